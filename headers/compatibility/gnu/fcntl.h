@@ -0,0 +1,38 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _GNU_FCNTL_H_
+#define _GNU_FCNTL_H_
+
+
+#include_next <fcntl.h>
+#include <features.h>
+
+
+#ifdef _DEFAULT_SOURCE
+
+
+/* flags for splice() */
+#define SPLICE_F_MOVE		0x01	/* only a hint, ignored */
+#define SPLICE_F_NONBLOCK	0x02	/* don't block on the pipe */
+#define SPLICE_F_MORE		0x04	/* only a hint, ignored */
+#define SPLICE_F_GIFT		0x08	/* only a hint, ignored */
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern ssize_t splice(int inFD, off_t* inOffset, int outFD, off_t* outOffset,
+	size_t length, unsigned int flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* _DEFAULT_SOURCE */
+
+
+#endif /* _GNU_FCNTL_H_ */
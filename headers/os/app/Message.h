@@ -541,6 +541,8 @@ private:
 			status_t			_CopyForWrite();
 			status_t			_Reference();
 			status_t			_Dereference();
+			status_t			_ReceiveFromPortBuffer(port_id port,
+									int32* _code);
 
 			status_t			_ValidateMessage();
 
@@ -46,7 +46,8 @@ typedef ulong cpu_status;
 		} while (false)
 #endif
 
-#define B_SPINLOCK_IS_LOCKED(spinlock)	(atomic_get(&(spinlock)->lock) > 0)
+#define B_SPINLOCK_IS_LOCKED(spinlock)	\
+	((atomic_get(&(spinlock)->lock) & 1) != 0)
 
 typedef struct {
 	int32		lock;
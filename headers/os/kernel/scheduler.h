@@ -24,6 +24,15 @@
 		PLAYBACK and RECORDING means threads feeding/reading ACTUAL
 		HARDWARE ONLY.
 		0 means don't care
+
+	Threads that need a guaranteed share of the CPU rather than just a high
+	priority can request a deadline reservation with set_thread_deadline():
+	the thread then gets \a runtime us of CPU time within \a deadline us
+	after the start of every \a period us (a \a deadline of 0 is the same
+	as \a period), ahead of all threads that are scheduled by priority. If
+	it needs more, it has to wait until its next period. A \a runtime of 0
+	removes the reservation. The function fails with B_BUSY, if the system
+	can't guarantee the reservation.
 */
 
 /* bitmasks for suggest_thread_priority() */
@@ -66,6 +75,12 @@ bigtime_t estimate_max_scheduling_latency(thread_id th = -1);
 status_t set_scheduler_mode(int32 mode);
 int32 get_scheduler_mode(void);
 
+status_t set_thread_deadline(thread_id thread, bigtime_t runtime,
+	bigtime_t deadline, bigtime_t period);
+status_t get_thread_deadline(thread_id thread, bigtime_t* _runtime,
+	bigtime_t* _deadline, bigtime_t* _period);
+	/* -1 is the current thread */
+
 }
 #else
 
@@ -78,6 +93,12 @@ bigtime_t estimate_max_scheduling_latency(thread_id th);
 status_t set_scheduler_mode(int32 mode);
 int32 get_scheduler_mode(void);
 
+status_t set_thread_deadline(thread_id thread, bigtime_t runtime,
+	bigtime_t deadline, bigtime_t period);
+status_t get_thread_deadline(thread_id thread, bigtime_t* _runtime,
+	bigtime_t* _deadline, bigtime_t* _period);
+	/* -1 is the current thread */
+
 #endif
 
 #endif // SCHEDULER_H
@@ -216,6 +216,13 @@ extern int pthread_attr_getschedparam(const pthread_attr_t *attr,
 extern int pthread_attr_setschedparam(pthread_attr_t *attr,
 	const struct sched_param *param);
 
+/* Haiku extension: deadline reservation (times in microseconds), see
+   set_thread_deadline() */
+extern int pthread_attr_getdeadline_np(const pthread_attr_t *attr,
+	__haiku_int64 *runtime, __haiku_int64 *deadline, __haiku_int64 *period);
+extern int pthread_attr_setdeadline_np(pthread_attr_t *attr,
+	__haiku_int64 runtime, __haiku_int64 deadline, __haiku_int64 period);
+
 extern int pthread_attr_getguardsize(const pthread_attr_t *attr,
 	size_t *guardsize);
 extern int pthread_attr_setguardsize(pthread_attr_t *attr, size_t guardsize);
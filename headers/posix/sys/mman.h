@@ -40,6 +40,8 @@
 #define MADV_WILLNEED		4
 #define MADV_DONTNEED		5
 #define MADV_FREE			6
+#define MADV_HUGEPAGE		7
+#define MADV_NOHUGEPAGE		8
 
 /* posix_madvise() values */
 #define POSIX_MADV_NORMAL		MADV_NORMAL
@@ -18,6 +18,8 @@
 #define MESSAGE_BODY_HASH_TABLE_SIZE	5
 #define MAX_DATA_PREALLOCATION			B_PAGE_SIZE * 10
 #define MAX_FIELD_PREALLOCATION			50
+#define MIN_PORT_BUFFER_MESSAGE_SIZE	B_PAGE_SIZE * 10
+	// larger messages are sent and received in port buffers
 
 
 static const int32 kPortMessageCode = 'pjpp';
@@ -32,7 +34,9 @@ enum {
 	MESSAGE_FLAG_HAS_SPECIFIERS = 0x0020,
 	MESSAGE_FLAG_WAS_DROPPED = 0x0040,
 	MESSAGE_FLAG_PASS_BY_AREA = 0x0080,
-	MESSAGE_FLAG_REPLY_AS_KMESSAGE = 0x0100
+	MESSAGE_FLAG_REPLY_AS_KMESSAGE = 0x0100,
+	MESSAGE_FLAG_PORT_BUFFER = 0x0200
+		// message_area is a port buffer the message was received in
 };
 
 
@@ -176,6 +180,12 @@ class BMessage::Private {
 			return fMessage->_FlattenToArea(header);
 		}
 
+		status_t
+		ReceiveFromPortBuffer(port_id port, int32* _code)
+		{
+			return fMessage->_ReceiveFromPortBuffer(port, _code);
+		}
+
 		status_t
 		SendMessage(port_id port, team_id portOwner, int32 token,
 			bigtime_t timeout, bool replyRequired, BMessenger &replyTo) const
@@ -227,6 +227,9 @@ enum {
 	AS_SET_SUBPIXEL_ORDERING,
 	AS_GET_SUBPIXEL_ORDERING,
 
+	AS_SET_TILED_RENDERING,
+	AS_GET_TILED_RENDERING,
+
 	// Graphics calls
 	AS_SET_HIGH_COLOR,
 	AS_SET_LOW_COLOR,
@@ -433,6 +433,10 @@
 #define CR0_FPU_EMULATION		(1UL << 2)
 #define CR0_MONITOR_FPU			(1UL << 1)
 
+// Control Register CR3 flags, with CR4.PCIDE set §4.10.4.1
+#define IA32_CR3_PCID_MASK		0xfffUL
+#define IA32_CR3_NO_FLUSH		(1ULL << 63)
+
 // Control Register CR4 flags §2.5
 // https://www.intel.com/content/dam/www/public/us/en/documents/manuals/64-ia-32-architectures-software-developer-vol-3a-part-1-manual.pdf
 #define IA32_CR4_VME			(1UL << 0)
@@ -544,6 +548,21 @@ enum x86_vendors {
 };
 
 
+#ifdef __x86_64__
+// number of process context IDs (PCIDs) each CPU assigns to user address
+// spaces, PCID 0 is used for the kernel address space
+#define X86_PCID_SLOT_COUNT		8
+
+typedef struct x86_pcid_slot {
+	int64				context;
+		// context ID of the paging structures the PCID belongs to
+	int64				flush_generation;
+		// the paging structures' flush generation up to which the TLB entries
+		// tagged with the PCID are valid, -1 if they must be flushed
+} x86_pcid_slot;
+#endif
+
+
 typedef struct arch_cpu_info {
 	// saved cpu info
 	enum x86_vendors	vendor;
@@ -567,6 +586,15 @@ typedef struct arch_cpu_info {
 	uint64				frequency;
 
 	struct X86PagingStructures* active_paging_structures;
+	bool				tlb_lazy;
+		// only kernel threads are running on active_paging_structures
+	bool				tlb_flush_pending;
+		// TLB flushes have been skipped while in lazy mode
+#ifdef __x86_64__
+	uint32				active_pcid;
+	uint32				next_pcid_slot;
+	x86_pcid_slot		pcid_slots[X86_PCID_SLOT_COUNT];
+#endif
 
 	size_t				dr6;	// temporary storage for debug registers (cf.
 	size_t				dr7;	// x86_exit_user_debug_at_kernel_entry())
@@ -653,6 +681,10 @@ struct amd_microcode_header {
 
 extern void (*gCpuIdleFunc)(void);
 
+#ifdef __x86_64__
+extern bool gHasPCID;
+#endif
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -42,6 +42,8 @@ status_t unload_kernel_add_on(image_id id);
 status_t elf_debug_lookup_symbol_address(addr_t address, addr_t *_baseAddress,
 			const char **_symbolName, const char **_imageName,
 			bool *_exactMatch);
+status_t elf_lookup_kernel_symbol_address(addr_t address,
+			addr_t *_baseAddress, char *symbolName, size_t symbolNameSize);
 status_t elf_debug_lookup_user_symbol_address(Team* team, addr_t address,
 			addr_t *_baseAddress, const char **_symbolName,
 			const char **_imageName, bool *_exactMatch);
@@ -20,6 +20,8 @@ extern status_t	_user_event_queue_select(int queue,	event_wait_info* userInfos,
 					int numInfos);
 extern ssize_t	_user_event_queue_wait(int queue, event_wait_info* infos,
 					int numInfos, uint32 flags, bigtime_t timeout);
+extern area_id	_user_event_queue_setup_ring(int queue, uint32 entries,
+					void** _address);
 
 
 #ifdef __cplusplus
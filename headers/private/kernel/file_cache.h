@@ -31,6 +31,8 @@ struct cache_module_info {
 	void (*node_closed)(struct vnode *vnode, dev_t mountID,
 				ino_t vnodeID, int32 accessType);
 	void (*node_launched)(size_t argCount, char * const *args);
+	void (*node_accessed)(dev_t mountID, ino_t vnodeID, off_t offset,
+				size_t size);
 };
 
 #ifdef __cplusplus
@@ -42,8 +44,12 @@ extern void cache_node_opened(struct vnode *vnode, VMCache *cache,
 extern void cache_node_closed(struct vnode *vnode, VMCache *cache,
 				dev_t mountID, ino_t vnodeID);
 extern void cache_node_launched(size_t argCount, char * const *args);
+extern void cache_node_accessed(VMCache *cache, off_t offset, size_t size);
+extern bool cache_tracks_node_accesses(void);
 extern void cache_prefetch_vnode(struct vnode *vnode, off_t offset, size_t size);
 extern void cache_prefetch(dev_t mountID, ino_t vnodeID, off_t offset, size_t size);
+extern status_t cache_advise(VMCache *cache, off_t offset, off_t length,
+				int advice);
 
 extern status_t file_map_init(void);
 extern status_t file_cache_init_post_boot_device(void);
@@ -90,6 +90,23 @@ extern status_t deselect_fd(int32 fd, struct select_info *info, bool kernel);
 extern bool fd_is_valid(int fd, bool kernel);
 extern struct vnode *fd_vnode(struct file_descriptor *descriptor);
 extern bool fd_is_file(struct file_descriptor* descriptor);
+extern status_t fd_sync(struct file_descriptor* descriptor);
+extern ssize_t fd_user_io(struct file_descriptor* descriptor, off_t pos,
+	void* buffer, size_t length, bool write, bool nonBlocking);
+extern ssize_t fd_vector_io(struct file_descriptor* descriptor, off_t pos,
+	const struct iovec* vecs, size_t count, bool write, bool nonBlocking);
+extern bool fd_nonblocking_io(int openMode);
+
+extern bool fd_is_socket(struct file_descriptor* descriptor);
+extern int socket_fd_accept(struct file_descriptor* descriptor, int flags,
+	bool kernel, bool nonBlocking);
+extern ssize_t socket_fd_recv(struct file_descriptor* descriptor, void* data,
+	size_t length, int flags);
+extern ssize_t socket_fd_send(struct file_descriptor* descriptor,
+	const void* data, size_t length, int flags);
+extern ssize_t socket_fd_send_external(struct file_descriptor* descriptor,
+	const struct iovec* vecs, size_t count, int flags,
+	void (*release)(void* cookie), void* cookie);
 
 extern bool fd_close_on_exec(const struct io_context *context, int fd);
 extern void fd_set_close_on_exec(struct io_context *context, int fd,
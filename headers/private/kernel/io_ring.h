@@ -0,0 +1,29 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _KERNEL_IO_RING_H
+#define _KERNEL_IO_RING_H
+
+
+#include <OS.h>
+#include <io_ring_defs.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+extern int		_user_io_ring_setup(io_ring_params* params);
+extern ssize_t	_user_io_ring_enter(int ring, uint32 toSubmit,
+					uint32 minComplete, uint32 flags, bigtime_t timeout);
+extern status_t	_user_io_ring_register(int ring, uint32 operation,
+					const void* args, uint32 count);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	// _KERNEL_IO_RING_H
@@ -16,6 +16,7 @@
 
 struct scheduling_analysis;
 struct SchedulerListener;
+struct thread_deadline_params;
 
 
 #ifdef __cplusplus
@@ -44,6 +45,12 @@ void scheduler_reschedule(int32 next_state);
 */
 int32 scheduler_set_thread_priority(Thread* thread, int32 priority);
 
+/*!	Sets or removes the deadline reservation of a thread. Interrupts must
+	be enabled.
+*/
+status_t scheduler_set_thread_deadline(Thread* thread, bigtime_t runtime,
+	bigtime_t deadline, bigtime_t period);
+
 /*!	Called when the Thread structure is first created.
 	Per-thread housekeeping resources can be allocated.
 	Interrupts must be enabled.
@@ -95,6 +102,11 @@ status_t _user_analyze_scheduling(bigtime_t from, bigtime_t until, void* buffer,
 status_t _user_set_scheduler_mode(int32 mode);
 int32 _user_get_scheduler_mode(void);
 
+status_t _user_set_thread_deadline(thread_id thread,
+	const struct thread_deadline_params* params);
+status_t _user_get_thread_deadline(thread_id thread,
+	struct thread_deadline_params* params);
+
 #ifdef __cplusplus
 }
 #endif
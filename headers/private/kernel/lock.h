@@ -28,6 +28,12 @@ typedef struct mutex {
 	int32					count;
 #endif
 	uint8					flags;
+	int32					owner_cpu;
+	void*					owner_stack;
+		// Only hints for adaptive spinning: an address on the holder's stack
+		// and the CPU it acquired the lock on (-1 if unknown). The stack
+		// address works without knowing the current thread, so that the
+		// inline fast path can record it as well.
 } mutex;
 
 #define MUTEX_FLAG_CLONE_NAME	0x1
@@ -62,6 +68,10 @@ typedef struct rw_lock {
 								// incremented "count", but have not yet started
 								// to wait at the time the last writer unlocked.
 	uint32					flags;
+	int32					owner_cpu;
+	void*					owner_stack;
+		// Only hints for adaptive spinning: an address on the stack of the
+		// writer holding the lock and the CPU it acquired the lock on.
 } rw_lock;
 
 #define RW_LOCK_WRITER_COUNT_BASE	0x10000
@@ -99,16 +109,16 @@ typedef struct rw_lock {
 // static initializers
 #if KDEBUG
 #	define MUTEX_INITIALIZER(name) \
-	{ name, NULL, B_SPINLOCK_INITIALIZER, -1, 0 }
+	{ name, NULL, B_SPINLOCK_INITIALIZER, -1, 0, -1, NULL }
 #	define RECURSIVE_LOCK_INITIALIZER(name)	{ MUTEX_INITIALIZER(name), 0 }
 #else
 #	define MUTEX_INITIALIZER(name) \
-	{ name, NULL, B_SPINLOCK_INITIALIZER, 0, 0 }
+	{ name, NULL, B_SPINLOCK_INITIALIZER, 0, 0, -1, NULL }
 #	define RECURSIVE_LOCK_INITIALIZER(name)	{ MUTEX_INITIALIZER(name), -1, 0 }
 #endif
 
 #define RW_LOCK_INITIALIZER(name) \
-	{ name, NULL, B_SPINLOCK_INITIALIZER, -1, 0, 0, 0, 0, 0 }
+	{ name, NULL, B_SPINLOCK_INITIALIZER, -1, 0, 0, 0, 0, 0, -1, NULL }
 
 
 #if KDEBUG
@@ -186,8 +196,15 @@ extern status_t _mutex_lock(mutex* lock, void* locker);
 extern void _mutex_unlock(mutex* lock);
 extern status_t _mutex_lock_with_timeout(mutex* lock, uint32 timeoutFlags,
 	bigtime_t timeout);
+extern status_t _mutex_lock_stats(mutex* lock);
+extern status_t _mutex_trylock_stats(mutex* lock);
+extern status_t _mutex_lock_with_timeout_stats(mutex* lock,
+	uint32 timeoutFlags, bigtime_t timeout);
 #endif
 
+extern int32 gLockStatsEnabled;
+extern void _lock_stats_released(const void* lock);
+
 
 static inline status_t
 rw_lock_read_lock(rw_lock* lock)
@@ -242,8 +259,14 @@ rw_lock_write_unlock(rw_lock* lock)
 static inline status_t
 mutex_lock(mutex* lock)
 {
+	if (gLockStatsEnabled != 0)
+		return _mutex_lock_stats(lock);
+
 	if (atomic_add(&lock->count, -1) < 0)
 		return _mutex_lock(lock, NULL);
+
+	lock->owner_cpu = -1;
+	lock->owner_stack = __builtin_frame_address(0);
 	return B_OK;
 }
 
@@ -251,8 +274,14 @@ mutex_lock(mutex* lock)
 static inline status_t
 mutex_trylock(mutex* lock)
 {
+	if (gLockStatsEnabled != 0)
+		return _mutex_trylock_stats(lock);
+
 	if (atomic_test_and_set(&lock->count, -1, 0) != 0)
 		return B_WOULD_BLOCK;
+
+	lock->owner_cpu = -1;
+	lock->owner_stack = __builtin_frame_address(0);
 	return B_OK;
 }
 
@@ -260,8 +289,14 @@ mutex_trylock(mutex* lock)
 static inline status_t
 mutex_lock_with_timeout(mutex* lock, uint32 timeoutFlags, bigtime_t timeout)
 {
+	if (gLockStatsEnabled != 0)
+		return _mutex_lock_with_timeout_stats(lock, timeoutFlags, timeout);
+
 	if (atomic_add(&lock->count, -1) < 0)
 		return _mutex_lock_with_timeout(lock, timeoutFlags, timeout);
+
+	lock->owner_cpu = -1;
+	lock->owner_stack = __builtin_frame_address(0);
 	return B_OK;
 }
 
@@ -269,6 +304,9 @@ mutex_lock_with_timeout(mutex* lock, uint32 timeoutFlags, bigtime_t timeout)
 static inline void
 mutex_unlock(mutex* lock)
 {
+	if (gLockStatsEnabled != 0)
+		_lock_stats_released(lock);
+
 	if (atomic_add(&lock->count, 1) < -1)
 		_mutex_unlock(lock);
 }
@@ -290,6 +328,7 @@ recursive_lock_transfer_lock(recursive_lock* lock, thread_id thread)
 
 
 extern void lock_debug_init();
+extern status_t lock_init_post_generic_syscalls();
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _KERNEL_LOCK_STATS_H
+#define _KERNEL_LOCK_STATS_H
+
+
+#include <OS.h>
+
+#include <lock_stats_defs.h>
+
+
+// number of locks per thread whose hold time can be tracked at the same time
+#define LOCK_STATS_MAX_HELD_LOCKS	4
+
+
+struct lock_stats_held_lock {
+	const void*	lock;
+	addr_t		identity;
+	const char*	name;
+	addr_t		caller;
+	nanotime_t	acquired;
+	uint32		type;
+	uint32		key;
+};
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int32 gLockStatsEnabled;
+
+void _lock_stats_acquired(uint32 type, const void* lock, const char* name,
+	addr_t caller, nanotime_t waitTime, bool contended);
+void _lock_stats_released(const void* lock);
+
+status_t lock_stats_init_post_generic_syscalls();
+
+#ifdef __cplusplus
+}
+#endif
+
+
+/*!	Records an acquisition of \a lock, if lock statistics are enabled.
+	\a waitTime is the time the caller spent acquiring the lock; for locks
+	whose hold time is tracked (all but spinlocks and read locks) the lock
+	must be released via lock_stats_released().
+*/
+static inline void
+lock_stats_acquired(uint32 type, const void* lock, const char* name,
+	addr_t caller, nanotime_t waitTime, bool contended)
+{
+	if (gLockStatsEnabled != 0)
+		_lock_stats_acquired(type, lock, name, caller, waitTime, contended);
+}
+
+
+static inline void
+lock_stats_released(const void* lock)
+{
+	if (gLockStatsEnabled != 0)
+		_lock_stats_released(lock);
+}
+
+
+#endif	/* _KERNEL_LOCK_STATS_H */
@@ -70,6 +70,14 @@ status_t	_user_writev_port_etc(port_id id, int32 msgCode,
 status_t	_user_get_port_message_info_etc(port_id port,
 				port_message_info *info, size_t infoSize, uint32 flags,
 				bigtime_t timeout);
+area_id		_user_acquire_port_buffer(size_t size, void **_address);
+status_t	_user_release_port_buffer(area_id buffer);
+ssize_t		_user_read_port_buffer_etc(port_id port, int32 *msgCode,
+				area_id *_buffer, void **_address, uint32 flags,
+				bigtime_t timeout);
+status_t	_user_write_port_buffer_etc(port_id port, int32 msgCode,
+				area_id buffer, size_t bufferSize, uint32 flags,
+				bigtime_t timeout);
 
 #ifdef __cplusplus
 }
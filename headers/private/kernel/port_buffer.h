@@ -0,0 +1,43 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _KERNEL_PORT_BUFFER_H
+#define _KERNEL_PORT_BUFFER_H
+
+
+#include <OS.h>
+
+
+#define PORT_BUFFER_MAX_SIZE	(4 * 1024 * 1024)
+
+struct PortBuffer;
+struct Team;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+status_t port_buffers_init(void);
+void delete_team_port_buffers(Team* team);
+bool is_port_buffer_area(area_id area);
+
+area_id acquire_port_buffer(size_t size, void** _address);
+status_t release_port_buffer(area_id buffer);
+
+status_t port_buffer_detach(area_id buffer, size_t size,
+			struct PortBuffer** _buffer);
+status_t port_buffer_attach(struct PortBuffer* buffer, area_id* _buffer,
+			void** _address);
+status_t port_buffer_create(const void* data, size_t size, team_id origin,
+			area_id* _buffer, void** _address);
+void port_buffer_put(struct PortBuffer* buffer);
+const void* port_buffer_data(struct PortBuffer* buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif	/* _KERNEL_PORT_BUFFER_H */
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _KERNEL_RCU_H
+#define _KERNEL_RCU_H
+
+
+#include <OS.h>
+
+#include <stdlib.h>
+
+
+/*!	Read-copy-update support.
+
+	Readers enclose their accesses in rcu_read_lock()/rcu_read_unlock(). They
+	don't take any lock and don't write to any shared cache line besides a
+	per-CPU counter. Writers unlink objects from the data structures the
+	readers traverse (under whatever lock usually protects them) and must not
+	free them before all readers that might still see them are done. That's
+	what rcu_synchronize() waits for, or what rcu_call() defers a callback
+	until.
+
+	Read sections may block, but should be short, as they delay the freeing of
+	all objects retired in the meantime. rcu_synchronize() must not be called
+	from within a read section.
+*/
+
+
+struct rcu_head;
+typedef void (*rcu_callback)(struct rcu_head* head);
+
+struct rcu_head {
+	struct rcu_head*	next;
+	rcu_callback		callback;
+};
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int32 rcu_read_lock(void);
+void rcu_read_unlock(int32 cookie);
+
+void rcu_synchronize(void);
+void rcu_call(struct rcu_head* head, rcu_callback callback);
+
+status_t rcu_init(void);
+
+#ifdef __cplusplus
+}
+
+
+class RCUReadLocker {
+public:
+	RCUReadLocker()
+		:
+		fCookie(rcu_read_lock())
+	{
+	}
+
+	~RCUReadLocker()
+	{
+		rcu_read_unlock(fCookie);
+	}
+
+private:
+	int32	fCookie;
+};
+
+
+/*!	Allocator for BOpenHashTable, that defers freeing old tables until all
+	readers are done. Needed for tables accessed via LookupUnlocked().
+*/
+struct RCUMallocAllocator {
+	void* Allocate(size_t size) const
+	{
+		Header* header = (Header*)malloc(sizeof(Header) + size);
+		if (header == NULL)
+			return NULL;
+		return header + 1;
+	}
+
+	void Free(void* memory) const
+	{
+		if (memory != NULL)
+			rcu_call(&((Header*)memory - 1)->head, &_Free);
+	}
+
+private:
+	union Header {
+		rcu_head	head;
+		uint64		alignment[2];
+	};
+
+	static void _Free(rcu_head* head)
+	{
+		free(head);
+	}
+};
+
+
+#endif	// __cplusplus
+
+
+#endif	/* _KERNEL_RCU_H */
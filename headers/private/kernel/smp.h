@@ -13,6 +13,7 @@
 #include <boot/kernel_args.h>
 #include <kernel.h>
 
+#include <ByteOrder.h>
 #include <KernelExport.h>
 
 #include <string.h>
@@ -38,6 +39,26 @@ enum {
 	SMP_MSG_FLAG_FREE_ARG	= 0x2,
 };
 
+// Bit in spinlock::lock that is set while the lock is held. The remaining
+// bits are used by smp.cpp to queue waiting CPUs.
+#define SPINLOCK_LOCKED	0x1
+
+
+/*!	Releases \a lock by storing 0 into the lowest byte of its word.
+	Only the owner ever writes that byte while the lock is held -- waiters
+	only change the queue tail in the upper bytes -- so a plain release store
+	suffices and no locked read-modify-write is needed.
+*/
+static inline void
+spinlock_clear_locked(spinlock* lock)
+{
+	uint8* lockedByte = (uint8*)&lock->lock;
+#if !B_HOST_IS_LENDIAN
+	lockedByte += sizeof(lock->lock) - 1;
+#endif
+	__atomic_store_n(lockedByte, 0, __ATOMIC_RELEASE);
+}
+
 typedef void (*smp_call_func)(addr_t data1, int32 currentCPU, addr_t data2, addr_t data3);
 
 class CPUSet {
@@ -209,7 +230,7 @@ CPUSet::IsEmpty() const
 static inline bool
 try_acquire_spinlock_inline(spinlock* lock)
 {
-	return atomic_get_and_set(&lock->lock, 1) == 0;
+	return atomic_test_and_set(&lock->lock, SPINLOCK_LOCKED, 0) == 0;
 }
 
 
@@ -225,7 +246,7 @@ acquire_spinlock_inline(spinlock* lock)
 static inline void
 release_spinlock_inline(spinlock* lock)
 {
-	atomic_set(&lock->lock, 0);
+	spinlock_clear_locked(lock);
 }
 
 
@@ -0,0 +1,25 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _KERNEL_SPLICE_H
+#define _KERNEL_SPLICE_H
+
+
+#include <OS.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+extern ssize_t	_user_splice(int inFD, off_t* inOffset, int outFD,
+					off_t* outOffset, size_t length, uint32 flags);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	// _KERNEL_SPLICE_H
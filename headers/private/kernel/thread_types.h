@@ -17,6 +17,7 @@
 #include <heap.h>
 #include <ksignal.h>
 #include <lock.h>
+#include <lock_stats.h>
 #include <smp.h>
 #include <thread_defs.h>
 #include <timer.h>
@@ -65,6 +66,7 @@ struct realtime_sem_context;	// defined in realtime_sem.cpp
 struct select_info;
 struct user_thread;				// defined in libroot/user_thread.h
 struct VMAddressSpace;
+class VMCachePagesTreePreload;	// defined in VMCachePagesTree.h
 struct user_mutex_context;		// defined in user_mutex.cpp
 struct xsi_sem_context;			// defined in xsi_semaphore.cpp
 
@@ -506,6 +508,8 @@ struct Thread : TeamThreadIteratorEntry<thread_id>, KernelReferenceable {
 	jmp_buf			fault_handler_state;
 	int32			page_faults_allowed;
 		/* this field may only stay in debug builds in the future */
+	VMCachePagesTreePreload* cache_pages_preload;
+		// the innermost preload; only accessed by the thread itself
 
 	BKernel::Team	*team;	// protected by team lock, thread lock, scheduler
 							// lock, team_lock
@@ -551,6 +555,9 @@ struct Thread : TeamThreadIteratorEntry<thread_id>, KernelReferenceable {
 	rw_lock*		held_read_locks[64] = {}; // only modified by this thread
 #endif
 
+	lock_stats_held_lock held_locks[LOCK_STATS_MAX_HELD_LOCKS] = {};
+		// only modified by this thread, used for lock hold time statistics
+
 	// architecture dependent section
 	struct arch_thread arch_info;
 
@@ -860,5 +867,8 @@ using BKernel::ProcessGroupList;
 #endif
 #define	THREAD_FLAGS_OLD_SIGMASK			0x4000
 	// the thread has an old sigmask to be restored
+#define	THREAD_FLAGS_NONBLOCKING_IO			0x8000
+	// the file descriptor I/O currently in progress must not block, even if
+	// the descriptor itself is blocking (see fd_nonblocking_io())
 
 #endif	/* _KERNEL_THREAD_TYPES_H */
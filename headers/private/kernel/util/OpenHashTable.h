@@ -58,6 +58,19 @@
 */
 
 
+// Stores and loads of the pointers LookupUnlocked() follows. A release store
+// orders the initialization of an element before its publication.
+#if defined(__GNUC__) && __GNUC__ >= 4
+#	define HASH_TABLE_STORE_RELEASE(target, value) \
+		__atomic_store_n(&(target), (value), __ATOMIC_RELEASE)
+#	define HASH_TABLE_LOAD_ACQUIRE(source) \
+		__atomic_load_n(&(source), __ATOMIC_ACQUIRE)
+#else
+#	define HASH_TABLE_STORE_RELEASE(target, value)	(target) = (value)
+#	define HASH_TABLE_LOAD_ACQUIRE(source)			(source)
+#endif
+
+
 struct MallocAllocator {
 	void* Allocate(size_t size) const
 	{
@@ -85,7 +98,8 @@ template<typename Definition, bool AutoExpand = true,
 	bool CheckDuplicates = false, typename Allocator = MallocAllocator>
 class BOpenHashTable {
 public:
-	typedef BOpenHashTable<Definition, AutoExpand, CheckDuplicates> HashTable;
+	typedef BOpenHashTable<Definition, AutoExpand, CheckDuplicates, Allocator>
+		HashTable;
 	typedef typename Definition::KeyType	KeyType;
 	typedef typename Definition::ValueType	ValueType;
 
@@ -167,6 +181,40 @@ public:
 		return slot;
 	}
 
+	/*!	\brief Looks up a value without holding the lock that protects the
+		table.
+
+		Concurrent insertions, removals, and resizes are tolerated, but may
+		cause the lookup to spuriously fail, so the caller needs a fallback
+		(i.e. the locked Lookup()). Neither removed values nor old tables
+		must be freed while unlocked lookups might still access them, which
+		is usually ensured by RCU (cf. RCUMallocAllocator).
+	*/
+	ValueType* LookupUnlocked(
+		typename TypeOperation<KeyType>::ConstRefT key) const
+	{
+		// _Resize() publishes the table and its size in an order that,
+		// together with re-reading the table pointer, guarantees that the
+		// size never exceeds that of the table.
+		ValueType** table = HASH_TABLE_LOAD_ACQUIRE(fTable);
+		size_t tableSize = HASH_TABLE_LOAD_ACQUIRE(fTableSize);
+		if (table == NULL || tableSize == 0
+			|| table != HASH_TABLE_LOAD_ACQUIRE(fTable)) {
+			return NULL;
+		}
+
+		size_t index = fDefinition.HashKey(key) & (tableSize - 1);
+		ValueType* slot = HASH_TABLE_LOAD_ACQUIRE(table[index]);
+
+		while (slot) {
+			if (fDefinition.Compare(key, slot))
+				break;
+			slot = HASH_TABLE_LOAD_ACQUIRE(_Link(slot));
+		}
+
+		return slot;
+	}
+
 	status_t Insert(ValueType* value)
 	{
 		if (fTableSize == 0) {
@@ -428,7 +476,7 @@ protected:
 		size_t index = fDefinition.Hash(value) & (tableSize - 1);
 
 		_Link(value) = table[index];
-		table[index] = value;
+		HASH_TABLE_STORE_RELEASE(table[index], value);
 	}
 
 	bool _Resize(size_t newSize)
@@ -447,25 +495,33 @@ protected:
 		for (size_t i = 0; i < newSize; i++)
 			newTable[i] = NULL;
 
-		if (fTable) {
+		ValueType** oldTable = fTable;
+		if (oldTable) {
 			for (size_t i = 0; i < fTableSize; i++) {
-				ValueType* bucket = fTable[i];
+				ValueType* bucket = oldTable[i];
 				while (bucket) {
 					ValueType* next = _Link(bucket);
 					_Insert(newTable, newSize, bucket);
 					bucket = next;
 				}
 			}
+		}
 
-			if (_oldTable != NULL)
-				*_oldTable = fTable;
-			else
-				fAllocator.Free(fTable);
-		} else if (_oldTable != NULL)
-			*_oldTable = NULL;
+		// For LookupUnlocked() a size must never be paired with a smaller
+		// table: when growing the table is published first, when shrinking
+		// the size. The old table is freed only afterwards.
+		if (newSize > fTableSize) {
+			HASH_TABLE_STORE_RELEASE(fTable, newTable);
+			HASH_TABLE_STORE_RELEASE(fTableSize, newSize);
+		} else {
+			HASH_TABLE_STORE_RELEASE(fTableSize, newSize);
+			HASH_TABLE_STORE_RELEASE(fTable, newTable);
+		}
 
-		fTableSize = newSize;
-		fTable = newTable;
+		if (_oldTable != NULL)
+			*_oldTable = oldTable;
+		else if (oldTable != NULL)
+			fAllocator.Free(oldTable);
 	}
 
 	ValueType*& _Link(ValueType* bucket) const
@@ -129,6 +129,8 @@ status_t	vfs_release_posix_lock(io_context* context,
 				struct file_descriptor* descriptor);
 status_t	vfs_unmount(dev_t mountID, uint32 flags);
 status_t	vfs_disconnect_vnode(dev_t mountID, ino_t vnodeID);
+void		vfs_node_stat_changed(dev_t mountID, ino_t vnodeID,
+			uint32 statFields);
 status_t	vfs_resolve_parent(struct vnode* parent, dev_t* device,
 				ino_t* node);
 void		vfs_free_unused_vnodes(int32 level);
@@ -254,6 +256,7 @@ int			_user_dup2(int ofd, int nfd, int flags);
 status_t	_user_lock_node(int fd);
 status_t	_user_unlock_node(int fd);
 status_t	_user_preallocate(int fd, off_t offset, off_t length);
+status_t	_user_file_advice(int fd, off_t offset, off_t length, int advice);
 
 /* socket user prototypes (implementation in socket.cpp) */
 int			_user_socket(int family, int type, int protocol);
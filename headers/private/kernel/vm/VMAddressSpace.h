@@ -12,6 +12,8 @@
 
 #include <OS.h>
 
+#include <condition_variable.h>
+
 #include <vm/vm_priv.h>
 #include <vm/VMArea.h>
 #include <vm/VMTranslationMap.h>
@@ -45,10 +47,16 @@ public:
 									{ return rw_lock_read_lock(&fLock); }
 			void				ReadUnlock()
 									{ rw_lock_read_unlock(&fLock); }
-			status_t			WriteLock()
-									{ return rw_lock_write_lock(&fLock); }
-			void				WriteUnlock()
-									{ rw_lock_write_unlock(&fLock); }
+	inline	status_t			WriteLock();
+	inline	void				WriteUnlock();
+
+			void				LimitWriteRange(addr_t address, size_t size);
+			bool				MayBeWritten(addr_t address, size_t size)
+									const;
+
+	inline	void				BeginSpeculativeFault()
+									{ atomic_add(&fSpeculativeFaults, 1); }
+	inline	void				EndSpeculativeFault();
 
 			int32				RefCount() const
 									{ return fRefCount; }
@@ -79,6 +87,7 @@ public:
 	virtual	VMArea*				NextArea(VMArea* area) const = 0;
 
 	virtual	VMArea*				LookupArea(addr_t address) const = 0;
+	virtual	VMArea*				LookupAreaUnlocked(addr_t address) const;
 	virtual	VMArea*				FindClosestArea(addr_t address, bool less) const
 									= 0;
 	virtual	VMArea*				CreateArea(const char* name, uint32 wiring,
@@ -136,6 +145,12 @@ public:
 protected:
 	static	void				_DeleteIfUnreferenced(team_id id);
 
+			void				_BeginWrite();
+			void				_EndWrite();
+			void				_SetWriteRange(addr_t start, addr_t end);
+			void				_ExtendWriteRange(addr_t address,
+									size_t size);
+
 	static	int					_DumpCommand(int argc, char** argv);
 	static	int					_DumpListCommand(int argc, char** argv);
 
@@ -152,6 +167,13 @@ protected:
 			int32				fRefCount;
 			int32				fFaultCount;
 			int32				fChangeCount;
+			int32				fWriteLockCount;
+			int32				fSpeculativeFaults;
+			int32				fSpeculativeFaultsWaiter;
+			ConditionVariable	fSpeculativeFaultsCondition;
+			int32				fWriteRangeSequence;
+			addr_t				fWriteRangeStart;
+			addr_t				fWriteRangeEnd;
 			VMTranslationMap*	fTranslationMap;
 			bool				fRandomizingEnabled;
 			bool				fDeleting;
@@ -159,6 +181,25 @@ protected:
 };
 
 
+status_t
+VMAddressSpace::WriteLock()
+{
+	status_t status = rw_lock_write_lock(&fLock);
+	if (status == B_OK && ++fWriteLockCount == 1)
+		_BeginWrite();
+	return status;
+}
+
+
+void
+VMAddressSpace::WriteUnlock()
+{
+	if (--fWriteLockCount == 0)
+		_EndWrite();
+	rw_lock_write_unlock(&fLock);
+}
+
+
 void
 VMAddressSpace::Put()
 {
@@ -253,6 +294,17 @@ private:
 };
 
 
+inline void
+VMAddressSpace::EndSpeculativeFault()
+{
+	// only the last fault has to wake up a waiting writer
+	if (atomic_add(&fSpeculativeFaults, -1) == 1
+		&& atomic_get(&fSpeculativeFaultsWaiter) != 0) {
+		fSpeculativeFaultsCondition.NotifyAll();
+	}
+}
+
+
 inline VMAddressSpace::AreaIterator
 VMAddressSpace::GetAreaIterator()
 {
@@ -101,6 +101,19 @@ public:
 											// wire for writing
 	};
 
+	enum {
+		// large_pages values
+		LARGE_PAGES_DEFAULT			= 0,	// if the area is large enough
+		LARGE_PAGES_ALWAYS,					// MADV_HUGEPAGE
+		LARGE_PAGES_NEVER					// MADV_NOHUGEPAGE
+	};
+
+	enum {
+		// fault_around_pages values; must be powers of two, or 0
+		FAULT_AROUND_DEFAULT_PAGES	= 16,	// MADV_NORMAL
+		FAULT_AROUND_MAX_PAGES		= 64	// MADV_SEQUENTIAL
+	};
+
 public:
 	area_id					id;
 	char					name[B_OS_NAME_LENGTH];
@@ -117,6 +130,8 @@ public:
 	uint32					cache_type;
 	VMAreaMappings			mappings;
 	uint8*					page_protections;
+	uint8					large_pages;
+	uint8					fault_around_pages;
 
 	struct VMAddressSpace*	address_space;
 
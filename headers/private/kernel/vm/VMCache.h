@@ -16,6 +16,7 @@
 #include <vm/vm.h>
 #include <vm/vm_types.h>
 #include <vm/VMArea.h>
+#include <vm/VMCachePagesTree.h>
 
 #include "kernel_debug_config.h"
 
@@ -44,35 +45,6 @@ extern ObjectCache* gDeviceCacheObjectCache;
 extern ObjectCache* gNullCacheObjectCache;
 
 
-struct VMCachePagesTreeDefinition {
-	typedef page_num_t KeyType;
-	typedef	vm_page NodeType;
-
-	static page_num_t GetKey(const NodeType* node)
-	{
-		return node->cache_offset;
-	}
-
-	static SplayTreeLink<NodeType>* GetLink(NodeType* node)
-	{
-		return &node->cache_link;
-	}
-
-	static int Compare(page_num_t key, const NodeType* node)
-	{
-		return key == node->cache_offset ? 0
-			: (key < node->cache_offset ? -1 : 1);
-	}
-
-	static NodeType** GetListLink(NodeType* node)
-	{
-		return &node->cache_next;
-	}
-};
-
-typedef IteratableSplayTree<VMCachePagesTreeDefinition> VMCachePagesTree;
-
-
 struct VMCache : public DoublyLinkedListLinkImpl<VMCache> {
 public:
 	typedef DoublyLinkedList<VMCache> ConsumerList;
@@ -110,7 +82,11 @@ public:
 	inline	void				MarkPageUnbusy(vm_page* page);
 
 			vm_page*			LookupPage(off_t offset);
+			vm_page*			LookupPageUnlocked(off_t offset) const
+									{ return pages.LookupUnlocked(
+										(page_num_t)(offset >> PAGE_SHIFT)); }
 			void				InsertPage(vm_page* page, off_t offset);
+			status_t			TryInsertPage(vm_page* page, off_t offset);
 			void				RemovePage(vm_page* page);
 			void				MovePage(vm_page* page, off_t offset);
 			void				MovePage(vm_page* page);
@@ -154,6 +130,7 @@ public:
 	virtual	bool				CanOvercommit();
 	virtual	status_t			Commit(off_t size, int priority);
 	virtual	bool				StoreHasPage(off_t offset);
+	virtual	bool				StoreHasPages(off_t offset, off_t size);
 
 	virtual	status_t			Read(off_t offset, const generic_io_vec *vecs,
 									size_t count, uint32 flags,
@@ -227,7 +204,7 @@ private:
 
 	inline	bool				_IsMergeable() const;
 
-			void				_MergeWithOnlyConsumer();
+			bool				_MergeWithOnlyConsumer();
 			void				_RemoveConsumer(VMCache* consumer);
 
 			bool				_FreePageRange(VMCachePagesTree::Iterator it,
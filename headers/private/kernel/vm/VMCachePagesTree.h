@@ -0,0 +1,160 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _KERNEL_VM_VM_CACHE_PAGES_TREE_H
+#define _KERNEL_VM_VM_CACHE_PAGES_TREE_H
+
+
+#include <SupportDefs.h>
+
+#include <vm/vm_types.h>
+
+
+enum {
+	VM_CACHE_PAGE_TAG_MODIFIED	= 0,
+		// the page is in PAGE_STATE_MODIFIED
+	VM_CACHE_PAGE_TAG_COUNT
+};
+
+
+struct VMCachePagesTreeNode;
+
+
+/*!	The page index of a VMCache: a radix tree keyed by the page offset
+	(vm_page::cache_offset).
+
+	All modifications require the cache lock. Lookups and iterations usually
+	hold it, too, but LookupUnlocked() only requires an RCU read section (it
+	enters one itself); since vm_page structures are never freed, the page it
+	returns can always be accessed, but it may no longer belong to the cache,
+	or be at another offset by the time the caller looks at it.
+
+	Every node keeps a bitmap of its used slots and one bitmap per tag, which
+	is set for a slot when any page below it carries the tag. This allows to
+	quickly skip the empty and the untagged parts of the tree when iterating.
+*/
+class VMCachePagesTree {
+public:
+	class Iterator {
+	public:
+		Iterator()
+			:
+			fTree(NULL),
+			fNextKey(0),
+			fTag(-1),
+			fDone(true)
+		{
+		}
+
+		Iterator(const VMCachePagesTree* tree, page_num_t key, int32 tag = -1)
+			:
+			fTree(tree),
+			fNextKey(key),
+			fTag(tag),
+			fDone(false)
+		{
+		}
+
+		bool HasNext() const
+		{
+			return !fDone && fTree->_FindNext(fNextKey, fTag) != NULL;
+		}
+
+		vm_page* Next();
+
+	private:
+		const VMCachePagesTree*	fTree;
+		page_num_t				fNextKey;
+		int32					fTag;
+		bool					fDone;
+	};
+
+	typedef Iterator ConstIterator;
+
+public:
+								VMCachePagesTree();
+
+	static	status_t			Init();
+	static	void				InitPostHeap();
+
+			bool				IsEmpty() const	{ return fRoot == NULL; }
+			size_t				NodeCount() const	{ return fNodeCount; }
+
+			vm_page*			Lookup(page_num_t key) const;
+			vm_page*			LookupUnlocked(page_num_t key) const;
+			status_t			Insert(vm_page* page);
+			bool				Remove(vm_page* page);
+
+			vm_page*			FindMin() const
+									{ return _FindNext(0, -1); }
+
+			void				SetTag(vm_page* page, uint32 tag);
+			void				ClearTag(vm_page* page, uint32 tag);
+			bool				IsTagged(vm_page* page, uint32 tag) const;
+			bool				HasTagged(uint32 tag) const;
+
+			Iterator			GetIterator() const
+									{ return Iterator(this, 0); }
+			Iterator			GetIterator(page_num_t key, bool greater,
+									bool orEqual) const;
+			Iterator			GetTaggedIterator(uint32 tag,
+									page_num_t key = 0) const
+									{ return Iterator(this, key, tag); }
+
+private:
+			vm_page*			_FindNext(page_num_t key, int32 tag) const;
+			VMCachePagesTreeNode* _LookupLeaf(page_num_t key) const;
+			size_t				_NodesNeeded(page_num_t key) const;
+			void				_Grow(page_num_t key,
+									VMCachePagesTreeNode*& nodes);
+			void				_Shrink();
+			void				_UpdateTag(VMCachePagesTreeNode* node,
+									page_num_t key, uint32 tag, bool set);
+
+private:
+			VMCachePagesTreeNode* fRoot;
+			size_t				fNodeCount;
+};
+
+
+/*!	Preallocates the nodes that VMCachePagesTree::Insert() needs, so that
+	pages can be inserted while the cache is locked, without waiting for
+	memory there.
+
+	Like a vm_page_reservation, a preload is filled before the cache is
+	locked. It is registered with the current thread for its lifetime, and
+	Insert() takes its nodes from the innermost preload of the thread first.
+	Only if that is exhausted it tries to allocate them without waiting, and
+	fails with \c B_NO_MEMORY if that is not possible. The nodes that have
+	not been used are freed when the preload is destroyed.
+*/
+class VMCachePagesTreePreload {
+public:
+								VMCachePagesTreePreload();
+								~VMCachePagesTreePreload();
+
+			void				Preload(size_t nodeCount);
+			status_t			TryPreload(size_t nodeCount);
+
+			size_t				Count() const	{ return fCount; }
+
+	static	void				PreloadCurrent(size_t nodeCount);
+	static	size_t				NodesNeeded(page_num_t pageCount);
+
+private:
+	friend class VMCachePagesTree;
+
+			status_t			_Preload(size_t nodeCount, uint32 flags);
+
+	static	VMCachePagesTreeNode* _TakeNodes(size_t count);
+
+private:
+			VMCachePagesTreeNode* fNodes;
+			size_t				fCount;
+			VMCachePagesTreePreload* fPrevious;
+			bool				fRegistered;
+};
+
+
+#endif	// _KERNEL_VM_VM_CACHE_PAGES_TREE_H
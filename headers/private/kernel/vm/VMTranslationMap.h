@@ -71,6 +71,10 @@ public:
 	virtual	status_t			ClearFlags(addr_t virtualAddress,
 									uint32 flags) = 0;
 
+	// large pages
+	virtual	size_t				LargePageSize() const;
+	virtual	status_t			PromoteLargePage(addr_t address);
+
 	virtual	bool				ClearAccessedAndModified(
 									VMArea* area, addr_t address,
 									bool unmapIfUnaccessed,
@@ -105,6 +109,11 @@ struct VMTranslationMap::ReverseMappingInfoCallback {
 };
 
 
+extern int32 gMappedLargePagesCount;
+extern int64 gLargePagePromotions;
+extern int64 gLargePageDemotions;
+
+
 struct VMPhysicalPageMapper {
 								VMPhysicalPageMapper();
 	virtual						~VMPhysicalPageMapper();
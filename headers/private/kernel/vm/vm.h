@@ -24,6 +24,8 @@ struct VMCache;
 struct vm_page;
 struct vnode;
 struct VMPageWiringInfo;
+struct vm_compressed_swap_stats;
+struct vm_large_page_stats;
 
 
 // area creation flags
@@ -106,6 +108,8 @@ area_id vm_map_physical_memory_vecs(team_id team, const char* name,
 area_id vm_map_file(team_id aid, const char *name, void **address,
 			uint32 addressSpec, addr_t size, uint32 protection, uint32 mapping,
 			bool unmapAddressRange, int fd, off_t offset);
+area_id vm_map_vnode_cache(const char *name, void **address,
+			uint32 addressSpec, addr_t size, struct vnode *vnode, off_t offset);
 struct VMCache *vm_area_get_locked_cache(struct VMArea *area);
 void vm_area_put_locked_cache(struct VMCache *cache);
 area_id vm_create_null_area(team_id team, const char *name, void **address,
@@ -177,6 +181,10 @@ status_t _user_get_memory_properties(team_id teamID, const void *address,
 status_t _user_mlock(const void* address, size_t size);
 status_t _user_munlock(const void* address, size_t size);
 
+status_t _user_get_large_page_stats(struct vm_large_page_stats* stats);
+status_t _user_get_compressed_swap_stats(
+	struct vm_compressed_swap_stats* stats);
+
 area_id _user_area_for(void *address);
 area_id _user_find_area(const char *name);
 status_t _user_get_area_info(area_id area, area_info *info);
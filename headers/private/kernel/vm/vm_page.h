@@ -44,6 +44,7 @@ status_t vm_mark_page_inuse(page_num_t page);
 status_t vm_mark_page_range_inuse(page_num_t startPage, page_num_t length);
 void vm_page_free_etc(VMCache* cache, vm_page* page,
 	vm_page_reservation* reservation);
+uint32 vm_page_free_cached_pages(void);
 
 void vm_page_set_state(struct vm_page *page, int state);
 void vm_page_requeue(struct vm_page *page, bool tail);
@@ -19,7 +19,6 @@
 #include <lock.h>
 #include <util/DoublyLinkedList.h>
 #include <util/DoublyLinkedQueue.h>
-#include <util/SplayTree.h>
 
 #include <sys/uio.h>
 
@@ -125,7 +124,6 @@ public:
 								// TODO: Only 32 bit on 32 bit platforms!
 								// Introduce a new 64 bit type page_off_t!
 
-	SplayTreeLink<vm_page>	cache_link;
 	vm_page*				cache_next;
 
 	vm_page_mappings		mappings;
@@ -149,7 +147,8 @@ public:
 	bool					busy_writing : 1;
 	bool					accessed : 1;
 	bool					modified : 1;
-	uint8					_unused : 1;
+	bool					cpu_cached : 1;
+							// free page held by a per-CPU page cache
 
 	uint8					usage_count;
 
@@ -197,6 +196,8 @@ enum {
 #define VM_PAGE_ALLOC_STATE	0x00000007
 #define VM_PAGE_ALLOC_CLEAR	0x00000010
 #define VM_PAGE_ALLOC_BUSY	0x00000020
+#define VM_PAGE_ALLOC_DONT_WAIT	0x00000040
+	// vm_page_allocate_page_run() only: fail instead of waiting for pages
 
 
 inline void
@@ -209,7 +210,7 @@ vm_page::Init(page_num_t pageNumber)
 	InitState(PAGE_STATE_FREE);
 	busy = busy_writing = false;
 	accessed = modified = false;
-	_unused = 0;
+	cpu_cached = false;
 	usage_count = 0;
 
 	fWiredCount = 0;
@@ -50,6 +50,9 @@ typedef struct _pthread_attr {
 	size_t		stack_size;
 	size_t		guard_size;
 	void		*stack_address;
+	bigtime_t	deadline_runtime;
+	bigtime_t	deadline;
+	bigtime_t	deadline_period;
 } pthread_attr;
 
 typedef struct _pthread_rwlockattr {
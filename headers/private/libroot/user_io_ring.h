@@ -0,0 +1,169 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _LIBROOT_USER_IO_RING_H
+#define _LIBROOT_USER_IO_RING_H
+
+
+#include <string.h>
+#include <sys/uio.h>
+
+#include <io_ring_defs.h>
+
+
+typedef struct io_ring {
+	int				fd;
+	area_id			area;
+	io_ring_queue*	sq;
+	io_ring_queue*	cq;
+	io_ring_sqe*	sqes;
+	io_ring_cqe*	cqes;
+	uint32			sq_tail;
+		// entries up to here have been handed out by io_ring_get_sqe()
+} io_ring;
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+status_t	io_ring_init(io_ring* ring, uint32 entries, uint32 flags);
+void		io_ring_exit(io_ring* ring);
+
+io_ring_sqe* io_ring_get_sqe(io_ring* ring);
+ssize_t		io_ring_submit(io_ring* ring);
+ssize_t		io_ring_submit_and_wait(io_ring* ring, uint32 waitCount);
+
+status_t	io_ring_peek_cqe(io_ring* ring, io_ring_cqe** _cqe);
+status_t	io_ring_wait_cqe(io_ring* ring, io_ring_cqe** _cqe);
+status_t	io_ring_wait_cqe_etc(io_ring* ring, io_ring_cqe** _cqe,
+				uint32 flags, bigtime_t timeout);
+void		io_ring_cqe_seen(io_ring* ring, io_ring_cqe* cqe);
+
+status_t	io_ring_register_buffers(io_ring* ring, const struct iovec* vecs,
+				uint32 count);
+status_t	io_ring_unregister_buffers(io_ring* ring);
+status_t	io_ring_register_files(io_ring* ring, const int* fds,
+				uint32 count);
+status_t	io_ring_unregister_files(io_ring* ring);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+static inline void
+io_ring_prep_rw(io_ring_sqe* sqe, uint8 opcode, int fd, const void* address,
+	uint32 length, off_t offset)
+{
+	memset(sqe, 0, sizeof(io_ring_sqe));
+	sqe->opcode = opcode;
+	sqe->fd = fd;
+	sqe->address = (addr_t)address;
+	sqe->length = length;
+	sqe->offset = offset;
+}
+
+
+static inline void
+io_ring_prep_nop(io_ring_sqe* sqe)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_NOP, -1, NULL, 0, 0);
+}
+
+
+static inline void
+io_ring_prep_read(io_ring_sqe* sqe, int fd, void* buffer, uint32 length,
+	off_t offset)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_READ, fd, buffer, length, offset);
+}
+
+
+static inline void
+io_ring_prep_write(io_ring_sqe* sqe, int fd, const void* buffer,
+	uint32 length, off_t offset)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_WRITE, fd, buffer, length, offset);
+}
+
+
+static inline void
+io_ring_prep_readv(io_ring_sqe* sqe, int fd, const struct iovec* vecs,
+	uint32 count, off_t offset)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_READV, fd, vecs, count, offset);
+}
+
+
+static inline void
+io_ring_prep_writev(io_ring_sqe* sqe, int fd, const struct iovec* vecs,
+	uint32 count, off_t offset)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_WRITEV, fd, vecs, count, offset);
+}
+
+
+static inline void
+io_ring_prep_read_fixed(io_ring_sqe* sqe, int fd, void* buffer,
+	uint32 length, off_t offset, uint16 bufferIndex)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_READ_FIXED, fd, buffer, length, offset);
+	sqe->buffer_index = bufferIndex;
+}
+
+
+static inline void
+io_ring_prep_write_fixed(io_ring_sqe* sqe, int fd, const void* buffer,
+	uint32 length, off_t offset, uint16 bufferIndex)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_WRITE_FIXED, fd, buffer, length, offset);
+	sqe->buffer_index = bufferIndex;
+}
+
+
+static inline void
+io_ring_prep_fsync(io_ring_sqe* sqe, int fd)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_FSYNC, fd, NULL, 0, 0);
+}
+
+
+static inline void
+io_ring_prep_poll(io_ring_sqe* sqe, int fd, uint32 events)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_POLL, fd, NULL, 0, 0);
+	sqe->op_flags = events;
+}
+
+
+static inline void
+io_ring_prep_accept(io_ring_sqe* sqe, int fd, uint32 flags)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_ACCEPT, fd, NULL, 0, 0);
+	sqe->op_flags = flags;
+}
+
+
+static inline void
+io_ring_prep_recv(io_ring_sqe* sqe, int fd, void* buffer, uint32 length,
+	uint32 flags)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_RECV, fd, buffer, length, 0);
+	sqe->op_flags = flags;
+}
+
+
+static inline void
+io_ring_prep_send(io_ring_sqe* sqe, int fd, const void* buffer,
+	uint32 length, uint32 flags)
+{
+	io_ring_prep_rw(sqe, IO_RING_OP_SEND, fd, buffer, length, 0);
+	sqe->op_flags = flags;
+}
+
+
+#endif	/* _LIBROOT_USER_IO_RING_H */
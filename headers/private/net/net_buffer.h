@@ -74,6 +74,9 @@ struct net_buffer_module_info {
 	status_t		(*trim)(net_buffer* buffer, size_t newSize);
 	status_t		(*append_cloned)(net_buffer* buffer, net_buffer* source,
 						uint32 offset, size_t bytes);
+	status_t		(*append_external)(net_buffer* buffer, const void* data,
+						size_t bytes, void (*release)(void* cookie),
+						void* cookie);
 
 	status_t		(*associate_data)(net_buffer* buffer, void* data);
 
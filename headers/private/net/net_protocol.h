@@ -114,6 +114,9 @@ struct net_protocol_module_info {
 					size_t vecCount, ancillary_data_container** _ancillaryData,
 					struct sockaddr* _address, socklen_t* _addressLength,
 					int flags);
+
+	status_t	(*accept_etc)(net_protocol* self,
+					net_socket** _acceptedSocket, int flags);
 };
 
 
@@ -92,7 +92,8 @@ struct net_socket_module_info {
 
 	// standard socket API
 	int			(*accept)(net_socket* socket, struct sockaddr* address,
-					socklen_t* _addressLength, net_socket** _acceptedSocket);
+					socklen_t* _addressLength, net_socket** _acceptedSocket,
+					int flags);
 	int			(*bind)(net_socket* socket, const struct sockaddr* address,
 					socklen_t addressLength);
 	int			(*connect)(net_socket* socket, const struct sockaddr* address,
@@ -108,6 +109,9 @@ struct net_socket_module_info {
 					size_t length, int flags);
 	ssize_t		(*send)(net_socket* socket, struct msghdr* , const void* data,
 					size_t length, int flags);
+	ssize_t		(*send_external)(net_socket* socket, const struct iovec* vecs,
+					size_t vecCount, int flags, void (*release)(void* cookie),
+					void* cookie);
 	int			(*setsockopt)(net_socket* socket, int level, int option,
 					const void* optionValue, int optionLength);
 	int			(*shutdown)(net_socket* socket, int direction);
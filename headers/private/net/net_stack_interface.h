@@ -35,7 +35,8 @@ struct net_stack_interface_module_info {
 					socklen_t addressLength);
 	status_t (*listen)(net_socket* socket, int backlog);
 	status_t (*accept)(net_socket* socket, struct sockaddr* address,
-					socklen_t* _addressLength, net_socket** _acceptedSocket);
+					socklen_t* _addressLength, net_socket** _acceptedSocket,
+					int flags);
 
 	ssize_t (*recv)(net_socket* socket, void* data, size_t length, int flags);
 	ssize_t (*recvfrom)(net_socket* socket, void* data, size_t length,
@@ -50,6 +51,9 @@ struct net_stack_interface_module_info {
 					socklen_t addressLength);
 	ssize_t (*sendmsg)(net_socket* socket, const struct msghdr* message,
 					int flags);
+	ssize_t (*send_external)(net_socket* socket, const struct iovec* vecs,
+					size_t vecCount, int flags,
+					void (*release)(void* cookie), void* cookie);
 
 	status_t (*getsockopt)(net_socket* socket, int level, int option,
 					void* value, socklen_t* _length);
@@ -6,6 +6,12 @@
 #define _SYSTEM_EVENT_QUEUE_DEFS_H
 
 
+#include <SupportDefs.h>
+
+
+#define EVENT_QUEUE_MAX_RING_ENTRIES	65536
+
+
 // extends B_EVENT_* constants defined in OS.h
 enum {
 	B_EVENT_LEVEL_TRIGGERED		= (1 << 26),	/* Event is level-triggered, not edge-triggered */
@@ -15,6 +21,13 @@ enum {
 };
 
 
+// _kern_event_queue_wait() flags, in addition to the timeout flags
+enum {
+	B_EVENT_QUEUE_WAIT_EXCLUSIVE	= (1 << 16),	/* Only one exclusive waiter is woken per batch of events */
+	B_EVENT_QUEUE_WAIT_RING			= (1 << 17),	/* Return the events in the queue's ring */
+};
+
+
 typedef struct event_wait_info {
 	int32		object;
 	uint16		type;
@@ -23,4 +36,18 @@ typedef struct event_wait_info {
 } event_wait_info;
 
 
+/*	The optional event ring is an area shared between the kernel and the team
+	that set it up. The kernel adds ready events at the tail, userland
+	consumes them at the head. Each side only ever writes the index it owns.
+	The entries follow the header.
+*/
+typedef struct event_queue_ring {
+	uint32		head;
+	uint32		tail;
+	uint32		mask;
+	uint32		entries;
+	uint32		_reserved[4];
+} event_queue_ring;
+
+
 #endif	/* _SYSTEM_EVENT_QUEUE_DEFS_H */
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _SYSTEM_IO_RING_DEFS_H
+#define _SYSTEM_IO_RING_DEFS_H
+
+
+#include <OS.h>
+
+
+/*	An I/O ring consists of a submission queue (SQ) and a completion queue
+	(CQ) in an area shared between the kernel and the team. Userland fills in
+	submission entries and advances the SQ tail; the kernel consumes them in
+	_kern_io_ring_enter() and advances the SQ head. Completion entries are
+	produced by the kernel at the CQ tail and consumed by userland at the CQ
+	head. Each side only ever writes the index it owns.
+*/
+
+
+#define IO_RING_MAX_ENTRIES			4096
+#define IO_RING_MAX_BUFFERS			1024
+#define IO_RING_MAX_FILES			1024
+
+
+// operations
+enum {
+	IO_RING_OP_NOP			= 0,
+	IO_RING_OP_READ,		// address, length, offset (-1: file position)
+	IO_RING_OP_WRITE,
+	IO_RING_OP_READV,		// address: iovec array, length: count
+	IO_RING_OP_WRITEV,
+	IO_RING_OP_READ_FIXED,	// address in registered buffer[buffer_index]
+	IO_RING_OP_WRITE_FIXED,
+	IO_RING_OP_FSYNC,
+	IO_RING_OP_POLL,		// op_flags: B_EVENT_* mask; result: events
+	IO_RING_OP_ACCEPT,		// op_flags: SOCK_* flags; result: new fd
+	IO_RING_OP_RECV,		// op_flags: MSG_* flags
+	IO_RING_OP_SEND,
+
+	IO_RING_OP_COUNT
+};
+
+// io_ring_sqe::flags
+enum {
+	IO_RING_SQE_FIXED_FILE	= 0x01,	// fd is an index into the registered files
+};
+
+// _kern_io_ring_enter() flags
+enum {
+	IO_RING_ENTER_GETEVENTS	= 0x100,
+		// wait for min_complete completions; can be combined with
+		// B_RELATIVE_TIMEOUT or B_ABSOLUTE_TIMEOUT
+};
+
+// _kern_io_ring_register() operations
+enum {
+	IO_RING_REGISTER_BUFFERS = 0,	// args: iovec array
+	IO_RING_UNREGISTER_BUFFERS,
+	IO_RING_REGISTER_FILES,			// args: int array
+	IO_RING_UNREGISTER_FILES,
+};
+
+
+typedef struct io_ring_sqe {
+	uint8		opcode;
+	uint8		flags;
+	uint16		buffer_index;
+	int32		fd;
+	off_t		offset;
+	uint64		address;
+	uint32		length;
+	uint32		op_flags;
+	uint64		user_data;
+} io_ring_sqe;
+
+typedef struct io_ring_cqe {
+	uint64		user_data;
+	int32		result;		// transferred bytes, new fd, events, or error
+	uint32		flags;
+} io_ring_cqe;
+
+typedef struct io_ring_queue {
+	uint32		head;
+	uint32		tail;
+	uint32		mask;
+	uint32		entries;
+	uint32		overflow;
+		// CQ only: completions that are still waiting for room in the ring
+	uint32		_reserved[3];
+} io_ring_queue;
+
+typedef struct io_ring_params {
+	// in
+	uint32		sq_entries;
+	uint32		cq_entries;		// 0 for twice the SQ entries
+	uint32		flags;
+
+	// out
+	area_id		area;
+	void*		address;
+	size_t		size;
+	uint32		sq_offset;		// of the io_ring_queue structures
+	uint32		cq_offset;
+	uint32		sqes_offset;	// of the entry arrays
+	uint32		cqes_offset;
+} io_ring_params;
+
+
+#endif	/* _SYSTEM_IO_RING_DEFS_H */
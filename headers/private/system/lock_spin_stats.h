@@ -0,0 +1,28 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _SYSTEM_LOCK_SPIN_STATS_H
+#define _SYSTEM_LOCK_SPIN_STATS_H
+
+#include <OS.h>
+
+
+#define LOCK_SPIN_STATS					"lock spin stats"
+#define GET_LOCK_SPIN_STATS				0x01
+#define SET_LOCK_SPIN_BUDGET			0x02
+
+
+typedef struct lock_spin_stats {
+	bigtime_t	spin_budget;
+		// maximum time a contending thread spins before blocking
+	int64		mutex_spin_acquired;
+		// contended mutex acquisitions that didn't need to block
+	int64		mutex_blocked;
+		// contended mutex acquisitions that blocked
+	int64		rw_lock_read_spin_acquired;
+	int64		rw_lock_read_blocked;
+} lock_spin_stats;
+
+
+#endif	/* _SYSTEM_LOCK_SPIN_STATS_H */
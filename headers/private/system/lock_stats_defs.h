@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _SYSTEM_LOCK_STATS_DEFS_H
+#define _SYSTEM_LOCK_STATS_DEFS_H
+
+#include <OS.h>
+
+
+#define LOCK_STATS_SYSCALLS				"lock stats"
+
+#define LOCK_STATS_ENABLE				0x01
+#define LOCK_STATS_DISABLE				0x02
+#define LOCK_STATS_GET					0x03
+	// copies the collected entries and resets them
+
+// lock types
+enum {
+	LOCK_STATS_MUTEX			= 0,
+	LOCK_STATS_RECURSIVE_LOCK,
+	LOCK_STATS_RW_LOCK_READ,
+	LOCK_STATS_RW_LOCK_WRITE,
+	LOCK_STATS_SPINLOCK,
+
+	LOCK_STATS_TYPE_COUNT
+};
+
+// what lock_stats_entry::lock identifies a lock by
+enum {
+	LOCK_STATS_KEY_NAME		= 0,
+		// a hash of the name string; all locks of the same name share entries
+	LOCK_STATS_KEY_ADDRESS
+		// the lock's address; used for spinlocks and unnamed locks
+};
+
+// The wait time histogram has logarithmic buckets: bucket 0 covers waits
+// shorter than 2^LOCK_STATS_HISTOGRAM_SHIFT ns, bucket i (i > 0) covers
+// [2^(i + shift - 1), 2^(i + shift)) ns, the last one everything above.
+#define LOCK_STATS_HISTOGRAM_SHIFT		8
+#define LOCK_STATS_HISTOGRAM_BUCKETS	24
+
+#define LOCK_STATS_SYMBOL_LENGTH		64
+
+
+typedef struct lock_stats_entry {
+	char		name[B_OS_NAME_LENGTH];
+		// lock name, or the symbol of the lock for spinlocks
+	char		caller[LOCK_STATS_SYMBOL_LENGTH];
+		// symbol of the call site acquiring the lock
+	addr_t		caller_address;
+	addr_t		lock;
+		// the lock's identity, see key
+	uint32		type;
+	uint32		key;
+		// LOCK_STATS_KEY_{NAME,ADDRESS}
+
+	int64		acquisitions;
+	int64		contentions;
+	nanotime_t	total_wait;
+	nanotime_t	max_wait;
+	int64		hold_count;
+	nanotime_t	total_hold;
+	nanotime_t	max_hold;
+	uint32		wait_histogram[LOCK_STATS_HISTOGRAM_BUCKETS];
+} lock_stats_entry;
+
+
+typedef struct lock_stats_get_args {
+	lock_stats_entry*	entries;
+	int32				count;
+		// in: capacity of entries, out: number of entries returned
+	int32				dropped;
+		// number of events that didn't fit into the kernel's tables
+} lock_stats_get_args;
+
+
+#endif	/* _SYSTEM_LOCK_STATS_DEFS_H */
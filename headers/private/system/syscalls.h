@@ -28,6 +28,7 @@ struct fd_info;
 struct fd_set;
 struct fs_info;
 struct iovec;
+struct io_ring_params;
 struct msqid_ds;
 struct net_stat;
 struct pollfd;
@@ -41,10 +42,13 @@ struct signal_frame_data;
 struct stat;
 struct system_profiler_parameters;
 struct user_timer_info;
+struct vm_compressed_swap_stats;
+struct vm_large_page_stats;
 
 struct disk_device_job_progress_info;
 struct partitionable_space_data;
 struct thread_creation_attributes;
+struct thread_deadline_params;
 struct user_disk_device_data;
 struct user_disk_device_job_info;
 struct user_disk_system_info;
@@ -80,6 +84,14 @@ extern status_t		_kern_event_queue_select(int queue,
 						struct event_wait_info* userInfos, int numInfos);
 extern ssize_t		_kern_event_queue_wait(int queue, struct event_wait_info* infos,
 						int numInfos, uint32 flags, bigtime_t timeout);
+extern area_id		_kern_event_queue_setup_ring(int queue, uint32 entries,
+						void** _address);
+
+extern int			_kern_io_ring_setup(struct io_ring_params* params);
+extern ssize_t		_kern_io_ring_enter(int ring, uint32 toSubmit,
+						uint32 minComplete, uint32 flags, bigtime_t timeout);
+extern status_t		_kern_io_ring_register(int ring, uint32 operation,
+						const void* args, uint32 count);
 
 /* user mutex functions */
 extern status_t		_kern_mutex_lock(int32* mutex, const char* name,
@@ -213,6 +225,11 @@ extern bigtime_t	_kern_estimate_max_scheduling_latency(thread_id thread);
 extern status_t		_kern_set_scheduler_mode(int32 mode);
 extern int32		_kern_get_scheduler_mode(void);
 
+extern status_t		_kern_set_thread_deadline(thread_id thread,
+						const struct thread_deadline_params* params);
+extern status_t		_kern_get_thread_deadline(thread_id thread,
+						struct thread_deadline_params* params);
+
 // user/group functions
 extern gid_t		_kern_getgid(bool effective);
 extern uid_t		_kern_getuid(bool effective);
@@ -336,6 +353,8 @@ extern ssize_t		_kern_write(int fd, off_t pos, const void *buffer,
 						size_t bufferSize);
 extern ssize_t		_kern_writev(int fd, off_t pos, const struct iovec *vecs,
 						size_t count);
+extern ssize_t		_kern_splice(int inFD, off_t *inOffset, int outFD,
+						off_t *outOffset, size_t length, uint32 flags);
 extern status_t		_kern_ioctl(int fd, uint32 cmd, void *data, size_t length);
 extern ssize_t		_kern_read_dir(int fd, struct dirent *buffer,
 						size_t bufferSize, uint32 maxCount);
@@ -353,6 +372,8 @@ extern status_t		_kern_unlock_node(int fd);
 extern status_t		_kern_get_next_fd_info(team_id team, uint32 *_cookie,
 						struct fd_info *info, size_t infoSize);
 extern status_t		_kern_preallocate(int fd, off_t offset, off_t length);
+extern status_t		_kern_file_advice(int fd, off_t offset, off_t length,
+						int advice);
 
 // socket functions
 extern int			_kern_socket(int family, int type, int protocol);
@@ -466,6 +487,11 @@ extern status_t		_kern_get_memory_properties(team_id teamID,
 extern status_t		_kern_mlock(const void* address, size_t size);
 extern status_t		_kern_munlock(const void* address, size_t size);
 
+extern status_t		_kern_get_large_page_stats(
+						struct vm_large_page_stats* stats);
+extern status_t		_kern_get_compressed_swap_stats(
+						struct vm_compressed_swap_stats* stats);
+
 /* kernel port functions */
 extern port_id		_kern_create_port(int32 queue_length, const char *name);
 extern status_t		_kern_close_port(port_id id);
@@ -490,6 +516,14 @@ extern status_t		_kern_writev_port_etc(port_id id, int32 msgCode,
 extern status_t		_kern_get_port_message_info_etc(port_id port,
 						port_message_info *info, size_t infoSize, uint32 flags,
 						bigtime_t timeout);
+extern area_id		_kern_acquire_port_buffer(size_t size, void **_address);
+extern status_t		_kern_release_port_buffer(area_id buffer);
+extern ssize_t		_kern_read_port_buffer_etc(port_id port, int32 *msgCode,
+						area_id *_buffer, void **_address, uint32 flags,
+						bigtime_t timeout);
+extern status_t		_kern_write_port_buffer_etc(port_id port, int32 msgCode,
+						area_id buffer, size_t bufferSize, uint32 flags,
+						bigtime_t timeout);
 
 // debug support functions
 extern status_t		_kern_kernel_debugger(const char *message);
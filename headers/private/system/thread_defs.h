@@ -53,4 +53,14 @@ struct thread_creation_attributes {
 	uint32		flags;
 };
 
+
+// A thread with a deadline reservation is guaranteed to get \c runtime us of
+// CPU time within \c deadline us after the start of each \c period. A
+// \c runtime of 0 means the thread has no reservation.
+struct thread_deadline_params {
+	bigtime_t	runtime;
+	bigtime_t	deadline;
+	bigtime_t	period;
+};
+
 #endif	/* _SYSTEM_THREAD_DEFS_H */
@@ -31,6 +31,12 @@ struct fd_info {
 /* pipe/FIFO buffer capacity */
 #define VFS_FIFO_BUFFER_CAPACITY	(64 * 1024)
 
+/* splice() flags */
+#define VFS_SPLICE_MOVE				0x01
+#define VFS_SPLICE_NONBLOCK			0x02
+#define VFS_SPLICE_MORE				0x04
+#define VFS_SPLICE_GIFT				0x08
+
 // make sure the constant values are sane
 #if VFS_FIFO_ATOMIC_WRITE_SIZE < _POSIX_PIPE_BUF
 #	error VFS_FIFO_ATOMIC_WRITE_SIZE < _POSIX_PIPE_BUF!
@@ -46,5 +46,35 @@ enum {
 
 #define MEMORY_TYPE_SHIFT		28
 
+// statistics returned by _kern_get_large_page_stats()
+struct vm_large_page_stats {
+	size_t		page_size;		// 0, if large pages are not supported
+	int64		mapped;			// large pages currently mapped
+	int64		faults;			// faults resolved with a large page
+	int64		fallbacks;		// faults that couldn't get a large page
+	int64		promotions;		// page tables replaced by a large page
+	int64		demotions;		// large pages split into page tables
+};
+
+// statistics returned by _kern_get_compressed_swap_stats()
+struct vm_compressed_swap_stats {
+	uint64		pool_size;			// maximum size of the compressed data
+	uint64		pool_used;			// current size of the compressed data
+	int64		stored_pages;		// pages currently stored, including:
+	int64		same_filled_pages;	// - pages stored without any data
+	int64		written_back_pages;	// - pages moved to the backing store
+	uint64		uncompressed_bytes;	// size of the compressed pages, and
+	uint64		compressed_bytes;	// what they have been compressed to
+	int64		stores;				// pages stored
+	int64		rejected_stores;	// pages that could not be stored
+	int64		write_throughs;		// pages stored in the backing store
+									// right away
+	int64		write_backs;		// pages moved to the backing store later
+	int64		loads;				// pages read
+	int64		backing_loads;		// pages read from the backing store
+	bigtime_t	total_load_time;	// time spent reading pages
+	bigtime_t	max_load_time;		// longest time spent reading a page
+};
+
 
 #endif	/* _SYSTEM_VM_DEFS_H */
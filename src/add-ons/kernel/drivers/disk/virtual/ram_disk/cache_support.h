@@ -61,6 +61,12 @@ cache_get_pages(VMCache* cache, off_t offset, off_t length, bool isWrite, vm_pag
 static void
 cache_put_pages(VMCache* cache, off_t offset, off_t length, vm_page** pages, bool success)
 {
+	VMCachePagesTreePreload preload;
+	if (success) {
+		preload.Preload(VMCachePagesTreePreload::NodesNeeded(
+			length / B_PAGE_SIZE));
+	}
+
 	AutoLocker<VMCache> locker(cache);
 
 	// Mark all pages unbusy. On error free the newly allocated pages.
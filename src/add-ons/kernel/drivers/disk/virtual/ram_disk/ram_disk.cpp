@@ -808,6 +808,9 @@ private:
 			// Add pages to cache. Ignore clear pages, though. Move those to the
 			// beginning of the array, so we can reuse them in the next
 			// iteration.
+			VMCachePagesTreePreload preload;
+			preload.Preload(VMCachePagesTreePreload::NodesNeeded(pagesRead));
+
 			AutoLocker<VMCache> locker(fCache);
 
 			size_t clearPages = 0;
@@ -1,12 +1,21 @@
 /*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
  * Copyright 2005, Axel Dörfler, axeld@pinc-software.de. All rights reserved.
  * Distributed under the terms of the MIT License.
  */
 
-/** This module memorizes all opened files for a certain session. A session
- *	can be the start of an application or the boot process.
- *	When a session is started, it will prefetch all files from an earlier
- *	session in order to speed up the launching or booting process.
+/** This module records which parts of which files are used by a certain
+ *	session. A session can be the start of an application or the boot
+ *	process.
+ *	The extents a session used are merged into a persistent profile, one per
+ *	executable, and one per named session (like the boot process). When a
+ *	session is started, the extents of its profile are read in
+ *	asynchronously in order to speed up the launching or booting process.
+ *
+ *	Every extent of a profile has a score that is raised whenever a session
+ *	uses the extent, and lowered whenever one doesn't. Only extents with a
+ *	sufficient score are prefetched, so a profile represents what the last
+ *	few sessions had in common, and doesn't grow indefinitely.
  *
  *	Note: this module is using private kernel API and is definitely not
  *		meant to be an example on how to write modules.
@@ -18,28 +27,31 @@
 #include <KernelExport.h>
 #include <Node.h>
 
+#include <AutoDeleter.h>
 #include <util/kernel_cpp.h>
 #include <util/AutoLock.h>
+#include <util/OpenHashTable.h>
 #include <thread.h>
 #include <team.h>
 #include <file_cache.h>
 #include <generic_syscall.h>
 #include <syscalls.h>
+#include <vfs.h>
 
+#include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <errno.h>
 #include <ctype.h>
+#include <sys/stat.h>
 
 extern dev_t gBootDevice;
 
 
-// ToDo: combine the last 3-5 sessions to their intersection
-// ToDo: maybe ignore sessions if the node count is < 3 (without system libs)
-
-#define TRACE_CACHE_MODULE
+//#define TRACE_CACHE_MODULE
 #ifdef TRACE_CACHE_MODULE
 #	define TRACE(x) dprintf x
 #else
@@ -49,18 +61,61 @@ extern dev_t gBootDevice;
 #define VNODE_HASH(mountid, vnodeid) (((uint32)((vnodeid) >> 32) \
 	+ (uint32)(vnodeid)) ^ (uint32)(mountid))
 
+
+static const char* const kProfileDirectory
+	= "/boot/system/cache/launch_speedup";
+static const char* const kBootSessionName = "system boot";
+
+static const uint32 kProfileMagic = 'LSpf';
+static const uint32 kProfileVersion = 1;
+static const off_t kMaxProfileSize = 1024 * 1024;
+
+static const int32 kMaxNodeParts = 16;
+	// extents recorded per node in a session
+static const off_t kPartGap = 64 * 1024;
+	// accesses closer to each other than this end up in the same extent
+static const int32 kMaxSessionNodes = 4096;
+
+static const uint8 kUsedScore = 2;
+	// added to the score of an extent when a session uses it
+static const uint8 kMaxScore = 8;
+static const uint8 kMinPrefetchScore = 2;
+
+static const int32 kAppSessionSeconds = 30;
+static const int32 kBootSessionSeconds = 120;
+
+
+// on-disk format of a profile
+
+struct profile_header {
+	uint32		magic;
+	uint32		version;
+	uint32		extent_count;
+	uint32		session_count;
+};
+
+struct profile_extent {
+	ino_t		node;
+	off_t		offset;
+	uint32		length;
+		// 0 if only the node itself has been used
+	dev_t		device;
+	uint8		score;
+	uint8		_reserved[7];
+};
+
+
 struct data_part {
 	off_t		offset;
-	off_t		size;
+	off_t		end;
 };
 
 struct node {
 	struct node	*next;
 	node_ref	ref;
 	int32		ref_count;
-	bigtime_t	timestamp;
-	data_part	parts[5];
-	size_t		part_count;
+	data_part	parts[kMaxNodeParts];
+	int32		part_count;
 };
 
 struct NodeHash {
@@ -90,11 +145,40 @@ struct NodeHash {
 
 typedef BOpenHashTable<NodeHash> NodeTable;
 
+class Profile {
+	public:
+		Profile(const char *name, const node_ref &ref);
+		~Profile();
+
+		const char *Name() const { return fName; }
+		const node_ref &NodeRef() const { return fNodeRef; }
+		bool IsMainProfile() const { return fNodeRef.node == -1; }
+		const profile_extent *Extents() const { return fExtents; }
+		int32 CountExtents() const { return fExtentCount; }
+		uint32 CountSessions() const { return fSessionCount; }
+
+		void SetExtents(profile_extent *extents, int32 count,
+			uint32 sessionCount);
+
+		status_t Load(const char *path);
+		status_t Save() const;
+		void Prefetch() const;
+
+		Profile *&Next() { return fNext; }
+
+	private:
+		Profile			*fNext;
+		char			fName[B_OS_NAME_LENGTH];
+		node_ref		fNodeRef;
+		profile_extent	*fExtents;
+		int32			fExtentCount;
+		uint32			fSessionCount;
+};
+
 class Session {
 	public:
-		Session(team_id team, const char *name, dev_t device,
-			ino_t node, int32 seconds);
-		Session(const char *name);
+		Session(team_id team, const char *name, const node_ref &ref,
+			int32 seconds);
 		~Session();
 
 		status_t InitCheck();
@@ -102,12 +186,14 @@ class Session {
 		const char *Name() const { return fName; }
 		const node_ref &NodeRef() const { return fNodeRef; }
 		bool IsActive() const { return fActiveUntil >= system_time(); }
-		bool IsClosing() const { return fClosing; }
-		bool IsMainSession() const;
+		bool IsMainSession() const { return fNodeRef.node == -1; }
 		bool IsWorthSaving() const;
+		bigtime_t Duration() const { return system_time() - fTimestamp; }
+		int32 CountNodes() const { return fNodeCount; }
 
 		void AddNode(dev_t device, ino_t node);
 		void RemoveNode(dev_t device, ino_t node);
+		void AddAccess(dev_t device, ino_t node, off_t offset, size_t size);
 
 		void Lock() { mutex_lock(&fLock); }
 		void Unlock() { mutex_unlock(&fLock); }
@@ -115,26 +201,23 @@ class Session {
 		status_t StartWatchingTeam();
 		void StopWatchingTeam();
 
-		status_t LoadFromDirectory(int fd);
-		status_t Save();
-		void Prefetch();
+		Profile *CreateProfile(const Profile *previous);
 
 		Session *&Next() { return fNext; }
 
 	private:
 		struct node *_FindNode(dev_t device, ino_t node);
+		struct node *_AddNode(dev_t device, ino_t node);
 
 		Session		*fNext;
 		char		fName[B_OS_NAME_LENGTH];
 		mutex		fLock;
 		NodeTable	*fNodeHash;
-		struct node	*fNodes;
 		int32		fNodeCount;
 		team_id		fTeam;
 		node_ref	fNodeRef;
 		bigtime_t	fActiveUntil;
 		bigtime_t	fTimestamp;
-		bool		fClosing;
 		bool		fIsWatchingTeam;
 };
 
@@ -143,20 +226,15 @@ class SessionGetter {
 		SessionGetter(team_id team, Session **_session);
 		~SessionGetter();
 
-		status_t New(const char *name, dev_t device, ino_t node,
-					Session **_session);
-		void Stop();
-
 	private:
 		Session	*fSession;
 };
 
-static Session *sMainSession;
-static SessionTable *sTeamHash;
-static PrefetchTable *sPrefetchHash;
-static Session *sMainPrefetchSessions;
-	// singly-linked list
-static recursive_lock sLock;
+struct prefetch_job {
+	char			name[B_OS_NAME_LENGTH];
+	int32			count;
+	profile_extent	extents[0];
+};
 
 
 node_ref::node_ref()
@@ -165,9 +243,9 @@ node_ref::node_ref()
 }
 
 
-struct PrefetchHash {
+struct ProfileHash {
 	typedef node_ref	KeyType;
-	typedef	Session		ValueType;
+	typedef	Profile		ValueType;
 
 	size_t HashKey(KeyType key) const
 	{
@@ -179,10 +257,10 @@ struct PrefetchHash {
 		return HashKey(value->NodeRef());
 	}
 
-	bool Compare(KeyType key, ValueType* session) const
+	bool Compare(KeyType key, ValueType* profile) const
 	{
-		return (session->NodeRef().device == key.device
-			&& session->NodeRef().node == key.node);
+		return (profile->NodeRef().device == key.device
+			&& profile->NodeRef().node == key.node);
 	}
 
 	ValueType*& GetLink(ValueType* value) const
@@ -191,7 +269,7 @@ struct PrefetchHash {
 	}
 };
 
-typedef BOpenHashTable<PrefetchHash> PrefetchTable;
+typedef BOpenHashTable<ProfileHash> ProfileTable;
 
 
 struct SessionHash {
@@ -210,7 +288,7 @@ struct SessionHash {
 
 	bool Compare(KeyType key, ValueType* session) const
 	{
-		return session->Team == key;
+		return session->Team() == key;
 	}
 
 	ValueType*& GetLink(ValueType* value) const
@@ -222,6 +300,242 @@ struct SessionHash {
 typedef BOpenHashTable<SessionHash> SessionTable;
 
 
+static Session *sMainSession;
+static SessionTable *sTeamHash;
+static int32 sTeamSessionCount;
+static ProfileTable *sProfileHash;
+static Profile *sMainProfiles;
+	// singly-linked list
+static bool sWaitingForBoot;
+static mutex sLock;
+	// protects the hash tables, the main session, and the profiles
+static rw_lock sSessionLock;
+	// also protects the main session and the team hash, so that the file
+	// cache hooks only need to read lock it to find their session instead of
+	// serializing all I/O on sLock; changes need both locks
+static mutex sSaveLock;
+	// serializes saving sessions; the hooks can be called with file system
+	// locks held, so sLock must not be held while writing a profile
+
+
+static int
+compare_extents(const void *_a, const void *_b)
+{
+	const profile_extent *a = (const profile_extent *)_a;
+	const profile_extent *b = (const profile_extent *)_b;
+
+	if (a->device != b->device)
+		return a->device < b->device ? -1 : 1;
+	if (a->node != b->node)
+		return a->node < b->node ? -1 : 1;
+	if (a->length == 0 || b->length == 0) {
+		// the entry for the node itself comes first
+		if (a->length != b->length)
+			return a->length == 0 ? -1 : 1;
+	}
+	if (a->offset != b->offset)
+		return a->offset < b->offset ? -1 : 1;
+	return 0;
+}
+
+
+/*!	Reads the extents of the job in the background. The extents are sorted
+	by node and offset, and inode numbers roughly correspond to the location
+	on disk, so the requests arrive in disk order for the most part.
+*/
+static status_t
+prefetch_thread(void *_job)
+{
+	prefetch_job *job = (prefetch_job *)_job;
+#ifdef TRACE_CACHE_MODULE
+	bigtime_t startTime = system_time();
+#endif
+
+	struct vnode *vnode = NULL;
+	int32 nodeCount = 0;
+	off_t bytes = 0;
+
+	for (int32 i = 0; i < job->count; i++) {
+		const profile_extent &extent = job->extents[i];
+
+		if (i == 0 || extent.node != job->extents[i - 1].node
+			|| extent.device != job->extents[i - 1].device) {
+			if (vnode != NULL)
+				vfs_put_vnode(vnode);
+
+			// this also reads in the inode
+			if (vfs_get_vnode(extent.device, extent.node, true, &vnode)
+					!= B_OK) {
+				vnode = NULL;
+				continue;
+			}
+			nodeCount++;
+		}
+
+		if (vnode == NULL || extent.length == 0)
+			continue;
+
+		cache_prefetch_vnode(vnode, extent.offset, extent.length);
+		bytes += extent.length;
+	}
+
+	if (vnode != NULL)
+		vfs_put_vnode(vnode);
+
+	TRACE(("launch_speedup: prefetched %" B_PRId32 " nodes, %" B_PRIdOFF
+		" KB for \"%s\" in %" B_PRId64 " ms\n", nodeCount, bytes / 1024,
+		job->name, (system_time() - startTime) / 1000));
+
+	free(job);
+	return B_OK;
+}
+
+
+static status_t
+build_profile_path(char *path, size_t size, const char *name,
+	const node_ref &ref)
+{
+	ssize_t length;
+	if (ref.node == -1)
+		length = snprintf(path, size, "%s/%s", kProfileDirectory, name);
+	else {
+		length = snprintf(path, size, "%s/%" B_PRIdDEV ":%" B_PRIdINO " %s",
+			kProfileDirectory, ref.device, ref.node, name);
+	}
+
+	return length < (ssize_t)size ? B_OK : B_NAME_TOO_LONG;
+}
+
+
+static bool
+parse_node_ref(const char *string, node_ref &ref, const char **_end = NULL)
+{
+	// parse node ref
+	char *end;
+	ref.device = strtol(string, &end, 0);
+	if (end == NULL || *end != ':' || ref.device == 0)
+		return false;
+
+	ref.node = strtoull(end + 1, &end, 0);
+
+	if (_end)
+		*_end = end;
+	return true;
+}
+
+
+static void
+load_profiles()
+{
+	DIR *dir = opendir(kProfileDirectory);
+	if (dir == NULL)
+		return;
+
+	struct dirent *dirent;
+	while ((dirent = readdir(dir)) != NULL) {
+		if (dirent->d_name[0] == '.')
+			continue;
+
+		node_ref ref;
+		ref.device = -1;
+		ref.node = -1;
+
+		const char *name = dirent->d_name;
+		if (isdigit(name[0])) {
+			if (!parse_node_ref(name, ref, &name) || name[0] != ' ')
+				continue;
+			name++;
+		}
+
+		char path[B_PATH_NAME_LENGTH];
+		snprintf(path, sizeof(path), "%s/%s", kProfileDirectory,
+			dirent->d_name);
+
+		Profile *profile = new(std::nothrow) Profile(name, ref);
+		if (profile == NULL)
+			break;
+
+		if (profile->Load(path) != B_OK) {
+			delete profile;
+			continue;
+		}
+
+		if (profile->IsMainProfile()) {
+			profile->Next() = sMainProfiles;
+			sMainProfiles = profile;
+		} else
+			sProfileHash->Insert(profile);
+	}
+
+	closedir(dir);
+}
+
+
+/*!	Returns the profile for the given session. sLock must be held. */
+static Profile *
+find_profile(const char *name, const node_ref &ref)
+{
+	if (ref.node != -1)
+		return sProfileHash->Lookup(ref);
+
+	for (Profile *profile = sMainProfiles; profile != NULL;
+			profile = profile->Next()) {
+		if (!strcmp(profile->Name(), name))
+			return profile;
+	}
+
+	return NULL;
+}
+
+
+/*!	Merges the session into its profile, and writes the result to disk. */
+static void
+save_session(Session *session)
+{
+	// Profiles are only replaced here, so the new profile cannot go away
+	// while we're writing it
+	MutexLocker saveLocker(sSaveLock);
+	MutexLocker locker(sLock);
+
+	Profile *previous = find_profile(session->Name(), session->NodeRef());
+	Profile *profile = session->CreateProfile(previous);
+	if (profile == NULL)
+		return;
+
+	if (previous != NULL) {
+		if (previous->IsMainProfile()) {
+			Profile **link = &sMainProfiles;
+			while (*link != previous)
+				link = &(*link)->Next();
+			*link = previous->Next();
+		} else
+			sProfileHash->Remove(previous);
+
+		delete previous;
+	}
+
+	if (profile->IsMainProfile()) {
+		profile->Next() = sMainProfiles;
+		sMainProfiles = profile;
+	} else
+		sProfileHash->Insert(profile);
+
+	locker.Unlock();
+
+	status_t status = profile->Save();
+	if (status != B_OK) {
+		TRACE(("launch_speedup: could not save profile \"%s\": %s\n",
+			session->Name(), strerror(status)));
+	}
+
+	TRACE(("launch_speedup: session \"%s\" took %" B_PRId64 " ms, used %"
+		B_PRId32 " nodes, profile has %" B_PRId32 " extents from %" B_PRIu32
+		" sessions\n", session->Name(), session->Duration() / 1000,
+		session->CountNodes(), profile->CountExtents(),
+		profile->CountSessions()));
+}
+
+
 static void
 stop_session(Session *session)
 {
@@ -230,30 +544,50 @@ stop_session(Session *session)
 
 	TRACE(("stop_session(%s)\n", session->Name()));
 
-	if (session->IsWorthSaving())
-		session->Save();
-
 	{
-		RecursiveLocker locker(&sLock);
-
-		if (session->Team() >= B_OK)
-			sTeamHash->Remove(session);
+		MutexLocker locker(sLock);
+		WriteLocker sessionLocker(sSessionLock);
 
 		if (session == sMainSession)
 			sMainSession = NULL;
+		else if (session->Team() >= B_OK
+			&& sTeamHash->Lookup(session->Team()) == session) {
+			sTeamHash->Remove(session);
+			atomic_add(&sTeamSessionCount, -1);
+		} else {
+			// someone else is already stopping it
+			return;
+		}
 	}
 
+	// No one can find the session anymore, wait for those that still use it
+	session->Lock();
+	session->Unlock();
+
+	session->StopWatchingTeam();
+
+	if (session->IsWorthSaving())
+		save_session(session);
+
 	delete session;
 }
 
 
-static Session *
-start_session(team_id team, dev_t device, ino_t node, const char *name,
-	int32 seconds = 30)
+static void
+team_gone(team_id team, void *_session)
 {
-	RecursiveLocker locker(&sLock);
+	stop_session((Session *)_session);
+}
+
 
-	Session *session = new Session(team, name, device, node, seconds);
+/*!	Starts a new session, and prefetches what its profile contains.
+	sLock must be held.
+*/
+static Session *
+start_session(team_id team, const char *name, const node_ref &ref,
+	int32 seconds)
+{
+	Session *session = new(std::nothrow) Session(team, name, ref, seconds);
 	if (session == NULL)
 		return NULL;
 
@@ -262,119 +596,177 @@ start_session(team_id team, dev_t device, ino_t node, const char *name,
 		return NULL;
 	}
 
-	// let's see if there is a prefetch session for this session
-
-	Session *prefetchSession;
-	if (session->IsMainSession()) {
-		// search for session by name
-		for (prefetchSession = sMainPrefetchSessions;
-				prefetchSession != NULL;
-				prefetchSession = prefetchSession->Next()) {
-			if (!strcmp(prefetchSession->Name(), name)) {
-				// found session!
-				break;
-			}
-		}
-	} else {
-		// ToDo: search for session by device/node ID
-		prefetchSession = NULL;
-	}
-	if (prefetchSession != NULL) {
-		TRACE(("found prefetch session %s\n", prefetchSession->Name()));
-		prefetchSession->Prefetch();
+	// let's see if there is a profile for this session
+	Profile *profile = find_profile(session->Name(), ref);
+	if (profile != NULL) {
+		TRACE(("found profile %s\n", profile->Name()));
+		profile->Prefetch();
 	}
 
-	if (team >= B_OK)
+	WriteLocker sessionLocker(sSessionLock);
+
+	if (team >= B_OK) {
 		sTeamHash->Insert(session);
+		atomic_add(&sTeamSessionCount, 1);
+	} else
+		sMainSession = session;
 
-	session->Lock();
 	return session;
 }
 
 
-static void
-team_gone(team_id team, void *_session)
+//	#pragma mark -
+
+
+Profile::Profile(const char *name, const node_ref &ref)
+	:
+	fNext(NULL),
+	fNodeRef(ref),
+	fExtents(NULL),
+	fExtentCount(0),
+	fSessionCount(0)
 {
-	Session *session = (Session *)_session;
+	strlcpy(fName, name, B_OS_NAME_LENGTH);
+}
 
-	session->Lock();
-	stop_session(session);
+
+Profile::~Profile()
+{
+	free(fExtents);
 }
 
 
-static bool
-parse_node_ref(const char *string, node_ref &ref, const char **_end = NULL)
+void
+Profile::SetExtents(profile_extent *extents, int32 count, uint32 sessionCount)
 {
-	// parse node ref
-	char *end;
-	ref.device = strtol(string, &end, 0);
-	if (end == NULL || ref.device == 0)
-		return false;
+	free(fExtents);
+	fExtents = extents;
+	fExtentCount = count;
+	fSessionCount = sessionCount;
+}
 
-	ref.node = strtoull(end + 1, &end, 0);
 
-	if (_end)
-		*_end = end;
-	return true;
+status_t
+Profile::Load(const char *path)
+{
+	TRACE(("load profile %s\n", Name()));
+
+	int fd = open(path, O_RDONLY);
+	if (fd < B_OK)
+		return errno;
+
+	FileDescriptorCloser fdCloser(fd);
+
+	struct stat stat;
+	if (fstat(fd, &stat) != 0)
+		return errno;
+
+	profile_header header;
+	if (stat.st_size > kMaxProfileSize
+		|| read(fd, &header, sizeof(header)) != sizeof(header)
+		|| header.magic != kProfileMagic
+		|| header.version != kProfileVersion
+		|| sizeof(header) + (off_t)header.extent_count
+			* sizeof(profile_extent) != stat.st_size) {
+		return B_BAD_DATA;
+	}
+
+	size_t size = header.extent_count * sizeof(profile_extent);
+	profile_extent *extents = (profile_extent *)malloc(size);
+	if (extents == NULL && size != 0)
+		return B_NO_MEMORY;
+
+	if (read(fd, extents, size) != (ssize_t)size) {
+		free(extents);
+		return B_BAD_DATA;
+	}
+
+	SetExtents(extents, header.extent_count, header.session_count);
+	return B_OK;
 }
 
 
-static struct node *
-new_node(dev_t device, ino_t id)
+status_t
+Profile::Save() const
 {
-	struct node *node = new ::node;
-	if (node == NULL)
-		return NULL;
+	char path[B_PATH_NAME_LENGTH];
+	status_t status = build_profile_path(path, sizeof(path), Name(),
+		NodeRef());
+	if (status != B_OK)
+		return status;
 
-	node->ref.device = device;
-	node->ref.node = id;
-	node->timestamp = system_time();
+	int fd = open(path, O_CREAT | O_TRUNC | O_WRONLY, 0644);
+	if (fd < B_OK)
+		return errno;
 
-	return node;
+	FileDescriptorCloser fdCloser(fd);
+
+	profile_header header;
+	header.magic = kProfileMagic;
+	header.version = kProfileVersion;
+	header.extent_count = fExtentCount;
+	header.session_count = fSessionCount;
+
+	size_t size = fExtentCount * sizeof(profile_extent);
+	if (write(fd, &header, sizeof(header)) != sizeof(header)
+		|| write(fd, fExtents, size) != (ssize_t)size) {
+		fdCloser.Unset();
+		unlink(path);
+		return B_IO_ERROR;
+	}
+
+	return B_OK;
 }
 
 
-static void
-load_prefetch_data()
+/*!	Starts reading in all extents of the profile that have been used often
+	enough. The I/O is done by a separate thread, so that the caller is not
+	held up by reading the inodes.
+*/
+void
+Profile::Prefetch() const
 {
-	DIR *dir = opendir("/etc/launch_cache");
-	if (dir == NULL)
+	int32 count = 0;
+	for (int32 i = 0; i < fExtentCount; i++) {
+		if (fExtents[i].score >= kMinPrefetchScore)
+			count++;
+	}
+	if (count == 0)
 		return;
 
-	struct dirent *dirent;
-	while ((dirent = readdir(dir)) != NULL) {
-		if (dirent->d_name[0] == '.')
-			continue;
-
-		Session *session = new Session(dirent->d_name);
+	prefetch_job *job = (prefetch_job *)malloc(sizeof(prefetch_job)
+		+ count * sizeof(profile_extent));
+	if (job == NULL)
+		return;
 
-		if (session->LoadFromDirectory(dirfd(dir)) != B_OK) {
-			delete session;
-			continue;
-		}
+	strlcpy(job->name, Name(), sizeof(job->name));
+	job->count = 0;
+	for (int32 i = 0; i < fExtentCount; i++) {
+		if (fExtents[i].score >= kMinPrefetchScore)
+			job->extents[job->count++] = fExtents[i];
+	}
 
-		if (session->IsMainSession()) {
-			session->Next() = sMainPrefetchSessions;
-			sMainPrefetchSessions = session;
-		} else {
-			sPrefetchHash->Insert(session);
-		}
+	thread_id thread = spawn_kernel_thread(&prefetch_thread,
+		"launch speedup prefetcher", B_NORMAL_PRIORITY, job);
+	if (thread < B_OK) {
+		free(job);
+		return;
 	}
 
-	closedir(dir);
+	resume_thread(thread);
 }
 
 
 //	#pragma mark -
 
 
-Session::Session(team_id team, const char *name, dev_t device,
-	ino_t node, int32 seconds)
+Session::Session(team_id team, const char *name, const node_ref &ref,
+	int32 seconds)
 	:
-	fNodes(NULL),
+	fNext(NULL),
 	fNodeCount(0),
 	fTeam(team),
-	fClosing(false),
+	fNodeRef(ref),
 	fIsWatchingTeam(false)
 {
 	if (name != NULL) {
@@ -392,32 +784,11 @@ Session::Session(team_id team, const char *name, dev_t device,
 		delete fNodeHash;
 		fNodeHash = NULL;
 	}
-	fActiveUntil = system_time() + seconds * 1000000LL;
 	fTimestamp = system_time();
+	fActiveUntil = fTimestamp + seconds * 1000000LL;
 
-	fNodeRef.device = device;
-	fNodeRef.node = node;
-
-	TRACE(("start session %ld:%lld \"%s\", system_time: %lld, active until: %lld\n",
-		device, node, Name(), system_time(), fActiveUntil));
-}
-
-
-Session::Session(const char *name)
-	:
-	fNodeHash(NULL),
-	fNodes(NULL),
-	fClosing(false),
-	fIsWatchingTeam(false)
-{
-	fTeam = -1;
-	fNodeRef.device = -1;
-	fNodeRef.node = -1;
-
-	if (isdigit(name[0]))
-		parse_node_ref(name, fNodeRef);
-
-	strlcpy(fName, name, B_OS_NAME_LENGTH);
+	TRACE(("start session %ld:%lld \"%s\", system_time: %lld, active until: "
+		"%lld\n", ref.device, ref.node, Name(), system_time(), fActiveUntil));
 }
 
 
@@ -426,19 +797,13 @@ Session::~Session()
 	mutex_destroy(&fLock);
 
 	// free all nodes
-	struct node *node, *next = NULL;
-
 	if (fNodeHash) {
-		// ... from the hash
-		node = fNodeHash->Clear(true);
-	} else {
-		// ... from the list
-		node = fNodes;
-	}
-
-	for (; node != NULL; node = next) {
-		next = node->next;
-		free(node);
+		struct node *node = fNodeHash->Clear(true);
+		while (node != NULL) {
+			struct node *next = node->next;
+			delete node;
+			node = next;
+		}
 	}
 
 	delete fNodeHash;
@@ -467,21 +832,35 @@ Session::_FindNode(dev_t device, ino_t node)
 }
 
 
-void
-Session::AddNode(dev_t device, ino_t id)
+node *
+Session::_AddNode(dev_t device, ino_t id)
 {
-	struct node *node = _FindNode(device, id);
-	if (node != NULL) {
-		node->ref_count++;
-		return;
-	}
+	if (fNodeCount >= kMaxSessionNodes)
+		return NULL;
 
-	node = new_node(device, id);
+	struct node *node = new(std::nothrow) ::node;
 	if (node == NULL)
-		return;
+		return NULL;
+
+	node->ref.device = device;
+	node->ref.node = id;
+	node->ref_count = 0;
+	node->part_count = 0;
 
 	fNodeHash->Insert(node);
 	fNodeCount++;
+	return node;
+}
+
+
+void
+Session::AddNode(dev_t device, ino_t id)
+{
+	struct node *node = _FindNode(device, id);
+	if (node == NULL)
+		node = _AddNode(device, id);
+	if (node != NULL)
+		node->ref_count++;
 }
 
 
@@ -489,9 +868,77 @@ void
 Session::RemoveNode(dev_t device, ino_t id)
 {
 	struct node *node = _FindNode(device, id);
-	if (node != NULL && --node->ref_count <= 0) {
+	if (node != NULL && --node->ref_count <= 0 && node->part_count == 0) {
 		fNodeHash->Remove(node);
 		fNodeCount--;
+		delete node;
+	}
+}
+
+
+/*!	Records an access to the given range of a node. Accesses that are close
+	to each other are combined, and if the node has too many extents already,
+	the two closest ones are merged.
+*/
+void
+Session::AddAccess(dev_t device, ino_t id, off_t offset, size_t size)
+{
+	struct node *node = _FindNode(device, id);
+	if (node == NULL)
+		node = _AddNode(device, id);
+	if (node == NULL)
+		return;
+
+	off_t start = ROUNDDOWN(offset, B_PAGE_SIZE);
+	off_t end = ROUNDUP(offset + (off_t)size, B_PAGE_SIZE);
+	data_part *parts = node->parts;
+
+	while (true) {
+		int32 index = 0;
+		while (index < node->part_count
+			&& parts[index].end + kPartGap < start) {
+			index++;
+		}
+
+		if (index < node->part_count && parts[index].offset <= end + kPartGap) {
+			// extend this part, and join it with the following ones, if they
+			// are close enough now
+			parts[index].offset = min_c(parts[index].offset, start);
+			parts[index].end = max_c(parts[index].end, end);
+
+			while (index + 1 < node->part_count
+				&& parts[index + 1].offset <= parts[index].end + kPartGap) {
+				parts[index].end = max_c(parts[index].end,
+					parts[index + 1].end);
+				memmove(&parts[index + 1], &parts[index + 2],
+					(node->part_count - index - 2) * sizeof(data_part));
+				node->part_count--;
+			}
+			return;
+		}
+
+		if (node->part_count < kMaxNodeParts) {
+			memmove(&parts[index + 1], &parts[index],
+				(node->part_count - index) * sizeof(data_part));
+			parts[index].offset = start;
+			parts[index].end = end;
+			node->part_count++;
+			return;
+		}
+
+		// no room left, merge the two closest parts, and try again
+		int32 closest = 0;
+		for (int32 i = 1; i < node->part_count - 1; i++) {
+			if (parts[i + 1].offset - parts[i].end
+					< parts[closest + 1].offset - parts[closest].end) {
+				closest = i;
+			}
+		}
+
+		parts[closest].end = parts[closest + 1].end;
+		memmove(&parts[closest + 1], &parts[closest + 2],
+			(node->part_count - closest - 2) * sizeof(data_part));
+		node->part_count--;
 	}
 }
 
@@ -513,126 +960,129 @@ Session::StartWatchingTeam()
 void
 Session::StopWatchingTeam()
 {
-	if (fIsWatchingTeam)
+	if (fIsWatchingTeam) {
 		stop_watching_team(Team(), team_gone, this);
-}
-
-
-void
-Session::Prefetch()
-{
-	if (fNodes == NULL || fNodeHash != NULL)
-		return;
-
-	for (struct node *node = fNodes; node != NULL; node = node->next) {
-		cache_prefetch(node->ref.device, node->ref.node, 0, ~0UL);
+		fIsWatchingTeam = false;
 	}
 }
 
 
-status_t
-Session::LoadFromDirectory(int directoryFD)
+/*!	Merges the extents used by this session into those of the \a previous
+	profile, and returns the result as a new profile.
+	Overlapping extents are joined. If the session used any part of the
+	result, its score is raised, otherwise it is lowered, and the extent is
+	dropped once it reaches zero.
+*/
+Profile *
+Session::CreateProfile(const Profile *previous)
 {
-	TRACE(("load session %s\n", Name()));
-
-	int fd = _kern_open(directoryFD, Name(), O_RDONLY, 0);
-	if (fd < B_OK)
-		return fd;
-
-	struct stat stat;
-	if (fstat(fd, &stat) != 0) {
-		close(fd);
-		return errno;
-	}
+	int32 count = previous != NULL ? previous->CountExtents() : 0;
 
-	if (stat.st_size > 32768) {
-		// for safety reasons
-		// ToDo: make a bit larger later
-		close(fd);
-		return B_BAD_DATA;
+	NodeTable::Iterator iterator(fNodeHash);
+	while (iterator.HasNext()) {
+		struct node *node = iterator.Next();
+		count += node->part_count + 1;
 	}
 
-	char *buffer = (char *)malloc(stat.st_size);
-	if (buffer == NULL) {
-		close(fd);
-		return B_NO_MEMORY;
-	}
+	// the score of this session's extents is 0 before the merge
+	profile_extent *extents = (profile_extent *)malloc(
+		max_c(count, 1) * sizeof(profile_extent));
+	if (extents == NULL)
+		return NULL;
 
-	if (read(fd, buffer, stat.st_size) < stat.st_size) {
-		free(buffer);
-		close(fd);
-		return B_ERROR;
+	int32 index = 0;
+	if (previous != NULL) {
+		memcpy(extents, previous->Extents(),
+			previous->CountExtents() * sizeof(profile_extent));
+		index = previous->CountExtents();
 	}
 
-	const char *line = buffer;
-	node_ref nodeRef;
-	while (parse_node_ref(line, nodeRef, &line)) {
-		struct node *node = new_node(nodeRef.device, nodeRef.node);
-		if (node != NULL) {
-			// note: this reverses the order of the nodes in the file
-			node->next = fNodes;
-			fNodes = node;
+	iterator.Rewind();
+	while (iterator.HasNext()) {
+		struct node *node = iterator.Next();
+		for (int32 i = -1; i < node->part_count; i++) {
+			profile_extent &extent = extents[index++];
+			memset(&extent, 0, sizeof(extent));
+			extent.device = node->ref.device;
+			extent.node = node->ref.node;
+			if (i >= 0) {
+				extent.offset = node->parts[i].offset;
+				extent.length = (uint32)min_c(
+					node->parts[i].end - node->parts[i].offset,
+					(off_t)UINT32_MAX & ~(off_t)(B_PAGE_SIZE - 1));
+			}
 		}
-		line++;
 	}
 
-	free(buffer);
-	close(fd);
-	return B_OK;
-}
-
-
-status_t
-Session::Save()
-{
-	fClosing = true;
-
-	char name[B_OS_NAME_LENGTH + 25];
-	if (!IsMainSession()) {
-		snprintf(name, sizeof(name), "/etc/launch_cache/%ld:%lld %s",
-			fNodeRef.device, fNodeRef.node, Name());
-	} else
-		snprintf(name, sizeof(name), "/etc/launch_cache/%s", Name());
-
-	int fd = open(name, O_CREAT | O_TRUNC | O_WRONLY, 0644);
-	if (fd < B_OK)
-		return errno;
+	qsort(extents, count, sizeof(profile_extent), &compare_extents);
+
+	// join overlapping extents, and update the scores
+	int32 resultCount = 0;
+	for (int32 i = 0; i < count;) {
+		profile_extent result = extents[i];
+		off_t end = result.offset + result.length;
+		uint8 score = 0;
+		bool used = false;
+
+		for (; i < count; i++) {
+			const profile_extent &extent = extents[i];
+			if (extent.device != result.device || extent.node != result.node
+				|| (extent.length == 0) != (result.length == 0)
+				|| extent.offset > end) {
+				break;
+			}
 
-	status_t status = B_OK;
-	off_t fileSize = 0;
+			end = max_c(end, extent.offset + (off_t)extent.length);
+			if (extent.score == 0)
+				used = true;
+			else
+				score = max_c(score, extent.score);
+		}
 
-	// ToDo: order nodes by timestamp... (should improve launch speed)
-	// ToDo: test which parts of a file have been read (and save that as well)
+		if (used)
+			score = min_c(score + kUsedScore, kMaxScore);
+		else
+			score--;
 
-	// enlarge file, so that it can be written faster
-	ftruncate(fd, 512 * 1024);
+		if (score == 0)
+			continue;
 
-	NodeTable::Iterator iterator(fNodeHash);
-	while (iterator.HasNext()) {
-		struct node *node = iterator.Next();
-		snprintf(name, sizeof(name), "%ld:%lld\n", node->ref.device, node->ref.node);
+		result.length = (uint32)min_c(end - result.offset,
+			(off_t)UINT32_MAX & ~(off_t)(B_PAGE_SIZE - 1));
+		result.score = score;
+		extents[resultCount++] = result;
+	}
 
-		ssize_t bytesWritten = write(fd, name, strlen(name));
-		if (bytesWritten < B_OK) {
-			status = bytesWritten;
-			break;
+	// keep the profile size bounded, drop the extents with the least score
+	int32 maxCount = (kMaxProfileSize - sizeof(profile_header))
+		/ sizeof(profile_extent);
+	for (uint8 dropScore = 1; resultCount > maxCount; dropScore++) {
+		int32 kept = 0;
+		for (int32 i = 0; i < resultCount; i++) {
+			if (extents[i].score > dropScore)
+				extents[kept++] = extents[i];
 		}
-
-		fileSize += bytesWritten;
+		resultCount = kept;
 	}
 
-	ftruncate(fd, fileSize);
-	close(fd);
+	Profile *profile = new(std::nothrow) Profile(Name(), NodeRef());
+	if (profile == NULL) {
+		free(extents);
+		return NULL;
+	}
 
-	return status;
+	profile->SetExtents(extents, resultCount,
+		previous != NULL ? previous->CountSessions() + 1 : 1);
+	return profile;
 }
 
 
 bool
 Session::IsWorthSaving() const
 {
-	// ToDo: sort out entries with only very few nodes, and those that load
-	//	instantly, anyway
+	if (IsMainSession())
+		return fNodeCount > 0;
+
 	if (fNodeCount < 5 || system_time() - fTimestamp < 400000) {
 		// sort anything out that opens less than 5 files, or needs less
 		// than 0.4 seconds to load an run
@@ -642,31 +1092,20 @@ Session::IsWorthSaving() const
 }
 
 
-bool
-Session::IsMainSession() const
-{
-	return fNodeRef.node == -1;
-}
-
-
 //	#pragma mark -
 
 
 SessionGetter::SessionGetter(team_id team, Session **_session)
 {
-	RecursiveLocker locker(&sLock);
+	ReadLocker locker(sSessionLock);
 
 	if (sMainSession != NULL)
 		fSession = sMainSession;
 	else
 		fSession = sTeamHash->Lookup(team);
 
-	if (fSession != NULL) {
-		if (!fSession->IsClosing())
-			fSession->Lock();
-		else
-			fSession = NULL;
-	}
+	if (fSession != NULL)
+		fSession->Lock();
 
 	*_session = fSession;
 }
@@ -679,32 +1118,6 @@ SessionGetter::~SessionGetter()
 }
 
 
-status_t
-SessionGetter::New(const char *name, dev_t device, ino_t node,
-	Session **_session)
-{
-	Thread *thread = thread_get_current_thread();
-	fSession = start_session(thread->team->id, device, node, name);
-
-	if (fSession != NULL) {
-		*_session = fSession;
-		return B_OK;
-	}
-
-	return B_ERROR;
-}
-
-
-void
-SessionGetter::Stop()
-{
-	if (fSession == sMainSession)
-		sMainSession = NULL;
-
-	stop_session(fSession);
-	fSession = NULL;
-}
-
 //	#pragma mark -
 
 
@@ -721,25 +1134,8 @@ node_opened(struct vnode *vnode, dev_t device, ino_t parent,
 	Session *session;
 	SessionGetter getter(team_get_current_team_id(), &session);
 
-	if (session == NULL) {
-		char buffer[B_FILE_NAME_LENGTH];
-		if (name == NULL
-			&& vfs_get_vnode_name(vnode, buffer, sizeof(buffer)) == B_OK)
-			name = buffer;
-
-		// create new session for this team
-		getter.New(name, device, node, &session);
-	}
-
-	if (session == NULL || !session->IsActive()) {
-		if (sMainSession != NULL) {
-			// ToDo: this opens a race condition with the "stop session" syscall
-			getter.Stop();
-		}
-		return;
-	}
-
-	session->AddNode(device, node);
+	if (session != NULL && session->IsActive())
+		session->AddNode(device, node);
 }
 
 
@@ -758,6 +1154,81 @@ node_closed(struct vnode *vnode, dev_t device, ino_t node,
 }
 
 
+static void
+node_accessed(dev_t device, ino_t node, off_t offset, size_t size)
+{
+	if (device < gBootDevice
+		|| (sMainSession == NULL && atomic_get(&sTeamSessionCount) == 0))
+		return;
+
+	Session *session;
+	SessionGetter getter(team_get_current_team_id(), &session);
+
+	if (session != NULL && session->IsActive())
+		session->AddAccess(device, node, offset, size);
+}
+
+
+/*!	Called in the context of a new team, before it starts executing. The
+	first team to be launched starts the boot session; afterwards, every
+	launch starts a session for its executable.
+*/
+static void
+node_launched(size_t argCount, char * const *args)
+{
+	if (argCount == 0)
+		return;
+
+	team_id team = team_get_current_team_id();
+
+	MutexLocker locker(sLock);
+
+	if (sWaitingForBoot) {
+		sWaitingForBoot = false;
+
+		node_ref ref;
+		ref.device = -1;
+		ref.node = -1;
+		start_session(-1, kBootSessionName, ref, kBootSessionSeconds);
+		dprintf("launch_speedup: START BOOT %" B_PRId64 "\n", system_time());
+		return;
+	}
+
+	Session *previous = sTeamHash->Lookup(team);
+	Session *mainSession = sMainSession;
+	if (mainSession != NULL && mainSession->IsActive())
+		return;
+
+	locker.Unlock();
+
+	// a running main session that isn't active anymore is done
+	if (mainSession != NULL)
+		stop_session(mainSession);
+
+	// the team executes another program
+	if (previous != NULL)
+		stop_session(previous);
+
+	struct vnode *vnode;
+	if (vfs_get_vnode_from_path(args[0], false, &vnode) != B_OK)
+		return;
+
+	node_ref ref;
+	vfs_vnode_to_node_ref(vnode, &ref.device, &ref.node);
+	vfs_put_vnode(vnode);
+
+	if (ref.device < gBootDevice)
+		return;
+
+	const char *name = strrchr(args[0], '/');
+	name = name != NULL ? name + 1 : args[0];
+
+	locker.Lock();
+	if (sMainSession == NULL && sTeamHash->Lookup(team) == NULL)
+		start_session(team, name, ref, kAppSessionSeconds);
+}
+
+
 static status_t
 launch_speedup_control(const char *subsystem, uint32 function,
 	void *buffer, size_t bufferSize)
@@ -773,8 +1244,15 @@ launch_speedup_control(const char *subsystem, uint32 function,
 			if (isdigit(name[0]) || name[0] == '.')
 				return B_BAD_VALUE;
 
-			sMainSession = start_session(-1, -1, -1, name, 60);
-			sMainSession->Unlock();
+			MutexLocker locker(sLock);
+			if (sMainSession != NULL)
+				return B_BUSY;
+
+			node_ref ref;
+			ref.device = -1;
+			ref.node = -1;
+			if (start_session(-1, name, ref, 60) == NULL)
+				return B_NO_MEMORY;
 			return B_OK;
 		}
 
@@ -785,16 +1263,18 @@ launch_speedup_control(const char *subsystem, uint32 function,
 				|| user_strlcpy(name, (const char *)buffer, B_OS_NAME_LENGTH) < B_OK)
 				return B_BAD_ADDRESS;
 
-			// ToDo: this check is not thread-safe
-			if (sMainSession == NULL || strcmp(sMainSession->Name(), name))
+			MutexLocker locker(sLock);
+			Session *session = sMainSession;
+			if (session == NULL || strcmp(session->Name(), name))
 				return B_BAD_VALUE;
+			locker.Unlock();
 
-			if (!strcmp(name, "system boot"))
-				dprintf("STOP BOOT %lld\n", system_time());
+			if (!strcmp(name, kBootSessionName)) {
+				dprintf("launch_speedup: STOP BOOT %" B_PRId64 "\n",
+					system_time());
+			}
 
-			sMainSession->Lock();
-			stop_session(sMainSession);
-			sMainSession = NULL;
+			stop_session(session);
 			return B_OK;
 		}
 	}
@@ -808,34 +1288,37 @@ uninit()
 {
 	unregister_generic_syscall(LAUNCH_SPEEDUP_SYSCALLS, 1);
 
-	recursive_lock_lock(&sLock);
+	mutex_lock(&sLock);
+	rw_lock_write_lock(&sSessionLock);
 
-	// free all sessions from the hashes
+	// free all sessions and profiles
 
 	Session *session = sTeamHash->Clear(true);
 	while (session != NULL) {
-		Session *next = session->next;
-		delete session;
-		session = next;
-	}
-	session = sPrefetchHash->Clear(true);
-	while (session != NULL) {
-		Session *next = session->next;
+		Session *next = session->Next();
 		delete session;
 		session = next;
 	}
+	delete sMainSession;
 
-	// free all sessions from the main prefetch list
+	Profile *profile = sProfileHash->Clear(true);
+	while (profile != NULL) {
+		Profile *next = profile->Next();
+		delete profile;
+		profile = next;
+	}
 
-	for (session = sMainPrefetchSessions; session != NULL; ) {
-		sMainPrefetchSessions = session->Next();
-		delete session;
-		session = sMainPrefetchSessions;
+	for (profile = sMainProfiles; profile != NULL; ) {
+		sMainProfiles = profile->Next();
+		delete profile;
+		profile = sMainProfiles;
 	}
 
 	delete sTeamHash;
-	delete sPrefetchHash;
-	recursive_lock_destroy(&sLock);
+	delete sProfileHash;
+	rw_lock_destroy(&sSessionLock);
+	mutex_destroy(&sLock);
+	mutex_destroy(&sSaveLock);
 }
 
 
@@ -848,13 +1331,15 @@ init()
 
 	status_t status;
 
-	sPrefetchHash = new(std::nothrow) PrefetchTable();
-	if (sPrefetchHash == NULL || sPrefetchHash->Init(64) != B_OK) {
+	sProfileHash = new(std::nothrow) ProfileTable();
+	if (sProfileHash == NULL || sProfileHash->Init(64) != B_OK) {
 		status = B_NO_MEMORY;
 		goto err1;
 	}
 
-	recursive_lock_init(&sLock, "launch speedup");
+	mutex_init(&sLock, "launch speedup");
+	rw_lock_init(&sSessionLock, "launch speedup sessions");
+	mutex_init(&sSaveLock, "launch speedup save");
 
 	// register kernel syscalls
 	if (register_generic_syscall(LAUNCH_SPEEDUP_SYSCALLS,
@@ -863,21 +1348,21 @@ init()
 		goto err3;
 	}
 
-	// read in prefetch knowledge base
-
-	mkdir("/etc/launch_cache", 0755);
-	load_prefetch_data();
+	// read in the profiles
 
-	// start boot session
+	mkdir(kProfileDirectory, 0755);
+	load_profiles();
 
-	sMainSession = start_session(-1, -1, -1, "system boot");
-	sMainSession->Unlock();
-	dprintf("START BOOT %lld\n", system_time());
+	// The boot session starts with the first team, if we're loaded early
+	// enough; only the kernel team exists at that point.
+	sWaitingForBoot = team_used_teams() <= 1;
 	return B_OK;
 
 err3:
-	recursive_lock_destroy(&sLock);
-	delete sPrefetchHash;
+	mutex_destroy(&sSaveLock);
+	rw_lock_destroy(&sSessionLock);
+	mutex_destroy(&sLock);
+	delete sProfileHash;
 err1:
 	delete sTeamHash;
 	return status;
@@ -909,7 +1394,8 @@ static struct cache_module_info sLaunchSpeedupModule = {
 	},
 	node_opened,
 	node_closed,
-	NULL,
+	node_launched,
+	node_accessed,
 };
 
 
@@ -226,6 +226,17 @@ CachedDataReader::_ReadCacheLine(off_t lineOffset, size_t lineSize,
 				output);
 		}
 
+		VMCachePagesTreePreload preload;
+		if (preload.TryPreload(VMCachePagesTreePreload::NodesNeeded(
+				lastMissing - firstMissing + 1)) != B_OK) {
+			vm_page_unreserve_pages(&reservation);
+			_DiscardPages(pages, firstMissing - firstPageOffset, missingPages);
+
+			// fall back to uncached transfer
+			return fReader->ReadDataToOutput(requestOffset, requestLength,
+				output);
+		}
+
 		// Allocate the missing pages and remove the already existing pages in
 		// the range from the cache. We're going to read/write the whole range
 		// anyway.
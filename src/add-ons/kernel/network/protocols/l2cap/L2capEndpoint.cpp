@@ -341,17 +341,20 @@ L2capEndpoint::Connect(const struct sockaddr* _address)
 
 
 status_t
-L2capEndpoint::Accept(net_socket** _acceptedSocket)
+L2capEndpoint::Accept(net_socket** _acceptedSocket, int flags)
 {
 	CALLED();
 	MutexLocker locker(fLock);
 
 	status_t status;
-	bigtime_t timeout = absolute_timeout(socket->receive.timeout);
-	if (gStackModule->is_restarted_syscall())
-		timeout = gStackModule->restore_syscall_restart_timeout();
-	else
-		gStackModule->store_syscall_restart_timeout(timeout);
+	bigtime_t timeout = 0;
+	if ((flags & MSG_DONTWAIT) == 0) {
+		timeout = absolute_timeout(socket->receive.timeout);
+		if (gStackModule->is_restarted_syscall())
+			timeout = gStackModule->restore_syscall_restart_timeout();
+		else
+			gStackModule->store_syscall_restart_timeout(timeout);
+	}
 
 	do {
 		locker.Unlock();
@@ -359,7 +362,7 @@ L2capEndpoint::Accept(net_socket** _acceptedSocket)
 		status = acquire_sem_etc(fAcceptSemaphore, 1, B_ABSOLUTE_TIMEOUT
 			| B_CAN_INTERRUPT, timeout);
 		if (status != B_OK) {
-			if (status == B_TIMED_OUT && socket->receive.timeout == 0)
+			if (status == B_TIMED_OUT && timeout == 0)
 				return B_WOULD_BLOCK;
 
 			return status;
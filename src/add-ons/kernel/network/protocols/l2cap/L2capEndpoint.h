@@ -36,7 +36,8 @@ public:
 			status_t	Unbind();
 			status_t	Listen(int backlog);
 			status_t	Connect(const struct sockaddr* address);
-			status_t	Accept(net_socket** _acceptedSocket);
+			status_t	Accept(net_socket** _acceptedSocket,
+						int flags = 0);
 
 			uint16		ChannelID() const { return fChannelID; }
 
@@ -96,6 +96,14 @@ l2cap_accept(net_protocol* protocol, struct net_socket** _acceptedSocket)
 }
 
 
+status_t
+l2cap_accept_etc(net_protocol* protocol, struct net_socket** _acceptedSocket,
+	int flags)
+{
+	return ((L2capEndpoint*)protocol)->Accept(_acceptedSocket, flags);
+}
+
+
 status_t
 l2cap_control(net_protocol* protocol, int level, int option, void* value,
 	size_t* _length)
@@ -402,7 +410,8 @@ net_protocol_module_info gL2CAPModule = {
 	NULL,		// process_ancillary_data()
 	NULL,		// process_ancillary_data_no_container()
 	NULL,		// send_data_no_buffer()
-	NULL		// read_data_no_buffer()
+	NULL,		// read_data_no_buffer()
+	l2cap_accept_etc
 };
 
 module_dependency module_dependencies[] = {
@@ -37,7 +37,8 @@ public:
 			status_t	Close();
 			void		Free();
 			status_t	Connect(const struct sockaddr* address);
-			status_t	Accept(struct net_socket** _acceptedSocket);
+			status_t	Accept(struct net_socket** _acceptedSocket,
+						int flags = 0);
 			status_t	Bind(const sockaddr* address);
 			status_t	Unbind(struct sockaddr* address);
 			status_t	Listen(int count);
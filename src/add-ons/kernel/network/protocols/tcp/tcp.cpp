@@ -537,6 +537,14 @@ tcp_accept(net_protocol* protocol, struct net_socket** _acceptedSocket)
 }
 
 
+status_t
+tcp_accept_etc(net_protocol* protocol, struct net_socket** _acceptedSocket,
+	int flags)
+{
+	return ((TCPEndpoint*)protocol)->Accept(_acceptedSocket, flags);
+}
+
+
 status_t
 tcp_control(net_protocol* _protocol, int level, int option, void* value,
 	size_t* _length)
@@ -896,7 +904,8 @@ net_protocol_module_info sTCPModule = {
 	NULL,		// process_ancillary_data()
 	NULL,		// process_ancillary_data_no_container()
 	NULL,		// send_data_no_buffer()
-	NULL		// read_data_no_buffer()
+	NULL,		// read_data_no_buffer()
+	tcp_accept_etc
 };
 
 module_dependency module_dependencies[] = {
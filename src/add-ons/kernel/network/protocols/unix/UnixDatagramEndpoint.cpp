@@ -198,7 +198,7 @@ UnixDatagramEndpoint::Connect(const struct sockaddr* _address)
 
 
 status_t
-UnixDatagramEndpoint::Accept(net_socket** _acceptedSocket)
+UnixDatagramEndpoint::Accept(net_socket** _acceptedSocket, int flags)
 {
 	TRACE("[%" B_PRId32 "] %p->UnixDatagramEndpoint::Accept()\n",
 		find_thread(NULL), this);
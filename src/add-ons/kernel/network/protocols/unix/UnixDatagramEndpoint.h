@@ -30,7 +30,8 @@ public:
 			status_t			Unbind() override;
 			status_t			Listen(int backlog) override;
 			status_t			Connect(const struct sockaddr* address) override;
-			status_t			Accept(net_socket** _acceptedSocket) override;
+			status_t			Accept(net_socket** _acceptedSocket,
+									int flags) override;
 
 			ssize_t				Send(const iovec* vecs, size_t vecCount,
 									ancillary_data_container* ancillaryData,
@@ -51,7 +51,8 @@ public:
 	virtual	status_t			Unbind() = 0;
 	virtual	status_t			Listen(int backlog) = 0;
 	virtual	status_t			Connect(const struct sockaddr* address) = 0;
-	virtual	status_t			Accept(net_socket** _acceptedSocket) = 0;
+	virtual	status_t			Accept(net_socket** _acceptedSocket,
+									int flags) = 0;
 
 	virtual	ssize_t				Send(const iovec* vecs, size_t vecCount,
 									ancillary_data_container* ancillaryData,
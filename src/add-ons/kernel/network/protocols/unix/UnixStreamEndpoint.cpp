@@ -341,16 +341,19 @@ UnixStreamEndpoint::Connect(const struct sockaddr* _address)
 
 
 status_t
-UnixStreamEndpoint::Accept(net_socket** _acceptedSocket)
+UnixStreamEndpoint::Accept(net_socket** _acceptedSocket, int flags)
 {
 	TRACE("[%" B_PRId32 "] %p->UnixStreamEndpoint::Accept()\n", find_thread(NULL),
 		this);
 
-	bigtime_t timeout = absolute_timeout(socket->receive.timeout);
-	if (gStackModule->is_restarted_syscall())
-		timeout = gStackModule->restore_syscall_restart_timeout();
-	else
-		gStackModule->store_syscall_restart_timeout(timeout);
+	bigtime_t timeout = 0;
+	if ((flags & MSG_DONTWAIT) == 0) {
+		timeout = absolute_timeout(socket->receive.timeout);
+		if (gStackModule->is_restarted_syscall())
+			timeout = gStackModule->restore_syscall_restart_timeout();
+		else
+			gStackModule->store_syscall_restart_timeout(timeout);
+	}
 
 	UnixStreamEndpointLocker locker(this);
 
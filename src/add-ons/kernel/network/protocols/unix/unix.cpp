@@ -125,7 +125,15 @@ unix_connect(net_protocol *_protocol, const struct sockaddr *address)
 status_t
 unix_accept(net_protocol *_protocol, struct net_socket **_acceptedSocket)
 {
-	return ((UnixEndpoint*)_protocol)->Accept(_acceptedSocket);
+	return ((UnixEndpoint*)_protocol)->Accept(_acceptedSocket, 0);
+}
+
+
+status_t
+unix_accept_etc(net_protocol *_protocol, struct net_socket **_acceptedSocket,
+	int flags)
+{
+	return ((UnixEndpoint*)_protocol)->Accept(_acceptedSocket, flags);
 }
 
 
@@ -535,7 +543,8 @@ net_protocol_module_info gUnixModule = {
 	unix_process_ancillary_data,
 	NULL,
 	unix_send_data_no_buffer,
-	unix_read_data_no_buffer
+	unix_read_data_no_buffer,
+	unix_accept_etc
 };
 
 module_dependency module_dependencies[] = {
@@ -53,6 +53,10 @@
 #define DATA_NODE_READ_ONLY		0x1
 #define DATA_NODE_STORED_HEADER	0x2
 
+#define DATA_HEADER_EXTERNAL	0x1
+
+#define MAX_EXTERNAL_NODE_SIZE	32768
+
 struct header_space {
 	uint16	size;
 	uint16	free;
@@ -70,6 +74,15 @@ struct data_header {
 	uint8*			data_end;
 	header_space	space;
 	uint16			tail_space;
+	uint16			flags;
+};
+
+// A header for memory that is not owned by the buffer module; it only keeps
+// track of the references to the data, and calls the release hook when the
+// last one is gone.
+struct external_data_header : data_header {
+	void			(*release)(void* cookie);
+	void*			cookie;
 };
 
 struct data_node {
@@ -153,6 +166,7 @@ struct net_buffer_private : net_buffer {
 
 static object_cache* sNetBufferCache;
 static object_cache* sDataNodeCache;
+static object_cache* sExternalDataHeaderCache;
 
 
 static status_t append_data(net_buffer* buffer, const void* data, size_t size);
@@ -814,6 +828,7 @@ create_data_header(size_t headerSpace)
 	header->tail_space = (uint8*)header + BUFFER_SIZE - header->data_end
 		- headerSpace;
 	header->first_free = NULL;
+	header->flags = 0;
 
 	TRACE(("%d:   create new data header %p\n", find_thread(NULL), header));
 	T2(CreateDataHeader(header));
@@ -830,6 +845,14 @@ release_data_header(data_header* header)
 		return;
 
 	TRACE(("%d:   free header %p\n", find_thread(NULL), header));
+
+	if ((header->flags & DATA_HEADER_EXTERNAL) != 0) {
+		external_data_header* external = (external_data_header*)header;
+		external->release(external->cookie);
+		object_cache_free(sExternalDataHeaderCache, external, 0);
+		return;
+	}
+
 	free_data_header(header);
 }
 
@@ -1416,7 +1439,8 @@ merge_buffer(net_buffer* _buffer, net_buffer* _with, bool after)
 		if (node == NULL)
 			break;
 
-		if ((uint8*)node > (uint8*)node->header
+		if ((node->header->flags & DATA_HEADER_EXTERNAL) == 0
+			&& (uint8*)node > (uint8*)node->header
 			&& (uint8*)node < (uint8*)node->header + BUFFER_SIZE) {
 			// The node is already in the buffer, we can just move it
 			// over to the new owner
@@ -2011,6 +2035,73 @@ append_cloned_data(net_buffer* _buffer, net_buffer* _source, uint32 offset,
 }
 
 
+/*!	Appends \a bytes of memory at \a data to the buffer without copying it.
+	The memory is only referenced by read-only nodes, and must stay valid and
+	unchanged until \a release is called with \a cookie. That happens when
+	the last buffer referring to the data (including clones) is freed, or
+	right away if the data could not be appended.
+*/
+static status_t
+append_external_data(net_buffer* _buffer, const void* data, size_t bytes,
+	void (*release)(void* cookie), void* cookie)
+{
+	net_buffer_private* buffer = (net_buffer_private*)_buffer;
+	TRACE(("%d: append_external_data(buffer %p, data %p, bytes = %ld)\n",
+		find_thread(NULL), buffer, data, bytes));
+
+	external_data_header* header = (external_data_header*)object_cache_alloc(
+		sExternalDataHeaderCache, 0);
+	if (header == NULL) {
+		release(cookie);
+		return B_NO_MEMORY;
+	}
+
+	header->ref_count = 1;
+	header->physical_address = 0;
+	header->first_free = NULL;
+	header->data_end = NULL;
+	header->space.size = 0;
+	header->space.free = 0;
+	header->tail_space = 0;
+	header->flags = DATA_HEADER_EXTERNAL;
+	header->release = release;
+	header->cookie = cookie;
+
+	ParanoiaChecker _(buffer);
+
+	status_t status = B_OK;
+	size_t sizeAppended = 0;
+
+	while (sizeAppended < bytes) {
+		data_node* node = add_data_node(buffer, header);
+		if (node == NULL) {
+			remove_trailer(buffer, sizeAppended);
+			status = ENOBUFS;
+			break;
+		}
+
+		node->offset = buffer->size;
+		node->start = (uint8*)data + sizeAppended;
+		node->used = min_c(bytes - sizeAppended, MAX_EXTERNAL_NODE_SIZE);
+		node->flags = DATA_NODE_READ_ONLY;
+
+		list_add_item(&buffer->buffers, node);
+
+		buffer->size += node->used;
+		sizeAppended += node->used;
+	}
+
+	// the nodes keep the data alive from here on
+	release_data_header(header);
+
+	CHECK_BUFFER(buffer);
+	SET_PARANOIA_CHECK(PARANOIA_SUSPICIOUS, buffer, &buffer->size,
+		sizeof(buffer->size));
+
+	return status;
+}
+
+
 void
 set_ancillary_data(net_buffer* buffer, ancillary_data_container* container)
 {
@@ -2327,6 +2418,14 @@ std_ops(int32 op, ...)
 				return B_NO_MEMORY;
 			}
 
+			sExternalDataHeaderCache = create_object_cache(
+				"external data header cache", sizeof(external_data_header), 0);
+			if (sExternalDataHeaderCache == NULL) {
+				delete_object_cache(sNetBufferCache);
+				delete_object_cache(sDataNodeCache);
+				return B_NO_MEMORY;
+			}
+
 #if ENABLE_STATS
 			add_debugger_command_etc("net_buffer_stats", &dump_net_buffer_stats,
 				"Print net buffer statistics",
@@ -2348,6 +2447,7 @@ std_ops(int32 op, ...)
 #endif
 			delete_object_cache(sNetBufferCache);
 			delete_object_cache(sDataNodeCache);
+			delete_object_cache(sExternalDataHeaderCache);
 			return B_OK;
 
 		default:
@@ -2380,6 +2480,7 @@ net_buffer_module_info gNetBufferModule = {
 	remove_trailer,
 	trim_data,
 	append_cloned_data,
+	append_external_data,
 
 	NULL,	// associate_data
 
@@ -881,16 +881,28 @@ socket_notify(net_socket* _socket, uint8 event, int32 value)
 //	#pragma mark - standard socket API
 
 
+/*!	Accepts a connection on the listening \a socket. If \a flags contains
+	\c MSG_DONTWAIT, \c B_WOULD_BLOCK is returned instead of waiting when
+	there is no pending connection, regardless of the socket's receive
+	timeout. Protocols that can listen implement \c accept_etc(); the
+	\c accept() of the others fails right away anyway.
+*/
 int
 socket_accept(net_socket* socket, struct sockaddr* address,
-	socklen_t* _addressLength, net_socket** _acceptedSocket)
+	socklen_t* _addressLength, net_socket** _acceptedSocket, int flags)
 {
 	if ((socket->options & SO_ACCEPTCONN) == 0)
 		return B_BAD_VALUE;
 
 	net_socket* accepted;
-	status_t status = socket->first_info->accept(socket->first_protocol,
-		&accepted);
+	status_t status;
+	if (socket->first_info->accept_etc != NULL) {
+		status = socket->first_info->accept_etc(socket->first_protocol,
+			&accepted, flags);
+	} else {
+		status = socket->first_info->accept(socket->first_protocol,
+			&accepted);
+	}
 	if (status != B_OK)
 		return status;
 
@@ -1417,6 +1429,93 @@ socket_send(net_socket* socket, msghdr* header, const void* data, size_t length,
 }
 
 
+/*!	Sends the data described by \a vecs without copying it; the memory is
+	attached to the net_buffers as external data. The stack takes over one
+	reference to \a cookie per vector, and calls \a release for each of them
+	once the data is no longer needed, including for vectors that could not
+	be sent.
+	Only connected stream sockets are supported. If the socket cannot take
+	external data, \c B_NOT_SUPPORTED is returned, and the references stay
+	with the caller.
+*/
+ssize_t
+socket_send_external(net_socket* socket, const iovec* vecs, size_t vecCount,
+	int flags, void (*release)(void* cookie), void* cookie)
+{
+	const bool nosignal = ((flags & MSG_NOSIGNAL) != 0);
+	flags &= ~MSG_NOSIGNAL;
+
+	if (socket->type != SOCK_STREAM
+		|| socket->first_info->send_data_no_buffer != NULL)
+		return B_NOT_SUPPORTED;
+
+	status_t status = B_OK;
+	if (socket->peer.ss_len == 0)
+		status = ENOTCONN;
+
+	ssize_t bytesSent = 0;
+	size_t vecIndex = 0;
+
+	while (status == B_OK && vecIndex < vecCount) {
+		net_buffer* buffer = gNetBufferModule.create(256);
+		if (buffer == NULL) {
+			status = ENOBUFS;
+			break;
+		}
+
+		// Only whole vectors go into a buffer, so that every reference ends
+		// up in exactly one of them. The buffer takes over the reference even
+		// if appending fails.
+		do {
+			status = gNetBufferModule.append_external(buffer,
+				vecs[vecIndex].iov_base, vecs[vecIndex].iov_len, release,
+				cookie);
+			vecIndex++;
+		} while (status == B_OK && vecIndex < vecCount
+			&& buffer->size + vecs[vecIndex].iov_len
+				<= socket->send.buffer_size);
+
+		if (status != B_OK) {
+			gNetBufferModule.free(buffer);
+			break;
+		}
+
+		size_t bufferSize = buffer->size;
+		buffer->msg_flags = flags;
+		memcpy(buffer->source, &socket->address, socket->address.ss_len);
+		memcpy(buffer->destination, &socket->peer, socket->peer.ss_len);
+
+		status = socket->first_info->send_data(socket->first_protocol, buffer);
+		if (status != B_OK) {
+			size_t sizeAfterSend = buffer->size;
+			gNetBufferModule.free(buffer);
+
+			bytesSent += bufferSize - sizeAfterSend;
+			break;
+		}
+
+		bytesSent += bufferSize;
+	}
+
+	// release the references of the vectors we did not get to
+	for (; vecIndex < vecCount; vecIndex++)
+		release(cookie);
+
+	if (status == B_OK)
+		return bytesSent;
+
+	// we only send signals when called from userland
+	if (status == EPIPE && is_syscall() && !nosignal)
+		send_signal(find_thread(NULL), SIGPIPE);
+
+	if (bytesSent > 0 && (status == B_INTERRUPTED || status == B_WOULD_BLOCK)) {
+		// this appears to be a partial write
+		return bytesSent;
+	}
+	return status;
+}
+
+
 status_t
 socket_set_option(net_socket* socket, int level, int option, const void* value,
 	int length)
@@ -1587,7 +1686,7 @@ socket_socketpair(int family, int type, int protocol, net_socket* sockets[2])
 		// accept a socket
 		if (type == SOCK_STREAM) {
 			net_socket* acceptedSocket = NULL;
-			error = socket_accept(sockets[0], NULL, NULL, &acceptedSocket);
+			error = socket_accept(sockets[0], NULL, NULL, &acceptedSocket, 0);
 			if (error == B_OK) {
 				// everything worked: close the listener socket
 				socket_close(sockets[0]);
@@ -1699,6 +1798,7 @@ net_socket_module_info gNetSocketModule = {
 	socket_listen,
 	socket_receive,
 	socket_send,
+	socket_send_external,
 	socket_setsockopt,
 	socket_shutdown,
 	socket_socketpair
@@ -64,10 +64,10 @@ stack_interface_listen(net_socket* socket, int backlog)
 
 static status_t
 stack_interface_accept(net_socket* socket, struct sockaddr* address,
-	socklen_t* _addressLength, net_socket** _acceptedSocket)
+	socklen_t* _addressLength, net_socket** _acceptedSocket, int flags)
 {
 	return gNetSocketModule.accept(socket, address, _addressLength,
-		_acceptedSocket);
+		_acceptedSocket, flags);
 }
 
 
@@ -161,6 +161,15 @@ stack_interface_sendmsg(net_socket* socket, const struct msghdr* message,
 }
 
 
+static ssize_t
+stack_interface_send_external(net_socket* socket, const struct iovec* vecs,
+	size_t vecCount, int flags, void (*release)(void* cookie), void* cookie)
+{
+	return gNetSocketModule.send_external(socket, vecs, vecCount, flags,
+		release, cookie);
+}
+
+
 static status_t
 stack_interface_getsockopt(net_socket* socket, int level, int option,
 	void* value, socklen_t* _length)
@@ -283,6 +292,7 @@ net_stack_interface_module_info gNetStackInterfaceModule = {
 	&stack_interface_send,
 	&stack_interface_sendto,
 	&stack_interface_sendmsg,
+	&stack_interface_send_external,
 
 	&stack_interface_getsockopt,
 	&stack_interface_setsockopt,
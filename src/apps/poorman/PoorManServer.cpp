@@ -9,14 +9,18 @@
 #include "PoorManServer.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <pthread.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h> //for struct timeval
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <poll.h>
+#include <unistd.h>
 
 #include <File.h>
 #include <Debug.h>
@@ -388,17 +392,17 @@ status_t PoorManServer::_HandleGet(httpd_conn* hc)
 {
 	PRINT(("HandleGet() called\n"));
 
-	ssize_t bytesRead;
-	uint8* buf;
 	BString log;
 
-	BFile file(hc->expnfilename, B_READ_ONLY);
-	if (file.InitCheck() != B_OK)
+	int fd = open(hc->expnfilename, O_RDONLY);
+	if (fd < 0)
 		return B_ERROR;
 
-	buf = new uint8[POOR_MAN_BUF_SIZE];
-	if (buf == NULL)
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close(fd);
 		return B_ERROR;
+	}
 	
 	static_cast<PoorManApplication*>(be_app)->GetPoorManWindow()->SetHits(
 		static_cast<PoorManApplication*>(be_app)->
@@ -414,20 +418,21 @@ status_t PoorManServer::_HandleGet(httpd_conn* hc)
 	
 	//send mime headers
 	if (send(hc->conn_fd, hc->response, hc->responselen, 0) < 0) {
-		delete [] buf;
+		close(fd);
 		return B_ERROR;
 	}
 	
-	file.Seek(hc->first_byte_index, SEEK_SET);
-	while (true) {
-		bytesRead = file.Read(buf, POOR_MAN_BUF_SIZE);
-		if (bytesRead == 0)
+	//let the kernel send the file straight from the file cache
+	off_t offset = hc->first_byte_index;
+	while (offset < st.st_size) {
+		ssize_t bytesSent = sendfile(hc->conn_fd, fd, &offset,
+			st.st_size - offset);
+		if (bytesSent == 0)
 			break;
-		else if (bytesRead < 0) {
-			delete [] buf;
-			return B_ERROR;
-		}
-		if (send(hc->conn_fd, (void*)buf, bytesRead, 0) < 0) {
+		else if (bytesSent < 0) {
+			if (errno == B_INTERRUPTED)
+				continue;
+
 			log.SetTo("Error sending file: ");
 			if (pthread_rwlock_rdlock(&fWebDirLock) == 0) {
 				log << hc->hs->cwd;
@@ -435,12 +440,12 @@ status_t PoorManServer::_HandleGet(httpd_conn* hc)
 			}
 			log << '/' << hc->expnfilename << '\n';
 			poorman_log(log.String(), true, &hc->client_addr, RED);
-			delete [] buf;
+			close(fd);
 			return B_ERROR;
 		}
 	}
 	
-	delete [] buf;
+	close(fd);
 	return B_OK;
 }
 
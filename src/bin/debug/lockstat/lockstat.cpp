@@ -0,0 +1,460 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <OS.h>
+
+#include <lock_stats_defs.h>
+#include <syscalls.h>
+
+
+extern const char* __progname;
+
+static const char* kUsage =
+	"Usage: %s [ <options> ] [ <command line> ]\n"
+	"Collects statistics about the contention of kernel locks (mutexes,\n"
+	"recursive locks, rw_locks, and spinlocks) while executing the given\n"
+	"command line <command line>, or for a given time, and prints them.\n"
+	"\n"
+	"Options:\n"
+	"  -c <count>   - Print the <count> top call sites of each lock\n"
+	"                 (default: 3).\n"
+	"  -h, --help   - Print this usage info.\n"
+	"  -H           - Also print a wait time histogram for each lock.\n"
+	"  -n <count>   - Print only the <count> top locks (default: 20).\n"
+	"  -s <key>     - Sort by <key>, one of \"wait\" (total wait time, the\n"
+	"                 default), \"contention\", \"count\", or \"hold\" (total\n"
+	"                 hold time).\n"
+	"  -t <seconds> - Collect for <seconds> seconds, if no command line is\n"
+	"                 given (default: 5).\n"
+	"\n"
+	"Notes: Uncontended spinlock and rw_lock read lock acquisitions are not\n"
+	"counted. Hold times are only available for mutexes, recursive locks,\n"
+	"and rw_lock write locks. Named locks are keyed by their name, i.e. all\n"
+	"locks of the same name are summed up; spinlocks and unnamed locks are\n"
+	"keyed by their address.\n"
+;
+
+static const char* const kTypeNames[LOCK_STATS_TYPE_COUNT] = {
+	"mutex",
+	"recursive",
+	"rw read",
+	"rw write",
+	"spinlock"
+};
+
+
+enum sort_key {
+	SORT_BY_WAIT,
+	SORT_BY_CONTENTION,
+	SORT_BY_COUNT,
+	SORT_BY_HOLD
+};
+
+
+struct call_site {
+	std::string	symbol;
+	int64		acquisitions;
+	int64		contentions;
+	nanotime_t	total_wait;
+};
+
+
+struct lock_summary {
+	std::string				name;
+	uint32					type;
+	int64					acquisitions;
+	int64					contentions;
+	nanotime_t				total_wait;
+	nanotime_t				max_wait;
+	int64					hold_count;
+	nanotime_t				total_hold;
+	nanotime_t				max_hold;
+	uint64					wait_histogram[LOCK_STATS_HISTOGRAM_BUCKETS];
+	std::map<addr_t, call_site>	call_sites;
+
+	lock_summary()
+		:
+		type(0),
+		acquisitions(0),
+		contentions(0),
+		total_wait(0),
+		max_wait(0),
+		hold_count(0),
+		total_hold(0),
+		max_hold(0)
+	{
+		memset(wait_histogram, 0, sizeof(wait_histogram));
+	}
+};
+
+
+typedef std::map<std::pair<std::string, uint32>, lock_summary> SummaryMap;
+
+
+static sort_key sSortKey = SORT_BY_WAIT;
+static volatile sig_atomic_t sInterrupted = 0;
+
+
+static void
+print_usage_and_exit(bool error)
+{
+	fprintf(error ? stderr : stdout, kUsage, __progname);
+	exit(error ? 1 : 0);
+}
+
+
+static void
+signal_handler(int signal)
+{
+	sInterrupted = 1;
+}
+
+
+static status_t
+lock_stats_call(uint32 function, void* buffer, size_t bufferSize)
+{
+	return _kern_generic_syscall(LOCK_STATS_SYSCALLS, function, buffer,
+		bufferSize);
+}
+
+
+static void
+run_child(int argc, const char* const* argv)
+{
+	pid_t child = fork();
+	if (child < 0) {
+		fprintf(stderr, "Error: fork() failed: %s\n", strerror(errno));
+		return;
+	}
+
+	if (child == 0) {
+		execvp(argv[0], (char**)argv);
+		fprintf(stderr, "Error: Failed to execute \"%s\": %s\n", argv[0],
+			strerror(errno));
+		_exit(1);
+	}
+
+	int childStatus;
+	while (waitpid(child, &childStatus, 0) < 0 && errno == EINTR)
+		;
+}
+
+
+static int64
+sort_value(const lock_summary* summary)
+{
+	switch (sSortKey) {
+		case SORT_BY_CONTENTION:
+			return summary->contentions;
+		case SORT_BY_COUNT:
+			return summary->acquisitions;
+		case SORT_BY_HOLD:
+			return summary->total_hold;
+		case SORT_BY_WAIT:
+		default:
+			return summary->total_wait;
+	}
+}
+
+
+static bool
+compare_summaries(const lock_summary* a, const lock_summary* b)
+{
+	return sort_value(a) > sort_value(b);
+}
+
+
+static bool
+compare_call_sites(const call_site* a, const call_site* b)
+{
+	if (a->total_wait != b->total_wait)
+		return a->total_wait > b->total_wait;
+	return a->acquisitions > b->acquisitions;
+}
+
+
+static void
+add_entry(SummaryMap& summaries, const lock_stats_entry& entry)
+{
+	if (entry.type >= LOCK_STATS_TYPE_COUNT)
+		return;
+
+	std::string name(entry.name, strnlen(entry.name, sizeof(entry.name)));
+	if (entry.key == LOCK_STATS_KEY_ADDRESS && name.empty()) {
+		// unnamed locks can only be told apart by their address
+		char address[32];
+		snprintf(address, sizeof(address), "<%#" B_PRIxADDR ">", entry.lock);
+		name = address;
+	}
+
+	lock_summary& summary = summaries[std::make_pair(name, entry.type)];
+	summary.name = name;
+	summary.type = entry.type;
+	summary.acquisitions += entry.acquisitions;
+	summary.contentions += entry.contentions;
+	summary.total_wait += entry.total_wait;
+	summary.max_wait = std::max(summary.max_wait, entry.max_wait);
+	summary.hold_count += entry.hold_count;
+	summary.total_hold += entry.total_hold;
+	summary.max_hold = std::max(summary.max_hold, entry.max_hold);
+	for (int32 i = 0; i < LOCK_STATS_HISTOGRAM_BUCKETS; i++)
+		summary.wait_histogram[i] += entry.wait_histogram[i];
+
+	call_site& site = summary.call_sites[entry.caller_address];
+	if (site.symbol.empty()) {
+		site.symbol.assign(entry.caller,
+			strnlen(entry.caller, sizeof(entry.caller)));
+	}
+	site.acquisitions += entry.acquisitions;
+	site.contentions += entry.contentions;
+	site.total_wait += entry.total_wait;
+}
+
+
+static double
+to_us(nanotime_t time)
+{
+	return time / 1000.0;
+}
+
+
+static void
+print_histogram(const lock_summary& summary)
+{
+	uint64 maxCount = 0;
+	int32 first = -1;
+	int32 last = -1;
+	for (int32 i = 0; i < LOCK_STATS_HISTOGRAM_BUCKETS; i++) {
+		if (summary.wait_histogram[i] == 0)
+			continue;
+		maxCount = std::max(maxCount, summary.wait_histogram[i]);
+		if (first < 0)
+			first = i;
+		last = i;
+	}
+
+	if (first < 0)
+		return;
+
+	static const int32 kBarWidth = 40;
+	for (int32 i = first; i <= last; i++) {
+		uint64 count = summary.wait_histogram[i];
+		int32 bar = (int32)(count * kBarWidth / maxCount);
+
+		if (i == 0) {
+			printf("      %12s < %-10" B_PRId64, "",
+				(int64)1 << LOCK_STATS_HISTOGRAM_SHIFT);
+		} else {
+			printf("      %12" B_PRId64 " - %-10" B_PRId64,
+				(int64)1 << (i + LOCK_STATS_HISTOGRAM_SHIFT - 1),
+				(int64)1 << (i + LOCK_STATS_HISTOGRAM_SHIFT));
+		}
+		printf(" ns %10" B_PRIu64 " |%.*s\n", count, (int)bar,
+			"########################################");
+	}
+}
+
+
+static void
+print_summaries(SummaryMap& summaries, int32 lockCount, int32 callSiteCount,
+	bool histogram)
+{
+	std::vector<lock_summary*> sorted;
+	for (SummaryMap::iterator it = summaries.begin(); it != summaries.end();
+			++it) {
+		sorted.push_back(&it->second);
+	}
+	std::sort(sorted.begin(), sorted.end(), &compare_summaries);
+
+	printf("%-9s %11s %10s %6s %12s %9s %9s %9s %9s  %s\n", "type",
+		"acquired", "contended", "cont%", "wait (us)", "avg (us)", "max (us)",
+		"hold avg", "hold max", "name");
+	printf("------------------------------------------------------------------"
+		"------------------------------------------\n");
+
+	int32 count = std::min((int32)sorted.size(), lockCount);
+	for (int32 i = 0; i < count; i++) {
+		const lock_summary& summary = *sorted[i];
+
+		double contention = summary.acquisitions > 0
+			? 100.0 * summary.contentions / summary.acquisitions : 0;
+		double averageWait = summary.contentions > 0
+			? to_us(summary.total_wait) / summary.contentions : 0;
+
+		printf("%-9s %11" B_PRId64 " %10" B_PRId64 " %6.1f %12.1f %9.2f "
+			"%9.1f ", kTypeNames[summary.type], summary.acquisitions,
+			summary.contentions, contention, to_us(summary.total_wait),
+			averageWait, to_us(summary.max_wait));
+
+		if (summary.hold_count > 0) {
+			printf("%9.2f %9.1f", to_us(summary.total_hold)
+				/ summary.hold_count, to_us(summary.max_hold));
+		} else
+			printf("%9s %9s", "-", "-");
+
+		printf("  %s\n", summary.name.c_str());
+
+		if (callSiteCount > 0) {
+			std::vector<const call_site*> sites;
+			for (std::map<addr_t, call_site>::const_iterator it
+					= summary.call_sites.begin();
+					it != summary.call_sites.end(); ++it) {
+				sites.push_back(&it->second);
+			}
+			std::sort(sites.begin(), sites.end(), &compare_call_sites);
+
+			int32 siteCount = std::min((int32)sites.size(), callSiteCount);
+			for (int32 k = 0; k < siteCount; k++) {
+				const call_site& site = *sites[k];
+				printf("      %11" B_PRId64 " %10" B_PRId64 " %19.1f  %s\n",
+					site.acquisitions, site.contentions,
+					to_us(site.total_wait), site.symbol.c_str());
+			}
+		}
+
+		if (histogram)
+			print_histogram(summary);
+	}
+}
+
+
+int
+main(int argc, const char* const* argv)
+{
+	int32 lockCount = 20;
+	int32 callSiteCount = 3;
+	bool histogram = false;
+	bigtime_t duration = 5000000;
+
+	while (true) {
+		static struct option sLongOptions[] = {
+			{ "help", no_argument, 0, 'h' },
+			{ 0, 0, 0, 0 }
+		};
+
+		opterr = 0; // don't print errors
+		int c = getopt_long(argc, (char**)argv, "+c:hHn:s:t:", sLongOptions,
+			NULL);
+		if (c == -1)
+			break;
+
+		switch (c) {
+			case 'c':
+				callSiteCount = atol(optarg);
+				break;
+			case 'h':
+				print_usage_and_exit(false);
+				break;
+			case 'H':
+				histogram = true;
+				break;
+			case 'n':
+				lockCount = atol(optarg);
+				if (lockCount < 1)
+					print_usage_and_exit(true);
+				break;
+			case 's':
+				if (strcmp(optarg, "wait") == 0)
+					sSortKey = SORT_BY_WAIT;
+				else if (strcmp(optarg, "contention") == 0)
+					sSortKey = SORT_BY_CONTENTION;
+				else if (strcmp(optarg, "count") == 0)
+					sSortKey = SORT_BY_COUNT;
+				else if (strcmp(optarg, "hold") == 0)
+					sSortKey = SORT_BY_HOLD;
+				else
+					print_usage_and_exit(true);
+				break;
+			case 't':
+				duration = (bigtime_t)(atof(optarg) * 1000000);
+				if (duration <= 0)
+					print_usage_and_exit(true);
+				break;
+
+			default:
+				print_usage_and_exit(true);
+				break;
+		}
+	}
+
+	system_info info;
+	get_system_info(&info);
+
+	// The kernel keeps at most LOCK_STATS_TABLE_SIZE (256) entries per CPU.
+	int32 capacity = info.cpu_count * 256;
+	lock_stats_entry* entries = (lock_stats_entry*)malloc(
+		sizeof(lock_stats_entry) * capacity);
+	if (entries == NULL) {
+		fprintf(stderr, "Error: Out of memory\n");
+		return 1;
+	}
+
+	status_t error = lock_stats_call(LOCK_STATS_ENABLE, NULL, 0);
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to enable lock statistics: %s\n",
+			strerror(error));
+		return 1;
+	}
+
+	// discard whatever has been collected before
+	lock_stats_get_args args;
+	args.entries = NULL;
+	args.count = 0;
+	lock_stats_call(LOCK_STATS_GET, &args, sizeof(args));
+
+	signal(SIGINT, &signal_handler);
+
+	bigtime_t startTime = system_time();
+	if (optind < argc)
+		run_child(argc - optind, argv + optind);
+	else {
+		while (!sInterrupted && system_time() - startTime < duration) {
+			snooze(std::min(duration - (system_time() - startTime),
+				(bigtime_t)100000));
+		}
+	}
+	bigtime_t runTime = system_time() - startTime;
+
+	args.entries = entries;
+	args.count = capacity;
+	error = lock_stats_call(LOCK_STATS_GET, &args, sizeof(args));
+	lock_stats_call(LOCK_STATS_DISABLE, NULL, 0);
+
+	if (error != B_OK) {
+		fprintf(stderr, "Error: Failed to get lock statistics: %s\n",
+			strerror(error));
+		return 1;
+	}
+
+	SummaryMap summaries;
+	for (int32 i = 0; i < args.count; i++)
+		add_entry(summaries, entries[i]);
+
+	printf("\nlock statistics over %.2f s (%" B_PRId32 " locks, %" B_PRId32
+		" events dropped)\n", runTime / 1000000.0, (int32)summaries.size(),
+		args.dropped);
+	printf("named locks are keyed by name, spinlocks and unnamed locks by "
+		"address\n\n");
+
+	print_summaries(summaries, lockCount, callSiteCount, histogram);
+
+	free(entries);
+	return 0;
+}
@@ -9,7 +9,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <syscalls.h>
 #include <system_info.h>
+#include <vm_defs.h>
 
 
 static struct option const kLongOptions[] = {
@@ -85,6 +87,46 @@ main(int argc, char** argv)
 		info.free_swap_pages * B_PAGE_SIZE);
 	printf("page faults:\t\t%" B_PRIu32 "\n", info.page_faults);
 
+	vm_large_page_stats largePages;
+	if (_kern_get_large_page_stats(&largePages) == B_OK
+		&& largePages.page_size != 0) {
+		printf("large page size:\t%" B_PRIuSIZE "\n", largePages.page_size);
+		printf("large pages mapped:\t%" B_PRId64 "\n", largePages.mapped);
+		printf("large page faults:\t%" B_PRId64 "\n", largePages.faults);
+		printf("large page fallbacks:\t%" B_PRId64 "\n",
+			largePages.fallbacks);
+		printf("large page promotions:\t%" B_PRId64 "\n",
+			largePages.promotions);
+		printf("large page demotions:\t%" B_PRId64 "\n",
+			largePages.demotions);
+	}
+
+	vm_compressed_swap_stats compressedSwap;
+	if (_kern_get_compressed_swap_stats(&compressedSwap) == B_OK) {
+		printf("compressed swap pool:\t%" B_PRIu64 " of %" B_PRIu64 "\n",
+			compressedSwap.pool_used, compressedSwap.pool_size);
+		printf("compressed swap pages:\t%" B_PRId64 " (%" B_PRId64
+			" same-filled, %" B_PRId64 " written back)\n",
+			compressedSwap.stored_pages, compressedSwap.same_filled_pages,
+			compressedSwap.written_back_pages);
+		printf("compression ratio:\t%.2f\n",
+			compressedSwap.compressed_bytes > 0
+				? (double)compressedSwap.uncompressed_bytes
+					/ compressedSwap.compressed_bytes : 0.0);
+		printf("compressed swap stores:\t%" B_PRId64 " (%" B_PRId64
+			" rejected, %" B_PRId64 " written through, %" B_PRId64
+			" written back)\n", compressedSwap.stores,
+			compressedSwap.rejected_stores, compressedSwap.write_throughs,
+			compressedSwap.write_backs);
+		printf("compressed swap loads:\t%" B_PRId64 " (%" B_PRId64
+			" from backing store)\n", compressedSwap.loads,
+			compressedSwap.backing_loads);
+		printf("fault-in latency:\tavg %" B_PRId64 " us, max %" B_PRId64
+			" us\n", compressedSwap.loads > 0
+				? compressedSwap.total_load_time / compressedSwap.loads : 0,
+			compressedSwap.max_load_time);
+	}
+
 	if (periodically) {
 		puts("\npage faults  used memory    used swap  block cache");
 		system_info lastInfo = info;
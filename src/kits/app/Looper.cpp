@@ -1138,10 +1138,41 @@ BLooper::ReadMessageFromPort(bigtime_t timeout)
 	int32 msgCode;
 	BMessage* message = NULL;
 
-	void* buffer = ReadRawFromPort(&msgCode, timeout);
-	if (buffer == NULL)
+	ssize_t size;
+	do {
+		size = port_buffer_size_etc(fMsgPort, B_RELATIVE_TIMEOUT, timeout);
+	} while (size == B_INTERRUPTED);
+
+	if (size < B_OK)
 		return NULL;
 
+	if (size > MIN_PORT_BUFFER_MESSAGE_SIZE) {
+		// Large messages are passed in port buffers; unflatten them in place
+		// instead of copying them out of the port.
+		message = new(std::nothrow) BMessage();
+		if (message != NULL) {
+			if (BMessage::Private(message).ReceiveFromPortBuffer(fMsgPort,
+					&msgCode) == B_OK) {
+				PRINT(("BLooper::ReadMessageFromPort() done: %p\n", message));
+				return message;
+			}
+			delete message;
+			message = NULL;
+		}
+	}
+
+	void* buffer = NULL;
+	if (size > 0)
+		buffer = malloc(size);
+
+	// the message is already there, don't wait for another one
+	size = read_port_etc(fMsgPort, &msgCode, buffer, size,
+		B_RELATIVE_TIMEOUT, 0);
+	if (size < B_OK || buffer == NULL) {
+		free(buffer);
+		return NULL;
+	}
+
 	message = ConvertToMessage(buffer, msgCode);
 	free(buffer);
 
@@ -74,6 +74,14 @@ extern "C" {
 	// private os function to set the owning team of an area
 	status_t _kern_transfer_area(area_id area, void** _address,
 		uint32 addressSpec, team_id target);
+
+	// private os functions to pass message data in port buffers
+	area_id _kern_acquire_port_buffer(size_t size, void** _address);
+	status_t _kern_release_port_buffer(area_id buffer);
+	ssize_t _kern_read_port_buffer_etc(port_id port, int32* msgCode,
+		area_id* _buffer, void** _address, uint32 flags, bigtime_t timeout);
+	status_t _kern_write_port_buffer_etc(port_id port, int32 msgCode,
+		area_id buffer, size_t bufferSize, uint32 flags, bigtime_t timeout);
 }
 
 
@@ -123,12 +131,21 @@ handle_reply(port_id replyPort, int32* _code, bigtime_t timeout,
 		return size;
 
 	status_t result;
+	if (size > MIN_PORT_BUFFER_MESSAGE_SIZE) {
+		result = BMessage::Private(reply).ReceiveFromPortBuffer(replyPort,
+			_code);
+		if (result == B_OK)
+			return *_code == kPortMessageCode ? B_OK : B_ERROR;
+		// the reply might not fit into a port buffer; read it normally
+	}
+
 	char* buffer = (char*)malloc(size);
 	if (buffer == NULL)
 		return B_NO_MEMORY;
 
 	do {
-		result = read_port(replyPort, _code, buffer, size);
+		result = read_port_etc(replyPort, _code, buffer, size,
+			B_RELATIVE_TIMEOUT, 0);
 	} while (result == B_INTERRUPTED);
 
 	if (result < 0 || *_code != kPortMessageCode) {
@@ -207,7 +224,7 @@ BMessage::operator=(const BMessage& other)
 	// apply to the clone.
 	fHeader->flags &= ~(MESSAGE_FLAG_REPLY_REQUIRED | MESSAGE_FLAG_REPLY_DONE
 		| MESSAGE_FLAG_IS_REPLY | MESSAGE_FLAG_WAS_DELIVERED
-		| MESSAGE_FLAG_PASS_BY_AREA);
+		| MESSAGE_FLAG_PASS_BY_AREA | MESSAGE_FLAG_PORT_BUFFER);
 	// Note, that BeOS R5 seems to keep the reply info.
 
 	if (fHeader->field_count > 0) {
@@ -1209,7 +1226,12 @@ BMessage::_Dereference()
 	if (fHeader == NULL)
 		return B_NO_INIT;
 
-	delete_area(fHeader->message_area);
+	if ((fHeader->flags & MESSAGE_FLAG_PORT_BUFFER) != 0) {
+		_kern_release_port_buffer(fHeader->message_area);
+		fHeader->flags &= ~MESSAGE_FLAG_PORT_BUFFER;
+	} else
+		delete_area(fHeader->message_area);
+
 	fHeader->message_area = -1;
 	fFields = NULL;
 	fData = NULL;
@@ -1217,6 +1239,78 @@ BMessage::_Dereference()
 }
 
 
+/*!	Reads the next message from \a port without waiting for it, and
+	unflattens it in place: it is received in a port buffer, and the fields
+	and data are used from there until the message is changed or deleted.
+	Returns an error if there was no message, or if it could not be received
+	in a port buffer; in the latter case, it stays in the port.
+*/
+status_t
+BMessage::_ReceiveFromPortBuffer(port_id port, int32* _code)
+{
+	DEBUG_FUNCTION_ENTER;
+	area_id buffer;
+	void* address;
+	ssize_t size;
+	do {
+		size = _kern_read_port_buffer_etc(port, _code, &buffer, &address,
+			B_RELATIVE_TIMEOUT, 0);
+	} while (size == B_INTERRUPTED);
+
+	if (size < 0)
+		return size;
+	if (buffer < 0)
+		return B_BAD_VALUE;
+
+	const message_header* header = (const message_header*)address;
+	if ((size_t)size < sizeof(message_header)
+		|| header->format != MESSAGE_FORMAT_HAIKU
+		|| (header->flags & MESSAGE_FLAG_PASS_BY_AREA) != 0) {
+		// this one can't be used in place
+		BMemoryIO io(address, size);
+		status_t result = Unflatten(&io);
+		_kern_release_port_buffer(buffer);
+		return result;
+	}
+
+	_Clear();
+
+	fHeader = (message_header*)malloc(sizeof(message_header));
+	if (fHeader == NULL) {
+		_kern_release_port_buffer(buffer);
+		return B_NO_MEMORY;
+	}
+
+	memcpy(fHeader, header, sizeof(message_header));
+	what = fHeader->what;
+
+	size_t bodySize = size - sizeof(message_header);
+	if ((fHeader->flags & MESSAGE_FLAG_VALID) == 0
+		|| fHeader->field_count > bodySize / sizeof(field_header)
+		|| fHeader->data_size
+			> bodySize - fHeader->field_count * sizeof(field_header)) {
+		_kern_release_port_buffer(buffer);
+		_InitHeader();
+		return B_BAD_VALUE;
+	}
+
+	if (fHeader->field_count == 0 && fHeader->data_size == 0) {
+		_kern_release_port_buffer(buffer);
+		fHeader->message_area = -1;
+		fHeader->flags &= ~MESSAGE_FLAG_PORT_BUFFER;
+		return B_OK;
+	}
+
+	fHeader->message_area = buffer;
+	fHeader->flags |= MESSAGE_FLAG_PORT_BUFFER;
+
+	uint8* body = (uint8*)address + sizeof(message_header);
+	fFields = (field_header*)body;
+	fData = body + fHeader->field_count * sizeof(field_header);
+	return _ValidateMessage();
+}
+
+
 status_t
 BMessage::_CopyForWrite()
 {
@@ -1333,6 +1427,7 @@ BMessage::Unflatten(BDataIO* stream)
 	}
 
 	what = fHeader->what;
+	fHeader->flags &= ~MESSAGE_FLAG_PORT_BUFFER;
 
 	if ((fHeader->flags & MESSAGE_FLAG_PASS_BY_AREA) != 0
 		&& fHeader->message_area >= 0) {
@@ -2128,6 +2223,33 @@ BMessage::_StaticGetCachedReplyPort()
 }
 
 
+/*!	Flattens the message into a port buffer, so that it can be passed to the
+	target without the kernel having to copy it. Unlike with _FlattenToArea(),
+	the buffers are recycled, and the receiver just gets a regular flattened
+	message, even if it reads it with read_port().
+*/
+static area_id
+flatten_to_port_buffer(const BMessage& message,
+	BMessage::message_header** _header, ssize_t* _size)
+{
+	ssize_t size = message.FlattenedSize();
+	void* address;
+	area_id buffer = _kern_acquire_port_buffer(size, &address);
+	if (buffer < 0)
+		return buffer;
+
+	status_t result = message.Flatten((char*)address, size);
+	if (result != B_OK) {
+		_kern_release_port_buffer(buffer);
+		return result;
+	}
+
+	*_header = (BMessage::message_header*)address;
+	*_size = size;
+	return buffer;
+}
+
+
 status_t
 BMessage::_SendMessage(port_id port, team_id portOwner, int32 token,
 	bigtime_t timeout, bool replyRequired, BMessenger& replyTo) const
@@ -2135,6 +2257,7 @@ BMessage::_SendMessage(port_id port, team_id portOwner, int32 token,
 	DEBUG_FUNCTION_ENTER;
 	ssize_t size = 0;
 	char* buffer = NULL;
+	area_id portBuffer = -1;
 	message_header* header = NULL;
 	status_t result = B_OK;
 
@@ -2163,9 +2286,12 @@ BMessage::_SendMessage(port_id port, team_id portOwner, int32 token,
 			return result;
 
 		return toMessage.SendTo(port, token);
+	} else if (fHeader->data_size > MIN_PORT_BUFFER_MESSAGE_SIZE
+		&& (portBuffer = flatten_to_port_buffer(*this, &header, &size)) >= 0) {
+		// the message is passed in a port buffer without being copied
 	} else if (fHeader->data_size > B_PAGE_SIZE * 10) {
 		// ToDo: bind the above size to the max port message size
-		// use message passing by area for such a large message
+		// use message passing by area if there is no port buffer available
 		result = _FlattenToArea(&header);
 		if (result != B_OK)
 			return result;
@@ -2239,9 +2365,17 @@ BMessage::_SendMessage(port_id port, team_id portOwner, int32 token,
 			char(what >> 24), char(what >> 16), char(what >> 8), (char)what);
 
 		do {
-			result = write_port_etc(port, kPortMessageCode, (void*)buffer,
-				size, B_RELATIVE_TIMEOUT, timeout);
+			if (portBuffer >= 0) {
+				result = _kern_write_port_buffer_etc(port, kPortMessageCode,
+					portBuffer, size, B_RELATIVE_TIMEOUT, timeout);
+			} else {
+				result = write_port_etc(port, kPortMessageCode, (void*)buffer,
+					size, B_RELATIVE_TIMEOUT, timeout);
+			}
 		} while (result == B_INTERRUPTED);
+
+		if (portBuffer >= 0 && result != B_OK)
+			_kern_release_port_buffer(portBuffer);
 	}
 
 	if (result == B_OK && IsSourceWaiting()) {
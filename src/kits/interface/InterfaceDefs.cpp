@@ -449,6 +449,31 @@ get_is_subpixel_ordering_regular(bool* subpixelOrdering)
 }
 
 
+void
+set_tiled_rendering(bool tiled)
+{
+	BPrivate::AppServerLink link;
+
+	link.StartMessage(AS_SET_TILED_RENDERING);
+	link.Attach<bool>(tiled);
+	link.Flush();
+}
+
+
+status_t
+get_tiled_rendering(bool* tiled)
+{
+	BPrivate::AppServerLink link;
+
+	link.StartMessage(AS_GET_TILED_RENDERING);
+	int32 status = B_ERROR;
+	if (link.FlushWithReply(status) != B_OK || status < B_OK)
+		return status;
+	link.Read<bool>(tiled);
+	return B_OK;
+}
+
+
 const color_map *
 system_colors()
 {
@@ -0,0 +1,36 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <fcntl.h>
+#include <sys/sendfile.h>
+
+#include <errno.h>
+
+#include <syscall_utils.h>
+#include <syscalls.h>
+#include <vfs_defs.h>
+
+
+static_assert(SPLICE_F_MOVE == VFS_SPLICE_MOVE
+	&& SPLICE_F_NONBLOCK == VFS_SPLICE_NONBLOCK
+	&& SPLICE_F_MORE == VFS_SPLICE_MORE
+	&& SPLICE_F_GIFT == VFS_SPLICE_GIFT, "splice flags don't match");
+
+
+ssize_t
+splice(int inFD, off_t* inOffset, int outFD, off_t* outOffset, size_t length,
+	unsigned int flags)
+{
+	RETURN_AND_SET_ERRNO(_kern_splice(inFD, inOffset, outFD, outOffset,
+		length, flags));
+}
+
+
+ssize_t
+sendfile(int outFD, int inFD, off_t* offset, size_t count)
+{
+	RETURN_AND_SET_ERRNO(_kern_splice(inFD, offset, outFD, NULL, count, 0));
+}
@@ -29,6 +29,7 @@
 #include "GlobalSubpixelSettings.h"
 #include "ServerConfig.h"
 #include "SystemPalette.h"
+#include "TiledRenderer.h"
 
 
 DesktopSettingsPrivate::DesktopSettingsPrivate(server_read_only_memory* shared)
@@ -89,6 +90,8 @@ DesktopSettingsPrivate::_SetDefaults()
 	gDefaultHintingMode = HINTING_MODE_ON;
 	gSubpixelAverageWeight = 120;
 	gSubpixelOrderingRGB = true;
+
+	gTiledRendering = false;
 }
 
 
@@ -301,6 +304,10 @@ DesktopSettingsPrivate::_Load()
 				gSubpixelOrderingRGB = subpixelOrdering;
 			}
 
+			bool tiledRendering;
+			if (settings.FindBool("tiled rendering", &tiledRendering) == B_OK)
+				gTiledRendering = tiledRendering;
+
 			const char* controlLook;
 			if (settings.FindString("control look", &controlLook) == B_OK) {
 				fControlLook = controlLook;
@@ -454,6 +461,7 @@ DesktopSettingsPrivate::Save(uint32 mask)
 			settings.AddBool("subpixel antialiasing", gSubpixelAntialiasing);
 			settings.AddInt8("subpixel average weight", gSubpixelAverageWeight);
 			settings.AddBool("subpixel ordering", gSubpixelOrderingRGB);
+			settings.AddBool("tiled rendering", gTiledRendering);
 
 			settings.AddString("control look", fControlLook);
 
@@ -800,6 +808,21 @@ DesktopSettingsPrivate::IsSubpixelOrderingRegular() const
 }
 
 
+void
+DesktopSettingsPrivate::SetTiledRendering(bool tiled)
+{
+	gTiledRendering = tiled;
+	Save(kAppearanceSettings);
+}
+
+
+bool
+DesktopSettingsPrivate::TiledRendering() const
+{
+	return gTiledRendering;
+}
+
+
 status_t
 DesktopSettingsPrivate::SetControlLook(const char* path)
 {
@@ -970,6 +993,13 @@ DesktopSettings::IsSubpixelOrderingRegular() const
 }
 
 
+bool
+DesktopSettings::TiledRendering() const
+{
+	return fSettings->TiledRendering();
+}
+
+
 const BString&
 DesktopSettings::ControlLook() const
 {
@@ -1097,6 +1127,13 @@ LockedDesktopSettings::SetSubpixelOrderingRegular(bool subpixelOrdering)
 }
 
 
+void
+LockedDesktopSettings::SetTiledRendering(bool tiled)
+{
+	fSettings->SetTiledRendering(tiled);
+}
+
+
 status_t
 LockedDesktopSettings::SetControlLook(const char* path)
 {
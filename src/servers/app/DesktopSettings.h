@@ -76,6 +76,8 @@ public:
 			uint8				SubpixelAverageWeight() const;
 			bool				IsSubpixelOrderingRegular() const;
 
+			bool				TiledRendering() const;
+
 			const BString&		ControlLook() const;
 
 protected:
@@ -111,6 +113,8 @@ public:
 			void				SetSubpixelOrderingRegular(
 									bool subpixelOrdering);
 
+			void				SetTiledRendering(bool tiled);
+
 			status_t			SetControlLook(const char* path);
 
 private:
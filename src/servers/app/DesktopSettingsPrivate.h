@@ -94,6 +94,9 @@ public:
 									bool subpixelOrdering);
 			bool				IsSubpixelOrderingRegular() const;
 
+			void				SetTiledRendering(bool tiled);
+			bool				TiledRendering() const;
+
 			status_t			SetControlLook(const char* path);
 			const BString&		ControlLook() const;
 
@@ -200,6 +200,9 @@ string_for_message_code(uint32 code)
 		CODE(AS_SET_SUBPIXEL_ORDERING);
 		CODE(AS_GET_SUBPIXEL_ORDERING);
 
+		CODE(AS_SET_TILED_RENDERING);
+		CODE(AS_GET_TILED_RENDERING);
+
 		// Graphics calls
 		CODE(AS_SET_HIGH_COLOR);
 		CODE(AS_SET_LOW_COLOR);
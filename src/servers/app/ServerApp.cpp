@@ -3584,6 +3584,26 @@ ServerApp::_DispatchMessage(int32 code, BPrivate::LinkReceiver& link)
 			break;
 		}
 
+		case AS_SET_TILED_RENDERING:
+		{
+			// The output is the same either way, no need to redraw
+			bool tiled;
+			if (link.Read<bool>(&tiled) == B_OK) {
+				LockedDesktopSettings settings(fDesktop);
+				settings.SetTiledRendering(tiled);
+			}
+			break;
+		}
+
+		case AS_GET_TILED_RENDERING:
+		{
+			DesktopSettings settings(fDesktop);
+			fLink.StartMessage(B_OK);
+			fLink.Attach<bool>(settings.TiledRendering());
+			fLink.Flush();
+			break;
+		}
+
 		default:
 			printf("ServerApp %s received unhandled message code %" B_PRId32
 				"\n", Signature(), code);
@@ -24,6 +24,7 @@
 #include "ServerBitmap.h"
 #include "ServerCursor.h"
 #include "RenderingBuffer.h"
+#include "TiledRenderer.h"
 
 #include "drawing_support.h"
 
@@ -166,6 +167,17 @@ public:
 		return fOverlaysHidden;
 	}
 
+	void Draw(const DrawingOperation& operation)
+	{
+		Painter* painter = fEngine->fPainter.Get();
+		if (gTiledRendering && TiledRenderer::Default() != NULL
+			&& TiledRenderer::Default()->Render(*painter, fDirty, operation)) {
+			return;
+		}
+
+		operation.Draw(painter);
+	}
+
 private:
 	DrawingEngine *fEngine;
 	bool fOverlaysHidden;
@@ -173,6 +185,270 @@ private:
 };
 
 
+// #pragma mark - drawing operations
+
+
+class ArcOperation : public DrawingOperation {
+public:
+	ArcOperation(BPoint center, float xRadius, float yRadius, float angle,
+			float span, bool filled, const BGradient* gradient = NULL)
+		:
+		fCenter(center),
+		fXRadius(xRadius),
+		fYRadius(yRadius),
+		fAngle(angle),
+		fSpan(span),
+		fFilled(filled),
+		fGradient(gradient)
+	{
+	}
+
+	virtual void Draw(Painter* painter) const
+	{
+		if (fGradient != NULL) {
+			painter->FillArc(fCenter, fXRadius, fYRadius, fAngle, fSpan,
+				*fGradient);
+		} else if (fFilled)
+			painter->FillArc(fCenter, fXRadius, fYRadius, fAngle, fSpan);
+		else
+			painter->StrokeArc(fCenter, fXRadius, fYRadius, fAngle, fSpan);
+	}
+
+private:
+	BPoint				fCenter;
+	float				fXRadius;
+	float				fYRadius;
+	float				fAngle;
+	float				fSpan;
+	bool				fFilled;
+	const BGradient*	fGradient;
+};
+
+
+class BitmapOperation : public DrawingOperation {
+public:
+	BitmapOperation(ServerBitmap* bitmap, const BRect& bitmapRect,
+			const BRect& viewRect, uint32 options)
+		:
+		fBitmap(bitmap),
+		fBitmapRect(bitmapRect),
+		fViewRect(viewRect),
+		fOptions(options)
+	{
+	}
+
+	virtual void Draw(Painter* painter) const
+	{
+		painter->DrawBitmap(fBitmap, fBitmapRect, fViewRect, fOptions);
+	}
+
+private:
+	ServerBitmap*		fBitmap;
+	BRect				fBitmapRect;
+	BRect				fViewRect;
+	uint32				fOptions;
+};
+
+
+class EllipseOperation : public DrawingOperation {
+public:
+	EllipseOperation(const BRect& rect, bool filled,
+			const BGradient* gradient = NULL)
+		:
+		fRect(rect),
+		fFilled(filled),
+		fGradient(gradient)
+	{
+	}
+
+	virtual void Draw(Painter* painter) const
+	{
+		if (fGradient != NULL)
+			painter->FillEllipse(fRect, *fGradient);
+		else
+			painter->DrawEllipse(fRect, fFilled);
+	}
+
+private:
+	BRect				fRect;
+	bool				fFilled;
+	const BGradient*	fGradient;
+};
+
+
+class PolygonOperation : public DrawingOperation {
+public:
+	PolygonOperation(BPoint* points, int32 count, bool filled, bool closed,
+			const BGradient* gradient = NULL)
+		:
+		fPoints(points),
+		fCount(count),
+		fFilled(filled),
+		fClosed(closed),
+		fGradient(gradient)
+	{
+	}
+
+	virtual void Draw(Painter* painter) const
+	{
+		if (fGradient != NULL)
+			painter->FillPolygon(fPoints, fCount, *fGradient, fClosed);
+		else
+			painter->DrawPolygon(fPoints, fCount, fFilled, fClosed);
+	}
+
+private:
+	BPoint*				fPoints;
+	int32				fCount;
+	bool				fFilled;
+	bool				fClosed;
+	const BGradient*	fGradient;
+};
+
+
+class RectOperation : public DrawingOperation {
+public:
+	RectOperation(const BRect& rect, const BGradient* gradient = NULL)
+		:
+		fRect(rect),
+		fGradient(gradient)
+	{
+	}
+
+	virtual void Draw(Painter* painter) const
+	{
+		if (fGradient != NULL)
+			painter->FillRect(fRect, *fGradient);
+		else
+			painter->FillRect(fRect);
+	}
+
+private:
+	BRect				fRect;
+	const BGradient*	fGradient;
+};
+
+
+class ColorRectOperation : public DrawingOperation {
+public:
+	ColorRectOperation(const BRect& rect, const rgb_color& color)
+		:
+		fRect(rect),
+		fColor(color)
+	{
+	}
+
+	virtual void Draw(Painter* painter) const
+	{
+		painter->FillRect(fRect, fColor);
+	}
+
+private:
+	BRect				fRect;
+	rgb_color			fColor;
+};
+
+
+class RegionOperation : public DrawingOperation {
+public:
+	RegionOperation(const BRegion& region, const BGradient* gradient = NULL)
+		:
+		fRegion(region),
+		fGradient(gradient)
+	{
+	}
+
+	virtual void Draw(Painter* painter) const
+	{
+		int32 count = fRegion.CountRects();
+		for (int32 i = 0; i < count; i++) {
+			if (fGradient != NULL)
+				painter->FillRect(fRegion.RectAt(i), *fGradient);
+			else
+				painter->FillRect(fRegion.RectAt(i));
+		}
+	}
+
+private:
+	const BRegion&		fRegion;
+	const BGradient*	fGradient;
+};
+
+
+class RoundRectOperation : public DrawingOperation {
+public:
+	RoundRectOperation(const BRect& rect, float xRadius, float yRadius,
+			bool filled, const BGradient* gradient = NULL)
+		:
+		fRect(rect),
+		fXRadius(xRadius),
+		fYRadius(yRadius),
+		fFilled(filled),
+		fGradient(gradient)
+	{
+	}
+
+	virtual void Draw(Painter* painter) const
+	{
+		if (fGradient != NULL)
+			painter->FillRoundRect(fRect, fXRadius, fYRadius, *fGradient);
+		else if (fFilled)
+			painter->FillRoundRect(fRect, fXRadius, fYRadius);
+		else
+			painter->StrokeRoundRect(fRect, fXRadius, fYRadius);
+	}
+
+private:
+	BRect				fRect;
+	float				fXRadius;
+	float				fYRadius;
+	bool				fFilled;
+	const BGradient*	fGradient;
+};
+
+
+class StringOperation : public DrawingOperation {
+public:
+	StringOperation(Painter* owner, const char* string, int32 length,
+			const BPoint& baseLine, const escapement_delta* delta,
+			const BPoint* offsets, FontCacheReference* cacheReference)
+		:
+		fOwner(owner),
+		fString(string),
+		fLength(length),
+		fBaseLine(baseLine),
+		fDelta(delta),
+		fOffsets(offsets),
+		fCacheReference(cacheReference)
+	{
+	}
+
+	virtual void Draw(Painter* painter) const
+	{
+		// The painters of the tiles lay out the string themselves, they
+		// cannot share the cache reference of the engine's painter.
+		FontCacheReference* cacheReference
+			= painter == fOwner ? fCacheReference : NULL;
+
+		if (fOffsets != NULL)
+			painter->DrawString(fString, fLength, fOffsets, cacheReference);
+		else {
+			painter->DrawString(fString, fLength, fBaseLine, fDelta,
+				cacheReference);
+		}
+	}
+
+private:
+	Painter*			fOwner;
+	const char*			fString;
+	int32				fLength;
+	BPoint				fBaseLine;
+	const escapement_delta* fDelta;
+	const BPoint*		fOffsets;
+	FontCacheReference*	fCacheReference;
+};
+
+
 //	#pragma mark -
 
 
@@ -636,7 +912,15 @@ DrawingEngine::DrawBitmap(ServerBitmap* bitmap, const BRect& bitmapRect,
 	ASSERT_PARALLEL_LOCKED();
 
 	DrawTransaction transaction(this, fPainter->TransformAndClipRect(viewRect));
-	if (transaction.IsDirty())
+	if (!transaction.IsDirty())
+		return;
+
+	// bitmaps in other color spaces are converted by each call, that is for
+	// each tile
+	if (bitmap->ColorSpace() == B_RGBA32 || bitmap->ColorSpace() == B_RGB32) {
+		BitmapOperation operation(bitmap, bitmapRect, viewRect, options);
+		transaction.Draw(operation);
+	} else
 		fPainter->DrawBitmap(bitmap, bitmapRect, viewRect, options);
 }
 
@@ -662,10 +946,8 @@ DrawingEngine::DrawArc(BRect r, const float& angle, const float& span,
 	BPoint center(r.left + xRadius,
 				  r.top + yRadius);
 
-	if (filled)
-		fPainter->FillArc(center, xRadius, yRadius, angle, span);
-	else
-		fPainter->StrokeArc(center, xRadius, yRadius, angle, span);
+	ArcOperation operation(center, xRadius, yRadius, angle, span, filled);
+	transaction.Draw(operation);
 }
 
 
@@ -686,7 +968,9 @@ DrawingEngine::FillArc(BRect r, const float& angle, const float& span,
 	BPoint center(r.left + xRadius,
 				  r.top + yRadius);
 
-	fPainter->FillArc(center, xRadius, yRadius, angle, span, gradient);
+	ArcOperation operation(center, xRadius, yRadius, angle, span, true,
+		&gradient);
+	transaction.Draw(operation);
 }
 
 
@@ -735,7 +1019,8 @@ DrawingEngine::DrawEllipse(BRect r, bool filled)
 	if (!transaction.IsDirty())
 		return;
 
-	fPainter->DrawEllipse(r, filled);
+	EllipseOperation operation(r, filled);
+	transaction.Draw(operation);
 }
 
 
@@ -757,7 +1042,8 @@ DrawingEngine::FillEllipse(BRect r, const BGradient& gradient)
 	if (!transaction.IsDirty())
 		return;
 
-	fPainter->FillEllipse(r, gradient);
+	EllipseOperation operation(r, true, &gradient);
+	transaction.Draw(operation);
 }
 
 
@@ -774,7 +1060,8 @@ DrawingEngine::DrawPolygon(BPoint* ptlist, int32 numpts, BRect bounds,
 	if (!transaction.IsDirty())
 		return;
 
-	fPainter->DrawPolygon(ptlist, numpts, filled, closed);
+	PolygonOperation operation(ptlist, numpts, filled, closed);
+	transaction.Draw(operation);
 }
 
 
@@ -789,7 +1076,8 @@ DrawingEngine::FillPolygon(BPoint* ptlist, int32 numpts, BRect bounds,
 	if (!transaction.IsDirty())
 		return;
 
-	fPainter->FillPolygon(ptlist, numpts, gradient, closed);
+	PolygonOperation operation(ptlist, numpts, true, closed, &gradient);
+	transaction.Draw(operation);
 }
 
 
@@ -857,7 +1145,8 @@ DrawingEngine::FillRect(BRect r, const rgb_color& color)
 	if (!transaction.IsDirty())
 		return;
 
-	fPainter->FillRect(r, color);
+	ColorRectOperation operation(r, color);
+	transaction.Draw(operation);
 }
 
 
@@ -924,7 +1213,8 @@ DrawingEngine::FillRect(BRect r)
 	if (!transaction.IsDirty())
 		return;
 
-	fPainter->FillRect(r);
+	RectOperation operation(r);
+	transaction.Draw(operation);
 }
 
 
@@ -940,7 +1230,8 @@ DrawingEngine::FillRect(BRect r, const BGradient& gradient)
 	if (!transaction.IsDirty())
 		return;
 
-	fPainter->FillRect(r, gradient);
+	RectOperation operation(r, &gradient);
+	transaction.Draw(operation);
 }
 
 
@@ -954,9 +1245,8 @@ DrawingEngine::FillRegion(BRegion& r)
 	if (!transaction.IsDirty())
 		return;
 
-	int32 count = r.CountRects();
-	for (int32 i = 0; i < count; i++)
-		fPainter->FillRect(r.RectAt(i));
+	RegionOperation operation(r);
+	transaction.Draw(operation);
 }
 
 
@@ -970,9 +1260,8 @@ DrawingEngine::FillRegion(BRegion& r, const BGradient& gradient)
 	if (!transaction.IsDirty())
 		return;
 
-	int32 count = r.CountRects();
-	for (int32 i = 0; i < count; i++)
-		fPainter->FillRect(r.RectAt(i), gradient);
+	RegionOperation operation(r, &gradient);
+	transaction.Draw(operation);
 }
 
 
@@ -995,10 +1284,8 @@ DrawingEngine::DrawRoundRect(BRect r, float xrad, float yrad, bool filled)
 	if (!transaction.IsDirty())
 		return;
 
-	if (filled)
-		fPainter->FillRoundRect(r, xrad, yrad);
-	else
-		fPainter->StrokeRoundRect(r, xrad, yrad);
+	RoundRectOperation operation(r, xrad, yrad, filled);
+	transaction.Draw(operation);
 }
 
 
@@ -1020,7 +1307,8 @@ DrawingEngine::FillRoundRect(BRect r, float xrad, float yrad,
 	if (!transaction.IsDirty())
 		return;
 
-	fPainter->FillRoundRect(r, xrad, yrad, gradient);
+	RoundRectOperation operation(r, xrad, yrad, true, &gradient);
+	transaction.Draw(operation);
 }
 
 
@@ -1224,7 +1512,9 @@ DrawingEngine::DrawString(const char* string, int32 length,
 //printf("bounding box '%s': %lld µs\n", string, system_time() - now);
 
 //now = system_time();
-		fPainter->DrawString(string, length, pt, delta, &cacheReference);
+		StringOperation operation(fPainter.Get(), string, length, pt, delta,
+			NULL, &cacheReference);
+		transaction.Draw(operation);
 //printf("drawing string: %lld µs\n", system_time() - now);
 	}
 
@@ -1251,7 +1541,9 @@ DrawingEngine::DrawString(const char* string, int32 length,
 //printf("bounding box '%s': %lld µs\n", string, system_time() - now);
 
 //now = system_time();
-		fPainter->DrawString(string, length, offsets, &cacheReference);
+		StringOperation operation(fPainter.Get(), string, length, B_ORIGIN,
+			NULL, offsets, &cacheReference);
+		transaction.Draw(operation);
 //printf("drawing string: %lld µs\n", system_time() - now);
 	}
 
@@ -60,6 +60,7 @@
 #include "RenderingBuffer.h"
 #include "ServerBitmap.h"
 #include "ServerFont.h"
+#include "SIMDBlending.h"
 #include "SystemPalette.h"
 
 #include "AppServer.h"
@@ -107,8 +108,29 @@ using std::nothrow;
 
 
 static uint32 detect_simd();
+static const SIMDBlendFunctions* select_blend_functions(uint32 simdFlags);
 
 uint32 gSIMDFlags = detect_simd();
+const SIMDBlendFunctions* gSIMDBlendFunctions
+	= select_blend_functions(gSIMDFlags);
+
+
+#if defined(__i386__) || defined(__x86_64__)
+
+/*!	Returns whether the OS saves the AVX state on context switches.
+*/
+static bool
+avx_state_enabled()
+{
+	uint32 low;
+	uint32 high;
+	// xgetbv, not known to all assemblers
+	__asm__ __volatile__(".byte 0x0f, 0x01, 0xd0"
+		: "=a" (low), "=d" (high) : "c" (0));
+	return (low & 0x6) == 0x6;
+}
+
+#endif
 
 
 /*!	Detect SIMD flags for use in AppServer. Checks all CPUs in the system
@@ -117,7 +139,7 @@ uint32 gSIMDFlags = detect_simd();
 static uint32
 detect_simd()
 {
-#if __i386__
+#if defined(__i386__) || defined(__x86_64__)
 	// Only scan CPUs for which we are certain the SIMD flags are properly
 	// defined.
 	const char* vendorNames[] = {
@@ -127,6 +149,7 @@ detect_simd()
 		"RiseRiseRise", // should be MMX-only
 		"CyrixInstead", // MMX-only, but custom MMX extensions
 		"GenuineTMx86", // MMX and SSE
+		"HygonGenuine", // AMD derived
 		0
 	};
 
@@ -156,25 +179,57 @@ detect_simd()
 		uint32 cpuSIMD = 0;
 		uint32 maxStdFunc = cpuInfo.regs.eax;
 		if (vendorFound && maxStdFunc >= 1) {
-			get_cpuid(&cpuInfo, 1, 0);
+			get_cpuid(&cpuInfo, 1, cpu);
 			uint32 edx = cpuInfo.regs.edx;
+			uint32 ecx = cpuInfo.regs.ecx;
 			if (edx & (1 << 23))
 				cpuSIMD |= APPSERVER_SIMD_MMX;
 			if (edx & (1 << 25))
 				cpuSIMD |= APPSERVER_SIMD_SSE;
+			if (edx & (1 << 26))
+				cpuSIMD |= APPSERVER_SIMD_SSE2;
+
+			// AVX2 also needs the OS to save the upper halves of the
+			// registers (OSXSAVE and AVX set, and enabled in XCR0)
+			if (maxStdFunc >= 7 && (ecx & (1 << 27)) != 0
+				&& (ecx & (1 << 28)) != 0 && avx_state_enabled()) {
+				get_cpuid(&cpuInfo, 7, cpu);
+				if (cpuInfo.regs.ebx & (1 << 5))
+					cpuSIMD |= APPSERVER_SIMD_AVX2;
+			}
 		} else {
 			// no flags can be identified
 			cpuSIMD = 0;
 		}
 		systemSIMD &= cpuSIMD;
 	}
+#ifdef __x86_64__
+	// part of the architecture
+	systemSIMD |= APPSERVER_SIMD_SSE2;
+#endif
 	return systemSIMD;
-#else	// !__i386__
+#else	// !__i386__ && !__x86_64__
 	return 0;
 #endif
 }
 
 
+/*!	Chooses the versions of the blending functions for the drawing modes that
+	have SIMD implementations.
+*/
+static const SIMDBlendFunctions*
+select_blend_functions(uint32 simdFlags)
+{
+#ifdef APPSERVER_SIMD_BLENDING
+	if ((simdFlags & APPSERVER_SIMD_AVX2) != 0)
+		return &kAVX2BlendFunctions;
+	if ((simdFlags & APPSERVER_SIMD_SSE2) != 0)
+		return &kSSE2BlendFunctions;
+#endif
+	return NULL;
+}
+
+
 // Gradients and strings don't use patterns, but we want the special handling
 // we have for solid patterns in certain modes to get the expected results for
 // border antialiasing.
@@ -216,6 +271,7 @@ Painter::Painter()
 	fLineCapMode(B_BUTT_CAP),
 	fLineJoinMode(B_MITER_JOIN),
 	fMiterLimit(B_DEFAULT_MITER_LIMIT),
+	fFillRule(B_NONZERO),
 
 	fPatternHandler(),
 	fTextRenderer(fSubpixRenderer, fRenderer, fRendererBin, fUnpackedScanline,
@@ -368,6 +424,65 @@ Painter::ConstrainClipping(const BRegion* region)
 }
 
 
+/*!	Used by the TiledRenderer to let this painter draw one tile of whatever
+	\a painter is asked to draw. \a tileClipping has to be a part of the
+	clipping region of \a painter, and must stay valid while drawing.
+
+	The rasterizers still clip to the frame of the whole clipping region, so
+	that the cells at the tile borders get exactly the same coverage values as
+	when \a painter draws everything itself. Only the spans are clipped to the
+	tile.
+	Since the scanline of an alpha mask cannot be shared between threads,
+	\a painter must not use one.
+*/
+void
+Painter::AdoptState(const Painter& painter, const BRegion* tileClipping)
+{
+	fBuffer.attach(painter.fBuffer.buf(), painter.fBuffer.width(),
+		painter.fBuffer.height(), painter.fBuffer.stride());
+	fAttached = painter.fAttached;
+
+	fSubpixelPrecise = painter.fSubpixelPrecise;
+	fIdentityTransform = painter.fIdentityTransform;
+	fTransform = painter.fTransform;
+	fPenSize = painter.fPenSize;
+	fLineCapMode = painter.fLineCapMode;
+	fLineJoinMode = painter.fLineJoinMode;
+	fMiterLimit = painter.fMiterLimit;
+	SetFillRule(painter.fFillRule);
+
+	fPatternHandler = painter.fPatternHandler;
+	fDrawingMode = painter.fDrawingMode;
+	fAlphaSrcMode = painter.fAlphaSrcMode;
+	fAlphaFncMode = painter.fAlphaFncMode;
+	_UpdateDrawingMode();
+
+	fRenderer.color(painter.fRenderer.color());
+	fSubpixRenderer.color(painter.fSubpixRenderer.color());
+	fRendererBin.color(painter.fRendererBin.color());
+
+	fTextRenderer.SetFont(painter.fTextRenderer.Font());
+	fTextRenderer.SetHinting(painter.fTextRenderer.Hinting());
+	fTextRenderer.SetAntialiasing(painter.fTextRenderer.Antialiasing());
+
+	fMaskedUnpackedScanline = NULL;
+	fClippedAlphaMask = NULL;
+
+	fBaseRenderer.set_offset(painter.fBaseRenderer.offset_x(),
+		painter.fBaseRenderer.offset_y());
+
+	fClippingRegion = tileClipping;
+	fBaseRenderer.set_clipping_region(const_cast<BRegion*>(tileClipping));
+	fValidClipping = painter.fValidClipping && tileClipping->Frame().IsValid();
+
+	if (painter.fValidClipping) {
+		clipping_rect cb = painter.fClippingRegion->FrameInt();
+		fRasterizer.clip_box(cb.left, cb.top, cb.right + 1, cb.bottom + 1);
+		fSubpixRasterizer.clip_box(cb.left, cb.top, cb.right + 1, cb.bottom + 1);
+	}
+}
+
+
 void
 Painter::SetTransform(BAffineTransform transform, int32 xOffset, int32 yOffset)
 {
@@ -450,6 +565,8 @@ Painter::SetStrokeMode(cap_mode lineCap, join_mode joinMode, float miterLimit)
 void
 Painter::SetFillRule(int32 fillRule)
 {
+	fFillRule = fillRule;
+
 	agg::filling_rule_e aggFillRule = fillRule == B_EVEN_ODD
 		? agg::fill_even_odd : agg::fill_non_zero;
 
@@ -1038,6 +1155,8 @@ Painter::FillRectVerticalGradient(BRect r,
 
 	// Make sure the color array is no larger than the screen height.
 	r = r & fClippingRegion->Frame();
+	if (!r.IsValid())
+		return;
 
 	int32 gradientArraySize = r.IntegerHeight() + 1;
 	uint32 gradientArray[gradientArraySize];
@@ -46,6 +46,8 @@ class ServerFont;
 // Defines for SIMD support.
 #define APPSERVER_SIMD_MMX	(1 << 0)
 #define APPSERVER_SIMD_SSE	(1 << 1)
+#define APPSERVER_SIMD_SSE2	(1 << 2)
+#define APPSERVER_SIMD_AVX2	(1 << 3)
 
 
 class Painter {
@@ -66,6 +68,14 @@ public:
 			const BRegion*		ClippingRegion() const
 									{ return fClippingRegion; }
 
+			// makes this painter draw like the given one, but only into
+			// the part of its clipping region given by tileClipping
+			void				AdoptState(const Painter& painter,
+									const BRegion* tileClipping);
+			bool				HasAlphaMask() const
+									{ return fInternal.fMaskedUnpackedScanline
+										!= NULL; }
+
 								// object settings
 			void				SetTransform(BAffineTransform transform,
 									int32 xOffset, int32 yOffset);
@@ -346,6 +356,7 @@ private:
 			cap_mode			fLineCapMode;
 			join_mode			fLineJoinMode;
 			float				fMiterLimit;
+			int32				fFillRule;
 
 			PatternHandler		fPatternHandler;
 
@@ -147,6 +147,9 @@ namespace agg
 			}
 		}
 
+		int offset_x() const { return m_offset_x; }
+		int offset_y() const { return m_offset_y; }
+
 		//--------------------------------------------------------------------
 		void translate_to_base_ren_x(int& x)
 		{
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 versions of the inner loops of the scaling bitmap painters.
+ *
+ */
+
+#include <emmintrin.h>
+
+#include <SupportDefs.h>
+
+
+struct filter_info {
+	uint16	index;
+	uint16	weight;
+};
+
+
+/*!	Bilinear interpolation of B_RGB32 pixels, like BilinearDefault with
+	ColorTypeRgb and DrawModeCopy. Instead of interpolating the left and right
+	pixel and then the rows, the rows are interpolated first, which gives the
+	same result as the scalar code, but fits into 16 bits until the last step.
+	The alpha channel of the destination is left alone.
+*/
+static inline __m128i
+interpolate(const uint8* s, uint32 sourceBytesPerRow, const filter_info& info,
+	__m128i wTop, __m128i wBottom)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	// the left and right pixel of both rows
+	__m128i top = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)s), zero);
+	__m128i bottom = _mm_unpacklo_epi8(
+		_mm_loadl_epi64((const __m128i*)(s + sourceBytesPerRow)), zero);
+
+	__m128i vertical = _mm_add_epi16(_mm_mullo_epi16(top, wTop),
+		_mm_mullo_epi16(bottom, wBottom));
+
+	__m128i weights = _mm_unpacklo_epi64(_mm_set1_epi16(info.weight),
+		_mm_set1_epi16(255 - info.weight));
+	__m128i low = _mm_mullo_epi16(vertical, weights);
+	__m128i high = _mm_mulhi_epu16(vertical, weights);
+
+	__m128i sum = _mm_add_epi32(_mm_unpacklo_epi16(low, high),
+		_mm_unpackhi_epi16(low, high));
+	return _mm_srli_epi32(sum, 16);
+}
+
+
+void
+bilinear_scale_xloop_sse2(const uint8* src, void* dst, void* xWeights,
+	uint32 xmin, uint32 xmax, uint32 wTop, uint32 srcBPR)
+{
+	const filter_info* weights = (const filter_info*)xWeights;
+	const __m128i top = _mm_set1_epi16(wTop);
+	const __m128i bottom = _mm_set1_epi16(255 - wTop);
+	const __m128i alphaMask = _mm_set1_epi32(0xff000000);
+
+	uint8* d = (uint8*)dst;
+	int32 x = (int32)xmin;
+	for (; x + 1 <= (int32)xmax; x += 2) {
+		__m128i first = interpolate(src + weights[x].index, srcBPR,
+			weights[x], top, bottom);
+		__m128i second = interpolate(src + weights[x + 1].index, srcBPR,
+			weights[x + 1], top, bottom);
+		__m128i pixels = _mm_packs_epi32(first, second);
+		pixels = _mm_packus_epi16(pixels, pixels);
+
+		__m128i destination = _mm_loadl_epi64((const __m128i*)d);
+		pixels = _mm_or_si128(_mm_andnot_si128(alphaMask, pixels),
+			_mm_and_si128(alphaMask, destination));
+		_mm_storel_epi64((__m128i*)d, pixels);
+		d += 8;
+	}
+
+	if (x <= (int32)xmax) {
+		__m128i pixel = interpolate(src + weights[x].index, srcBPR,
+			weights[x], top, bottom);
+		pixel = _mm_packs_epi32(pixel, pixel);
+		pixel = _mm_packus_epi16(pixel, pixel);
+
+		uint32 result = (uint32)_mm_cvtsi128_si32(pixel);
+		*(uint32*)d = (result & 0x00ffffff) | (*(uint32*)d & 0xff000000);
+	}
+}
+
+
+/*!	Nearest neighbor scaling of one row, four pixels at a time.
+*/
+void
+scale_nearest_row_sse2(uint32* dst, const uint8* src, const uint16* xIndices,
+	int32 count)
+{
+	for (; count >= 4; count -= 4) {
+		__m128i pixels = _mm_setr_epi32(
+			*(const int32*)(src + xIndices[0]),
+			*(const int32*)(src + xIndices[1]),
+			*(const int32*)(src + xIndices[2]),
+			*(const int32*)(src + xIndices[3]));
+		_mm_storeu_si128((__m128i*)dst, pixels);
+		dst += 4;
+		xIndices += 4;
+	}
+
+	for (; count > 0; count--)
+		*dst++ = *(const uint32*)(src + *xIndices++);
+}
@@ -9,6 +9,7 @@
 #define DRAW_BITMAP_BILINEAR_H
 
 #include "Painter.h"
+#include "SIMDBlending.h"
 
 #include <typeinfo>
 
@@ -19,10 +20,35 @@ extern "C" {
 		void* xWeights, uint32 xmin, uint32 xmax, uint32 wTop, uint32 srcBPR);
 }
 
+void bilinear_scale_xloop_sse2(const uint8* src, void* dst, void* xWeights,
+	uint32 xmin, uint32 xmax, uint32 wTop, uint32 srcBPR);
+
+typedef void (*bilinear_scale_xloop_func)(const uint8* src, void* dst,
+	void* xWeights, uint32 xmin, uint32 xmax, uint32 wTop, uint32 srcBPR);
+
 
 extern uint32 gSIMDFlags;
 
 
+/*!	Returns the fastest version of the inner loop of BilinearSimd the CPU
+	supports, or NULL if there is none.
+*/
+static inline bilinear_scale_xloop_func
+bilinear_scale_xloop_simd()
+{
+#ifdef APPSERVER_SIMD_BLENDING
+	if ((gSIMDFlags & APPSERVER_SIMD_SSE2) != 0)
+		return bilinear_scale_xloop_sse2;
+#endif
+#ifdef __i386__
+	uint32 neededSIMDFlags = APPSERVER_SIMD_MMX | APPSERVER_SIMD_SSE;
+	if ((gSIMDFlags & neededSIMDFlags) == neededSIMDFlags)
+		return bilinear_scale_xloop_mmxsse;
+#endif
+	return NULL;
+}
+
+
 namespace BitmapPainterPrivate {
 
 
@@ -405,9 +431,13 @@ struct BilinearLowFilterRatio :
 };
 
 
-#ifdef __i386__
-
 struct BilinearSimd : DrawBitmapBilinearOptimized<BilinearSimd> {
+	BilinearSimd(bilinear_scale_xloop_func xLoop)
+		:
+		fXLoop(xLoop)
+	{
+	}
+
 	void DrawToClipRect(int32 xIndexL, int32 xIndexR, int32 y1, int32 y2)
 	{
 		// Basically the same as the "standard" mode, but we use SIMD
@@ -432,8 +462,8 @@ struct BilinearSimd : DrawBitmapBilinearOptimized<BilinearSimd> {
 			// buffer handle for destination to be incremented per
 			// pixel
 			uint8* d = fDestination;
-			bilinear_scale_xloop_mmxsse(src, fDestination, fWeightsX, xIndexL,
-				xIndexMax, wTop, fSourceBytesPerRow);
+			fXLoop(src, fDestination, fWeightsX, xIndexL, xIndexMax, wTop,
+				fSourceBytesPerRow);
 			// increase pointer by processed pixels
 			d += (xIndexMax - xIndexL + 1) * 4;
 
@@ -473,9 +503,10 @@ struct BilinearSimd : DrawBitmapBilinearOptimized<BilinearSimd> {
 			*(uint32*)d = *(uint32*)s;
 		}
 	}
-};
 
-#endif	// __i386__
+private:
+	bilinear_scale_xloop_func	fXLoop;
+};
 
 
 template<class ColorType, class DrawMode>
@@ -595,11 +626,14 @@ struct DrawBitmapBilinear {
 		};
 
 		int codeSelect = kUseDefaultVersion;
+		bilinear_scale_xloop_func xLoop = NULL;
 
 		if (typeid(ColorType) == typeid(ColorTypeRgb)
 			&& typeid(DrawMode) == typeid(DrawModeCopy)) {
-			uint32 neededSIMDFlags = APPSERVER_SIMD_MMX | APPSERVER_SIMD_SSE;
-			if ((gSIMDFlags & neededSIMDFlags) == neededSIMDFlags)
+			// the SIMD version always reads the row below
+			if (srcHeight > 1)
+				xLoop = bilinear_scale_xloop_simd();
+			if (xLoop != NULL)
 				codeSelect = kUseSIMDVersion;
 			else {
 				if (scaleX == scaleY && (scaleX == 1.5 || scaleX == 2.0
@@ -626,15 +660,13 @@ struct DrawBitmapBilinear {
 				break;
 			}
 
-#ifdef __i386__
 			case kUseSIMDVersion:
 			{
-				BilinearSimd bilinearPainter;
+				BilinearSimd bilinearPainter(xLoop);
 				bilinearPainter.Draw(aggInterface, destinationRect, &bitmap,
 					filterData);
 				break;
 			}
-#endif	// __i386__
 		}
 
 #ifdef FILTER_INFOS_ON_HEAP
@@ -9,6 +9,13 @@
 #define DRAW_BITMAP_NEAREST_NEIGHBOR_H
 
 #include "Painter.h"
+#include "SIMDBlending.h"
+
+
+void scale_nearest_row_sse2(uint32* dst, const uint8* src,
+	const uint16* xIndices, int32 count);
+
+extern uint32 gSIMDFlags;
 
 
 struct DrawBitmapNearestNeighborCopy {
@@ -93,6 +100,10 @@ struct DrawBitmapNearestNeighborCopy {
 
 		renderer_base& baseRenderer = aggInterface.fBaseRenderer;
 
+#ifdef APPSERVER_SIMD_BLENDING
+		const bool useSSE2 = (gSIMDFlags & APPSERVER_SIMD_SSE2) != 0;
+#endif
+
 		// iterate over clipping boxes
 		baseRenderer.first_clip_box();
 		do {
@@ -125,6 +136,14 @@ struct DrawBitmapNearestNeighborCopy {
 				// buffer handle for destination to be incremented per pixel
 				uint32* d = (uint32*)dst;
 
+#ifdef APPSERVER_SIMD_BLENDING
+				if (useSSE2) {
+					scale_nearest_row_sse2(d, src, &xIndices[xIndexL],
+						xIndexR - xIndexL + 1);
+					dst += dstBPR;
+					continue;
+				}
+#endif
 				for (int32 x = xIndexL; x <= xIndexR; x++) {
 					*d = *(uint32*)(src + xIndices[x]);
 					d++;
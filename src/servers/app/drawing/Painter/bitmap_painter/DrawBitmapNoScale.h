@@ -11,6 +11,7 @@
 #include "IntPoint.h"
 #include "IntRect.h"
 #include "Painter.h"
+#include "SIMDBlending.h"
 #include "SystemPalette.h"
 
 
@@ -150,6 +151,11 @@ struct Bgr32Alpha : public DrawBitmapNoScale<Bgr32Alpha>
 {
 	void BlendRow(uint8* dst, const uint8* src, int32 numPixels)
 	{
+		if (gSIMDBlendFunctions != NULL) {
+			gSIMDBlendFunctions->blend_bitmap_row_alpha(dst, src, numPixels);
+			return;
+		}
+
 		uint32* d = (uint32*)dst;
 		int32 bytes = numPixels * 4;
 		uint8 buffer[bytes];
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * Versions of the B_OP_COPY, B_OP_OVER and B_OP_ALPHA (B_PIXEL_ALPHA,
+ * B_ALPHA_OVERLAY) blending functions on B_RGBA32 that use the
+ * SIMDBlendFunctions chosen for the CPU. They may only be used if
+ * gSIMDBlendFunctions is set.
+ *
+ */
+
+#ifndef DRAWING_MODE_SIMD_H
+#define DRAWING_MODE_SIMD_H
+
+#include "DrawingMode.h"
+#include "SIMDBlending.h"
+
+#ifdef APPSERVER_SIMD_BLENDING
+
+
+// simd_pixel_for
+static inline uint32
+simd_pixel_for(const color_type& c)
+{
+	return 0xff000000 | (c.r << 16) | (c.g << 8) | c.b;
+}
+
+// blend_hline_copy_solid_simd
+void
+blend_hline_copy_solid_simd(int x, int y, unsigned len,
+							const color_type& c, uint8 cover,
+							agg_buffer* buffer, const PatternHandler* pattern)
+{
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+	if (cover == 255)
+		gSIMDBlendFunctions->fill(p, len, simd_pixel_for(c));
+	else
+		gSIMDBlendFunctions->blend_solid(p, len, simd_pixel_for(c), cover);
+}
+
+// blend_hline_over_solid_simd
+void
+blend_hline_over_solid_simd(int x, int y, unsigned len,
+							const color_type& c, uint8 cover,
+							agg_buffer* buffer, const PatternHandler* pattern)
+{
+	if (pattern->IsSolidLow())
+		return;
+
+	blend_hline_copy_solid_simd(x, y, len, c, cover, buffer, pattern);
+}
+
+// blend_solid_hspan_copy_solid_simd
+void
+blend_solid_hspan_copy_solid_simd(int x, int y, unsigned len,
+								  const color_type& c, const uint8* covers,
+								  agg_buffer* buffer,
+								  const PatternHandler* pattern)
+{
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+	gSIMDBlendFunctions->blend_solid_covers(p, len, simd_pixel_for(c),
+		covers);
+}
+
+// blend_solid_hspan_over_solid_simd
+void
+blend_solid_hspan_over_solid_simd(int x, int y, unsigned len,
+								  const color_type& c, const uint8* covers,
+								  agg_buffer* buffer,
+								  const PatternHandler* pattern)
+{
+	if (pattern->IsSolidLow())
+		return;
+
+	blend_solid_hspan_copy_solid_simd(x, y, len, c, covers, buffer, pattern);
+}
+
+// blend_color_hspan_copy_solid_simd
+void
+blend_color_hspan_copy_solid_simd(int x, int y, unsigned len,
+								  const color_type* colors,
+								  const uint8* covers, uint8 cover,
+								  agg_buffer* buffer,
+								  const PatternHandler* pattern)
+{
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+	gSIMDBlendFunctions->blend_colors(p, len, (const uint8*)colors, covers,
+		cover, false);
+}
+
+// blend_color_hspan_over_simd
+void
+blend_color_hspan_over_simd(int x, int y, unsigned len,
+							const color_type* colors,
+							const uint8* covers, uint8 cover,
+							agg_buffer* buffer, const PatternHandler* pattern)
+{
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+	gSIMDBlendFunctions->blend_colors(p, len, (const uint8*)colors, covers,
+		cover, true);
+}
+
+// blend_solid_hspan_alpha_po_solid_simd
+void
+blend_solid_hspan_alpha_po_solid_simd(int x, int y, unsigned len,
+									  const color_type& c,
+									  const uint8* covers,
+									  agg_buffer* buffer,
+									  const PatternHandler* pattern)
+{
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+	gSIMDBlendFunctions->blend_solid_alpha_covers(p, len, simd_pixel_for(c),
+		c.a, covers);
+}
+
+// blend_color_hspan_alpha_po_simd
+void
+blend_color_hspan_alpha_po_simd(int x, int y, unsigned len,
+								const color_type* colors,
+								const uint8* covers, uint8 cover,
+								agg_buffer* buffer,
+								const PatternHandler* pattern)
+{
+	uint8* p = buffer->row_ptr(y) + (x << 2);
+	gSIMDBlendFunctions->blend_colors_alpha(p, len, (const uint8*)colors,
+		covers, cover);
+}
+
+
+#endif // APPSERVER_SIMD_BLENDING
+
+#endif // DRAWING_MODE_SIMD_H
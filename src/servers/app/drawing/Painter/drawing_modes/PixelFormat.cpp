@@ -54,8 +54,20 @@
 #include "DrawingModeSelectSUBPIX.h"
 #include "DrawingModeSubtractSUBPIX.h"
 
+#include "DrawingModeSIMD.h"
+
 #include "PatternHandler.h"
 
+
+// Picks the SIMD version of a blending function when the CPU supports it.
+#ifdef APPSERVER_SIMD_BLENDING
+#	define SIMD_OR_SCALAR(function) \
+		(gSIMDBlendFunctions != NULL ? function##_simd : function)
+#else
+#	define SIMD_OR_SCALAR(function) function
+#endif
+
+
 // blend_pixel_empty
 void
 blend_pixel_empty(int x, int y, const color_type& c, uint8 cover,
@@ -165,8 +177,8 @@ PixelFormat::SetDrawingMode(drawing_mode mode, source_alpha alphaSrcMode,
 		case B_OP_OVER:
 			if (fPatternHandler->IsSolid()) {
 				fBlendPixel = blend_pixel_over_solid;
-				fBlendHLine = blend_hline_over_solid;
-				fBlendSolidHSpan = blend_solid_hspan_over_solid;
+				fBlendHLine = SIMD_OR_SCALAR(blend_hline_over_solid);
+				fBlendSolidHSpan = SIMD_OR_SCALAR(blend_solid_hspan_over_solid);
 				fBlendSolidVSpan = blend_solid_vspan_over_solid;
 				fBlendSolidHSpanSubpix = blend_solid_hspan_over_solid_subpix;
 			} else {
@@ -176,7 +188,7 @@ PixelFormat::SetDrawingMode(drawing_mode mode, source_alpha alphaSrcMode,
 				fBlendSolidHSpan = blend_solid_hspan_over;
 				fBlendSolidVSpan = blend_solid_vspan_over;
 			}
-			fBlendColorHSpan = blend_color_hspan_over;
+			fBlendColorHSpan = SIMD_OR_SCALAR(blend_color_hspan_over);
 			break;
 		case B_OP_ERASE:
 			fBlendPixel = blend_pixel_erase;
@@ -208,11 +220,13 @@ PixelFormat::SetDrawingMode(drawing_mode mode, source_alpha alphaSrcMode,
 		case B_OP_COPY:
 			if (fPatternHandler->IsSolid()) {
 				fBlendPixel = blend_pixel_copy_solid;
-				fBlendHLine = blend_hline_copy_solid;
+				fBlendHLine = SIMD_OR_SCALAR(blend_hline_copy_solid);
 				fBlendSolidHSpanSubpix = blend_solid_hspan_copy_solid_subpix;
-				fBlendSolidHSpan = blend_solid_hspan_copy_solid;
+				fBlendSolidHSpan
+					= SIMD_OR_SCALAR(blend_solid_hspan_copy_solid);
 				fBlendSolidVSpan = blend_solid_vspan_copy_solid;
-				fBlendColorHSpan = blend_color_hspan_copy_solid;
+				fBlendColorHSpan
+					= SIMD_OR_SCALAR(blend_color_hspan_copy_solid);
 			} else {
 				fBlendPixel = blend_pixel_copy;
 				fBlendHLine = blend_hline_copy;
@@ -302,7 +316,8 @@ PixelFormat::SetDrawingMode(drawing_mode mode, source_alpha alphaSrcMode,
 						fBlendPixel = blend_pixel_alpha_po_solid;
 						fBlendHLine = blend_hline_alpha_po_solid;
 						fBlendSolidHSpanSubpix = blend_solid_hspan_alpha_po_solid_subpix;
-						fBlendSolidHSpan = blend_solid_hspan_alpha_po_solid;
+						fBlendSolidHSpan
+							= SIMD_OR_SCALAR(blend_solid_hspan_alpha_po_solid);
 						fBlendSolidVSpan = blend_solid_vspan_alpha_po_solid;
 					} else {
 						fBlendPixel = blend_pixel_alpha_po;
@@ -311,7 +326,8 @@ PixelFormat::SetDrawingMode(drawing_mode mode, source_alpha alphaSrcMode,
 						fBlendSolidHSpan = blend_solid_hspan_alpha_po;
 						fBlendSolidVSpan = blend_solid_vspan_alpha_po;
 					}
-					fBlendColorHSpan = blend_color_hspan_alpha_po;
+					fBlendColorHSpan
+						= SIMD_OR_SCALAR(blend_color_hspan_alpha_po);
 				} else if (alphaFncMode == B_ALPHA_COMPOSITE) {
 					if (fPatternHandler->IsSolid()) {
 						fBlendPixel = blend_pixel_alpha_pc_solid;
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 and AVX2 versions of the inner loops of the most frequently used
+ * drawing modes on B_RGBA32.
+ *
+ */
+#ifndef SIMD_BLENDING_H
+#define SIMD_BLENDING_H
+
+#include <SupportDefs.h>
+
+
+#if (defined(__i386__) || defined(__x86_64__)) && __GNUC__ >= 4
+#	define APPSERVER_SIMD_BLENDING 1
+#endif
+
+
+/*!	The functions work on rows of B_RGBA32 pixels and produce exactly the
+	same pixels as the scalar code in the DrawingMode*.h headers, including
+	its quirks. Colors are passed as B_RGBA32 values with an alpha of 255,
+	color spans as agg::rgba8 arrays, covers are in the range 0..255.
+*/
+struct SIMDBlendFunctions {
+	// B_OP_COPY and B_OP_OVER with a solid pattern
+	void	(*fill)(uint8* p, unsigned len, uint32 color);
+	void	(*blend_solid)(uint8* p, unsigned len, uint32 color,
+				uint8 cover);
+	void	(*blend_solid_covers)(uint8* p, unsigned len, uint32 color,
+				const uint8* covers);
+	void	(*blend_colors)(uint8* p, unsigned len, const uint8* colors,
+				const uint8* covers, uint8 cover, bool skipTransparent);
+
+	// B_OP_ALPHA, B_PIXEL_ALPHA, B_ALPHA_OVERLAY
+	void	(*blend_solid_alpha_covers)(uint8* p, unsigned len, uint32 color,
+				uint8 alpha, const uint8* covers);
+	void	(*blend_colors_alpha)(uint8* p, unsigned len,
+				const uint8* colors, const uint8* covers, uint8 cover);
+
+	// unscaled B_RGBA32 bitmaps with B_OP_ALPHA
+	void	(*blend_bitmap_row_alpha)(uint8* dst, const uint8* src,
+				unsigned len);
+};
+
+
+#ifdef APPSERVER_SIMD_BLENDING
+extern const SIMDBlendFunctions kSSE2BlendFunctions;
+extern const SIMDBlendFunctions kAVX2BlendFunctions;
+#endif
+
+extern const SIMDBlendFunctions* gSIMDBlendFunctions;
+	// NULL if the CPU doesn't support any of the above
+
+
+#endif // SIMD_BLENDING_H
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * AVX2 version of the SIMDBlendFunctions, eight pixels at a time.
+ *
+ */
+
+#include <immintrin.h>
+
+#include "SIMDBlendingImpl.h"
+
+
+namespace {
+
+
+/*!	Unpacking and packing only work within the two 128 bit lanes, but since
+	every unpack is undone by a pack of the same kind, the pixels end up in
+	the right place anyway.
+*/
+struct AVX2Vector {
+	typedef __m256i type;
+
+	enum {
+		kPixels = 8
+	};
+
+	static inline type Load(const uint8* p)
+		{ return _mm256_loadu_si256((const __m256i*)p); }
+	static inline void Store(uint8* p, type v)
+		{ _mm256_storeu_si256((__m256i*)p, v); }
+
+	static inline type Zero()
+		{ return _mm256_setzero_si256(); }
+	static inline type Set8(uint8 value)
+		{ return _mm256_set1_epi8((char)value); }
+	static inline type Set16(uint16 value)
+		{ return _mm256_set1_epi16((short)value); }
+	static inline type Set32(uint32 value)
+		{ return _mm256_set1_epi32((int)value); }
+
+	static inline type And(type a, type b)
+		{ return _mm256_and_si256(a, b); }
+	static inline type AndNot(type a, type b)
+		{ return _mm256_andnot_si256(a, b); }
+	static inline type Or(type a, type b)
+		{ return _mm256_or_si256(a, b); }
+
+	static inline type Add16(type a, type b)
+		{ return _mm256_add_epi16(a, b); }
+	static inline type Sub16(type a, type b)
+		{ return _mm256_sub_epi16(a, b); }
+	static inline type Add32(type a, type b)
+		{ return _mm256_add_epi32(a, b); }
+	static inline type MultiplyLow16(type a, type b)
+		{ return _mm256_mullo_epi16(a, b); }
+	static inline type MultiplyHighUnsigned16(type a, type b)
+		{ return _mm256_mulhi_epu16(a, b); }
+
+	static inline type ShiftRight16(type v, int count)
+		{ return _mm256_srli_epi16(v, count); }
+	static inline type ShiftRight32(type v, int count)
+		{ return _mm256_srli_epi32(v, count); }
+	static inline type ShiftLeft32(type v, int count)
+		{ return _mm256_slli_epi32(v, count); }
+
+	static inline type UnpackLow8(type a, type b)
+		{ return _mm256_unpacklo_epi8(a, b); }
+	static inline type UnpackHigh8(type a, type b)
+		{ return _mm256_unpackhi_epi8(a, b); }
+	static inline type UnpackLow16(type a, type b)
+		{ return _mm256_unpacklo_epi16(a, b); }
+	static inline type UnpackHigh16(type a, type b)
+		{ return _mm256_unpackhi_epi16(a, b); }
+	static inline type PackUnsigned16(type a, type b)
+		{ return _mm256_packus_epi16(a, b); }
+	static inline type PackSigned16(type a, type b)
+		{ return _mm256_packs_epi16(a, b); }
+	static inline type PackSigned32(type a, type b)
+		{ return _mm256_packs_epi32(a, b); }
+
+	static inline type CompareEqual8(type a, type b)
+		{ return _mm256_cmpeq_epi8(a, b); }
+	static inline type CompareEqual16(type a, type b)
+		{ return _mm256_cmpeq_epi16(a, b); }
+	static inline type CompareEqual32(type a, type b)
+		{ return _mm256_cmpeq_epi32(a, b); }
+
+	static inline bool AllSet(type mask)
+		{ return _mm256_movemask_epi8(mask) == -1; }
+	static inline bool IsZero(type mask)
+		{ return _mm256_movemask_epi8(mask) == 0; }
+
+	//! Copies each of the kPixels covers into all bytes of its pixel.
+	static inline type Expand(const uint8* covers)
+	{
+		type v = _mm256_cvtepu8_epi32(
+			_mm_loadl_epi64((const __m128i*)covers));
+		return _mm256_shuffle_epi8(v, _mm256_setr_epi8(
+			0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12,
+			0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12));
+	}
+};
+
+
+typedef SIMDBlending<AVX2Vector> AVX2Blending;
+
+
+}	// namespace
+
+
+const SIMDBlendFunctions kAVX2BlendFunctions = {
+	AVX2Blending::Fill,
+	AVX2Blending::BlendSolid,
+	AVX2Blending::BlendSolidCovers,
+	AVX2Blending::BlendColors,
+	AVX2Blending::BlendSolidAlphaCovers,
+	AVX2Blending::BlendColorsAlpha,
+	AVX2Blending::BlendBitmapRowAlpha
+};
@@ -0,0 +1,427 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * The SIMDBlendFunctions, written against a "Vector" class wrapping the
+ * intrinsics of one instruction set (see SIMDBlendingSSE2.cpp and
+ * SIMDBlendingAVX2.cpp). Only to be included by those files.
+ *
+ */
+#ifndef SIMD_BLENDING_IMPL_H
+#define SIMD_BLENDING_IMPL_H
+
+#include <string.h>
+
+#include "SIMDBlending.h"
+
+
+// The including file is compiled for a specific instruction set, so none of
+// this may end up in a symbol the linker could share with other objects.
+namespace {
+
+
+template<class Vector>
+struct SIMDBlending {
+	typedef typename Vector::type vector;
+
+	enum {
+		kPixels = Vector::kPixels
+	};
+
+	// #pragma mark - helpers
+
+	static inline vector
+	AlphaMask()
+	{
+		return Vector::Set32(0xff000000);
+	}
+
+	static inline vector
+	Select(vector mask, vector a, vector b)
+	{
+		return Vector::Or(Vector::And(mask, a), Vector::AndNot(mask, b));
+	}
+
+	/*!	Converts agg::rgba8 colors into B_RGBA32 pixels with an alpha of 255.
+	*/
+	static inline vector
+	ToPixels(vector colors)
+	{
+		vector green = Vector::And(colors, Vector::Set32(0x0000ff00));
+		vector red = Vector::And(Vector::ShiftLeft32(colors, 16),
+			Vector::Set32(0x00ff0000));
+		vector blue = Vector::And(Vector::ShiftRight32(colors, 16),
+			Vector::Set32(0x000000ff));
+		return Vector::Or(Vector::Or(green, red),
+			Vector::Or(blue, AlphaMask()));
+	}
+
+	/*!	Copies the last byte of every pixel into all of its bytes.
+	*/
+	static inline vector
+	SpreadAlpha(vector pixels)
+	{
+		vector alpha = Vector::ShiftRight32(pixels, 24);
+		alpha = Vector::Or(alpha, Vector::ShiftLeft32(alpha, 8));
+		return Vector::Or(alpha, Vector::ShiftLeft32(alpha, 16));
+	}
+
+	/*!	The BLEND() macro for every byte: (d * (256 - a) + s * a) >> 8 is the
+		same as ((s - d) * a + (d << 8)) >> 8, and never exceeds 16 bits.
+	*/
+	static inline vector
+	Blend(vector d, vector s, vector alpha)
+	{
+		const vector zero = Vector::Zero();
+		const vector k256 = Vector::Set16(256);
+
+		vector a = Vector::UnpackLow8(alpha, zero);
+		vector low = Vector::ShiftRight16(Vector::Add16(
+			Vector::MultiplyLow16(Vector::UnpackLow8(d, zero),
+				Vector::Sub16(k256, a)),
+			Vector::MultiplyLow16(Vector::UnpackLow8(s, zero), a)), 8);
+
+		a = Vector::UnpackHigh8(alpha, zero);
+		vector high = Vector::ShiftRight16(Vector::Add16(
+			Vector::MultiplyLow16(Vector::UnpackHigh8(d, zero),
+				Vector::Sub16(k256, a)),
+			Vector::MultiplyLow16(Vector::UnpackHigh8(s, zero), a)), 8);
+
+		return Vector::PackUnsigned16(low, high);
+	}
+
+	/*!	The BLEND16() macro for 16 bit channels: the alpha is in the range
+		1..65024, so 65536 - alpha still fits into 16 bits, but the sum of
+		the products needs 32 bits.
+	*/
+	static inline vector
+	Blend16Channels(vector d, vector s, vector a)
+	{
+		vector inverse = Vector::Sub16(Vector::Zero(), a);
+		vector dLow = Vector::MultiplyLow16(d, inverse);
+		vector dHigh = Vector::MultiplyHighUnsigned16(d, inverse);
+		vector sLow = Vector::MultiplyLow16(s, a);
+		vector sHigh = Vector::MultiplyHighUnsigned16(s, a);
+
+		vector first = Vector::ShiftRight32(Vector::Add32(
+			Vector::UnpackLow16(dLow, dHigh),
+			Vector::UnpackLow16(sLow, sHigh)), 16);
+		vector second = Vector::ShiftRight32(Vector::Add32(
+			Vector::UnpackHigh16(dLow, dHigh),
+			Vector::UnpackHigh16(sLow, sHigh)), 16);
+
+		return Vector::PackSigned32(first, second);
+	}
+
+	static inline vector
+	Blend16(vector d, vector s, vector alphaLow, vector alphaHigh)
+	{
+		const vector zero = Vector::Zero();
+		return Vector::PackUnsigned16(
+			Blend16Channels(Vector::UnpackLow8(d, zero),
+				Vector::UnpackLow8(s, zero), alphaLow),
+			Blend16Channels(Vector::UnpackHigh8(d, zero),
+				Vector::UnpackHigh8(s, zero), alphaHigh));
+	}
+
+	/*!	Calls \a kernel for every kPixels pixels. The remaining pixels are
+		padded to a full vector; covers are padded with zero, and the padding
+		is never written back.
+	*/
+	template<class Kernel>
+	static inline void
+	ForEachBlock(uint8* p, unsigned len, const uint8* source,
+		const uint8* covers, const Kernel& kernel)
+	{
+		while (len >= kPixels) {
+			kernel.Block(p, source, covers);
+			p += kPixels * 4;
+			if (source != NULL)
+				source += kPixels * 4;
+			if (covers != NULL)
+				covers += kPixels;
+			len -= kPixels;
+		}
+		if (len == 0)
+			return;
+
+		uint8 pixels[kPixels * 4];
+		uint8 sourcePixels[kPixels * 4];
+		uint8 tempCovers[kPixels];
+		memset(pixels, 0, sizeof(pixels));
+		memset(sourcePixels, 0, sizeof(sourcePixels));
+		memset(tempCovers, 0, sizeof(tempCovers));
+
+		memcpy(pixels, p, len * 4);
+		if (source != NULL)
+			memcpy(sourcePixels, source, len * 4);
+		if (covers != NULL)
+			memcpy(tempCovers, covers, len);
+
+		kernel.Block(pixels, source != NULL ? sourcePixels : NULL,
+			covers != NULL ? tempCovers : NULL);
+
+		memcpy(p, pixels, len * 4);
+	}
+
+	// #pragma mark - kernels
+
+	struct SolidKernel {
+		vector	color;
+		vector	cover;
+
+		inline void
+		Block(uint8* p, const uint8*, const uint8*) const
+		{
+			Vector::Store(p, Vector::Or(Blend(Vector::Load(p), color, cover),
+				AlphaMask()));
+		}
+	};
+
+	struct SolidCoversKernel {
+		vector	color;
+
+		inline void
+		Block(uint8* p, const uint8*, const uint8* covers) const
+		{
+			vector cover = Vector::Expand(covers);
+			vector none = Vector::CompareEqual8(cover, Vector::Zero());
+			if (Vector::AllSet(none))
+				return;
+
+			vector full = Vector::CompareEqual8(cover, Vector::Set8(255));
+			if (Vector::AllSet(full)) {
+				Vector::Store(p, color);
+				return;
+			}
+
+			vector d = Vector::Load(p);
+			vector result = Vector::Or(Blend(d, color, cover), AlphaMask());
+			result = Select(full, color, result);
+			Vector::Store(p, Select(none, d, result));
+		}
+	};
+
+	struct ColorsKernel {
+		vector	cover;
+		bool	skipTransparent;
+
+		inline void
+		Block(uint8* p, const uint8* colors, const uint8* covers) const
+		{
+			const vector zero = Vector::Zero();
+			vector source = Vector::Load(colors);
+			vector blockCover = covers != NULL
+				? Vector::Expand(covers) : cover;
+
+			vector skip = Vector::CompareEqual8(blockCover, zero);
+			if (skipTransparent) {
+				skip = Vector::Or(skip, Vector::CompareEqual32(
+					Vector::And(source, AlphaMask()), zero));
+			}
+			if (Vector::AllSet(skip))
+				return;
+
+			vector color = ToPixels(source);
+			vector full = Vector::CompareEqual8(blockCover,
+				Vector::Set8(255));
+			if (Vector::AllSet(full) && Vector::IsZero(skip)) {
+				Vector::Store(p, color);
+				return;
+			}
+
+			vector d = Vector::Load(p);
+			vector result = Vector::Or(Blend(d, color, blockCover),
+				AlphaMask());
+			result = Select(full, color, result);
+			Vector::Store(p, Select(skip, d, result));
+		}
+	};
+
+	struct AlphaCoversKernel {
+		vector	color;
+		vector	colorAlpha;
+
+		inline void
+		Block(uint8* p, const uint8* colors, const uint8* covers) const
+		{
+			const vector zero = Vector::Zero();
+			vector blockColor = color;
+			vector blockColorAlpha = colorAlpha;
+			if (colors != NULL) {
+				vector source = Vector::Load(colors);
+				blockColor = ToPixels(source);
+				blockColorAlpha = SpreadAlpha(source);
+			}
+
+			// alpha = color alpha * cover, in the range 0..65025
+			vector cover = Vector::Expand(covers);
+			vector alphaLow = Vector::MultiplyLow16(
+				Vector::UnpackLow8(blockColorAlpha, zero),
+				Vector::UnpackLow8(cover, zero));
+			vector alphaHigh = Vector::MultiplyLow16(
+				Vector::UnpackHigh8(blockColorAlpha, zero),
+				Vector::UnpackHigh8(cover, zero));
+
+			vector none = Vector::PackSigned16(
+				Vector::CompareEqual16(alphaLow, zero),
+				Vector::CompareEqual16(alphaHigh, zero));
+			if (Vector::AllSet(none))
+				return;
+
+			const vector opaque = Vector::Set16(255 * 255);
+			vector full = Vector::PackSigned16(
+				Vector::CompareEqual16(alphaLow, opaque),
+				Vector::CompareEqual16(alphaHigh, opaque));
+			if (Vector::AllSet(full)) {
+				Vector::Store(p, blockColor);
+				return;
+			}
+
+			vector d = Vector::Load(p);
+			vector result = Vector::Or(
+				Blend16(d, blockColor, alphaLow, alphaHigh), AlphaMask());
+			result = Select(full, blockColor, result);
+			Vector::Store(p, Select(none, d, result));
+		}
+	};
+
+	struct AlphaKernel {
+		vector	alpha;
+
+		inline void
+		Block(uint8* p, const uint8* colors, const uint8*) const
+		{
+			vector color = ToPixels(Vector::Load(colors));
+			Vector::Store(p, Vector::Or(
+				Blend16(Vector::Load(p), color, alpha, alpha), AlphaMask()));
+		}
+	};
+
+	struct CopyColorsKernel {
+		inline void
+		Block(uint8* p, const uint8* colors, const uint8*) const
+		{
+			Vector::Store(p, ToPixels(Vector::Load(colors)));
+		}
+	};
+
+	struct BitmapAlphaKernel {
+		inline void
+		Block(uint8* p, const uint8* source, const uint8*) const
+		{
+			vector s = Vector::Load(source);
+			vector alpha = SpreadAlpha(s);
+			vector full = Vector::CompareEqual8(alpha, Vector::Set8(255));
+			if (Vector::AllSet(full)) {
+				Vector::Store(p, s);
+				return;
+			}
+
+			// the destination keeps its alpha
+			vector d = Vector::Load(p);
+			vector result = Blend(d, s, alpha);
+			result = Vector::Or(Vector::AndNot(AlphaMask(), result),
+				Vector::And(d, AlphaMask()));
+			Vector::Store(p, Select(full, s, result));
+		}
+	};
+
+	// #pragma mark - SIMDBlendFunctions
+
+	static void
+	Fill(uint8* p, unsigned len, uint32 color)
+	{
+		vector pixels = Vector::Set32(color);
+		for (; len >= kPixels; len -= kPixels) {
+			Vector::Store(p, pixels);
+			p += kPixels * 4;
+		}
+		for (; len > 0; len--) {
+			*(uint32*)p = color;
+			p += 4;
+		}
+	}
+
+	static void
+	BlendSolid(uint8* p, unsigned len, uint32 color, uint8 cover)
+	{
+		SolidKernel kernel;
+		kernel.color = Vector::Set32(color);
+		kernel.cover = Vector::Set8(cover);
+		ForEachBlock(p, len, NULL, NULL, kernel);
+	}
+
+	static void
+	BlendSolidCovers(uint8* p, unsigned len, uint32 color,
+		const uint8* covers)
+	{
+		SolidCoversKernel kernel;
+		kernel.color = Vector::Set32(color);
+		ForEachBlock(p, len, NULL, covers, kernel);
+	}
+
+	static void
+	BlendColors(uint8* p, unsigned len, const uint8* colors,
+		const uint8* covers, uint8 cover, bool skipTransparent)
+	{
+		if (covers == NULL && cover == 0)
+			return;
+
+		ColorsKernel kernel;
+		kernel.cover = Vector::Set8(cover);
+		kernel.skipTransparent = skipTransparent;
+		ForEachBlock(p, len, colors, covers, kernel);
+	}
+
+	static void
+	BlendSolidAlphaCovers(uint8* p, unsigned len, uint32 color, uint8 alpha,
+		const uint8* covers)
+	{
+		AlphaCoversKernel kernel;
+		kernel.color = Vector::Set32(color);
+		kernel.colorAlpha = Vector::Set8(alpha);
+		ForEachBlock(p, len, NULL, covers, kernel);
+	}
+
+	static void
+	BlendColorsAlpha(uint8* p, unsigned len, const uint8* colors,
+		const uint8* covers, uint8 cover)
+	{
+		if (covers != NULL) {
+			AlphaCoversKernel kernel;
+			kernel.color = Vector::Zero();
+			kernel.colorAlpha = Vector::Zero();
+			ForEachBlock(p, len, colors, covers, kernel);
+			return;
+		}
+
+		// Like the scalar version, use the alpha of the first color for the
+		// whole span.
+		uint16 alpha = colors[3] * cover;
+		if (alpha == 0)
+			return;
+
+		if (alpha == 255 * 255) {
+			CopyColorsKernel kernel;
+			ForEachBlock(p, len, colors, NULL, kernel);
+		} else {
+			AlphaKernel kernel;
+			kernel.alpha = Vector::Set16(alpha);
+			ForEachBlock(p, len, colors, NULL, kernel);
+		}
+	}
+
+	static void
+	BlendBitmapRowAlpha(uint8* dst, const uint8* src, unsigned len)
+	{
+		BitmapAlphaKernel kernel;
+		ForEachBlock(dst, len, src, NULL, kernel);
+	}
+};
+
+
+}	// namespace
+
+
+#endif // SIMD_BLENDING_IMPL_H
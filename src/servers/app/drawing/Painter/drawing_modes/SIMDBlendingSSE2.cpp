@@ -0,0 +1,116 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ *
+ * SSE2 version of the SIMDBlendFunctions, four pixels at a time.
+ *
+ */
+
+#include <emmintrin.h>
+
+#include "SIMDBlendingImpl.h"
+
+
+namespace {
+
+
+struct SSE2Vector {
+	typedef __m128i type;
+
+	enum {
+		kPixels = 4
+	};
+
+	static inline type Load(const uint8* p)
+		{ return _mm_loadu_si128((const __m128i*)p); }
+	static inline void Store(uint8* p, type v)
+		{ _mm_storeu_si128((__m128i*)p, v); }
+
+	static inline type Zero()
+		{ return _mm_setzero_si128(); }
+	static inline type Set8(uint8 value)
+		{ return _mm_set1_epi8((char)value); }
+	static inline type Set16(uint16 value)
+		{ return _mm_set1_epi16((short)value); }
+	static inline type Set32(uint32 value)
+		{ return _mm_set1_epi32((int)value); }
+
+	static inline type And(type a, type b)
+		{ return _mm_and_si128(a, b); }
+	static inline type AndNot(type a, type b)
+		{ return _mm_andnot_si128(a, b); }
+	static inline type Or(type a, type b)
+		{ return _mm_or_si128(a, b); }
+
+	static inline type Add16(type a, type b)
+		{ return _mm_add_epi16(a, b); }
+	static inline type Sub16(type a, type b)
+		{ return _mm_sub_epi16(a, b); }
+	static inline type Add32(type a, type b)
+		{ return _mm_add_epi32(a, b); }
+	static inline type MultiplyLow16(type a, type b)
+		{ return _mm_mullo_epi16(a, b); }
+	static inline type MultiplyHighUnsigned16(type a, type b)
+		{ return _mm_mulhi_epu16(a, b); }
+
+	static inline type ShiftRight16(type v, int count)
+		{ return _mm_srli_epi16(v, count); }
+	static inline type ShiftRight32(type v, int count)
+		{ return _mm_srli_epi32(v, count); }
+	static inline type ShiftLeft32(type v, int count)
+		{ return _mm_slli_epi32(v, count); }
+
+	static inline type UnpackLow8(type a, type b)
+		{ return _mm_unpacklo_epi8(a, b); }
+	static inline type UnpackHigh8(type a, type b)
+		{ return _mm_unpackhi_epi8(a, b); }
+	static inline type UnpackLow16(type a, type b)
+		{ return _mm_unpacklo_epi16(a, b); }
+	static inline type UnpackHigh16(type a, type b)
+		{ return _mm_unpackhi_epi16(a, b); }
+	static inline type PackUnsigned16(type a, type b)
+		{ return _mm_packus_epi16(a, b); }
+	static inline type PackSigned16(type a, type b)
+		{ return _mm_packs_epi16(a, b); }
+	static inline type PackSigned32(type a, type b)
+		{ return _mm_packs_epi32(a, b); }
+
+	static inline type CompareEqual8(type a, type b)
+		{ return _mm_cmpeq_epi8(a, b); }
+	static inline type CompareEqual16(type a, type b)
+		{ return _mm_cmpeq_epi16(a, b); }
+	static inline type CompareEqual32(type a, type b)
+		{ return _mm_cmpeq_epi32(a, b); }
+
+	static inline bool AllSet(type mask)
+		{ return _mm_movemask_epi8(mask) == 0xffff; }
+	static inline bool IsZero(type mask)
+		{ return _mm_movemask_epi8(mask) == 0; }
+
+	//! Copies each of the kPixels covers into all bytes of its pixel.
+	static inline type Expand(const uint8* covers)
+	{
+		uint32 value;
+		memcpy(&value, covers, sizeof(value));
+		type v = _mm_cvtsi32_si128((int)value);
+		v = _mm_unpacklo_epi8(v, v);
+		return _mm_unpacklo_epi16(v, v);
+	}
+};
+
+
+typedef SIMDBlending<SSE2Vector> SSE2Blending;
+
+
+}	// namespace
+
+
+const SIMDBlendFunctions kSSE2BlendFunctions = {
+	SSE2Blending::Fill,
+	SSE2Blending::BlendSolid,
+	SSE2Blending::BlendSolidCovers,
+	SSE2Blending::BlendColors,
+	SSE2Blending::BlendSolidAlphaCovers,
+	SSE2Blending::BlendColorsAlpha,
+	SSE2Blending::BlendBitmapRowAlpha
+};
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Renders single large drawing operations in parallel.
+
+	The clipping region of the painter is split into horizontal tiles, and
+	the operation is replayed for each tile by a painter of its own, each
+	with its own AGG rasterizers and scanlines. The calling thread renders
+	tiles as well, and only returns once all tiles are done.
+
+	The painters of the tiles rasterize the complete shape with the same
+	clipping box as the original painter, only the resulting spans are
+	clipped to the tile. That costs some duplicated rasterizing work, but
+	guarantees that every pixel ends up exactly as if the original painter
+	had drawn it.
+*/
+
+
+#include "TiledRenderer.h"
+
+#include <new>
+#include <pthread.h>
+#include <stdio.h>
+
+#include "Painter.h"
+
+
+bool gTiledRendering = false;
+	// initialized in DesktopSettings.cpp
+
+static TiledRenderer* sDefaultRenderer;
+static pthread_once_t sDefaultRendererInitOnce = PTHREAD_ONCE_INIT;
+
+// Below this size, splitting up the work costs more than it saves.
+static const int64 kMinimumTiledArea = 256 * 256;
+static const int32 kMinimumTileHeight = 32;
+
+
+struct TiledRenderer::Worker {
+	Worker()
+		:
+		renderer(NULL),
+		thread(-1)
+	{
+	}
+
+	TiledRenderer*		renderer;
+	thread_id			thread;
+	Painter				painter;
+	BRegion				clipping;
+};
+
+
+DrawingOperation::~DrawingOperation()
+{
+}
+
+
+// #pragma mark -
+
+
+TiledRenderer::TiledRenderer()
+	:
+	fLock("tiled renderer"),
+	fStartSemaphore(-1),
+	fDoneSemaphore(-1),
+	fWorkers(NULL),
+	fWorkerCount(0),
+	fPainter(NULL),
+	fOperation(NULL),
+	fTileCount(0),
+	fNextTile(0)
+{
+	system_info info;
+	if (get_system_info(&info) != B_OK || info.cpu_count < 2)
+		return;
+
+	int32 workerCount = min_c((int32)info.cpu_count, (int32)kMaxWorkers);
+
+	fStartSemaphore = create_sem(0, "tiled renderer start");
+	fDoneSemaphore = create_sem(0, "tiled renderer done");
+	fWorkers = new(std::nothrow) Worker[workerCount];
+	if (fStartSemaphore < 0 || fDoneSemaphore < 0 || fWorkers == NULL)
+		return;
+
+	// The first worker has no thread, its painter is used by whoever calls
+	// Render().
+	fWorkerCount = 1;
+	for (int32 i = 1; i < workerCount; i++) {
+		Worker& worker = fWorkers[i];
+		worker.renderer = this;
+
+		char name[B_OS_NAME_LENGTH];
+		snprintf(name, sizeof(name), "tile renderer %" B_PRId32, i);
+		worker.thread = spawn_thread(&_WorkerThread, name, B_DISPLAY_PRIORITY,
+			&worker);
+		if (worker.thread < 0 || resume_thread(worker.thread) != B_OK)
+			break;
+
+		fWorkerCount++;
+	}
+}
+
+
+TiledRenderer::~TiledRenderer()
+{
+	// deleting the semaphore makes the worker threads quit
+	delete_sem(fStartSemaphore);
+	delete_sem(fDoneSemaphore);
+
+	for (int32 i = 1; i < fWorkerCount; i++) {
+		status_t result;
+		wait_for_thread(fWorkers[i].thread, &result);
+	}
+
+	delete[] fWorkers;
+}
+
+
+/*static*/ TiledRenderer*
+TiledRenderer::Default()
+{
+	pthread_once(&sDefaultRendererInitOnce, &_InitDefault);
+	return sDefaultRenderer;
+}
+
+
+/*!	Lets the operation draw the tiles of \a dirty in parallel, using the state
+	of \a painter. Returns \c false without drawing anything when this is not
+	worth it, or when another drawing engine is using the workers already; in
+	that case, the caller must draw serially.
+*/
+bool
+TiledRenderer::Render(const Painter& painter, const BRegion& dirty,
+	const DrawingOperation& operation)
+{
+	if (fWorkerCount < 2 || painter.ClippingRegion() == NULL
+		|| painter.HasAlphaMask()) {
+		return false;
+	}
+
+	clipping_rect dirtyFrame = dirty.FrameInt();
+	int32 width = dirtyFrame.right - dirtyFrame.left + 1;
+	int32 height = dirtyFrame.bottom - dirtyFrame.top + 1;
+	if ((int64)width * height < kMinimumTiledArea)
+		return false;
+
+	int32 tileCount = min_c(fWorkerCount * (int32)kTilesPerWorker,
+		height / kMinimumTileHeight);
+	if (tileCount < 2)
+		return false;
+
+	// rather draw serially than wait for another drawing engine
+	if (fLock.LockWithTimeout(0) != B_OK)
+		return false;
+
+	// The tiles span the whole width of the clipping region, and the outer
+	// ones extend to its top and bottom, in case the operation draws outside
+	// of the dirty region.
+	clipping_rect clippingFrame = painter.ClippingRegion()->FrameInt();
+	for (int32 i = 0; i < tileCount; i++) {
+		clipping_rect& tile = fTiles[i];
+		tile.left = clippingFrame.left;
+		tile.right = clippingFrame.right;
+		tile.top = dirtyFrame.top + height * i / tileCount;
+		tile.bottom = dirtyFrame.top + height * (i + 1) / tileCount - 1;
+	}
+	fTiles[0].top = min_c(fTiles[0].top, clippingFrame.top);
+	fTiles[tileCount - 1].bottom = max_c(fTiles[tileCount - 1].bottom,
+		clippingFrame.bottom);
+
+	fPainter = &painter;
+	fOperation = &operation;
+	fTileCount = tileCount;
+	fNextTile = 0;
+
+	release_sem_etc(fStartSemaphore, fWorkerCount - 1, B_DO_NOT_RESCHEDULE);
+	_RenderTiles(fWorkers[0]);
+	acquire_sem_etc(fDoneSemaphore, fWorkerCount - 1, 0, 0);
+
+	fPainter = NULL;
+	fOperation = NULL;
+
+	fLock.Unlock();
+	return true;
+}
+
+
+/*static*/ status_t
+TiledRenderer::_WorkerThread(void* data)
+{
+	Worker& worker = *(Worker*)data;
+	TiledRenderer* renderer = worker.renderer;
+
+	while (acquire_sem(renderer->fStartSemaphore) == B_OK) {
+		renderer->_RenderTiles(worker);
+		release_sem(renderer->fDoneSemaphore);
+	}
+
+	return B_OK;
+}
+
+
+void
+TiledRenderer::_RenderTiles(Worker& worker)
+{
+	while (true) {
+		int32 index = atomic_add(&fNextTile, 1);
+		if (index >= fTileCount)
+			break;
+
+		worker.clipping.Set(fTiles[index]);
+		worker.clipping.IntersectWith(fPainter->ClippingRegion());
+		if (worker.clipping.CountRects() == 0)
+			continue;
+
+		worker.painter.AdoptState(*fPainter, &worker.clipping);
+		fOperation->Draw(&worker.painter);
+	}
+}
+
+
+/*static*/ void
+TiledRenderer::_InitDefault()
+{
+	sDefaultRenderer = new(std::nothrow) TiledRenderer();
+}
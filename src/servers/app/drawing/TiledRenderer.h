@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef TILED_RENDERER_H
+#define TILED_RENDERER_H
+
+
+#include <Locker.h>
+#include <OS.h>
+#include <Region.h>
+
+
+class Painter;
+
+
+/*!	The painter calls of a DrawTransaction, recorded so that they can be
+	replayed for each tile.
+*/
+class DrawingOperation {
+public:
+	virtual						~DrawingOperation();
+
+	virtual	void				Draw(Painter* painter) const = 0;
+};
+
+
+class TiledRenderer {
+public:
+								TiledRenderer();
+								~TiledRenderer();
+
+	static	TiledRenderer*		Default();
+
+			bool				Render(const Painter& painter,
+									const BRegion& dirty,
+									const DrawingOperation& operation);
+
+private:
+			struct Worker;
+
+	static	status_t			_WorkerThread(void* data);
+			void				_RenderTiles(Worker& worker);
+
+	static	void				_InitDefault();
+
+private:
+	enum {
+		kMaxWorkers				= 16,
+		kTilesPerWorker			= 2
+	};
+
+			BLocker				fLock;
+			sem_id				fStartSemaphore;
+			sem_id				fDoneSemaphore;
+			Worker*				fWorkers;
+			int32				fWorkerCount;
+
+			const Painter*		fPainter;
+			const DrawingOperation* fOperation;
+			clipping_rect		fTiles[kMaxWorkers * kTilesPerWorker];
+			int32				fTileCount;
+			int32				fNextTile;
+};
+
+
+extern bool gTiledRendering;
+
+
+#endif	// TILED_RENDERER_H
@@ -90,6 +90,7 @@ extern addr_t _xsavec;
 extern addr_t _xrstor;
 uint64 gXsaveMask;
 uint64 gFPUSaveLength = 512;
+bool gHasPCID = false;
 bool gHasXsave = false;
 bool gHasXsavec = false;
 #endif
@@ -1849,6 +1850,13 @@ enable_xsavemask(void* dummy, int cpu)
 {
 	xsetbv(0, gXsaveMask);
 }
+
+
+static void
+enable_pcid(void* dummy, int cpu)
+{
+	x86_write_cr4(x86_read_cr4() | IA32_CR4_PCIDE);
+}
 #endif
 
 
@@ -1868,6 +1876,7 @@ arch_cpu_init_post_vm(kernel_args* args)
 			VMAddressSpace::Kernel()->TranslationMap())->PagingStructures();
 
 	// Set active translation map on each CPU.
+	kernelPagingStructures->context_id = 0;
 	for (uint32 i = 0; i < args->num_cpus; i++) {
 		gCPU[i].arch.active_paging_structures = kernelPagingStructures;
 		kernelPagingStructures->AddReference();
@@ -1899,6 +1908,14 @@ arch_cpu_init_post_vm(kernel_args* args)
 			dprintf("SMAP disabled per safemode setting\n");
 	}
 
+	// if available enable PCIDs, so that the user TLB entries don't have to
+	// be flushed on every address space switch
+	if (x86_check_feature(IA32_FEATURE_EXT_PCID, FEATURE_EXT)) {
+		dprintf("enable PCID\n");
+		call_all_cpus_sync(&enable_pcid, NULL);
+		gHasPCID = true;
+	}
+
 	// if available enable XSAVE (XSAVE and extended states)
 	gHasXsave = x86_check_feature(IA32_FEATURE_EXT_XSAVE, FEATURE_EXT);
 	if (gHasXsave) {
@@ -1973,6 +1990,8 @@ arch_cpu_init_post_modules(kernel_args* args)
 void
 arch_cpu_user_TLB_invalidate(void)
 {
+	// With PCIDs enabled, CR3 contains the current PCID, and only the entries
+	// tagged with it are flushed.
 	x86_write_cr3(x86_read_cr3());
 }
 
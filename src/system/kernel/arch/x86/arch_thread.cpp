@@ -205,31 +205,16 @@ arch_thread_context_switch(Thread* from, Thread* to)
 	if (to->user_local_storage != 0)
 		x86_set_tls_context(to);
 
-	X86PagingStructures* activePagingStructures
-		= cpuData->arch.active_paging_structures;
 	VMAddressSpace* toAddressSpace = to->team->address_space;
-
-	X86PagingStructures* toPagingStructures;
-	if (toAddressSpace != NULL
-		&& (toPagingStructures = static_cast<X86VMTranslationMap*>(
-				toAddressSpace->TranslationMap())->PagingStructures())
-					!= activePagingStructures) {
-		// update on which CPUs the address space is used
-		int cpu = cpuData->cpu_num;
-		activePagingStructures->active_on_cpus.ClearBitAtomic(cpu);
-		toPagingStructures->active_on_cpus.SetBitAtomic(cpu);
-
-		// assign the new paging structures to the CPU
-		toPagingStructures->AddReference();
-		cpuData->arch.active_paging_structures = toPagingStructures;
-
-		// set the page directory, if it changes
-		addr_t newPageDirectory = toPagingStructures->pgdir_phys;
-		if (newPageDirectory != activePagingStructures->pgdir_phys)
-			x86_swap_pgdir(newPageDirectory);
-
-		// This CPU no longer uses the previous paging structures.
-		activePagingStructures->RemoveReference();
+	if (toAddressSpace == VMAddressSpace::Kernel()) {
+		// The kernel mappings are part of all paging structures, so kernel
+		// threads just keep using the current ones. Switching back to the
+		// previous team is cheap that way.
+		x86_enter_lazy_tlb_mode(cpuData);
+	} else if (toAddressSpace != NULL) {
+		x86_activate_paging_structures(cpuData,
+			static_cast<X86VMTranslationMap*>(
+				toAddressSpace->TranslationMap())->PagingStructures());
 	}
 
 #ifndef __x86_64__
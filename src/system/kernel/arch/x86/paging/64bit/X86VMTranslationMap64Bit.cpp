@@ -51,6 +51,9 @@ X86VMTranslationMap64Bit::~X86VMTranslationMap64Bit()
 	if (fPagingStructures == NULL)
 		return;
 
+	// No CPU may use the page tables anymore, once they are freed.
+	x86_unload_paging_structures(fPagingStructures);
+
 	if (fPageMapper != NULL) {
 		vm_page_reservation reservation = {};
 		phys_addr_t address;
@@ -74,6 +77,12 @@ X86VMTranslationMap64Bit::~X86VMTranslationMap64Bit()
 					if ((virtualPageDir[k] & X86_64_PDE_PRESENT) == 0)
 						continue;
 
+					if ((virtualPageDir[k] & X86_64_PDE_LARGE_PAGE) != 0) {
+						// The memory of a large page belongs to its cache.
+						atomic_add(&gMappedLargePagesCount, -1);
+						continue;
+					}
+
 					address = virtualPageDir[k] & X86_64_PDE_ADDRESS_MASK;
 					page = vm_lookup_page(address / B_PAGE_SIZE);
 					if (page == NULL) {
@@ -107,6 +116,12 @@ X86VMTranslationMap64Bit::~X86VMTranslationMap64Bit()
 			vm_page_free_etc(NULL, page, &reservation);
 		}
 
+		// Free the page tables that have been replaced by large pages.
+		while ((page = fLargePageTables.RemoveHead()) != NULL) {
+			DEBUG_PAGE_ACCESS_START(page);
+			vm_page_free_etc(NULL, page, &reservation);
+		}
+
 		vm_page_unreserve_pages(&reservation);
 
 		fPageMapper->Delete();
@@ -210,9 +225,8 @@ X86VMTranslationMap64Bit::Map(addr_t virtualAddress, phys_addr_t physicalAddress
 
 	// Look up the page table for the virtual address, allocating new tables
 	// if required. Shouldn't fail.
-	uint64* entry = X86PagingMethod64Bit::PageTableEntryForAddress(
-		fPagingStructures->VirtualPMLTop(), virtualAddress, fIsKernelMap,
-		true, reservation, fPageMapper, fMapCount);
+	uint64* entry = _PageTableEntryForAddress(virtualAddress, true,
+		reservation);
 	ASSERT(entry != NULL);
 
 	// The entry should not already exist.
@@ -246,9 +260,7 @@ X86VMTranslationMap64Bit::Unmap(addr_t start, addr_t end)
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
 	do {
-		uint64* pageTable = X86PagingMethod64Bit::PageTableForAddress(
-			fPagingStructures->VirtualPMLTop(), start, fIsKernelMap, false,
-			NULL, fPageMapper, fMapCount);
+		uint64* pageTable = _PageTableForAddress(start, false, NULL);
 		if (pageTable == NULL) {
 			// Move on to the next page table.
 			start = ROUNDUP(start + 1, k64BitPageTableRange);
@@ -296,15 +308,35 @@ X86VMTranslationMap64Bit::DebugMarkRangePresent(addr_t start, addr_t end,
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
 	do {
-		uint64* pageTable = X86PagingMethod64Bit::PageTableForAddress(
+		uint64* pde = X86PagingMethod64Bit::PageDirectoryEntryForAddress(
 			fPagingStructures->VirtualPMLTop(), start, fIsKernelMap, false,
 			NULL, fPageMapper, fMapCount);
-		if (pageTable == NULL) {
+		if (pde != NULL && (*pde & X86_64_PDE_LARGE_PAGE) != 0) {
+			// A large page can only be marked as a whole; the PDE is the
+			// entry that maps it.
+			if (markPresent) {
+				X86PagingMethod64Bit::SetTableEntryFlags(pde,
+					X86_64_PDE_PRESENT);
+			} else {
+				uint64 oldEntry = X86PagingMethod64Bit::ClearTableEntryFlags(
+					pde, X86_64_PDE_PRESENT);
+				if ((oldEntry & X86_64_PDE_ACCESSED) != 0)
+					_InvalidateLargePage(start);
+			}
+
+			start = ROUNDUP(start + 1, k64BitPageTableRange);
+			continue;
+		}
+
+		if (pde == NULL || (*pde & X86_64_PDE_PRESENT) == 0) {
 			// Move on to the next page table.
 			start = ROUNDUP(start + 1, k64BitPageTableRange);
 			continue;
 		}
 
+		uint64* pageTable = (uint64*)fPageMapper->GetPageTableAt(
+			*pde & X86_64_PDE_ADDRESS_MASK);
+
 		for (uint32 index = start / B_PAGE_SIZE % k64BitTableEntryCount;
 				index < k64BitTableEntryCount && start < end;
 				index++, start += B_PAGE_SIZE) {
@@ -344,17 +376,14 @@ X86VMTranslationMap64Bit::UnmapPage(VMArea* area, addr_t address,
 
 	TRACE("X86VMTranslationMap64Bit::UnmapPage(%#" B_PRIxADDR ")\n", address);
 
+	RecursiveLocker locker(fLock);
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
 	// Look up the page table for the virtual address.
-	uint64* entry = X86PagingMethod64Bit::PageTableEntryForAddress(
-		fPagingStructures->VirtualPMLTop(), address, fIsKernelMap,
-		false, NULL, fPageMapper, fMapCount);
+	uint64* entry = _PageTableEntryForAddress(address, false, NULL);
 	if (entry == NULL)
 		return B_ENTRY_NOT_FOUND;
 
-	RecursiveLocker locker(fLock);
-
 	uint64 oldEntry = X86PagingMethod64Bit::ClearTableEntry(entry);
 
 	pinner.Unlock();
@@ -427,9 +456,7 @@ X86VMTranslationMap64Bit::UnmapPages(VMArea* area, addr_t base, size_t size,
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
 	do {
-		uint64* pageTable = X86PagingMethod64Bit::PageTableForAddress(
-			fPagingStructures->VirtualPMLTop(), start, fIsKernelMap, false,
-			NULL, fPageMapper, fMapCount);
+		uint64* pageTable = _PageTableForAddress(start, false, NULL);
 		if (pageTable == NULL) {
 			// Move on to the next page table.
 			start = ROUNDUP(start + 1, k64BitPageTableRange);
@@ -462,11 +489,11 @@ X86VMTranslationMap64Bit::UnmapPages(VMArea* area, addr_t base, size_t size,
 					updatePageQueue, &queue);
 			}
 		}
-
-		Flush();
-			// flush explicitly, since we directly use the lock
 	} while (start != 0 && start < end);
 
+	Flush();
+		// flush explicitly, since we directly use the lock
+
 	// TODO: As in UnmapPage() we can lose page dirty flags here. ATM it's not
 	// really critical here, as in all cases this method is used, the unmapped
 	// area range is unmapped for good (resized/cut) and the pages will likely
@@ -569,12 +596,38 @@ X86VMTranslationMap64Bit::Protect(addr_t start, addr_t end, uint32 attributes,
 	} else if ((attributes & B_KERNEL_WRITE_AREA) != 0)
 		newProtectionFlags = X86_64_PTE_WRITABLE;
 
+	uint64 memoryTypeFlags
+		= X86PagingMethod64Bit::MemoryTypeToPageTableEntryFlags(memoryType);
+
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
 	do {
-		uint64* pageTable = X86PagingMethod64Bit::PageTableForAddress(
+		uint64* pde = X86PagingMethod64Bit::PageDirectoryEntryForAddress(
 			fPagingStructures->VirtualPMLTop(), start, fIsKernelMap, false,
 			NULL, fPageMapper, fMapCount);
+		if (!fIsKernelMap && pde != NULL
+			&& (*pde & X86_64_PDE_LARGE_PAGE) != 0
+			&& start % k64BitPageTableRange == 0
+			&& end - start >= k64BitPageTableRange - 1
+			&& memoryTypeFlags == 0) {
+			// The complete large page is affected, so it doesn't need to be
+			// split.
+			uint64 entry = *pde;
+			while (true) {
+				uint64 oldEntry = X86PagingMethod64Bit::TestAndSetTableEntry(
+					pde, (entry & ~X86_64_PTE_PROTECTION_MASK)
+						| newProtectionFlags, entry);
+				if (oldEntry == entry)
+					break;
+				entry = oldEntry;
+			}
+
+			_InvalidateLargePage(start);
+			start += k64BitPageTableRange;
+			continue;
+		}
+
+		uint64* pageTable = _PageTableForAddress(start, false, NULL);
 		if (pageTable == NULL) {
 			// Move on to the next page table.
 			start = ROUNDUP(start + 1, k64BitPageTableRange);
@@ -599,9 +652,7 @@ X86VMTranslationMap64Bit::Protect(addr_t start, addr_t end, uint32 attributes,
 					&pageTable[index],
 					(entry & ~(X86_64_PTE_PROTECTION_MASK
 							| X86_64_PTE_MEMORY_TYPE_MASK))
-						| newProtectionFlags
-						| X86PagingMethod64Bit::MemoryTypeToPageTableEntryFlags(
-							memoryType),
+						| newProtectionFlags | memoryTypeFlags,
 					entry);
 				if (oldEntry == entry)
 					break;
@@ -629,9 +680,7 @@ X86VMTranslationMap64Bit::ClearFlags(addr_t address, uint32 flags)
 
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
-	uint64* entry = X86PagingMethod64Bit::PageTableEntryForAddress(
-		fPagingStructures->VirtualPMLTop(), address, fIsKernelMap,
-		false, NULL, fPageMapper, fMapCount);
+	uint64* entry = _PageTableEntryForAddress(address, false, NULL);
 	if (entry == NULL)
 		return B_OK;
 
@@ -660,9 +709,30 @@ X86VMTranslationMap64Bit::ClearAccessedAndModified(VMArea* area, addr_t address,
 	RecursiveLocker locker(fLock);
 	ThreadCPUPinner pinner(thread_get_current_thread());
 
-	uint64* entry = X86PagingMethod64Bit::PageTableEntryForAddress(
-		fPagingStructures->VirtualPMLTop(), address, fIsKernelMap,
-		false, NULL, fPageMapper, fMapCount);
+	uint64* pde = X86PagingMethod64Bit::PageDirectoryEntryForAddress(
+		fPagingStructures->VirtualPMLTop(), address, fIsKernelMap, false, NULL,
+		fPageMapper, fMapCount);
+	if (!fIsKernelMap && pde != NULL && (*pde & X86_64_PDE_LARGE_PAGE) != 0
+		&& (!unmapIfUnaccessed || (*pde & X86_64_PDE_ACCESSED) != 0)) {
+		// There is only a single accessed flag for the whole large page. It's
+		// cleared only for the large page's first page, so that it represents
+		// the accesses since the page daemon last looked at that one. The
+		// modified flag is never cleared, since it can't be tracked per page.
+		// An unaccessed large page that shall be unmapped is split below.
+		uint64 oldEntry = *pde;
+		if ((oldEntry & X86_64_PDE_ACCESSED) != 0
+			&& address % k64BitPageTableRange == 0) {
+			X86PagingMethod64Bit::ClearTableEntryFlags(pde,
+				X86_64_PDE_ACCESSED);
+			InvalidatePage(address);
+			Flush();
+		}
+
+		_modified = (oldEntry & X86_64_PDE_DIRTY) != 0;
+		return (oldEntry & X86_64_PDE_ACCESSED) != 0;
+	}
+
+	uint64* entry = _PageTableEntryForAddress(address, false, NULL);
 	if (entry == NULL)
 		return false;
 
@@ -727,6 +797,100 @@ X86VMTranslationMap64Bit::ClearAccessedAndModified(VMArea* area, addr_t address,
 }
 
 
+size_t
+X86VMTranslationMap64Bit::LargePageSize() const
+{
+	return k64BitPageTableRange;
+}
+
+
+status_t
+X86VMTranslationMap64Bit::PromoteLargePage(addr_t address)
+{
+	TRACE("X86VMTranslationMap64Bit::PromoteLargePage(%#" B_PRIxADDR ")\n",
+		address);
+
+	if (fIsKernelMap || address % k64BitPageTableRange != 0)
+		return B_BAD_VALUE;
+
+	ThreadCPUPinner pinner(thread_get_current_thread());
+
+	uint64* pde = X86PagingMethod64Bit::PageDirectoryEntryForAddress(
+		fPagingStructures->VirtualPMLTop(), address, fIsKernelMap, false, NULL,
+		fPageMapper, fMapCount);
+	if (pde == NULL || (*pde & X86_64_PDE_PRESENT) == 0)
+		return B_ENTRY_NOT_FOUND;
+
+	uint64 tableEntry = *pde;
+	if ((tableEntry & X86_64_PDE_LARGE_PAGE) != 0)
+		return B_OK;
+
+	uint64* pageTable = (uint64*)fPageMapper->GetPageTableAt(
+		tableEntry & X86_64_PDE_ADDRESS_MASK);
+
+	// All pages must be present, physically contiguous (starting at a large
+	// page boundary), and mapped with the same attributes. Only write-back
+	// memory is supported, since the PAT bit is in a different place in a
+	// page directory entry.
+	const uint64 kAttributeMask = X86_64_PTE_PRESENT | X86_64_PTE_WRITABLE
+		| X86_64_PTE_USER | X86_64_PTE_GLOBAL | X86_64_PTE_NOT_EXECUTABLE
+		| X86_64_PTE_MEMORY_TYPE_MASK | X86_64_PTE_PAT;
+
+	uint64 attributes = pageTable[0] & kAttributeMask;
+	phys_addr_t physicalAddress = pageTable[0] & X86_64_PTE_ADDRESS_MASK;
+	if ((attributes & X86_64_PTE_PRESENT) == 0
+		|| (attributes & (X86_64_PTE_MEMORY_TYPE_MASK | X86_64_PTE_PAT)) != 0
+		|| physicalAddress % k64BitPageTableRange != 0) {
+		return B_BAD_VALUE;
+	}
+
+	uint64 dirty = 0;
+	for (uint32 i = 0; i < k64BitTableEntryCount; i++) {
+		uint64 entry = pageTable[i];
+		if ((entry & kAttributeMask) != attributes
+			|| (entry & X86_64_PTE_ADDRESS_MASK)
+				!= physicalAddress + i * B_PAGE_SIZE) {
+			return B_BAD_VALUE;
+		}
+
+		dirty |= entry & X86_64_PTE_DIRTY;
+	}
+
+	// The accessed and modified state of the individual pages is lost, so
+	// the large page is considered accessed and, if writable, modified.
+	uint64 largeEntry = physicalAddress | attributes | X86_64_PDE_LARGE_PAGE
+		| X86_64_PDE_ACCESSED | dirty
+		| ((attributes & X86_64_PTE_WRITABLE) != 0 ? X86_64_PDE_DIRTY : 0);
+
+	while (true) {
+		uint64 oldEntry = X86PagingMethod64Bit::TestAndSetTableEntry(pde,
+			largeEntry, tableEntry);
+		if (oldEntry == tableEntry)
+			break;
+
+		// Only the accessed flag may have been set in the meantime.
+		if ((oldEntry & ~X86_64_PDE_ACCESSED)
+				!= (tableEntry & ~X86_64_PDE_ACCESSED)) {
+			return B_BUSY;
+		}
+		tableEntry = oldEntry;
+	}
+
+	// Keep the page table around, so that splitting the large page again
+	// never needs to allocate memory.
+	vm_page* page = vm_lookup_page(
+		(tableEntry & X86_64_PDE_ADDRESS_MASK) / B_PAGE_SIZE);
+	fLargePageTables.Add(page);
+
+	_InvalidateLargePage(address);
+
+	atomic_add(&gMappedLargePagesCount, 1);
+	atomic_add64(&gLargePagePromotions, 1);
+
+	return B_OK;
+}
+
+
 bool
 X86VMTranslationMap64Bit::DebugGetReverseMappingInfo(phys_addr_t physicalAddress,
 	ReverseMappingInfoCallback& callback)
@@ -799,3 +963,110 @@ X86VMTranslationMap64Bit::PagingStructures() const
 {
 	return fPagingStructures;
 }
+
+
+/*!	Like X86PagingMethod64Bit::PageTableForAddress(), but splits a large page
+	mapping the given address into small pages first.
+*/
+uint64*
+X86VMTranslationMap64Bit::_PageTableForAddress(addr_t virtualAddress,
+	bool allocateTables, vm_page_reservation* reservation)
+{
+	if (!fIsKernelMap && !fLargePageTables.IsEmpty()) {
+		uint64* pde = X86PagingMethod64Bit::PageDirectoryEntryForAddress(
+			fPagingStructures->VirtualPMLTop(), virtualAddress, fIsKernelMap,
+			false, NULL, fPageMapper, fMapCount);
+		if (pde != NULL && (*pde & X86_64_PDE_LARGE_PAGE) != 0)
+			_DemoteLargePage(pde, virtualAddress);
+	}
+
+	return X86PagingMethod64Bit::PageTableForAddress(
+		fPagingStructures->VirtualPMLTop(), virtualAddress, fIsKernelMap,
+		allocateTables, reservation, fPageMapper, fMapCount);
+}
+
+
+uint64*
+X86VMTranslationMap64Bit::_PageTableEntryForAddress(addr_t virtualAddress,
+	bool allocateTables, vm_page_reservation* reservation)
+{
+	uint64* pageTable = _PageTableForAddress(virtualAddress, allocateTables,
+		reservation);
+	if (pageTable == NULL)
+		return NULL;
+
+	return &pageTable[VADDR_TO_PTE(virtualAddress)];
+}
+
+
+/*!	Splits the large page mapped by the given page directory entry into small
+	pages, reusing one of the page tables that were replaced by large pages.
+	The accessed and modified flags of the large page are inherited by all
+	small pages.
+*/
+void
+X86VMTranslationMap64Bit::_DemoteLargePage(uint64* pde, addr_t virtualAddress)
+{
+	RecursiveLocker locker(fLock);
+
+	vm_page* page = fLargePageTables.RemoveHead();
+	if (page == NULL) {
+		panic("X86VMTranslationMap64Bit::_DemoteLargePage(): no page table "
+			"left for large page at %#" B_PRIxADDR, virtualAddress);
+		return;
+	}
+
+	phys_addr_t physicalPageTable
+		= (phys_addr_t)page->physical_page_number * B_PAGE_SIZE;
+	uint64* pageTable = (uint64*)fPageMapper->GetPageTableAt(
+		physicalPageTable);
+
+	const uint64 kAttributeMask = X86_64_PTE_PRESENT | X86_64_PTE_WRITABLE
+		| X86_64_PTE_USER | X86_64_PTE_ACCESSED | X86_64_PTE_DIRTY
+		| X86_64_PTE_GLOBAL | X86_64_PTE_NOT_EXECUTABLE
+		| X86_64_PTE_MEMORY_TYPE_MASK;
+
+	uint64 largeEntry = *pde;
+	while ((largeEntry & X86_64_PDE_LARGE_PAGE) != 0) {
+		phys_addr_t physicalAddress = largeEntry & X86_64_PDE_ADDRESS_MASK
+			& ~(phys_addr_t)(k64BitPageTableRange - 1);
+		uint64 attributes = largeEntry & kAttributeMask;
+		for (uint32 i = 0; i < k64BitTableEntryCount; i++)
+			pageTable[i] = (physicalAddress + i * B_PAGE_SIZE) | attributes;
+
+		// The CPU might set the accessed or dirty flag concurrently, in which
+		// case we have to start over.
+		uint64 oldEntry = X86PagingMethod64Bit::TestAndSetTableEntry(pde,
+			(physicalPageTable & X86_64_PDE_ADDRESS_MASK) | X86_64_PDE_PRESENT
+				| X86_64_PDE_WRITABLE | X86_64_PDE_USER,
+			largeEntry);
+		if (oldEntry == largeEntry)
+			break;
+		largeEntry = oldEntry;
+	}
+
+	if ((largeEntry & X86_64_PDE_LARGE_PAGE) == 0) {
+		// someone else was faster
+		fLargePageTables.Add(page);
+		return;
+	}
+
+	_InvalidateLargePage(virtualAddress);
+	Flush();
+
+	atomic_add(&gMappedLargePagesCount, -1);
+	atomic_add64(&gLargePageDemotions, 1);
+}
+
+
+/*!	Invalidates all TLB entries for the large page range containing the
+	given address. The CPUs may hold entries for the large page as well as
+	for any of its small pages, so only a complete flush is sufficient.
+*/
+void
+X86VMTranslationMap64Bit::_InvalidateLargePage(addr_t virtualAddress)
+{
+	InvalidatePage(ROUNDDOWN(virtualAddress, k64BitPageTableRange));
+	if (fInvalidPagesCount <= PAGE_INVALIDATE_CACHE_SIZE)
+		fInvalidPagesCount = PAGE_INVALIDATE_CACHE_SIZE + 1;
+}
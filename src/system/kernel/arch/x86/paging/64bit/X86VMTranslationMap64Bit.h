@@ -7,6 +7,9 @@
 #define KERNEL_ARCH_X86_PAGING_64BIT_X86_VM_TRANSLATION_MAP_64BIT_H
 
 
+#include <util/DoublyLinkedList.h>
+#include <vm/vm_types.h>
+
 #include "paging/X86VMTranslationMap.h"
 
 
@@ -51,6 +54,9 @@ struct X86VMTranslationMap64Bit final : X86VMTranslationMap {
 	virtual	status_t			ClearFlags(addr_t virtualAddress,
 									uint32 flags);
 
+	virtual	size_t				LargePageSize() const;
+	virtual	status_t			PromoteLargePage(addr_t address);
+
 	virtual	bool				ClearAccessedAndModified(
 									VMArea* area, addr_t address,
 									bool unmapIfUnaccessed,
@@ -64,8 +70,26 @@ struct X86VMTranslationMap64Bit final : X86VMTranslationMap {
 	inline	X86PagingStructures64Bit* PagingStructures64Bit() const
 									{ return fPagingStructures; }
 
+private:
+	typedef DoublyLinkedList<vm_page,
+		DoublyLinkedListMemberGetLink<vm_page, &vm_page::queue_link> >
+			PageTableList;
+
+private:
+			uint64*				_PageTableForAddress(addr_t virtualAddress,
+									bool allocateTables,
+									vm_page_reservation* reservation);
+			uint64*				_PageTableEntryForAddress(
+									addr_t virtualAddress, bool allocateTables,
+									vm_page_reservation* reservation);
+			void				_DemoteLargePage(uint64* pde,
+									addr_t virtualAddress);
+			void				_InvalidateLargePage(addr_t virtualAddress);
+
 private:
 			X86PagingStructures64Bit* fPagingStructures;
+			PageTableList		fLargePageTables;
+									// page tables replaced by large pages
 			bool				fLA57;
 };
 
@@ -1,19 +1,279 @@
 /*
  * Copyright 2010, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All rights reserved.
  * Distributed under the terms of the MIT License.
  */
 
 
 #include "paging/X86PagingStructures.h"
 
+#include <arch/cpu.h>
+#include <thread.h>
+#include <util/AutoLock.h>
+#include <vm/VMAddressSpace.h>
+
+#include "paging/X86VMTranslationMap.h"
+
+
+/*!	TLB shootdowns and lazy TLB mode
+
+	A CPU keeps the paging structures of the last user team it ran active
+	while it runs kernel threads, since those only access kernel mappings,
+	which are part of all paging structures. It is said to be in lazy TLB
+	mode then, and TLB shootdowns of the user mappings skip it, only marking
+	a flush as pending. When the CPU switches back to a thread of the same
+	team, it flushes its TLB, if necessary; when it switches to another
+	team, the pending flush is implied by loading the new paging structures.
+
+	If the CPU supports process context identifiers (PCIDs), the TLB entries
+	of up to X86_PCID_SLOT_COUNT user address spaces are kept when switching
+	between them. Each paging structures object has a flush generation that
+	is incremented with every shootdown. A CPU remembers the generation its
+	TLB entries for the paging structures it stops using are valid for, and
+	only reuses them when no shootdown has happened since.
+
+	The lazy TLB state of a CPU, the paging structures' active_on_cpus mask,
+	and their flush generation are only changed with the paging structures'
+	lock held.
+*/
+
+
+static int64 sNextContextID = 1;
+
 
 X86PagingStructures::X86PagingStructures()
 	:
-	ref_count(1)
+	ref_count(1),
+	context_id(atomic_add64(&sNextContextID, 1)),
+	flush_generation(0)
 {
+	B_INITIALIZE_SPINLOCK(&lock);
 }
 
 
 X86PagingStructures::~X86PagingStructures()
 {
 }
+
+
+#ifdef __x86_64__
+
+
+static void
+switch_pcid(arch_cpu_info& arch, int64 previousGeneration,
+	X86PagingStructures* structures, int64 generation)
+{
+	// remember for which generation the previous TLB entries are valid
+	if (arch.active_pcid != 0)
+		arch.pcid_slots[arch.active_pcid - 1].flush_generation
+			= previousGeneration;
+
+	uint64 pageDirectory = structures->pgdir_phys;
+	if (structures->context_id == 0) {
+		// the kernel's paging structures always use PCID 0
+		arch.active_pcid = 0;
+		x86_swap_pgdir(pageDirectory);
+		return;
+	}
+
+	uint32 slot = 0;
+	while (slot < X86_PCID_SLOT_COUNT
+		&& arch.pcid_slots[slot].context != structures->context_id) {
+		slot++;
+	}
+
+	if (slot < X86_PCID_SLOT_COUNT
+		&& arch.pcid_slots[slot].flush_generation == generation) {
+		// the TLB entries are still valid, keep them
+		pageDirectory |= IA32_CR3_NO_FLUSH;
+	} else if (slot == X86_PCID_SLOT_COUNT) {
+		// recycle a PCID -- loading it without IA32_CR3_NO_FLUSH flushes its
+		// TLB entries
+		slot = arch.next_pcid_slot;
+		arch.next_pcid_slot = (slot + 1) % X86_PCID_SLOT_COUNT;
+		arch.pcid_slots[slot].context = structures->context_id;
+	}
+
+	arch.pcid_slots[slot].flush_generation = generation;
+	arch.active_pcid = slot + 1;
+
+	x86_swap_pgdir(pageDirectory | arch.active_pcid);
+}
+
+
+#endif	// __x86_64__
+
+
+/*!	Makes \a structures the paging structures used by \a cpu, and leaves
+	the lazy TLB mode.
+	Must be called with interrupts disabled on the given CPU.
+*/
+void
+x86_activate_paging_structures(cpu_ent* cpu, X86PagingStructures* structures)
+{
+	arch_cpu_info& arch = cpu->arch;
+	X86PagingStructures* activeStructures = arch.active_paging_structures;
+
+	if (structures == activeStructures) {
+		if (!arch.tlb_lazy)
+			return;
+
+		SpinLocker locker(structures->lock);
+		bool flush = arch.tlb_flush_pending;
+		arch.tlb_lazy = false;
+		arch.tlb_flush_pending = false;
+		locker.Unlock();
+
+		if (flush)
+			arch_cpu_user_TLB_invalidate();
+		return;
+	}
+
+	int32 cpuNumber = cpu->cpu_num;
+
+	// Stop using the previous paging structures. Any later shootdown will
+	// increment the flush generation past the one we record.
+	SpinLocker locker(activeStructures->lock);
+	activeStructures->active_on_cpus.ClearBit(cpuNumber);
+	int64 previousGeneration = arch.tlb_flush_pending
+		? -1 : activeStructures->flush_generation;
+	arch.tlb_lazy = false;
+	arch.tlb_flush_pending = false;
+	locker.Unlock();
+
+	locker.SetTo(structures->lock, false);
+	structures->active_on_cpus.SetBit(cpuNumber);
+	int64 generation = structures->flush_generation;
+	locker.Unlock();
+
+	// assign the new paging structures to the CPU
+	structures->AddReference();
+	arch.active_paging_structures = structures;
+
+#ifdef __x86_64__
+	if (gHasPCID)
+		switch_pcid(arch, previousGeneration, structures, generation);
+	else
+#endif
+	if (structures->pgdir_phys != activeStructures->pgdir_phys)
+		x86_swap_pgdir(structures->pgdir_phys);
+
+	// This CPU no longer uses the previous paging structures.
+	activeStructures->RemoveReference();
+}
+
+
+/*!	Lets \a cpu keep its paging structures while it runs kernel threads,
+	without receiving TLB shootdowns for them.
+	Must be called with interrupts disabled on the given CPU.
+*/
+void
+x86_enter_lazy_tlb_mode(cpu_ent* cpu)
+{
+	if (cpu->arch.tlb_lazy)
+		return;
+
+	SpinLocker locker(cpu->arch.active_paging_structures->lock);
+	cpu->arch.tlb_lazy = true;
+}
+
+
+static void
+unload_paging_structures(addr_t structures, int32 currentCPU, addr_t, addr_t)
+{
+	cpu_ent* cpu = &gCPU[currentCPU];
+	if (cpu->arch.active_paging_structures != (X86PagingStructures*)structures)
+		return;
+
+	X86PagingStructures* kernelStructures = static_cast<X86VMTranslationMap*>(
+		VMAddressSpace::Kernel()->TranslationMap())->PagingStructures();
+	x86_activate_paging_structures(cpu, kernelStructures);
+}
+
+
+/*!	Makes all CPUs still using \a structures -- lazily, or because the
+	current thread belonged to the structures' team -- switch to the
+	kernel's paging structures.
+	Called before the page tables of a user address space are freed.
+*/
+void
+x86_unload_paging_structures(X86PagingStructures* structures)
+{
+	Thread* thread = thread_get_current_thread();
+	thread_pin_to_current_cpu(thread);
+
+	cpu_status state = disable_interrupts();
+	unload_paging_structures((addr_t)structures, smp_get_current_cpu(), 0, 0);
+
+	SpinLocker locker(structures->lock);
+	CPUSet cpus = structures->active_on_cpus;
+	locker.Unlock();
+	restore_interrupts(state);
+
+	if (!cpus.IsEmpty()) {
+		smp_send_multicast_ici(cpus, SMP_MSG_CALL_FUNCTION, (addr_t)structures,
+			0, 0, (void*)&unload_paging_structures, SMP_MSG_FLAG_SYNC);
+	}
+
+	thread_unpin_from_current_cpu(thread);
+}
+
+
+/*!	Starts a TLB shootdown of the user mappings of \a structures.
+	Increments their flush generation, marks the flush as pending for all
+	CPUs using them lazily, and returns the other CPUs using them, except
+	for the current one, which have to be interrupted.
+	Must be called with interrupts disabled.
+*/
+CPUSet
+x86_prepare_tlb_shootdown(X86PagingStructures* structures)
+{
+	int32 currentCPU = smp_get_current_cpu();
+
+	SpinLocker locker(structures->lock);
+	structures->flush_generation++;
+
+	CPUSet cpus = structures->active_on_cpus;
+	cpus.ClearBit(currentCPU);
+
+	int32 cpuCount = smp_get_num_cpus();
+	for (int32 i = 0; i < cpuCount; i++) {
+		if (cpus.GetBit(i) && gCPU[i].arch.tlb_lazy) {
+			gCPU[i].arch.tlb_flush_pending = true;
+			cpus.ClearBit(i);
+		}
+	}
+
+	return cpus;
+}
+
+
+/*!	Invalidates the TLB entries of the current CPU for the given pages of
+	the user mappings of \a structures, or all of them, if \a count is
+	negative.
+	Must be called with interrupts disabled.
+*/
+void
+x86_invalidate_tlb(X86PagingStructures* structures, addr_t* pages,
+	int32 count)
+{
+	cpu_ent* cpu = get_cpu_struct();
+	if (cpu->arch.active_paging_structures == structures) {
+		if (count < 0)
+			arch_cpu_user_TLB_invalidate();
+		else
+			arch_cpu_invalidate_TLB_list(pages, count);
+		return;
+	}
+
+#ifdef __x86_64__
+	// The CPU has switched to other paging structures since the shootdown
+	// started, but its PCID might still tag entries of these.
+	if (gHasPCID) {
+		for (uint32 i = 0; i < X86_PCID_SLOT_COUNT; i++) {
+			if (cpu->arch.pcid_slots[i].context == structures->context_id)
+				cpu->arch.pcid_slots[i].flush_generation = -1;
+		}
+	}
+#endif
+}
@@ -12,6 +12,7 @@
 
 #include <SupportDefs.h>
 
+#include <cpu.h>
 #include <heap.h>
 
 #include <smp.h>
@@ -22,6 +23,13 @@ struct X86PagingStructures : DeferredDeletable {
 	int32						ref_count;
 	CPUSet						active_on_cpus;
 		// mask indicating on which CPUs the map is currently used
+	spinlock					lock;
+		// protects active_on_cpus and the lazy TLB state of the CPUs
+		// using the structures against concurrent TLB shootdowns
+	int64						context_id;
+		// unique ID, 0 for the kernel's paging structures
+	int64						flush_generation;
+		// incremented with every TLB shootdown of the user mappings
 
 								X86PagingStructures();
 	virtual						~X86PagingStructures();
@@ -48,4 +56,14 @@ X86PagingStructures::RemoveReference()
 }
 
 
+void x86_activate_paging_structures(cpu_ent* cpu,
+	X86PagingStructures* structures);
+void x86_enter_lazy_tlb_mode(cpu_ent* cpu);
+void x86_unload_paging_structures(X86PagingStructures* structures);
+
+CPUSet x86_prepare_tlb_shootdown(X86PagingStructures* structures);
+void x86_invalidate_tlb(X86PagingStructures* structures, addr_t* pages,
+	int32 count);
+
+
 #endif	// KERNEL_ARCH_X86_PAGING_X86_PAGING_STRUCTURES_H
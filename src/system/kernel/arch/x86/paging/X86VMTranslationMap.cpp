@@ -24,6 +24,15 @@
 #endif
 
 
+static void
+invalidate_tlb(addr_t structures, int32 currentCPU, addr_t pages,
+	addr_t count)
+{
+	x86_invalidate_tlb((X86PagingStructures*)structures, (addr_t*)pages,
+		(int32)count);
+}
+
+
 X86VMTranslationMap::X86VMTranslationMap()
 	:
 	fPageMapper(NULL),
@@ -98,50 +107,40 @@ X86VMTranslationMap::Flush()
 	Thread* thread = thread_get_current_thread();
 	thread_pin_to_current_cpu(thread);
 
-	if (fInvalidPagesCount > PAGE_INVALIDATE_CACHE_SIZE) {
+	if (!fIsKernelMap) {
+		// Only CPUs actually running a thread of the team are interrupted,
+		// the others flush their TLB when they switch back to the team, if
+		// necessary (cf. X86PagingStructures.cpp).
+		int32 count = fInvalidPagesCount > PAGE_INVALIDATE_CACHE_SIZE
+			? -1 : fInvalidPagesCount;
+		TRACE("flush_tmap: %d pages to invalidate\n", fInvalidPagesCount);
+
+		cpu_status state = disable_interrupts();
+		CPUSet cpuMask = x86_prepare_tlb_shootdown(PagingStructures());
+		x86_invalidate_tlb(PagingStructures(), fInvalidPages, count);
+		restore_interrupts(state);
+
+		if (!cpuMask.IsEmpty()) {
+			smp_send_multicast_ici(cpuMask, SMP_MSG_CALL_FUNCTION,
+				(addr_t)PagingStructures(), (addr_t)fInvalidPages, count,
+				(void*)&invalidate_tlb, SMP_MSG_FLAG_SYNC);
+		}
+	} else if (fInvalidPagesCount > PAGE_INVALIDATE_CACHE_SIZE) {
 		// invalidate all pages
 		TRACE("flush_tmap: %d pages to invalidate, invalidate all\n",
 			fInvalidPagesCount);
 
-		if (fIsKernelMap) {
-			arch_cpu_global_TLB_invalidate();
-			smp_send_broadcast_ici(SMP_MSG_GLOBAL_INVALIDATE_PAGES, 0, 0, 0,
-				NULL, SMP_MSG_FLAG_SYNC);
-		} else {
-			cpu_status state = disable_interrupts();
-			arch_cpu_user_TLB_invalidate();
-			restore_interrupts(state);
-
-			int cpu = smp_get_current_cpu();
-			CPUSet cpuMask = PagingStructures()->active_on_cpus;
-			cpuMask.ClearBit(cpu);
-
-			if (!cpuMask.IsEmpty()) {
-				smp_send_multicast_ici(cpuMask, SMP_MSG_USER_INVALIDATE_PAGES,
-					0, 0, 0, NULL, SMP_MSG_FLAG_SYNC);
-			}
-		}
+		arch_cpu_global_TLB_invalidate();
+		smp_send_broadcast_ici(SMP_MSG_GLOBAL_INVALIDATE_PAGES, 0, 0, 0,
+			NULL, SMP_MSG_FLAG_SYNC);
 	} else {
 		TRACE("flush_tmap: %d pages to invalidate, invalidate list\n",
 			fInvalidPagesCount);
 
 		arch_cpu_invalidate_TLB_list(fInvalidPages, fInvalidPagesCount);
-
-		if (fIsKernelMap) {
-			smp_send_broadcast_ici(SMP_MSG_INVALIDATE_PAGE_LIST,
-				(addr_t)fInvalidPages, fInvalidPagesCount, 0, NULL,
-				SMP_MSG_FLAG_SYNC);
-		} else {
-			int cpu = smp_get_current_cpu();
-			CPUSet cpuMask = PagingStructures()->active_on_cpus;
-			cpuMask.ClearBit(cpu);
-
-			if (!cpuMask.IsEmpty()) {
-				smp_send_multicast_ici(cpuMask, SMP_MSG_INVALIDATE_PAGE_LIST,
-					(addr_t)fInvalidPages, fInvalidPagesCount, 0, NULL,
-					SMP_MSG_FLAG_SYNC);
-			}
-		}
+		smp_send_broadcast_ici(SMP_MSG_INVALIDATE_PAGE_LIST,
+			(addr_t)fInvalidPages, fInvalidPagesCount, 0, NULL,
+			SMP_MSG_FLAG_SYNC);
 	}
 	fInvalidPagesCount = 0;
 
@@ -238,6 +238,9 @@ X86VMTranslationMapPAE::~X86VMTranslationMapPAE()
 	if (fPagingStructures == NULL)
 		return;
 
+	// No CPU may use the page tables anymore, once they are freed.
+	x86_unload_paging_structures(fPagingStructures);
+
 	if (fPageMapper != NULL)
 		fPageMapper->Delete();
 
@@ -703,11 +706,11 @@ X86VMTranslationMapPAE::UnmapPages(VMArea* area, addr_t base, size_t size,
 					updatePageQueue, &queue);
 			}
 		}
-
-		Flush();
-			// flush explicitly, since we directly use the lock
 	} while (start != 0 && start < end);
 
+	Flush();
+		// flush explicitly, since we directly use the lock
+
 	// TODO: As in UnmapPage() we can lose page dirty flags here. ATM it's not
 	// really critical here, as in all cases this method is used, the unmapped
 	// area range is unmapped for good (resized/cut) and the pages will likely
@@ -58,6 +58,7 @@
 
 static const bigtime_t kTransactionIdleTime = 2000000LL;
 	// a transaction is considered idle after 2 seconds of inactivity
+static const uint32 kMaxBlockShards = 64;
 
 
 namespace {
@@ -91,16 +92,23 @@ struct cached_block {
 #endif
 	int32			ref_count;
 	int32			last_accessed;
-	bool			busy_reading : 1;
 	bool			busy_writing : 1;
-	bool			is_writing : 1;
-		// Block has been checked out for writing without transactions, and
-		// cannot be written back if set
 	bool			is_dirty : 1;
-	bool			unused : 1;
-	bool			discard : 1;
 	bool			busy_reading_waiters : 1;
 	bool			busy_writing_waiters : 1;
+
+	// The following flags are accessed under the shard lock, see
+	// block_shard for details, and therefore cannot share a bit field with
+	// the ones above.
+	bool			busy_reading;
+	bool			unused;
+	bool			referenced;
+		// Block has been accessed again after its first use, and is kept in
+		// the protected list when unused
+	bool			is_writing;
+		// Block has been checked out for writing without transactions, and
+		// cannot be written back if set
+	bool			discard;
 	cache_transaction* transaction;
 		// This is the current active transaction, if any, the block is
 		// currently in (meaning was changed as a part of it).
@@ -214,8 +222,44 @@ struct TransactionHash {
 typedef BOpenHashTable<TransactionHash> TransactionTable;
 
 
+/*!	The blocks of a cache are spread over a number of shards by their block
+	number. A shard's lock protects its part of the block hash, its unused
+	lists, as well as the ref_count, last_accessed, unused, and referenced
+	fields of its blocks. This allows blocks that are already cached to be
+	retrieved and released again without acquiring the cache lock.
+
+	The cache lock protects the transactions, and everything else. The hash,
+	and the busy_reading flag of a block are only changed with both, the
+	cache lock and the shard lock held, so that holding either of them is
+	enough to look at them. The same goes for a block's transaction,
+	previous_transaction, is_writing, and discard fields, unless the block
+	is referenced by the one changing them (since they only matter when the
+	last reference is released).
+	The cache lock must be acquired before a shard lock, and no more than one
+	shard lock must be held at a time.
+
+	Unused blocks are kept in two lists, following the 2Q replacement policy:
+	blocks that have been used only once (or only within the same second) are
+	kept in the probation FIFO, while blocks that have been used again later
+	on are kept in the protected LRU list. Blocks are reclaimed from the
+	probation list first, as long as it holds a reasonable share of the
+	unused blocks, so that scanning a large directory does not push the
+	working set out of the cache.
+*/
+struct block_shard {
+	mutex			lock;
+	BlockTable		hash;
+	block_list		probation_blocks;
+	block_list		protected_blocks;
+	uint32			probation_count;
+	uint32			protected_count;
+};
+
+
 struct block_cache : DoublyLinkedListLinkImpl<block_cache> {
-	BlockTable*		hash;
+	block_shard*	shards;
+	uint32			shard_count;
+	uint32			next_reclaim_shard;
 	mutex			lock;
 	const int		fd;
 	off_t			max_blocks;
@@ -225,8 +269,7 @@ struct block_cache : DoublyLinkedListLinkImpl<block_cache> {
 	TransactionTable* transaction_hash;
 
 	object_cache*	buffer_cache;
-	block_list		unused_blocks;
-	uint32			unused_block_count;
+	int32			unused_block_count;
 
 	ConditionVariable busy_reading_condition;
 	uint32			busy_reading_count;
@@ -261,10 +304,56 @@ struct block_cache : DoublyLinkedListLinkImpl<block_cache> {
 	void			RemoveBlock(cached_block* block);
 	void			DiscardBlock(cached_block* block);
 
+	block_shard&	ShardFor(off_t blockNumber) const;
+	cached_block*	Lookup(off_t blockNumber) const;
+	void			InsertBlock(cached_block* block, bool unused);
+	void			UnlinkBlock(block_shard& shard, cached_block* block);
+	void			ReferenceBlock(block_shard& shard, cached_block* block);
+	void			AddUnusedBlock(block_shard& shard, cached_block* block);
+	void			RemoveUnusedBlock(block_shard& shard,
+						cached_block* block);
+
 private:
 	static void		_LowMemoryHandler(void* data, uint32 resources,
 						int32 level);
 	cached_block*	_GetUnusedBlock();
+	cached_block*	_ReclaimCandidate(block_shard& shard,
+						int32 minSecondsOld);
+	bool			_ReclaimBlock(block_shard& shard,
+						MutexLocker& shardLocker, cached_block* block);
+};
+
+
+/*!	Iterates over all blocks of a cache. The cache must be locked. */
+class BlockIterator {
+public:
+	BlockIterator(block_cache* cache)
+		:
+		fCache(cache),
+		fShard(0),
+		fIterator(&cache->shards[0].hash)
+	{
+	}
+
+	bool HasNext()
+	{
+		while (!fIterator.HasNext()) {
+			if (++fShard >= fCache->shard_count)
+				return false;
+			fIterator = BlockTable::Iterator(&fCache->shards[fShard].hash);
+		}
+		return true;
+	}
+
+	cached_block* Next()
+	{
+		return HasNext() ? fIterator.Next() : NULL;
+	}
+
+private:
+	block_cache*			fCache;
+	uint32					fShard;
+	BlockTable::Iterator	fIterator;
 };
 
 struct cache_transaction {
@@ -1373,10 +1462,15 @@ BlockWriter::_BlockDone(cached_block* block,
 
 	_UnmarkWriting(block);
 
+	block_shard& shard = fCache->ShardFor(block->block_number);
+
 	cache_transaction* previous = block->previous_transaction;
 	if (previous != NULL) {
 		previous->blocks.Remove(block);
+
+		mutex_lock(&shard.lock);
 		block->previous_transaction = NULL;
+		mutex_unlock(&shard.lock);
 
 		if (block->original_data != NULL && block->transaction == NULL) {
 			// This block is not part of a transaction, so it does not need
@@ -1406,13 +1500,14 @@ BlockWriter::_BlockDone(cached_block* block,
 			fDeletedTransaction = true;
 		}
 	}
+
+	MutexLocker shardLocker(shard.lock);
 	if (block->transaction == NULL && block->ref_count == 0 && !block->unused) {
 		// the block is no longer used
 		ASSERT(block->original_data == NULL && block->parent_data == NULL);
-		block->unused = true;
-		fCache->unused_blocks.Add(block);
-		fCache->unused_block_count++;
+		fCache->AddUnusedBlock(shard, block);
 	}
+	shardLocker.Unlock();
 
 	TB2(BlockData(fCache, block, "after write"));
 }
@@ -1495,7 +1590,7 @@ BlockPrefetcher::Allocate()
 				B_PRIdOFF ")", blockNumIter, fCache->max_blocks - 1);
 			return B_BAD_VALUE;
 		}
-		cached_block* block = fCache->hash->Lookup(blockNumIter);
+		cached_block* block = fCache->Lookup(blockNumIter);
 		if (block != NULL) {
 			// truncate the request
 			TRACE(("BlockPrefetcher::Allocate: found an existing block (%" B_PRIdOFF ")\n",
@@ -1510,14 +1605,14 @@ BlockPrefetcher::Allocate()
 	for (size_t i = 0; i < finalNumBlocks; ++i) {
 		cached_block* block = fCache->NewBlock(fBlockNumber + i);
 		if (block == NULL) {
-			_RemoveAllocated(0, i);
+			_RemoveAllocated(i, i);
 			return B_NO_MEMORY;
 		}
-		fCache->hash->Insert(block);
 
-		block->unused = true;
-		fCache->unused_blocks.Add(block);
-		fCache->unused_block_count++;
+		// The block must already be busy when it's inserted, as it can be
+		// found without the cache lock.
+		mark_block_busy_reading(fCache, block);
+		fCache->InsertBlock(block, true);
 
 		fBlocks[i] = block;
 	}
@@ -1541,7 +1636,6 @@ BlockPrefetcher::ReadAsync(MutexLocker& cacheLocker)
 	for (size_t i = 0; i < fNumAllocated; ++i) {
 		vecs[i].base = reinterpret_cast<generic_addr_t>(fBlocks[i]->current_data);
 		vecs[i].length = blockSize;
-		mark_block_busy_reading(fCache, fBlocks[i]);
 	}
 
 	IORequest* request = new IORequest;
@@ -1593,7 +1687,8 @@ BlockPrefetcher::_IOFinished(status_t status, generic_size_t bytesTransferred)
 		for (size_t i = 0; i < fNumAllocated; i++) {
 			TB(Read(cache, fBlockNumber + i));
 			mark_block_unbusy_reading(fCache, fBlocks[i]);
-			fBlocks[i]->last_accessed = system_time() / 1000000L;
+				// The block is only considered accessed once it's actually
+				// used, and will be reclaimed first until then.
 		}
 	}
 
@@ -1612,16 +1707,22 @@ BlockPrefetcher::_RemoveAllocated(size_t unbusyCount, size_t removeCount)
 
 	ASSERT_LOCKED_MUTEX(&fCache->lock);
 
-	for (size_t i = 0; i < unbusyCount; ++i)
-		mark_block_unbusy_reading(fCache, fBlocks[i]);
-
 	for (size_t i = 0; i < removeCount; ++i) {
 		ASSERT(fBlocks[i]->is_dirty == false && fBlocks[i]->unused == true);
 
-		fCache->unused_blocks.Remove(fBlocks[i]);
-		fCache->unused_block_count--;
+		block_shard& shard = fCache->ShardFor(fBlocks[i]->block_number);
+		mutex_lock(&shard.lock);
+		fCache->UnlinkBlock(shard, fBlocks[i]);
+		mutex_unlock(&shard.lock);
+	}
+
+	// The blocks are unbusied only after they have been removed from the
+	// hash, so that nobody can get them anymore.
+	for (size_t i = 0; i < unbusyCount; ++i)
+		mark_block_unbusy_reading(fCache, fBlocks[i]);
 
-		fCache->RemoveBlock(fBlocks[i]);
+	for (size_t i = 0; i < removeCount; ++i) {
+		fCache->FreeBlock(fBlocks[i]);
 		fBlocks[i] = NULL;
 	}
 
@@ -1638,7 +1739,9 @@ BlockPrefetcher::_RemoveAllocated(size_t unbusyCount, size_t removeCount)
 block_cache::block_cache(int _fd, off_t numBlocks, size_t blockSize,
 		bool readOnly)
 	:
-	hash(NULL),
+	shards(NULL),
+	shard_count(0),
+	next_reclaim_shard(0),
 	fd(_fd),
 	max_blocks(numBlocks),
 	block_size(blockSize),
@@ -1665,7 +1768,12 @@ block_cache::~block_cache()
 	unregister_low_resource_handler(&_LowMemoryHandler, this);
 
 	delete transaction_hash;
-	delete hash;
+
+	if (shards != NULL) {
+		for (uint32 i = 0; i < shard_count; i++)
+			mutex_destroy(&shards[i].lock);
+		delete[] shards;
+	}
 
 	delete_object_cache(buffer_cache);
 
@@ -1686,10 +1794,30 @@ block_cache::Init()
 	if (buffer_cache == NULL)
 		return B_NO_MEMORY;
 
-	hash = new BlockTable();
-	if (hash == NULL || hash->Init(1024) != B_OK)
+	// use twice as many shards as there are CPUs, so that they don't collide
+	// too often
+	system_info info;
+	get_system_info(&info);
+
+	uint32 shardCount = 1;
+	while (shardCount < 2 * info.cpu_count && shardCount < kMaxBlockShards)
+		shardCount <<= 1;
+
+	shards = new(std::nothrow) block_shard[shardCount];
+	if (shards == NULL)
 		return B_NO_MEMORY;
 
+	shard_count = shardCount;
+	for (uint32 i = 0; i < shard_count; i++) {
+		mutex_init(&shards[i].lock, "block cache shard");
+		shards[i].probation_count = 0;
+		shards[i].protected_count = 0;
+	}
+	for (uint32 i = 0; i < shard_count; i++) {
+		if (shards[i].hash.Init(1024 / shard_count) != B_OK)
+			return B_NO_MEMORY;
+	}
+
 	transaction_hash = new(std::nothrow) TransactionTable();
 	if (transaction_hash == NULL || transaction_hash->Init(16) != B_OK)
 		return B_NO_MEMORY;
@@ -1762,7 +1890,7 @@ block_cache::NewBlock(off_t blockNumber)
 		} else {
 			TB(Error(this, blockNumber, "allocation failed"));
 			TRACE_ALWAYS("block allocation failed, unused list is %sempty.\n",
-				unused_blocks.IsEmpty() ? "" : "not ");
+				unused_block_count == 0 ? "" : "not ");
 
 			// allocation failed, try to reuse an unused block
 			block = _GetUnusedBlock();
@@ -1786,6 +1914,7 @@ block_cache::NewBlock(off_t blockNumber)
 	block->is_writing = false;
 	block->is_dirty = false;
 	block->unused = false;
+	block->referenced = false;
 	block->discard = false;
 	block->busy_reading_waiters = false;
 	block->busy_writing_waiters = false;
@@ -1807,47 +1936,55 @@ block_cache::FreeBlockParentData(cached_block* block)
 }
 
 
+/*!	Frees up to \a count unused blocks that have not been accessed within
+	the last \a minSecondsOld seconds. The blocks are taken from all shards
+	in turn.
+*/
 void
 block_cache::RemoveUnusedBlocks(int32 count, int32 minSecondsOld)
 {
 	TRACE(("block_cache: remove up to %" B_PRId32 " unused blocks\n", count));
 
-	for (block_list::Iterator iterator = unused_blocks.GetIterator();
-			cached_block* block = iterator.Next();) {
-		if (minSecondsOld >= block->LastAccess()) {
-			// The list is sorted by last access
-			break;
-		}
-		if (block->busy_reading || block->busy_writing)
-			continue;
+	for (uint32 i = 0; i < shard_count && count > 0; i++) {
+		block_shard& shard = shards[next_reclaim_shard++ & (shard_count - 1)];
+		MutexLocker shardLocker(shard.lock);
 
-		TB(Flush(this, block));
-		TRACE(("  remove block %" B_PRIdOFF ", last accessed %" B_PRId32 "\n",
-			block->block_number, block->last_accessed));
+		// every shard contributes its share of the blocks
+		int32 shardCount = (count + shard_count - i - 1) / (shard_count - i);
+		uint32 tries = shard.probation_count + shard.protected_count;
 
-		// this can only happen if no transactions are used
-		if (block->is_dirty && !block->discard) {
-			if (block->busy_writing)
-				continue;
+		for (; shardCount > 0 && tries > 0; tries--) {
+			cached_block* block = _ReclaimCandidate(shard, minSecondsOld);
+			if (block == NULL)
+				break;
 
-			BlockWriter::WriteBlock(this, block);
-		}
+			TB(Flush(this, block));
+			TRACE(("  remove block %" B_PRIdOFF ", last accessed %" B_PRId32
+				"\n", block->block_number, block->last_accessed));
 
-		// remove block from lists
-		iterator.Remove();
-		unused_block_count--;
-		RemoveBlock(block);
+			if (!_ReclaimBlock(shard, shardLocker, block))
+				continue;
 
-		if (--count <= 0)
-			break;
+			FreeBlock(block);
+			shardCount--;
+			count--;
+		}
 	}
 }
 
 
+/*!	Removes the block from the cache, and frees it. The block must not be
+	referenced anymore.
+*/
 void
 block_cache::RemoveBlock(cached_block* block)
 {
-	hash->Remove(block);
+	block_shard& shard = ShardFor(block->block_number);
+
+	mutex_lock(&shard.lock);
+	UnlinkBlock(shard, block);
+	mutex_unlock(&shard.lock);
+
 	FreeBlock(block);
 }
 
@@ -1873,6 +2010,115 @@ block_cache::DiscardBlock(cached_block* block)
 }
 
 
+block_shard&
+block_cache::ShardFor(off_t blockNumber) const
+{
+	// The lower bits of the block number are used by the shard's hash table,
+	// so we take the upper half of a multiplicative hash instead.
+	uint32 hash = ((uint64)blockNumber * 0x9e3779b97f4a7c15ULL) >> 32;
+	return shards[hash & (shard_count - 1)];
+}
+
+
+/*!	Looks up the block with the given number. Either the cache lock, or the
+	block's shard lock must be held.
+*/
+cached_block*
+block_cache::Lookup(off_t blockNumber) const
+{
+	return ShardFor(blockNumber).hash.Lookup(blockNumber);
+}
+
+
+/*!	Inserts a new block into the hash, and into the unused lists, if
+	\a unused is \c true. The cache must be locked, but not the shard.
+*/
+void
+block_cache::InsertBlock(cached_block* block, bool unused)
+{
+	block_shard& shard = ShardFor(block->block_number);
+	MutexLocker shardLocker(shard.lock);
+
+	shard.hash.Insert(block);
+	if (unused)
+		AddUnusedBlock(shard, block);
+}
+
+
+/*!	Removes the block from the hash, and from the unused lists. Both, the
+	cache, and the \a shard must be locked.
+*/
+void
+block_cache::UnlinkBlock(block_shard& shard, cached_block* block)
+{
+	if (block->unused)
+		RemoveUnusedBlock(shard, block);
+
+	shard.hash.Remove(block);
+}
+
+
+/*!	Acquires a reference to the block, and marks it accessed. The \a shard
+	must be locked.
+*/
+void
+block_cache::ReferenceBlock(block_shard& shard, cached_block* block)
+{
+	if (block->unused)
+		RemoveUnusedBlock(shard, block);
+
+	// A block is only considered to be used again, if that happens in a
+	// different second than before; this filters out bursts of accesses to
+	// the same block.
+	int32 now = system_time() / 1000000L;
+	if (block->last_accessed != 0 && block->last_accessed != now)
+		block->referenced = true;
+
+	block->ref_count++;
+	block->last_accessed = now;
+}
+
+
+/*!	Puts the unreferenced block into the unused list it belongs to. The
+	\a shard must be locked.
+*/
+void
+block_cache::AddUnusedBlock(block_shard& shard, cached_block* block)
+{
+	ASSERT(!block->unused);
+	block->unused = true;
+
+	if (block->referenced) {
+		shard.protected_blocks.Add(block);
+		shard.protected_count++;
+	} else {
+		shard.probation_blocks.Add(block);
+		shard.probation_count++;
+	}
+
+	atomic_add(&unused_block_count, 1);
+}
+
+
+/*!	The \a shard must be locked. */
+void
+block_cache::RemoveUnusedBlock(block_shard& shard, cached_block* block)
+{
+	ASSERT(block->unused);
+	block->unused = false;
+
+	if (block->referenced) {
+		shard.protected_blocks.Remove(block);
+		shard.protected_count--;
+	} else {
+		shard.probation_blocks.Remove(block);
+		shard.probation_count--;
+	}
+
+	atomic_add(&unused_block_count, -1);
+}
+
+
 void
 block_cache::_LowMemoryHandler(void* data, uint32 resources, int32 level)
 {
@@ -1882,7 +2128,8 @@ block_cache::_LowMemoryHandler(void* data, uint32 resources, int32 level)
 	// (if there is enough memory left, we don't free any)
 
 	block_cache* cache = (block_cache*)data;
-	if (cache->unused_block_count <= 1)
+	int32 unusedCount = atomic_get(&cache->unused_block_count);
+	if (unusedCount <= 1)
 		return;
 
 	int32 free = 0;
@@ -1891,15 +2138,15 @@ block_cache::_LowMemoryHandler(void* data, uint32 resources, int32 level)
 		case B_NO_LOW_RESOURCE:
 			return;
 		case B_LOW_RESOURCE_NOTE:
-			free = cache->unused_block_count / 4;
+			free = unusedCount / 4;
 			secondsOld = 120;
 			break;
 		case B_LOW_RESOURCE_WARNING:
-			free = cache->unused_block_count / 2;
+			free = unusedCount / 2;
 			secondsOld = 10;
 			break;
 		case B_LOW_RESOURCE_CRITICAL:
-			free = cache->unused_block_count - 1;
+			free = unusedCount - 1;
 			secondsOld = 0;
 			break;
 	}
@@ -1914,35 +2161,37 @@ block_cache::_LowMemoryHandler(void* data, uint32 resources, int32 level)
 	}
 
 #ifdef TRACE_BLOCK_CACHE
-	uint32 oldUnused = cache->unused_block_count;
+	int32 oldUnused = cache->unused_block_count;
 #endif
 
 	cache->RemoveUnusedBlocks(free, secondsOld);
 
-	TRACE(("block_cache::_LowMemoryHandler(): %p: unused: %" B_PRIu32 " -> %" B_PRIu32 "\n",
+	TRACE(("block_cache::_LowMemoryHandler(): %p: unused: %" B_PRId32 " -> %" B_PRId32 "\n",
 		cache, oldUnused, cache->unused_block_count));
 }
 
 
+/*!	Takes an unused block out of the cache, so that it can be reused for
+	another block number.
+*/
 cached_block*
 block_cache::_GetUnusedBlock()
 {
 	TRACE(("block_cache: get unused block\n"));
 
-	for (block_list::Iterator iterator = unused_blocks.GetIterator();
-			cached_block* block = iterator.Next();) {
-		TB(Flush(this, block, true));
-		// this can only happen if no transactions are used
-		if (block->is_dirty && !block->busy_writing && !block->discard)
-			BlockWriter::WriteBlock(this, block);
+	for (uint32 i = 0; i < shard_count; i++) {
+		block_shard& shard = shards[next_reclaim_shard++ & (shard_count - 1)];
+		MutexLocker shardLocker(shard.lock);
 
-		// remove block from lists
-		iterator.Remove();
-		unused_block_count--;
-		hash->Remove(block);
+		cached_block* block = _ReclaimCandidate(shard, -1);
+		if (block == NULL)
+			continue;
+
+		TB(Flush(this, block, true));
+		if (!_ReclaimBlock(shard, shardLocker, block))
+			continue;
 
 		ASSERT(block->original_data == NULL && block->parent_data == NULL);
-		block->unused = false;
 
 		// TODO: see if compare data is handled correctly here!
 #if BLOCK_CACHE_DEBUG_CHANGED
@@ -1956,25 +2205,97 @@ block_cache::_GetUnusedBlock()
 }
 
 
+/*!	Chooses the unused block of the \a shard that should be reclaimed next,
+	if any. Blocks accessed within the last \a minSecondsOld seconds are not
+	considered. The \a shard must be locked.
+*/
+cached_block*
+block_cache::_ReclaimCandidate(block_shard& shard, int32 minSecondsOld)
+{
+	block_list* lists[2] = { &shard.probation_blocks, &shard.protected_blocks };
+
+	if (shard.probation_count * 4
+			< shard.probation_count + shard.protected_count) {
+		// Leave the blocks on probation a chance to be used again, and take
+		// the least recently used protected block instead.
+		lists[0] = &shard.protected_blocks;
+		lists[1] = &shard.probation_blocks;
+	}
+
+	for (int32 i = 0; i < 2; i++) {
+		for (block_list::Iterator iterator = lists[i]->GetIterator();
+				cached_block* block = iterator.Next();) {
+			if (minSecondsOld >= block->LastAccess()) {
+				// The lists are sorted by last access
+				break;
+			}
+			if (block->busy_reading || block->busy_writing)
+				continue;
+
+			return block;
+		}
+	}
+
+	return NULL;
+}
+
+
+/*!	Removes the unused \a block from the cache, so that it can be freed or
+	reused. If the block is dirty, it will be written back first, in which
+	case both, the cache lock and the shard lock will be dropped temporarily.
+	Returns \c false if the block cannot be reclaimed (anymore).
+*/
+bool
+block_cache::_ReclaimBlock(block_shard& shard, MutexLocker& shardLocker,
+	cached_block* block)
+{
+	if (block->is_dirty && !block->discard) {
+		// this can only happen if no transactions are used
+		shardLocker.Unlock();
+		BlockWriter::WriteBlock(this, block);
+		shardLocker.Lock();
+
+		// The block might have been used again in the meantime
+		if (!block->unused || block->is_dirty || block->busy_reading
+			|| block->busy_writing) {
+			return false;
+		}
+	}
+
+	UnlinkBlock(shard, block);
+	return true;
+}
+
+
 //	#pragma mark - private block functions
 
 
-/*!	Cache must be locked.
+/*!	Cache must be locked, the block's shard must not.
 */
 static void
 mark_block_busy_reading(block_cache* cache, cached_block* block)
 {
+	block_shard& shard = cache->ShardFor(block->block_number);
+
+	mutex_lock(&shard.lock);
 	block->busy_reading = true;
+	mutex_unlock(&shard.lock);
+
 	cache->busy_reading_count++;
 }
 
 
-/*!	Cache must be locked.
+/*!	Cache must be locked, the block's shard must not.
 */
 static void
 mark_block_unbusy_reading(block_cache* cache, cached_block* block)
 {
+	block_shard& shard = cache->ShardFor(block->block_number);
+
+	mutex_lock(&shard.lock);
 	block->busy_reading = false;
+	mutex_unlock(&shard.lock);
+
 	cache->busy_reading_count--;
 
 	if ((cache->busy_reading_waiters && cache->busy_reading_count == 0)
@@ -1987,20 +2308,20 @@ mark_block_unbusy_reading(block_cache* cache, cached_block* block)
 
 
 /*!	Cache must be locked.
+	Since the block might have been removed when this function returns, the
+	caller has to look it up again.
 */
 static void
 wait_for_busy_reading_block(block_cache* cache, cached_block* block)
 {
-	while (block->busy_reading) {
-		// wait for at least the specified block to be read in
-		ConditionVariableEntry entry;
-		cache->busy_reading_condition.Add(&entry);
-		block->busy_reading_waiters = true;
+	// wait for at least the specified block to be read in
+	ConditionVariableEntry entry;
+	cache->busy_reading_condition.Add(&entry);
+	block->busy_reading_waiters = true;
 
-		mutex_unlock(&cache->lock);
-		entry.Wait();
-		mutex_lock(&cache->lock);
-	}
+	mutex_unlock(&cache->lock);
+	entry.Wait();
+	mutex_lock(&cache->lock);
 }
 
 
@@ -2082,6 +2403,9 @@ put_cached_block(block_cache* cache, cached_block* block)
 #endif
 	TB(Put(cache, block));
 
+	block_shard& shard = cache->ShardFor(block->block_number);
+	MutexLocker shardLocker(shard.lock);
+
 	if (block->ref_count < 1) {
 		panic("Invalid ref_count for block %p, cache %p\n", block, cache);
 		return;
@@ -2093,15 +2417,14 @@ put_cached_block(block_cache* cache, cached_block* block)
 		block->is_writing = false;
 
 		if (block->discard) {
-			cache->RemoveBlock(block);
+			cache->UnlinkBlock(shard, block);
+			shardLocker.Unlock();
+
+			cache->FreeBlock(block);
 		} else {
 			// put this block in the list of unused blocks
-			ASSERT(!block->unused);
-			block->unused = true;
-
 			ASSERT(block->original_data == NULL && block->parent_data == NULL);
-			cache->unused_blocks.Add(block);
-			cache->unused_block_count++;
+			cache->AddUnusedBlock(shard, block);
 		}
 	}
 }
@@ -2115,7 +2438,7 @@ put_cached_block(block_cache* cache, off_t blockNumber)
 			blockNumber, cache->max_blocks - 1);
 	}
 
-	cached_block* block = cache->hash->Lookup(blockNumber);
+	cached_block* block = cache->Lookup(blockNumber);
 	if (block != NULL)
 		put_cached_block(cache, block);
 	else {
@@ -2124,6 +2447,68 @@ put_cached_block(block_cache* cache, off_t blockNumber)
 }
 
 
+/*!	Releases a reference to the block \a blockNumber without locking the
+	cache, which is possible unless this is the last reference, and the block
+	has to be written back or discarded.
+	Returns \c false if put_cached_block() has to be used instead.
+*/
+static bool
+put_cached_block_unlocked(block_cache* cache, off_t blockNumber)
+{
+#if BLOCK_CACHE_DEBUG_CHANGED
+	// the block contents are checked in put_cached_block()
+	return false;
+#else
+	block_shard& shard = cache->ShardFor(blockNumber);
+	MutexLocker shardLocker(shard.lock);
+
+	cached_block* block = shard.hash.Lookup(blockNumber);
+	if (block == NULL || block->ref_count < 1)
+		return false;
+
+	bool unused = block->ref_count == 1 && block->transaction == NULL
+		&& block->previous_transaction == NULL;
+	if (unused && (block->is_writing || block->discard))
+		return false;
+
+	TB(Put(cache, block));
+
+	block->ref_count--;
+	if (unused) {
+		ASSERT(block->original_data == NULL && block->parent_data == NULL);
+		cache->AddUnusedBlock(shard, block);
+	}
+
+	return true;
+#endif
+}
+
+
+/*!	Gets a reference to the block \a blockNumber without locking the cache.
+	This is possible if it is already in the cache, and not being read in.
+	Returns \c NULL if get_cached_block() has to be used instead.
+*/
+static cached_block*
+get_cached_block_unlocked(block_cache* cache, off_t blockNumber)
+{
+#if BLOCK_CACHE_DEBUG_CHANGED
+	// block_cache_get_etc() needs the cache lock to maintain the compare
+	// data
+	return NULL;
+#else
+	block_shard& shard = cache->ShardFor(blockNumber);
+	MutexLocker shardLocker(shard.lock);
+
+	cached_block* block = shard.hash.Lookup(blockNumber);
+	if (block == NULL || block->busy_reading)
+		return NULL;
+
+	cache->ReferenceBlock(shard, block);
+	return block;
+#endif
+}
+
+
 /*!	Retrieves the block \a blockNumber from the hash table, if it's already
 	there, or reads it from the disk.
 	You need to have the cache locked when calling this function.
@@ -2132,8 +2517,10 @@ put_cached_block(block_cache* cache, off_t blockNumber)
 		to satisfy your request.
 	\param readBlock if \c false, the block will not be read in case it was
 		not already in the cache. The block you retrieve may contain random
-		data. If \c true, the cache will be temporarily unlocked while the
-		block is read in.
+		data then, and is still marked busy, so that nobody else can get it
+		before you have called mark_block_unbusy_reading().
+		If \c true, the cache will be temporarily unlocked while the block
+		is read in.
 */
 static status_t
 get_cached_block(block_cache* cache, off_t blockNumber, bool* _allocated,
@@ -2148,7 +2535,7 @@ get_cached_block(block_cache* cache, off_t blockNumber, bool* _allocated,
 	}
 
 retry:
-	cached_block* block = cache->hash->Lookup(blockNumber);
+	cached_block* block = cache->Lookup(blockNumber);
 	*_allocated = false;
 
 	if (block == NULL) {
@@ -2156,8 +2543,17 @@ retry:
 		block = cache->NewBlock(blockNumber);
 		if (block == NULL)
 			return B_NO_MEMORY;
+		if (cache->Lookup(blockNumber) != NULL) {
+			// Someone else was faster while the cache was unlocked to write
+			// back the block we are reusing
+			cache->FreeBlock(block);
+			goto retry;
+		}
 
-		cache->hash->Insert(block);
+		// The block can be found without the cache lock as soon as it's in
+		// the hash, so it must be busy until it has valid contents.
+		mark_block_busy_reading(cache, block);
+		cache->InsertBlock(block, false);
 		*_allocated = true;
 	} else if (block->busy_reading) {
 		// The block is currently busy_reading - wait and try again later
@@ -2168,29 +2564,29 @@ retry:
 		goto retry;
 	}
 
-	if (block->unused) {
-		//TRACE(("remove block %" B_PRIdOFF " from unused\n", blockNumber));
-		block->unused = false;
-		cache->unused_blocks.Remove(block);
-		cache->unused_block_count--;
-	}
-
 	if (*_allocated && readBlock) {
 		// read block into cache
 		int32 blockSize = cache->block_size;
 
-		mark_block_busy_reading(cache, block);
 		mutex_unlock(&cache->lock);
 
 		ssize_t bytesRead = read_pos(cache->fd, blockNumber * blockSize,
 			block->current_data, blockSize);
+		status_t error = errno;
 
 		mutex_lock(&cache->lock);
 		if (bytesRead < blockSize) {
-			cache->RemoveBlock(block);
+			// Remove the block from the hash before it's unbusied, so that
+			// nobody can get it anymore
+			block_shard& shard = cache->ShardFor(blockNumber);
+			mutex_lock(&shard.lock);
+			cache->UnlinkBlock(shard, block);
+			mutex_unlock(&shard.lock);
+
+			mark_block_unbusy_reading(cache, block);
+			cache->FreeBlock(block);
 			TB(Error(cache, blockNumber, "read failed", bytesRead));
 
-			status_t error = errno;
 			TRACE_ALWAYS("could not read block %" B_PRIdOFF ": bytesRead: %zd,"
 				" error: %s\n", blockNumber, bytesRead, strerror(error));
 			if (error == B_OK)
@@ -2202,8 +2598,10 @@ retry:
 		mark_block_unbusy_reading(cache, block);
 	}
 
-	block->ref_count++;
-	block->last_accessed = system_time() / 1000000L;
+	block_shard& shard = cache->ShardFor(blockNumber);
+	mutex_lock(&shard.lock);
+	cache->ReferenceBlock(shard, block);
+	mutex_unlock(&shard.lock);
 
 	*_block = block;
 	return B_OK;
@@ -2237,6 +2635,16 @@ get_writable_cached_block(block_cache* cache, off_t blockNumber,
 	if (status != B_OK)
 		return status;
 
+	if (allocated && cleared) {
+		// the block has not been read in, and is still marked busy
+		mutex_unlock(&cache->lock);
+
+		memset(block->current_data, 0, cache->block_size);
+
+		mutex_lock(&cache->lock);
+		mark_block_unbusy_reading(cache, block);
+	}
+
 	if (block->busy_writing)
 		wait_for_busy_writing_block(cache, block);
 
@@ -2244,7 +2652,7 @@ get_writable_cached_block(block_cache* cache, off_t blockNumber,
 
 	// if there is no transaction support, we just return the current block
 	if (transactionID == -1) {
-		if (cleared) {
+		if (cleared && !allocated) {
 			mark_block_busy_reading(cache, block);
 			mutex_unlock(&cache->lock);
 
@@ -2348,7 +2756,7 @@ get_writable_cached_block(block_cache* cache, off_t blockNumber,
 		&& block->parent_data == NULL && wasUnchanged)
 		transaction->sub_num_blocks++;
 
-	if (cleared) {
+	if (cleared && !allocated) {
 		mark_block_busy_reading(cache, block);
 		mutex_unlock(&cache->lock);
 
@@ -2409,6 +2817,8 @@ dump_block_long(cached_block* block)
 		kprintf(" is-dirty");
 	if (block->unused)
 		kprintf(" unused");
+	if (block->referenced)
+		kprintf(" referenced");
 	if (block->discard)
 		kprintf(" discard");
 	kprintf("\n");
@@ -2482,7 +2892,7 @@ dump_cache(int argc, char** argv)
 	off_t blockNumber = -1;
 	if (i + 1 < argc) {
 		blockNumber = parse_expression(argv[i + 1]);
-		cached_block* block = cache->hash->Lookup(blockNumber);
+		cached_block* block = cache->Lookup(blockNumber);
 		if (block != NULL)
 			dump_block_long(block);
 		else
@@ -2501,6 +2911,7 @@ dump_cache(int argc, char** argv)
 		cache->busy_reading_waiters ? "has" : "no");
 	kprintf(" busy_writing: %" B_PRIu32 ", %s waiters\n", cache->busy_writing_count,
 		cache->busy_writing_waiters ? "has" : "no");
+	kprintf(" shards:       %" B_PRIu32 "\n", cache->shard_count);
 
 	if (!cache->pending_notifications.IsEmpty()) {
 		kprintf(" pending notifications:\n");
@@ -2542,7 +2953,8 @@ dump_cache(int argc, char** argv)
 	uint32 count = 0;
 	uint32 dirty = 0;
 	uint32 discarded = 0;
-	BlockTable::Iterator iterator(cache->hash);
+	uint32 probation = 0;
+	BlockIterator iterator(cache);
 	while (iterator.HasNext()) {
 		cached_block* block = iterator.Next();
 		if (showBlocks)
@@ -2556,12 +2968,14 @@ dump_cache(int argc, char** argv)
 			referenced++;
 		count++;
 	}
+	for (uint32 i = 0; i < cache->shard_count; i++)
+		probation += cache->shards[i].probation_count;
 
 	kprintf(" %" B_PRIu32 " blocks total, %" B_PRIu32 " dirty, %" B_PRIu32
-		" discarded, %" B_PRIu32 " referenced, %" B_PRIu32 " busy, %" B_PRIu32
-		" in unused.\n",
+		" discarded, %" B_PRIu32 " referenced, %" B_PRIu32 " busy, %" B_PRId32
+		" in unused (%" B_PRIu32 " on probation).\n",
 		count, dirty, discarded, referenced, cache->busy_reading_count,
-		cache->unused_block_count);
+		cache->unused_block_count, probation);
 	return 0;
 }
 
@@ -2850,7 +3264,7 @@ block_notifier_and_writer(void* /*data*/)
 			if (cache->num_dirty_blocks) {
 				// This cache is not using transactions, we'll scan the blocks
 				// directly
-				BlockTable::Iterator iterator(cache->hash);
+				BlockIterator iterator(cache);
 
 				while (iterator.HasNext()) {
 					cached_block* block = iterator.Next();
@@ -3171,9 +3585,12 @@ cache_end_transaction(void* _cache, int32 id,
 		// move the block to the previous transaction list
 		transaction->blocks.Add(block);
 
+		block_shard& shard = cache->ShardFor(block->block_number);
+		mutex_lock(&shard.lock);
 		block->previous_transaction = transaction;
 		block->transaction_next = NULL;
 		block->transaction = NULL;
+		mutex_unlock(&shard.lock);
 	}
 
 	transaction->open = false;
@@ -3217,10 +3634,16 @@ cache_abort_transaction(void* _cache, int32 id)
 			cache->FreeBlockParentData(block);
 
 		block->transaction_next = NULL;
-		block->transaction = NULL;
-		block->discard = false;
 		if (block->previous_transaction == NULL)
 			block->is_dirty = false;
+
+		block_shard& shard = cache->ShardFor(block->block_number);
+		MutexLocker shardLocker(shard.lock);
+		block->transaction = NULL;
+		block->discard = false;
+
+		if (block->previous_transaction == NULL && block->ref_count == 0)
+			cache->AddUnusedBlock(shard, block);
 	}
 
 	cache->transaction_hash->Remove(transaction);
@@ -3285,7 +3708,8 @@ cache_detach_sub_transaction(void* _cache, int32 id,
 			continue;
 		}
 
-		if (block->parent_data != NULL) {
+		bool changedInParent = block->parent_data != NULL;
+		if (changedInParent) {
 			// The block changed in the parent - free the original data, since
 			// they will be replaced by what is in current.
 			ASSERT(block->original_data != NULL);
@@ -3302,9 +3726,14 @@ cache_detach_sub_transaction(void* _cache, int32 id,
 
 			// move the block to the previous transaction list
 			transaction->blocks.Add(block);
-			block->previous_transaction = transaction;
 		}
 
+		block_shard& shard = cache->ShardFor(block->block_number);
+		MutexLocker shardLocker(shard.lock);
+
+		if (changedInParent)
+			block->previous_transaction = transaction;
+
 		if (block->original_data != NULL) {
 			// This block had been changed in the current sub transaction,
 			// we need to move this block over to the new transaction.
@@ -3380,21 +3809,24 @@ cache_abort_sub_transaction(void* _cache, int32 id)
 				transaction->first_block = next;
 
 			block->transaction_next = NULL;
-			block->transaction = NULL;
 			transaction->num_blocks--;
 
 			if (block->previous_transaction == NULL) {
 				cache->Free(block->original_data);
 				block->original_data = NULL;
 				block->is_dirty = false;
+			}
 
-				if (block->ref_count == 0) {
-					// Move the block into the unused list if possible
-					block->unused = true;
-					cache->unused_blocks.Add(block);
-					cache->unused_block_count++;
-				}
+			block_shard& shard = cache->ShardFor(block->block_number);
+			MutexLocker shardLocker(shard.lock);
+			block->transaction = NULL;
+			block->discard = false;
+
+			if (block->previous_transaction == NULL && block->ref_count == 0) {
+				// Move the block into the unused list if possible
+				cache->AddUnusedBlock(shard, block);
 			}
+			continue;
 		} else {
 			if (block->parent_data != block->current_data) {
 				// The block has been changed and must be restored - the block
@@ -3633,7 +4065,7 @@ cache_has_block_in_transaction(void* _cache, int32 id, off_t blockNumber)
 	block_cache* cache = (block_cache*)_cache;
 	TransactionLocker locker(cache);
 
-	cached_block* block = cache->hash->Lookup(blockNumber);
+	cached_block* block = cache->Lookup(blockNumber);
 
 	return (block != NULL && block->transaction != NULL
 		&& block->transaction->id == id);
@@ -3663,11 +4095,13 @@ block_cache_delete(void* _cache, bool allowWrites)
 
 	// free all blocks
 
-	cached_block* block = cache->hash->Clear(true);
-	while (block != NULL) {
-		cached_block* next = block->next;
-		cache->FreeBlock(block);
-		block = next;
+	for (uint32 i = 0; i < cache->shard_count; i++) {
+		cached_block* block = cache->shards[i].hash.Clear(true);
+		while (block != NULL) {
+			cached_block* next = block->next;
+			cache->FreeBlock(block);
+			block = next;
+		}
 	}
 
 	// free all transactions (they will all be aborted)
@@ -3714,7 +4148,7 @@ block_cache_sync(void* _cache)
 	MutexLocker locker(&cache->lock);
 
 	BlockWriter writer(cache);
-	BlockTable::Iterator iterator(cache->hash);
+	BlockIterator iterator(cache);
 
 	while (iterator.HasNext()) {
 		cached_block* block = iterator.Next();
@@ -3752,7 +4186,7 @@ block_cache_sync_etc(void* _cache, off_t blockNumber, size_t numBlocks)
 	BlockWriter writer(cache);
 
 	for (; numBlocks > 0; numBlocks--, blockNumber++) {
-		cached_block* block = cache->hash->Lookup(blockNumber);
+		cached_block* block = cache->Lookup(blockNumber);
 		if (block == NULL)
 			continue;
 
@@ -3786,7 +4220,7 @@ block_cache_discard(void* _cache, off_t blockNumber, size_t numBlocks)
 	BlockWriter writer(cache);
 
 	for (size_t i = 0; i < numBlocks; i++, blockNumber++) {
-		cached_block* block = cache->hash->Lookup(blockNumber);
+		cached_block* block = cache->Lookup(blockNumber);
 		if (block != NULL && block->previous_transaction != NULL)
 			writer.Add(block);
 	}
@@ -3798,16 +4232,20 @@ block_cache_discard(void* _cache, off_t blockNumber, size_t numBlocks)
 		// reset blockNumber to its original value
 
 	for (size_t i = 0; i < numBlocks; i++, blockNumber++) {
-		cached_block* block = cache->hash->Lookup(blockNumber);
+		cached_block* block = cache->Lookup(blockNumber);
 		if (block == NULL)
 			continue;
 
 		ASSERT(block->previous_transaction == NULL);
 
+		block_shard& shard = cache->ShardFor(blockNumber);
+		MutexLocker shardLocker(shard.lock);
+
 		if (block->unused) {
-			cache->unused_blocks.Remove(block);
-			cache->unused_block_count--;
-			cache->RemoveBlock(block);
+			cache->UnlinkBlock(shard, block);
+			shardLocker.Unlock();
+
+			cache->FreeBlock(block);
 		} else {
 			if (block->transaction != NULL && block->parent_data != NULL
 				&& block->parent_data != block->current_data) {
@@ -3899,10 +4337,18 @@ status_t
 block_cache_get_etc(void* _cache, off_t blockNumber, const void** _block)
 {
 	block_cache* cache = (block_cache*)_cache;
+
+	cached_block* block = get_cached_block_unlocked(cache, blockNumber);
+	if (block != NULL) {
+		TB(Get(cache, block));
+
+		*_block = block->current_data;
+		return B_OK;
+	}
+
 	MutexLocker locker(&cache->lock);
 	bool allocated;
 
-	cached_block* block;
 	status_t status = get_cached_block(cache, blockNumber, &allocated, true,
 		&block);
 	if (status != B_OK)
@@ -3946,7 +4392,7 @@ block_cache_set_dirty(void* _cache, off_t blockNumber, bool dirty,
 	block_cache* cache = (block_cache*)_cache;
 	MutexLocker locker(&cache->lock);
 
-	cached_block* block = cache->hash->Lookup(blockNumber);
+	cached_block* block = cache->Lookup(blockNumber);
 	if (block == NULL)
 		return B_BAD_VALUE;
 	if (block->is_dirty == dirty) {
@@ -3966,6 +4412,9 @@ void
 block_cache_put(void* _cache, off_t blockNumber)
 {
 	block_cache* cache = (block_cache*)_cache;
+	if (put_cached_block_unlocked(cache, blockNumber))
+		return;
+
 	MutexLocker locker(&cache->lock);
 
 	put_cached_block(cache, blockNumber);
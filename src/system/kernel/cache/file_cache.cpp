@@ -6,6 +6,7 @@
 
 #include "vnode_store.h"
 
+#include <fcntl.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
@@ -41,6 +42,29 @@
 #define BYPASS_IO_SIZE		65536
 #define LAST_ACCESSES		3
 
+// number of sequential read streams tracked per file
+#define READ_AHEAD_STREAMS	4
+
+// read ahead window sizes
+static const size_t kMinReadAhead = MAX_IO_VECS * B_PAGE_SIZE;
+static const size_t kMaxReadAhead = 2 * 1024 * 1024;
+static const size_t kMaxSequentialReadAhead = 8 * 1024 * 1024;
+	// used when sequential access has been announced
+
+struct read_ahead_stream {
+	off_t			next_offset;
+		// where the next read of this stream is expected to start
+	off_t			marker;
+		// first page of the most recent read ahead batch; a read beyond it
+		// starts the next batch
+	off_t			end;
+		// end of what has been read ahead so far
+	uint32			window;
+		// size of the next batch
+	uint32			last_used;
+		// 0 if the stream is unused
+};
+
 struct file_cache_ref {
 	VMCache			*cache;
 	struct vnode	*vnode;
@@ -50,6 +74,12 @@ struct file_cache_ref {
 		//	write vs. read)
 	int32			last_access_index;
 	uint16			disabled_count;
+	uint8			advice;
+		// POSIX_FADV_* value for the whole file
+
+	// protected by the cache lock
+	read_ahead_stream streams[READ_AHEAD_STREAMS];
+	uint32			stream_clock;
 
 	inline void SetLastAccess(int32 index, off_t access, bool isWrite)
 	{
@@ -283,6 +313,169 @@ push_access(file_cache_ref* ref, off_t offset, generic_size_t bytes,
 }
 
 
+/*!	Reads the pages of the given range that are not in the cache yet
+	asynchronously. \a offset and \a size must be page aligned, and must not
+	exceed the file size.
+	The caller must hold a reference to the cache, but must not have it locked.
+*/
+static void
+read_pages_async(file_cache_ref* ref, off_t offset, size_t size)
+{
+	VMCache* cache = ref->cache;
+
+	// Skip what is already cached without locking the cache, in the common
+	// case that is everything. This is only a hint, we check again below.
+	while (size > 0 && cache->LookupPageUnlocked(offset) != NULL) {
+		offset += B_PAGE_SIZE;
+		size -= B_PAGE_SIZE;
+	}
+	if (size == 0)
+		return;
+
+	size_t bytesToRead = 0;
+	off_t lastOffset = offset;
+
+	vm_page_reservation reservation;
+	vm_page_reserve_pages(&reservation, size / B_PAGE_SIZE, VM_PRIORITY_USER);
+
+	VMCachePagesTreePreload preload;
+	preload.Preload(VMCachePagesTreePreload::NodesNeeded(size / B_PAGE_SIZE));
+
+	cache->Lock();
+
+	while (true) {
+		// check if this page is already in memory
+		if (size > 0) {
+			vm_page* page = cache->LookupPage(offset);
+
+			offset += B_PAGE_SIZE;
+			size -= B_PAGE_SIZE;
+
+			if (page == NULL) {
+				bytesToRead += B_PAGE_SIZE;
+				continue;
+			}
+		}
+		if (bytesToRead != 0) {
+			// read the part before the current page (or the end of the request)
+			PrecacheIO* io = new(std::nothrow) PrecacheIO(ref, lastOffset,
+				bytesToRead);
+			if (io == NULL || io->Prepare(&reservation) != B_OK) {
+				delete io;
+				break;
+			}
+
+			// we must not have the cache locked during I/O
+			cache->Unlock();
+			io->ReadAsync();
+			cache->Lock();
+
+			bytesToRead = 0;
+		}
+
+		if (size == 0) {
+			// we have reached the end of the request
+			break;
+		}
+
+		lastOffset = offset;
+	}
+
+	cache->Unlock();
+	vm_page_unreserve_pages(&reservation);
+}
+
+
+/*!	Tracks the sequential read streams of the file, and reads ahead for them.
+
+	A read that continues where a stream left off belongs to that stream,
+	any other read starts a new one, replacing the least recently used stream.
+	A new stream is only read ahead when it starts at the beginning of the
+	file, or when sequential access has been announced, otherwise the second
+	read confirms it.
+	The data is read ahead asynchronously in batches that double in size up to
+	a maximum. The start of the latest batch serves as marker: as soon as a
+	read passes it, the next batch is started behind the current one. Thus,
+	while the stream consumes one batch, the next one is already underway.
+
+	The cache must not be locked.
+*/
+static void
+read_ahead(file_cache_ref* ref, off_t offset, size_t size)
+{
+	VMCache* cache = ref->cache;
+	off_t end = offset + size;
+
+	AutoLocker<VMCache> locker(cache);
+
+	if (ref->advice == POSIX_FADV_RANDOM || ref->disabled_count > 0)
+		return;
+
+	size_t maxWindow = ref->advice == POSIX_FADV_SEQUENTIAL
+		? kMaxSequentialReadAhead : kMaxReadAhead;
+
+	read_ahead_stream* stream = NULL;
+	read_ahead_stream* oldest = &ref->streams[0];
+	for (int32 i = 0; i < READ_AHEAD_STREAMS; i++) {
+		read_ahead_stream* candidate = &ref->streams[i];
+		if (candidate->last_used != 0 && offset <= candidate->next_offset
+			&& offset >= candidate->next_offset - B_PAGE_SIZE) {
+			stream = candidate;
+			break;
+		}
+		if (candidate->last_used < oldest->last_used)
+			oldest = candidate;
+	}
+
+	if (stream == NULL) {
+		stream = oldest;
+		stream->next_offset = end;
+		stream->marker = offset;
+		stream->end = end;
+		stream->window = min_c(max_c(kMinReadAhead,
+			2 * ROUNDUP(size, B_PAGE_SIZE)), maxWindow);
+		stream->last_used = ++ref->stream_clock;
+
+		if (offset != 0 && ref->advice != POSIX_FADV_SEQUENTIAL)
+			return;
+	} else {
+		stream->next_offset = end;
+		stream->last_used = ++ref->stream_clock;
+	}
+
+	if (end <= stream->marker)
+		return;
+
+	// The stream has passed the marker, start the next batch. If the stream
+	// has overtaken the read ahead, the batch starts behind the current read,
+	// and the window doesn't grow.
+	if (stream->end > end)
+		stream->window = min_c(stream->window * 2, maxWindow);
+
+	off_t start = max_c(stream->end, ROUNDUP(end, B_PAGE_SIZE));
+	off_t fileSize = cache->virtual_end;
+	if (start >= fileSize)
+		return;
+
+	size_t batchSize = (size_t)min_c((off_t)stream->window,
+		ROUNDUP(fileSize - start, B_PAGE_SIZE));
+
+	// don't compete with other users for memory
+	if (low_resource_state(B_KERNEL_RESOURCE_PAGES) != B_NO_LOW_RESOURCE
+		|| vm_page_num_unused_pages() < 2 * batchSize / B_PAGE_SIZE) {
+		return;
+	}
+
+	stream->marker = start;
+	stream->end = start + batchSize;
+
+	TRACE(("%p: read ahead %lld, %lu\n", ref, start, batchSize));
+
+	locker.Unlock();
+	read_pages_async(ref, start, batchSize);
+}
+
+
 static void
 reserve_pages(file_cache_ref* ref, vm_page_reservation* reservation,
 	size_t reservePages, bool isWrite)
@@ -329,6 +522,10 @@ reserve_pages(file_cache_ref* ref, vm_page_reservation* reservation,
 	}
 
 	vm_page_reserve_pages(reservation, reservePages, VM_PRIORITY_USER);
+
+	// the reserved pages are going to be inserted into the cache
+	VMCachePagesTreePreload::PreloadCurrent(
+		VMCachePagesTreePreload::NodesNeeded(reservePages));
 }
 
 
@@ -761,6 +958,7 @@ cache_io(void* _cacheRef, void* cookie, off_t offset, addr_t buffer,
 	cache_func function = NULL;
 
 	vm_page_reservation reservation;
+	VMCachePagesTreePreload preload;
 	reserve_pages(ref, &reservation, lastReservedPages, doWrite);
 
 	AutoLocker<VMCache> locker(cache);
@@ -905,9 +1103,14 @@ file_cache_control(const char* subsystem, uint32 function, void* buffer,
 {
 	switch (function) {
 		case CACHE_CLEAR:
-			// ToDo: clear the cache
-			dprintf("cache_control: clear cache!\n");
+		{
+			// Only unmapped, unmodified pages can go, which is what a cold
+			// start needs to reread
+			uint32 count = vm_page_free_cached_pages();
+			TRACE(("cache_control: cleared %" B_PRIu32 " pages!\n", count));
+			(void)count;
 			return B_OK;
+		}
 
 		case CACHE_SET_MODULE:
 		{
@@ -986,54 +1189,93 @@ cache_prefetch_vnode(struct vnode* vnode, off_t offset, size_t size)
 		return;
 	}
 
-	size_t bytesToRead = 0;
-	off_t lastOffset = offset;
+	read_pages_async(ref, offset, size);
+	cache->ReleaseRef();
+}
 
-	vm_page_reservation reservation;
-	vm_page_reserve_pages(&reservation, pagesCount, VM_PRIORITY_USER);
 
-	cache->Lock();
+/*!	Applies the POSIX_FADV_* \a advice to the given range of the file \a cache
+	belongs to. A \a length of 0 stands for the rest of the file.
+	The access pattern hints apply to the whole file, not only to the range.
+*/
+extern "C" status_t
+cache_advise(VMCache* cache, off_t offset, off_t length, int advice)
+{
+	if (offset < 0 || length < 0)
+		return B_BAD_VALUE;
+	if (cache->type != CACHE_TYPE_VNODE)
+		return B_OK;
 
-	while (true) {
-		// check if this page is already in memory
-		if (size > 0) {
-			vm_page* page = cache->LookupPage(offset);
+	file_cache_ref* ref = ((VMVnodeCache*)cache)->FileCacheRef();
+	if (ref == NULL)
+		return B_OK;
 
-			offset += B_PAGE_SIZE;
-			size -= B_PAGE_SIZE;
+	AutoLocker<VMCache> locker(cache);
 
-			if (page == NULL) {
-				bytesToRead += B_PAGE_SIZE;
-				continue;
-			}
-		}
-		if (bytesToRead != 0) {
-			// read the part before the current page (or the end of the request)
-			PrecacheIO* io = new(std::nothrow) PrecacheIO(ref, lastOffset,
-				bytesToRead);
-			if (io == NULL || io->Prepare(&reservation) != B_OK) {
-				delete io;
+	off_t fileSize = cache->virtual_end;
+	if (offset >= fileSize)
+		return B_OK;
+	if (length == 0 || length > fileSize - offset)
+		length = fileSize - offset;
+
+	switch (advice) {
+		case POSIX_FADV_NORMAL:
+		case POSIX_FADV_SEQUENTIAL:
+		case POSIX_FADV_NOREUSE:
+			ref->advice = advice == POSIX_FADV_SEQUENTIAL
+				? POSIX_FADV_SEQUENTIAL : POSIX_FADV_NORMAL;
+			break;
+
+		case POSIX_FADV_RANDOM:
+			// forget about the streams, there won't be any read ahead anymore
+			ref->advice = POSIX_FADV_RANDOM;
+			memset(ref->streams, 0, sizeof(ref->streams));
+			break;
+
+		case POSIX_FADV_WILLNEED:
+		{
+			if (ref->disabled_count > 0)
 				break;
-			}
 
-			// we must not have the cache locked during I/O
-			cache->Unlock();
-			io->ReadAsync();
-			cache->Lock();
+			off_t end = ROUNDUP(offset + length, B_PAGE_SIZE);
+			offset = ROUNDDOWN(offset, B_PAGE_SIZE);
+			size_t size = (size_t)min_c(end - offset,
+				(off_t)kMaxSequentialReadAhead);
+			if (vm_page_num_unused_pages() < 2 * size / B_PAGE_SIZE)
+				break;
 
-			bytesToRead = 0;
+			locker.Unlock();
+			read_pages_async(ref, offset, size);
+			break;
 		}
 
-		if (size == 0) {
-			// we have reached the end of the request
+		case POSIX_FADV_DONTNEED:
+		{
+			// drop the clean pages of the range that aren't in use
+			page_num_t endPage = (offset + length + B_PAGE_SIZE - 1)
+				>> PAGE_SHIFT;
+			VMCachePagesTree::Iterator it = cache->pages.GetIterator(
+				offset >> PAGE_SHIFT, true, true);
+			while (vm_page* page = it.Next()) {
+				if (page->cache_offset >= endPage)
+					break;
+				if (page->State() != PAGE_STATE_CACHED || page->busy
+					|| page->IsMapped() || page->modified) {
+					continue;
+				}
+
+				DEBUG_PAGE_ACCESS_START(page);
+				cache->RemovePage(page);
+				vm_page_free(cache, page);
+			}
 			break;
 		}
 
-		lastOffset = offset;
+		default:
+			return B_BAD_VALUE;
 	}
 
-	cache->ReleaseRefAndUnlock();
-	vm_page_unreserve_pages(&reservation);
+	return B_OK;
 }
 
 
@@ -1099,6 +1341,32 @@ cache_node_launched(size_t argCount, char*  const* args)
 }
 
 
+/*!	Tells the cache module that the given range of a vnode cache has been
+	read or mapped in. Must be called without holding any VM locks.
+*/
+extern "C" void
+cache_node_accessed(VMCache* cache, off_t offset, size_t size)
+{
+	cache_module_info* module = sCacheModule;
+	if (module == NULL || module->node_accessed == NULL
+		|| cache->type != CACHE_TYPE_VNODE) {
+		return;
+	}
+
+	VMVnodeCache* vnodeCache = (VMVnodeCache*)cache;
+	module->node_accessed(vnodeCache->DeviceId(), vnodeCache->InodeId(),
+		offset, size);
+}
+
+
+extern "C" bool
+cache_tracks_node_accesses(void)
+{
+	cache_module_info* module = sCacheModule;
+	return module != NULL && module->node_accessed != NULL;
+}
+
+
 extern "C" status_t
 file_cache_init_post_boot_device(void)
 {
@@ -1150,6 +1418,9 @@ file_cache_create(dev_t mountID, ino_t vnodeID, off_t size)
 	memset(ref->last_access, 0, sizeof(ref->last_access));
 	ref->last_access_index = 0;
 	ref->disabled_count = 0;
+	ref->advice = POSIX_FADV_NORMAL;
+	memset(ref->streams, 0, sizeof(ref->streams));
+	ref->stream_clock = 0;
 
 	// TODO: delay VMCache creation until data is
 	//	requested/written for the first time? Listing lots of
@@ -1327,6 +1598,9 @@ file_cache_read(void* _cacheRef, void* cookie, off_t offset, void* buffer,
 		return error;
 	}
 
+	cache_node_accessed(ref->cache, offset, *_size);
+	read_ahead(ref, offset, *_size);
+
 	return cache_io(ref, cookie, offset, (addr_t)buffer, _size, false);
 }
 
@@ -147,7 +147,7 @@ IOCache::MediaChanged()
 	AutoLocker<VMCache> cacheLocker(fCache);
 
 	// new media -- burn all cached data
-	while (vm_page* page = fCache->pages.Root()) {
+	while (vm_page* page = fCache->pages.FindMin()) {
 		DEBUG_PAGE_ACCESS_START(page);
 		fCache->RemovePage(page);
 		vm_page_free(NULL, page);
@@ -336,6 +336,17 @@ IOCache::_TransferRequestLine(IORequest* request, off_t lineOffset,
 				requestOffset, requestLength);
 		}
 
+		VMCachePagesTreePreload preload;
+		if (preload.TryPreload(VMCachePagesTreePreload::NodesNeeded(
+				lastMissing - firstMissing + 1)) != B_OK) {
+			vm_page_unreserve_pages(&reservation);
+			_DiscardPages(firstMissing - firstPageOffset, missingPages);
+
+			// fall back to uncached transfer
+			return _TransferRequestLineUncached(request, lineOffset,
+				requestOffset, requestLength);
+		}
+
 		// Allocate the missing pages and remove the already existing pages in
 		// the range from the cache. We're going to read/write the whole range
 		// anyway and this way we can sort it, possibly improving the physical
@@ -1731,6 +1731,29 @@ symbol_found:
 }
 
 
+/*!	Like elf_debug_lookup_symbol_address(), but may be called outside of the
+	kernel debugger. The symbol name is copied into \a symbolName.
+	Returns \c B_ENTRY_NOT_FOUND, if no symbol for the address was found.
+*/
+status_t
+elf_lookup_kernel_symbol_address(addr_t address, addr_t* _baseAddress,
+	char* symbolName, size_t symbolNameSize)
+{
+	MutexLocker _(sImageMutex);
+
+	const char* symbol;
+	status_t status = elf_debug_lookup_symbol_address(address, _baseAddress,
+		&symbol, NULL, NULL);
+	if (status != B_OK)
+		return status;
+	if (symbol == NULL)
+		return B_ENTRY_NOT_FOUND;
+
+	strlcpy(symbolName, symbol, symbolNameSize);
+	return B_OK;
+}
+
+
 /*!	Tries to find a matching user symbol for the given address.
 	Note that the given team's address space must already be in effect.
 */
@@ -1,11 +1,13 @@
 /*
  * Copyright 2015, Hamish Morrison, hamishm53@gmail.com.
- * Copyright 2023, Haiku, Inc. All rights reserved.
+ * Copyright 2023-2026, Haiku, Inc. All rights reserved.
  * Distributed under the terms of the MIT License.
  */
 
 #include <event_queue.h>
 
+#include <string.h>
+
 #include <OS.h>
 
 #include <AutoDeleter.h>
@@ -15,10 +17,13 @@
 #include <sem.h>
 #include <syscalls.h>
 #include <syscall_restart.h>
+#include <team.h>
 #include <thread.h>
+#include <util/atomic.h>
 #include <util/AutoLock.h>
 #include <util/AVLTree.h>
 #include <util/DoublyLinkedList.h>
+#include <vm/vm.h>
 #include <AutoDeleterDrivers.h>
 #include <StackOrHeapArray.h>
 #include <wait_for_objects.h>
@@ -43,12 +48,20 @@ enum {
 
 
 
+#define EVENT_QUEUE_WAIT_FLAGS \
+	(B_EVENT_QUEUE_WAIT_EXCLUSIVE | B_EVENT_QUEUE_WAIT_RING)
+
+
 struct select_event : select_info, AVLTreeNode,
 		DoublyLinkedListLinkImpl<select_event> {
 	int32				object;
 	uint16				type;
 	uint32				behavior;
 	void*				user_data;
+	select_event*		ready_next;
+		// link in the queue's ready stack
+	bool				in_tree;
+		// guarded by the queue lock
 };
 
 
@@ -106,11 +119,24 @@ public:
 	ssize_t				Wait(event_wait_info* infos, int numInfos,
 							int32 flags, bigtime_t timeout);
 
+	area_id				SetUpRing(team_id team, uint32 entries,
+							void** _address);
+
 private:
 	void				_Notify(select_event* event, uint16 events);
 	status_t			_DeselectEvent(select_event* event);
+	status_t			_Rearm(select_event* event);
+
+	void				_PushReady(select_event* event);
+	void				_CollectReady();
+	bool				_HasReadyEvents() const;
+	void				_WakeUpWaiters();
 
-	ssize_t				_DequeueEvents(event_wait_info* infos, int numInfos);
+	status_t			_WaitForEvents(MutexLocker& locker, bool exclusive,
+							uint32 flags, bigtime_t timeout);
+	ssize_t				_DequeueEvents(event_wait_info* infos, uint32 start,
+							uint32 mask, int numInfos);
+	ssize_t				_DequeueToRing();
 
 	select_event*		_GetEvent(int32 object, uint16 type);
 
@@ -131,6 +157,13 @@ private:
 	EventList			fEventList;
 	EventTree			fEventTree;
 
+	/*
+	 * Events that became ready are pushed here by Notify() without taking
+	 * the queue lock, and are moved to fEventList by _CollectReady().
+	 * An event has B_EVENT_QUEUED set as long as it is in either of them.
+	 */
+	select_event*		fReadyStack;
+
 	/*
 	 * Protects the queue. We cannot call select or deselect while holding
 	 * this, because it will invert the locking order with EventQueue::Notify.
@@ -138,15 +171,29 @@ private:
 	mutex				fQueueLock;
 
 	/*
-	 * Notified when events are available on the queue.
+	 * Notified when events are available on the queue. Exclusive waiters
+	 * wait on their own condition, and are woken one at a time.
 	 */
 	ConditionVariable	fQueueCondition;
+	ConditionVariable	fExclusiveCondition;
+	int32				fWaiters;
+	int32				fExclusiveWaiters;
 
 	/*
 	 * Used to wait on a changing select_event while the queue lock is dropped
 	 * during a call to select/deselect.
 	 */
 	ConditionVariable	fEventCondition;
+
+	/*
+	 * The optional ring events are returned in, shared with fRingTeam.
+	 */
+	area_id				fRingArea;
+	area_id				fRingUserArea;
+	team_id				fRingTeam;
+	event_queue_ring*	fRing;
+	event_wait_info*	fRingEntries;
+	uint32				fRingTail;
 };
 
 
@@ -154,10 +201,20 @@ EventQueue::EventQueue(bool kernel)
 	:
 	fKernel(kernel),
 	fClosing(false),
-	fDequeueing(false)
+	fDequeueing(false),
+	fReadyStack(NULL),
+	fWaiters(0),
+	fExclusiveWaiters(0),
+	fRingArea(-1),
+	fRingUserArea(-1),
+	fRingTeam(-1),
+	fRing(NULL),
+	fRingEntries(NULL),
+	fRingTail(0)
 {
 	mutex_init(&fQueueLock, "event_queue lock");
 	fQueueCondition.Init(this, "evtq wait");
+	fExclusiveCondition.Init(this, "evtq exclusive wait");
 	fEventCondition.Init(this, "event_queue event change wait");
 }
 
@@ -170,18 +227,21 @@ EventQueue::~EventQueue()
 	EventTree::Iterator iter = fEventTree.GetIterator();
 	while (iter.HasNext()) {
 		select_event* event = iter.Next();
-		event->events |= B_EVENT_DELETING;
+		atomic_or(&event->events, B_EVENT_DELETING);
 
 		mutex_unlock(&fQueueLock);
 		_DeselectEvent(event);
 		mutex_lock(&fQueueLock);
 
 		iter.Remove();
+		_CollectReady();
 		if ((event->events & B_EVENT_QUEUED) != 0)
 			fEventList.Remove(event);
 		delete event;
 	}
 
+	_CollectReady();
+
 	EventList::Iterator listIter = fEventList.GetIterator();
 	while (listIter.HasNext()) {
 		select_event* event = listIter.Next();
@@ -191,6 +251,11 @@ EventQueue::~EventQueue()
 		delete event;
 	}
 
+	if (fRingUserArea >= 0)
+		vm_delete_area(fRingTeam, fRingUserArea, true);
+	if (fRingArea >= 0)
+		delete_area(fRingArea);
+
 	mutex_destroy(&fQueueLock);
 }
 
@@ -205,6 +270,7 @@ EventQueue::Closed()
 
 	// Wake up all waiters
 	fQueueCondition.NotifyAll(B_FILE_ERROR);
+	fExclusiveCondition.NotifyAll(B_FILE_ERROR);
 }
 
 
@@ -244,10 +310,12 @@ EventQueue::Select(int32 object, uint16 type, uint32 events, void* userData)
 	event->behavior = EVENT_BEHAVIOR(events);
 	event->user_data = userData;
 	event->events = 0;
+	event->ready_next = NULL;
 
 	status_t result = fEventTree.Insert(event);
 	if (result != B_OK)
 		return result;
+	event->in_tree = true;
 
 	// We drop the lock before calling select() to avoid inverting the
 	// locking order with Notify(). Setting the B_EVENT_SELECTING flag prevents
@@ -260,7 +328,11 @@ EventQueue::Select(int32 object, uint16 type, uint32 events, void* userData)
 	status_t status = select_object(event->type, event->object, event, fKernel);
 	if (status < 0) {
 		locker.Lock();
-		fEventTree.Remove(event);
+		if (event->in_tree)
+			fEventTree.Remove(event);
+		_CollectReady();
+		if ((event->events & B_EVENT_QUEUED) != 0)
+			fEventList.Remove(event);
 		fEventCondition.NotifyAll();
 		return status;
 	}
@@ -306,8 +378,11 @@ EventQueue::Deselect(int32 object, uint16 type)
 	_DeselectEvent(event);
 	locker.Lock();
 
-	if ((event->events & B_EVENT_INVALID) == 0)
+	// Now that the object doesn't know about the event anymore, everything
+	// it might have pushed is on the ready stack.
+	if (event->in_tree)
 		fEventTree.Remove(event);
+	_CollectReady();
 	if ((event->events & B_EVENT_QUEUED) != 0)
 		fEventList.Remove(event);
 
@@ -335,44 +410,170 @@ EventQueue::Notify(select_info* info, uint16 events)
 }
 
 
+/*!	Re-selects a level-triggered \a event after it has been dequeued, so that
+	it is queued again if its condition still holds. Unlike a Deselect() and
+	Select() pair, this keeps the event in the tree, and doesn't allocate.
+	The queue lock must be held, and is dropped meanwhile. If the object is
+	gone, the event is deleted and an error is returned.
+*/
+status_t
+EventQueue::_Rearm(select_event* event)
+{
+	atomic_or(&event->events, B_EVENT_SELECTING);
+	mutex_unlock(&fQueueLock);
+
+	_DeselectEvent(event);
+	status_t status = select_object(event->type, event->object, event,
+		fKernel);
+
+	mutex_lock(&fQueueLock);
+
+	if (status < 0) {
+		if (event->in_tree)
+			fEventTree.Remove(event);
+		_CollectReady();
+		if ((event->events & B_EVENT_QUEUED) != 0)
+			fEventList.Remove(event);
+		delete event;
+	} else
+		atomic_and(&event->events, ~B_EVENT_SELECTING);
+
+	fEventCondition.NotifyAll();
+	return status < 0 ? status : B_OK;
+}
+
+
+/*!	Called by the selected objects, possibly with their locks held; doesn't
+	take the queue lock.
+*/
 void
 EventQueue::_Notify(select_event* event, uint16 events)
 {
 	if ((events & event->selected_events) == 0)
 		return;
 
-	const int32 previousEvents = atomic_or(&event->events, (events & ~B_EVENT_INVALID));
+	// Add the events and mark the event queued in one go, unless it is
+	// being deleted. B_EVENT_INVALID is handled when it is dequeued: it
+	// removes the event from the tree then, or earlier in _GetEvent(), if
+	// the object ID is reused in the meantime.
+	int32 previousEvents = atomic_get(&event->events);
+	while (true) {
+		if ((previousEvents & B_EVENT_DELETING) != 0)
+			return;
 
-	// If the event is already being deleted, we should ignore this notification.
-	if ((previousEvents & B_EVENT_DELETING) != 0)
+		const int32 newEvents = previousEvents | events | B_EVENT_QUEUED;
+		const int32 oldEvents = atomic_test_and_set(&event->events, newEvents,
+			previousEvents);
+		if (oldEvents == previousEvents)
+			break;
+		previousEvents = oldEvents;
+	}
+
+	// If the event is already queued, the new events will be picked up with
+	// it. Otherwise it's our responsibility to queue it.
+	if ((previousEvents & B_EVENT_QUEUED) != 0)
 		return;
 
-	// If the event is already queued, and it is not becoming invalid,
-	// we don't need to do anything more.
-	if ((previousEvents & B_EVENT_QUEUED) != 0 && (events & B_EVENT_INVALID) == 0)
+	_PushReady(event);
+	_WakeUpWaiters();
+}
+
+
+void
+EventQueue::_PushReady(select_event* event)
+{
+	select_event* head = atomic_pointer_get(&fReadyStack);
+	while (true) {
+		event->ready_next = head;
+		select_event* previous = atomic_pointer_test_and_set(&fReadyStack,
+			event, head);
+		if (previous == head)
+			break;
+		head = previous;
+	}
+}
+
+
+/*!	Moves the events on the ready stack to the event list, in the order they
+	were pushed. Must be called with the queue lock held.
+*/
+void
+EventQueue::_CollectReady()
+{
+	select_event* event = atomic_pointer_get_and_set(&fReadyStack,
+		(select_event*)NULL);
+	if (event == NULL)
 		return;
 
-	{
-		MutexLocker _(&fQueueLock);
+	select_event* reversed = NULL;
+	while (event != NULL) {
+		select_event* next = event->ready_next;
+		event->ready_next = reversed;
+		reversed = event;
+		event = next;
+	}
 
-		// We need to recheck B_EVENT_DELETING now we have the lock.
-		if ((event->events & B_EVENT_DELETING) != 0)
-			return;
+	while (reversed != NULL) {
+		select_event* next = reversed->ready_next;
+		reversed->ready_next = NULL;
+		fEventList.Add(reversed);
+		reversed = next;
+	}
+}
 
-		// If we get B_EVENT_INVALID it means the object we were monitoring was
-		// deleted. The object's ID may now be reused, so we must remove it
-		// from the event tree.
-		if ((events & B_EVENT_INVALID) != 0) {
-			atomic_or(&event->events, B_EVENT_INVALID);
-			fEventTree.Remove(event);
+
+bool
+EventQueue::_HasReadyEvents() const
+{
+	return !fEventList.IsEmpty() || atomic_pointer_get(&fReadyStack) != NULL;
+}
+
+
+void
+EventQueue::_WakeUpWaiters()
+{
+	if (atomic_get(&fWaiters) > 0)
+		fQueueCondition.NotifyAll();
+	if (atomic_get(&fExclusiveWaiters) > 0)
+		fExclusiveCondition.NotifyOne();
+}
+
+
+/*!	Waits until events are ready and nobody else is dequeuing. Since Notify()
+	doesn't take the queue lock, the waiter is registered before the last
+	check, so that no wake-up can get lost.
+*/
+status_t
+EventQueue::_WaitForEvents(MutexLocker& locker, bool exclusive, uint32 flags,
+	bigtime_t timeout)
+{
+	ConditionVariable& condition
+		= exclusive ? fExclusiveCondition : fQueueCondition;
+	int32& waiters = exclusive ? fExclusiveWaiters : fWaiters;
+
+	while (!fClosing && (fDequeueing || !_HasReadyEvents())) {
+		ConditionVariableEntry entry;
+		atomic_add(&waiters, 1);
+		condition.Add(&entry);
+
+		status_t status = B_OK;
+		if (!fClosing && (fDequeueing || !_HasReadyEvents())) {
+			locker.Unlock();
+			status = entry.Wait(flags | B_CAN_INTERRUPT, timeout);
+			locker.Lock();
 		}
 
-		// If it's not already queued, it's our responsibility to queue it.
-		if ((atomic_or(&event->events, B_EVENT_QUEUED) & B_EVENT_QUEUED) == 0) {
-			fEventList.Add(event);
-			fQueueCondition.NotifyAll();
+		atomic_add(&waiters, -1);
+
+		if (status != B_OK) {
+			// don't swallow a wake-up meant for another exclusive waiter
+			if (exclusive && !fDequeueing && _HasReadyEvents())
+				fExclusiveCondition.NotifyOne();
+			return status;
 		}
 	}
+
+	return fClosing ? B_FILE_ERROR : B_OK;
 }
 
 
@@ -383,27 +584,36 @@ EventQueue::Wait(event_wait_info* infos, int numInfos,
 	ASSERT((flags & B_ABSOLUTE_TIMEOUT) != 0
 		|| (timeout == B_INFINITE_TIMEOUT || timeout == 0));
 
+	const bool exclusive = (flags & B_EVENT_QUEUE_WAIT_EXCLUSIVE) != 0;
+	const bool useRing = (flags & B_EVENT_QUEUE_WAIT_RING) != 0;
+	flags &= ~EVENT_QUEUE_WAIT_FLAGS;
+
 	MutexLocker queueLocker(&fQueueLock);
 
+	if (useRing && (fRing == NULL || fRingTeam != team_get_current_team_id()))
+		return B_BAD_VALUE;
+
 	ssize_t count = 0;
 	while (timeout == 0 || (system_time() < timeout)) {
-		while ((fDequeueing || fEventList.IsEmpty()) && !fClosing) {
-			status_t status = fQueueCondition.Wait(queueLocker.Get(),
-				flags | B_CAN_INTERRUPT, timeout);
-			if (status != B_OK)
-				return status;
-		}
-
-		if (fClosing)
-			return B_FILE_ERROR;
+		status_t status = _WaitForEvents(queueLocker, exclusive, flags,
+			timeout);
+		if (status != B_OK)
+			return status;
 
-		if (numInfos == 0)
+		if (numInfos == 0 && !useRing)
 			return B_OK;
 
 		fDequeueing = true;
-		count = _DequeueEvents(infos, numInfos);
+		if (useRing)
+			count = _DequeueToRing();
+		else
+			count = _DequeueEvents(infos, 0, ~(uint32)0, numInfos);
 		fDequeueing = false;
 
+		// Others might have been waiting for us, or for what we left.
+		if (_HasReadyEvents())
+			_WakeUpWaiters();
+
 		if (count != 0)
 			break;
 
@@ -415,8 +625,13 @@ EventQueue::Wait(event_wait_info* infos, int numInfos,
 }
 
 
+/*!	Dequeues up to \a numInfos events into \a infos, starting at \a start,
+	with the index wrapped by \a mask (which lets the ring be filled in one
+	go). Must be called with the queue lock held and fDequeueing set.
+*/
 ssize_t
-EventQueue::_DequeueEvents(event_wait_info* infos, int numInfos)
+EventQueue::_DequeueEvents(event_wait_info* infos, uint32 start, uint32 mask,
+	int numInfos)
 {
 	ssize_t count = 0;
 
@@ -424,16 +639,19 @@ EventQueue::_DequeueEvents(event_wait_info* infos, int numInfos)
 	select_event* deselect[kMaxToDeselect];
 	int32 deselectCount = 0;
 
+	_CollectReady();
+
 	// Add a marker element, so we don't loop forever after unlocking the list.
 	// (There is only one invocation of _DequeueEvents() at a time.)
 	select_event marker = {};
 	fEventList.Add(&marker);
 
-	for (select_event* event = NULL; count < numInfos; ) {
-		if (fEventList.Head() == NULL || fEventList.Head() == &marker)
+	while (count < numInfos) {
+		select_event* event = fEventList.Head();
+		if (event == NULL || event == &marker)
 			break;
 
-		event = fEventList.RemoveHead();
+		fEventList.Remove(event);
 		int32 events = atomic_and(&event->events,
 			~(event->selected_events | B_EVENT_QUEUED));
 
@@ -442,53 +660,39 @@ EventQueue::_DequeueEvents(event_wait_info* infos, int numInfos)
 
 		if ((events & B_EVENT_INVALID) == 0
 				&& (event->behavior & B_EVENT_LEVEL_TRIGGERED) != 0) {
-			// This event is level-triggered. We need to deselect and reselect it,
-			// as its state may have changed since we were notified.
-			const select_event tmp = *event;
-
-			mutex_unlock(&fQueueLock);
-			status_t status = Deselect(tmp.object, tmp.type);
-			if (status == B_OK) {
-				event = NULL;
-				status = Select(tmp.object, tmp.type,
-					tmp.selected_events | tmp.behavior, tmp.user_data);
-			}
-			mutex_lock(&fQueueLock);
-
-			if (status == B_OK) {
-				// Is the event still queued?
-				event = _GetEvent(tmp.object, tmp.type);
-				if (event == NULL)
-					continue;
-				events = atomic_get(&event->events);
-				if ((events & B_EVENT_QUEUED) == 0)
-					continue;
-			} else if (event == NULL) {
+			// This event is level-triggered. We need to re-select it, as its
+			// state may have changed since we were notified.
+			if (_Rearm(event) != B_OK)
+				continue;
+
+			// Is the event still queued?
+			events = atomic_get(&event->events);
+			if ((events & B_EVENT_QUEUED) == 0)
 				continue;
-			}
 		}
 
-		infos[count].object = event->object;
-		infos[count].type = event->type;
-		infos[count].user_data = event->user_data;
-		infos[count].events = USER_EVENTS(events);
+		event_wait_info& info = infos[(start + count) & mask];
+		info.object = event->object;
+		info.type = event->type;
+		info.user_data = event->user_data;
+		info.events = USER_EVENTS(events);
 		count++;
 
 		// All logic past this point has to do with deleting events.
 		if ((events & B_EVENT_INVALID) == 0 && (event->behavior & B_EVENT_ONE_SHOT) == 0)
 			continue;
 
-		// Check if the event was requeued.
-		if ((atomic_and(&event->events, ~B_EVENT_QUEUED) & B_EVENT_QUEUED) != 0)
-			fEventList.Remove(event);
-
 		if ((events & B_EVENT_INVALID) != 0) {
-			// The event will already have been removed from the tree.
+			// The object is gone and won't notify anymore, so the event
+			// cannot have been queued again.
+			if (event->in_tree)
+				fEventTree.Remove(event);
 			delete event;
 		} else if ((event->behavior & B_EVENT_ONE_SHOT) != 0) {
-			// We already checked B_EVENT_INVALID above, so we don't need to again.
-			fEventTree.Remove(event);
-			event->events = B_EVENT_DELETING;
+			if (event->in_tree)
+				fEventTree.Remove(event);
+			event->in_tree = false;
+			atomic_or(&event->events, B_EVENT_DELETING);
 
 			deselect[deselectCount++] = event;
 			if (deselectCount == kMaxToDeselect)
@@ -500,22 +704,103 @@ EventQueue::_DequeueEvents(event_wait_info* infos, int numInfos)
 
 	if (deselectCount != 0) {
 		mutex_unlock(&fQueueLock);
+		for (int32 i = 0; i < deselectCount; i++)
+			_DeselectEvent(deselect[i]);
+		mutex_lock(&fQueueLock);
+
+		// The events might have been queued again before they were marked
+		// deleting. We removed them from anywhere else they could be found
+		// before dropping the lock, so we don't need to notify waiters.
+		_CollectReady();
 		for (int32 i = 0; i < deselectCount; i++) {
 			select_event* event = deselect[i];
-
-			_DeselectEvent(event);
+			if ((event->events & B_EVENT_QUEUED) != 0)
+				fEventList.Remove(event);
 			delete event;
 		}
-		mutex_lock(&fQueueLock);
+	}
+
+	return count;
+}
+
+
+/*!	Dequeues as many events as there is room for in the ring. */
+ssize_t
+EventQueue::_DequeueToRing()
+{
+	const uint32 head = atomic_get((int32*)&fRing->head);
+	const uint32 used = fRingTail - head;
+	if (used > fRing->entries) {
+		// userland has messed up the ring
+		return B_BAD_DATA;
+	}
 
-		// We don't need to notify waiters, as we removed the events
-		// from anywhere they could be found before dropping the lock.
+	const uint32 space = fRing->entries - used;
+	if (space == 0)
+		return B_BUSY;
+
+	ssize_t count = _DequeueEvents(fRingEntries, fRingTail, fRing->mask,
+		space);
+	if (count > 0) {
+		fRingTail += count;
+		atomic_set((int32*)&fRing->tail, fRingTail);
 	}
 
 	return count;
 }
 
 
+/*!	Creates the ring that events are returned in with
+	B_EVENT_QUEUE_WAIT_RING, and maps it into \a team.
+*/
+area_id
+EventQueue::SetUpRing(team_id team, uint32 entries, void** _address)
+{
+	if (entries == 0 || entries > EVENT_QUEUE_MAX_RING_ENTRIES)
+		return B_BAD_VALUE;
+
+	uint32 size = 1;
+	while (size < entries)
+		size <<= 1;
+
+	MutexLocker locker(&fQueueLock);
+	if (fRing != NULL)
+		return B_BUSY;
+
+	const size_t areaSize = PAGE_ALIGN(sizeof(event_queue_ring)
+		+ size * sizeof(event_wait_info));
+
+	uint8* address;
+	area_id area = create_area("event queue ring", (void**)&address,
+		B_ANY_KERNEL_ADDRESS, areaSize, B_FULL_LOCK,
+		B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA);
+	if (area < 0)
+		return area;
+
+	void* userAddress = NULL;
+	area_id userArea = vm_clone_area(team, "event queue ring", &userAddress,
+		B_ANY_ADDRESS, B_READ_AREA | B_WRITE_AREA, REGION_NO_PRIVATE_MAP,
+		area, true);
+	if (userArea < 0) {
+		delete_area(area);
+		return userArea;
+	}
+
+	memset(address, 0, areaSize);
+	fRing = (event_queue_ring*)address;
+	fRing->mask = size - 1;
+	fRing->entries = size;
+	fRingEntries = (event_wait_info*)(address + sizeof(event_queue_ring));
+	fRingArea = area;
+	fRingUserArea = userArea;
+	fRingTeam = team;
+	fRingTail = 0;
+
+	*_address = userAddress;
+	return userArea;
+}
+
+
 /*
  * Get the select_event for the given object and type. Must be called with the
  * queue lock held. This method will sleep if the event is undergoing selection
@@ -531,7 +816,16 @@ EventQueue::_GetEvent(int32 object, uint16 type)
 		if (event == NULL)
 			return NULL;
 
-		if ((event->events & (B_EVENT_SELECTING | B_EVENT_DELETING)) == 0)
+		const int32 events = atomic_get(&event->events);
+		if ((events & B_EVENT_INVALID) != 0) {
+			// The object is gone, and its ID may have been reused already.
+			// The event is still queued, and will be deleted when dequeued.
+			fEventTree.Remove(event);
+			event->in_tree = false;
+			return NULL;
+		}
+
+		if ((events & (B_EVENT_SELECTING | B_EVENT_DELETING)) == 0)
 			return event;
 
 		fEventCondition.Wait(&fQueueLock);
@@ -707,9 +1001,35 @@ _user_event_queue_wait(int queue, event_wait_info* userInfos, int numInfos,
 	if (result < 0)
 		return syscall_restart_handle_timeout_post(result, timeout);
 
+	// only copy back what we actually got
 	status_t status = B_OK;
-	if (numInfos != 0)
-		status = user_memcpy(userInfos, infos, sizeof(event_wait_info) * numInfos);
+	if (result > 0 && (flags & B_EVENT_QUEUE_WAIT_RING) == 0)
+		status = user_memcpy(userInfos, infos, sizeof(event_wait_info) * result);
 
 	return status == B_OK ? result : status;
 }
+
+
+area_id
+_user_event_queue_setup_ring(int queue, uint32 entries, void** _userAddress)
+{
+	if (_userAddress == NULL || !IS_USER_ADDRESS(_userAddress))
+		return B_BAD_ADDRESS;
+
+	file_descriptor* descriptor;
+	GET_QUEUE_FD_OR_RETURN(queue, false, descriptor);
+	FileDescriptorPutter _(descriptor);
+
+	EventQueue* eventQueue = (EventQueue*)descriptor->cookie;
+
+	void* address;
+	area_id area = eventQueue->SetUpRing(team_get_current_team_id(), entries,
+		&address);
+	if (area < 0)
+		return area;
+
+	if (user_memcpy(_userAddress, &address, sizeof(void*)) != B_OK)
+		return B_BAD_ADDRESS;
+
+	return area;
+}
@@ -7,6 +7,8 @@
 #include "EntryCache.h"
 
 #include <new>
+#include <stddef.h>
+
 #include <vm/vm.h>
 #include <slab/Slab.h>
 
@@ -62,7 +64,8 @@ EntryCache::EntryCache()
 
 EntryCache::~EntryCache()
 {
-	// delete entries
+	// delete entries -- the mount is gone, so there can't be any unlocked
+	// readers anymore
 	EntryCacheEntry* entry = fEntries.Clear(true);
 	while (entry != NULL) {
 		EntryCacheEntry* next = entry->hash_link;
@@ -115,15 +118,20 @@ EntryCache::Add(ino_t dirID, const char* name, ino_t nodeID, bool missing)
 
 	EntryCacheEntry* entry = fEntries.Lookup(key);
 	if (entry != NULL) {
-		entry->node_id = nodeID;
-		entry->missing = missing;
-		if (entry->generation != fCurrentGeneration) {
-			if (entry->index >= 0) {
-				fGenerations[entry->generation].entries[entry->index] = NULL;
-				_AddEntryToCurrentGeneration(entry);
+		if (entry->node_id == nodeID && entry->missing == missing) {
+			if (entry->generation != fCurrentGeneration) {
+				if (entry->index >= 0) {
+					fGenerations[entry->generation].entries[entry->index]
+						= NULL;
+					_AddEntryToCurrentGeneration(entry);
+				}
 			}
+			return B_OK;
 		}
-		return B_OK;
+
+		// Unlocked readers might be looking at the entry, so we replace it
+		// instead of changing it.
+		_RemoveEntry(entry);
 	}
 
 	// Avoid deadlock if system had to wait for free memory
@@ -161,19 +169,7 @@ EntryCache::Remove(ino_t dirID, const char* name)
 	if (entry == NULL)
 		return B_ENTRY_NOT_FOUND;
 
-	fEntries.Remove(entry);
-
-	if (entry->index >= 0) {
-		// remove the entry from its generation and delete it
-		fGenerations[entry->generation].entries[entry->index] = NULL;
-		free(entry);
-	} else {
-		// We can't free it, since another thread is about to try to move it
-		// to another generation. We mark it removed and the other thread will
-		// take care of deleting it.
-		entry->index = kEntryRemoved;
-	}
-
+	_RemoveEntry(entry);
 	return B_OK;
 }
 
@@ -221,7 +217,7 @@ EntryCache::Lookup(ino_t dirID, const char* name, ino_t& _nodeID,
 
 	if (entry->index == kEntryRemoved) {
 		// the entry has been removed in the meantime
-		free(entry);
+		_FreeEntry(entry);
 		return false;
 	}
 
@@ -233,6 +229,28 @@ EntryCache::Lookup(ino_t dirID, const char* name, ino_t& _nodeID,
 }
 
 
+/*!	Looks up an entry without locking. The caller must be in an RCU read
+	section. Negative entries and entries that have to be moved to the
+	current generation are not returned, the caller has to fall back to
+	Lookup() for them.
+*/
+bool
+EntryCache::LookupUnlocked(ino_t dirID, const char* name, ino_t& _nodeID)
+{
+	EntryCacheKey key(dirID, name);
+
+	EntryCacheEntry* entry = fEntries.LookupUnlocked(key);
+	if (entry == NULL || entry->missing)
+		return false;
+
+	if (atomic_get(&entry->generation) != atomic_get(&fCurrentGeneration))
+		return false;
+
+	_nodeID = entry->node_id;
+	return true;
+}
+
+
 const char*
 EntryCache::DebugReverseLookup(ino_t nodeID, ino_t& _dirID)
 {
@@ -272,7 +290,7 @@ EntryCache::_AddEntryToCurrentGeneration(EntryCacheEntry* entry)
 
 		fGenerations[newGeneration].entries[i] = NULL;
 		fEntries.Remove(otherEntry);
-		free(otherEntry);
+		_FreeEntry(otherEntry);
 	}
 
 	// set the new generation and add the entry
@@ -282,3 +300,37 @@ EntryCache::_AddEntryToCurrentGeneration(EntryCacheEntry* entry)
 	entry->generation = newGeneration;
 	entry->index = 0;
 }
+
+
+void
+EntryCache::_RemoveEntry(EntryCacheEntry* entry)
+{
+	ASSERT_WRITE_LOCKED_RW_LOCK(&fLock);
+
+	fEntries.Remove(entry);
+
+	if (entry->index >= 0) {
+		// remove the entry from its generation and delete it
+		fGenerations[entry->generation].entries[entry->index] = NULL;
+		_FreeEntry(entry);
+	} else {
+		// We can't free it, since another thread is about to try to move it
+		// to another generation. We mark it removed and the other thread will
+		// take care of deleting it.
+		entry->index = kEntryRemoved;
+	}
+}
+
+
+/*static*/ void
+EntryCache::_FreeEntry(EntryCacheEntry* entry)
+{
+	rcu_call(&entry->rcu_link, &_FreeEntryCallback);
+}
+
+
+/*static*/ void
+EntryCache::_FreeEntryCallback(rcu_head* head)
+{
+	free((uint8*)head - offsetof(EntryCacheEntry, rcu_link));
+}
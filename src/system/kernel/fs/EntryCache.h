@@ -8,6 +8,7 @@
 
 #include <stdlib.h>
 
+#include <rcu.h>
 #include <util/AutoLock.h>
 #include <util/DoublyLinkedList.h>
 #include <util/OpenHashTable.h>
@@ -36,8 +37,12 @@ struct EntryCacheKey {
 };
 
 
+// Entries are immutable except for their generation and index, so that they
+// can be read without holding the cache's lock (cf. LookupUnlocked()). They
+// are freed only after an RCU grace period.
 struct EntryCacheEntry {
 	EntryCacheEntry*	hash_link;
+	rcu_head			rcu_link;
 	ino_t				node_id;
 	ino_t				dir_id;
 	uint32				hash;
@@ -103,16 +108,23 @@ public:
 
 			bool				Lookup(ino_t dirID, const char* name,
 									ino_t& nodeID, bool& missing);
+			bool				LookupUnlocked(ino_t dirID,
+									const char* name, ino_t& nodeID);
 
 			const char*			DebugReverseLookup(ino_t nodeID, ino_t& _dirID);
 
 private:
-			typedef BOpenHashTable<EntryCacheHashDefinition> EntryTable;
+			typedef BOpenHashTable<EntryCacheHashDefinition, true, false,
+				RCUMallocAllocator> EntryTable;
 			typedef DoublyLinkedList<EntryCacheEntry> EntryList;
 
 private:
 			void				_AddEntryToCurrentGeneration(
 									EntryCacheEntry* entry);
+			void				_RemoveEntry(EntryCacheEntry* entry);
+
+	static	void				_FreeEntry(EntryCacheEntry* entry);
+	static	void				_FreeEntryCallback(rcu_head* head);
 
 private:
 			rw_lock				fLock;
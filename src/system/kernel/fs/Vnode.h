@@ -12,6 +12,7 @@
 #include <util/list.h>
 
 #include <lock.h>
+#include <rcu.h>
 #include <thread.h>
 
 
@@ -32,6 +33,7 @@ struct vnode : fs_vnode, DoublyLinkedListLinkImpl<vnode> {
 			struct advisory_locking* advisory_locking;
 			struct file_descriptor* mandatory_locked_by;
 			DoublyLinkedListLink<struct vnode> unused_link;
+			rcu_head			rcu_link;
 			ino_t				id;
 			dev_t				device;
 			int32				ref_count;
@@ -60,6 +62,13 @@ public:
 	inline	bool				IsCovering() const;
 	inline	void				SetCovering(bool covering);
 
+	// Whether everyone may search the (directory) vnode, as last checked.
+	// setters require sSearchPermissionLock (vfs.cpp), getters are lockless
+	inline	bool				IsSearchChecked() const;
+	inline	bool				IsSearchable() const;
+	inline	void				SetSearchable(bool searchable);
+	inline	void				ResetSearchable();
+
 	inline	uint32				Type() const;
 	inline	void				SetType(uint32 type);
 
@@ -78,6 +87,8 @@ private:
 	static	const uint32		kFlagsHot			= 0x00000040;
 	static	const uint32		kFlagsCovered		= 0x00000080;
 	static	const uint32		kFlagsCovering		= 0x00000100;
+	static	const uint32		kFlagsSearchChecked	= 0x00000200;
+	static	const uint32		kFlagsSearchable	= 0x00000400;
 	static	const uint32		kFlagsType			= 0xfffff000;
 
 	static	const uint32		kBucketCount		= 32;
@@ -228,6 +239,39 @@ vnode::SetCovering(bool covering)
 }
 
 
+bool
+vnode::IsSearchChecked() const
+{
+	return (fFlags & kFlagsSearchChecked) != 0;
+}
+
+
+bool
+vnode::IsSearchable() const
+{
+	return (fFlags & kFlagsSearchable) != 0;
+}
+
+
+void
+vnode::SetSearchable(bool searchable)
+{
+	if (searchable)
+		atomic_or(&fFlags, kFlagsSearchChecked | kFlagsSearchable);
+	else {
+		atomic_and(&fFlags, ~kFlagsSearchable);
+		atomic_or(&fFlags, kFlagsSearchChecked);
+	}
+}
+
+
+void
+vnode::ResetSearchable()
+{
+	atomic_and(&fFlags, ~(kFlagsSearchChecked | kFlagsSearchable));
+}
+
+
 uint32
 vnode::Type() const
 {
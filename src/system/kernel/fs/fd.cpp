@@ -45,6 +45,31 @@ static const size_t kMaxReadDirBufferSize = B_PAGE_SIZE * 2;
 extern object_cache* sFileDescriptorCache;
 
 
+/*!	Marks the I/O of the current thread as non-blocking for its lifetime, if
+	requested; see fd_nonblocking_io().
+*/
+struct NonBlockingIOSetter {
+	NonBlockingIOSetter(bool nonBlocking)
+	{
+		fThread = nonBlocking ? thread_get_current_thread() : NULL;
+		if (fThread != NULL) {
+			fWasSet = (atomic_or(&fThread->flags, THREAD_FLAGS_NONBLOCKING_IO)
+				& THREAD_FLAGS_NONBLOCKING_IO) != 0;
+		}
+	}
+
+	~NonBlockingIOSetter()
+	{
+		if (fThread != NULL && !fWasSet)
+			atomic_and(&fThread->flags, ~THREAD_FLAGS_NONBLOCKING_IO);
+	}
+
+private:
+	Thread*	fThread;
+	bool	fWasSet;
+};
+
+
 static struct file_descriptor* get_fd_locked(const struct io_context* context,
 	int fd);
 static struct file_descriptor* remove_fd(struct io_context* context, int fd);
@@ -674,16 +699,34 @@ fd_is_valid(int fd, bool kernel)
 }
 
 
-static ssize_t
-common_vector_io(int fd, off_t pos, const iovec* vecs, size_t count, bool write, bool kernel)
+/*!	Returns whether I/O on a descriptor with the given \a openMode must not
+	block; that is either if it has been opened with \c O_NONBLOCK, or if the
+	I/O was started via fd_user_io() or fd_vector_io() with \c nonBlocking
+	set. Descriptor types that may block should check this rather than their
+	open mode alone.
+*/
+bool
+fd_nonblocking_io(int openMode)
+{
+	return (openMode & O_NONBLOCK) != 0
+		|| (thread_get_current_thread()->flags
+			& THREAD_FLAGS_NONBLOCKING_IO) != 0;
+}
+
+
+/*!	Reads or writes the given vectors from or to the descriptor. The vectors
+	must have been validated already, if they come from userland.
+	If \a nonBlocking is \c true, the descriptor is asked to fail with
+	\c B_WOULD_BLOCK instead of waiting, as if it had been opened with
+	\c O_NONBLOCK; only pipes and sockets honor that, though.
+*/
+ssize_t
+fd_vector_io(struct file_descriptor* descriptor, off_t pos, const iovec* vecs,
+	size_t count, bool write, bool nonBlocking)
 {
 	if (pos < -1)
 		return B_BAD_VALUE;
 
-	FileDescriptorPutter descriptor(get_fd(get_current_io_context(kernel), fd));
-	if (!descriptor.IsSet())
-		return B_FILE_ERROR;
-
 	if (write ? (descriptor->open_mode & O_RWMASK) == O_RDONLY
 			: (descriptor->open_mode & O_RWMASK) == O_WRONLY) {
 		return B_FILE_ERROR;
@@ -700,14 +743,16 @@ common_vector_io(int fd, off_t pos, const iovec* vecs, size_t count, bool write,
 		return B_BAD_VALUE;
 	}
 
+	NonBlockingIOSetter nonBlockingIOSetter(nonBlocking);
+
 	if (!movePosition && count > 1 && (write ? descriptor->ops->fd_writev != NULL
 			: descriptor->ops->fd_readv != NULL)) {
 		ssize_t result;
 		if (write) {
-			result = descriptor->ops->fd_writev(descriptor.Get(), pos,
+			result = descriptor->ops->fd_writev(descriptor, pos,
 				vecs, count);
 		} else {
-			result = descriptor->ops->fd_readv(descriptor.Get(), pos,
+			result = descriptor->ops->fd_readv(descriptor, pos,
 				vecs, count);
 		}
 		if (result != B_UNSUPPORTED)
@@ -723,10 +768,10 @@ common_vector_io(int fd, off_t pos, const iovec* vecs, size_t count, bool write,
 
 		size_t length = vecs[i].iov_len;
 		if (write) {
-			status = descriptor->ops->fd_write(descriptor.Get(), pos,
+			status = descriptor->ops->fd_write(descriptor, pos,
 				vecs[i].iov_base, &length);
 		} else {
-			status = descriptor->ops->fd_read(descriptor.Get(), pos,
+			status = descriptor->ops->fd_read(descriptor, pos,
 				vecs[i].iov_base, &length);
 		}
 
@@ -750,7 +795,7 @@ common_vector_io(int fd, off_t pos, const iovec* vecs, size_t count, bool write,
 
 	if (movePosition) {
 		descriptor->pos = write && (descriptor->open_mode & O_APPEND) != 0
-			? descriptor->ops->fd_seek(descriptor.Get(), 0, SEEK_END) : pos;
+			? descriptor->ops->fd_seek(descriptor, 0, SEEK_END) : pos;
 	}
 
 	return bytesTransferred;
@@ -758,15 +803,29 @@ common_vector_io(int fd, off_t pos, const iovec* vecs, size_t count, bool write,
 
 
 static ssize_t
-common_user_io(int fd, off_t pos, void* buffer, size_t length, bool write)
+common_vector_io(int fd, off_t pos, const iovec* vecs, size_t count, bool write, bool kernel)
 {
 	if (pos < -1)
 		return B_BAD_VALUE;
 
-	FileDescriptorPutter descriptor(get_fd(get_current_io_context(false), fd));
+	FileDescriptorPutter descriptor(get_fd(get_current_io_context(kernel), fd));
 	if (!descriptor.IsSet())
 		return B_FILE_ERROR;
 
+	return fd_vector_io(descriptor.Get(), pos, vecs, count, write, false);
+}
+
+
+/*!	Reads or writes a userland buffer from or to the descriptor.
+	\a nonBlocking works as for fd_vector_io().
+*/
+ssize_t
+fd_user_io(struct file_descriptor* descriptor, off_t pos, void* buffer,
+	size_t length, bool write, bool nonBlocking)
+{
+	if (pos < -1)
+		return B_BAD_VALUE;
+
 	if (write ? (descriptor->open_mode & O_RWMASK) == O_RDONLY
 			: (descriptor->open_mode & O_RWMASK) == O_WRONLY) {
 		return B_FILE_ERROR;
@@ -789,25 +848,42 @@ common_user_io(int fd, off_t pos, void* buffer, size_t length, bool write)
 	if (!is_user_address_range(buffer, length))
 		return B_BAD_ADDRESS;
 
-	SyscallRestartWrapper<status_t> status;
+	NonBlockingIOSetter nonBlockingIOSetter(nonBlocking);
 
+	status_t status;
 	if (write)
-		status = descriptor->ops->fd_write(descriptor.Get(), pos, buffer, &length);
+		status = descriptor->ops->fd_write(descriptor, pos, buffer, &length);
 	else
-		status = descriptor->ops->fd_read(descriptor.Get(), pos, buffer, &length);
+		status = descriptor->ops->fd_read(descriptor, pos, buffer, &length);
 
 	if (status != B_OK)
 		return status;
 
 	if (movePosition) {
 		descriptor->pos = write && (descriptor->open_mode & O_APPEND) != 0
-			? descriptor->ops->fd_seek(descriptor.Get(), 0, SEEK_END) : pos + length;
+			? descriptor->ops->fd_seek(descriptor, 0, SEEK_END) : pos + length;
 	}
 
 	return length <= SSIZE_MAX ? (ssize_t)length : SSIZE_MAX;
 }
 
 
+static ssize_t
+common_user_io(int fd, off_t pos, void* buffer, size_t length, bool write)
+{
+	if (pos < -1)
+		return B_BAD_VALUE;
+
+	FileDescriptorPutter descriptor(get_fd(get_current_io_context(false), fd));
+	if (!descriptor.IsSet())
+		return B_FILE_ERROR;
+
+	SyscallRestartWrapper<ssize_t> result;
+	return result = fd_user_io(descriptor.Get(), pos, buffer, length, write,
+		false);
+}
+
+
 static ssize_t
 common_user_vector_io(int fd, off_t pos, const iovec* userVecs, size_t count,
 	bool write)
@@ -13,6 +13,7 @@
 #include <string.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 #include <new>
 
@@ -22,6 +23,7 @@
 
 #include <condition_variable.h>
 #include <debug_hex_dump.h>
+#include <fd.h>
 #include <lock.h>
 #include <select_sync_pool.h>
 #include <syscall_restart.h>
@@ -68,6 +70,11 @@ public:
 			ssize_t				Peek(size_t offset, void* buffer,
 									size_t length) const;
 
+			int32				GetReadableVecs(iovec* vecs) const;
+			int32				GetWritableVecs(iovec* vecs) const;
+			void				Flush(size_t length);
+			void				CommitWritten(size_t length);
+
 			size_t				Readable() const;
 			size_t				Writable() const;
 
@@ -175,6 +182,12 @@ public:
 			status_t			ReadDataFromBuffer(void* data, size_t* _length,
 									bool nonBlocking, bool isUser,
 									ReadRequest& request);
+			status_t			SpliceDataToBuffer(size_t* _length,
+									bool nonBlocking, fifo_splice_hook hook,
+									void* hookCookie);
+			status_t			SpliceDataFromBuffer(size_t* _length,
+									bool nonBlocking, ReadRequest& request,
+									fifo_splice_hook hook, void* hookCookie);
 			size_t				BytesAvailable() const
 									{ return fBuffer.Readable(); }
 			size_t				BytesWritable() const
@@ -203,6 +216,11 @@ public:
 	static	int					Dump(int argc, char** argv);
 
 private:
+			status_t			_WaitForWritable(size_t minToWrite,
+									bool nonBlocking);
+			status_t			_WaitForReadable(bool nonBlocking,
+									ReadRequest& request);
+
 			timespec			fCreationTime;
 			timespec			fModificationTime;
 
@@ -333,6 +351,36 @@ RingBuffer::Peek(size_t offset, void* buffer, size_t length) const
 }
 
 
+inline int32
+RingBuffer::GetReadableVecs(iovec* vecs) const
+{
+	return fBuffer != NULL ? ring_buffer_get_vecs(fBuffer, vecs) : 0;
+}
+
+
+inline int32
+RingBuffer::GetWritableVecs(iovec* vecs) const
+{
+	return fBuffer != NULL ? ring_buffer_get_write_vecs(fBuffer, vecs) : 0;
+}
+
+
+inline void
+RingBuffer::Flush(size_t length)
+{
+	if (fBuffer != NULL)
+		ring_buffer_flush(fBuffer, length);
+}
+
+
+inline void
+RingBuffer::CommitWritten(size_t length)
+{
+	if (fBuffer != NULL)
+		ring_buffer_commit_written(fBuffer, length);
+}
+
+
 inline size_t
 RingBuffer::Readable() const
 {
@@ -411,26 +459,9 @@ Inode::WriteDataToBuffer(const void* _data, size_t* _length, bool nonBlocking,
 
 	while (dataSize > 0) {
 		// Wait until enough space in the buffer is available.
-		while (!fActive
-				|| (fBuffer.Writable() < minToWrite && fReaderCount > 0)) {
-			if (nonBlocking)
-				return B_WOULD_BLOCK;
-
-			ConditionVariableEntry entry;
-			entry.Add(this);
-
-			WriteRequest request(thread_get_current_thread(), minToWrite);
-			fWriteRequests.Add(&request);
-
-			mutex_unlock(&fRequestLock);
-			status_t status = entry.Wait(B_CAN_INTERRUPT);
-			mutex_lock(&fRequestLock);
-
-			fWriteRequests.Remove(&request);
-
-			if (status != B_OK)
-				return status;
-		}
+		status_t status = _WaitForWritable(minToWrite, nonBlocking);
+		if (status != B_OK)
+			return status;
 
 		// write only as long as there are readers left
 		if (fActive && fReaderCount == 0) {
@@ -469,35 +500,9 @@ Inode::ReadDataFromBuffer(void* data, size_t* _length, bool nonBlocking,
 	size_t dataSize = *_length;
 	*_length = 0;
 
-	// wait until our request is first in queue
-	status_t error;
-	if (fReadRequests.Head() != &request) {
-		if (nonBlocking)
-			return B_WOULD_BLOCK;
-
-		TRACE("Inode %p::%s(): wait for request %p to become the first "
-			"request.\n", this, __FUNCTION__, &request);
-
-		error = WaitForReadRequest(request);
-		if (error != B_OK)
-			return error;
-	}
-
-	// wait until data are available
-	while (fBuffer.Readable() == 0) {
-		if (nonBlocking)
-			return B_WOULD_BLOCK;
-
-		if (fActive && fWriterCount == 0)
-			return B_OK;
-
-		TRACE("Inode %p::%s(): wait for data, request %p\n", this, __FUNCTION__,
-			&request);
-
-		error = WaitForReadRequest(request);
-		if (error != B_OK)
-			return error;
-	}
+	status_t error = _WaitForReadable(nonBlocking, request);
+	if (error != B_OK || fBuffer.Readable() == 0)
+		return error;
 
 	// read as much as we can
 	size_t toRead = fBuffer.Readable();
@@ -516,6 +521,111 @@ Inode::ReadDataFromBuffer(void* data, size_t* _length, bool nonBlocking,
 }
 
 
+/*!	Like WriteDataToBuffer(), but instead of copying from a buffer, lets
+	\a hook produce the data directly in the ring buffer. The hook is called
+	with the request lock held, and returns how many bytes it has placed in
+	the given space; fewer than asked for end the transfer.
+*/
+status_t
+Inode::SpliceDataToBuffer(size_t* _length, bool nonBlocking,
+	fifo_splice_hook hook, void* hookCookie)
+{
+	size_t dataSize = *_length;
+	size_t& written = *_length;
+	written = 0;
+
+	size_t minToWrite = 1;
+	if (dataSize <= VFS_FIFO_ATOMIC_WRITE_SIZE)
+		minToWrite = dataSize;
+
+	while (dataSize > 0) {
+		status_t status = _WaitForWritable(minToWrite, nonBlocking);
+		if (status != B_OK)
+			return status;
+
+		// write only as long as there are readers left
+		if (fActive && fReaderCount == 0) {
+			if (written == 0)
+				send_signal(find_thread(NULL), SIGPIPE);
+			return EPIPE;
+		}
+
+		iovec vecs[2];
+		int32 count = fBuffer.GetWritableVecs(vecs);
+		size_t transferred = 0;
+		bool sourceDone = false;
+
+		for (int32 i = 0; i < count && transferred < dataSize; i++) {
+			size_t toTransfer = min_c(vecs[i].iov_len, dataSize - transferred);
+			ssize_t bytes = hook(hookCookie, vecs[i].iov_base, toTransfer);
+			if (bytes < 0) {
+				status = bytes;
+				sourceDone = true;
+				break;
+			}
+
+			transferred += bytes;
+			if ((size_t)bytes < toTransfer) {
+				sourceDone = true;
+				break;
+			}
+		}
+
+		fBuffer.CommitWritten(transferred);
+		dataSize -= transferred;
+		written += transferred;
+
+		NotifyBytesWritten(transferred);
+
+		if (sourceDone)
+			return status;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Like ReadDataFromBuffer(), but hands the data to \a hook directly from
+	the ring buffer instead of copying it out. The hook is called with the
+	request lock held, and returns how many bytes it has consumed.
+*/
+status_t
+Inode::SpliceDataFromBuffer(size_t* _length, bool nonBlocking,
+	ReadRequest& request, fifo_splice_hook hook, void* hookCookie)
+{
+	size_t dataSize = *_length;
+	*_length = 0;
+
+	status_t error = _WaitForReadable(nonBlocking, request);
+	if (error != B_OK)
+		return error;
+
+	iovec vecs[2];
+	int32 count = fBuffer.GetReadableVecs(vecs);
+	size_t transferred = 0;
+
+	for (int32 i = 0; i < count && transferred < dataSize; i++) {
+		size_t toTransfer = min_c(vecs[i].iov_len, dataSize - transferred);
+		ssize_t bytes = hook(hookCookie, vecs[i].iov_base, toTransfer);
+		if (bytes < 0) {
+			error = bytes;
+			break;
+		}
+
+		transferred += bytes;
+		if ((size_t)bytes < toTransfer)
+			break;
+	}
+
+	fBuffer.Flush(transferred);
+	NotifyBytesRead(transferred);
+
+	*_length = transferred;
+
+	return transferred > 0 ? B_OK : error;
+}
+
+
 void
 Inode::AddReadRequest(ReadRequest& request)
 {
@@ -774,6 +884,78 @@ Inode::Deselect(uint8 event, selectsync* sync, int openMode)
 }
 
 
+/*!	Waits until at least \a minToWrite bytes can be written to the buffer, or
+	there are no readers left. The request lock must be held.
+*/
+status_t
+Inode::_WaitForWritable(size_t minToWrite, bool nonBlocking)
+{
+	while (!fActive
+			|| (fBuffer.Writable() < minToWrite && fReaderCount > 0)) {
+		if (nonBlocking)
+			return B_WOULD_BLOCK;
+
+		ConditionVariableEntry entry;
+		entry.Add(this);
+
+		WriteRequest request(thread_get_current_thread(), minToWrite);
+		fWriteRequests.Add(&request);
+
+		mutex_unlock(&fRequestLock);
+		status_t status = entry.Wait(B_CAN_INTERRUPT);
+		mutex_lock(&fRequestLock);
+
+		fWriteRequests.Remove(&request);
+
+		if (status != B_OK)
+			return status;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Waits until \a request is the first in the queue, and data are available
+	or there are no writers left -- in the latter case the buffer is empty on
+	return. The request lock must be held.
+*/
+status_t
+Inode::_WaitForReadable(bool nonBlocking, ReadRequest& request)
+{
+	// wait until our request is first in queue
+	status_t error;
+	if (fReadRequests.Head() != &request) {
+		if (nonBlocking)
+			return B_WOULD_BLOCK;
+
+		TRACE("Inode %p::%s(): wait for request %p to become the first "
+			"request.\n", this, __FUNCTION__, &request);
+
+		error = WaitForReadRequest(request);
+		if (error != B_OK)
+			return error;
+	}
+
+	// wait until data are available
+	while (fBuffer.Readable() == 0) {
+		if (nonBlocking)
+			return B_WOULD_BLOCK;
+
+		if (fActive && fWriterCount == 0)
+			return B_OK;
+
+		TRACE("Inode %p::%s(): wait for data, request %p\n", this, __FUNCTION__,
+			&request);
+
+		error = WaitForReadRequest(request);
+		if (error != B_OK)
+			return error;
+	}
+
+	return B_OK;
+}
+
+
 void
 Inode::Dump(bool dumpData) const
 {
@@ -992,7 +1174,7 @@ fifo_read(fs_volume* _volume, fs_vnode* _node, void* _cookie,
 
 	size_t length = *_length;
 	status_t status = inode->ReadDataFromBuffer(buffer, &length,
-		(cookie->open_mode & O_NONBLOCK) != 0, is_called_via_syscall(),
+		fd_nonblocking_io(cookie->open_mode), is_called_via_syscall(),
 		request);
 
 	inode->RemoveReadRequest(request);
@@ -1026,7 +1208,7 @@ fifo_write(fs_volume* _volume, fs_vnode* _node, void* _cookie,
 
 	// copy data into ring buffer
 	status_t status = inode->WriteDataToBuffer(buffer, &length,
-		(cookie->open_mode & O_NONBLOCK) != 0, is_called_via_syscall());
+		fd_nonblocking_io(cookie->open_mode), is_called_via_syscall());
 
 	if (length > 0)
 		status = B_OK;
@@ -1329,6 +1511,84 @@ create_fifo_vnode(fs_volume* superVolume, fs_vnode* vnode)
 }
 
 
+bool
+is_fifo_vnode(fs_vnode* vnode)
+{
+	return vnode->ops == &sFIFOVnodeOps;
+}
+
+
+/*!	Reads up to \a _length bytes from the FIFO, like read() would, but passes
+	them to \a hook right from the FIFO's buffer. \a nonBlocking is honored
+	in addition to the cookie's open mode.
+	Since the hook is called with the FIFO locked, writers will have to wait
+	for it to return.
+*/
+status_t
+fifo_splice_read(fs_vnode* vnode, void* _cookie, size_t* _length,
+	bool nonBlocking, fifo_splice_hook hook, void* hookCookie)
+{
+	file_cookie* cookie = (file_cookie*)_cookie;
+	Inode* inode = (Inode*)vnode->private_node;
+
+	MutexLocker locker(inode->RequestLock());
+
+	if (inode->IsActive() && inode->WriterCount() == 0
+		&& inode->BytesAvailable() == 0) {
+		*_length = 0;
+		return B_OK;
+	}
+
+	ReadRequest request(cookie);
+	inode->AddReadRequest(request);
+
+	size_t length = *_length;
+	status_t status = inode->SpliceDataFromBuffer(&length,
+		nonBlocking || (cookie->open_mode & O_NONBLOCK) != 0, request, hook,
+		hookCookie);
+
+	inode->RemoveReadRequest(request);
+	inode->NotifyReadDone();
+
+	if (length > 0)
+		status = B_OK;
+
+	*_length = length;
+	return status;
+}
+
+
+/*!	Writes up to \a _length bytes to the FIFO, like write() would, but lets
+	\a hook produce them right in the FIFO's buffer. Stops early when the
+	hook returns fewer bytes than asked for.
+	Since the hook is called with the FIFO locked, readers will have to wait
+	for it to return.
+*/
+status_t
+fifo_splice_write(fs_vnode* vnode, void* _cookie, size_t* _length,
+	bool nonBlocking, fifo_splice_hook hook, void* hookCookie)
+{
+	file_cookie* cookie = (file_cookie*)_cookie;
+	Inode* inode = (Inode*)vnode->private_node;
+
+	MutexLocker locker(inode->RequestLock());
+
+	size_t length = *_length;
+	if (length == 0)
+		return B_OK;
+
+	status_t status = inode->SpliceDataToBuffer(&length,
+		nonBlocking || (cookie->open_mode & O_NONBLOCK) != 0, hook,
+		hookCookie);
+
+	if (length > 0)
+		status = B_OK;
+
+	*_length = length;
+	return status;
+}
+
+
 void
 fifo_init()
 {
@@ -1,5 +1,6 @@
 /*
  * Copyright 2008, Ingo Weinhold, ingo_weinhold@gmx.de.
+ * Copyright 2026, Haiku, Inc. All rights reserved.
  * Distributed under the terms of the MIT License.
  */
 #ifndef _VFS_FIFO_H
@@ -8,8 +9,17 @@
 #include <fs_interface.h>
 
 
+typedef ssize_t (*fifo_splice_hook)(void* cookie, void* data, size_t length);
+
+
 status_t	create_fifo_vnode(fs_volume* superVolume, fs_vnode* vnode);
 void		fifo_init();
 
+bool		is_fifo_vnode(fs_vnode* vnode);
+status_t	fifo_splice_read(fs_vnode* vnode, void* cookie, size_t* _length,
+				bool nonBlocking, fifo_splice_hook hook, void* hookCookie);
+status_t	fifo_splice_write(fs_vnode* vnode, void* cookie, size_t* _length,
+				bool nonBlocking, fifo_splice_hook hook, void* hookCookie);
+
 
 #endif	// _VFS_FIFO_H
@@ -0,0 +1,1277 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	I/O rings: batched file and socket I/O through a submission and a
+	completion queue shared with the team (see io_ring_defs.h).
+
+	Operations are started by the thread that enters the ring. How they
+	complete depends on the file they are for:
+	- Reads and writes of registered buffers on devices with an io() hook are
+	  turned into IORequests on the locked buffer pages, and complete from the
+	  request's finished callback.
+	- Operations on files that support select() and might block, like
+	  sockets, FIFOs, or TTYs, wait on the ring until the file is ready, and
+	  are then executed by the next thread that enters the ring. Sockets are
+	  accessed non-blocking then, so that losing a race only re-arms the
+	  operation.
+	- Everything else, most importantly regular files, is executed right away
+	  like a read() or write() would.
+	Completions that find the completion queue full are kept back until
+	userland has made room again.
+*/
+
+
+#include <io_ring.h>
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+
+#include <AutoDeleter.h>
+#include <AutoDeleterDrivers.h>
+#include <StackOrHeapArray.h>
+
+#include <condition_variable.h>
+#include <fs/fd.h>
+#include <kernel.h>
+#include <lock.h>
+#include <syscall_restart.h>
+#include <team.h>
+#include <thread.h>
+#include <util/AutoLock.h>
+#include <util/DoublyLinkedList.h>
+#include <util/iovec_support.h>
+#include <vfs.h>
+#include <vm/vm.h>
+#include <wait_for_objects.h>
+
+#include "IORequest.h"
+#include "select_sync.h"
+#include "Vnode.h"
+
+
+//#define TRACE_IO_RING
+#ifdef TRACE_IO_RING
+#	define TRACE(x...) dprintf("io_ring: " x)
+#else
+#	define TRACE(x...) do {} while (false)
+#endif
+
+
+class IORing;
+
+
+struct IORingOperation : select_info, AsyncIOCallback,
+		DoublyLinkedListLinkImpl<IORingOperation> {
+	IORing*				ring;
+	io_ring_sqe			sqe;
+		// our copy, userland may change the ring entry at any time
+	file_descriptor*	descriptor;
+	generic_io_vec*		vecs;
+	int32				result;
+	uint16				wait_events;
+	uint16				armed_events;
+	bool				queued;
+
+	virtual	void		IOFinished(status_t status, bool partialTransfer,
+							generic_size_t bytesTransferred);
+};
+
+typedef DoublyLinkedList<IORingOperation> OperationList;
+
+
+class IORing : public select_sync {
+public:
+								IORing(team_id team);
+	virtual						~IORing();
+
+			status_t			Init(io_ring_params& params);
+			void				Close();
+
+			team_id				Team() const	{ return fTeam; }
+
+			ssize_t				Enter(uint32 toSubmit, uint32 minComplete,
+									uint32 flags, bigtime_t timeout);
+
+			status_t			RegisterBuffers(const iovec* userVecs,
+									uint32 count);
+			status_t			UnregisterBuffers();
+			status_t			RegisterFiles(const int* userFDs,
+									uint32 count);
+			status_t			UnregisterFiles();
+
+	virtual	status_t			Notify(select_info* info, uint16 events);
+
+			void				AsyncOperationFinished(IORingOperation* op,
+									ssize_t result);
+
+private:
+			void				_Start(IORingOperation* op);
+			status_t			_CheckOperation(IORingOperation* op);
+			status_t			_GetDescriptor(IORingOperation* op);
+			uint16				_WaitEvents(IORingOperation* op);
+			bool				_StartAsynchronous(IORingOperation* op);
+			ssize_t				_Execute(IORingOperation* op);
+
+			void				_Arm(IORingOperation* op);
+			void				_Disarm(IORingOperation* op);
+			void				_RunReady();
+			void				_CancelWaiting();
+
+			void				_Complete(IORingOperation* op,
+									ssize_t result);
+			bool				_PostCompletion(IORingOperation* op);
+			void				_FlushOverflow();
+			void				_Reap();
+			uint32				_CompletionsAvailable() const;
+
+			void				_WaitForAsynchronousIO(
+									MutexLocker& locker);
+			void				_UnregisterBuffers(MutexLocker& locker);
+			void				_UnregisterFiles();
+
+private:
+			mutex				fLock;
+				// serializes entering and (un)registering
+			spinlock			fSpinlock;
+				// protects the completion queue and the operation lists
+				// below, may be taken in any context
+			ConditionVariable	fCondition;
+			team_id				fTeam;
+			bool				fClosed;
+
+			area_id				fArea;
+			area_id				fUserArea;
+			uint8*				fAddress;
+			io_ring_queue*		fSQ;
+			io_ring_queue*		fCQ;
+			io_ring_sqe*		fSQEntries;
+			io_ring_cqe*		fCQEntries;
+			uint32				fSQSize;
+			uint32				fCQSize;
+			uint32				fSQHead;
+			uint32				fCQTail;
+				// our copies of the indices we own
+
+			IORingOperation*	fOperations;
+			OperationList		fFreeOperations;
+			OperationList		fWaiting;
+			OperationList		fReady;
+			OperationList		fOverflow;
+			OperationList		fDone;
+			int32				fInFlight;
+			int32				fAsynchronous;
+			uint32				fOverflowCount;
+
+			iovec*				fBuffers;
+			uint32				fBufferCount;
+			file_descriptor**	fFiles;
+			uint32				fFileCount;
+};
+
+
+static status_t io_ring_close(file_descriptor* descriptor);
+static void io_ring_free(file_descriptor* descriptor);
+
+static struct fd_ops sIORingFDOps = {
+	&io_ring_close,
+	&io_ring_free
+};
+
+
+/*!	Drops an open reference acquired with get_open_fd(). Unlike close_fd()
+	this doesn't release the team's POSIX locks, since no FD of the team is
+	closed.
+*/
+static void
+put_open_fd(file_descriptor* descriptor)
+{
+	if (atomic_add(&descriptor->open_count, -1) == 1) {
+		vfs_unlock_vnode_if_locked(descriptor);
+
+		if (descriptor->ops != NULL && descriptor->ops->fd_close != NULL)
+			descriptor->ops->fd_close(descriptor);
+	}
+
+	put_fd(descriptor);
+}
+
+
+static inline bool
+is_fixed_buffer_operation(uint8 opcode)
+{
+	return opcode == IO_RING_OP_READ_FIXED || opcode == IO_RING_OP_WRITE_FIXED;
+}
+
+
+static inline bool
+is_write_operation(uint8 opcode)
+{
+	return opcode == IO_RING_OP_WRITE || opcode == IO_RING_OP_WRITEV
+		|| opcode == IO_RING_OP_WRITE_FIXED;
+}
+
+
+void
+IORingOperation::IOFinished(status_t status, bool partialTransfer,
+	generic_size_t bytesTransferred)
+{
+	ring->AsyncOperationFinished(this,
+		status == B_OK || bytesTransferred > 0
+			? (ssize_t)bytesTransferred : (ssize_t)status);
+}
+
+
+//	#pragma mark - IORing
+
+
+IORing::IORing(team_id team)
+	:
+	fTeam(team),
+	fClosed(false),
+	fArea(-1),
+	fUserArea(-1),
+	fAddress(NULL),
+	fSQ(NULL),
+	fCQ(NULL),
+	fSQEntries(NULL),
+	fCQEntries(NULL),
+	fSQSize(0),
+	fCQSize(0),
+	fSQHead(0),
+	fCQTail(0),
+	fOperations(NULL),
+	fInFlight(0),
+	fAsynchronous(0),
+	fOverflowCount(0),
+	fBuffers(NULL),
+	fBufferCount(0),
+	fFiles(NULL),
+	fFileCount(0)
+{
+	mutex_init(&fLock, "io ring");
+	B_INITIALIZE_SPINLOCK(&fSpinlock);
+	fCondition.Init(this, "io ring");
+}
+
+
+IORing::~IORing()
+{
+	delete[] fOperations;
+
+	if (fUserArea >= 0)
+		vm_delete_area(fTeam, fUserArea, true);
+	if (fArea >= 0)
+		delete_area(fArea);
+
+	mutex_destroy(&fLock);
+}
+
+
+status_t
+IORing::Init(io_ring_params& params)
+{
+	if (params.sq_entries == 0 || params.sq_entries > IO_RING_MAX_ENTRIES
+		|| params.cq_entries > 2 * IO_RING_MAX_ENTRIES || params.flags != 0) {
+		return B_BAD_VALUE;
+	}
+
+	fSQSize = 1;
+	while (fSQSize < params.sq_entries)
+		fSQSize <<= 1;
+
+	uint32 cqEntries = params.cq_entries != 0
+		? params.cq_entries : 2 * fSQSize;
+	if (cqEntries < fSQSize)
+		return B_BAD_VALUE;
+
+	fCQSize = 1;
+	while (fCQSize < cqEntries)
+		fCQSize <<= 1;
+
+	const uint32 sqOffset = 0;
+	const uint32 cqOffset = sizeof(io_ring_queue);
+	const uint32 sqesOffset = 2 * sizeof(io_ring_queue);
+	const uint32 cqesOffset = sqesOffset + fSQSize * sizeof(io_ring_sqe);
+	const size_t size = PAGE_ALIGN(cqesOffset + fCQSize * sizeof(io_ring_cqe));
+
+	fArea = create_area("io ring", (void**)&fAddress, B_ANY_KERNEL_ADDRESS,
+		size, B_FULL_LOCK, B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA);
+	if (fArea < 0)
+		return fArea;
+
+	void* userAddress = NULL;
+	fUserArea = vm_clone_area(fTeam, "io ring", &userAddress, B_ANY_ADDRESS,
+		B_READ_AREA | B_WRITE_AREA, REGION_NO_PRIVATE_MAP, fArea, true);
+	if (fUserArea < 0)
+		return fUserArea;
+
+	fOperations = new(std::nothrow) IORingOperation[fCQSize];
+	if (fOperations == NULL)
+		return B_NO_MEMORY;
+
+	for (uint32 i = 0; i < fCQSize; i++) {
+		fOperations[i].ring = this;
+		fFreeOperations.Add(&fOperations[i]);
+	}
+
+	memset(fAddress, 0, size);
+	fSQ = (io_ring_queue*)(fAddress + sqOffset);
+	fCQ = (io_ring_queue*)(fAddress + cqOffset);
+	fSQEntries = (io_ring_sqe*)(fAddress + sqesOffset);
+	fCQEntries = (io_ring_cqe*)(fAddress + cqesOffset);
+	fSQ->mask = fSQSize - 1;
+	fSQ->entries = fSQSize;
+	fCQ->mask = fCQSize - 1;
+	fCQ->entries = fCQSize;
+
+	params.sq_entries = fSQSize;
+	params.cq_entries = fCQSize;
+	params.area = fUserArea;
+	params.address = userAddress;
+	params.size = size;
+	params.sq_offset = sqOffset;
+	params.cq_offset = cqOffset;
+	params.sqes_offset = sqesOffset;
+	params.cqes_offset = cqesOffset;
+
+	return B_OK;
+}
+
+
+/*!	Called when the last FD referring to the ring is closed. Cancels all
+	operations that wait for their file, and waits for those that are
+	already in progress.
+*/
+void
+IORing::Close()
+{
+	MutexLocker locker(fLock);
+
+	fClosed = true;
+	_CancelWaiting();
+	_WaitForAsynchronousIO(locker);
+
+	{
+		// nobody is going to make room for these anymore
+		InterruptsSpinLocker spinLocker(fSpinlock);
+		fDone.TakeFrom(&fOverflow);
+		fOverflowCount = 0;
+	}
+	_Reap();
+
+	_UnregisterFiles();
+	_UnregisterBuffers(locker);
+
+	locker.Unlock();
+	fCondition.NotifyAll(B_FILE_ERROR);
+}
+
+
+ssize_t
+IORing::Enter(uint32 toSubmit, uint32 minComplete, uint32 flags,
+	bigtime_t timeout)
+{
+	MutexLocker locker(fLock);
+	if (fClosed)
+		return B_FILE_ERROR;
+
+	_Reap();
+	_FlushOverflow();
+
+	// submit the new entries
+
+	ssize_t submitted = 0;
+	status_t error = B_OK;
+	uint32 tail = atomic_get((int32*)&fSQ->tail);
+
+	while ((uint32)submitted < toSubmit && fSQHead != tail) {
+		if (tail - fSQHead > fSQSize) {
+			// userland has messed up the queue
+			error = B_BAD_DATA;
+			break;
+		}
+
+		IORingOperation* op = fFreeOperations.RemoveHead();
+		if (op == NULL) {
+			// too many operations in flight
+			error = B_BUSY;
+			break;
+		}
+
+		memcpy(&op->sqe, &fSQEntries[fSQHead & (fSQSize - 1)],
+			sizeof(io_ring_sqe));
+		fSQHead++;
+		atomic_set((int32*)&fSQ->head, fSQHead);
+		submitted++;
+
+		atomic_add(&fInFlight, 1);
+		_Start(op);
+	}
+
+	if ((flags & IO_RING_ENTER_GETEVENTS) == 0
+		|| (error != B_OK && error != B_BUSY)) {
+		return submitted > 0 ? submitted : error;
+	}
+
+	// When we ran out of operations, waiting for completions will free
+	// some.
+
+	// wait for completions
+
+	minComplete = std::min(minComplete, fCQSize);
+	flags &= B_RELATIVE_TIMEOUT | B_ABSOLUTE_TIMEOUT | B_TIMEOUT_REAL_TIME_BASE;
+
+	while (true) {
+		_RunReady();
+		_Reap();
+
+		ConditionVariableEntry entry;
+		fCondition.Add(&entry);
+
+		_FlushOverflow();
+
+		if (_CompletionsAvailable() >= minComplete)
+			break;
+
+		{
+			InterruptsSpinLocker spinLocker(fSpinlock);
+			if (fInFlight == 0 && fOverflow.IsEmpty() && fReady.IsEmpty()) {
+				// nothing could ever complete
+				break;
+			}
+		}
+
+		locker.Unlock();
+		status_t status = entry.Wait(flags | B_CAN_INTERRUPT, timeout);
+		locker.Lock();
+
+		if (fClosed)
+			return B_FILE_ERROR;
+
+		if (status != B_OK) {
+			if (submitted == 0)
+				return status;
+			break;
+		}
+	}
+
+	return submitted;
+}
+
+
+status_t
+IORing::RegisterBuffers(const iovec* userVecs, uint32 count)
+{
+	MutexLocker locker(fLock);
+	if (fClosed)
+		return B_FILE_ERROR;
+	if (fBufferCount > 0)
+		return B_BUSY;
+	if (count == 0 || count > IO_RING_MAX_BUFFERS)
+		return B_BAD_VALUE;
+
+	MemoryDeleter buffersDeleter(malloc(sizeof(iovec) * count));
+	iovec* buffers = (iovec*)buffersDeleter.Get();
+	if (buffers == NULL)
+		return B_NO_MEMORY;
+
+	status_t error = get_iovecs_from_user(userVecs, count, buffers);
+	if (error != B_OK)
+		return error;
+
+	// The buffers stay locked for as long as they are registered, so that
+	// devices can transfer directly from and to their pages.
+	for (uint32 i = 0; i < count; i++) {
+		if (buffers[i].iov_len > 0) {
+			error = lock_memory_etc(fTeam, buffers[i].iov_base,
+				buffers[i].iov_len, B_READ_DEVICE);
+		}
+		if (error != B_OK) {
+			while (i-- > 0) {
+				if (buffers[i].iov_len > 0) {
+					unlock_memory_etc(fTeam, buffers[i].iov_base,
+						buffers[i].iov_len, B_READ_DEVICE);
+				}
+			}
+			return error;
+		}
+	}
+
+	fBuffers = (iovec*)buffersDeleter.Detach();
+	fBufferCount = count;
+	return B_OK;
+}
+
+
+status_t
+IORing::UnregisterBuffers()
+{
+	MutexLocker locker(fLock);
+	if (fClosed)
+		return B_FILE_ERROR;
+	if (fBufferCount == 0)
+		return B_ENTRY_NOT_FOUND;
+
+	_UnregisterBuffers(locker);
+	return B_OK;
+}
+
+
+status_t
+IORing::RegisterFiles(const int* userFDs, uint32 count)
+{
+	MutexLocker locker(fLock);
+	if (fClosed)
+		return B_FILE_ERROR;
+	if (fFileCount > 0)
+		return B_BUSY;
+	if (count == 0 || count > IO_RING_MAX_FILES)
+		return B_BAD_VALUE;
+
+	BStackOrHeapArray<int, 64> fds(count);
+	if (!fds.IsValid())
+		return B_NO_MEMORY;
+	if (!IS_USER_ADDRESS(userFDs)
+		|| user_memcpy(fds, userFDs, sizeof(int) * count) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	file_descriptor** files
+		= (file_descriptor**)calloc(count, sizeof(file_descriptor*));
+	if (files == NULL)
+		return B_NO_MEMORY;
+
+	// Registered files are kept open, even if the team closes their FDs.
+	io_context* context = get_current_io_context(false);
+	for (uint32 i = 0; i < count; i++) {
+		if (fds[i] < 0)
+			continue;
+
+		files[i] = get_open_fd(context, fds[i]);
+		if (files[i] == NULL || files[i]->ops == &sIORingFDOps) {
+			if (files[i] != NULL)
+				put_open_fd(files[i]);
+			while (i-- > 0) {
+				if (files[i] != NULL)
+					put_open_fd(files[i]);
+			}
+			free(files);
+			return B_FILE_ERROR;
+		}
+	}
+
+	fFiles = files;
+	fFileCount = count;
+	return B_OK;
+}
+
+
+status_t
+IORing::UnregisterFiles()
+{
+	MutexLocker locker(fLock);
+	if (fClosed)
+		return B_FILE_ERROR;
+	if (fFileCount == 0)
+		return B_ENTRY_NOT_FOUND;
+
+	_UnregisterFiles();
+	return B_OK;
+}
+
+
+status_t
+IORing::Notify(select_info* info, uint16 events)
+{
+	IORingOperation* op = static_cast<IORingOperation*>(info);
+
+	atomic_or(&op->events, events);
+	if ((op->selected_events & events) == 0)
+		return B_OK;
+
+	InterruptsSpinLocker locker(fSpinlock);
+	if (!op->queued) {
+		op->queued = true;
+		fWaiting.Remove(op);
+		fReady.Add(op);
+		fCondition.NotifyAll();
+	}
+
+	return B_OK;
+}
+
+
+void
+IORing::AsyncOperationFinished(IORingOperation* op, ssize_t result)
+{
+	_Complete(op, result);
+
+	// Close() may delete the ring as soon as the count drops to zero, so
+	// that has to be the last thing we touch.
+	InterruptsSpinLocker locker(fSpinlock);
+	if (--fAsynchronous == 0)
+		fCondition.NotifyAll();
+}
+
+
+void
+IORing::_Start(IORingOperation* op)
+{
+	TRACE("start %p: opcode %u, fd %" B_PRId32 "\n", op, op->sqe.opcode,
+		op->sqe.fd);
+
+	op->descriptor = NULL;
+	op->vecs = NULL;
+	op->wait_events = 0;
+	op->armed_events = 0;
+
+	status_t error = _CheckOperation(op);
+	if (error != B_OK) {
+		_Complete(op, error);
+		return;
+	}
+
+	if (op->sqe.opcode == IO_RING_OP_NOP) {
+		_Complete(op, B_OK);
+		return;
+	}
+
+	error = _GetDescriptor(op);
+	if (error != B_OK) {
+		_Complete(op, error);
+		return;
+	}
+
+	if (_StartAsynchronous(op))
+		return;
+
+	op->wait_events = _WaitEvents(op);
+	if (op->wait_events != 0) {
+		_Arm(op);
+		return;
+	}
+
+	_Complete(op, _Execute(op));
+}
+
+
+status_t
+IORing::_CheckOperation(IORingOperation* op)
+{
+	const io_ring_sqe& sqe = op->sqe;
+
+	if (sqe.opcode >= IO_RING_OP_COUNT
+		|| (sqe.flags & ~IO_RING_SQE_FIXED_FILE) != 0
+		|| sqe.length > INT32_MAX || sqe.offset < -1) {
+		return B_BAD_VALUE;
+	}
+
+	if (is_fixed_buffer_operation(sqe.opcode)) {
+		if (sqe.buffer_index >= fBufferCount)
+			return B_BAD_VALUE;
+
+		const iovec& buffer = fBuffers[sqe.buffer_index];
+		addr_t base = (addr_t)buffer.iov_base;
+		if (sqe.address < base || sqe.length > buffer.iov_len
+			|| sqe.address - base > buffer.iov_len - sqe.length) {
+			return B_BAD_ADDRESS;
+		}
+	}
+
+	return B_OK;
+}
+
+
+status_t
+IORing::_GetDescriptor(IORingOperation* op)
+{
+	file_descriptor* descriptor;
+	if ((op->sqe.flags & IO_RING_SQE_FIXED_FILE) != 0) {
+		if (op->sqe.fd < 0 || (uint32)op->sqe.fd >= fFileCount
+			|| fFiles[op->sqe.fd] == NULL) {
+			return B_FILE_ERROR;
+		}
+
+		descriptor = fFiles[op->sqe.fd];
+		inc_fd_ref_count(descriptor);
+		atomic_add(&descriptor->open_count, 1);
+	} else {
+		descriptor = get_open_fd(get_current_io_context(false), op->sqe.fd);
+		if (descriptor == NULL)
+			return B_FILE_ERROR;
+	}
+
+	if (descriptor->ops == &sIORingFDOps) {
+		put_open_fd(descriptor);
+		return B_BAD_VALUE;
+	}
+
+	// The operation keeps the file open until it has been completed.
+	op->descriptor = descriptor;
+	return B_OK;
+}
+
+
+/*!	Returns the events an operation has to wait for before it can be
+	executed without blocking, or 0, if it doesn't need to wait.
+*/
+uint16
+IORing::_WaitEvents(IORingOperation* op)
+{
+	file_descriptor* descriptor = op->descriptor;
+
+	if (op->sqe.opcode == IO_RING_OP_POLL)
+		return op->sqe.op_flags & ~B_EVENT_INVALID;
+	if (op->sqe.opcode == IO_RING_OP_FSYNC || descriptor->ops->fd_select == NULL)
+		return 0;
+
+	struct vnode* vnode = fd_vnode(descriptor);
+	if (vnode != NULL && (S_ISREG(vnode->Type()) || S_ISDIR(vnode->Type())))
+		return 0;
+
+	return is_write_operation(op->sqe.opcode)
+			|| op->sqe.opcode == IO_RING_OP_SEND
+		? B_EVENT_WRITE : B_EVENT_READ;
+}
+
+
+/*!	Starts a fixed buffer read or write on a device as IORequest, if
+	possible.
+*/
+bool
+IORing::_StartAsynchronous(IORingOperation* op)
+{
+	const io_ring_sqe& sqe = op->sqe;
+	file_descriptor* descriptor = op->descriptor;
+
+	if (!is_fixed_buffer_operation(sqe.opcode) || sqe.offset < 0
+		|| sqe.length == 0 || !fd_is_file(descriptor)) {
+		return false;
+	}
+
+	struct vnode* vnode = fd_vnode(descriptor);
+	if ((!S_ISCHR(vnode->Type()) && !S_ISBLK(vnode->Type()))
+		|| vnode->ops->io == NULL) {
+		return false;
+	}
+
+	bool write = is_write_operation(sqe.opcode);
+	if (write ? (descriptor->open_mode & O_RWMASK) == O_RDONLY
+			: (descriptor->open_mode & O_RWMASK) == O_WRONLY) {
+		return false;
+	}
+
+	// The buffer is locked, so its physical pages won't change.
+	uint32 count = (sqe.address % B_PAGE_SIZE + sqe.length + B_PAGE_SIZE - 1)
+		/ B_PAGE_SIZE;
+	BStackOrHeapArray<physical_entry, 16> entries(count);
+	op->vecs = (generic_io_vec*)malloc(sizeof(generic_io_vec) * count);
+	if (!entries.IsValid() || op->vecs == NULL)
+		return false;
+
+	if (get_memory_map_etc(fTeam, (void*)(addr_t)sqe.address, sqe.length,
+			entries, &count) != B_OK) {
+		return false;
+	}
+
+	for (uint32 i = 0; i < count; i++) {
+		op->vecs[i].base = entries[i].address;
+		op->vecs[i].length = entries[i].size;
+	}
+
+	{
+		InterruptsSpinLocker locker(fSpinlock);
+		fAsynchronous++;
+	}
+
+	// the callback is invoked in any case
+	if (write) {
+		vfs_asynchronous_write_pages(vnode, descriptor->cookie, sqe.offset,
+			op->vecs, count, sqe.length, B_PHYSICAL_IO_REQUEST, op);
+	} else {
+		vfs_asynchronous_read_pages(vnode, descriptor->cookie, sqe.offset,
+			op->vecs, count, sqe.length, B_PHYSICAL_IO_REQUEST, op);
+	}
+
+	return true;
+}
+
+
+ssize_t
+IORing::_Execute(IORingOperation* op)
+{
+	const io_ring_sqe& sqe = op->sqe;
+	file_descriptor* descriptor = op->descriptor;
+	void* buffer = (void*)(addr_t)sqe.address;
+	bool write = is_write_operation(sqe.opcode);
+	// Operations that waited for their file must not block: another reader
+	// may have taken the data already, and we're holding the ring's lock.
+	// They are armed again when B_WOULD_BLOCK is returned.
+	bool nonBlocking = op->wait_events != 0;
+
+	switch (sqe.opcode) {
+		case IO_RING_OP_READ:
+		case IO_RING_OP_WRITE:
+		case IO_RING_OP_READ_FIXED:
+		case IO_RING_OP_WRITE_FIXED:
+			return fd_user_io(descriptor, sqe.offset, buffer, sqe.length,
+				write, nonBlocking);
+
+		case IO_RING_OP_READV:
+		case IO_RING_OP_WRITEV:
+		{
+			if (sqe.length > IOV_MAX)
+				return B_BAD_VALUE;
+
+			BStackOrHeapArray<iovec, 16> vecs(sqe.length);
+			if (!vecs.IsValid())
+				return B_NO_MEMORY;
+
+			status_t error = get_iovecs_from_user((const iovec*)buffer,
+				sqe.length, vecs, true);
+			if (error != B_OK)
+				return error;
+
+			return fd_vector_io(descriptor, sqe.offset, vecs, sqe.length,
+				write, nonBlocking);
+		}
+
+		case IO_RING_OP_FSYNC:
+			return fd_sync(descriptor);
+
+		case IO_RING_OP_ACCEPT:
+			if (!fd_is_socket(descriptor))
+				return ENOTSOCK;
+			return socket_fd_accept(descriptor,
+				sqe.op_flags & (SOCK_NONBLOCK | SOCK_CLOEXEC), false,
+				nonBlocking);
+
+		case IO_RING_OP_RECV:
+		case IO_RING_OP_SEND:
+			if (!fd_is_socket(descriptor))
+				return ENOTSOCK;
+			if (!is_user_address_range(buffer, sqe.length))
+				return B_BAD_ADDRESS;
+
+			if (sqe.opcode == IO_RING_OP_SEND) {
+				return socket_fd_send(descriptor, buffer, sqe.length,
+					sqe.op_flags | MSG_DONTWAIT);
+			}
+			return socket_fd_recv(descriptor, buffer, sqe.length,
+				sqe.op_flags | MSG_DONTWAIT);
+	}
+
+	return B_BAD_VALUE;
+}
+
+
+/*!	Lets the operation wait until its file reports one of its wait_events. */
+void
+IORing::_Arm(IORingOperation* op)
+{
+	file_descriptor* descriptor = op->descriptor;
+
+	op->sync = this;
+	op->next = NULL;
+	op->events = 0;
+	op->selected_events = op->wait_events | B_EVENT_ERROR
+		| B_EVENT_DISCONNECTED;
+
+	{
+		InterruptsSpinLocker locker(fSpinlock);
+		op->queued = false;
+		fWaiting.Add(op);
+	}
+
+	// The file might notify us right away.
+	uint16 armedEvents = 0;
+	if (descriptor->ops->fd_select != NULL) {
+		for (uint16 event = 1; event < 16; event++) {
+			if ((op->selected_events & SELECT_FLAG(event)) != 0
+				&& descriptor->ops->fd_select(descriptor, event,
+					(selectsync*)(select_info*)op) == B_OK) {
+				armedEvents |= SELECT_FLAG(event);
+			}
+		}
+	}
+	op->armed_events = armedEvents;
+
+	if (armedEvents == 0)
+		Notify(op, op->wait_events);
+}
+
+
+void
+IORing::_Disarm(IORingOperation* op)
+{
+	file_descriptor* descriptor = op->descriptor;
+
+	for (uint16 event = 1; event < 16; event++) {
+		if ((op->armed_events & SELECT_FLAG(event)) != 0) {
+			descriptor->ops->fd_deselect(descriptor, event,
+				(selectsync*)(select_info*)op);
+		}
+	}
+
+	op->armed_events = 0;
+}
+
+
+/*!	Executes the operations whose files have become ready. */
+void
+IORing::_RunReady()
+{
+	while (true) {
+		IORingOperation* op;
+		{
+			InterruptsSpinLocker locker(fSpinlock);
+			op = fReady.RemoveHead();
+		}
+		if (op == NULL)
+			break;
+
+		_Disarm(op);
+
+		if (op->sqe.opcode == IO_RING_OP_POLL) {
+			_Complete(op, atomic_get(&op->events) & op->selected_events);
+			continue;
+		}
+
+		ssize_t result = _Execute(op);
+		if (result == B_WOULD_BLOCK) {
+			// someone else was faster
+			_Arm(op);
+			continue;
+		}
+
+		_Complete(op, result);
+	}
+}
+
+
+void
+IORing::_CancelWaiting()
+{
+	OperationList operations;
+	{
+		InterruptsSpinLocker locker(fSpinlock);
+		for (OperationList::Iterator it = fWaiting.GetIterator();
+				IORingOperation* op = it.Next();) {
+			op->queued = true;
+		}
+		operations.TakeFrom(&fWaiting);
+		operations.TakeFrom(&fReady);
+	}
+
+	while (IORingOperation* op = operations.RemoveHead()) {
+		_Disarm(op);
+		_Complete(op, B_CANCELED);
+	}
+}
+
+
+void
+IORing::_Complete(IORingOperation* op, ssize_t result)
+{
+	op->result = std::min(result, (ssize_t)INT32_MAX);
+
+	TRACE("complete %p: %" B_PRId32 "\n", op, op->result);
+
+	InterruptsSpinLocker locker(fSpinlock);
+
+	if (fOverflow.IsEmpty() && _PostCompletion(op))
+		fDone.Add(op);
+	else {
+		fOverflow.Add(op);
+		atomic_set((int32*)&fCQ->overflow, ++fOverflowCount);
+	}
+
+	atomic_add(&fInFlight, -1);
+	fCondition.NotifyAll();
+}
+
+
+/*!	The caller must hold the spinlock. */
+bool
+IORing::_PostCompletion(IORingOperation* op)
+{
+	uint32 head = atomic_get((int32*)&fCQ->head);
+	if (fCQTail - head >= fCQSize)
+		return false;
+
+	io_ring_cqe& cqe = fCQEntries[fCQTail & (fCQSize - 1)];
+	cqe.user_data = op->sqe.user_data;
+	cqe.result = op->result;
+	cqe.flags = 0;
+
+	fCQTail++;
+	atomic_set((int32*)&fCQ->tail, fCQTail);
+	return true;
+}
+
+
+void
+IORing::_FlushOverflow()
+{
+	InterruptsSpinLocker locker(fSpinlock);
+
+	while (IORingOperation* op = fOverflow.Head()) {
+		if (!_PostCompletion(op))
+			break;
+
+		fOverflow.Remove(op);
+		fDone.Add(op);
+		fOverflowCount--;
+	}
+
+	atomic_set((int32*)&fCQ->overflow, fOverflowCount);
+}
+
+
+/*!	Releases what the completed operations still hold. */
+void
+IORing::_Reap()
+{
+	OperationList done;
+	{
+		InterruptsSpinLocker locker(fSpinlock);
+		done.TakeFrom(&fDone);
+	}
+
+	while (IORingOperation* op = done.RemoveHead()) {
+		if (op->descriptor != NULL)
+			put_open_fd(op->descriptor);
+		free(op->vecs);
+
+		op->descriptor = NULL;
+		op->vecs = NULL;
+		fFreeOperations.Add(op);
+	}
+}
+
+
+uint32
+IORing::_CompletionsAvailable() const
+{
+	return fCQTail - (uint32)atomic_get((int32*)&fCQ->head);
+}
+
+
+/*!	Waits until all IORequests have finished. The caller must hold the
+	ring's lock, which is temporarily released.
+*/
+void
+IORing::_WaitForAsynchronousIO(MutexLocker& locker)
+{
+	while (true) {
+		ConditionVariableEntry entry;
+		fCondition.Add(&entry);
+
+		{
+			InterruptsSpinLocker spinLocker(fSpinlock);
+			if (fAsynchronous == 0)
+				break;
+		}
+
+		locker.Unlock();
+		entry.Wait();
+		locker.Lock();
+	}
+}
+
+
+/*!	The caller must hold the ring's lock, which is temporarily released
+	while device I/O might still be using the buffers.
+*/
+void
+IORing::_UnregisterBuffers(MutexLocker& locker)
+{
+	if (fBufferCount == 0)
+		return;
+
+	_WaitForAsynchronousIO(locker);
+
+	for (uint32 i = 0; i < fBufferCount; i++) {
+		if (fBuffers[i].iov_len > 0) {
+			unlock_memory_etc(fTeam, fBuffers[i].iov_base,
+				fBuffers[i].iov_len, B_READ_DEVICE);
+		}
+	}
+
+	free(fBuffers);
+	fBuffers = NULL;
+	fBufferCount = 0;
+}
+
+
+/*!	The caller must hold the ring's lock. Operations in flight keep their
+	own references to the files.
+*/
+void
+IORing::_UnregisterFiles()
+{
+	for (uint32 i = 0; i < fFileCount; i++) {
+		if (fFiles[i] != NULL)
+			put_open_fd(fFiles[i]);
+	}
+
+	free(fFiles);
+	fFiles = NULL;
+	fFileCount = 0;
+}
+
+
+//	#pragma mark - File descriptor ops
+
+
+static status_t
+io_ring_close(file_descriptor* descriptor)
+{
+	IORing* ring = (IORing*)descriptor->cookie;
+	ring->Close();
+	return B_OK;
+}
+
+
+static void
+io_ring_free(file_descriptor* descriptor)
+{
+	IORing* ring = (IORing*)descriptor->cookie;
+	put_select_sync(ring);
+}
+
+
+/*!	Returns the ring for the FD. Rings can only be used by the team that
+	created them; their shared memory is mapped only there.
+*/
+static status_t
+get_io_ring(int fd, file_descriptor*& descriptor, IORing*& ring)
+{
+	if (fd < 0)
+		return B_FILE_ERROR;
+
+	descriptor = get_fd(get_current_io_context(false), fd);
+	if (descriptor == NULL)
+		return B_FILE_ERROR;
+
+	if (descriptor->ops != &sIORingFDOps) {
+		put_fd(descriptor);
+		return B_BAD_VALUE;
+	}
+
+	ring = (IORing*)descriptor->cookie;
+	if (ring->Team() != team_get_current_team_id()) {
+		put_fd(descriptor);
+		return B_NOT_ALLOWED;
+	}
+
+	return B_OK;
+}
+
+
+//	#pragma mark - User syscalls
+
+
+int
+_user_io_ring_setup(io_ring_params* userParams)
+{
+	io_ring_params params;
+	if (userParams == NULL || !IS_USER_ADDRESS(userParams)
+		|| user_memcpy(&params, userParams, sizeof(params)) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	IORing* ring = new(std::nothrow) IORing(team_get_current_team_id());
+	if (ring == NULL)
+		return B_NO_MEMORY;
+
+	status_t error = ring->Init(params);
+	if (error == B_OK
+		&& user_memcpy(userParams, &params, sizeof(params)) != B_OK) {
+		error = B_BAD_ADDRESS;
+	}
+	if (error != B_OK) {
+		put_select_sync(ring);
+		return error;
+	}
+
+	file_descriptor* descriptor = alloc_fd();
+	if (descriptor == NULL) {
+		put_select_sync(ring);
+		return B_NO_MEMORY;
+	}
+
+	descriptor->ops = &sIORingFDOps;
+	descriptor->cookie = ring;
+	descriptor->open_mode = O_RDWR;
+
+	io_context* context = get_current_io_context(false);
+	int fd = new_fd(context, descriptor);
+	if (fd < 0) {
+		free(descriptor);
+		put_select_sync(ring);
+		return fd;
+	}
+
+	// the ring's memory is gone after exec()
+	rw_lock_write_lock(&context->lock);
+	fd_set_close_on_exec(context, fd, true);
+	rw_lock_write_unlock(&context->lock);
+
+	return fd;
+}
+
+
+ssize_t
+_user_io_ring_enter(int fd, uint32 toSubmit, uint32 minComplete, uint32 flags,
+	bigtime_t timeout)
+{
+	syscall_restart_handle_timeout_pre(flags, timeout);
+
+	file_descriptor* descriptor;
+	IORing* ring;
+	status_t error = get_io_ring(fd, descriptor, ring);
+	if (error != B_OK)
+		return error;
+	FileDescriptorPutter _(descriptor);
+
+	ssize_t result = ring->Enter(toSubmit, minComplete, flags, timeout);
+	if (result < 0)
+		return syscall_restart_handle_timeout_post(result, timeout);
+
+	return result;
+}
+
+
+status_t
+_user_io_ring_register(int fd, uint32 operation, const void* args,
+	uint32 count)
+{
+	file_descriptor* descriptor;
+	IORing* ring;
+	status_t error = get_io_ring(fd, descriptor, ring);
+	if (error != B_OK)
+		return error;
+	FileDescriptorPutter _(descriptor);
+
+	switch (operation) {
+		case IO_RING_REGISTER_BUFFERS:
+			return ring->RegisterBuffers((const iovec*)args, count);
+		case IO_RING_REGISTER_FILES:
+			return ring->RegisterFiles((const int*)args, count);
+
+		case IO_RING_UNREGISTER_BUFFERS:
+			return ring->UnregisterBuffers();
+		case IO_RING_UNREGISTER_FILES:
+			return ring->UnregisterFiles();
+	}
+
+	return B_BAD_VALUE;
+}
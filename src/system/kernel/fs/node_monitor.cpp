@@ -1213,6 +1213,8 @@ status_t
 notify_stat_changed(dev_t device, ino_t directory, ino_t node,
 	uint32 statFields)
 {
+	vfs_node_stat_changed(device, node, statFields);
+
 	return sNodeMonitorService.NotifyStatChanged(device, directory, node,
 		statFields);
 }
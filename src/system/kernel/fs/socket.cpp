@@ -203,7 +203,7 @@ socket_read(struct file_descriptor *descriptor, off_t pos, void *buffer,
 	size_t *_length)
 {
 	ssize_t bytesRead = sStackInterface->recv(FD_SOCKET(descriptor), buffer,
-		*_length, 0);
+		*_length, fd_nonblocking_io(0) ? MSG_DONTWAIT : 0);
 	*_length = bytesRead >= 0 ? bytesRead : 0;
 	return bytesRead >= 0 ? B_OK : bytesRead;
 }
@@ -214,7 +214,7 @@ socket_write(struct file_descriptor *descriptor, off_t pos, const void *buffer,
 	size_t *_length)
 {
 	ssize_t bytesWritten = sStackInterface->send(FD_SOCKET(descriptor), buffer,
-		*_length, 0);
+		*_length, fd_nonblocking_io(0) ? MSG_DONTWAIT : 0);
 	*_length = bytesWritten >= 0 ? bytesWritten : 0;
 	return bytesWritten >= 0 ? B_OK : bytesWritten;
 }
@@ -227,7 +227,8 @@ socket_readv(struct file_descriptor *descriptor, off_t pos,
 	struct msghdr message = {};
 	message.msg_iov = (struct iovec*)vecs;
 	message.msg_iovlen = count;
-	return sStackInterface->recvmsg(FD_SOCKET(descriptor), &message, 0);
+	return sStackInterface->recvmsg(FD_SOCKET(descriptor), &message,
+		fd_nonblocking_io(0) ? MSG_DONTWAIT : 0);
 }
 
 
@@ -238,7 +239,8 @@ socket_writev(struct file_descriptor *descriptor, off_t pos,
 	struct msghdr message = {};
 	message.msg_iov = (struct iovec*)vecs;
 	message.msg_iovlen = count;
-	return sStackInterface->sendmsg(FD_SOCKET(descriptor), &message, 0);
+	return sStackInterface->sendmsg(FD_SOCKET(descriptor), &message,
+		fd_nonblocking_io(0) ? MSG_DONTWAIT : 0);
 }
 
 
@@ -480,19 +482,15 @@ common_listen(int fd, int backlog, bool kernel)
 
 
 static int
-common_accept(int fd, struct sockaddr *address, socklen_t *_addressLength, int flags,
-	bool kernel)
+accept_socket_fd(file_descriptor* descriptor, struct sockaddr *address,
+	socklen_t *_addressLength, int flags, bool kernel, bool nonBlocking)
 {
-	file_descriptor* descriptor;
-	GET_SOCKET_FD_OR_RETURN(fd, kernel, descriptor);
-	FileDescriptorPutter _(descriptor);
-
 	if ((flags & ~(SOCK_CLOEXEC | SOCK_NONBLOCK)) != 0)
 		RETURN_AND_SET_ERRNO(B_BAD_VALUE);
 
 	net_socket* acceptedSocket;
 	status_t error = sStackInterface->accept(FD_SOCKET(descriptor), address,
-		_addressLength, &acceptedSocket);
+		_addressLength, &acceptedSocket, nonBlocking ? MSG_DONTWAIT : 0);
 	if (error != B_OK)
 		return error;
 
@@ -510,6 +508,19 @@ common_accept(int fd, struct sockaddr *address, socklen_t *_addressLength, int f
 }
 
 
+static int
+common_accept(int fd, struct sockaddr *address, socklen_t *_addressLength, int flags,
+	bool kernel)
+{
+	file_descriptor* descriptor;
+	GET_SOCKET_FD_OR_RETURN(fd, kernel, descriptor);
+	FileDescriptorPutter _(descriptor);
+
+	return accept_socket_fd(descriptor, address, _addressLength, flags, kernel,
+		false);
+}
+
+
 static ssize_t
 common_recv(int fd, void *data, size_t length, int flags, bool kernel)
 {
@@ -856,6 +867,61 @@ socketpair(int family, int type, int protocol, int socketVector[2])
 }
 
 
+// #pragma mark - kernel private API
+
+
+bool
+fd_is_socket(struct file_descriptor* descriptor)
+{
+	return descriptor->ops == &sSocketFDOps;
+}
+
+
+/*!	Accepts a connection on the socket \a descriptor, which the caller has a
+	reference to, and returns the new FD in the current team's context.
+	If \a nonBlocking is \c true, \c B_WOULD_BLOCK is returned when there is
+	no pending connection, no matter whether the socket is non-blocking.
+*/
+int
+socket_fd_accept(struct file_descriptor* descriptor, int flags, bool kernel,
+	bool nonBlocking)
+{
+	socklen_t addressLength = 0;
+	return accept_socket_fd(descriptor, NULL, &addressLength, flags, kernel,
+		nonBlocking);
+}
+
+
+ssize_t
+socket_fd_recv(struct file_descriptor* descriptor, void* data, size_t length,
+	int flags)
+{
+	return sStackInterface->recv(FD_SOCKET(descriptor), data, length, flags);
+}
+
+
+ssize_t
+socket_fd_send(struct file_descriptor* descriptor, const void* data,
+	size_t length, int flags)
+{
+	return sStackInterface->send(FD_SOCKET(descriptor), data, length, flags);
+}
+
+
+/*!	Sends the memory described by \a vecs without copying it. The stack takes
+	over one reference to \a cookie per vector, unless \c B_NOT_SUPPORTED is
+	returned; see socket_send_external() in the network stack for details.
+*/
+ssize_t
+socket_fd_send_external(struct file_descriptor* descriptor,
+	const struct iovec* vecs, size_t count, int flags,
+	void (*release)(void* cookie), void* cookie)
+{
+	return sStackInterface->send_external(FD_SOCKET(descriptor), vecs, count,
+		flags, release, cookie);
+}
+
+
 // #pragma mark - syscalls
 
 
@@ -0,0 +1,512 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	splice(): moves data between two file descriptors without taking it
+	through userland; sendfile() is built on top of it.
+
+	Where possible, the data is not copied in the kernel either:
+	- From a regular file with a file cache to a stream socket, the cached
+	  pages are mapped and locked, and attached to the socket's buffers as
+	  external data. They are unlocked once the stack is done with them,
+	  i.e. usually when the data has been acknowledged.
+	- From a FIFO, the data is handed to the target right out of the FIFO's
+	  buffer; to a FIFO, the source writes into the FIFO's buffer directly.
+	Everything else, including files that don't have a file cache, is copied
+	through a bounce buffer.
+*/
+
+
+#include <splice.h>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <new>
+
+#include <AutoDeleter.h>
+#include <AutoDeleterDrivers.h>
+#include <Referenceable.h>
+
+#include <fs/fd.h>
+#include <heap.h>
+#include <kernel.h>
+#include <syscall_restart.h>
+#include <vfs.h>
+#include <vfs_defs.h>
+#include <vm/vm.h>
+#include <vm/VMAddressSpace.h>
+#include <vm/VMCache.h>
+
+#include "fifo.h"
+#include "Vnode.h"
+
+
+//#define TRACE_SPLICE
+#ifdef TRACE_SPLICE
+#	define TRACE(x...) dprintf("splice: " x)
+#else
+#	define TRACE(x...) do {} while (false)
+#endif
+
+
+static const size_t kMaxWindowSize = 1024 * 1024;
+static const size_t kExternalVecSize = 16 * B_PAGE_SIZE;
+static const size_t kMaxWindowVecs = kMaxWindowSize / kExternalVecSize + 1;
+static const size_t kBounceBufferSize = 64 * 1024;
+
+
+/*!	A part of a file cache that is mapped and locked in the kernel, so that
+	it can be attached to net_buffers. Every vector handed to the stack holds
+	a reference; the mapping goes away with the last one.
+*/
+class SpliceWindow : public BReferenceable, public DeferredDeletable {
+public:
+								SpliceWindow();
+	virtual						~SpliceWindow();
+
+			status_t			Init(struct vnode* vnode, off_t offset,
+									size_t size);
+
+			uint8*				Address() const	{ return fAddress; }
+
+	static	void				ReleaseHook(void* cookie);
+
+protected:
+	virtual	void				LastReferenceReleased();
+
+private:
+			area_id				fArea;
+			uint8*				fAddress;
+			size_t				fSize;
+			bool				fLocked;
+};
+
+
+struct splice_end {
+	file_descriptor*	descriptor;
+	off_t				pos;
+		// -1 to use (and update) the descriptor's position
+	bool				nonBlocking;
+};
+
+
+SpliceWindow::SpliceWindow()
+	:
+	fArea(-1),
+	fAddress(NULL),
+	fSize(0),
+	fLocked(false)
+{
+}
+
+
+SpliceWindow::~SpliceWindow()
+{
+	if (fLocked) {
+		unlock_memory_etc(VMAddressSpace::KernelID(), fAddress, fSize,
+			B_READ_DEVICE);
+	}
+	if (fArea >= 0)
+		delete_area(fArea);
+}
+
+
+status_t
+SpliceWindow::Init(struct vnode* vnode, off_t offset, size_t size)
+{
+	void* address;
+	fArea = vm_map_vnode_cache("splice window", &address,
+		B_ANY_KERNEL_ADDRESS, size, vnode, offset);
+	if (fArea < 0)
+		return fArea;
+
+	fAddress = (uint8*)address;
+	fSize = PAGE_ALIGN(size);
+
+	// this reads in the pages, too
+	status_t status = lock_memory_etc(VMAddressSpace::KernelID(), fAddress,
+		fSize, B_READ_DEVICE);
+	if (status != B_OK)
+		return status;
+
+	fLocked = true;
+	return B_OK;
+}
+
+
+/*static*/ void
+SpliceWindow::ReleaseHook(void* cookie)
+{
+	((SpliceWindow*)cookie)->ReleaseReference();
+}
+
+
+void
+SpliceWindow::LastReferenceReleased()
+{
+	// The stack might release its references in any context; unmapping
+	// needs a thread that may block.
+	deferred_delete(this);
+}
+
+
+// #pragma mark - copying
+
+
+static inline void
+advance_position(splice_end& end, ssize_t bytes)
+{
+	if (end.pos != -1)
+		end.pos += bytes;
+}
+
+
+/*!	Reads from \a cookie's descriptor into the kernel buffer \a data. Used
+	directly as fifo_splice_hook, too.
+*/
+static ssize_t
+read_from_end(void* cookie, void* data, size_t length)
+{
+	splice_end& end = *(splice_end*)cookie;
+
+	ssize_t bytesRead;
+	if (fd_is_socket(end.descriptor)) {
+		bytesRead = socket_fd_recv(end.descriptor, data, length,
+			end.nonBlocking ? MSG_DONTWAIT : 0);
+	} else {
+		// The buffer is in the kernel; FIFOs and the like decide that by
+		// whether we have been called via syscall.
+		SyscallFlagUnsetter _;
+		iovec vec = { data, length };
+		bytesRead = fd_vector_io(end.descriptor, end.pos, &vec, 1, false,
+			end.nonBlocking);
+	}
+
+	if (bytesRead > 0)
+		advance_position(end, bytesRead);
+
+	return bytesRead;
+}
+
+
+/*!	Writes the kernel buffer \a data to \a cookie's descriptor. Used directly
+	as fifo_splice_hook, too.
+*/
+static ssize_t
+write_to_end(void* cookie, void* data, size_t length)
+{
+	splice_end& end = *(splice_end*)cookie;
+
+	ssize_t bytesWritten;
+	if (fd_is_socket(end.descriptor)) {
+		bytesWritten = socket_fd_send(end.descriptor, data, length,
+			end.nonBlocking ? MSG_DONTWAIT : 0);
+	} else {
+		SyscallFlagUnsetter _;
+		iovec vec = { data, length };
+		bytesWritten = fd_vector_io(end.descriptor, end.pos, &vec, 1, true,
+			end.nonBlocking);
+	}
+
+	if (bytesWritten > 0)
+		advance_position(end, bytesWritten);
+
+	return bytesWritten;
+}
+
+
+/*!	Copies the data through a bounce buffer. Stops at the first short read, so
+	that sockets and FIFOs only return what is already there.
+	If fewer bytes could be written than were read, a seekable source is
+	rewound by the difference; data from other sources is lost, as it would
+	be with the same read() and write() loop in userland.
+*/
+static ssize_t
+copy_data(splice_end& source, splice_end& target, size_t length)
+{
+	size_t bufferSize = std::min(length, kBounceBufferSize);
+	uint8* buffer = (uint8*)malloc(bufferSize);
+	if (buffer == NULL)
+		return B_NO_MEMORY;
+	MemoryDeleter bufferDeleter(buffer);
+
+	size_t transferred = 0;
+	status_t status = B_OK;
+
+	while (transferred < length) {
+		size_t toRead = std::min(length - transferred, bufferSize);
+		ssize_t bytesRead = read_from_end(&source, buffer, toRead);
+		if (bytesRead <= 0) {
+			status = bytesRead;
+			break;
+		}
+
+		ssize_t bytesWritten = 0;
+		while (bytesWritten < bytesRead) {
+			ssize_t written = write_to_end(&target, buffer + bytesWritten,
+				bytesRead - bytesWritten);
+			if (written <= 0) {
+				status = written < 0 ? written : B_IO_ERROR;
+				break;
+			}
+			bytesWritten += written;
+		}
+
+		transferred += bytesWritten;
+
+		if (bytesWritten < bytesRead) {
+			off_t unwritten = bytesRead - bytesWritten;
+			if (source.pos != -1)
+				source.pos -= unwritten;
+			else if (source.descriptor->pos != -1)
+				source.descriptor->pos -= unwritten;
+			break;
+		}
+
+		if ((size_t)bytesRead < toRead)
+			break;
+	}
+
+	if (transferred > 0)
+		return transferred;
+
+	return status;
+}
+
+
+// #pragma mark - zero copy
+
+
+/*!	Sends \a length bytes from \a pos of the file cache of \a vnode, without
+	crossing a window boundary.
+	Returns \c B_NOT_SUPPORTED if the socket cannot take external data.
+*/
+static ssize_t
+send_file_window(struct vnode* vnode, off_t pos, size_t length,
+	file_descriptor* socket, int flags)
+{
+	off_t windowOffset = ROUNDDOWN(pos, B_PAGE_SIZE);
+	size_t skip = pos - windowOffset;
+	size_t windowSize = skip + length;
+
+	SpliceWindow* window = new(std::nothrow) SpliceWindow;
+	if (window == NULL)
+		return B_NO_MEMORY;
+	BReference<SpliceWindow> windowReference(window, true);
+
+	status_t status = window->Init(vnode, windowOffset, windowSize);
+	if (status != B_OK)
+		return status;
+
+	// Cut the window into aligned pieces, so that the stack can let go of
+	// the beginning while the rest is still in flight.
+	iovec vecs[kMaxWindowVecs];
+	size_t count = 0;
+	for (size_t offset = skip; offset < windowSize; count++) {
+		size_t end = std::min(ROUNDDOWN(offset, kExternalVecSize)
+			+ kExternalVecSize, windowSize);
+		vecs[count].iov_base = window->Address() + offset;
+		vecs[count].iov_len = end - offset;
+		offset = end;
+
+		window->AcquireReference();
+	}
+
+	ssize_t bytesSent = socket_fd_send_external(socket, vecs, count, flags,
+		&SpliceWindow::ReleaseHook, window);
+	if (bytesSent == B_NOT_SUPPORTED) {
+		for (size_t i = 0; i < count; i++)
+			window->ReleaseReference();
+	}
+
+	TRACE("send_file_window(pos %" B_PRIdOFF ", length %" B_PRIuSIZE "): %"
+		B_PRIdSSIZE "\n", pos, length, bytesSent);
+
+	return bytesSent;
+}
+
+
+/*!	Sends up to \a length bytes of a regular file to a stream socket directly
+	from the file cache.
+	Returns \c B_NOT_SUPPORTED without having transferred anything, if this
+	is not possible for the given pair.
+*/
+static ssize_t
+send_file_cache(splice_end& source, splice_end& target, size_t length)
+{
+	struct vnode* vnode = fd_vnode(source.descriptor);
+
+	struct stat stat;
+	status_t status = vfs_stat_vnode(vnode, &stat);
+	if (status != B_OK)
+		return status;
+	if (!S_ISREG(stat.st_mode))
+		return B_NOT_SUPPORTED;
+
+	// Only use the cache if the file system already has one; we don't want
+	// to create one behind its back.
+	VMCache* cache;
+	if (vfs_get_vnode_cache(vnode, &cache, false) != B_OK)
+		return B_NOT_SUPPORTED;
+	cache->ReleaseRef();
+
+	off_t pos = source.pos != -1 ? source.pos : source.descriptor->pos;
+	if (pos >= stat.st_size)
+		return 0;
+	if ((off_t)length > stat.st_size - pos)
+		length = stat.st_size - pos;
+
+	int flags = target.nonBlocking ? MSG_DONTWAIT : 0;
+	size_t sent = 0;
+	ssize_t result = B_OK;
+
+	while (sent < length) {
+		off_t chunkPos = pos + sent;
+		size_t chunkSize = std::min(length - sent,
+			kMaxWindowSize - size_t(chunkPos % B_PAGE_SIZE));
+
+		result = send_file_window(vnode, chunkPos, chunkSize,
+			target.descriptor, flags);
+		if (result <= 0)
+			break;
+
+		sent += result;
+		if ((size_t)result < chunkSize)
+			break;
+	}
+
+	if (sent == 0)
+		return result;
+
+	if (source.pos != -1)
+		source.pos += sent;
+	else
+		source.descriptor->pos += sent;
+
+	return sent;
+}
+
+
+static ssize_t
+common_splice(splice_end& source, splice_end& target, size_t length)
+{
+	struct vnode* sourceVnode = fd_is_file(source.descriptor)
+		? fd_vnode(source.descriptor) : NULL;
+	struct vnode* targetVnode = fd_is_file(target.descriptor)
+		? fd_vnode(target.descriptor) : NULL;
+	bool sourceIsFIFO = sourceVnode != NULL && is_fifo_vnode(sourceVnode);
+	bool targetIsFIFO = targetVnode != NULL && is_fifo_vnode(targetVnode);
+
+	// Between two FIFOs, we would have to lock both, so we just copy.
+	if (sourceIsFIFO && !targetIsFIFO) {
+		size_t bytes = length;
+		status_t status = fifo_splice_read(sourceVnode,
+			source.descriptor->cookie, &bytes, source.nonBlocking,
+			&write_to_end, &target);
+		return bytes > 0 ? (ssize_t)bytes : status;
+	}
+
+	if (targetIsFIFO && !sourceIsFIFO) {
+		size_t bytes = length;
+		status_t status = fifo_splice_write(targetVnode,
+			target.descriptor->cookie, &bytes, target.nonBlocking,
+			&read_from_end, &source);
+		return bytes > 0 ? (ssize_t)bytes : status;
+	}
+
+	if (sourceVnode != NULL && fd_is_socket(target.descriptor)) {
+		ssize_t bytes = send_file_cache(source, target, length);
+		if (bytes != B_NOT_SUPPORTED)
+			return bytes;
+	}
+
+	return copy_data(source, target, length);
+}
+
+
+static status_t
+get_splice_offset(off_t* userOffset, off_t& _offset)
+{
+	if (userOffset == NULL) {
+		_offset = -1;
+		return B_OK;
+	}
+
+	if (!IS_USER_ADDRESS(userOffset)
+		|| user_memcpy(&_offset, userOffset, sizeof(off_t)) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+
+	return _offset >= 0 ? B_OK : B_BAD_VALUE;
+}
+
+
+// #pragma mark - syscalls
+
+
+ssize_t
+_user_splice(int inFD, off_t* userInOffset, int outFD, off_t* userOutOffset,
+	size_t length, uint32 flags)
+{
+	off_t inOffset;
+	off_t outOffset;
+	status_t status = get_splice_offset(userInOffset, inOffset);
+	if (status == B_OK)
+		status = get_splice_offset(userOutOffset, outOffset);
+	if (status != B_OK)
+		return status;
+
+	io_context* context = get_current_io_context(false);
+
+	file_descriptor* in = get_fd(context, inFD);
+	if (in == NULL)
+		return B_FILE_ERROR;
+	FileDescriptorPutter inPutter(in);
+
+	file_descriptor* out = get_fd(context, outFD);
+	if (out == NULL)
+		return B_FILE_ERROR;
+	FileDescriptorPutter outPutter(out);
+
+	if ((in->open_mode & O_RWMASK) == O_WRONLY
+		|| (out->open_mode & O_RWMASK) == O_RDONLY) {
+		return B_FILE_ERROR;
+	}
+
+	// explicit offsets are only allowed for seekable files
+	if ((userInOffset != NULL && in->pos == -1)
+		|| (userOutOffset != NULL && out->pos == -1)) {
+		return ESPIPE;
+	}
+
+	if (length > SSIZE_MAX)
+		length = SSIZE_MAX;
+	if (length == 0)
+		return 0;
+
+	bool nonBlocking = (flags & VFS_SPLICE_NONBLOCK) != 0;
+	splice_end source = { in, inOffset, nonBlocking };
+	splice_end target = { out, outOffset, nonBlocking };
+
+	SyscallRestartWrapper<ssize_t> result;
+	result = common_splice(source, target, length);
+	if (result <= 0)
+		return result;
+
+	if ((userInOffset != NULL && user_memcpy(userInOffset, &source.pos,
+				sizeof(off_t)) != B_OK)
+		|| (userOutOffset != NULL && user_memcpy(userOutOffset, &target.pos,
+				sizeof(off_t)) != B_OK)) {
+		return B_BAD_ADDRESS;
+	}
+
+	return result;
+}
@@ -46,6 +46,7 @@
 #include <KPath.h>
 #include <lock.h>
 #include <low_resource_manager.h>
+#include <rcu.h>
 #include <slab/Slab.h>
 #include <StackOrHeapArray.h>
 #include <syscalls.h>
@@ -246,9 +247,24 @@ static recursive_lock sMountOpLock;
 	The thread trying to acquire the lock must not hold sMountLock.
 	You must not hold this lock when calling create_sem(), as this might call
 	vfs_free_unused_vnodes() and thus cause a deadlock.
+
+	The path resolution fast path (cf. fast_path_to_vnode()) looks up vnodes
+	in sVnodeTable without this lock in an RCU read section. Hence vnodes that
+	have been in the table, as well as old tables, are freed only after an RCU
+	grace period.
 */
 static rw_lock sVnodeLock = RW_LOCK_INITIALIZER("vfs_vnode_lock");
 
+/*!	\brief Guards setting the vnodes' search permission flags.
+
+	sSearchPermissionGeneration is incremented whenever a vnode's flags are
+	reset, so that a permission check racing with a change doesn't set stale
+	flags.
+*/
+static mutex sSearchPermissionLock
+	= MUTEX_INITIALIZER("vfs search permission lock");
+static int32 sSearchPermissionGeneration = 0;
+
 /*!	\brief Guards io_context::root.
 
 	Must be held when setting or getting the io_context::root field.
@@ -295,7 +311,7 @@ struct VnodeHash {
 	}
 };
 
-typedef BOpenHashTable<VnodeHash> VnodeTable;
+typedef BOpenHashTable<VnodeHash, true, false, RCUMallocAllocator> VnodeTable;
 
 
 struct MountHash {
@@ -904,6 +920,25 @@ retry_busy_vnode(int32& tries, dev_t mountID, ino_t vnodeID)
 }
 
 
+static void
+free_vnode_object_callback(rcu_head* head)
+{
+	object_cache_free(sVnodeCache,
+		(uint8*)head - offsetof(struct vnode, rcu_link), 0);
+}
+
+
+/*!	Frees the memory of a vnode that has been in sVnodeTable. That is done
+	only after an RCU grace period, since unlocked lookups might still access
+	it.
+*/
+static void
+free_vnode_object(struct vnode* vnode)
+{
+	rcu_call(&vnode->rcu_link, &free_vnode_object_callback);
+}
+
+
 /*!	Creates a new vnode with the given mount and node ID.
 	If the node already exists, it is returned instead and no new node is
 	created. In either case -- but not, if an error occurs -- the function write
@@ -1032,7 +1067,7 @@ free_vnode(struct vnode* vnode, bool reenter)
 
 	remove_vnode_from_mount_list(vnode, vnode->mount);
 
-	object_cache_free(sVnodeCache, vnode, 0);
+	free_vnode_object(vnode);
 }
 
 
@@ -1256,7 +1291,7 @@ restart:
 			remove_vnode_from_mount_list(vnode, vnode->mount);
 			rw_lock_write_unlock(&sVnodeLock);
 
-			object_cache_free(sVnodeCache, vnode, 0);
+			free_vnode_object(vnode);
 			return status;
 		}
 
@@ -2094,6 +2129,170 @@ entry_ref_to_vnode(dev_t mountID, ino_t directoryID, const char* name,
 }
 
 
+/*!	Records whether everyone may search the directory \a vnode, i.e. whether
+	fast_path_to_vnode() may skip the access() check for it. Called when the
+	caller has just been granted search permission.
+*/
+static void
+update_search_permission(struct vnode* vnode)
+{
+	int32 generation = atomic_get(&sSearchPermissionGeneration);
+
+	bool searchable = true;
+	if (HAS_FS_CALL(vnode, access)) {
+		const mode_t kSearchBits = S_IXUSR | S_IXGRP | S_IXOTH;
+		struct stat stat;
+		searchable = HAS_FS_CALL(vnode, read_stat)
+			&& FS_CALL(vnode, read_stat, &stat) == B_OK
+			&& (stat.st_mode & kSearchBits) == kSearchBits;
+	}
+
+	MutexLocker locker(sSearchPermissionLock);
+	if (generation == sSearchPermissionGeneration)
+		vnode->SetSearchable(searchable);
+}
+
+
+/*!	Must be called after the stat data of \a vnode have been changed, so that
+	the search permission is checked again.
+*/
+static void
+search_permission_may_have_changed(struct vnode* vnode, uint32 statMask)
+{
+	if ((statMask & (B_STAT_MODE | B_STAT_UID | B_STAT_GID)) == 0)
+		return;
+
+	MutexLocker locker(sSearchPermissionLock);
+	sSearchPermissionGeneration++;
+	vnode->ResetSearchable();
+}
+
+
+/*!	Terminates the components of \a path like vnode_path_to_vnode() does
+	while walking it.
+*/
+static void
+terminate_path_components(char* path)
+{
+	char* next = strchr(path, '/');
+	while (next != NULL) {
+		*next++ = '\0';
+		while (*next == '/')
+			next++;
+		next = strchr(next, '/');
+	}
+}
+
+
+/*!	Tries to resolve \a path relative to \a start without taking any locks.
+
+	Only the entry caches and the vnodes already in sVnodeTable are consulted,
+	in an RCU read section. The function fails, if any component is not
+	cached, is "..", or is a symbolic link that would have to be traversed, if
+	any vnode on the way is busy, or if any directory isn't known to be
+	searchable by everyone. The caller has to fall back to the regular walk
+	in that case.
+
+	Other than vnode_path_to_vnode() the function neither releases the
+	reference to \a start nor modifies \a path, unless it succeeds.
+
+	\return \c true, if the path could be resolved. Then \a _vnode is set to
+		the found vnode, with a reference acquired, and \a _parentID to the
+		ID of the directory containing it.
+*/
+static bool
+fast_path_to_vnode(struct vnode* start, char* path, bool traverseLeafLink,
+	struct vnode*& _vnode, ino_t& _parentID)
+{
+	struct vnode_hash_key key;
+	ino_t parentID = start->id;
+
+	{
+		RCUReadLocker rcuLocker;
+
+		struct vnode* vnode = start;
+		const char* component = path;
+		char name[B_FILE_NAME_LENGTH];
+
+		while (*component != '\0') {
+			const char* end = component;
+			while (*end != '\0' && *end != '/')
+				end++;
+
+			size_t length = end - component;
+			bool directoryFound = *end == '/';
+			while (*end == '/')
+				end++;
+
+			if (length >= B_FILE_NAME_LENGTH
+				|| (length == 2 && component[0] == '.' && component[1] == '.')) {
+				return false;
+			}
+
+			if (!S_ISDIR(vnode->Type()) || !vnode->IsSearchable()
+				|| vnode->IsBusy()) {
+				return false;
+			}
+
+			if (length == 1 && component[0] == '.') {
+				parentID = vnode->id;
+				component = end;
+				continue;
+			}
+
+			memcpy(name, component, length);
+			name[length] = '\0';
+
+			key.device = vnode->device;
+			if (!vnode->mount->entry_cache.LookupUnlocked(vnode->id, name,
+					key.vnode)) {
+				return false;
+			}
+
+			struct vnode* nextVnode = sVnodeTable->LookupUnlocked(key);
+			if (nextVnode == NULL || nextVnode->IsBusy())
+				return false;
+
+			if (S_ISLNK(nextVnode->Type())
+				&& (traverseLeafLink || directoryFound)) {
+				return false;
+			}
+
+			parentID = vnode->id;
+			vnode = nextVnode;
+
+			// see if we hit a covered node
+			while (vnode->IsCovered()) {
+				vnode = atomic_pointer_get(&vnode->covered_by);
+				if (vnode == NULL)
+					return false;
+			}
+
+			component = end;
+		}
+
+		key.device = vnode->device;
+		key.vnode = vnode->id;
+	}
+
+	struct vnode* vnode;
+	if (get_vnode(key.device, key.vnode, &vnode, true, false) != B_OK)
+		return false;
+
+	// the node might have been covered in the meantime
+	if (Vnode* coveringNode = get_covering_vnode(vnode)) {
+		put_vnode(vnode);
+		vnode = coveringNode;
+	}
+
+	terminate_path_components(path);
+
+	_vnode = vnode;
+	_parentID = parentID;
+	return true;
+}
+
+
 /*!	Looks up the entry with name \a name in the directory represented by \a dir
 	and returns the respective vnode.
 	On success a reference to the vnode is acquired for the caller.
@@ -2167,6 +2366,18 @@ vnode_path_to_vnode(struct vnode* start, char* path, bool traverseLeafLink,
 	if (*path == '\0')
 		return B_ENTRY_NOT_FOUND;
 
+	if (count == 0) {
+		struct vnode* foundVnode;
+		ino_t parentID;
+		if (fast_path_to_vnode(start, path, traverseLeafLink, foundVnode,
+				parentID)) {
+			_vnode.SetTo(foundVnode);
+			if (_parentID != NULL)
+				*_parentID = parentID;
+			return B_OK;
+		}
+	}
+
 	status_t status = B_OK;
 	ino_t lastParentID = vnode->id;
 	while (true) {
@@ -2216,6 +2427,9 @@ vnode_path_to_vnode(struct vnode* start, char* path, bool traverseLeafLink,
 		if (status == B_OK && HAS_FS_CALL(vnode, access))
 			status = FS_CALL(vnode.Get(), access, X_OK);
 
+		if (status == B_OK && !vnode->IsSearchChecked())
+			update_search_permission(vnode.Get());
+
 		// Tell the filesystem to get the vnode of this path component (if we
 		// got the permission from the call above)
 		VnodePutter nextVnode;
@@ -2826,6 +3040,21 @@ fd_is_file(struct file_descriptor* descriptor)
 }
 
 
+/*!	Flushes the node of the descriptor to disk, as fsync() does. */
+status_t
+fd_sync(struct file_descriptor* descriptor)
+{
+	struct vnode* vnode = fd_vnode(descriptor);
+	if (vnode == NULL)
+		return B_FILE_ERROR;
+
+	if (!HAS_FS_CALL(vnode, fsync))
+		return B_UNSUPPORTED;
+
+	return FS_CALL_NO_PARAMS(vnode, fsync);
+}
+
+
 static int
 get_new_fd(struct fd_ops* ops, struct fs_mount* mount, struct vnode* vnode,
 	void* cookie, int openMode, bool kernel)
@@ -3820,7 +4049,7 @@ restart:
 			locker.Lock();
 			sVnodeTable->Remove(vnode);
 			remove_vnode_from_mount_list(vnode, vnode->mount);
-			object_cache_free(sVnodeCache, vnode, 0);
+			free_vnode_object(vnode);
 		}
 	} else {
 		// we still hold the write lock -- mark the node unbusy and published
@@ -4603,6 +4832,18 @@ vfs_unmount(dev_t mountID, uint32 flags)
 }
 
 
+/*!	Called by the node monitor when the stat data of a node have changed.
+*/
+void
+vfs_node_stat_changed(dev_t mountID, ino_t vnodeID, uint32 statFields)
+{
+	ReadLocker locker(sVnodeLock);
+
+	if (struct vnode* vnode = lookup_vnode(mountID, vnodeID))
+		search_permission_may_have_changed(vnode, statFields);
+}
+
+
 extern "C" status_t
 vfs_disconnect_vnode(dev_t mountID, ino_t vnodeID)
 {
@@ -6390,13 +6631,7 @@ common_sync(int fd, bool kernel)
 	if (!descriptor.IsSet())
 		return B_FILE_ERROR;
 
-	status_t status;
-	if (HAS_FS_CALL(vnode, fsync))
-		status = FS_CALL_NO_PARAMS(vnode, fsync);
-	else
-		status = B_UNSUPPORTED;
-
-	return status;
+	return fd_sync(descriptor.Get());
 }
 
 
@@ -6480,6 +6715,35 @@ common_preallocate(int fd, off_t offset, off_t length, bool kernel)
 }
 
 
+static status_t
+common_file_advice(int fd, off_t offset, off_t length, int advice, bool kernel)
+{
+	if (offset < 0 || length < 0)
+		return B_BAD_VALUE;
+
+	struct vnode* vnode;
+	FileDescriptorPutter descriptor(get_fd_and_vnode(fd, &vnode, kernel));
+	if (!descriptor.IsSet())
+		return B_FILE_ERROR;
+
+	if (S_ISFIFO(vnode->Type()) || S_ISSOCK(vnode->Type()))
+		return ESPIPE;
+	if (!S_ISREG(vnode->Type()))
+		return B_OK;
+
+	// Files that haven't been read or written yet don't have a cache; there
+	// is nothing to do for them either.
+	VMCache* cache;
+	if (vfs_get_vnode_cache(vnode, &cache, false) != B_OK)
+		return B_OK;
+
+	status_t status = cache_advise(cache, offset, length, advice);
+	cache->ReleaseRef();
+
+	return status;
+}
+
+
 static status_t
 common_read_link(int fd, char* path, char* buffer, size_t* _bufferSize,
 	bool kernel)
@@ -6680,7 +6944,11 @@ common_write_stat(struct file_descriptor* descriptor, const struct stat* stat,
 	if (!HAS_FS_CALL(vnode, write_stat))
 		return B_READ_ONLY_DEVICE;
 
-	return FS_CALL(vnode, write_stat, stat, statMask);
+	status_t status = FS_CALL(vnode, write_stat, stat, statMask);
+	if (status == B_OK)
+		search_permission_may_have_changed(vnode, statMask);
+
+	return status;
 }
 
 
@@ -6721,6 +6989,9 @@ common_path_write_stat(int fd, char* path, bool traverseLeafLink,
 	else
 		status = B_READ_ONLY_DEVICE;
 
+	if (status == B_OK)
+		search_permission_may_have_changed(vnode.Get(), statMask);
+
 	return status;
 }
 
@@ -7918,6 +8189,9 @@ fs_unmount(char* path, dev_t mountID, uint32 flags, bool kernel)
 		partition->Unregister();
 	}
 
+	// fast_path_to_vnode() might still be looking at the mount's entry cache
+	rcu_synchronize();
+
 	delete mount;
 	return B_OK;
 }
@@ -9316,6 +9590,13 @@ _user_preallocate(int fd, off_t offset, off_t length)
 }
 
 
+status_t
+_user_file_advice(int fd, off_t offset, off_t length, int advice)
+{
+	return common_file_advice(fd, offset, length, advice, false);
+}
+
+
 status_t
 _user_create_dir_entry_ref(dev_t device, ino_t inode, const char* userName,
 	int perms)
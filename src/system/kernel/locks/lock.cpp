@@ -12,7 +12,6 @@
 
 #if KDEBUG
 #define KDEBUG_STATIC static
-static status_t _mutex_lock(struct mutex* lock, void* locker);
 static void _mutex_unlock(struct mutex* lock);
 #else
 #define KDEBUG_STATIC
@@ -26,13 +25,21 @@ static void _mutex_unlock(struct mutex* lock);
 
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
+#include <cpu.h>
+#include <generic_syscall.h>
 #include <int.h>
 #include <kernel.h>
 #include <listeners.h>
+#include <lock_spin_stats.h>
+#include <lock_stats.h>
 #include <scheduling_analysis.h>
+#include <arch/debug.h>
+#include <smp.h>
 #include <thread.h>
 #include <util/AutoLock.h>
+#include <util/atomic.h>
 
 
 struct mutex_waiter {
@@ -50,6 +57,202 @@ struct rw_lock_waiter {
 
 #define MUTEX_FLAG_RELEASED		0x2
 
+// Default time (in microseconds) a contending thread may spin on a lock whose
+// holder is running, before it blocks.
+#define LOCK_DEFAULT_SPIN_BUDGET	20
+#define LOCK_MAX_SPIN_BUDGET		10000
+
+// Number of spin iterations between checks of the holder and the budget.
+#define LOCK_SPIN_CHECK_INTERVAL	32
+
+struct CACHE_LINE_ALIGN per_cpu_lock_spin_stats {
+	lock_spin_stats	stats;
+};
+
+static bigtime_t sLockSpinBudget = LOCK_DEFAULT_SPIN_BUDGET;
+static per_cpu_lock_spin_stats sLockSpinStats[SMP_MAX_CPUS];
+
+
+KDEBUG_STATIC status_t _mutex_lock(mutex* lock, void* locker);
+static status_t mutex_lock_etc(mutex* lock, uint32 statsType, addr_t caller);
+static status_t mutex_trylock_etc(mutex* lock, uint32 statsType,
+	addr_t caller);
+
+
+static inline void
+lock_spin_stats_add(int64 lock_spin_stats::* counter)
+{
+	atomic_add64(&(sLockSpinStats[smp_get_current_cpu()].stats.*counter), 1);
+}
+
+
+static void
+get_lock_spin_stats(lock_spin_stats& stats)
+{
+	memset(&stats, 0, sizeof(stats));
+	stats.spin_budget = atomic_get64(&sLockSpinBudget);
+
+	int32 cpuCount = smp_get_num_cpus();
+	for (int32 i = 0; i < cpuCount; i++) {
+		const lock_spin_stats& cpuStats = sLockSpinStats[i].stats;
+		stats.mutex_spin_acquired += cpuStats.mutex_spin_acquired;
+		stats.mutex_blocked += cpuStats.mutex_blocked;
+		stats.rw_lock_read_spin_acquired
+			+= cpuStats.rw_lock_read_spin_acquired;
+		stats.rw_lock_read_blocked += cpuStats.rw_lock_read_blocked;
+	}
+}
+
+
+/*!	Records the current thread as the owner of the lock, so that contending
+	threads can tell whether it is still running. Must only be called by the
+	new lock holder.
+	Like the inline fast paths in <lock.h>, this identifies the owner by an
+	address on its stack.
+*/
+template<typename Lock>
+static inline void
+lock_set_owner(Lock* lock)
+{
+	lock->owner_cpu = thread_get_current_thread()->cpu->cpu_num;
+	lock->owner_stack = __builtin_frame_address(0);
+}
+
+
+/*!	Returns whether  address lies on the kernel stack of  thread.
+*/
+static inline bool
+lock_is_on_stack(Thread* thread, const void* address)
+{
+	return thread != NULL && (addr_t)address >= thread->kernel_stack_base
+		&& (addr_t)address < thread->kernel_stack_top;
+}
+
+
+/*!	Returns the CPU the thread owning the given stack address is running on,
+	or -1 if it is not running.  cpuHint is checked first, all other CPUs
+	only if that fails.
+	The check is racy by nature and must only be used as a hint: the running
+	threads may change while we look at them.
+*/
+static int32
+lock_owner_running_cpu(const void* ownerStack, int32 cpuHint)
+{
+	if (ownerStack == NULL)
+		return -1;
+
+	int32 cpuCount = smp_get_num_cpus();
+	if (cpuHint >= 0 && cpuHint < cpuCount
+		&& lock_is_on_stack(atomic_pointer_get(&gCPU[cpuHint].running_thread),
+			ownerStack)) {
+		return cpuHint;
+	}
+
+	for (int32 i = 0; i < cpuCount; i++) {
+		if (i != cpuHint
+			&& lock_is_on_stack(atomic_pointer_get(&gCPU[i].running_thread),
+				ownerStack)) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+
+/*!	Common optimistic spinning loop of the mutex and rw_lock slow paths.
+	Spins while \a isAvailable returns \c false, the lock owner is running on
+	another CPU, nobody is blocked on the lock yet, and the spin budget has
+	not been used up.
+	Returns whether it actually spun, i.e. whether \a isAvailable returned
+	\c false at least once. Either way, the caller still has to claim the lock
+	the usual way.
+*/
+template<typename Lock, typename IsAvailable>
+static bool
+lock_spin_on_owner(Lock* lock, IsAvailable isAvailable)
+{
+	bigtime_t budget = atomic_get64(&sLockSpinBudget);
+	if (budget <= 0 || gKernelStartup || smp_get_num_cpus() < 2
+		|| !are_interrupts_enabled()) {
+		return false;
+	}
+
+	Thread* thread = thread_get_current_thread();
+	bigtime_t deadline = 0;
+	int32 ownerCPU = -1;
+
+	for (uint32 i = 0; ; i++) {
+		if (isAvailable(lock))
+			return i > 0;
+
+		// If others are blocked already, the lock will be handed over to them.
+		if (atomic_pointer_get(&lock->waiters) != NULL)
+			return i > 0;
+
+		if (i % LOCK_SPIN_CHECK_INTERVAL == 0) {
+			// The fast path doesn't know its CPU, so we remember where we
+			// found the owner last time and check that CPU first.
+			void* owner = atomic_pointer_get(&lock->owner_stack);
+			if (lock_is_on_stack(thread, owner))
+				return i > 0;
+			if (ownerCPU < 0)
+				ownerCPU = atomic_get(&lock->owner_cpu);
+			ownerCPU = lock_owner_running_cpu(owner, ownerCPU);
+			if (ownerCPU < 0)
+				return i > 0;
+
+			bigtime_t now = system_time();
+			if (deadline == 0)
+				deadline = now + budget;
+			else if (now >= deadline)
+				return true;
+		}
+
+		cpu_pause();
+	}
+}
+
+
+static inline bool
+mutex_is_released(mutex* lock)
+{
+#if KDEBUG
+	return atomic_get(&lock->holder) < 0;
+#else
+	return (*(volatile uint8*)&lock->flags & MUTEX_FLAG_RELEASED) != 0;
+#endif
+}
+
+
+/*!	Spins while the holder of the mutex is running, hoping that it releases
+	the lock soon. Must be called without holding the mutex's spinlock.
+	Returns whether it spun at all.
+*/
+static bool
+mutex_spin(mutex* lock)
+{
+	return lock_spin_on_owner(lock, &mutex_is_released);
+}
+
+
+static inline bool
+rw_lock_has_pending_readers(rw_lock* lock)
+{
+	return *(volatile int16*)&lock->pending_readers > 0;
+}
+
+
+/*!	Spins while the writer holding the rw_lock is running. Must be called by a
+	reader that has already announced itself in rw_lock::count.
+	Returns whether it spun at all.
+*/
+static bool
+rw_lock_read_spin(rw_lock* lock)
+{
+	return lock_spin_on_owner(lock, &rw_lock_has_pending_readers);
+}
+
 
 int32
 recursive_lock_get_recursion(recursive_lock *lock)
@@ -102,7 +305,8 @@ recursive_lock_lock(recursive_lock *lock)
 	thread_id thread = thread_get_current_thread_id();
 
 	if (thread != RECURSIVE_LOCK_HOLDER(lock)) {
-		mutex_lock(&lock->lock);
+		mutex_lock_etc(&lock->lock, LOCK_STATS_RECURSIVE_LOCK,
+			(addr_t)arch_debug_get_caller());
 #if !KDEBUG
 		lock->holder = thread;
 #endif
@@ -126,7 +330,8 @@ recursive_lock_trylock(recursive_lock *lock)
 #endif
 
 	if (thread != RECURSIVE_LOCK_HOLDER(lock)) {
-		status_t status = mutex_trylock(&lock->lock);
+		status_t status = mutex_trylock_etc(&lock->lock,
+			LOCK_STATS_RECURSIVE_LOCK, (addr_t)arch_debug_get_caller());
 		if (status != B_OK)
 			return status;
 
@@ -344,6 +549,7 @@ rw_lock_unblock(rw_lock* lock)
 			lock->waiters->last = waiter->last;
 
 		lock->holder = waiter->thread->id;
+		lock->owner_stack = NULL;
 
 		// unblock thread
 		thread_unblock(waiter->thread, B_OK);
@@ -387,6 +593,8 @@ rw_lock_init(rw_lock* lock, const char* name)
 	lock->active_readers = 0;
 	lock->pending_readers = 0;
 	lock->flags = 0;
+	lock->owner_cpu = -1;
+	lock->owner_stack = NULL;
 
 	T_SCHEDULING_ANALYSIS(InitRWLock(lock, name));
 	NotifyWaitObjectListeners(&WaitObjectListener::RWLockInitialized, lock);
@@ -405,6 +613,8 @@ rw_lock_init_etc(rw_lock* lock, const char* name, uint32 flags)
 	lock->active_readers = 0;
 	lock->pending_readers = 0;
 	lock->flags = flags & RW_LOCK_FLAG_CLONE_NAME;
+	lock->owner_cpu = -1;
+	lock->owner_stack = NULL;
 
 	T_SCHEDULING_ANALYSIS(InitRWLock(lock, name));
 	NotifyWaitObjectListeners(&WaitObjectListener::RWLockInitialized, lock);
@@ -500,6 +710,21 @@ _rw_lock_unset_read_locked(rw_lock* lock)
 #endif
 
 
+/*!	Records a contended read lock acquisition. Uncontended ones are handled
+	inline in rw_lock_read_lock() and are not accounted for.
+*/
+static inline void
+rw_lock_read_stats_acquired(rw_lock* lock, nanotime_t startTime,
+	void* caller)
+{
+	if (startTime == 0)
+		return;
+
+	lock_stats_acquired(LOCK_STATS_RW_LOCK_READ, lock, lock->name,
+		(addr_t)caller, system_time_nsecs() - startTime, true);
+}
+
+
 status_t
 _rw_lock_read_lock(rw_lock* lock)
 {
@@ -518,6 +743,11 @@ _rw_lock_read_lock(rw_lock* lock)
 	}
 #endif
 
+	nanotime_t startTime = gLockStatsEnabled != 0 ? system_time_nsecs() : 0;
+
+	// Give a running writer the chance to finish before we block.
+	bool spun = rw_lock_read_spin(lock);
+
 	InterruptsSpinLocker locker(lock->lock);
 
 	// We might be the writer ourselves.
@@ -540,6 +770,9 @@ _rw_lock_read_lock(rw_lock* lock)
 		if (lock->count >= RW_LOCK_WRITER_COUNT_BASE)
 			lock->active_readers++;
 
+		if (spun)
+			lock_spin_stats_add(&lock_spin_stats::rw_lock_read_spin_acquired);
+		rw_lock_read_stats_acquired(lock, startTime, arch_debug_get_caller());
 #if KDEBUG_RW_LOCK_DEBUG
 		_rw_lock_set_read_locked(lock);
 #endif
@@ -549,7 +782,10 @@ _rw_lock_read_lock(rw_lock* lock)
 	ASSERT(lock->count >= RW_LOCK_WRITER_COUNT_BASE);
 
 	// we need to wait
+	lock_spin_stats_add(&lock_spin_stats::rw_lock_read_blocked);
 	status_t status = rw_lock_wait(lock, false, locker);
+	if (status == B_OK)
+		rw_lock_read_stats_acquired(lock, startTime, arch_debug_get_caller());
 
 #if KDEBUG_RW_LOCK_DEBUG
 	if (status == B_OK)
@@ -579,6 +815,11 @@ _rw_lock_read_lock_with_timeout(rw_lock* lock, uint32 timeoutFlags,
 	}
 #endif
 
+	nanotime_t startTime = gLockStatsEnabled != 0 ? system_time_nsecs() : 0;
+
+	// Give a running writer the chance to finish before we block.
+	bool spun = rw_lock_read_spin(lock);
+
 	InterruptsSpinLocker locker(lock->lock);
 
 	// We might be the writer ourselves.
@@ -599,6 +840,9 @@ _rw_lock_read_lock_with_timeout(rw_lock* lock, uint32 timeoutFlags,
 		if (lock->count >= RW_LOCK_WRITER_COUNT_BASE)
 			lock->active_readers++;
 
+		if (spun)
+			lock_spin_stats_add(&lock_spin_stats::rw_lock_read_spin_acquired);
+		rw_lock_read_stats_acquired(lock, startTime, arch_debug_get_caller());
 #if KDEBUG_RW_LOCK_DEBUG
 		_rw_lock_set_read_locked(lock);
 #endif
@@ -626,10 +870,12 @@ _rw_lock_read_lock_with_timeout(rw_lock* lock, uint32 timeoutFlags,
 	thread_prepare_to_block(waiter.thread, 0, THREAD_BLOCK_TYPE_RW_LOCK, lock);
 	locker.Unlock();
 
+	lock_spin_stats_add(&lock_spin_stats::rw_lock_read_blocked);
 	status_t error = thread_block_with_timeout(timeoutFlags, timeout);
 	if (error == B_OK || waiter.thread == NULL) {
 		// We were unblocked successfully -- potentially our unblocker overtook
 		// us after we already failed. In either case, we've got the lock, now.
+		rw_lock_read_stats_acquired(lock, startTime, arch_debug_get_caller());
 #if KDEBUG_RW_LOCK_DEBUG
 		_rw_lock_set_read_locked(lock);
 #endif
@@ -716,6 +962,8 @@ rw_lock_write_lock(rw_lock* lock)
 	}
 #endif
 
+	nanotime_t startTime = gLockStatsEnabled != 0 ? system_time_nsecs() : 0;
+
 	InterruptsSpinLocker locker(lock->lock);
 
 	// If we're already the lock holder, we just need to increment the owner
@@ -735,6 +983,13 @@ rw_lock_write_lock(rw_lock* lock)
 		// No-one else held a read or write lock, so it's ours now.
 		lock->holder = thread;
 		lock->owner_count = RW_LOCK_WRITER_COUNT_BASE;
+		lock_set_owner(lock);
+
+		if (startTime != 0) {
+			lock_stats_acquired(LOCK_STATS_RW_LOCK_WRITE, lock, lock->name,
+				(addr_t)arch_debug_get_caller(),
+				system_time_nsecs() - startTime, false);
+		}
 		return B_OK;
 	}
 
@@ -747,6 +1002,13 @@ rw_lock_write_lock(rw_lock* lock)
 	if (status == B_OK) {
 		lock->holder = thread;
 		lock->owner_count = RW_LOCK_WRITER_COUNT_BASE;
+		lock_set_owner(lock);
+
+		if (startTime != 0) {
+			lock_stats_acquired(LOCK_STATS_RW_LOCK_WRITE, lock, lock->name,
+				(addr_t)arch_debug_get_caller(),
+				system_time_nsecs() - startTime, true);
+		}
 	}
 
 	return status;
@@ -770,10 +1032,13 @@ _rw_lock_write_unlock(rw_lock* lock)
 	if (lock->owner_count >= RW_LOCK_WRITER_COUNT_BASE)
 		return;
 
+	lock_stats_released(lock);
+
 	// We gave up our last write lock -- clean up and unblock waiters.
 	int32 readerCount = lock->owner_count;
 	lock->holder = -1;
 	lock->owner_count = 0;
+	lock->owner_stack = NULL;
 
 #if KDEBUG_RW_LOCK_DEBUG
 	if (readerCount != 0)
@@ -862,6 +1127,8 @@ mutex_init_etc(mutex* lock, const char *name, uint32 flags)
 	lock->count = 0;
 #endif
 	lock->flags = flags & MUTEX_FLAG_CLONE_NAME;
+	lock->owner_cpu = -1;
+	lock->owner_stack = NULL;
 
 	T_SCHEDULING_ANALYSIS(InitMutex(lock, name));
 	NotifyWaitObjectListeners(&WaitObjectListener::MutexInitialized, lock);
@@ -919,6 +1186,8 @@ mutex_lock_threads_locked(mutex* lock, InterruptsSpinLocker* locker)
 #else
 	if (atomic_add(&lock->count, -1) < 0)
 		return _mutex_lock(lock, locker);
+
+	lock_set_owner(lock);
 	return B_OK;
 #endif
 }
@@ -950,6 +1219,7 @@ mutex_transfer_lock(mutex* lock, thread_id thread)
 		panic("mutex_transfer_lock(): current thread is not the lock holder!");
 	lock->holder = thread;
 #endif
+	lock->owner_stack = NULL;
 }
 
 
@@ -986,7 +1256,12 @@ _mutex_lock(mutex* lock, void* _locker)
 		= reinterpret_cast<InterruptsSpinLocker*>(_locker);
 
 	InterruptsSpinLocker lockLocker;
+	bool spun = false;
 	if (locker == NULL) {
+		// Unless we have to wait atomically with releasing another lock, try
+		// to avoid blocking while the holder is still busy on another CPU.
+		spun = mutex_spin(lock);
+
 		lockLocker.SetTo(lock->lock, false);
 		locker = &lockLocker;
 	}
@@ -996,6 +1271,9 @@ _mutex_lock(mutex* lock, void* _locker)
 #if KDEBUG
 	if (lock->holder < 0) {
 		lock->holder = thread_get_current_thread_id();
+		lock_set_owner(lock);
+		if (spun)
+			lock_spin_stats_add(&lock_spin_stats::mutex_spin_acquired);
 		return B_OK;
 	} else if (lock->holder == thread_get_current_thread_id()) {
 		panic("_mutex_lock(): double lock of %p by thread %" B_PRId32, lock,
@@ -1006,6 +1284,9 @@ _mutex_lock(mutex* lock, void* _locker)
 #else
 	if ((lock->flags & MUTEX_FLAG_RELEASED) != 0) {
 		lock->flags &= ~MUTEX_FLAG_RELEASED;
+		lock_set_owner(lock);
+		if (spun)
+			lock_spin_stats_add(&lock_spin_stats::mutex_spin_acquired);
 		return B_OK;
 	}
 #endif
@@ -1026,15 +1307,17 @@ _mutex_lock(mutex* lock, void* _locker)
 	thread_prepare_to_block(waiter.thread, 0, THREAD_BLOCK_TYPE_MUTEX, lock);
 	locker->Unlock();
 
+	lock_spin_stats_add(&lock_spin_stats::mutex_blocked);
 	status_t error = thread_block();
-#if KDEBUG
 	if (error == B_OK) {
+#if KDEBUG
 		ASSERT(lock->holder == waiter.thread->id);
+#endif
+		lock_set_owner(lock);
 	} else {
 		// This should only happen when the mutex was destroyed.
 		ASSERT(waiter.thread == NULL);
 	}
-#endif
 	return error;
 }
 
@@ -1067,6 +1350,7 @@ _mutex_unlock(mutex* lock)
 		// is not held by anyone.
 		lock->holder = waiter->thread->id;
 #endif
+		lock->owner_stack = NULL;
 
 		// unblock thread
 		thread_unblock(waiter->thread, B_OK);
@@ -1091,6 +1375,8 @@ _mutex_lock_with_timeout(mutex* lock, uint32 timeoutFlags, bigtime_t timeout)
 	}
 #endif
 
+	bool spun = mutex_spin(lock);
+
 	InterruptsSpinLocker locker(lock->lock);
 
 	// Might have been released after we decremented the count, but before
@@ -1098,6 +1384,9 @@ _mutex_lock_with_timeout(mutex* lock, uint32 timeoutFlags, bigtime_t timeout)
 #if KDEBUG
 	if (lock->holder < 0) {
 		lock->holder = thread_get_current_thread_id();
+		lock_set_owner(lock);
+		if (spun)
+			lock_spin_stats_add(&lock_spin_stats::mutex_spin_acquired);
 		return B_OK;
 	} else if (lock->holder == thread_get_current_thread_id()) {
 		panic("_mutex_lock(): double lock of %p by thread %" B_PRId32, lock,
@@ -1108,6 +1397,9 @@ _mutex_lock_with_timeout(mutex* lock, uint32 timeoutFlags, bigtime_t timeout)
 #else
 	if ((lock->flags & MUTEX_FLAG_RELEASED) != 0) {
 		lock->flags &= ~MUTEX_FLAG_RELEASED;
+		lock_set_owner(lock);
+		if (spun)
+			lock_spin_stats_add(&lock_spin_stats::mutex_spin_acquired);
 		return B_OK;
 	}
 #endif
@@ -1128,12 +1420,14 @@ _mutex_lock_with_timeout(mutex* lock, uint32 timeoutFlags, bigtime_t timeout)
 	thread_prepare_to_block(waiter.thread, 0, THREAD_BLOCK_TYPE_MUTEX, lock);
 	locker.Unlock();
 
+	lock_spin_stats_add(&lock_spin_stats::mutex_blocked);
 	status_t error = thread_block_with_timeout(timeoutFlags, timeout);
 
 	if (error == B_OK) {
 #if KDEBUG
 		ASSERT(lock->holder == waiter.thread->id);
 #endif
+		lock_set_owner(lock);
 	} else {
 		// If the lock was destroyed, our "thread" entry will be NULL.
 		if (waiter.thread == NULL)
@@ -1174,6 +1468,7 @@ _mutex_lock_with_timeout(mutex* lock, uint32 timeoutFlags, bigtime_t timeout)
 #if KDEBUG
 			ASSERT(lock->holder == waiter.thread->id);
 #endif
+			lock_set_owner(lock);
 			return B_OK;
 		}
 	}
@@ -1182,43 +1477,168 @@ _mutex_lock_with_timeout(mutex* lock, uint32 timeoutFlags, bigtime_t timeout)
 }
 
 
-#undef mutex_trylock
-status_t
-mutex_trylock(mutex* lock)
+static status_t
+mutex_trylock_etc(mutex* lock, uint32 statsType, addr_t caller)
 {
 #if KDEBUG
-	InterruptsSpinLocker _(lock->lock);
+	InterruptsSpinLocker locker(lock->lock);
 
 	if (lock->holder < 0) {
 		lock->holder = thread_get_current_thread_id();
+		lock_set_owner(lock);
+		locker.Unlock();
+
+		lock_stats_acquired(statsType, lock, lock->name, caller, 0, false);
 		return B_OK;
 	} else if (lock->holder == 0) {
 		panic("_mutex_trylock(): using uninitialized lock %p", lock);
 	}
 	return B_WOULD_BLOCK;
 #else
-	return mutex_trylock_inline(lock);
+	if (atomic_test_and_set(&lock->count, -1, 0) != 0)
+		return B_WOULD_BLOCK;
+
+	lock_set_owner(lock);
+	lock_stats_acquired(statsType, lock, lock->name, caller, 0, false);
+	return B_OK;
 #endif
 }
 
 
-#undef mutex_lock
-status_t
-mutex_lock(mutex* lock)
+/*!	The slow variant of mutex_lock_etc(), used while lock statistics are
+	being collected.
+*/
+static status_t
+mutex_lock_with_stats(mutex* lock, uint32 statsType, addr_t caller)
+{
+	nanotime_t startTime = system_time_nsecs();
+
+#if KDEBUG
+	// only a hint, the holder might change before we get the spinlock
+	bool contended = atomic_get(&lock->holder) >= 0;
+	status_t status = _mutex_lock(lock, NULL);
+#else
+	status_t status = B_OK;
+	bool contended = atomic_add(&lock->count, -1) < 0;
+	if (contended)
+		status = _mutex_lock(lock, NULL);
+	else
+		lock_set_owner(lock);
+#endif
+
+	if (status == B_OK) {
+		lock_stats_acquired(statsType, lock, lock->name, caller,
+			system_time_nsecs() - startTime, contended);
+	}
+
+	return status;
+}
+
+
+static status_t
+mutex_lock_etc(mutex* lock, uint32 statsType, addr_t caller)
 {
+	if (gLockStatsEnabled != 0)
+		return mutex_lock_with_stats(lock, statsType, caller);
+
 #if KDEBUG
 	return _mutex_lock(lock, NULL);
 #else
-	return mutex_lock_inline(lock);
+	if (atomic_add(&lock->count, -1) < 0)
+		return _mutex_lock(lock, NULL);
+
+	lock_set_owner(lock);
+	return B_OK;
 #endif
 }
 
 
+static status_t
+mutex_lock_with_timeout_etc(mutex* lock, uint32 timeoutFlags,
+	bigtime_t timeout, addr_t caller)
+{
+	nanotime_t startTime = gLockStatsEnabled != 0 ? system_time_nsecs() : 0;
+
+#if KDEBUG
+	// only a hint, the holder might change before we get the spinlock
+	bool contended = atomic_get(&lock->holder) >= 0;
+	status_t status = _mutex_lock_with_timeout(lock, timeoutFlags, timeout);
+#else
+	status_t status = B_OK;
+	bool contended = atomic_add(&lock->count, -1) < 0;
+	if (contended)
+		status = _mutex_lock_with_timeout(lock, timeoutFlags, timeout);
+	else
+		lock_set_owner(lock);
+#endif
+
+	if (startTime != 0 && status == B_OK) {
+		lock_stats_acquired(LOCK_STATS_MUTEX, lock, lock->name, caller,
+			system_time_nsecs() - startTime, contended);
+	}
+
+	return status;
+}
+
+
+#if !KDEBUG
+
+
+/*!	Called by the inline mutex_lock() while lock statistics are being
+	collected. The same goes for the following two functions.
+*/
+status_t
+_mutex_lock_stats(mutex* lock)
+{
+	return mutex_lock_etc(lock, LOCK_STATS_MUTEX,
+		(addr_t)arch_debug_get_caller());
+}
+
+
+status_t
+_mutex_trylock_stats(mutex* lock)
+{
+	return mutex_trylock_etc(lock, LOCK_STATS_MUTEX,
+		(addr_t)arch_debug_get_caller());
+}
+
+
+status_t
+_mutex_lock_with_timeout_stats(mutex* lock, uint32 timeoutFlags,
+	bigtime_t timeout)
+{
+	return mutex_lock_with_timeout_etc(lock, timeoutFlags, timeout,
+		(addr_t)arch_debug_get_caller());
+}
+
+
+#endif	// !KDEBUG
+
+
+#undef mutex_trylock
+status_t
+mutex_trylock(mutex* lock)
+{
+	return mutex_trylock_etc(lock, LOCK_STATS_MUTEX,
+		(addr_t)arch_debug_get_caller());
+}
+
+
+#undef mutex_lock
+status_t
+mutex_lock(mutex* lock)
+{
+	return mutex_lock_etc(lock, LOCK_STATS_MUTEX,
+		(addr_t)arch_debug_get_caller());
+}
+
+
 #undef mutex_unlock
 void
 mutex_unlock(mutex* lock)
 {
 #if KDEBUG
+	lock_stats_released(lock);
 	_mutex_unlock(lock);
 #else
 	mutex_unlock_inline(lock);
@@ -1230,11 +1650,24 @@ mutex_unlock(mutex* lock)
 status_t
 mutex_lock_with_timeout(mutex* lock, uint32 timeoutFlags, bigtime_t timeout)
 {
-#if KDEBUG
-	return _mutex_lock_with_timeout(lock, timeoutFlags, timeout);
-#else
-	return mutex_lock_with_timeout_inline(lock, timeoutFlags, timeout);
-#endif
+	return mutex_lock_with_timeout_etc(lock, timeoutFlags, timeout,
+		(addr_t)arch_debug_get_caller());
+}
+
+
+static void
+dump_lock_spin_stats()
+{
+	lock_spin_stats stats;
+	get_lock_spin_stats(stats);
+
+	kprintf("adaptive spinning (budget %" B_PRIdBIGTIME " us):\n",
+		stats.spin_budget);
+	kprintf("  mutex:    %" B_PRId64 " acquired after spinning, %" B_PRId64
+		" blocked\n", stats.mutex_spin_acquired, stats.mutex_blocked);
+	kprintf("  rw_lock:  %" B_PRId64 " read locks acquired after spinning, %"
+		B_PRId64 " blocked\n", stats.rw_lock_read_spin_acquired,
+		stats.rw_lock_read_blocked);
 }
 
 
@@ -1246,6 +1679,11 @@ dump_mutex_info(int argc, char** argv)
 		return 0;
 	}
 
+	if (strcmp(argv[1], "-s") == 0) {
+		dump_lock_spin_stats();
+		return 0;
+	}
+
 	mutex* lock = (mutex*)parse_expression(argv[1]);
 
 	if (!IS_KERNEL_ADDRESS(lock)) {
@@ -1261,6 +1699,8 @@ dump_mutex_info(int argc, char** argv)
 #else
 	kprintf("  count:           %" B_PRId32 "\n", lock->count);
 #endif
+	kprintf("  owner stack:     %p (cpu %" B_PRId32 ")\n", lock->owner_stack,
+		lock->owner_cpu);
 
 	kprintf("  waiting threads:");
 	mutex_waiter* waiter = lock->waiters;
@@ -1274,6 +1714,51 @@ dump_mutex_info(int argc, char** argv)
 }
 
 
+static status_t
+lock_spin_stats_syscall(const char* subsystem, uint32 function,
+	void* buffer, size_t bufferSize)
+{
+	switch (function) {
+		case GET_LOCK_SPIN_STATS:
+		{
+			if (bufferSize < sizeof(lock_spin_stats))
+				return B_BAD_VALUE;
+
+			lock_spin_stats stats;
+			get_lock_spin_stats(stats);
+
+			if (!IS_USER_ADDRESS(buffer)
+				|| user_memcpy(buffer, &stats, sizeof(stats)) != B_OK) {
+				return B_BAD_ADDRESS;
+			}
+			return B_OK;
+		}
+
+		case SET_LOCK_SPIN_BUDGET:
+		{
+			if (geteuid() != 0)
+				return B_NOT_ALLOWED;
+
+			bigtime_t budget;
+			if (bufferSize != sizeof(budget))
+				return B_BAD_VALUE;
+			if (!IS_USER_ADDRESS(buffer)
+				|| user_memcpy(&budget, buffer, sizeof(budget)) != B_OK) {
+				return B_BAD_ADDRESS;
+			}
+
+			if (budget < 0 || budget > LOCK_MAX_SPIN_BUDGET)
+				return B_BAD_VALUE;
+
+			atomic_set64(&sLockSpinBudget, budget);
+			return B_OK;
+		}
+	}
+
+	return B_BAD_VALUE;
+}
+
+
 // #pragma mark -
 
 
@@ -1282,9 +1767,11 @@ lock_debug_init()
 {
 	add_debugger_command_etc("mutex", &dump_mutex_info,
 		"Dump info about a mutex",
-		"<mutex>\n"
+		"( <mutex> | -s )\n"
 		"Prints info about the specified mutex.\n"
-		"  <mutex>  - pointer to the mutex to print the info for.\n", 0);
+		"  <mutex>  - pointer to the mutex to print the info for.\n"
+		"  -s       - print the adaptive spinning statistics of all mutexes\n"
+		"             and rw_locks instead.\n", 0);
 	add_debugger_command_etc("rwlock", &dump_rw_lock_info,
 		"Dump info about an rw lock",
 		"<lock>\n"
@@ -1297,3 +1784,11 @@ lock_debug_init()
 		"  <lock>  - pointer to the recursive lock to print the info for.\n",
 		0);
 }
+
+
+status_t
+lock_init_post_generic_syscalls()
+{
+	return register_generic_syscall(LOCK_SPIN_STATS, &lock_spin_stats_syscall,
+		1, 0);
+}
@@ -0,0 +1,427 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Runtime lock contention statistics.
+
+	When enabled, the locking primitives report acquisitions, the time spent
+	waiting for the lock and, for locks that have a single owner, the time the
+	lock was held. The events are aggregated per lock identity and call site
+	into per-CPU tables, so that recording doesn't need any global lock. The
+	tables are drained (and reset) via the generic syscall, which is what the
+	"lockstat" tool does.
+
+	Named locks are identified by a hash of their name string, so that e.g.
+	all vnode locks end up in the same entry, even when their names have been
+	cloned; spinlocks, which don't have a name, and unnamed locks are
+	identified by their address. Entries report which key was used.
+*/
+
+
+#include <lock_stats.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cpu.h>
+#include <elf.h>
+#include <generic_syscall.h>
+#include <int.h>
+#include <kernel.h>
+#include <lock.h>
+#include <smp.h>
+#include <thread.h>
+#include <util/AutoLock.h>
+
+
+// number of entries in each CPU's table, must be a power of two
+#define LOCK_STATS_TABLE_SIZE		256
+	// The table is considered full when three quarters are used, to keep the
+	// probe sequences short.
+#define LOCK_STATS_TABLE_MAX_USED	(LOCK_STATS_TABLE_SIZE * 3 / 4)
+
+
+struct lock_stats_table {
+	lock_stats_entry	entries[LOCK_STATS_TABLE_SIZE];
+	int32				used;
+	int32				dropped;
+} CACHE_LINE_ALIGN;
+
+
+int32 gLockStatsEnabled = 0;
+
+static lock_stats_table* sTables = NULL;
+static int32 sTableCount = 0;
+static mutex sLockStatsLock = MUTEX_INITIALIZER("lock stats");
+
+
+static inline uint32
+lock_stats_hash(uint32 type, addr_t identity, addr_t caller)
+{
+	uint64 hash = (uint64)identity * 0x9e3779b97f4a7c15ULL;
+	hash ^= (uint64)caller * 0xc2b2ae3d27d4eb4fULL;
+	hash ^= type;
+	return (uint32)(hash >> 32);
+}
+
+
+/*!	Returns the identity of a lock named \a name: the FNV-1a hash of the
+	string, which is never 0, as that marks unused entries.
+*/
+static inline addr_t
+lock_stats_name_identity(const char* name)
+{
+	uint64 hash = 0xcbf29ce484222325ULL;
+	for (int32 i = 0; i < B_OS_NAME_LENGTH - 1 && name[i] != '\0'; i++) {
+		hash ^= (uint8)name[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	addr_t identity = (addr_t)hash;
+	return identity != 0 ? identity : 1;
+}
+
+
+static inline int32
+lock_stats_histogram_bucket(nanotime_t waitTime)
+{
+	int32 bucket = 0;
+	waitTime >>= LOCK_STATS_HISTOGRAM_SHIFT;
+	while (waitTime > 0 && bucket < LOCK_STATS_HISTOGRAM_BUCKETS - 1) {
+		waitTime >>= 1;
+		bucket++;
+	}
+
+	return bucket;
+}
+
+
+/*!	Returns the current CPU's entry for the given key, creating it, if it
+	doesn't exist yet. Returns \c NULL, if the table is full.
+	Interrupts must be disabled.
+*/
+static lock_stats_entry*
+lock_stats_lookup(uint32 type, uint32 key, addr_t identity, const char* name,
+	addr_t caller)
+{
+	int32 cpu = smp_get_current_cpu();
+	if (sTables == NULL || cpu >= sTableCount)
+		return NULL;
+
+	lock_stats_table& table = sTables[cpu];
+
+	uint32 index = lock_stats_hash(type, identity, caller)
+		& (LOCK_STATS_TABLE_SIZE - 1);
+	while (true) {
+		lock_stats_entry* entry = &table.entries[index];
+		if (entry->lock == identity && entry->caller_address == caller
+			&& entry->type == type && entry->key == key
+			&& (key != LOCK_STATS_KEY_NAME
+				|| strncmp(entry->name, name, sizeof(entry->name) - 1) == 0)) {
+			return entry;
+		}
+
+		if (entry->lock == 0)
+			break;
+
+		index = (index + 1) & (LOCK_STATS_TABLE_SIZE - 1);
+	}
+
+	if (table.used >= LOCK_STATS_TABLE_MAX_USED) {
+		table.dropped++;
+		return NULL;
+	}
+
+	table.used++;
+
+	lock_stats_entry* entry = &table.entries[index];
+	entry->lock = identity;
+	entry->caller_address = caller;
+	entry->type = type;
+	entry->key = key;
+	if (name != NULL)
+		strlcpy(entry->name, name, sizeof(entry->name));
+
+	return entry;
+}
+
+
+static void
+lock_stats_push_held(Thread* thread, uint32 type, uint32 key, const void* lock,
+	addr_t identity, const char* name, addr_t caller, nanotime_t now)
+{
+	// Use a free slot, or else replace the oldest one -- it most likely
+	// belongs to a lock that was transferred to another thread.
+	lock_stats_held_lock* slot = &thread->held_locks[0];
+	for (int32 i = 0; i < LOCK_STATS_MAX_HELD_LOCKS; i++) {
+		lock_stats_held_lock* held = &thread->held_locks[i];
+		if (held->lock == NULL) {
+			slot = held;
+			break;
+		}
+		if (held->acquired < slot->acquired)
+			slot = held;
+	}
+
+	slot->lock = lock;
+	slot->identity = identity;
+	slot->name = name;
+	slot->caller = caller;
+	slot->acquired = now;
+	slot->type = type;
+	slot->key = key;
+}
+
+
+static void
+lock_stats_quiesce(void* /*cookie*/, int /*cpu*/)
+{
+	// Nothing to do: once this has been executed on all CPUs, no CPU can be
+	// in the middle of recording an event anymore, since that happens with
+	// interrupts disabled.
+}
+
+
+static status_t
+lock_stats_enable()
+{
+	MutexLocker locker(sLockStatsLock);
+
+	if (sTables == NULL) {
+		int32 cpuCount = smp_get_num_cpus();
+		lock_stats_table* tables = (lock_stats_table*)memalign(
+			CACHE_LINE_SIZE, sizeof(lock_stats_table) * cpuCount);
+		if (tables == NULL)
+			return B_NO_MEMORY;
+
+		memset(tables, 0, sizeof(lock_stats_table) * cpuCount);
+		sTableCount = cpuCount;
+		sTables = tables;
+	}
+
+	atomic_set(&gLockStatsEnabled, 1);
+	return B_OK;
+}
+
+
+static void
+lock_stats_resolve_symbols(lock_stats_entry* entry)
+{
+	char symbol[LOCK_STATS_SYMBOL_LENGTH];
+	addr_t baseAddress;
+	if (elf_lookup_kernel_symbol_address(entry->caller_address, &baseAddress,
+			symbol, sizeof(symbol)) == B_OK) {
+		snprintf(entry->caller, sizeof(entry->caller), "%s+%#" B_PRIxADDR,
+			symbol, entry->caller_address - baseAddress);
+	} else {
+		snprintf(entry->caller, sizeof(entry->caller), "%#" B_PRIxADDR,
+			entry->caller_address);
+	}
+
+	if (entry->type != LOCK_STATS_SPINLOCK
+		|| entry->key != LOCK_STATS_KEY_ADDRESS) {
+		return;
+	}
+
+	if (elf_lookup_kernel_symbol_address(entry->lock, &baseAddress, symbol,
+			sizeof(symbol)) == B_OK) {
+		if (entry->lock == baseAddress)
+			strlcpy(entry->name, symbol, sizeof(entry->name));
+		else {
+			snprintf(entry->name, sizeof(entry->name), "%s+%#" B_PRIxADDR,
+				symbol, entry->lock - baseAddress);
+		}
+	} else {
+		snprintf(entry->name, sizeof(entry->name), "spinlock %#" B_PRIxADDR,
+			entry->lock);
+	}
+}
+
+
+static status_t
+lock_stats_get(lock_stats_get_args* userArgs)
+{
+	lock_stats_get_args args;
+	if (!IS_USER_ADDRESS(userArgs)
+		|| user_memcpy(&args, userArgs, sizeof(args)) != B_OK) {
+		return B_BAD_ADDRESS;
+	}
+	if (args.count < 0)
+		return B_BAD_VALUE;
+	if (args.count > 0 && !IS_USER_ADDRESS(args.entries))
+		return B_BAD_ADDRESS;
+
+	MutexLocker locker(sLockStatsLock);
+
+	int32 count = 0;
+	int32 dropped = 0;
+
+	if (sTables != NULL) {
+		// Stop recording and wait until all CPUs are done with their current
+		// events, so that we can access the tables safely.
+		int32 wasEnabled = atomic_get_and_set(&gLockStatsEnabled, 0);
+		call_all_cpus_sync(&lock_stats_quiesce, NULL);
+
+		status_t status = B_OK;
+		for (int32 cpu = 0; cpu < sTableCount; cpu++) {
+			lock_stats_table& table = sTables[cpu];
+			dropped += table.dropped;
+
+			for (int32 i = 0; i < LOCK_STATS_TABLE_SIZE && status == B_OK;
+					i++) {
+				lock_stats_entry* entry = &table.entries[i];
+				if (entry->lock == 0)
+					continue;
+
+				if (count >= args.count) {
+					dropped++;
+					continue;
+				}
+
+				lock_stats_resolve_symbols(entry);
+				status = user_memcpy(args.entries + count, entry,
+					sizeof(lock_stats_entry));
+				count++;
+			}
+
+			memset(&table, 0, sizeof(table));
+		}
+
+		if (wasEnabled != 0)
+			atomic_set(&gLockStatsEnabled, 1);
+
+		if (status != B_OK)
+			return B_BAD_ADDRESS;
+	}
+
+	args.count = count;
+	args.dropped = dropped;
+	if (user_memcpy(userArgs, &args, sizeof(args)) != B_OK)
+		return B_BAD_ADDRESS;
+
+	return B_OK;
+}
+
+
+static status_t
+lock_stats_syscall(const char* subsystem, uint32 function, void* buffer,
+	size_t bufferSize)
+{
+	switch (function) {
+		case LOCK_STATS_ENABLE:
+			if (geteuid() != 0)
+				return B_NOT_ALLOWED;
+			return lock_stats_enable();
+
+		case LOCK_STATS_DISABLE:
+			if (geteuid() != 0)
+				return B_NOT_ALLOWED;
+			atomic_set(&gLockStatsEnabled, 0);
+			return B_OK;
+
+		case LOCK_STATS_GET:
+			if (geteuid() != 0)
+				return B_NOT_ALLOWED;
+			if (bufferSize != sizeof(lock_stats_get_args))
+				return B_BAD_VALUE;
+			return lock_stats_get((lock_stats_get_args*)buffer);
+	}
+
+	return B_BAD_VALUE;
+}
+
+
+// #pragma mark - kernel private API
+
+
+void
+_lock_stats_acquired(uint32 type, const void* lock, const char* name,
+	addr_t caller, nanotime_t waitTime, bool contended)
+{
+	uint32 key;
+	addr_t identity;
+	if (name != NULL && name[0] != '\0') {
+		key = LOCK_STATS_KEY_NAME;
+		identity = lock_stats_name_identity(name);
+	} else {
+		key = LOCK_STATS_KEY_ADDRESS;
+		identity = (addr_t)lock;
+		name = NULL;
+	}
+
+	InterruptsLocker locker;
+
+	if (atomic_get(&gLockStatsEnabled) == 0)
+		return;
+
+	lock_stats_entry* entry = lock_stats_lookup(type, key, identity, name,
+		caller);
+	if (entry != NULL) {
+		entry->acquisitions++;
+		entry->wait_histogram[lock_stats_histogram_bucket(waitTime)]++;
+		if (contended) {
+			entry->contentions++;
+			entry->total_wait += waitTime;
+			if (waitTime > entry->max_wait)
+				entry->max_wait = waitTime;
+		}
+	}
+
+	if (type == LOCK_STATS_SPINLOCK || type == LOCK_STATS_RW_LOCK_READ)
+		return;
+
+	Thread* thread = thread_get_current_thread();
+	if (thread != NULL) {
+		lock_stats_push_held(thread, type, key, lock, identity, name, caller,
+			system_time_nsecs());
+	}
+}
+
+
+void
+_lock_stats_released(const void* lock)
+{
+	Thread* thread = thread_get_current_thread();
+	if (thread == NULL)
+		return;
+
+	lock_stats_held_lock* held = NULL;
+	for (int32 i = 0; i < LOCK_STATS_MAX_HELD_LOCKS; i++) {
+		if (thread->held_locks[i].lock == lock) {
+			held = &thread->held_locks[i];
+			break;
+		}
+	}
+	if (held == NULL)
+		return;
+
+	nanotime_t holdTime = system_time_nsecs() - held->acquired;
+	held->lock = NULL;
+
+	InterruptsLocker locker;
+
+	if (atomic_get(&gLockStatsEnabled) == 0)
+		return;
+
+	lock_stats_entry* entry = lock_stats_lookup(held->type, held->key,
+		held->identity, held->name, held->caller);
+	if (entry == NULL)
+		return;
+
+	entry->hold_count++;
+	entry->total_hold += holdTime;
+	if (holdTime > entry->max_hold)
+		entry->max_hold = holdTime;
+}
+
+
+status_t
+lock_stats_init_post_generic_syscalls()
+{
+	return register_generic_syscall(LOCK_STATS_SYSCALLS, &lock_stats_syscall,
+		1, 0);
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Read-copy-update in the style of sleepable RCU.
+
+	Every CPU has a pair of reader counters, one per phase. A reader
+	increments the counter of the current phase on the CPU it runs on and
+	decrements the same counter again when leaving the read section, so it is
+	free to block or to migrate to another CPU in between.
+	A grace period flips the phase and waits until the sum of the old phase's
+	counters has dropped to zero. Readers entering after the flip use the new
+	phase and don't hold up the grace period.
+
+	Callbacks queued with rcu_call() are collected and invoked in batches by
+	the reclaimer thread, after a grace period has passed.
+*/
+
+
+#include <rcu.h>
+
+#include <condition_variable.h>
+#include <cpu.h>
+#include <debug.h>
+#include <kernel.h>
+#include <lock.h>
+#include <smp.h>
+#include <thread.h>
+#include <util/AutoLock.h>
+
+
+static const bigtime_t kReclaimInterval = 100000;
+static const int32 kReclaimThreshold = 1024;
+	// number of pending callbacks that wake up the reclaimer early
+static const bigtime_t kGracePeriodPollInterval = 1000;
+
+
+struct CACHE_LINE_ALIGN rcu_reader_counts {
+	int32	counts[2];
+};
+
+
+static rcu_reader_counts sReaderCounts[SMP_MAX_CPUS];
+static int32 sPhase = 0;
+
+static mutex sSynchronizeLock = MUTEX_INITIALIZER("rcu synchronize");
+static int64 sGracePeriods = 0;
+
+static spinlock sCallbackLock = B_SPINLOCK_INITIALIZER;
+static rcu_head* sCallbacks = NULL;
+static rcu_head** sCallbacksTail = &sCallbacks;
+static int32 sPendingCallbacks = 0;
+static int64 sInvokedCallbacks = 0;
+
+static ConditionVariable sReclaimCondition;
+
+
+static int32
+readers_in_phase(int32 phase)
+{
+	int32 count = 0;
+	int32 cpuCount = smp_get_num_cpus();
+	for (int32 i = 0; i < cpuCount; i++)
+		count += atomic_get(&sReaderCounts[i].counts[phase]);
+	return count;
+}
+
+
+static void
+invoke_callbacks(rcu_head* head)
+{
+	int64 count = 0;
+	while (head != NULL) {
+		rcu_head* next = head->next;
+		head->callback(head);
+		head = next;
+		count++;
+	}
+
+	atomic_add64(&sInvokedCallbacks, count);
+}
+
+
+static status_t
+reclaimer_thread(void* /*data*/)
+{
+	while (true) {
+		ConditionVariableEntry entry;
+		sReclaimCondition.Add(&entry);
+		if (atomic_get(&sPendingCallbacks) < kReclaimThreshold)
+			entry.Wait(B_RELATIVE_TIMEOUT, kReclaimInterval);
+
+		InterruptsSpinLocker locker(sCallbackLock);
+		rcu_head* head = sCallbacks;
+		sCallbacks = NULL;
+		sCallbacksTail = &sCallbacks;
+		sPendingCallbacks = 0;
+		locker.Unlock();
+
+		if (head == NULL)
+			continue;
+
+		rcu_synchronize();
+		invoke_callbacks(head);
+	}
+
+	return B_OK;
+}
+
+
+static int
+dump_rcu(int argc, char** argv)
+{
+	kprintf("phase:              %" B_PRId32 "\n", sPhase);
+	kprintf("grace periods:      %" B_PRId64 "\n", sGracePeriods);
+	kprintf("pending callbacks:  %" B_PRId32 "\n", sPendingCallbacks);
+	kprintf("invoked callbacks:  %" B_PRId64 "\n", sInvokedCallbacks);
+
+	int32 cpuCount = smp_get_num_cpus();
+	for (int32 i = 0; i < cpuCount; i++) {
+		kprintf("  cpu %2" B_PRId32 ": %6" B_PRId32 " %6" B_PRId32 "\n", i,
+			sReaderCounts[i].counts[0], sReaderCounts[i].counts[1]);
+	}
+
+	return 0;
+}
+
+
+// #pragma mark - kernel private API
+
+
+/*!	Enters a read section.
+	The returned cookie must be passed to the matching rcu_read_unlock().
+*/
+int32
+rcu_read_lock(void)
+{
+	int32 cpu = smp_get_current_cpu();
+
+	while (true) {
+		int32 phase = atomic_get(&sPhase) & 1;
+		atomic_add(&sReaderCounts[cpu].counts[phase], 1);
+
+		// If the phase has been flipped in the meantime, the grace period
+		// might already have missed us.
+		if ((atomic_get(&sPhase) & 1) == phase)
+			return (cpu << 1) | phase;
+
+		atomic_add(&sReaderCounts[cpu].counts[phase], -1);
+	}
+}
+
+
+void
+rcu_read_unlock(int32 cookie)
+{
+	atomic_add(&sReaderCounts[cookie >> 1].counts[cookie & 1], -1);
+}
+
+
+/*!	Waits until all read sections that have been entered before the call
+	have been left.
+*/
+void
+rcu_synchronize(void)
+{
+	MutexLocker locker(sSynchronizeLock);
+
+	int32 oldPhase = atomic_add(&sPhase, 1) & 1;
+
+	while (readers_in_phase(oldPhase) != 0)
+		snooze(kGracePeriodPollInterval);
+
+	sGracePeriods++;
+}
+
+
+/*!	Calls \a callback with \a head after a grace period, in the context of
+	a kernel thread. The callback is usually used to free the object \a head
+	is embedded in.
+*/
+void
+rcu_call(rcu_head* head, rcu_callback callback)
+{
+	head->next = NULL;
+	head->callback = callback;
+
+	InterruptsSpinLocker locker(sCallbackLock);
+	*sCallbacksTail = head;
+	sCallbacksTail = &head->next;
+	bool wakeUp = ++sPendingCallbacks == kReclaimThreshold;
+	locker.Unlock();
+
+	if (wakeUp)
+		sReclaimCondition.NotifyOne();
+}
+
+
+status_t
+rcu_init(void)
+{
+	sReclaimCondition.Init(&sCallbacks, "rcu reclaim");
+
+	thread_id thread = spawn_kernel_thread(&reclaimer_thread, "rcu reclaimer",
+		B_NORMAL_PRIORITY, NULL);
+	if (thread < 0)
+		return thread;
+	resume_thread(thread);
+
+	add_debugger_command_etc("rcu", &dump_rcu,
+		"Dump the state of the read-copy-update facility",
+		"\n"
+		"Prints the current phase, statistics, and the per-CPU reader\n"
+		"counters.\n", 0);
+
+	return B_OK;
+}
@@ -41,6 +41,7 @@
 #include <ksyscalls.h>
 #include <ksystem_info.h>
 #include <lock.h>
+#include <lock_stats.h>
 #include <low_resource_manager.h>
 #include <messaging.h>
 #include <Notifications.h>
@@ -48,6 +49,7 @@
 #include <posix/realtime_sem.h>
 #include <posix/xsi_message_queue.h>
 #include <posix/xsi_semaphore.h>
+#include <rcu.h>
 #include <real_time_clock.h>
 #include <sem.h>
 #include <smp.h>
@@ -199,6 +201,8 @@ _start(kernel_args *bootKernelArgs, int currentCPU)
 		TRACE("init generic syscall\n");
 		generic_syscall_init();
 		smp_init_post_generic_syscalls();
+		lock_init_post_generic_syscalls();
+		lock_stats_init_post_generic_syscalls();
 		TRACE("init scheduler\n");
 		scheduler_init();
 		TRACE("init threads\n");
@@ -216,6 +220,8 @@ _start(kernel_args *bootKernelArgs, int currentCPU)
 		low_resource_manager_init_post_thread();
 		TRACE("init DPC\n");
 		dpc_init();
+		TRACE("init RCU\n");
+		rcu_init();
 		TRACE("init VFS\n");
 		vfs_init(&sKernelArgs);
 #if ENABLE_SWAP_SUPPORT
@@ -28,6 +28,7 @@
 #include <heap.h>
 #include <kernel.h>
 #include <Notifications.h>
+#include <port_buffer.h>
 #include <sem.h>
 #include <syscall_restart.h>
 #include <team.h>
@@ -96,6 +97,8 @@ struct port_message : DoublyLinkedListLinkImpl<port_message> {
 	uid_t				sender;
 	gid_t				sender_group;
 	team_id				sender_team;
+	PortBuffer*			port_buffer;
+		// if set, the message data is in this buffer instead of inline
 	char				buffer[0];
 };
 
@@ -669,7 +672,11 @@ is_port_closed(Port* port)
 static void
 put_port_message(port_message* message)
 {
-	const size_t size = sizeof(port_message) + message->size;
+	size_t size = sizeof(port_message);
+	if (message->port_buffer != NULL)
+		port_buffer_put(message->port_buffer);
+	else
+		size += message->size;
 	free(message);
 
 	atomic_add(&sTotalSpaceCommited, -size);
@@ -737,6 +744,7 @@ get_port_message(int32 code, size_t bufferSize, uint32 flags, bigtime_t timeout,
 		if (message != NULL) {
 			message->code = code;
 			message->size = bufferSize;
+			message->port_buffer = NULL;
 
 			*_message = message;
 			return B_OK;
@@ -780,18 +788,72 @@ copy_port_message(port_message* message, int32* _code, void* buffer,
 		*_code = message->code;
 
 	if (size > 0) {
+		const void* data = message->port_buffer != NULL
+			? port_buffer_data(message->port_buffer) : message->buffer;
 		if (userCopy) {
-			status_t status = user_memcpy(buffer, message->buffer, size);
+			status_t status = user_memcpy(buffer, data, size);
 			if (status != B_OK)
 				return status;
 		} else
-			memcpy(buffer, message->buffer, size);
+			memcpy(buffer, data, size);
 	}
 
 	return size;
 }
 
 
+/*!	Waits until the port has a message that can be read.
+	The port must be locked by \a locker, and is still locked when this
+	function returns \c B_OK.
+*/
+static status_t
+wait_for_port_message(port_id id, BReference<Port>& portRef,
+	MutexLocker& locker, uint32 flags, bigtime_t timeout)
+{
+	if (is_port_closed(portRef) && portRef->messages.IsEmpty()) {
+		T(Read(portRef, 0, B_BAD_PORT_ID));
+		TRACE(("wait_for_port_message(): closed port %ld\n", id));
+		return B_BAD_PORT_ID;
+	}
+
+	while (portRef->read_count == 0) {
+		if ((flags & B_RELATIVE_TIMEOUT) != 0 && timeout <= 0)
+			return B_WOULD_BLOCK;
+
+		// We need to wait for a message to appear
+		ConditionVariableEntry entry;
+		portRef->read_condition.Add(&entry);
+
+		locker.Unlock();
+
+		// block if no message, or, if B_TIMEOUT flag set, block with timeout
+		status_t status = entry.Wait(flags, timeout);
+
+		// re-lock
+		BReference<Port> newPortRef = get_locked_port(id);
+		if (newPortRef == NULL) {
+			T(Read(id, 0, 0, 0, B_BAD_PORT_ID));
+			return B_BAD_PORT_ID;
+		}
+		locker.SetTo(newPortRef->lock, true);
+
+		if (newPortRef != portRef
+			|| (is_port_closed(portRef) && portRef->messages.IsEmpty())) {
+			// the port is no longer there
+			T(Read(id, 0, 0, 0, B_BAD_PORT_ID));
+			return B_BAD_PORT_ID;
+		}
+
+		if (status != B_OK) {
+			T(Read(portRef, 0, status));
+			return status;
+		}
+	}
+
+	return B_OK;
+}
+
+
 static void
 uninit_port(Port* port)
 {
@@ -946,6 +1008,9 @@ port_init(kernel_args *args)
 
 	sNoSpaceCondition.Init(&sPorts, "port space");
 
+	if (port_buffers_init() != B_OK)
+		return B_NO_MEMORY;
+
 	// add debugger commands
 	add_debugger_command_etc("ports", &dump_port_list,
 		"Dump a list of all active ports (for team, with name, etc.)",
@@ -1454,45 +1519,10 @@ read_port_etc(port_id id, int32* _code, void* buffer, size_t bufferSize,
 		return B_BAD_PORT_ID;
 	MutexLocker locker(portRef->lock, true);
 
-	if (is_port_closed(portRef) && portRef->messages.IsEmpty()) {
-		T(Read(portRef, 0, B_BAD_PORT_ID));
-		TRACE(("read_port_etc(): closed port %ld\n", id));
-		return B_BAD_PORT_ID;
-	}
-
-	while (portRef->read_count == 0) {
-		if ((flags & B_RELATIVE_TIMEOUT) != 0 && timeout <= 0)
-			return B_WOULD_BLOCK;
-
-		// We need to wait for a message to appear
-		ConditionVariableEntry entry;
-		portRef->read_condition.Add(&entry);
-
-		locker.Unlock();
-
-		// block if no message, or, if B_TIMEOUT flag set, block with timeout
-		status_t status = entry.Wait(flags, timeout);
-
-		// re-lock
-		BReference<Port> newPortRef = get_locked_port(id);
-		if (newPortRef == NULL) {
-			T(Read(id, 0, 0, 0, B_BAD_PORT_ID));
-			return B_BAD_PORT_ID;
-		}
-		locker.SetTo(newPortRef->lock, true);
-
-		if (newPortRef != portRef
-			|| (is_port_closed(portRef) && portRef->messages.IsEmpty())) {
-			// the port is no longer there
-			T(Read(id, 0, 0, 0, B_BAD_PORT_ID));
-			return B_BAD_PORT_ID;
-		}
-
-		if (status != B_OK) {
-			T(Read(portRef, 0, status));
-			return status;
-		}
-	}
+	status_t status = wait_for_port_message(id, portRef, locker, flags,
+		timeout);
+	if (status != B_OK)
+		return status;
 
 	// determine tail & get the length of the message
 	port_message* message = portRef->messages.Head();
@@ -1533,6 +1563,83 @@ read_port_etc(port_id id, int32* _code, void* buffer, size_t bufferSize,
 }
 
 
+/*!	Reads a message from the port, and hands its data to the current team in
+	a port buffer it can read. Messages that were not written in a buffer are
+	copied into a new one. If that fails, the message stays in the queue.
+	Returns the size of the message; for empty messages, \a _buffer is set
+	to -1.
+*/
+static ssize_t
+read_port_buffer_etc(port_id id, int32* _code, area_id* _buffer,
+	void** _address, uint32 flags, bigtime_t timeout)
+{
+	if (!sPortsActive || id < 0)
+		return B_BAD_PORT_ID;
+	if (timeout < 0)
+		return B_BAD_VALUE;
+
+	flags &= B_CAN_INTERRUPT | B_KILL_CAN_INTERRUPT | B_RELATIVE_TIMEOUT
+		| B_ABSOLUTE_TIMEOUT;
+
+	// get the port
+	BReference<Port> portRef = get_locked_port(id);
+	if (portRef == NULL)
+		return B_BAD_PORT_ID;
+	MutexLocker locker(portRef->lock, true);
+
+	status_t status = wait_for_port_message(id, portRef, locker, flags,
+		timeout);
+	if (status != B_OK)
+		return status;
+
+	port_message* message = portRef->messages.Head();
+	if (message == NULL) {
+		panic("port %" B_PRId32 ": no messages found\n", portRef->id);
+		return B_ERROR;
+	}
+
+	const size_t size = message->size;
+	area_id buffer = -1;
+	void* address = NULL;
+	if (message->port_buffer != NULL) {
+		status = port_buffer_attach(message->port_buffer, &buffer, &address);
+		if (status == B_OK) {
+			// the buffer belongs to the reader now
+			message->port_buffer = NULL;
+			message->size = 0;
+		}
+	} else if (size > 0) {
+		status = port_buffer_create(message->buffer, size,
+			message->sender_team, &buffer, &address);
+	}
+
+	if (status != B_OK) {
+		T(Read(portRef, 0, status));
+		portRef->read_condition.NotifyOne();
+		return status;
+	}
+
+	portRef->messages.RemoveHead();
+	portRef->total_count++;
+	portRef->write_count++;
+	portRef->read_count--;
+
+	notify_port_select_events(portRef, B_EVENT_WRITE);
+	portRef->write_condition.NotifyOne();
+
+	T(Read(portRef, message->code, size));
+
+	locker.Unlock();
+
+	*_code = message->code;
+	*_buffer = buffer;
+	*_address = address;
+
+	put_port_message(message);
+	return size;
+}
+
+
 status_t
 write_port(port_id id, int32 msgCode, const void* buffer, size_t bufferSize)
 {
@@ -1552,14 +1659,21 @@ write_port_etc(port_id id, int32 msgCode, const void* buffer,
 }
 
 
-status_t
-writev_port_etc(port_id id, int32 msgCode, const iovec* msgVecs,
-	size_t vecCount, size_t bufferSize, uint32 flags, bigtime_t timeout)
+/*!	Writes a message to the port. The message data is either copied from
+	\a msgVecs, or passed in the current team's \a portBuffer, if that is
+	given.
+*/
+static status_t
+write_port_message(port_id id, int32 msgCode, const iovec* msgVecs,
+	size_t vecCount, size_t bufferSize, area_id portBuffer, uint32 flags,
+	bigtime_t timeout)
 {
 	if (!sPortsActive || id < 0)
 		return B_BAD_PORT_ID;
-	if (bufferSize > PORT_MAX_MESSAGE_SIZE)
+	if (bufferSize > (portBuffer >= 0
+			? PORT_BUFFER_MAX_SIZE : PORT_MAX_MESSAGE_SIZE)) {
 		return B_BAD_VALUE;
+	}
 
 	bool userCopy = (flags & PORT_FLAG_USE_USER_MEMCPY) != 0;
 
@@ -1623,8 +1737,8 @@ writev_port_etc(port_id id, int32 msgCode, const iovec* msgVecs,
 	} else
 		portRef->write_count--;
 
-	status = get_port_message(msgCode, bufferSize, flags, timeout,
-		&message, *portRef);
+	status = get_port_message(msgCode, portBuffer >= 0 ? 0 : bufferSize,
+		flags, timeout, &message, *portRef);
 	if (status != B_OK) {
 		if (status == B_BAD_PORT_ID) {
 			// the port had to be unlocked and is now no longer there
@@ -1640,7 +1754,16 @@ writev_port_etc(port_id id, int32 msgCode, const iovec* msgVecs,
 	message->sender_group = getegid();
 	message->sender_team = team_get_current_team_id();
 
-	if (bufferSize > 0) {
+	if (portBuffer >= 0) {
+		// this makes the buffer inaccessible for the sender
+		status = port_buffer_detach(portBuffer, bufferSize,
+			&message->port_buffer);
+		if (status != B_OK) {
+			put_port_message(message);
+			goto error;
+		}
+		message->size = bufferSize;
+	} else if (bufferSize > 0) {
 		size_t offset = 0;
 		for (uint32 i = 0; i < vecCount; i++) {
 			size_t bytes = msgVecs[i].iov_len;
@@ -1687,6 +1810,15 @@ error:
 }
 
 
+status_t
+writev_port_etc(port_id id, int32 msgCode, const iovec* msgVecs,
+	size_t vecCount, size_t bufferSize, uint32 flags, bigtime_t timeout)
+{
+	return write_port_message(id, msgCode, msgVecs, vecCount, bufferSize, -1,
+		flags, timeout);
+}
+
+
 status_t
 set_port_owner(port_id id, team_id newTeamID)
 {
@@ -1942,6 +2074,53 @@ _user_writev_port_etc(port_id port, int32 messageCode, const iovec *userVecs,
 }
 
 
+ssize_t
+_user_read_port_buffer_etc(port_id port, int32 *userCode, area_id *userBuffer,
+	void **userAddress, uint32 flags, bigtime_t timeout)
+{
+	syscall_restart_handle_timeout_pre(flags, timeout);
+
+	if (userCode == NULL || userBuffer == NULL || userAddress == NULL)
+		return B_BAD_VALUE;
+	if (!IS_USER_ADDRESS(userCode) || !IS_USER_ADDRESS(userBuffer)
+		|| !IS_USER_ADDRESS(userAddress))
+		return B_BAD_ADDRESS;
+
+	int32 messageCode;
+	area_id buffer;
+	void* address;
+	ssize_t bytesRead = read_port_buffer_etc(port, &messageCode, &buffer,
+		&address, flags | B_CAN_INTERRUPT, timeout);
+
+	if (bytesRead >= 0
+		&& (user_memcpy(userCode, &messageCode, sizeof(int32)) < B_OK
+			|| user_memcpy(userBuffer, &buffer, sizeof(area_id)) < B_OK
+			|| user_memcpy(userAddress, &address, sizeof(void*)) < B_OK)) {
+		if (buffer >= 0)
+			release_port_buffer(buffer);
+		return B_BAD_ADDRESS;
+	}
+
+	return syscall_restart_handle_timeout_post(bytesRead, timeout);
+}
+
+
+status_t
+_user_write_port_buffer_etc(port_id port, int32 messageCode, area_id buffer,
+	size_t bufferSize, uint32 flags, bigtime_t timeout)
+{
+	syscall_restart_handle_timeout_pre(flags, timeout);
+
+	if (buffer < 0)
+		return B_BAD_VALUE;
+
+	status_t status = write_port_message(port, messageCode, NULL, 0,
+		bufferSize, buffer, flags | B_CAN_INTERRUPT, timeout);
+
+	return syscall_restart_handle_timeout_post(status, timeout);
+}
+
+
 status_t
 _user_get_port_message_info_etc(port_id port, port_message_info *userInfo,
 	size_t infoSize, uint32 flags, bigtime_t timeout)
@@ -0,0 +1,854 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Port buffers: page aligned message buffers that are passed through ports
+	without copying their contents.
+
+	A port buffer is a kernel area that is cloned into every team that used it
+	so far. The clones are kept when the buffer changes hands, and only their
+	protection is changed, so that once all teams involved have it mapped,
+	passing a buffer on costs neither a copy nor creating or deleting an area.
+	At most one of the clones is accessible from userland at any time:
+	- the team that acquired the buffer can read and write it,
+	- once it has been written to a port, nobody can access it,
+	- the team that read it from the port can only read it.
+	The contents of a buffer are thus only seen by the team that wrote them
+	(its origin), and the teams they were sent to. Free buffers are kept in a
+	pool per size, and are preferably handed out to their origin again, since
+	they need to be cleared before another team can write them.
+
+	The clones are B_KERNEL_AREAs, so that userland cannot delete them, or
+	change their protection.
+*/
+
+
+#include <port_buffer.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+#include <kernel.h>
+#include <lock.h>
+#include <team.h>
+#include <util/AutoLock.h>
+#include <util/DoublyLinkedList.h>
+#include <util/OpenHashTable.h>
+#include <vm/vm.h>
+#include <vm/VMAddressSpace.h>
+
+
+//#define TRACE_PORT_BUFFER
+#ifdef TRACE_PORT_BUFFER
+#	define TRACE(x...) dprintf("port buffer: " x)
+#else
+#	define TRACE(x...) do {} while (false)
+#endif
+
+
+static const uint32 kSizeClassCount = 11;
+	// B_PAGE_SIZE up to PORT_BUFFER_MAX_SIZE
+static const size_t kTotalSizeLimit = 64 * 1024 * 1024;
+static const size_t kFreeSizeLimit = 16 * 1024 * 1024;
+static const size_t kTeamSizeLimit = 16 * 1024 * 1024;
+static const int32 kMaxPoolScan = 8;
+
+static const uint32 kNoAccessProtection = B_KERNEL_AREA | B_SHARED_AREA;
+static const uint32 kReadProtection = B_READ_AREA | B_KERNEL_AREA
+	| B_SHARED_AREA;
+static const uint32 kWriteProtection = B_READ_AREA | B_WRITE_AREA
+	| B_KERNEL_AREA | B_SHARED_AREA;
+
+
+namespace {
+
+enum {
+	kNoAccess = 0,
+	kReadAccess,
+	kWriteAccess
+};
+
+
+struct PortBufferMapping {
+	DoublyLinkedListLink<PortBufferMapping>	buffer_link;
+	DoublyLinkedListLink<PortBufferMapping>	team_link;
+	PortBufferMapping*	hash_link;
+	PortBuffer*			buffer;
+	team_id				team;
+	area_id				area;
+	void*				address;
+	uint32				access;
+};
+
+typedef DoublyLinkedList<PortBufferMapping,
+	DoublyLinkedListMemberGetLink<PortBufferMapping,
+		&PortBufferMapping::buffer_link> > BufferMappingList;
+typedef DoublyLinkedList<PortBufferMapping,
+	DoublyLinkedListMemberGetLink<PortBufferMapping,
+		&PortBufferMapping::team_link> > TeamMappingList;
+
+
+struct TeamPortBuffers {
+	team_id				team;
+	size_t				owned_size;
+	TeamMappingList		mappings;
+	TeamPortBuffers*	hash_link;
+};
+
+
+struct MappingHashDefinition {
+	typedef area_id				KeyType;
+	typedef PortBufferMapping	ValueType;
+
+	size_t HashKey(area_id key) const
+	{
+		return key;
+	}
+
+	size_t Hash(PortBufferMapping* value) const
+	{
+		return HashKey(value->area);
+	}
+
+	bool Compare(area_id key, PortBufferMapping* value) const
+	{
+		return value->area == key;
+	}
+
+	PortBufferMapping*& GetLink(PortBufferMapping* value) const
+	{
+		return value->hash_link;
+	}
+};
+
+typedef BOpenHashTable<MappingHashDefinition> MappingHashTable;
+
+
+struct TeamHashDefinition {
+	typedef team_id			KeyType;
+	typedef TeamPortBuffers	ValueType;
+
+	size_t HashKey(team_id key) const
+	{
+		return key;
+	}
+
+	size_t Hash(TeamPortBuffers* value) const
+	{
+		return HashKey(value->team);
+	}
+
+	bool Compare(team_id key, TeamPortBuffers* value) const
+	{
+		return value->team == key;
+	}
+
+	TeamPortBuffers*& GetLink(TeamPortBuffers* value) const
+	{
+		return value->hash_link;
+	}
+};
+
+typedef BOpenHashTable<TeamHashDefinition> TeamHashTable;
+
+} // namespace
+
+
+struct PortBuffer : DoublyLinkedListLinkImpl<PortBuffer> {
+	enum State {
+		kFree = 0,
+		kBusy,
+			// being handed to its new owner
+		kOwned,
+		kInTransit
+	};
+
+	area_id				area;
+	uint8*				address;
+	size_t				size;
+	uint32				size_class;
+	int32				state;
+	team_id				owner;
+	team_id				origin;
+		// the team that wrote the current contents, -1 if they are all zero
+	PortBufferMapping*	open_mapping;
+		// the one mapping userland may access, if any
+	BufferMappingList	mappings;
+
+	PortBuffer(uint32 sizeClass)
+		:
+		area(-1),
+		address(NULL),
+		size(B_PAGE_SIZE << sizeClass),
+		size_class(sizeClass),
+		state(kFree),
+		owner(-1),
+		origin(-1),
+		open_mapping(NULL)
+	{
+	}
+};
+
+typedef DoublyLinkedList<PortBuffer> BufferList;
+
+
+// Locking: sLock protects the hash tables, the free lists, the mapping lists,
+// and the state and owner of all buffers. A buffer that is not free is used
+// by one thread only: the team thread that owns it, or the one that currently
+// has its port locked. That thread may change the protection of the buffer's
+// mappings, or create new ones without holding sLock.
+static mutex sLock = MUTEX_INITIALIZER("port buffers");
+static MappingHashTable sMappings;
+static TeamHashTable sTeams;
+static BufferList sFreeBuffers[kSizeClassCount];
+static size_t sTotalSize;
+static size_t sFreeSize;
+
+
+static status_t
+size_class_for(size_t size, uint32& _sizeClass)
+{
+	if (size == 0 || size > PORT_BUFFER_MAX_SIZE)
+		return B_BAD_VALUE;
+
+	uint32 sizeClass = 0;
+	while (((size_t)B_PAGE_SIZE << sizeClass) < size)
+		sizeClass++;
+
+	_sizeClass = sizeClass;
+	return B_OK;
+}
+
+
+static uint32
+protection_for(uint32 access)
+{
+	switch (access) {
+		case kReadAccess:
+			return kReadProtection;
+		case kWriteAccess:
+			return kWriteProtection;
+		default:
+			return kNoAccessProtection;
+	}
+}
+
+
+/*!	sLock must be held. */
+static TeamPortBuffers*
+get_team_buffers(team_id team)
+{
+	TeamPortBuffers* teamBuffers = sTeams.Lookup(team);
+	if (teamBuffers != NULL)
+		return teamBuffers;
+
+	teamBuffers = new(std::nothrow) TeamPortBuffers;
+	if (teamBuffers == NULL)
+		return NULL;
+
+	teamBuffers->team = team;
+	teamBuffers->owned_size = 0;
+	if (sTeams.Insert(teamBuffers) != B_OK) {
+		delete teamBuffers;
+		return NULL;
+	}
+
+	return teamBuffers;
+}
+
+
+/*!	sLock must be held. */
+static PortBufferMapping*
+find_mapping(PortBuffer* buffer, team_id team)
+{
+	for (BufferMappingList::Iterator iterator = buffer->mappings.GetIterator();
+			PortBufferMapping* mapping = iterator.Next();) {
+		if (mapping->team == team)
+			return mapping;
+	}
+
+	return NULL;
+}
+
+
+/*!	Unmaps the buffer from all teams, and deletes it. The buffer must be
+	neither in use, nor in the pool.
+*/
+static void
+delete_buffer(PortBuffer* buffer)
+{
+	TRACE("delete buffer %" B_PRId32 " (%" B_PRIuSIZE " bytes)\n",
+		buffer->area, buffer->size);
+
+	MutexLocker locker(sLock);
+
+	BufferMappingList mappings;
+	while (PortBufferMapping* mapping = buffer->mappings.RemoveHead()) {
+		sTeams.Lookup(mapping->team)->mappings.Remove(mapping);
+		sMappings.RemoveUnchecked(mapping);
+		mappings.Add(mapping);
+	}
+	sTotalSize -= buffer->size;
+
+	locker.Unlock();
+
+	while (PortBufferMapping* mapping = mappings.RemoveHead()) {
+		vm_delete_area(mapping->team, mapping->area, true);
+		delete mapping;
+	}
+
+	delete_area(buffer->area);
+	delete buffer;
+}
+
+
+/*!	Puts an unused buffer back into the pool. Returns \c false, if the pool is
+	full and the caller has to delete the buffer instead.
+	sLock must be held.
+*/
+static bool
+free_buffer_locked(PortBuffer* buffer)
+{
+	buffer->state = PortBuffer::kFree;
+	buffer->owner = -1;
+
+	if (sFreeSize + buffer->size > kFreeSizeLimit)
+		return false;
+
+	// recently used buffers go first, they are most likely still mapped
+	sFreeSize += buffer->size;
+	sFreeBuffers[buffer->size_class].Add(buffer, false);
+	return true;
+}
+
+
+/*!	Removes the free buffer of the given size that suits \a team best from the
+	pool: ideally one that it wrote itself, and can still access.
+	sLock must be held.
+*/
+static PortBuffer*
+take_free_buffer_locked(uint32 sizeClass, team_id team)
+{
+	BufferList& list = sFreeBuffers[sizeClass];
+
+	PortBuffer* best = NULL;
+	int32 bestScore = -1;
+	int32 scanned = 0;
+	for (BufferList::Iterator iterator = list.GetIterator();
+			PortBuffer* buffer = iterator.Next();) {
+		int32 score = 0;
+		if (buffer->origin == team || buffer->origin < 0)
+			score += 2;
+		if (buffer->open_mapping != NULL && buffer->open_mapping->team == team)
+			score++;
+
+		if (score > bestScore) {
+			best = buffer;
+			bestScore = score;
+			if (score == 3)
+				break;
+		}
+		if (++scanned == kMaxPoolScan)
+			break;
+	}
+
+	if (best != NULL) {
+		list.Remove(best);
+		sFreeSize -= best->size;
+	}
+
+	return best;
+}
+
+
+static PortBuffer*
+create_buffer(uint32 sizeClass)
+{
+	PortBuffer* buffer = new(std::nothrow) PortBuffer(sizeClass);
+	if (buffer == NULL)
+		return NULL;
+
+	buffer->area = create_area("port buffer", (void**)&buffer->address,
+		B_ANY_KERNEL_ADDRESS, buffer->size, B_FULL_LOCK,
+		B_KERNEL_READ_AREA | B_KERNEL_WRITE_AREA);
+	if (buffer->area < 0) {
+		delete buffer;
+		return NULL;
+	}
+
+	TRACE("created buffer %" B_PRId32 " (%" B_PRIuSIZE " bytes)\n",
+		buffer->area, buffer->size);
+	return buffer;
+}
+
+
+/*!	Makes the buffer owned by \a team, but busy.
+	sLock must be held.
+*/
+static status_t
+own_buffer_locked(PortBuffer* buffer, team_id team)
+{
+	TeamPortBuffers* teamBuffers = get_team_buffers(team);
+	if (teamBuffers == NULL)
+		return B_NO_MEMORY;
+
+	teamBuffers->owned_size += buffer->size;
+	buffer->state = PortBuffer::kBusy;
+	buffer->owner = team;
+	return B_OK;
+}
+
+
+/*!	sLock must be held. */
+static void
+disown_buffer_locked(PortBuffer* buffer)
+{
+	TeamPortBuffers* teamBuffers = sTeams.Lookup(buffer->owner);
+	if (teamBuffers != NULL)
+		teamBuffers->owned_size -= buffer->size;
+
+	buffer->owner = -1;
+}
+
+
+static void
+put_buffer(PortBuffer* buffer)
+{
+	MutexLocker locker(sLock);
+	bool pooled = free_buffer_locked(buffer);
+	locker.Unlock();
+
+	if (!pooled)
+		delete_buffer(buffer);
+}
+
+
+/*!	Makes the busy buffer accessible to its owner only, with the given access.
+	If \a data is given, the buffer is filled with it, and cleared beyond, or
+	else just cleared if \a clear is \c true; both happen while no team can
+	access the buffer.
+*/
+static status_t
+set_buffer_access(PortBuffer* buffer, uint32 access, bool clear,
+	const void* data, size_t dataSize, PortBufferMapping** _mapping)
+{
+	const team_id team = buffer->owner;
+
+	MutexLocker locker(sLock);
+
+	PortBufferMapping* openMapping = buffer->open_mapping;
+	if (openMapping != NULL && openMapping->team != team) {
+		area_id area = openMapping->area;
+		openMapping->access = kNoAccess;
+		buffer->open_mapping = NULL;
+
+		locker.Unlock();
+		// This fails only if the other team is just going away.
+		vm_set_area_protection(VMAddressSpace::KernelID(), area,
+			kNoAccessProtection, true);
+		locker.Lock();
+	}
+
+	if (clear || data != NULL) {
+		// fill the buffer before its owner can access it
+		PortBufferMapping* mapping = find_mapping(buffer, team);
+		if (mapping != NULL && mapping->access != kNoAccess) {
+			area_id area = mapping->area;
+			mapping->access = kNoAccess;
+			buffer->open_mapping = NULL;
+
+			locker.Unlock();
+			vm_set_area_protection(VMAddressSpace::KernelID(), area,
+				kNoAccessProtection, true);
+			locker.Lock();
+		}
+
+		locker.Unlock();
+		if (data != NULL)
+			memcpy(buffer->address, data, dataSize);
+		else
+			dataSize = 0;
+		memset(buffer->address + dataSize, 0, buffer->size - dataSize);
+		locker.Lock();
+	}
+
+	PortBufferMapping* mapping = find_mapping(buffer, team);
+	if (mapping != NULL) {
+		if (mapping->access != access) {
+			area_id area = mapping->area;
+			locker.Unlock();
+
+			status_t status = vm_set_area_protection(
+				VMAddressSpace::KernelID(), area, protection_for(access), true);
+			if (status != B_OK)
+				return status;
+
+			locker.Lock();
+			mapping->access = access;
+		}
+
+		buffer->open_mapping = mapping;
+		*_mapping = mapping;
+		return B_OK;
+	}
+
+	locker.Unlock();
+
+	// the team doesn't have the buffer mapped yet
+	mapping = new(std::nothrow) PortBufferMapping;
+	if (mapping == NULL)
+		return B_NO_MEMORY;
+
+	mapping->buffer = buffer;
+	mapping->team = team;
+	mapping->access = access;
+	mapping->address = NULL;
+	mapping->area = vm_clone_area(team, "port buffer", &mapping->address,
+		B_ANY_ADDRESS, protection_for(access), REGION_NO_PRIVATE_MAP,
+		buffer->area, true);
+	if (mapping->area < 0) {
+		status_t status = mapping->area;
+		delete mapping;
+		return status;
+	}
+
+	locker.Lock();
+
+	if (sMappings.Insert(mapping) != B_OK) {
+		locker.Unlock();
+		vm_delete_area(team, mapping->area, true);
+		delete mapping;
+		return B_NO_MEMORY;
+	}
+
+	// the owner always has an entry, see own_buffer_locked()
+	sTeams.Lookup(team)->mappings.Add(mapping);
+	buffer->mappings.Add(mapping);
+	buffer->open_mapping = mapping;
+
+	TRACE("mapped buffer %" B_PRId32 " into team %" B_PRId32 " as %" B_PRId32
+		"\n", buffer->area, team, mapping->area);
+
+	*_mapping = mapping;
+	return B_OK;
+}
+
+
+/*!	Gets a buffer of at least \a size bytes for the current team, fills it
+	with \a data, or clears it if needed, and makes it accessible.
+	A buffer that its origin gets back is not cleared, just like memory that is
+	reused by an allocator.
+*/
+static status_t
+get_buffer(size_t size, team_id origin, uint32 access, const void* data,
+	area_id* _area, void** _address)
+{
+	uint32 sizeClass;
+	status_t status = size_class_for(size, sizeClass);
+	if (status != B_OK)
+		return status;
+
+	const team_id team = team_get_current_team_id();
+	const size_t bufferSize = (size_t)B_PAGE_SIZE << sizeClass;
+
+	MutexLocker locker(sLock);
+
+	TeamPortBuffers* teamBuffers = get_team_buffers(team);
+	if (teamBuffers == NULL)
+		return B_NO_MEMORY;
+	if (teamBuffers->owned_size + bufferSize > kTeamSizeLimit)
+		return B_NO_MEMORY;
+
+	PortBuffer* buffer = take_free_buffer_locked(sizeClass, team);
+	if (buffer == NULL) {
+		if (sTotalSize + bufferSize > kTotalSizeLimit)
+			return B_NO_MEMORY;
+		sTotalSize += bufferSize;
+
+		locker.Unlock();
+		buffer = create_buffer(sizeClass);
+		locker.Lock();
+
+		if (buffer == NULL) {
+			sTotalSize -= bufferSize;
+			return B_NO_MEMORY;
+		}
+	}
+
+	status = own_buffer_locked(buffer, team);
+	if (status != B_OK) {
+		locker.Unlock();
+		put_buffer(buffer);
+		return status;
+	}
+
+	bool clear = buffer->origin >= 0 && buffer->origin != origin;
+	buffer->origin = origin;
+
+	locker.Unlock();
+
+	PortBufferMapping* mapping;
+	status = set_buffer_access(buffer, access, clear, data, size, &mapping);
+
+	locker.Lock();
+
+	if (status != B_OK) {
+		disown_buffer_locked(buffer);
+		bool pooled = free_buffer_locked(buffer);
+		locker.Unlock();
+
+		if (!pooled)
+			delete_buffer(buffer);
+		return status;
+	}
+
+	buffer->state = PortBuffer::kOwned;
+	*_area = mapping->area;
+	*_address = mapping->address;
+	return B_OK;
+}
+
+
+//	#pragma mark - private kernel API
+
+
+status_t
+port_buffers_init(void)
+{
+	new(&sMappings) MappingHashTable;
+	new(&sTeams) TeamHashTable;
+	for (uint32 i = 0; i < kSizeClassCount; i++)
+		new(&sFreeBuffers[i]) BufferList;
+
+	if (sMappings.Init() != B_OK || sTeams.Init() != B_OK) {
+		panic("Failed to init port buffer hash tables!");
+		return B_NO_MEMORY;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Forgets the team's mappings, and returns the buffers it owns to the pool.
+	The team's areas must already have been deleted.
+*/
+void
+delete_team_port_buffers(Team* team)
+{
+	MutexLocker locker(sLock);
+
+	TeamPortBuffers* teamBuffers = sTeams.Lookup(team->id);
+	if (teamBuffers == NULL)
+		return;
+
+	sTeams.RemoveUnchecked(teamBuffers);
+
+	BufferList deletionList;
+	while (PortBufferMapping* mapping = teamBuffers->mappings.RemoveHead()) {
+		PortBuffer* buffer = mapping->buffer;
+		buffer->mappings.Remove(mapping);
+		sMappings.RemoveUnchecked(mapping);
+		if (buffer->open_mapping == mapping)
+			buffer->open_mapping = NULL;
+
+		if (buffer->state == PortBuffer::kOwned && buffer->owner == team->id
+			&& !free_buffer_locked(buffer)) {
+			deletionList.Add(buffer);
+		}
+
+		delete mapping;
+	}
+
+	locker.Unlock();
+
+	delete teamBuffers;
+
+	while (PortBuffer* buffer = deletionList.RemoveHead())
+		delete_buffer(buffer);
+}
+
+
+bool
+is_port_buffer_area(area_id area)
+{
+	MutexLocker locker(sLock);
+	return sMappings.Lookup(area) != NULL;
+}
+
+
+/*!	Gets a buffer of at least \a size bytes that the current team can write.
+	Returns the ID of the team's area for it.
+*/
+area_id
+acquire_port_buffer(size_t size, void** _address)
+{
+	const team_id team = team_get_current_team_id();
+
+	area_id area;
+	status_t status = get_buffer(size, team, kWriteAccess, NULL, &area,
+		_address);
+	if (status != B_OK)
+		return status;
+
+	return area;
+}
+
+
+/*!	Returns a buffer the current team owns to the pool. The team keeps its
+	access to it until the buffer is handed out to someone else.
+*/
+status_t
+release_port_buffer(area_id area)
+{
+	const team_id team = team_get_current_team_id();
+
+	MutexLocker locker(sLock);
+
+	PortBufferMapping* mapping = sMappings.Lookup(area);
+	if (mapping == NULL || mapping->team != team)
+		return B_BAD_VALUE;
+
+	PortBuffer* buffer = mapping->buffer;
+	if (buffer->state != PortBuffer::kOwned || buffer->owner != team)
+		return B_BAD_VALUE;
+
+	disown_buffer_locked(buffer);
+	bool pooled = free_buffer_locked(buffer);
+	locker.Unlock();
+
+	if (!pooled)
+		delete_buffer(buffer);
+	return B_OK;
+}
+
+
+/*!	Takes away a buffer from the current team to send it, and makes it
+	inaccessible. \a size must not exceed the size of the buffer.
+*/
+status_t
+port_buffer_detach(area_id area, size_t size, PortBuffer** _buffer)
+{
+	const team_id team = team_get_current_team_id();
+
+	MutexLocker locker(sLock);
+
+	PortBufferMapping* mapping = sMappings.Lookup(area);
+	if (mapping == NULL || mapping->team != team)
+		return B_BAD_VALUE;
+
+	PortBuffer* buffer = mapping->buffer;
+	if (buffer->state != PortBuffer::kOwned || buffer->owner != team
+		|| size > buffer->size) {
+		return B_BAD_VALUE;
+	}
+
+	disown_buffer_locked(buffer);
+	buffer->state = PortBuffer::kInTransit;
+	buffer->open_mapping = NULL;
+	mapping->access = kNoAccess;
+
+	locker.Unlock();
+
+	status_t status = vm_set_area_protection(VMAddressSpace::KernelID(), area,
+		kNoAccessProtection, true);
+	if (status != B_OK) {
+		// can't really happen, as userland cannot touch the area
+		port_buffer_put(buffer);
+		return status;
+	}
+
+	*_buffer = buffer;
+	return B_OK;
+}
+
+
+/*!	Hands a buffer that was in transit to the current team, which can read it
+	then. On failure, the buffer stays in transit.
+*/
+status_t
+port_buffer_attach(PortBuffer* buffer, area_id* _area, void** _address)
+{
+	MutexLocker locker(sLock);
+
+	status_t status = own_buffer_locked(buffer, team_get_current_team_id());
+	if (status != B_OK)
+		return status;
+
+	locker.Unlock();
+
+	PortBufferMapping* mapping;
+	status = set_buffer_access(buffer, kReadAccess, false, NULL, 0, &mapping);
+
+	locker.Lock();
+
+	if (status != B_OK) {
+		disown_buffer_locked(buffer);
+		buffer->state = PortBuffer::kInTransit;
+		return status;
+	}
+
+	buffer->state = PortBuffer::kOwned;
+	*_area = mapping->area;
+	*_address = mapping->address;
+	return B_OK;
+}
+
+
+/*!	Copies a message that was not sent in a buffer into a new buffer, which
+	the current team can read.
+*/
+status_t
+port_buffer_create(const void* data, size_t size, team_id origin,
+	area_id* _area, void** _address)
+{
+	return get_buffer(size, origin, kReadAccess, data, _area, _address);
+}
+
+
+/*!	Returns a buffer in transit to the pool. */
+void
+port_buffer_put(PortBuffer* buffer)
+{
+	put_buffer(buffer);
+}
+
+
+const void*
+port_buffer_data(PortBuffer* buffer)
+{
+	return buffer->address;
+}
+
+
+//	#pragma mark - syscalls
+
+
+area_id
+_user_acquire_port_buffer(size_t size, void** _userAddress)
+{
+	if (_userAddress == NULL || !IS_USER_ADDRESS(_userAddress))
+		return B_BAD_ADDRESS;
+
+	void* address;
+	area_id area = acquire_port_buffer(size, &address);
+	if (area < 0)
+		return area;
+
+	if (user_memcpy(_userAddress, &address, sizeof(void*)) != B_OK) {
+		release_port_buffer(area);
+		return B_BAD_ADDRESS;
+	}
+
+	return area;
+}
+
+
+status_t
+_user_release_port_buffer(area_id area)
+{
+	return release_port_buffer(area);
+}
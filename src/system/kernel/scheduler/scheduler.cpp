@@ -16,6 +16,8 @@
 
 #include <OS.h>
 
+#include <unistd.h>
+
 #include <AutoDeleter.h>
 #include <cpu.h>
 #include <debug.h>
@@ -74,9 +76,18 @@ static scheduler_mode_operations* sSchedulerModes[] = {
 static int32* sCPUToCore;
 static int32* sCPUToPackage;
 
+// The bandwidth reserved by threads with a deadline reservation on each CPU.
+// Protected by sDeadlineLock.
+static int64 sDeadlineBandwidth[SMP_MAX_CPUS];
+static spinlock sDeadlineLock = B_SPINLOCK_INITIALIZER;
+
 
 static void enqueue(Thread* thread, bool newOne);
 
+// An idle CPU only pulls a thread from a core in another package, if that
+// core has at least this many more ready threads than idle CPUs.
+static const int32 kRemoteStealThreshold = 2;
+
 
 void
 ThreadEnqueuer::operator()(ThreadData* thread)
@@ -102,9 +113,13 @@ enqueue(Thread* thread, bool newOne)
 	int32 threadPriority = threadData->GetEffectivePriority();
 	T(EnqueueThread(thread, threadPriority));
 
+	const bool isDeadline = threadData->IsDeadline();
+
 	CPUEntry* targetCPU = NULL;
 	CoreEntry* targetCore = NULL;
-	if (thread->pinned_to_cpu > 0) {
+	if (isDeadline) {
+		targetCPU = threadData->DeadlineCPU();
+	} else if (thread->pinned_to_cpu > 0) {
 		ASSERT(thread->previous_cpu != NULL);
 		ASSERT(threadData->Core() != NULL);
 		targetCPU = &gCPUEntries[thread->previous_cpu->cpu_num];
@@ -127,10 +142,13 @@ enqueue(Thread* thread, bool newOne)
 	NotifySchedulerListeners(&SchedulerListener::ThreadEnqueuedInRunQueue,
 		thread);
 
+	// A thread with a deadline reservation only preempts its CPU's current
+	// thread, if that doesn't run with an earlier deadline.
 	int32 heapPriority = CPUPriorityHeap::GetKey(targetCPU);
-	if (threadPriority > heapPriority
-		|| (threadPriority == heapPriority && rescheduleNeeded)
-		|| wasRunQueueEmpty) {
+	if (isDeadline ? wasRunQueueEmpty
+			: (threadPriority > heapPriority
+				|| (threadPriority == heapPriority && rescheduleNeeded)
+				|| wasRunQueueEmpty)) {
 
 		if (targetCPU->ID() == smp_get_current_cpu()) {
 			gCPU[targetCPU->ID()].invoke_scheduler = true;
@@ -142,6 +160,187 @@ enqueue(Thread* thread, bool newOne)
 }
 
 
+static bool
+steal_thread_from(CPUEntry* cpu, CoreEntry* core, CoreEntry* victim,
+	bool remote)
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	Profiling::WorkStealingStats& stats
+		= Profiling::gWorkStealingStats[cpu->ID()];
+
+	// Across packages the thread would lose its cache contents, so only take
+	// threads whose cache affinity has expired anyway.
+	int32 cacheHotSkipped = 0;
+	ThreadData* threadData = victim->StealThread(cpu, remote, cacheHotSkipped);
+	stats.cache_hot_skips += cacheHotSkipped;
+	if (threadData == NULL)
+		return false;
+
+	Thread* thread = threadData->GetThread();
+	TRACE("cpu %" B_PRId32 " steals thread %" B_PRId32 " from core %" B_PRId32
+		"\n", cpu->ID(), thread->id, victim->ID());
+
+	// move the thread (and its load) over to our core
+	CoreEntry* targetCore = core;
+	CPUEntry* targetCPU = cpu;
+	threadData->ChooseCoreAndCPU(targetCore, targetCPU);
+	ASSERT(threadData->Core() == core);
+
+	bool wasRunQueueEmpty;
+	threadData->Enqueue(wasRunQueueEmpty);
+
+	release_spinlock(&thread->scheduler_lock);
+
+	if (remote)
+		stats.remote_steals++;
+	else
+		stats.package_steals++;
+	return true;
+}
+
+
+/*!	Called when \a cpu is about to go idle. Looks for a busier core whose
+	ready threads could run here instead -- first in the same package, then
+	in the other packages -- and migrates one thread to our core's run queue.
+*/
+static void
+steal_thread(CPUEntry* cpu, CoreEntry* core)
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	Profiling::gWorkStealingStats[cpu->ID()].attempts++;
+
+	// Power saving mode deliberately keeps threads on as few packages as
+	// possible.
+	const bool stealRemote = gCurrentModeID != SCHEDULER_MODE_POWER_SAVING
+		&& gPackageCount > 1;
+
+	for (int32 pass = 0; pass < (stealRemote ? 2 : 1); pass++) {
+		const bool remote = pass == 1;
+		const int32 threshold = remote ? kRemoteStealThreshold : 1;
+
+		// try the core with the most surplus threads first
+		CoreEntry* victim = NULL;
+		int32 victimSurplus = threshold - 1;
+		for (int32 i = 0; i < gCoreCount; i++) {
+			CoreEntry* other = &gCoreEntries[i];
+			if (other == core || other->CPUCount() == 0
+				|| (other->Package() != core->Package()) != remote) {
+				continue;
+			}
+
+			int32 surplus = other->QueuedThreadCount() - other->IdleCPUCount();
+			if (surplus > victimSurplus) {
+				victim = other;
+				victimSurplus = surplus;
+			}
+		}
+
+		if (victim != NULL && steal_thread_from(cpu, core, victim, remote))
+			return;
+	}
+
+	Profiling::gWorkStealingStats[cpu->ID()].failures++;
+}
+
+
+static int32
+replenish_deadline_runtime(timer* timer)
+{
+	ThreadData* threadData = (ThreadData*)timer->user_data;
+	Thread* thread = threadData->GetThread();
+
+	SpinLocker locker(thread->scheduler_lock);
+	SchedulerModeLocker modeLocker;
+
+	ASSERT(threadData->IsThrottled());
+	threadData->SetThrottled(false);
+
+	TRACE("thread %" B_PRId32 " may continue with deadline %" B_PRId64 "\n",
+		thread->id, threadData->GetDeadline());
+
+	enqueue(thread, false);
+	return B_HANDLED_INTERRUPT;
+}
+
+
+/*!	Takes the thread out of the run queues until \a until, because it has
+	used up the runtime its deadline reservation grants it for the current
+	period. The thread lock must be held.
+*/
+static void
+throttle_thread(Thread* thread, bigtime_t until)
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	ThreadData* threadData = thread->scheduler_data;
+	ASSERT(!threadData->IsThrottled());
+
+	TRACE("throttling thread %" B_PRId32 " until %" B_PRId64 "\n", thread->id,
+		until);
+
+	// The thread stays ready, but won't be enqueued until the timer fires.
+	// The timer is never cancelled: the thread can't go away in the meantime,
+	// since it doesn't run.
+	threadData->SetThrottled(true);
+	thread->state = B_THREAD_READY;
+
+	timer* replenishTimer = threadData->ReplenishTimer();
+	replenishTimer->user_data = threadData;
+	add_timer(replenishTimer, &replenish_deadline_runtime, until,
+		B_ONE_SHOT_ABSOLUTE_TIMER);
+}
+
+
+/*!	Returns the CPU with the least reserved bandwidth that can still admit
+	\a bandwidth and that \a thread may run on, or \c NULL, if there is none.
+	sDeadlineLock must be held.
+*/
+static CPUEntry*
+choose_deadline_cpu(ThreadData* threadData, int64 bandwidth)
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	CPUSet mask = threadData->GetCPUMask();
+	const bool useMask = !mask.IsEmpty();
+
+	CPUEntry* cpu = NULL;
+	int32 cpuCount = smp_get_num_cpus();
+	for (int32 i = 0; i < cpuCount; i++) {
+		if (gCPU[i].disabled || (useMask && !mask.GetBit(i)))
+			continue;
+		if (sDeadlineBandwidth[i] + bandwidth > kMaxDeadlineBandwidth)
+			continue;
+
+		if (cpu == NULL || sDeadlineBandwidth[i] < sDeadlineBandwidth[cpu->ID()])
+			cpu = &gCPUEntries[i];
+	}
+
+	return cpu;
+}
+
+
+/*!	Gives back the bandwidth reserved by the thread when it dies. The thread
+	lock must be held.
+*/
+static void
+release_deadline_reservation(ThreadData* threadData)
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	if (!threadData->HasDeadline())
+		return;
+
+	SpinLocker locker(sDeadlineLock);
+	sDeadlineBandwidth[threadData->DeadlineCPU()->ID()]
+		-= threadData->GetDeadlineBandwidth();
+	locker.Unlock();
+
+	threadData->SetDeadline(NULL, 0, 0, 0);
+}
+
+
 /*!	Enqueues the thread into the run queue.
 	Note: thread lock must be held when entering this function
 */
@@ -161,6 +360,9 @@ scheduler_enqueue_in_run_queue(Thread *thread)
 	if (threadData->ShouldCancelPenalty())
 		threadData->CancelPenalty();
 
+	if (threadData->HasDeadline())
+		threadData->DeadlineWakesUp();
+
 	enqueue(thread, true);
 }
 
@@ -190,7 +392,7 @@ scheduler_set_thread_priority(Thread *thread, int32 priority)
 		return oldPriority;
 
 	if (thread->state != B_THREAD_READY) {
-		if (thread->state == B_THREAD_RUNNING) {
+		if (thread->state == B_THREAD_RUNNING && !threadData->IsDeadline()) {
 			ASSERT(threadData->Core() != NULL);
 
 			ASSERT(thread->cpu != NULL);
@@ -219,6 +421,95 @@ scheduler_set_thread_priority(Thread *thread, int32 priority)
 }
 
 
+/*!	Sets the deadline reservation of a thread: it will get \a runtime us of
+	CPU time within \a deadline us after the start of each period of
+	\a period us. A \a deadline of 0 means the end of the period, a
+	\a runtime of 0 removes the reservation.
+	Returns \c B_BUSY, if none of the CPUs the thread may run on can admit
+	the reservation.
+*/
+status_t
+scheduler_set_thread_deadline(Thread* thread, bigtime_t runtime,
+	bigtime_t deadline, bigtime_t period)
+{
+	ASSERT(are_interrupts_enabled());
+
+	if (runtime != 0) {
+		if (deadline == 0)
+			deadline = period;
+		if (runtime < kMinimalDeadlineRuntime || runtime > deadline
+			|| deadline > period || period > kMaximalDeadlinePeriod) {
+			return B_BAD_VALUE;
+		}
+	}
+
+	if (thread_is_idle_thread(thread))
+		return B_NOT_ALLOWED;
+
+	InterruptsSpinLocker _(thread->scheduler_lock);
+	SchedulerModeLocker modeLocker;
+
+	SCHEDULER_ENTER_FUNCTION();
+
+	ThreadData* threadData = thread->scheduler_data;
+
+	// admission control: the reservation is assigned to a single CPU
+	SpinLocker deadlineLocker(sDeadlineLock);
+
+	CPUEntry* oldCPU = threadData->DeadlineCPU();
+	int64 oldBandwidth = threadData->GetDeadlineBandwidth();
+	if (oldCPU != NULL)
+		sDeadlineBandwidth[oldCPU->ID()] -= oldBandwidth;
+
+	CPUEntry* cpu = NULL;
+	if (runtime != 0) {
+		int64 bandwidth = runtime * kDeadlineBandwidthScale / deadline;
+		cpu = choose_deadline_cpu(threadData, bandwidth);
+		if (cpu == NULL) {
+			if (oldCPU != NULL)
+				sDeadlineBandwidth[oldCPU->ID()] += oldBandwidth;
+			return B_BUSY;
+		}
+
+		sDeadlineBandwidth[cpu->ID()] += bandwidth;
+	}
+
+	deadlineLocker.Unlock();
+
+	TRACE("thread %" B_PRId32 " gets a reservation of %" B_PRId64 " us every %"
+		B_PRId64 " us on CPU %" B_PRId32 "\n", thread->id, runtime, period,
+		cpu != NULL ? cpu->ID() : -1);
+
+	bool wasEnqueued = false;
+	if (thread->state == B_THREAD_READY) {
+		T(RemoveThread(thread));
+
+		// notify listeners
+		NotifySchedulerListeners(&SchedulerListener::ThreadRemovedFromRunQueue,
+			thread);
+
+		wasEnqueued = threadData->Dequeue();
+	}
+
+	threadData->SetDeadline(cpu, runtime, deadline, period);
+
+	if (wasEnqueued)
+		enqueue(thread, true);
+	else if (thread->state == B_THREAD_RUNNING) {
+		// let the thread's CPU pick up the change
+		int32 cpuID = thread->cpu->cpu_num;
+		if (cpuID == smp_get_current_cpu())
+			gCPU[cpuID].invoke_scheduler = true;
+		else {
+			smp_send_ici(cpuID, SMP_MSG_RESCHEDULE, 0, 0, 0, NULL,
+				SMP_MSG_FLAG_ASYNC);
+		}
+	}
+
+	return B_OK;
+}
+
+
 void
 scheduler_reschedule_ici()
 {
@@ -374,6 +665,7 @@ reschedule(int32 nextState)
 			break;
 		case THREAD_STATE_FREE_ON_RESCHED:
 			oldThreadData->Dies();
+			release_deadline_reservation(oldThreadData);
 			break;
 		default:
 			oldThreadData->GoesAway();
@@ -384,6 +676,16 @@ reschedule(int32 nextState)
 
 	oldThread->has_yielded = false;
 
+	// charge the time the thread has run to its deadline reservation, and
+	// throttle it, if it has used up its runtime
+	if (oldThreadData->IsDeadline()) {
+		bigtime_t continueTime = oldThreadData->ChargeDeadlineRuntime();
+		if (enqueueOldThread && continueTime > system_time()) {
+			throttle_thread(oldThread, continueTime);
+			enqueueOldThread = false;
+		}
+	}
+
 	// select thread with the biggest priority and enqueue back the old thread
 	ThreadData* nextThreadData;
 	if (gCPU[thisCPU].disabled) {
@@ -410,6 +712,35 @@ reschedule(int32 nextState)
 		if (oldThreadShouldMigrate)
 			enqueueOldThread = false;
 
+		// A thread with a deadline reservation goes back into the deadline
+		// run queue of its CPU, so that it competes with the other threads
+		// there by deadline.
+		if (enqueueOldThread && oldThreadData->IsDeadline()) {
+			if (oldThreadData->DeadlineCPU() == cpu) {
+				bool wasRunQueueEmpty;
+				oldThreadData->Enqueue(wasRunQueueEmpty);
+			} else
+				enqueue(oldThread, false);
+			enqueueOldThread = false;
+		}
+
+		// If this CPU would go idle otherwise, try to take over a thread
+		// another core hasn't got around to run yet.
+		if (!gSingleCore && (!enqueueOldThread || oldThreadData->IsIdle())) {
+			CPURunQueueLocker cpuLocker(cpu);
+			ThreadData* pinnedThread = cpu->PeekThread();
+			bool goesIdle = cpu->PeekDeadlineThread() == NULL
+				&& (pinnedThread == NULL || pinnedThread->IsIdle());
+			if (goesIdle) {
+				CoreRunQueueLocker coreLocker(core);
+				goesIdle = core->PeekThread() == NULL;
+			}
+			cpuLocker.Unlock();
+
+			if (goesIdle)
+				steal_thread(cpu, core);
+		}
+
 		nextThreadData
 			= cpu->ChooseNextThread(enqueueOldThread ? oldThreadData : NULL,
 				putOldThreadAtBack);
@@ -421,9 +752,11 @@ reschedule(int32 nextState)
 				nextThreadData = cpu->PeekIdleThread();
 		}
 
-		// update CPU heap
+		// update CPU heap -- a CPU running a thread with a deadline
+		// reservation is not available to anyone else
 		CoreCPUHeapLocker cpuLocker(core);
-		cpu->UpdatePriority(nextThreadData->GetEffectivePriority());
+		cpu->UpdatePriority(nextThreadData->IsDeadline()
+			? THREAD_MAX_SET_PRIORITY : nextThreadData->GetEffectivePriority());
 	}
 
 	Thread* nextThread = nextThreadData->GetThread();
@@ -600,6 +933,13 @@ scheduler_set_cpu_enabled(int32 cpuID, bool enabled)
 	else
 		gCPUEnabled.ClearBitAtomic(cpuID);
 
+	if (!enabled) {
+		// The reservations on the CPU are suspended until it is enabled again,
+		// until then the threads are scheduled like all others.
+		ThreadEnqueuer enqueuer;
+		cpu->RemoveDeadlineThreads(enqueuer);
+	}
+
 	if (!enabled) {
 		cpu->Stop();
 
@@ -751,6 +1091,7 @@ scheduler_init()
 	scheduler_set_operation_mode(SCHEDULER_MODE_LOW_LATENCY);
 
 	init_debug_commands();
+	Profiling::init_work_stealing_stats();
 
 #if SCHEDULER_TRACING
 	add_debugger_command_etc("scheduler", &cmd_scheduler,
@@ -873,3 +1214,66 @@ _user_get_scheduler_mode()
 	return gCurrentModeID;
 }
 
+
+status_t
+_user_set_thread_deadline(thread_id id,
+	const struct thread_deadline_params* userParams)
+{
+	thread_deadline_params params = {};
+	if (userParams != NULL
+		&& (!IS_USER_ADDRESS(userParams)
+			|| user_memcpy(&params, userParams, sizeof(params)) != B_OK)) {
+		return B_BAD_ADDRESS;
+	}
+
+	// get the thread
+	Thread* thread;
+	if (id < 0) {
+		thread = thread_get_current_thread();
+		thread->AcquireReference();
+	} else {
+		thread = Thread::Get(id);
+		if (thread == NULL)
+			return B_BAD_THREAD_ID;
+	}
+	BReference<Thread> threadReference(thread, true);
+
+	// only root may reserve CPU time for other teams' threads
+	if (thread->team != thread_get_current_thread()->team && geteuid() != 0)
+		return B_NOT_ALLOWED;
+
+	return scheduler_set_thread_deadline(thread, params.runtime,
+		params.deadline, params.period);
+}
+
+
+status_t
+_user_get_thread_deadline(thread_id id,
+	struct thread_deadline_params* userParams)
+{
+	if (userParams == NULL || !IS_USER_ADDRESS(userParams))
+		return B_BAD_ADDRESS;
+
+	// get the thread
+	Thread* thread;
+	if (id < 0) {
+		thread = thread_get_current_thread();
+		thread->AcquireReference();
+	} else {
+		thread = Thread::Get(id);
+		if (thread == NULL)
+			return B_BAD_THREAD_ID;
+	}
+	BReference<Thread> threadReference(thread, true);
+
+	thread_deadline_params params;
+	InterruptsSpinLocker locker(thread->scheduler_lock);
+	thread->scheduler_data->GetDeadlineParameters(params.runtime,
+		params.deadline, params.period);
+	locker.Unlock();
+
+	if (user_memcpy(userParams, &params, sizeof(params)) != B_OK)
+		return B_BAD_ADDRESS;
+
+	return B_OK;
+}
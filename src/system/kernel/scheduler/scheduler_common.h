@@ -42,6 +42,14 @@ const int kVeryHighLoad = (kMaxLoad + kHighLoad) / 2;
 
 const int kLoadDifference = kMaxLoad * 20 / 100;
 
+// Deadline reservations: the bandwidth of a reservation is its runtime
+// relative to its deadline, a fully used CPU has kDeadlineBandwidthScale.
+// Some CPU time is always left to the threads without a reservation.
+const int64 kDeadlineBandwidthScale = 1 << 20;
+const int64 kMaxDeadlineBandwidth = kDeadlineBandwidthScale * 95 / 100;
+const bigtime_t kMinimalDeadlineRuntime = 100;
+const bigtime_t kMaximalDeadlinePeriod = 10000000;
+
 extern bool gSingleCore;
 extern bool gTrackCoreLoad;
 extern bool gTrackCPULoad;
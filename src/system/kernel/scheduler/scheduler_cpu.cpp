@@ -79,6 +79,7 @@ ThreadRunQueue::Dump() const
 
 CPUEntry::CPUEntry()
 	:
+	fRunningDeadline(B_INFINITE_TIMEOUT),
 	fLoad(0),
 	fMeasureActiveTime(0),
 	fMeasureTime(0),
@@ -152,6 +153,56 @@ CPUEntry::Remove(ThreadData* thread)
 }
 
 
+/*!	Inserts \a thread into the deadline run queue, behind all threads with
+	an earlier or the same deadline. The run queue lock must be held.
+*/
+void
+CPUEntry::PushDeadline(ThreadData* thread)
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	// Admission control keeps the number of threads with a reservation on a
+	// single CPU small, so a sorted list is good enough.
+	ThreadData* before = fDeadlineRunQueue.Head();
+	while (before != NULL && before->GetDeadline() <= thread->GetDeadline())
+		before = fDeadlineRunQueue.GetNext(before);
+
+	fDeadlineRunQueue.InsertBefore(before, thread);
+}
+
+
+void
+CPUEntry::RemoveDeadline(ThreadData* thread)
+{
+	SCHEDULER_ENTER_FUNCTION();
+	ASSERT(thread->IsEnqueued());
+	thread->SetDequeued();
+	fDeadlineRunQueue.Remove(thread);
+}
+
+
+/*!	Empties the deadline run queue, e.g. because the CPU is being disabled.
+	The threads are passed to \a threadPostProcessing one by one, without the
+	run queue lock being held.
+*/
+void
+CPUEntry::RemoveDeadlineThreads(ThreadProcessing& threadPostProcessing)
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	while (true) {
+		CPURunQueueLocker locker(this);
+		ThreadData* thread = fDeadlineRunQueue.Head();
+		if (thread == NULL)
+			break;
+		RemoveDeadline(thread);
+		locker.Unlock();
+
+		threadPostProcessing(thread);
+	}
+}
+
+
 ThreadData*
 CoreEntry::PeekThread() const
 {
@@ -225,6 +276,17 @@ CPUEntry::ChooseNextThread(ThreadData* oldThread, bool putAtBack)
 
 	CPURunQueueLocker cpuLocker(this);
 
+	// Threads with a deadline reservation on this CPU are picked in EDF order
+	// before anything else. A preempted one has already been put back into
+	// the deadline run queue by the caller.
+	ThreadData* deadlineThread = fDeadlineRunQueue.Head();
+	if (deadlineThread != NULL) {
+		RemoveDeadline(deadlineThread);
+		fRunningDeadline = deadlineThread->GetDeadline();
+		return deadlineThread;
+	}
+	fRunningDeadline = B_INFINITE_TIMEOUT;
+
 	ThreadData* pinnedThread = fRunQueue.PeekMaximum();
 	int32 pinnedPriority = -1;
 	if (pinnedThread != NULL)
@@ -306,6 +368,11 @@ CPUEntry::StartQuantumTimer(ThreadData* thread, bool wasPreempted)
 
 	if (!thread->IsIdle()) {
 		bigtime_t quantum = thread->GetQuantumLeft();
+		if (thread->IsDeadline()) {
+			// make sure the thread is throttled as soon as its runtime for
+			// the current period is used up
+			quantum = std::min(quantum, thread->GetDeadlineRuntimeLeft());
+		}
 		add_timer(&cpu->quantum_timer, &CPUEntry::_RescheduleEvent, quantum,
 			B_ONE_SHOT_RELATIVE_TIMER);
 	} else if (gTrackCoreLoad) {
@@ -462,6 +529,54 @@ CoreEntry::Remove(ThreadData* thread)
 }
 
 
+/*!	Removes a thread that is allowed to run on \a thief from the run queue,
+	so that the (idle) thief can take it over. The highest priority thread is
+	preferred. If \a coldCacheOnly is \c true, threads that still have cache
+	affinity to this core are left alone.
+	Returns the thread with its scheduler lock held, or \c NULL.
+*/
+ThreadData*
+CoreEntry::StealThread(CPUEntry* thief, bool coldCacheOnly,
+	int32& cacheHotSkipped)
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	CoreRunQueueLocker _(this);
+
+	// The idle CPUs of this core will pick up that many threads themselves.
+	if (fThreadCount <= fIdleCPUCount)
+		return NULL;
+
+	ThreadRunQueue::ConstIterator iterator = fRunQueue.GetConstIterator();
+	while (iterator.HasNext()) {
+		ThreadData* threadData = iterator.Next();
+		Thread* thread = threadData->GetThread();
+
+		if (threadData->IsIdle() || thread->pinned_to_cpu > 0)
+			continue;
+
+		CPUSet mask = threadData->GetCPUMask();
+		if (!mask.IsEmpty() && !mask.GetBit(thief->ID()))
+			continue;
+
+		if (coldCacheOnly && !threadData->HasCacheExpired()) {
+			cacheHotSkipped++;
+			continue;
+		}
+
+		// The run queue lock nests inside the thread's scheduler lock, so we
+		// must not wait for it here.
+		if (!try_acquire_spinlock(&thread->scheduler_lock))
+			continue;
+
+		Remove(threadData);
+		return threadData;
+	}
+
+	return NULL;
+}
+
+
 void
 CoreEntry::AddCPU(CPUEntry* cpu)
 {
@@ -695,6 +810,20 @@ DebugDumper::DumpCPURunQueue(CPUEntry* cpu)
 		kprintf("\nCPU %" B_PRId32 " run queue:\n", cpu->ID());
 		cpu->fRunQueue.Dump();
 	}
+
+	if (!cpu->fDeadlineRunQueue.IsEmpty()) {
+		kprintf("\nCPU %" B_PRId32 " deadline run queue:\n", cpu->ID());
+		kprintf("thread      id      deadline          runtime left  name\n");
+
+		DeadlineRunQueue::Iterator deadlineIterator
+			= cpu->fDeadlineRunQueue.GetIterator();
+		while (ThreadData* threadData = deadlineIterator.Next()) {
+			Thread* thread = threadData->GetThread();
+			kprintf("%p  %-7" B_PRId32 " %-17" B_PRId64 " %-13" B_PRId64 " %s\n",
+				thread, thread->id, threadData->GetDeadline(),
+				threadData->GetDeadlineRuntimeLeft(), thread->name);
+		}
+	}
 }
 
 
@@ -11,6 +11,7 @@
 #include <smp.h>
 #include <thread.h>
 #include <util/AutoLock.h>
+#include <util/DoublyLinkedList.h>
 #include <util/Heap.h>
 #include <util/MinMaxHeap.h>
 
@@ -43,6 +44,11 @@ public:
 						void			Dump() const;
 };
 
+// Threads with a deadline reservation on a logical processor, ordered by
+// their absolute deadlines. They are scheduled before any thread in the
+// priority based run queues.
+typedef DoublyLinkedList<ThreadData> DeadlineRunQueue;
+
 class CPUEntry : public HeapLinkImpl<CPUEntry, int32> {
 public:
 										CPUEntry();
@@ -72,6 +78,16 @@ public:
 						ThreadData*		PeekThread() const;
 						ThreadData*		PeekIdleThread() const;
 
+						void			PushDeadline(ThreadData* thread);
+						void			RemoveDeadline(ThreadData* thread);
+	inline				ThreadData*		PeekDeadlineThread() const
+											{ return fDeadlineRunQueue.Head(); }
+						void			RemoveDeadlineThreads(
+											ThreadProcessing&
+												threadPostProcessing);
+	inline				bigtime_t		RunningDeadline() const
+											{ return fRunningDeadline; }
+
 						void			UpdatePriority(int32 priority);
 
 	inline				int32			GetLoad() const	{ return fLoad; }
@@ -101,6 +117,8 @@ private:
 						rw_spinlock 	fSchedulerModeLock;
 
 						ThreadRunQueue	fRunQueue;
+						DeadlineRunQueue fDeadlineRunQueue;
+						bigtime_t		fRunningDeadline;
 						spinlock		fQueueLock;
 
 						int32			fLoad;
@@ -141,6 +159,10 @@ public:
 	inline				CPUPriorityHeap*	CPUHeap();
 
 	inline				int32			ThreadCount() const;
+	inline				int32			QueuedThreadCount() const
+											{ return fThreadCount; }
+	inline				int32			IdleCPUCount() const
+											{ return fIdleCPUCount; }
 
 	inline				void			LockRunQueue();
 	inline				void			UnlockRunQueue();
@@ -152,6 +174,10 @@ public:
 						void			Remove(ThreadData* thread);
 						ThreadData*		PeekThread() const;
 
+						ThreadData*		StealThread(CPUEntry* thief,
+											bool coldCacheOnly,
+											int32& cacheHotSkipped);
+
 	inline				bigtime_t		GetActiveTime() const;
 	inline				void			IncreaseActiveTime(
 											bigtime_t activeTime);
@@ -5,6 +5,8 @@
 
 #include "scheduler_profiler.h"
 
+#include <string.h>
+
 #include <debug.h>
 #include <util/AutoLock.h>
 
@@ -321,3 +323,55 @@ dump_profiler(int argc, char** argv)
 
 #endif	// SCHEDULER_PROFILING
 
+
+// #pragma mark - work stealing
+
+
+Scheduler::Profiling::WorkStealingStats
+	Scheduler::Profiling::gWorkStealingStats[SMP_MAX_CPUS];
+
+
+static int
+dump_work_stealing_stats(int argc, char** argv)
+{
+	using Scheduler::Profiling::gWorkStealingStats;
+
+	int32 cpuCount = smp_get_num_cpus();
+
+	if (argc == 2 && !strcmp(argv[1], "reset")) {
+		memset(gWorkStealingStats, 0,
+			sizeof(gWorkStealingStats[0]) * cpuCount);
+		return 0;
+	} else if (argc > 1) {
+		print_debugger_command_usage(argv[0]);
+		return 0;
+	}
+
+	kprintf("cpu     attempts      package       remote   cache-hot     failed"
+		"\n");
+	for (int32 i = 0; i < cpuCount; i++) {
+		kprintf("%3" B_PRId32 " %12" B_PRId64 " %12" B_PRId64 " %12" B_PRId64
+			" %11" B_PRId64 " %10" B_PRId64 "\n", i,
+			gWorkStealingStats[i].attempts,
+			gWorkStealingStats[i].package_steals,
+			gWorkStealingStats[i].remote_steals,
+			gWorkStealingStats[i].cache_hot_skips,
+			gWorkStealingStats[i].failures);
+	}
+
+	return 0;
+}
+
+
+void
+Scheduler::Profiling::init_work_stealing_stats()
+{
+	add_debugger_command_etc("steal_stats", &dump_work_stealing_stats,
+		"Show idle work stealing statistics of the scheduler",
+		"[ reset ]\n"
+		"Shows how often idle CPUs tried to pull threads from other cores,\n"
+		"how often they succeeded within their package and across packages,\n"
+		"how many threads were left alone because of their cache affinity,\n"
+		"and how often no thread could be found.\n"
+		"  reset  - Reset the counters.\n", 0);
+}
@@ -6,6 +6,7 @@
 #define KERNEL_SCHEDULER_PROFILER_H
 
 
+#include <cpu.h>
 #include <smp.h>
 
 
@@ -132,5 +133,30 @@ Function::Exit()
 #endif	// !SCHEDULER_PROFILING
 
 
+namespace Scheduler {
+
+namespace Profiling {
+
+
+// Idle work stealing counters. These are always collected; each CPU only
+// updates its own entry, with interrupts disabled.
+struct WorkStealingStats {
+			int64			attempts;
+			int64			package_steals;
+			int64			remote_steals;
+			int64			cache_hot_skips;
+			int64			failures;
+} CACHE_LINE_ALIGN;
+
+extern WorkStealingStats gWorkStealingStats[SMP_MAX_CPUS];
+
+void init_work_stealing_stats();
+
+
+}	// namespace Profiling
+
+}	// namespace Scheduler
+
+
 #endif	// KERNEL_SCHEDULER_PROFILER_H
 
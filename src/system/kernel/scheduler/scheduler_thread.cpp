@@ -39,6 +39,16 @@ ThreadData::_InitBase()
 	fMeasureAvailableActiveTime = 0;
 	fLastMeasureAvailableTime = 0;
 	fMeasureAvailableTime = 0;
+
+	fDeadlineCPU = NULL;
+	fDeadlineRuntime = 0;
+	fRelativeDeadline = 0;
+	fDeadlinePeriod = 0;
+	fAbsoluteDeadline = 0;
+	fDeadlineRuntimeLeft = 0;
+	fDeadlineChargeStart = 0;
+	fDeadlineEnqueued = false;
+	fThrottled = false;
 }
 
 
@@ -155,6 +165,17 @@ ThreadData::Dump() const
 		fCore != NULL ? fCore->ID() : -1);
 	if (fCore != NULL && HasCacheExpired())
 		kprintf("\tcache affinity has expired\n");
+
+	if (fDeadlineCPU != NULL) {
+		kprintf("\tdeadline_cpu:\t\t%" B_PRId32 "%s\n", fDeadlineCPU->ID(),
+			IsDeadline() ? "" : " (not in effect)");
+		kprintf("\treservation:\t\t%" B_PRId64 " us every %" B_PRId64
+			" us, within %" B_PRId64 " us\n", fDeadlineRuntime,
+			fDeadlinePeriod, fRelativeDeadline);
+		kprintf("\tdeadline:\t\t%" B_PRId64 " (runtime left: %" B_PRId64
+			" us)%s\n", fAbsoluteDeadline, fDeadlineRuntimeLeft,
+			fThrottled ? ", throttled" : "");
+	}
 }
 
 
@@ -232,6 +253,47 @@ ThreadData::UnassignCore(bool running)
 }
 
 
+/*!	Sets the deadline reservation of the thread, or removes it, if \a cpu is
+	\c NULL. The reservation starts with a fresh period.
+	The thread must not be enqueued, admission control is up to the caller.
+*/
+void
+ThreadData::SetDeadline(CPUEntry* cpu, bigtime_t runtime, bigtime_t deadline,
+	bigtime_t period)
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	ASSERT(!fEnqueued);
+
+	fDeadlineCPU = cpu;
+	if (cpu == NULL) {
+		fDeadlineRuntime = 0;
+		fRelativeDeadline = 0;
+		fDeadlinePeriod = 0;
+		return;
+	}
+
+	fDeadlineRuntime = runtime;
+	fRelativeDeadline = deadline;
+	fDeadlinePeriod = period;
+
+	bigtime_t now = system_time();
+	fAbsoluteDeadline = now + deadline;
+	fDeadlineRuntimeLeft = runtime;
+	fDeadlineChargeStart = now;
+}
+
+
+void
+ThreadData::GetDeadlineParameters(bigtime_t& runtime, bigtime_t& deadline,
+	bigtime_t& period) const
+{
+	runtime = fDeadlineRuntime;
+	deadline = fRelativeDeadline;
+	period = fDeadlinePeriod;
+}
+
+
 /* static */ void
 ThreadData::ComputeQuantumLengths()
 {
@@ -81,13 +81,34 @@ public:
 	inline	void		UpdateActivity(bigtime_t active);
 
 	inline	bool		IsEnqueued() const	{ return fEnqueued; }
-	inline	void		SetDequeued()	{ fEnqueued = false; }
+	inline	void		SetDequeued()
+							{ fEnqueued = false; fDeadlineEnqueued = false; }
 
 	inline	int32		GetLoad() const	{ return fNeededLoad; }
 
 	inline	CoreEntry*	Core() const	{ return fCore; }
 			void		UnassignCore(bool running = false);
 
+	inline	bool		HasDeadline() const
+							{ return fDeadlineCPU != NULL; }
+	inline	bool		IsDeadline() const;
+	inline	CPUEntry*	DeadlineCPU() const	{ return fDeadlineCPU; }
+	inline	bigtime_t	GetDeadline() const	{ return fAbsoluteDeadline; }
+	inline	bigtime_t	GetDeadlineRuntimeLeft() const
+							{ return fDeadlineRuntimeLeft; }
+	inline	int64		GetDeadlineBandwidth() const;
+			void		SetDeadline(CPUEntry* cpu, bigtime_t runtime,
+							bigtime_t deadline, bigtime_t period);
+			void		GetDeadlineParameters(bigtime_t& runtime,
+							bigtime_t& deadline, bigtime_t& period) const;
+	inline	void		DeadlineWakesUp();
+	inline	bigtime_t	ChargeDeadlineRuntime();
+
+	inline	bool		IsThrottled() const	{ return fThrottled; }
+	inline	void		SetThrottled(bool throttled)
+							{ fThrottled = throttled; }
+	inline	timer*		ReplenishTimer()	{ return &fReplenishTimer; }
+
 	static	void		ComputeQuantumLengths();
 
 private:
@@ -130,6 +151,17 @@ private:
 			uint32		fLoadMeasurementEpoch;
 
 			CoreEntry*	fCore;
+
+			CPUEntry*	fDeadlineCPU;
+			bigtime_t	fDeadlineRuntime;
+			bigtime_t	fRelativeDeadline;
+			bigtime_t	fDeadlinePeriod;
+			bigtime_t	fAbsoluteDeadline;
+			bigtime_t	fDeadlineRuntimeLeft;
+			bigtime_t	fDeadlineChargeStart;
+			bool		fDeadlineEnqueued;
+			bool		fThrottled;
+			timer		fReplenishTimer;
 };
 
 class ThreadProcessing {
@@ -187,6 +219,87 @@ ThreadData::Rebalance() const
 }
 
 
+/*!	Returns whether the thread's deadline reservation is in effect. It isn't,
+	if the reserved CPU has been disabled, or if the thread is currently
+	pinned to or not allowed to run on a different CPU; the thread is then
+	scheduled like any other thread until that changes.
+*/
+inline bool
+ThreadData::IsDeadline() const
+{
+	if (fDeadlineCPU == NULL)
+		return false;
+
+	int32 cpu = fDeadlineCPU->ID();
+	if (gCPU[cpu].disabled)
+		return false;
+	if (fThread->pinned_to_cpu > 0 && fThread->previous_cpu != &gCPU[cpu])
+		return false;
+
+	CPUSet mask = GetCPUMask();
+	return mask.IsEmpty() || mask.GetBit(cpu);
+}
+
+
+/*!	Returns the share of a CPU the thread's reservation takes, in units of
+	kDeadlineBandwidthScale.
+*/
+inline int64
+ThreadData::GetDeadlineBandwidth() const
+{
+	if (fDeadlineCPU == NULL)
+		return 0;
+	return fDeadlineRuntime * kDeadlineBandwidthScale / fRelativeDeadline;
+}
+
+
+/*!	Applies the constant bandwidth server wake up rule: if the thread can't
+	use up the runtime it has left until its current deadline without
+	exceeding its reserved bandwidth, a new period is started right away.
+*/
+inline void
+ThreadData::DeadlineWakesUp()
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	bigtime_t now = system_time();
+	if (fAbsoluteDeadline <= now
+		|| fDeadlineRuntimeLeft * fRelativeDeadline
+			> (fAbsoluteDeadline - now) * fDeadlineRuntime) {
+		fAbsoluteDeadline = now + fRelativeDeadline;
+		fDeadlineRuntimeLeft = fDeadlineRuntime;
+	}
+}
+
+
+/*!	Charges the CPU time the thread has used since it has last been charged
+	to its reservation. If the runtime of the current period is used up, the
+	deadline is postponed by as many periods as needed to make up for the
+	overrun.
+	Returns the start of the period the thread may continue in, which may lie
+	in the past, if it doesn't have to be throttled.
+*/
+inline bigtime_t
+ThreadData::ChargeDeadlineRuntime()
+{
+	SCHEDULER_ENTER_FUNCTION();
+
+	bigtime_t now = system_time();
+	fDeadlineRuntimeLeft -= now - fDeadlineChargeStart;
+	fDeadlineChargeStart = now;
+
+	if (fDeadlineRuntimeLeft > 0)
+		return 0;
+
+	do {
+		fDeadlineRuntimeLeft += fDeadlineRuntime;
+		fAbsoluteDeadline += fDeadlinePeriod;
+	} while (fDeadlineRuntimeLeft <= 0);
+
+	return fAbsoluteDeadline - fRelativeDeadline;
+}
+
+
 inline int32
 ThreadData::GetEffectivePriority() const
 {
@@ -301,6 +414,7 @@ ThreadData::StartQuantum()
 {
 	SCHEDULER_ENTER_FUNCTION();
 	fQuantumStart = system_time();
+	fDeadlineChargeStart = fQuantumStart;
 }
 
 
@@ -428,6 +542,21 @@ ThreadData::Enqueue(bool& wasRunQueueEmpty)
 
 	fThread->state = B_THREAD_READY;
 
+	if (IsDeadline()) {
+		ASSERT(fCore == fDeadlineCPU->Core());
+
+		CPURunQueueLocker _(fDeadlineCPU);
+		ASSERT(!fEnqueued);
+		fEnqueued = true;
+		fDeadlineEnqueued = true;
+
+		// tell the caller whether the CPU has to preempt its current thread
+		wasRunQueueEmpty = fAbsoluteDeadline < fDeadlineCPU->RunningDeadline();
+
+		fDeadlineCPU->PushDeadline(this);
+		return;
+	}
+
 	const int32 priority = GetEffectivePriority();
 	if (fThread->pinned_to_cpu > 0) {
 		ASSERT(fThread->previous_cpu != NULL);
@@ -459,6 +588,15 @@ ThreadData::Dequeue()
 {
 	SCHEDULER_ENTER_FUNCTION();
 
+	if (fDeadlineEnqueued) {
+		CPURunQueueLocker _(fDeadlineCPU);
+		if (!fEnqueued)
+			return false;
+		fDeadlineCPU->RemoveDeadline(this);
+		ASSERT(!fEnqueued);
+		return true;
+	}
+
 	if (fThread->pinned_to_cpu > 0) {
 		ASSERT(fThread->previous_cpu != NULL);
 		CPUEntry* cpu = CPUEntry::GetCPU(fThread->previous_cpu->cpu_num);
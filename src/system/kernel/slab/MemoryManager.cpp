@@ -1478,6 +1478,17 @@ MemoryManager::_MapChunk(VMArea* vmArea, addr_t address, size_t size,
 	} else
 		vm_page_reserve_pages(&reservation, reservedPages, priority);
 
+	// Preload the nodes for the cache's page tree. We must not wait for them,
+	// since we might be mapping a chunk for the node cache right now; it
+	// keeps a reserve for us instead.
+	VMCachePagesTreePreload preload;
+	if (preload.TryPreload(VMCachePagesTreePreload::NodesNeeded(
+			size / B_PAGE_SIZE)) != B_OK) {
+		vm_page_unreserve_pages(&reservation);
+		vm_unreserve_memory(reservedMemory);
+		return B_NO_MEMORY;
+	}
+
 	VMCache* cache = vm_area_get_locked_cache(vmArea);
 
 	// map the pages
@@ -26,6 +26,7 @@
 #include <cpu.h>
 #include <generic_syscall.h>
 #include <int.h>
+#include <lock_stats.h>
 #include <spinlock_contention.h>
 #include <thread.h>
 #include <util/atomic.h>
@@ -67,6 +68,32 @@
 #define SPINLOCK_DEADLOCK_COUNT				100000000
 #define SPINLOCK_DEADLOCK_COUNT_NO_CHECK	2000000000
 
+// The spinlock word consists of the SPINLOCK_LOCKED bit and the tail of the
+// queue of waiting CPUs. The tail identifies a wait node by CPU (plus one, so
+// that an empty queue is 0) and nesting index. It must leave the lowest byte
+// alone, as spinlock_clear_locked() releases the lock by overwriting it.
+#define SPINLOCK_MAX_WAIT_NODES				4
+#define SPINLOCK_TAIL_INDEX_SHIFT			8
+#define SPINLOCK_TAIL_CPU_SHIFT				10
+#define SPINLOCK_TAIL_MASK					0x7fffff00
+
+STATIC_ASSERT(SPINLOCK_MAX_WAIT_NODES
+	<= (1 << (SPINLOCK_TAIL_CPU_SHIFT - SPINLOCK_TAIL_INDEX_SHIFT)));
+STATIC_ASSERT(((SMP_MAX_CPUS + 1) << SPINLOCK_TAIL_CPU_SHIFT)
+	<= SPINLOCK_TAIL_MASK);
+STATIC_ASSERT((SPINLOCK_TAIL_MASK & 0xff) == 0);
+
+
+struct spinlock_wait_node {
+	spinlock_wait_node*	next;
+	int32				granted;
+};
+
+struct CACHE_LINE_ALIGN spinlock_wait_queue {
+	int32				depth;
+	spinlock_wait_node	nodes[SPINLOCK_MAX_WAIT_NODES];
+};
+
 
 struct smp_msg {
 	struct smp_msg	*next;
@@ -103,6 +130,8 @@ static struct smp_msg* sBroadcastMessages = NULL;
 static spinlock sBroadcastMessageSpinlock = B_SPINLOCK_INITIALIZER;
 static int32 sBroadcastMessageCounter;
 
+static spinlock_wait_queue sSpinlockWaitQueues[SMP_MAX_CPUS];
+
 static bool sICIEnabled = false;
 static int32 sNumCPUs = 1;
 
@@ -169,6 +198,13 @@ dump_spinlock(int argc, char** argv)
 	} else
 		kprintf("  not locked\n");
 
+	uint32 tail = (uint32)lock->lock & SPINLOCK_TAIL_MASK;
+	if (tail != 0) {
+		kprintf("  last waiter: cpu %" B_PRId32 ", node %" B_PRIu32 "\n",
+			(int32)(tail >> SPINLOCK_TAIL_CPU_SHIFT) - 1,
+			(tail >> SPINLOCK_TAIL_INDEX_SHIFT) & (SPINLOCK_MAX_WAIT_NODES - 1));
+	}
+
 #if B_DEBUG_SPINLOCK_CONTENTION
 	kprintf("  failed try_acquire():		%d\n", lock->failed_try_acquire);
 	kprintf("  total wait time:		%" B_PRIdBIGTIME "\n", lock->total_wait);
@@ -296,6 +332,161 @@ process_all_pending_ici(int32 currentCPU)
 }
 
 
+/*!	Encodes the wait node \a index of CPU \a cpu as a spinlock tail value. */
+static inline uint32
+spinlock_encode_tail(int32 cpu, int32 index)
+{
+	return ((uint32)(cpu + 1) << SPINLOCK_TAIL_CPU_SHIFT)
+		| ((uint32)index << SPINLOCK_TAIL_INDEX_SHIFT);
+}
+
+
+static inline spinlock_wait_node*
+spinlock_decode_tail(uint32 tail)
+{
+	int32 cpu = (int32)(tail >> SPINLOCK_TAIL_CPU_SHIFT) - 1;
+	int32 index = (tail >> SPINLOCK_TAIL_INDEX_SHIFT)
+		& (SPINLOCK_MAX_WAIT_NODES - 1);
+	return &sSpinlockWaitQueues[cpu].nodes[index];
+}
+
+
+static void
+spinlock_deadlock_panic(const char* function, spinlock* lock)
+{
+#if DEBUG_SPINLOCKS
+	panic("%s(): Failed to acquire spinlock %p for a long time (last caller: "
+		"%p, value: %" B_PRIx32 ")", function, lock, find_lock_caller(lock),
+		lock->lock);
+#else
+	panic("%s(): Failed to acquire spinlock %p for a long time (value: %"
+		B_PRIx32 ")", function, lock, lock->lock);
+#endif
+}
+
+
+/*!	Contended path of the spinlock acquisition functions.
+
+	The waiting CPU appends one of its wait nodes to the lock's queue and only
+	spins on that node until its predecessor hands the lock over, so that
+	waiters don't hammer the lock word and get the lock in FIFO order. While
+	waiting, pending ICIs are processed if \a processICIs is \c true; since
+	ICI handlers may acquire spinlocks themselves, each CPU has several wait
+	nodes. Should those be exhausted, we fall back to spinning on the lock
+	word directly. That fallback can only take the lock while no other CPU is
+	queued, and thus has no fairness bound: under sustained contention it may
+	starve until the deadlock check panics. It is only reached when ICI
+	handlers nest more than SPINLOCK_MAX_WAIT_NODES contended acquisitions,
+	though.
+	src/tests/system/kernel/spinlock_latency.cpp has a userland copy of this
+	algorithm that needs to be updated along with it.
+*/
+static void
+acquire_spinlock_queued(int32 currentCPU, spinlock* lock, bool processICIs,
+	uint32 deadlockCount, const char* function)
+{
+	spinlock_wait_queue& queue = sSpinlockWaitQueues[currentCPU];
+	uint32 count = 0;
+
+	int32 index = queue.depth;
+	if (index >= SPINLOCK_MAX_WAIT_NODES) {
+		while (atomic_test_and_set(&lock->lock, SPINLOCK_LOCKED, 0) != 0) {
+			if (++count == deadlockCount) {
+				spinlock_deadlock_panic(function, lock);
+				count = 0;
+			}
+
+			if (processICIs)
+				process_all_pending_ici(currentCPU);
+			cpu_pause();
+		}
+		return;
+	}
+
+	spinlock_wait_node* node = &queue.nodes[index];
+	node->next = NULL;
+	node->granted = 0;
+	queue.depth = index + 1;
+
+	const uint32 tail = spinlock_encode_tail(currentCPU, index);
+
+	// make ourselves the new tail of the queue
+	uint32 oldValue;
+	while (true) {
+		oldValue = (uint32)atomic_get(&lock->lock);
+		if (oldValue == 0) {
+			// the lock has been released in the meantime
+			if (atomic_test_and_set(&lock->lock, SPINLOCK_LOCKED, 0) == 0) {
+				queue.depth = index;
+				return;
+			}
+			continue;
+		}
+
+		uint32 newValue = (oldValue & ~SPINLOCK_TAIL_MASK) | tail;
+		if ((uint32)atomic_test_and_set(&lock->lock, newValue, oldValue)
+				== oldValue) {
+			break;
+		}
+	}
+
+	// if there is a predecessor, link in and wait until it hands over to us
+	uint32 previousTail = oldValue & SPINLOCK_TAIL_MASK;
+	if (previousTail != 0) {
+		spinlock_wait_node* previous = spinlock_decode_tail(previousTail);
+		atomic_pointer_set(&previous->next, node);
+
+		while (atomic_get(&node->granted) == 0) {
+			if (++count == deadlockCount) {
+				spinlock_deadlock_panic(function, lock);
+				count = 0;
+			}
+
+			if (processICIs)
+				process_all_pending_ici(currentCPU);
+			cpu_wait(&node->granted, 0);
+		}
+	}
+
+	// we are at the head of the queue -- wait for the owner to release the lock
+	while ((atomic_get(&lock->lock) & SPINLOCK_LOCKED) != 0) {
+		if (++count == deadlockCount) {
+			spinlock_deadlock_panic(function, lock);
+			count = 0;
+		}
+
+		if (processICIs)
+			process_all_pending_ici(currentCPU);
+		cpu_pause();
+	}
+
+	// Take the lock. If we are the last waiter, the tail is cleared as well,
+	// otherwise nobody but us may set the locked bit now.
+	while (true) {
+		uint32 value = (uint32)atomic_get(&lock->lock);
+		if ((value & SPINLOCK_TAIL_MASK) != tail) {
+			atomic_or(&lock->lock, SPINLOCK_LOCKED);
+			break;
+		}
+
+		if ((uint32)atomic_test_and_set(&lock->lock, SPINLOCK_LOCKED, value)
+				== value) {
+			queue.depth = index;
+			return;
+		}
+	}
+
+	// Someone queued up behind us. It might not have linked itself in yet,
+	// but it is about to do so with interrupts disabled.
+	spinlock_wait_node* next;
+	while ((next = atomic_pointer_get(&node->next)) == NULL)
+		cpu_pause();
+
+	atomic_set(&next->granted, 1);
+	queue.depth = index;
+}
+
+
 bool
 try_acquire_spinlock(spinlock* lock)
 {
@@ -306,7 +497,7 @@ try_acquire_spinlock(spinlock* lock)
 	}
 #endif
 
-	if (atomic_get_and_set(&lock->lock, 1) != 0) {
+	if (atomic_test_and_set(&lock->lock, SPINLOCK_LOCKED, 0) != 0) {
 #if B_DEBUG_SPINLOCK_CONTENTION
 		atomic_add(&lock->failed_try_acquire, 1);
 #endif
@@ -339,28 +530,16 @@ acquire_spinlock(spinlock* lock)
 #if B_DEBUG_SPINLOCK_CONTENTION
 		const bigtime_t start = system_time();
 #endif
-		int currentCPU = smp_get_current_cpu();
-		while (1) {
-			uint32 count = 0;
-			while (lock->lock != 0) {
-				if (++count == SPINLOCK_DEADLOCK_COUNT) {
-#if DEBUG_SPINLOCKS
-					panic("acquire_spinlock(): Failed to acquire spinlock %p "
-						"for a long time (last caller: %p, value: %" B_PRIx32
-						")", lock, find_lock_caller(lock), lock->lock);
-#else
-					panic("acquire_spinlock(): Failed to acquire spinlock %p "
-						"for a long time (value: %" B_PRIx32 ")", lock,
-						lock->lock);
-#endif
-					count = 0;
-				}
-
-				process_all_pending_ici(currentCPU);
-				cpu_wait(&lock->lock, 0);
+		if (atomic_test_and_set(&lock->lock, SPINLOCK_LOCKED, 0) != 0) {
+			nanotime_t startTime
+				= gLockStatsEnabled != 0 ? system_time_nsecs() : 0;
+			acquire_spinlock_queued(smp_get_current_cpu(), lock, true,
+				SPINLOCK_DEADLOCK_COUNT, "acquire_spinlock");
+			if (startTime != 0) {
+				lock_stats_acquired(LOCK_STATS_SPINLOCK, lock, NULL,
+					(addr_t)arch_debug_get_caller(),
+					system_time_nsecs() - startTime, true);
 			}
-			if (atomic_get_and_set(&lock->lock, 1) == 0)
-				break;
 		}
 
 #if B_DEBUG_SPINLOCK_CONTENTION
@@ -375,7 +554,7 @@ acquire_spinlock(spinlock* lock)
 		lock->last_acquired = system_time();
 #endif
 #if DEBUG_SPINLOCKS
-		int32 oldValue = atomic_get_and_set(&lock->lock, 1);
+		int32 oldValue = atomic_get_and_set(&lock->lock, SPINLOCK_LOCKED);
 		if (oldValue != 0) {
 			panic("acquire_spinlock: attempt to acquire lock %p twice on "
 				"non-SMP system (last caller: %p, value %" B_PRIx32 ")", lock,
@@ -402,27 +581,9 @@ acquire_spinlock_nocheck(spinlock *lock)
 #if B_DEBUG_SPINLOCK_CONTENTION
 		const bigtime_t start = system_time();
 #endif
-		while (1) {
-			uint32 count = 0;
-			while (lock->lock != 0) {
-				if (++count == SPINLOCK_DEADLOCK_COUNT_NO_CHECK) {
-#if DEBUG_SPINLOCKS
-					panic("acquire_spinlock_nocheck(): Failed to acquire "
-						"spinlock %p for a long time (last caller: %p, value: %"
-						B_PRIx32 ")", lock, find_lock_caller(lock), lock->lock);
-#else
-					panic("acquire_spinlock_nocheck(): Failed to acquire "
-						"spinlock %p for a long time (value: %" B_PRIx32 ")",
-						lock, lock->lock);
-#endif
-					count = 0;
-				}
-
-				cpu_wait(&lock->lock, 0);
-			}
-
-			if (atomic_get_and_set(&lock->lock, 1) == 0)
-				break;
+		if (atomic_test_and_set(&lock->lock, SPINLOCK_LOCKED, 0) != 0) {
+			acquire_spinlock_queued(smp_get_current_cpu(), lock, false,
+				SPINLOCK_DEADLOCK_COUNT_NO_CHECK, "acquire_spinlock_nocheck");
 		}
 
 #if B_DEBUG_SPINLOCK_CONTENTION
@@ -437,7 +598,7 @@ acquire_spinlock_nocheck(spinlock *lock)
 		lock->last_acquired = system_time();
 #endif
 #if DEBUG_SPINLOCKS
-		int32 oldValue = atomic_get_and_set(&lock->lock, 1);
+		int32 oldValue = atomic_get_and_set(&lock->lock, SPINLOCK_LOCKED);
 		if (oldValue != 0) {
 			panic("acquire_spinlock_nocheck: attempt to acquire lock %p twice "
 				"on non-SMP system (last caller: %p, value %" B_PRIx32 ")",
@@ -465,27 +626,16 @@ acquire_spinlock_cpu(int32 currentCPU, spinlock *lock)
 #if B_DEBUG_SPINLOCK_CONTENTION
 		const bigtime_t start = system_time();
 #endif
-		while (1) {
-			uint32 count = 0;
-			while (lock->lock != 0) {
-				if (++count == SPINLOCK_DEADLOCK_COUNT) {
-#if DEBUG_SPINLOCKS
-					panic("acquire_spinlock_cpu(): Failed to acquire spinlock "
-						"%p for a long time (last caller: %p, value: %" B_PRIx32
-						")", lock, find_lock_caller(lock), lock->lock);
-#else
-					panic("acquire_spinlock_cpu(): Failed to acquire spinlock "
-						"%p for a long time (value: %" B_PRIx32 ")", lock,
-						lock->lock);
-#endif
-					count = 0;
-				}
-
-				process_all_pending_ici(currentCPU);
-				cpu_wait(&lock->lock, 0);
+		if (atomic_test_and_set(&lock->lock, SPINLOCK_LOCKED, 0) != 0) {
+			nanotime_t startTime
+				= gLockStatsEnabled != 0 ? system_time_nsecs() : 0;
+			acquire_spinlock_queued(currentCPU, lock, true,
+				SPINLOCK_DEADLOCK_COUNT, "acquire_spinlock_cpu");
+			if (startTime != 0) {
+				lock_stats_acquired(LOCK_STATS_SPINLOCK, lock, NULL,
+					(addr_t)arch_debug_get_caller(),
+					system_time_nsecs() - startTime, true);
 			}
-			if (atomic_get_and_set(&lock->lock, 1) == 0)
-				break;
 		}
 
 #if B_DEBUG_SPINLOCK_CONTENTION
@@ -500,7 +650,7 @@ acquire_spinlock_cpu(int32 currentCPU, spinlock *lock)
 		lock->last_acquired = system_time();
 #endif
 #if DEBUG_SPINLOCKS
-		int32 oldValue = atomic_get_and_set(&lock->lock, 1);
+		int32 oldValue = atomic_get_and_set(&lock->lock, SPINLOCK_LOCKED);
 		if (oldValue != 0) {
 			panic("acquire_spinlock_cpu(): attempt to acquire lock %p twice on "
 				"non-SMP system (last caller: %p, value %" B_PRIx32 ")", lock,
@@ -526,19 +676,19 @@ release_spinlock(spinlock *lock)
 				"interrupts enabled\n", lock);
 		}
 
+		// only clear the locked bit, the tail belongs to the waiters
 #if DEBUG_SPINLOCKS
-		if (atomic_get_and_set(&lock->lock, 0) != 1)
+		if ((atomic_get(&lock->lock) & SPINLOCK_LOCKED) == 0)
 			panic("release_spinlock: lock %p was already released\n", lock);
-#else
-		atomic_set(&lock->lock, 0);
 #endif
+		spinlock_clear_locked(lock);
 	} else {
 #if DEBUG_SPINLOCKS
 		if (are_interrupts_enabled()) {
 			panic("release_spinlock: attempt to release lock %p with "
 				"interrupts enabled\n", lock);
 		}
-		if (atomic_get_and_set(&lock->lock, 0) != 1)
+		if (atomic_get_and_set(&lock->lock, 0) != SPINLOCK_LOCKED)
 			panic("release_spinlock: lock %p was already released\n", lock);
 #endif
 	}
@@ -29,6 +29,7 @@
 #include <fs/node_monitor.h>
 #include <generic_syscall.h>
 #include <int.h>
+#include <io_ring.h>
 #include <kernel.h>
 #include <kimage.h>
 #include <ksignal.h>
@@ -42,6 +43,7 @@
 #include <real_time_clock.h>
 #include <safemode.h>
 #include <sem.h>
+#include <splice.h>
 #include <sys/resource.h>
 #include <system_profiler.h>
 #include <thread.h>
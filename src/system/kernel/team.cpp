@@ -41,6 +41,7 @@
 #include <ksignal.h>
 #include <Notifications.h>
 #include <port.h>
+#include <port_buffer.h>
 #include <posix/realtime_sem.h>
 #include <posix/xsi_semaphore.h>
 #include <safemode.h>
@@ -520,6 +521,7 @@ Team::~Team()
 	if (io_context != NULL)
 		vfs_put_io_context(io_context);
 	delete_owned_ports(this);
+	delete_team_port_buffers(this);
 	sem_delete_owned_sems(this);
 
 	DeleteUserTimers(false);
@@ -1995,6 +1997,7 @@ exec_team(const char* path, char**& _flatArgs, size_t flatArgsSize,
 	vm_delete_areas(team->address_space, false);
 	xsi_sem_undo(team);
 	delete_owned_ports(team);
+	delete_team_port_buffers(team);
 	sem_delete_owned_sems(team);
 	remove_images(team);
 	vfs_exec_io_context(team->io_context);
@@ -2166,6 +2169,9 @@ fork_team(void)
 				break;
 
 			thread->user_thread = team_allocate_user_thread(team);
+		} else if (is_port_buffer_area(info.area)) {
+			// port buffers are passed on explicitly only
+			continue;
 		} else {
 			void* address;
 			area_id area = vm_copy_area(team->address_space->ID(), info.name,
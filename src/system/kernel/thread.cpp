@@ -282,6 +282,7 @@ Thread::Thread(const char* name, thread_id threadID, struct cpu_ent* cpu)
 	user_thread(NULL),
 	fault_handler(0),
 	page_faults_allowed(1),
+	cache_pages_preload(NULL),
 	team(NULL),
 	select_infos(NULL),
 	kernel_stack_area(-1),
@@ -302,6 +302,58 @@ ring_buffer_get_vecs(struct ring_buffer* buffer, struct iovec* vecs)
 }
 
 
+/*!	Returns iovecs describing the free space of the ring buffer, in the order
+	it will be filled. Data placed there becomes part of the buffer contents
+	only once ring_buffer_commit_written() has been called.
+
+	\param buffer The ring buffer.
+	\param vecs Pointer to an iovec array with at least 2 elements to be filled
+		in by the function.
+	\return The number of iovecs the function has filled in to describe the
+		free space of the ring buffer. \c 0, if full, \c 2 at maximum.
+*/
+int32
+ring_buffer_get_write_vecs(struct ring_buffer* buffer, struct iovec* vecs)
+{
+	int32 left = space_left_in_buffer(buffer);
+	if (left == 0)
+		return 0;
+
+	int32 position = (buffer->first + buffer->in) % buffer->size;
+	if (position + left <= buffer->size) {
+		// one element
+		vecs[0].iov_base = buffer->buffer + position;
+		vecs[0].iov_len = left;
+		return 1;
+	}
+
+	// two elements
+	size_t upper = buffer->size - position;
+	size_t lower = left - upper;
+
+	vecs[0].iov_base = buffer->buffer + position;
+	vecs[0].iov_len = upper;
+	vecs[1].iov_base = buffer->buffer;
+	vecs[1].iov_len = lower;
+
+	return 2;
+}
+
+
+/*!	Adds \a length bytes that have been written directly into the space
+	returned by ring_buffer_get_write_vecs() to the buffer contents.
+*/
+void
+ring_buffer_commit_written(struct ring_buffer* buffer, size_t length)
+{
+	// we can't commit more bytes than there is space
+	if (length > (size_t)space_left_in_buffer(buffer))
+		length = space_left_in_buffer(buffer);
+
+	buffer->in += length;
+}
+
+
 /*! Moves data from one ring buffer to another.
 
 	\param to The destination ring buffer.
@@ -0,0 +1,824 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "CompressedSwap.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include <KernelExport.h>
+
+#include <heap.h>
+#include <smp.h>
+#include <thread.h>
+#include <util/AutoLock.h>
+#include <vm/vm.h>
+#include <vm_defs.h>
+
+#include "IORequest.h"
+
+
+#if ENABLE_SWAP_SUPPORT
+
+//#define TRACE_COMPRESSED_SWAP
+#ifdef TRACE_COMPRESSED_SWAP
+#	define TRACE(x...) dprintf("compressed swap: " x)
+#else
+#	define TRACE(x...) do { } while (false)
+#endif
+
+
+// Pages that don't compress to this size are written to the backing store
+// right away -- keeping them in memory wouldn't save enough.
+static const size_t kMaxCompressedSize = B_PAGE_SIZE * 3 / 4;
+
+// The background thread starts writing back the oldest pages when the pool is
+// filled beyond the high watermark, and stops at the low watermark (in
+// percent of the pool size).
+static const size_t kWriteBackHighWatermark = 90;
+static const size_t kWriteBackLowWatermark = 75;
+
+// delay before the next write back attempt, when the last one failed
+static const bigtime_t kWriteBackRetryDelay = 1000000;
+
+// The page writer might be trying to free memory, so we must neither wait
+// for memory nor lock the kernel address space.
+static const uint32 kAllocationFlags = HEAP_DONT_WAIT_FOR_MEMORY
+	| HEAP_DONT_LOCK_KERNEL_SPACE | HEAP_PRIORITY_VIP;
+
+// zlib parameters: raw deflate (no header and checksum), with a window that
+// covers a whole page, and a small hash table
+static const int kZlibWindowBits = -12;
+static const int kZlibMemoryLevel = 4;
+
+
+enum {
+	ENTRY_SAME_FILLED,
+	ENTRY_COMPRESSED,
+	ENTRY_WRITTEN_BACK
+};
+
+
+struct CompressedSwap::Entry : DoublyLinkedListLinkImpl<Entry> {
+	swap_addr_t		slot;
+	int32			ref_count;
+	uint16			type;
+	uint16			size;			// size of the compressed data
+	bool			queued;			// in fCompressedEntries
+	union {
+		uint32		value;			// ENTRY_SAME_FILLED: the repeated word
+		swap_addr_t	backing_slot;	// ENTRY_WRITTEN_BACK
+	};
+	uint8			data[0];		// ENTRY_COMPRESSED: the compressed page
+};
+
+
+struct CompressedSwap::Context {
+	mutex			lock;
+	z_stream		deflate_stream;
+	z_stream		inflate_stream;
+	uint8*			page;
+	uint8*			buffer;
+	bool			deflate_initialized;
+	bool			inflate_initialized;
+};
+
+
+static voidpf
+zlib_alloc(voidpf, uInt items, uInt size)
+{
+	return malloc((size_t)items * size);
+}
+
+
+static void
+zlib_free(voidpf, voidpf address)
+{
+	free(address);
+}
+
+
+static status_t
+copy_from_vec(void* to, generic_addr_t from, generic_size_t length,
+	uint32 flags)
+{
+	if ((flags & B_PHYSICAL_IO_REQUEST) != 0)
+		return vm_memcpy_from_physical(to, from, length, false);
+
+	memcpy(to, (void*)(addr_t)from, length);
+	return B_OK;
+}
+
+
+static status_t
+copy_to_vec(generic_addr_t to, const void* from, generic_size_t length,
+	uint32 flags)
+{
+	if ((flags & B_PHYSICAL_IO_REQUEST) != 0)
+		return vm_memcpy_to_physical(to, from, length, false);
+
+	memcpy((void*)(addr_t)to, from, length);
+	return B_OK;
+}
+
+
+/*!	Returns whether the page consists of a single repeated 32 bit word, which
+	is most often the case for pages that were never written to (or cleared
+	again).
+*/
+static bool
+is_same_filled(const uint8* page, uint32& _value)
+{
+	const uint32* words = (const uint32*)page;
+	uint32 value = words[0];
+	for (size_t i = 1; i < B_PAGE_SIZE / sizeof(uint32); i++) {
+		if (words[i] != value)
+			return false;
+	}
+
+	_value = value;
+	return true;
+}
+
+
+// #pragma mark -
+
+
+CompressedSwap::CompressedSwap()
+	:
+	fEntries(NULL),
+	fSlotCount(0),
+	fPoolSize(0),
+	fPoolUsed(0),
+	fContexts(NULL),
+	fContextCount(0),
+	fWriteBackContext(NULL),
+	fWriteBackThread(-1),
+	fWriteBackRequested(false),
+	fStoredPages(0),
+	fSameFilledPages(0),
+	fWrittenBackPages(0),
+	fUncompressedBytes(0),
+	fCompressedBytes(0),
+	fStores(0),
+	fRejectedStores(0),
+	fWriteThroughs(0),
+	fWriteBacks(0),
+	fLoads(0),
+	fBackingLoads(0),
+	fTotalLoadTime(0),
+	fMaxLoadTime(0)
+{
+	mutex_init(&fLock, "compressed swap");
+	fWriteBackCondition.Init(this, "compressed swap write back");
+}
+
+
+/*!	Only used to clean up after a failed Init() -- once added, the compressed
+	swap stays for good.
+*/
+CompressedSwap::~CompressedSwap()
+{
+	ASSERT(fWriteBackThread < 0);
+
+	for (int32 i = 0; fContexts != NULL && i <= fContextCount; i++) {
+		Context& context = fContexts[i];
+		if (context.deflate_initialized)
+			deflateEnd(&context.deflate_stream);
+		if (context.inflate_initialized)
+			inflateEnd(&context.inflate_stream);
+		free(context.page);
+		free(context.buffer);
+		mutex_destroy(&context.lock);
+	}
+
+	delete[] fContexts;
+	free(fEntries);
+	mutex_destroy(&fLock);
+}
+
+
+status_t
+CompressedSwap::Init(swap_addr_t slotCount, size_t poolSize)
+{
+	fEntries = (Entry**)malloc(sizeof(Entry*) * slotCount);
+	if (fEntries == NULL)
+		return B_NO_MEMORY;
+
+	memset(fEntries, 0, sizeof(Entry*) * slotCount);
+	fSlotCount = slotCount;
+	fPoolSize = poolSize;
+
+	// One context per CPU, and one more for the write back thread. The
+	// contexts are only locked while (de)compressing, so the page writer and
+	// threads faulting pages in don't contend much.
+	fContextCount = smp_get_num_cpus();
+	fContexts = new(std::nothrow) Context[fContextCount + 1];
+	if (fContexts == NULL)
+		return B_NO_MEMORY;
+
+	for (int32 i = 0; i <= fContextCount; i++) {
+		Context& context = fContexts[i];
+		mutex_init(&context.lock, "compressed swap context");
+		memset(&context.deflate_stream, 0, sizeof(z_stream));
+		memset(&context.inflate_stream, 0, sizeof(z_stream));
+		context.deflate_stream.zalloc = context.inflate_stream.zalloc
+			= &zlib_alloc;
+		context.deflate_stream.zfree = context.inflate_stream.zfree
+			= &zlib_free;
+		context.page = NULL;
+		context.buffer = NULL;
+		context.deflate_initialized = false;
+		context.inflate_initialized = false;
+	}
+
+	for (int32 i = 0; i <= fContextCount; i++) {
+		Context& context = fContexts[i];
+		context.page = (uint8*)malloc(B_PAGE_SIZE);
+		context.buffer = (uint8*)malloc(kMaxCompressedSize);
+		if (context.page == NULL || context.buffer == NULL)
+			return B_NO_MEMORY;
+
+		if (deflateInit2(&context.deflate_stream, Z_BEST_SPEED, Z_DEFLATED,
+				kZlibWindowBits, kZlibMemoryLevel, Z_DEFAULT_STRATEGY)
+					!= Z_OK) {
+			return B_NO_MEMORY;
+		}
+		context.deflate_initialized = true;
+
+		if (inflateInit2(&context.inflate_stream, kZlibWindowBits) != Z_OK)
+			return B_NO_MEMORY;
+		context.inflate_initialized = true;
+	}
+
+	fWriteBackContext = &fContexts[fContextCount];
+
+	fWriteBackThread = spawn_kernel_thread(&_WriteBackThread,
+		"compressed swap writer", B_NORMAL_PRIORITY, this);
+	if (fWriteBackThread < 0)
+		return fWriteBackThread;
+
+	resume_thread(fWriteBackThread);
+	return B_OK;
+}
+
+
+/*!	Reads the pages starting at \a slotIndex into the given vectors.
+	Every page of the vectors needs to have been written before.
+*/
+status_t
+CompressedSwap::Read(swap_addr_t slotIndex, const generic_io_vec* vecs,
+	size_t count, uint32 flags)
+{
+	for (size_t i = 0; i < count; i++) {
+		for (generic_size_t offset = 0; offset < vecs[i].length;
+				offset += B_PAGE_SIZE, slotIndex++) {
+			status_t status = _ReadPage(slotIndex, vecs[i].base + offset,
+				min_c(vecs[i].length - offset, B_PAGE_SIZE), flags);
+			if (status != B_OK)
+				return status;
+		}
+	}
+
+	return B_OK;
+}
+
+
+/*!	Stores the pages of the given vectors starting at \a slotIndex,
+	replacing any previous contents of the slots.
+	Fails, if a page could neither be kept in memory nor written to the
+	backing store.
+*/
+status_t
+CompressedSwap::Write(swap_addr_t slotIndex, const generic_io_vec* vecs,
+	size_t count, uint32 flags)
+{
+	for (size_t i = 0; i < count; i++) {
+		for (generic_size_t offset = 0; offset < vecs[i].length;
+				offset += B_PAGE_SIZE, slotIndex++) {
+			status_t status = _WritePage(slotIndex, vecs[i].base + offset,
+				min_c(vecs[i].length - offset, B_PAGE_SIZE), flags);
+			if (status != B_OK)
+				return status;
+		}
+	}
+
+	return B_OK;
+}
+
+
+void
+CompressedSwap::Free(swap_addr_t slotIndex, uint32 count)
+{
+	EntryList freeEntries;
+
+	MutexLocker locker(fLock);
+
+	for (uint32 i = 0; i < count; i++) {
+		Entry* entry = fEntries[slotIndex + i];
+		if (entry == NULL)
+			continue;
+
+		fEntries[slotIndex + i] = NULL;
+		_AccountEntry(entry, -1);
+		if (_ReleaseEntry(entry))
+			freeEntries.Add(entry);
+	}
+
+	locker.Unlock();
+
+	while (Entry* entry = freeEntries.RemoveHead())
+		_DeleteEntry(entry);
+}
+
+
+void
+CompressedSwap::GetStats(vm_compressed_swap_stats& stats)
+{
+	MutexLocker locker(fLock);
+
+	stats.pool_size = fPoolSize;
+	stats.pool_used = fPoolUsed;
+	stats.stored_pages = fStoredPages;
+	stats.same_filled_pages = fSameFilledPages;
+	stats.written_back_pages = fWrittenBackPages;
+	stats.uncompressed_bytes = fUncompressedBytes;
+	stats.compressed_bytes = fCompressedBytes;
+	stats.stores = fStores;
+	stats.rejected_stores = fRejectedStores;
+	stats.write_throughs = fWriteThroughs;
+	stats.write_backs = fWriteBacks;
+	stats.loads = fLoads;
+	stats.backing_loads = fBackingLoads;
+	stats.total_load_time = fTotalLoadTime;
+	stats.max_load_time = fMaxLoadTime;
+}
+
+
+void
+CompressedSwap::Dump()
+{
+	kprintf("  pool:         %" B_PRIuSIZE " of %" B_PRIuSIZE " bytes used\n",
+		fPoolUsed, fPoolSize);
+	kprintf("  pages:        %" B_PRId64 " (%" B_PRId64 " same-filled, %"
+		B_PRId64 " written back)\n", fStoredPages, fSameFilledPages,
+		fWrittenBackPages);
+	kprintf("  compressed:   %" B_PRIu64 " -> %" B_PRIu64 " bytes\n",
+		fUncompressedBytes, fCompressedBytes);
+	kprintf("  stores:       %" B_PRId64 " (%" B_PRId64 " rejected, %" B_PRId64
+		" written through)\n", fStores, fRejectedStores, fWriteThroughs);
+	kprintf("  write backs:  %" B_PRId64 "\n", fWriteBacks);
+	kprintf("  loads:        %" B_PRId64 " (%" B_PRId64 " from backing store), "
+		"avg %" B_PRId64 " us, max %" B_PRId64 " us\n", fLoads, fBackingLoads,
+		fLoads > 0 ? fTotalLoadTime / fLoads : 0, fMaxLoadTime);
+}
+
+
+status_t
+CompressedSwap::_ReadPage(swap_addr_t slotIndex, generic_addr_t address,
+	generic_size_t length, uint32 flags)
+{
+	bigtime_t startTime = system_time();
+
+	MutexLocker locker(fLock);
+
+	Entry* entry = fEntries[slotIndex];
+	if (entry == NULL) {
+		panic("CompressedSwap::_ReadPage(): slot %" B_PRIu32 " is empty",
+			slotIndex);
+		return B_BAD_VALUE;
+	}
+
+	// The entry can't go away while we're reading the page, but it might be
+	// replaced by the write back thread.
+	entry->ref_count++;
+	locker.Unlock();
+
+	status_t status = B_OK;
+	switch (entry->type) {
+		case ENTRY_SAME_FILLED:
+			if (entry->value == 0 && (flags & B_PHYSICAL_IO_REQUEST) != 0) {
+				status = vm_memset_physical(address, 0, length);
+				break;
+			}
+			// fall through
+
+		case ENTRY_COMPRESSED:
+		{
+			Context* context = _GetContext();
+
+			if (entry->type == ENTRY_SAME_FILLED) {
+				uint32* words = (uint32*)context->page;
+				for (size_t i = 0; i < B_PAGE_SIZE / sizeof(uint32); i++)
+					words[i] = entry->value;
+			} else {
+				z_stream& stream = context->inflate_stream;
+				inflateReset(&stream);
+				stream.next_in = entry->data;
+				stream.avail_in = entry->size;
+				stream.next_out = context->page;
+				stream.avail_out = B_PAGE_SIZE;
+
+				if (inflate(&stream, Z_FINISH) != Z_STREAM_END
+					|| stream.avail_out != 0) {
+					dprintf("CompressedSwap: failed to decompress slot %"
+						B_PRIu32 "\n", slotIndex);
+					status = B_IO_ERROR;
+				}
+			}
+
+			if (status == B_OK)
+				status = copy_to_vec(address, context->page, length, flags);
+
+			_PutContext(context);
+			break;
+		}
+
+		case ENTRY_WRITTEN_BACK:
+		{
+			generic_io_vec vec = { address, length };
+			status = swap_backing_read(entry->backing_slot, &vec, flags);
+			break;
+		}
+	}
+
+	bigtime_t loadTime = system_time() - startTime;
+
+	locker.Lock();
+
+	fLoads++;
+	if (entry->type == ENTRY_WRITTEN_BACK)
+		fBackingLoads++;
+	fTotalLoadTime += loadTime;
+	if (loadTime > fMaxLoadTime)
+		fMaxLoadTime = loadTime;
+
+	bool deleteEntry = _ReleaseEntry(entry);
+	locker.Unlock();
+
+	if (deleteEntry)
+		_DeleteEntry(entry);
+
+	return status;
+}
+
+
+status_t
+CompressedSwap::_WritePage(swap_addr_t slotIndex, generic_addr_t address,
+	generic_size_t length, uint32 flags)
+{
+	Context* context = _GetContext();
+
+	status_t status = copy_from_vec(context->page, address, length, flags);
+	if (status != B_OK) {
+		_PutContext(context);
+		return status;
+	}
+	if (length < B_PAGE_SIZE)
+		memset(context->page + length, 0, B_PAGE_SIZE - length);
+
+	Entry* entry = NULL;
+	uint32 value;
+	if (is_same_filled(context->page, value)) {
+		entry = (Entry*)malloc_etc(sizeof(Entry), kAllocationFlags);
+		if (entry != NULL) {
+			entry->type = ENTRY_SAME_FILLED;
+			entry->size = 0;
+			entry->value = value;
+		}
+	} else {
+		MutexLocker locker(fLock);
+		bool poolFull = fPoolUsed >= fPoolSize;
+		locker.Unlock();
+
+		size_t size = 0;
+		if (!poolFull) {
+			z_stream& stream = context->deflate_stream;
+			deflateReset(&stream);
+			stream.next_in = context->page;
+			stream.avail_in = B_PAGE_SIZE;
+			stream.next_out = context->buffer;
+			stream.avail_out = kMaxCompressedSize;
+
+			if (deflate(&stream, Z_FINISH) == Z_STREAM_END)
+				size = kMaxCompressedSize - stream.avail_out;
+		}
+
+		if (size > 0) {
+			// reserve the space in the pool
+			locker.Lock();
+			if (fPoolUsed + size <= fPoolSize)
+				fPoolUsed += size;
+			else
+				size = 0;
+			locker.Unlock();
+		}
+
+		if (size > 0) {
+			entry = (Entry*)malloc_etc(sizeof(Entry) + size, kAllocationFlags);
+			if (entry != NULL) {
+				entry->type = ENTRY_COMPRESSED;
+				entry->size = size;
+				memcpy(entry->data, context->buffer, size);
+			} else {
+				locker.Lock();
+				fPoolUsed -= size;
+				locker.Unlock();
+			}
+		}
+	}
+
+	_PutContext(context);
+
+	if (entry == NULL) {
+		// The page is incompressible, the pool is full, or we're out of
+		// memory -- write the page directly to the backing store.
+		generic_io_vec vec = { address, length };
+		status = _WritePageToBackingStore(vec, flags, entry);
+		if (status != B_OK) {
+			TRACE("failed to store slot %" B_PRIu32 ": %s\n", slotIndex,
+				strerror(status));
+			MutexLocker locker(fLock);
+			fRejectedStores++;
+			return status;
+		}
+
+		MutexLocker locker(fLock);
+		fWriteThroughs++;
+	}
+
+	_SetEntry(slotIndex, entry);
+	return B_OK;
+}
+
+
+/*!	Writes the page to a newly allocated slot of the backing store, and
+	creates a respective entry for it.
+*/
+status_t
+CompressedSwap::_WritePageToBackingStore(const generic_io_vec& vec,
+	uint32 flags, Entry*& _entry)
+{
+	Entry* entry = (Entry*)malloc_etc(sizeof(Entry), kAllocationFlags);
+	if (entry == NULL)
+		return B_NO_MEMORY;
+
+	swap_addr_t backingSlot;
+	status_t status = swap_backing_slot_alloc(backingSlot);
+	if (status == B_OK) {
+		status = swap_backing_write(backingSlot, &vec, flags);
+		if (status != B_OK)
+			swap_backing_slot_free(backingSlot);
+	}
+
+	if (status != B_OK) {
+		free_etc(entry, kAllocationFlags);
+		return status;
+	}
+
+	entry->type = ENTRY_WRITTEN_BACK;
+	entry->size = 0;
+	entry->backing_slot = backingSlot;
+
+	_entry = entry;
+	return B_OK;
+}
+
+
+void
+CompressedSwap::_SetEntry(swap_addr_t slotIndex, Entry* entry)
+{
+	entry->slot = slotIndex;
+	entry->ref_count = 1;
+	entry->queued = false;
+
+	MutexLocker locker(fLock);
+
+	Entry* oldEntry = fEntries[slotIndex];
+	fEntries[slotIndex] = entry;
+	_AccountEntry(entry, 1);
+	fStores++;
+
+	if (oldEntry != NULL) {
+		_AccountEntry(oldEntry, -1);
+		if (!_ReleaseEntry(oldEntry))
+			oldEntry = NULL;
+	}
+
+	if (entry->type == ENTRY_COMPRESSED) {
+		fCompressedEntries.Add(entry);
+		entry->queued = true;
+
+		if (!fWriteBackRequested
+			&& fPoolUsed > fPoolSize / 100 * kWriteBackHighWatermark) {
+			fWriteBackRequested = true;
+			fWriteBackCondition.NotifyAll();
+		}
+	}
+
+	locker.Unlock();
+
+	if (oldEntry != NULL)
+		_DeleteEntry(oldEntry);
+}
+
+
+/*!	Adds (\a sign 1) or removes (\a sign -1) the entry to/from the statistics.
+	Also dequeues removed entries. The pool usage is tracked separately, since
+	the memory of a removed entry is only freed with its last reference.
+	The lock must be held.
+*/
+void
+CompressedSwap::_AccountEntry(Entry* entry, int32 sign)
+{
+	fStoredPages += sign;
+
+	switch (entry->type) {
+		case ENTRY_SAME_FILLED:
+			fSameFilledPages += sign;
+			break;
+		case ENTRY_COMPRESSED:
+			fUncompressedBytes += sign * (int64)B_PAGE_SIZE;
+			fCompressedBytes += sign * (int64)entry->size;
+			break;
+		case ENTRY_WRITTEN_BACK:
+			fWrittenBackPages += sign;
+			break;
+	}
+
+	if (sign < 0 && entry->queued) {
+		fCompressedEntries.Remove(entry);
+		entry->queued = false;
+	}
+}
+
+
+/*!	Releases a reference to the entry. Returns whether that was the last
+	one, in which case the caller has to _DeleteEntry() it after unlocking.
+	The lock must be held.
+*/
+bool
+CompressedSwap::_ReleaseEntry(Entry* entry)
+{
+	if (--entry->ref_count > 0)
+		return false;
+
+	if (entry->type == ENTRY_COMPRESSED)
+		fPoolUsed -= entry->size;
+
+	return true;
+}
+
+
+void
+CompressedSwap::_DeleteEntry(Entry* entry)
+{
+	if (entry->type == ENTRY_WRITTEN_BACK)
+		swap_backing_slot_free(entry->backing_slot);
+
+	free_etc(entry, kAllocationFlags);
+}
+
+
+CompressedSwap::Context*
+CompressedSwap::_GetContext()
+{
+	// We might be migrated to another CPU right away, but that doesn't matter
+	// -- it just spreads the threads over the contexts.
+	Context* context = &fContexts[smp_get_current_cpu() % fContextCount];
+	mutex_lock(&context->lock);
+	return context;
+}
+
+
+void
+CompressedSwap::_PutContext(Context* context)
+{
+	mutex_unlock(&context->lock);
+}
+
+
+/*!	Writes the oldest compressed page back to the backing store.
+	Returns whether that succeeded.
+*/
+bool
+CompressedSwap::_WriteBackOldest(Context* context)
+{
+	MutexLocker locker(fLock);
+
+	Entry* entry = fCompressedEntries.RemoveHead();
+	if (entry == NULL)
+		return false;
+
+	entry->queued = false;
+	entry->ref_count++;
+	swap_addr_t slotIndex = entry->slot;
+
+	locker.Unlock();
+
+	// decompress the page, and write it to the backing store
+	status_t status = B_OK;
+	MutexLocker contextLocker(context->lock);
+
+	z_stream& stream = context->inflate_stream;
+	inflateReset(&stream);
+	stream.next_in = entry->data;
+	stream.avail_in = entry->size;
+	stream.next_out = context->page;
+	stream.avail_out = B_PAGE_SIZE;
+	if (inflate(&stream, Z_FINISH) != Z_STREAM_END || stream.avail_out != 0)
+		status = B_IO_ERROR;
+
+	Entry* newEntry = NULL;
+	if (status == B_OK) {
+		generic_io_vec vec = { (generic_addr_t)(addr_t)context->page,
+			B_PAGE_SIZE };
+		status = _WritePageToBackingStore(vec, 0, newEntry);
+	}
+
+	contextLocker.Unlock();
+
+	locker.Lock();
+
+	Entry* oldEntry = NULL;
+	if (fEntries[slotIndex] == entry) {
+		if (status == B_OK) {
+			newEntry->slot = slotIndex;
+			newEntry->ref_count = 1;
+			newEntry->queued = false;
+
+			fEntries[slotIndex] = newEntry;
+			_AccountEntry(newEntry, 1);
+			_AccountEntry(entry, -1);
+			if (_ReleaseEntry(entry))
+				oldEntry = entry;
+			newEntry = NULL;
+
+			fWriteBacks++;
+		} else {
+			// keep it as the first one to try again
+			fCompressedEntries.Add(entry, false);
+			entry->queued = true;
+		}
+	}
+
+	// The entry might have been freed or replaced while we were writing it
+	// back. In that case the written back copy is useless.
+	if (_ReleaseEntry(entry))
+		oldEntry = entry;
+
+	locker.Unlock();
+
+	if (oldEntry != NULL)
+		_DeleteEntry(oldEntry);
+	if (newEntry != NULL)
+		_DeleteEntry(newEntry);
+
+	return status == B_OK;
+}
+
+
+/*static*/ status_t
+CompressedSwap::_WriteBackThread(void* data)
+{
+	CompressedSwap* swap = (CompressedSwap*)data;
+
+	MutexLocker locker(swap->fLock);
+
+	while (true) {
+		if (!swap->fWriteBackRequested) {
+			swap->fWriteBackCondition.Wait(&swap->fLock);
+			continue;
+		}
+
+		bool success = true;
+		while (swap->fPoolUsed > swap->fPoolSize / 100 * kWriteBackLowWatermark
+			&& success) {
+			locker.Unlock();
+			success = swap->_WriteBackOldest(swap->fWriteBackContext);
+			locker.Lock();
+		}
+
+		if (!success) {
+			// There's probably no (free) backing store -- don't retry right
+			// away.
+			TRACE("write back failed, pool used: %" B_PRIuSIZE "\n",
+				swap->fPoolUsed);
+			locker.Unlock();
+			snooze(kWriteBackRetryDelay);
+			locker.Lock();
+		}
+
+		swap->fWriteBackRequested = false;
+	}
+
+	return B_OK;
+}
+
+
+#endif	// ENABLE_SWAP_SUPPORT
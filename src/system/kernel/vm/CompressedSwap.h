@@ -0,0 +1,126 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _KERNEL_VM_COMPRESSED_SWAP_H
+#define _KERNEL_VM_COMPRESSED_SWAP_H
+
+
+#include <condition_variable.h>
+#include <lock.h>
+#include <util/DoublyLinkedList.h>
+#include <util/iovec_support.h>
+
+#include "VMAnonymousCache.h"
+
+
+#if ENABLE_SWAP_SUPPORT
+
+struct vm_compressed_swap_stats;
+
+
+// The backing store the compressed swap writes pages back to, when its pool
+// runs full. Implemented by VMAnonymousCache.cpp on top of the swap files.
+status_t swap_backing_slot_alloc(swap_addr_t& _slotIndex);
+void swap_backing_slot_free(swap_addr_t slotIndex);
+status_t swap_backing_read(swap_addr_t slotIndex, const generic_io_vec* vec,
+	uint32 flags);
+status_t swap_backing_write(swap_addr_t slotIndex, const generic_io_vec* vec,
+	uint32 flags);
+
+
+/*!	A swap device that keeps the pages compressed in memory.
+
+	It is registered as a pseudo swap file and is addressed with its own slot
+	indices (0 - SlotCount() - 1). Pages that consist of a single repeated
+	word are stored without any data, all other pages are compressed with
+	zlib. When the pool is used up, pages are written back to the backing
+	store: new pages directly, and the oldest compressed pages by a
+	background thread, so that the pool keeps room for newer ones.
+*/
+class CompressedSwap {
+public:
+								CompressedSwap();
+								~CompressedSwap();
+
+			status_t			Init(swap_addr_t slotCount, size_t poolSize);
+
+			swap_addr_t			SlotCount() const	{ return fSlotCount; }
+
+			status_t			Read(swap_addr_t slotIndex,
+									const generic_io_vec* vecs, size_t count,
+									uint32 flags);
+			status_t			Write(swap_addr_t slotIndex,
+									const generic_io_vec* vecs, size_t count,
+									uint32 flags);
+			void				Free(swap_addr_t slotIndex, uint32 count);
+
+			void				GetStats(vm_compressed_swap_stats& stats);
+			void				Dump();
+
+private:
+			struct Entry;
+			struct Context;
+
+			typedef DoublyLinkedList<Entry> EntryList;
+
+			status_t			_ReadPage(swap_addr_t slotIndex,
+									generic_addr_t address,
+									generic_size_t length, uint32 flags);
+			status_t			_WritePage(swap_addr_t slotIndex,
+									generic_addr_t address,
+									generic_size_t length, uint32 flags);
+			status_t			_WritePageToBackingStore(
+									const generic_io_vec& vec, uint32 flags,
+									Entry*& _entry);
+
+			void				_SetEntry(swap_addr_t slotIndex, Entry* entry);
+			void				_AccountEntry(Entry* entry, int32 sign);
+			bool				_ReleaseEntry(Entry* entry);
+			void				_DeleteEntry(Entry* entry);
+
+			Context*			_GetContext();
+			void				_PutContext(Context* context);
+
+			bool				_WriteBackOldest(Context* context);
+	static	status_t			_WriteBackThread(void* data);
+
+private:
+			mutex				fLock;
+			Entry**				fEntries;
+			swap_addr_t			fSlotCount;
+			EntryList			fCompressedEntries;
+				// oldest first, candidates for writing back
+
+			size_t				fPoolSize;
+			size_t				fPoolUsed;
+
+			Context*			fContexts;
+			int32				fContextCount;
+			Context*			fWriteBackContext;
+
+			thread_id			fWriteBackThread;
+			ConditionVariable	fWriteBackCondition;
+			bool				fWriteBackRequested;
+
+			// statistics
+			int64				fStoredPages;
+			int64				fSameFilledPages;
+			int64				fWrittenBackPages;
+			uint64				fUncompressedBytes;
+			uint64				fCompressedBytes;
+			int64				fStores;
+			int64				fRejectedStores;
+			int64				fWriteThroughs;
+			int64				fWriteBacks;
+			int64				fLoads;
+			int64				fBackingLoads;
+			bigtime_t			fTotalLoadTime;
+			bigtime_t			fMaxLoadTime;
+};
+
+
+#endif	// ENABLE_SWAP_SUPPORT
+
+
+#endif	// _KERNEL_VM_COMPRESSED_SWAP_H
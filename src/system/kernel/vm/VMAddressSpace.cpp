@@ -12,12 +12,15 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <new>
 
 #include <KernelExport.h>
 
+#include <util/AutoLock.h>
 #include <util/OpenHashTable.h>
 
+#include <cpu.h>
 #include <heap.h>
 #include <thread.h>
 #include <vm/vm.h>
@@ -93,11 +96,18 @@ VMAddressSpace::VMAddressSpace(team_id id, addr_t base, size_t size,
 	fRefCount(1),
 	fFaultCount(0),
 	fChangeCount(0),
+	fWriteLockCount(0),
+	fSpeculativeFaults(0),
+	fSpeculativeFaultsWaiter(0),
+	fWriteRangeSequence(0),
+	fWriteRangeStart(~(addr_t)0),
+	fWriteRangeEnd(0),
 	fTranslationMap(NULL),
 	fRandomizingEnabled(true),
 	fDeleting(false)
 {
 	rw_lock_init(&fLock, name);
+	fSpeculativeFaultsCondition.Init(this, "speculative faults");
 }
 
 
@@ -168,6 +178,120 @@ VMAddressSpace::InitObject()
 }
 
 
+/*!	Returns the area containing \a address without holding the address space
+	lock, if the implementation supports it. See vm_soft_fault() for how the
+	result can be used.
+*/
+VMArea*
+VMAddressSpace::LookupAreaUnlocked(addr_t address) const
+{
+	return NULL;
+}
+
+
+/*!	Tells speculative page faults that the current writer will only change
+	the areas within the given range (and those it inserts), so that faults
+	in other areas don't need to wait for it.
+	Must be called with the address space write locked, before anything has
+	been changed. A \a size of 0 means that no existing area is changed.
+*/
+void
+VMAddressSpace::LimitWriteRange(addr_t address, size_t size)
+{
+	if (size == 0)
+		_SetWriteRange(~(addr_t)0, 0);
+	else
+		_SetWriteRange(address, address + (size - 1));
+}
+
+
+/*!	Returns whether the current writer, if any, might change an area that
+	intersects the given range. Can be called without holding any lock.
+*/
+bool
+VMAddressSpace::MayBeWritten(addr_t address, size_t size) const
+{
+	addr_t end = address + (size - 1);
+
+	while (true) {
+		int32 sequence = atomic_get((int32*)&fWriteRangeSequence);
+		if ((sequence & 1) != 0) {
+			cpu_pause();
+			continue;
+		}
+
+		addr_t start = fWriteRangeStart;
+		addr_t writeEnd = fWriteRangeEnd;
+
+		memory_read_barrier();
+		if (atomic_get((int32*)&fWriteRangeSequence) == sequence)
+			return start <= writeEnd && start <= end && address <= writeEnd;
+	}
+}
+
+
+/*!	Called when the address space has been write locked. At first, the
+	writer might change any area: we announce that and wait for the
+	speculative page faults that didn't see it yet. Since new faults back off,
+	that doesn't take longer than the faults in progress.
+*/
+void
+VMAddressSpace::_BeginWrite()
+{
+	_SetWriteRange(fBase, fEndAddress);
+
+	while (atomic_get(&fSpeculativeFaults) != 0) {
+		ConditionVariableEntry entry;
+		fSpeculativeFaultsCondition.Add(&entry);
+
+		// EndSpeculativeFault() only notifies when it sees a waiter, so we
+		// have to check again after announcing ourselves.
+		atomic_set(&fSpeculativeFaultsWaiter, 1);
+		if (atomic_get(&fSpeculativeFaults) != 0)
+			entry.Wait();
+		atomic_set(&fSpeculativeFaultsWaiter, 0);
+	}
+}
+
+
+void
+VMAddressSpace::_EndWrite()
+{
+	_SetWriteRange(~(addr_t)0, 0);
+}
+
+
+void
+VMAddressSpace::_SetWriteRange(addr_t start, addr_t end)
+{
+	// MayBeWritten() spins while the sequence is odd, so we must not be
+	// interrupted in between.
+	InterruptsLocker locker;
+
+	atomic_add(&fWriteRangeSequence, 1);
+	fWriteRangeStart = start;
+	fWriteRangeEnd = end;
+	atomic_add(&fWriteRangeSequence, 1);
+}
+
+
+/*!	Makes sure a newly inserted area is within the range the current writer
+	might change, so that speculative page faults don't see it before it is
+	completely set up. Must be called before the area is inserted.
+*/
+void
+VMAddressSpace::_ExtendWriteRange(addr_t address, size_t size)
+{
+	addr_t end = address + (size - 1);
+	if (fWriteRangeStart <= fWriteRangeEnd) {
+		address = std::min(address, fWriteRangeStart);
+		end = std::max(end, fWriteRangeEnd);
+	}
+
+	_SetWriteRange(address, end);
+}
+
+
 void
 VMAddressSpace::Dump() const
 {
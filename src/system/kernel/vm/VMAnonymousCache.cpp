@@ -56,7 +56,9 @@
 #include <vm/vm_page.h>
 #include <vm/vm_priv.h>
 #include <vm/VMAddressSpace.h>
+#include <vm_defs.h>
 
+#include "CompressedSwap.h"
 #include "IORequest.h"
 
 
@@ -85,12 +87,18 @@
 #define SWAP_BLOCK_MASK  (SWAP_BLOCK_PAGES - 1)
 
 
+// The default virtual size of the compressed swap, in multiples of its pool
+// size, i.e. the compression ratio we expect.
+#define COMPRESSED_SWAP_SIZE_FACTOR	2
+
+
 static const char* const kDefaultSwapPath = "/var/swap";
 
 struct swap_file : DoublyLinkedListLinkImpl<swap_file> {
 	int				fd;
 	struct vnode*	vnode;
 	void*			cookie;
+	CompressedSwap*	compressed;		// only set for the compressed swap
 	swap_addr_t		first_slot;
 	swap_addr_t		last_slot;
 	radix_bitmap*	bmp;
@@ -151,6 +159,7 @@ static SwapFileList sSwapFileList;
 static mutex sSwapFileListLock;
 static swap_file* sSwapFileAlloc = NULL; // allocate from here
 static uint32 sSwapFileCount = 0;
+static swap_file* sCompressedSwapFile = NULL;
 
 static off_t sAvailSwapSpace = 0;
 static mutex sAvailSwapSpaceLock;
@@ -240,8 +249,14 @@ dump_swap_info(int argc, char** argv)
 	for (SwapFileList::Iterator it = sSwapFileList.GetIterator();
 		swap_file* file = it.Next();) {
 		swap_addr_t total = file->last_slot - file->first_slot;
-		kprintf("  vnode: %p, pages: total: %" B_PRIu32 ", free: %" B_PRIu32
-			"\n", file->vnode, total, file->bmp->free_slots);
+		if (file->compressed != NULL)
+			kprintf("  compressed, ");
+		else
+			kprintf("  vnode: %p, ", file->vnode);
+		kprintf("pages: total: %" B_PRIu32 ", free: %" B_PRIu32 "\n", total,
+			file->bmp->free_slots);
+		if (file->compressed != NULL)
+			file->compressed->Dump();
 
 		totalSwapPages += total;
 		freeSwapPages += file->bmp->free_slots;
@@ -278,15 +293,27 @@ swap_slot_alloc(uint32 count)
 		return SWAP_SLOT_NONE;
 	}
 
+	// The compressed swap is always preferred; it writes pages back to the
+	// swap files itself when it runs full.
 	swap_addr_t j, addr = SWAP_SLOT_NONE;
+	if (sCompressedSwapFile != NULL) {
+		addr = radix_bitmap_alloc(sCompressedSwapFile->bmp, count);
+		if (addr != SWAP_SLOT_NONE) {
+			mutex_unlock(&sSwapFileListLock);
+			return addr + sCompressedSwapFile->first_slot;
+		}
+	}
+
 	for (j = 0; j < sSwapFileCount; j++) {
 		if (sSwapFileAlloc == NULL)
 			sSwapFileAlloc = sSwapFileList.First();
 
-		addr = radix_bitmap_alloc(sSwapFileAlloc->bmp, count);
-		if (addr != SWAP_SLOT_NONE) {
-			addr += sSwapFileAlloc->first_slot;
-			break;
+		if (sSwapFileAlloc != sCompressedSwapFile) {
+			addr = radix_bitmap_alloc(sSwapFileAlloc->bmp, count);
+			if (addr != SWAP_SLOT_NONE) {
+				addr += sSwapFileAlloc->first_slot;
+				break;
+			}
 		}
 
 		// this swap_file is full, find another
@@ -338,6 +365,16 @@ swap_slot_dealloc(swap_addr_t slotIndex, uint32 count)
 	mutex_lock(&sSwapFileListLock);
 	swap_file* swapFile = find_swap_file(slotIndex);
 	slotIndex -= swapFile->first_slot;
+
+	if (swapFile->compressed != NULL) {
+		// Freeing the pages might free backing store slots as well, so we
+		// can't hold the lock. The swap file can't go away while it still
+		// has slots allocated.
+		mutex_unlock(&sSwapFileListLock);
+		swapFile->compressed->Free(slotIndex, count);
+		mutex_lock(&sSwapFileListLock);
+	}
+
 	radix_bitmap_dealloc(swapFile->bmp, slotIndex, count);
 	mutex_unlock(&sSwapFileListLock);
 }
@@ -368,6 +405,74 @@ swap_space_unreserve(off_t amount)
 }
 
 
+/*!	Allocates a slot in one of the swap files for the compressed swap to
+	write a page back to. Unlike the compressed swap slot, this one has not
+	been accounted for by any cache, so the swap space is reserved here.
+*/
+status_t
+swap_backing_slot_alloc(swap_addr_t& _slotIndex)
+{
+	off_t reserved = swap_space_reserve(B_PAGE_SIZE);
+	if (reserved != B_PAGE_SIZE) {
+		swap_space_unreserve(reserved);
+		return B_DEVICE_FULL;
+	}
+
+	MutexLocker locker(sSwapFileListLock);
+
+	for (SwapFileList::Iterator it = sSwapFileList.GetIterator();
+			swap_file* swapFile = it.Next();) {
+		if (swapFile->compressed != NULL)
+			continue;
+
+		swap_addr_t slotIndex = radix_bitmap_alloc(swapFile->bmp, 1);
+		if (slotIndex != SWAP_SLOT_NONE) {
+			_slotIndex = slotIndex + swapFile->first_slot;
+			return B_OK;
+		}
+	}
+
+	locker.Unlock();
+
+	swap_space_unreserve(B_PAGE_SIZE);
+	return B_DEVICE_FULL;
+}
+
+
+void
+swap_backing_slot_free(swap_addr_t slotIndex)
+{
+	swap_slot_dealloc(slotIndex, 1);
+	swap_space_unreserve(B_PAGE_SIZE);
+}
+
+
+status_t
+swap_backing_read(swap_addr_t slotIndex, const generic_io_vec* vec,
+	uint32 flags)
+{
+	swap_file* swapFile = find_swap_file(slotIndex);
+	off_t pos = (off_t)(slotIndex - swapFile->first_slot) * B_PAGE_SIZE;
+	generic_size_t length = vec->length;
+
+	return vfs_read_pages(swapFile->vnode, swapFile->cookie, pos, vec, 1,
+		flags, &length);
+}
+
+
+status_t
+swap_backing_write(swap_addr_t slotIndex, const generic_io_vec* vec,
+	uint32 flags)
+{
+	swap_file* swapFile = find_swap_file(slotIndex);
+	off_t pos = (off_t)(slotIndex - swapFile->first_slot) * B_PAGE_SIZE;
+	generic_size_t length = vec->length;
+
+	return vfs_write_pages(swapFile->vnode, swapFile->cookie, pos, vec, 1,
+		flags, &length);
+}
+
+
 static void
 swap_hash_resizer(void*, int)
 {
@@ -759,6 +864,41 @@ VMAnonymousCache::StoreHasPage(off_t offset)
 }
 
 
+bool
+VMAnonymousCache::StoreHasPages(off_t offset, off_t size)
+{
+	if (fAllocatedSwapSize == 0)
+		return false;
+
+	off_t pageIndex = offset >> PAGE_SHIFT;
+	off_t endPageIndex = (offset + size + B_PAGE_SIZE - 1) >> PAGE_SHIFT;
+
+	ReadLocker locker(sSwapHashLock);
+
+	// look up every swap block only once
+	while (pageIndex < endPageIndex) {
+		off_t blockEnd = ROUNDUP(pageIndex + 1, SWAP_BLOCK_PAGES);
+		if (blockEnd > endPageIndex)
+			blockEnd = endPageIndex;
+
+		swap_hash_key key = { this, pageIndex };
+		swap_block* swap = sSwapHashTable.Lookup(key);
+		if (swap != NULL && swap->used > 0) {
+			for (; pageIndex < blockEnd; pageIndex++) {
+				if (swap->swap_slots[pageIndex & SWAP_BLOCK_MASK]
+						!= SWAP_SLOT_NONE) {
+					return true;
+				}
+			}
+		}
+
+		pageIndex = blockEnd;
+	}
+
+	return false;
+}
+
+
 bool
 VMAnonymousCache::DebugStoreHasPage(off_t offset)
 {
@@ -791,11 +931,17 @@ VMAnonymousCache::Read(off_t offset, const generic_io_vec* vecs, size_t count,
 
 		swap_file* swapFile = find_swap_file(startSlotIndex);
 
-		off_t pos = (off_t)(startSlotIndex - swapFile->first_slot)
-			* B_PAGE_SIZE;
+		status_t status;
+		if (swapFile->compressed != NULL) {
+			status = swapFile->compressed->Read(
+				startSlotIndex - swapFile->first_slot, vecs + i, j - i, flags);
+		} else {
+			off_t pos = (off_t)(startSlotIndex - swapFile->first_slot)
+				* B_PAGE_SIZE;
 
-		status_t status = vfs_read_pages(swapFile->vnode, swapFile->cookie, pos,
-			vecs + i, j - i, flags, _numBytes);
+			status = vfs_read_pages(swapFile->vnode, swapFile->cookie, pos,
+				vecs + i, j - i, flags, _numBytes);
+		}
 		if (status != B_OK)
 			return status;
 	}
@@ -863,8 +1009,14 @@ VMAnonymousCache::Write(off_t offset, const generic_io_vec* vecs, size_t count,
 			vector->base = vectorBase;
 			vector->length = length;
 
-			status_t status = vfs_write_pages(swapFile->vnode, swapFile->cookie,
-				pos, vector, 1, flags, &length);
+			status_t status;
+			if (swapFile->compressed != NULL) {
+				status = swapFile->compressed->Write(
+					slotIndex - swapFile->first_slot, vector, 1, flags);
+			} else {
+				status = vfs_write_pages(swapFile->vnode, swapFile->cookie,
+					pos, vector, 1, flags, &length);
+			}
 			if (status != B_OK) {
 				locker.Lock();
 				fAllocatedSwapSize -= (off_t)pagesLeft * B_PAGE_SIZE;
@@ -943,6 +1095,16 @@ VMAnonymousCache::WriteAsync(off_t offset, const generic_io_vec* vecs,
 
 	// write the page asynchrounously
 	swap_file* swapFile = find_swap_file(slotIndex);
+	if (swapFile->compressed != NULL) {
+		// The compressed swap stores the page right away; it only has to do
+		// I/O when writing through to its backing store.
+		status_t status = swapFile->compressed->Write(
+			slotIndex - swapFile->first_slot, vecs, 1, flags);
+		callback->IOFinished(status, status != B_OK,
+			status == B_OK ? numBytes : 0);
+		return status;
+	}
+
 	off_t pos = (off_t)(slotIndex - swapFile->first_slot) * B_PAGE_SIZE;
 
 	return vfs_asynchronous_write_pages(swapFile->vnode, swapFile->cookie, pos,
@@ -1469,6 +1631,7 @@ swap_file_add(const char* path)
 	swap->fd = fd;
 	swap->vnode = node;
 	swap->cookie = descriptor->cookie;
+	swap->compressed = NULL;
 
 	uint32 pageCount = st.st_size >> PAGE_SHIFT;
 	swap->bmp = radix_bitmap_create(pageCount);
@@ -1547,6 +1710,57 @@ swap_file_delete(const char* path)
 }
 
 
+/*!	Adds the compressed swap with a pool of the given size. It is preferred
+	over all other swap files, and uses them as its backing store.
+*/
+static status_t
+swap_add_compressed(size_t poolSize)
+{
+	poolSize = ROUNDDOWN(poolSize, B_PAGE_SIZE);
+	uint32 pageCount = poolSize / B_PAGE_SIZE * COMPRESSED_SWAP_SIZE_FACTOR;
+	if (pageCount == 0)
+		return B_BAD_VALUE;
+
+	swap_file* swap = new(std::nothrow) swap_file;
+	if (swap == NULL)
+		return B_NO_MEMORY;
+
+	swap->fd = -1;
+	swap->vnode = NULL;
+	swap->cookie = NULL;
+
+	swap->bmp = radix_bitmap_create(pageCount);
+	swap->compressed = new(std::nothrow) CompressedSwap;
+	status_t status = swap->bmp != NULL && swap->compressed != NULL
+		? swap->compressed->Init(pageCount, poolSize) : B_NO_MEMORY;
+	if (status != B_OK) {
+		if (swap->bmp != NULL)
+			radix_bitmap_destroy(swap->bmp);
+		delete swap->compressed;
+		delete swap;
+		return status;
+	}
+
+	mutex_lock(&sSwapFileListLock);
+	// leave one page gap to the swap files
+	swap->first_slot = sSwapFileList.IsEmpty()
+		? 0 : sSwapFileList.Last()->last_slot + 1;
+	swap->last_slot = swap->first_slot + pageCount;
+	sSwapFileList.Add(swap);
+	sSwapFileCount++;
+	sCompressedSwapFile = swap;
+	mutex_unlock(&sSwapFileListLock);
+
+	mutex_lock(&sAvailSwapSpaceLock);
+	sAvailSwapSpace += (off_t)pageCount * B_PAGE_SIZE;
+	mutex_unlock(&sAvailSwapSpaceLock);
+
+	dprintf("compressed swap: %" B_PRIuSIZE " KB pool, %" B_PRIu32
+		" pages\n", poolSize / 1024, pageCount);
+	return B_OK;
+}
+
+
 void
 swap_init(void)
 {
@@ -1592,6 +1806,29 @@ swap_init(void)
 void
 swap_init_post_modules()
 {
+	// The compressed swap doesn't need a device, so it's also available when
+	// booting from a read-only one.
+	void* settings = load_driver_settings("virtual_memory");
+	if (settings != NULL) {
+		if (get_driver_boolean_parameter(settings, "swap_compressed", false,
+				true)) {
+			// defaults to a quarter of the memory, and may use up to half
+			off_t memorySize = (off_t)vm_page_num_pages() * B_PAGE_SIZE;
+			off_t poolSize = memorySize / 4;
+			const char* size = get_driver_parameter(settings,
+				"swap_compressed_pool_size", NULL, NULL);
+			if (size != NULL)
+				poolSize = min_c(atoll(size), memorySize / 2);
+
+			status_t error = swap_add_compressed(poolSize);
+			if (error != B_OK) {
+				dprintf("%s: Failed to add compressed swap: %s\n", __func__,
+					strerror(error));
+			}
+		}
+		unload_driver_settings(settings);
+	}
+
 	// Never try to create a swap file on a read-only device - when booting
 	// from CD, the write overlay is used.
 	if (gReadOnlyBootDevice)
@@ -1604,7 +1841,7 @@ swap_init_post_modules()
 	dev_t swapDeviceID = -1;
 	VolumeInfo selectedVolume = {};
 
-	void* settings = load_driver_settings("virtual_memory");
+	settings = load_driver_settings("virtual_memory");
 
 	if (settings != NULL) {
 		// We pass a lot of information on the swap device, this is mostly to
@@ -1819,6 +2056,26 @@ swap_total_swap_pages()
 #endif	// ENABLE_SWAP_SUPPORT
 
 
+status_t
+_user_get_compressed_swap_stats(vm_compressed_swap_stats* userStats)
+{
+	if (userStats == NULL || !IS_USER_ADDRESS(userStats))
+		return B_BAD_ADDRESS;
+
+#if ENABLE_SWAP_SUPPORT
+	if (sCompressedSwapFile == NULL)
+		return B_ENTRY_NOT_FOUND;
+
+	vm_compressed_swap_stats stats;
+	sCompressedSwapFile->compressed->GetStats(stats);
+
+	return user_memcpy(userStats, &stats, sizeof(stats));
+#else
+	return B_NOT_SUPPORTED;
+#endif
+}
+
+
 void
 swap_get_info(system_info* info)
 {
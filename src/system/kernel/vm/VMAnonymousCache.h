@@ -52,6 +52,7 @@ public:
 	virtual	bool				CanOvercommit();
 	virtual	status_t			Commit(off_t size, int priority);
 	virtual	bool				StoreHasPage(off_t offset);
+	virtual	bool				StoreHasPages(off_t offset, off_t size);
 	virtual	bool				DebugStoreHasPage(off_t offset);
 
 	virtual	int32				GuardSize()	{ return fGuardedSize; }
@@ -119,6 +119,13 @@ VMAnonymousNoSwapCache::StoreHasPage(off_t offset)
 }
 
 
+bool
+VMAnonymousNoSwapCache::StoreHasPages(off_t offset, off_t size)
+{
+	return false;
+}
+
+
 status_t
 VMAnonymousNoSwapCache::Read(off_t offset, const generic_io_vec* vecs, size_t count,
 	uint32 flags, generic_size_t* _numBytes)
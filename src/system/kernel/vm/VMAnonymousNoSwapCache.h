@@ -27,6 +27,7 @@ public:
 	virtual	bool				CanOvercommit();
 	virtual	status_t			Commit(off_t size, int priority);
 	virtual	bool				StoreHasPage(off_t offset);
+	virtual	bool				StoreHasPages(off_t offset, off_t size);
 
 	virtual	int32				GuardSize()	{ return fGuardedSize; }
 	virtual	void				SetGuardSize(int32 guardSize)
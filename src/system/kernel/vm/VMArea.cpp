@@ -33,6 +33,8 @@ VMArea::VMArea(VMAddressSpace* addressSpace, uint32 wiring, uint32 protection)
 	cache_offset(0),
 	cache_type(0),
 	page_protections(NULL),
+	large_pages(LARGE_PAGES_DEFAULT),
+	fault_around_pages(FAULT_AROUND_DEFAULT_PAGES),
 	address_space(addressSpace)
 {
 	new (&mappings) VMAreaMappings;
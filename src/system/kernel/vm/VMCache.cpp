@@ -12,6 +12,7 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <algorithm>
 
@@ -521,6 +522,11 @@ vm_cache_init(kernel_args* args)
 	gNullCacheObjectCache = create_object_cache("null caches",
 		sizeof(VMNullCache), 0);
 
+	if (VMCachePagesTree::Init() != B_OK) {
+		panic("vm_cache_init(): Failed to create the pages tree node cache!");
+		return B_NO_MEMORY;
+	}
+
 	if (gCacheRefObjectCache == NULL
 #if ENABLE_SWAP_SUPPORT
 		|| gAnonymousCacheObjectCache == NULL
@@ -540,6 +546,8 @@ vm_cache_init(kernel_args* args)
 void
 vm_cache_init_post_heap()
 {
+	VMCachePagesTree::InitPostHeap();
+
 #if VM_CACHE_TRACING
 	add_debugger_command_etc("cache_stack", &command_cache_stack,
 		"List the ancestors (sources) of a VMCache at the time given by "
@@ -684,7 +692,7 @@ VMCache::Delete()
 
 	// free all of the pages in the cache
 	vm_page_reservation reservation = {};
-	while (vm_page* page = pages.Root()) {
+	while (vm_page* page = pages.FindMin()) {
 		if (!page->mappings.IsEmpty() || page->WiredCount() != 0) {
 			panic("remove page %p from cache %p: page still has mappings!\n"
 				"@!page %p; cache %p", page, this, page, this);
@@ -734,10 +742,13 @@ VMCache::Unlock(bool consumerLocked)
 	while (fRefCount == 1 && _IsMergeable()) {
 		VMCache* consumer = consumers.Head();
 		if (consumerLocked) {
-			_MergeWithOnlyConsumer();
+			if (!_MergeWithOnlyConsumer())
+				break;
 		} else if (consumer->TryLock()) {
-			_MergeWithOnlyConsumer();
+			bool merged = _MergeWithOnlyConsumer();
 			consumer->Unlock();
+			if (!merged)
+				break;
 		} else {
 			// Someone else has locked the consumer ATM. Unlock this cache and
 			// wait for the consumer lock. Increment the cache's ref count
@@ -749,13 +760,16 @@ VMCache::Unlock(bool consumerLocked)
 			fRefCount--;
 
 			if (consumerLockedTemp) {
+				bool merged = true;
 				if (fRefCount == 1 && _IsMergeable()
 						&& consumer == consumers.Head()) {
 					// nothing has changed in the meantime -- merge
-					_MergeWithOnlyConsumer();
+					merged = _MergeWithOnlyConsumer();
 				}
 
 				consumer->Unlock();
+				if (!merged)
+					break;
 			}
 		}
 	}
@@ -784,12 +798,34 @@ VMCache::LookupPage(off_t offset)
 }
 
 
+/*!	Inserts the \a page into this cache at the given \a offset.
+	The nodes the page tree needs for this are taken from the current thread's
+	VMCachePagesTreePreload, which the caller has to fill before locking the
+	cache.
+	The cache lock must be held.
+*/
 void
 VMCache::InsertPage(vm_page* page, off_t offset)
 {
-	TRACE(("VMCache::InsertPage(): cache %p, page %p, offset %" B_PRIdOFF "\n",
-		this, page, offset));
-	T2(InsertPage(this, page, offset));
+	status_t status = TryInsertPage(page, offset);
+	if (status != B_OK) {
+		panic("VMCache::InsertPage(): failed to insert page %p at offset %"
+			B_PRIdOFF " into cache %p: %s", page, offset, this,
+			strerror(status));
+	}
+}
+
+
+/*!	Like InsertPage(), but fails with \c B_NO_MEMORY, if the page tree needs
+	more nodes than have been preloaded, and they cannot be allocated without
+	waiting.
+	The cache lock must be held.
+*/
+status_t
+VMCache::TryInsertPage(vm_page* page, off_t offset)
+{
+	TRACE(("VMCache::TryInsertPage(): cache %p, page %p, offset %" B_PRIdOFF
+		"\n", this, page, offset));
 
 	AssertLocked();
 	ASSERT(offset >= virtual_base && offset < virtual_end);
@@ -800,22 +836,32 @@ VMCache::InsertPage(vm_page* page, off_t offset)
 	}
 
 	page->cache_offset = (page_num_t)(offset >> PAGE_SHIFT);
-	page_count++;
-	page->SetCacheRef(fCacheRef);
 
+	status_t status = pages.Insert(page);
+	if (status != B_OK) {
 #if KDEBUG
-	vm_page* otherPage = pages.Lookup(page->cache_offset);
-	if (otherPage != NULL) {
-		panic("VMCache::InsertPage(): there's already page %p with cache "
-			"offset %" B_PRIuPHYSADDR " in cache %p; inserting page %p",
-			otherPage, page->cache_offset, this, page);
-	}
+		if (status == B_NAME_IN_USE) {
+			panic("VMCache::InsertPage(): there's already page %p with cache "
+				"offset %" B_PRIuPHYSADDR " in cache %p; inserting page %p",
+				pages.Lookup(page->cache_offset), page->cache_offset, this,
+				page);
+		}
 #endif	// KDEBUG
+		return status;
+	}
 
-	pages.Insert(page);
+	T2(InsertPage(this, page, offset));
+
+	page_count++;
+	page->SetCacheRef(fCacheRef);
+
+	if (page->State() == PAGE_STATE_MODIFIED)
+		pages.SetTag(page, VM_CACHE_PAGE_TAG_MODIFIED);
 
 	if (page->WiredCount() > 0)
 		IncrementWiredPagesCount();
+
+	return B_OK;
 }
 
 
@@ -847,6 +893,8 @@ VMCache::RemovePage(vm_page* page)
 
 /*!	Moves the given page from its current cache inserts it into this cache
 	at the given offset.
+	Like for InsertPage(), the caller must have preloaded the nodes the page
+	tree might need.
 	Both caches must be locked.
 */
 void
@@ -867,7 +915,13 @@ VMCache::MovePage(vm_page* page, off_t offset)
 	page->cache_offset = offset >> PAGE_SHIFT;
 
 	// insert here
-	pages.Insert(page);
+	status_t status = pages.Insert(page);
+	if (status != B_OK) {
+		panic("VMCache::MovePage(): failed to insert page %p into cache %p: "
+			"%s", page, this, strerror(status));
+	}
+	if (page->State() == PAGE_STATE_MODIFIED)
+		pages.SetTag(page, VM_CACHE_PAGE_TAG_MODIFIED);
 	page_count++;
 	page->SetCacheRef(fCacheRef);
 
@@ -1132,8 +1186,8 @@ VMCache::_FreePageRange(VMCachePagesTree::Iterator it,
 			// temporarily (e.g. by lock_memory()), we actually must not
 			// unmap it!
 		RemovePage(page);
-			// Note: When iterating through a IteratableSplayTree
-			// removing the current node is safe.
+			// Note: The iterator only remembers the key of the current
+			// page, so removing it is safe.
 
 		vm_page_free(this, page);
 		if (freedPages != NULL)
@@ -1222,6 +1276,8 @@ VMCache::Rebase(off_t newBase, int priority)
 
 /*!	Moves pages in the given range from the source cache into this cache. Both
 	caches must be locked.
+	The caller must have preloaded the nodes the page tree might need; as many
+	as the source's page tree has suffice.
 */
 status_t
 VMCache::Adopt(VMCache* source, off_t offset, off_t size, off_t newOffset)
@@ -1292,8 +1348,8 @@ VMCache::FlushAndRemoveAllPages()
 			DEBUG_PAGE_ACCESS_START(page);
 			RemovePage(page);
 			vm_page_free(this, page);
-				// Note: When iterating through a IteratableSplayTree
-				// removing the current node is safe.
+				// Note: The iterator only remembers the key of the current
+				// page, so removing it is safe.
 		}
 	}
 
@@ -1332,6 +1388,26 @@ VMCache::StoreHasPage(off_t offset)
 }
 
 
+/*!	Returns whether the cache's underlying backing store could deliver any
+	of the pages in the given range.
+
+	The default implementation asks StoreHasPage() for every page; subclasses
+	that can answer this more efficiently should override it.
+*/
+bool
+VMCache::StoreHasPages(off_t offset, off_t size)
+{
+	off_t end = offset + size;
+	for (offset = ROUNDDOWN(offset, B_PAGE_SIZE); offset < end;
+			offset += B_PAGE_SIZE) {
+		if (StoreHasPage(offset))
+			return true;
+	}
+
+	return false;
+}
+
+
 status_t
 VMCache::Read(off_t offset, const generic_io_vec *vecs, size_t count,
 	uint32 flags, generic_size_t *_numBytes)
@@ -1395,8 +1471,8 @@ VMCache::Merge(VMCache* source)
 		if (page->cache_offset < firstOffset || page->cache_offset >= endOffset)
 			continue;
 
-		// Note: Removing the current node while iterating through a
-		// IteratableSplayTree is safe.
+		// Note: The iterator only remembers the key of the current page, so
+		// moving it away is safe.
 		vm_page* consumerPage = LookupPage(
 			(off_t)page->cache_offset << PAGE_SHIFT);
 		if (consumerPage == NULL) {
@@ -1519,10 +1595,22 @@ VMCache::_NotifyPageEvents(vm_page* page, uint32 events)
 /*!	Merges the given cache with its only consumer.
 	The caller must hold both the cache's and the consumer's lock. The method
 	does release neither lock.
+	\return \c false, if the memory for merging the page trees could not be
+		allocated without waiting. Nothing has been changed then; merging is
+		only an optimization, and the caches can as well stay as they are.
 */
-void
+bool
 VMCache::_MergeWithOnlyConsumer()
 {
+	// Moving the pages of one cache into the other one needs at most as many
+	// nodes as both page trees have together, even if pages in the way are
+	// removed first.
+	VMCachePagesTreePreload preload;
+	if (preload.TryPreload(pages.NodeCount()
+			+ consumers.Head()->pages.NodeCount()) != B_OK) {
+		return false;
+	}
+
 	VMCache* consumer = consumers.RemoveHead();
 
 	TRACE(("merge vm cache %p (ref == %" B_PRId32 ") with vm cache %p\n",
@@ -1551,6 +1639,7 @@ VMCache::_MergeWithOnlyConsumer()
 	// Release the reference the cache's consumer owned. The consumer takes
 	// over the cache's ref to its source (if any) instead.
 	ReleaseRefLocked();
+	return true;
 }
 
 
@@ -0,0 +1,695 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <vm/VMCachePagesTree.h>
+
+#include <stddef.h>
+#include <string.h>
+
+#include <KernelExport.h>
+
+#include <arch/vm.h>
+#include <debug.h>
+#include <kernel.h>
+#include <rcu.h>
+#include <slab/Slab.h>
+#include <thread.h>
+#include <util/atomic.h>
+
+
+static const uint32 kShift = 6;
+static const uint32 kSlotCount = 1 << kShift;
+static const page_num_t kSlotMask = kSlotCount - 1;
+static const size_t kMinimumNodeReserve = 256;
+
+
+struct VMCachePagesTreeNode {
+	void*					slots[kSlotCount];
+		// child nodes, or pages in leaf nodes
+	uint64					used;
+	uint64					tags[VM_CACHE_PAGE_TAG_COUNT];
+	VMCachePagesTreeNode*	parent;
+		// also links the nodes of a preload
+	uint32					shift;
+		// of the key bits that select a slot in this node; 0 for leaves
+	rcu_head				rcu;
+};
+
+
+static object_cache* sNodeCache;
+
+
+/*!	Returns the largest key that fits into a node with the given \a shift;
+	this is also the mask for the part of the key below the node.
+*/
+static inline page_num_t
+max_key(uint32 shift)
+{
+	if (shift + kShift >= sizeof(page_num_t) * 8)
+		return ~(page_num_t)0;
+
+	return ((page_num_t)1 << (shift + kShift)) - 1;
+}
+
+
+static inline uint32
+slot_index(const VMCachePagesTreeNode* node, page_num_t key)
+{
+	return (key >> node->shift) & kSlotMask;
+}
+
+
+/*!	Returns the highest number of levels the tree can have: the keys are
+	page offsets, which are limited by the size of an off_t.
+*/
+static inline uint32
+max_levels()
+{
+	uint32 keyBits = sizeof(off_t) * 8 - 1 - PAGE_SHIFT;
+	if (keyBits > sizeof(page_num_t) * 8)
+		keyBits = sizeof(page_num_t) * 8;
+
+	return (keyBits + kShift - 1) / kShift;
+}
+
+
+/*!	Removes the first node from the list of preallocated \a nodes, and
+	initializes it for the given \a shift.
+*/
+static VMCachePagesTreeNode*
+take_node(VMCachePagesTreeNode*& nodes, uint32 shift)
+{
+	VMCachePagesTreeNode* node = nodes;
+	ASSERT(node != NULL);
+	nodes = node->parent;
+
+	memset(node, 0, sizeof(VMCachePagesTreeNode));
+	node->shift = shift;
+	return node;
+}
+
+
+static void
+free_node_rcu(rcu_head* head)
+{
+	object_cache_free(sNodeCache, (uint8*)head
+		- offsetof(VMCachePagesTreeNode, rcu), 0);
+}
+
+
+static void
+free_node(VMCachePagesTreeNode* node)
+{
+	if (gKernelStartup) {
+		// there is no one else who could look at the node
+		object_cache_free(sNodeCache, node,
+			CACHE_DONT_WAIT_FOR_MEMORY | CACHE_DONT_LOCK_KERNEL_SPACE);
+		return;
+	}
+
+	// LookupUnlocked() might still be looking at the node
+	rcu_call(&node->rcu, &free_node_rcu);
+}
+
+
+//	#pragma mark - Iterator
+
+
+vm_page*
+VMCachePagesTree::Iterator::Next()
+{
+	if (fDone)
+		return NULL;
+
+	vm_page* page = fTree->_FindNext(fNextKey, fTag);
+	if (page == NULL) {
+		fDone = true;
+		return NULL;
+	}
+
+	// The page may be removed before the next call, so we only remember
+	// its key
+	fNextKey = page->cache_offset + 1;
+	if (fNextKey == 0)
+		fDone = true;
+
+	return page;
+}
+
+
+//	#pragma mark - VMCachePagesTree
+
+
+VMCachePagesTree::VMCachePagesTree()
+	:
+	fRoot(NULL),
+	fNodeCount(0)
+{
+}
+
+
+/*static*/ status_t
+VMCachePagesTree::Init()
+{
+	sNodeCache = create_object_cache("cache pages tree nodes",
+		sizeof(VMCachePagesTreeNode), 0);
+	if (sNodeCache == NULL)
+		return B_NO_MEMORY;
+
+	return B_OK;
+}
+
+
+/*!	Sets up a reserve of nodes for the slab allocator itself: when it maps
+	a chunk, the nodes for its area's cache can only be preloaded without
+	waiting, since that might need a new chunk for the node cache.
+*/
+/*static*/ void
+VMCachePagesTree::InitPostHeap()
+{
+	object_cache_set_minimum_reserve(sNodeCache, kMinimumNodeReserve);
+}
+
+
+vm_page*
+VMCachePagesTree::Lookup(page_num_t key) const
+{
+	VMCachePagesTreeNode* node = _LookupLeaf(key);
+	if (node == NULL)
+		return NULL;
+
+	return (vm_page*)node->slots[key & kSlotMask];
+}
+
+
+/*!	Looks up the page at \a key without holding the cache lock. The result
+	is only a hint, see the class description.
+*/
+vm_page*
+VMCachePagesTree::LookupUnlocked(page_num_t key) const
+{
+	RCUReadLocker locker;
+
+	VMCachePagesTreeNode* node = atomic_pointer_get(&fRoot);
+	if (node == NULL || key > max_key(node->shift))
+		return NULL;
+
+	while (true) {
+		void* slot = atomic_pointer_get(&node->slots[slot_index(node, key)]);
+		if (slot == NULL || node->shift == 0)
+			return (vm_page*)slot;
+
+		node = (VMCachePagesTreeNode*)slot;
+	}
+}
+
+
+/*!	Inserts the \a page at its vm_page::cache_offset.
+	The nodes the tree needs for this are taken from the current thread's
+	preload, see VMCachePagesTreePreload. If it doesn't have enough of them,
+	they are allocated without waiting for memory.
+	\return \c B_OK on success, \c B_NAME_IN_USE if there is another page at
+		the offset already, or \c B_NO_MEMORY if the nodes could not be
+		allocated. In both error cases, the tree has not been changed.
+*/
+status_t
+VMCachePagesTree::Insert(vm_page* page)
+{
+	page_num_t key = page->cache_offset;
+
+	if (Lookup(key) != NULL)
+		return B_NAME_IN_USE;
+
+	size_t nodeCount = _NodesNeeded(key);
+	VMCachePagesTreeNode* nodes = NULL;
+	if (nodeCount > 0) {
+		nodes = VMCachePagesTreePreload::_TakeNodes(nodeCount);
+		if (nodes == NULL)
+			return B_NO_MEMORY;
+		fNodeCount += nodeCount;
+	}
+
+	if (fRoot == NULL) {
+		uint32 shift = 0;
+		while (key > max_key(shift))
+			shift += kShift;
+
+		atomic_pointer_set(&fRoot, take_node(nodes, shift));
+	} else
+		_Grow(key, nodes);
+
+	VMCachePagesTreeNode* node = fRoot;
+	while (node->shift > 0) {
+		uint32 index = slot_index(node, key);
+		VMCachePagesTreeNode* child = (VMCachePagesTreeNode*)node->slots[index];
+		if (child == NULL) {
+			child = take_node(nodes, node->shift - kShift);
+			child->parent = node;
+			atomic_pointer_set(&node->slots[index], (void*)child);
+			node->used |= (uint64)1 << index;
+		}
+		node = child;
+	}
+
+	ASSERT(nodes == NULL);
+
+	uint32 index = key & kSlotMask;
+	atomic_pointer_set(&node->slots[index], (void*)page);
+	node->used |= (uint64)1 << index;
+	return B_OK;
+}
+
+
+bool
+VMCachePagesTree::Remove(vm_page* page)
+{
+	page_num_t key = page->cache_offset;
+
+	VMCachePagesTreeNode* node = _LookupLeaf(key);
+	if (node == NULL || node->slots[key & kSlotMask] != page)
+		return false;
+
+	uint32 index = key & kSlotMask;
+	atomic_pointer_set(&node->slots[index], (void*)NULL);
+	node->used &= ~((uint64)1 << index);
+
+	for (uint32 tag = 0; tag < VM_CACHE_PAGE_TAG_COUNT; tag++)
+		_UpdateTag(node, key, tag, false);
+
+	// free the nodes that became empty; their tags are clear already
+	while (node->used == 0) {
+		VMCachePagesTreeNode* parent = node->parent;
+		if (parent == NULL) {
+			atomic_pointer_set(&fRoot, (VMCachePagesTreeNode*)NULL);
+			free_node(node);
+			fNodeCount--;
+			return true;
+		}
+
+		index = slot_index(parent, key);
+		atomic_pointer_set(&parent->slots[index], (void*)NULL);
+		parent->used &= ~((uint64)1 << index);
+
+		free_node(node);
+		fNodeCount--;
+		node = parent;
+	}
+
+	_Shrink();
+	return true;
+}
+
+
+/*!	Returns an iterator that starts at the page with the given \a key, or the
+	next one after it. Only \a greater iterators are supported.
+*/
+VMCachePagesTree::Iterator
+VMCachePagesTree::GetIterator(page_num_t key, bool greater, bool orEqual) const
+{
+	ASSERT(greater);
+
+	if (!orEqual) {
+		if (key == ~(page_num_t)0)
+			return Iterator();
+		key++;
+	}
+
+	return Iterator(this, key);
+}
+
+
+void
+VMCachePagesTree::SetTag(vm_page* page, uint32 tag)
+{
+	VMCachePagesTreeNode* node = _LookupLeaf(page->cache_offset);
+	ASSERT(node != NULL && node->slots[page->cache_offset & kSlotMask] == page);
+
+	_UpdateTag(node, page->cache_offset, tag, true);
+}
+
+
+void
+VMCachePagesTree::ClearTag(vm_page* page, uint32 tag)
+{
+	VMCachePagesTreeNode* node = _LookupLeaf(page->cache_offset);
+	ASSERT(node != NULL && node->slots[page->cache_offset & kSlotMask] == page);
+
+	_UpdateTag(node, page->cache_offset, tag, false);
+}
+
+
+bool
+VMCachePagesTree::IsTagged(vm_page* page, uint32 tag) const
+{
+	VMCachePagesTreeNode* node = _LookupLeaf(page->cache_offset);
+	if (node == NULL)
+		return false;
+
+	return (node->tags[tag] & ((uint64)1 << (page->cache_offset & kSlotMask)))
+		!= 0;
+}
+
+
+bool
+VMCachePagesTree::HasTagged(uint32 tag) const
+{
+	return fRoot != NULL && fRoot->tags[tag] != 0;
+}
+
+
+/*!	Returns the page with the smallest key that is equal to or greater than
+	\a key. If \a tag is not negative, only pages with that tag are
+	considered.
+*/
+vm_page*
+VMCachePagesTree::_FindNext(page_num_t key, int32 tag) const
+{
+	VMCachePagesTreeNode* node = fRoot;
+	if (node == NULL || key > max_key(node->shift))
+		return NULL;
+
+	while (true) {
+		uint32 index = slot_index(node, key);
+		uint64 bitmap = (tag < 0 ? node->used : node->tags[tag])
+			& (~(uint64)0 << index);
+
+		if (bitmap == 0) {
+			// Nothing left in this node; continue with the key that follows
+			// it, starting over at the root.
+			key = (key | max_key(node->shift)) + 1;
+			node = fRoot;
+			if (key == 0 || key > max_key(node->shift))
+				return NULL;
+			continue;
+		}
+
+		uint32 nextIndex = __builtin_ffsll(bitmap) - 1;
+		if (nextIndex != index) {
+			key = (key & ~max_key(node->shift))
+				| ((page_num_t)nextIndex << node->shift);
+		}
+
+		if (node->shift == 0)
+			return (vm_page*)node->slots[nextIndex];
+
+		node = (VMCachePagesTreeNode*)node->slots[nextIndex];
+	}
+}
+
+
+VMCachePagesTreeNode*
+VMCachePagesTree::_LookupLeaf(page_num_t key) const
+{
+	VMCachePagesTreeNode* node = fRoot;
+	if (node == NULL || key > max_key(node->shift))
+		return NULL;
+
+	while (node->shift > 0) {
+		node = (VMCachePagesTreeNode*)node->slots[slot_index(node, key)];
+		if (node == NULL)
+			return NULL;
+	}
+
+	return node;
+}
+
+
+/*!	Returns how many nodes Insert() has to add to the tree for the given
+	\a key, when there is no page at it yet.
+*/
+size_t
+VMCachePagesTree::_NodesNeeded(page_num_t key) const
+{
+	uint32 shift = fRoot != NULL ? fRoot->shift : 0;
+	while (key > max_key(shift))
+		shift += kShift;
+
+	if (fRoot == NULL)
+		return shift / kShift + 1;
+
+	// The levels added on top of the root only have the old root in their
+	// first slot; if the key is not below it, the rest of its path is new.
+	size_t count = (shift - fRoot->shift) / kShift;
+	for (; shift > fRoot->shift; shift -= kShift) {
+		if (((key >> shift) & kSlotMask) != 0)
+			return count + shift / kShift;
+	}
+
+	VMCachePagesTreeNode* node = fRoot;
+	while (node->shift > 0) {
+		VMCachePagesTreeNode* child
+			= (VMCachePagesTreeNode*)node->slots[slot_index(node, key)];
+		if (child == NULL)
+			return count + node->shift / kShift;
+
+		node = child;
+	}
+
+	return count;
+}
+
+
+/*!	Adds levels on top of the tree until \a key fits in, taking the nodes from
+	\a nodes. The tree must not be empty.
+*/
+void
+VMCachePagesTree::_Grow(page_num_t key, VMCachePagesTreeNode*& nodes)
+{
+	while (key > max_key(fRoot->shift)) {
+		VMCachePagesTreeNode* oldRoot = fRoot;
+		VMCachePagesTreeNode* root = take_node(nodes, oldRoot->shift + kShift);
+
+		root->slots[0] = oldRoot;
+		root->used = 1;
+		for (uint32 tag = 0; tag < VM_CACHE_PAGE_TAG_COUNT; tag++) {
+			if (oldRoot->tags[tag] != 0)
+				root->tags[tag] = 1;
+		}
+
+		oldRoot->parent = root;
+		atomic_pointer_set(&fRoot, root);
+	}
+}
+
+
+/*!	Removes root nodes that only have a child in their first slot. */
+void
+VMCachePagesTree::_Shrink()
+{
+	while (fRoot != NULL && fRoot->shift > 0 && fRoot->used == 1) {
+		VMCachePagesTreeNode* root = fRoot;
+		VMCachePagesTreeNode* child = (VMCachePagesTreeNode*)root->slots[0];
+
+		child->parent = NULL;
+		atomic_pointer_set(&fRoot, child);
+		free_node(root);
+		fNodeCount--;
+	}
+}
+
+
+/*!	Sets or clears the \a tag for \a key in the leaf \a node, and propagates
+	the change up the tree: the tag is set for a slot, if any page below it
+	has the tag.
+*/
+void
+VMCachePagesTree::_UpdateTag(VMCachePagesTreeNode* node, page_num_t key,
+	uint32 tag, bool set)
+{
+	while (node != NULL) {
+		uint64 bit = (uint64)1 << slot_index(node, key);
+
+		if (set) {
+			bool wasTagged = node->tags[tag] != 0;
+			node->tags[tag] |= bit;
+			if (wasTagged)
+				return;
+		} else {
+			if ((node->tags[tag] & bit) == 0)
+				return;
+			node->tags[tag] &= ~bit;
+			if (node->tags[tag] != 0)
+				return;
+		}
+
+		node = node->parent;
+	}
+}
+
+
+//	#pragma mark - VMCachePagesTreePreload
+
+
+VMCachePagesTreePreload::VMCachePagesTreePreload()
+	:
+	fNodes(NULL),
+	fCount(0),
+	fPrevious(NULL),
+	fRegistered(false)
+{
+	// Early in the boot process, there is no thread yet; the nodes are
+	// always allocated on demand then.
+	Thread* thread = thread_get_current_thread();
+	if (thread == NULL)
+		return;
+
+	fPrevious = thread->cache_pages_preload;
+	thread->cache_pages_preload = this;
+	fRegistered = true;
+}
+
+
+VMCachePagesTreePreload::~VMCachePagesTreePreload()
+{
+	if (fRegistered) {
+		Thread* thread = thread_get_current_thread();
+		ASSERT(thread->cache_pages_preload == this);
+		thread->cache_pages_preload = fPrevious;
+	}
+
+	while (fNodes != NULL) {
+		VMCachePagesTreeNode* node = fNodes;
+		fNodes = node->parent;
+		object_cache_free(sNodeCache, node,
+			CACHE_DONT_WAIT_FOR_MEMORY | CACHE_DONT_LOCK_KERNEL_SPACE);
+	}
+}
+
+
+/*!	Makes sure that the preload holds at least \a nodeCount nodes, waiting
+	for memory if necessary. No cache may be locked.
+*/
+void
+VMCachePagesTreePreload::Preload(size_t nodeCount)
+{
+	while (_Preload(nodeCount, 0) != B_OK) {
+		// We don't hold any locks, so this doesn't keep anyone from freeing
+		// memory.
+		snooze(10000);
+	}
+}
+
+
+/*!	Like Preload(), but doesn't wait for memory, and can therefore be used
+	while caches are locked.
+	\return \c B_OK, if the preload holds at least \a nodeCount nodes now,
+		\c B_NO_MEMORY otherwise.
+*/
+status_t
+VMCachePagesTreePreload::TryPreload(size_t nodeCount)
+{
+	return _Preload(nodeCount,
+		CACHE_DONT_WAIT_FOR_MEMORY | CACHE_DONT_LOCK_KERNEL_SPACE);
+}
+
+
+/*!	Preloads \a nodeCount nodes into the current thread's innermost preload,
+	which must exist. This is meant for functions that refill a page
+	reservation of their caller, and not the place to create the preload.
+*/
+/*static*/ void
+VMCachePagesTreePreload::PreloadCurrent(size_t nodeCount)
+{
+	Thread* thread = thread_get_current_thread();
+	ASSERT(thread != NULL && thread->cache_pages_preload != NULL);
+
+	thread->cache_pages_preload->Preload(nodeCount);
+}
+
+
+/*!	Returns the number of nodes that suffice to insert any pages whose keys
+	lie within a range of \a pageCount consecutive keys, regardless of the
+	shape of the tree.
+*/
+/*static*/ size_t
+VMCachePagesTreePreload::NodesNeeded(page_num_t pageCount)
+{
+	if (pageCount == 0)
+		return 0;
+
+	// On each level, the range touches one node more than it fills up
+	size_t count = 0;
+	page_num_t span = kSlotCount;
+	for (uint32 level = max_levels(); level > 0; level--) {
+		count += pageCount == 1 ? 1 : (pageCount - 2) / span + 2;
+		if (span > ~(page_num_t)0 / kSlotCount)
+			span = ~(page_num_t)0;
+		else
+			span *= kSlotCount;
+	}
+
+	return count;
+}
+
+
+status_t
+VMCachePagesTreePreload::_Preload(size_t nodeCount, uint32 flags)
+{
+	if (!fRegistered)
+		return B_OK;
+
+	while (fCount < nodeCount) {
+		VMCachePagesTreeNode* node = (VMCachePagesTreeNode*)object_cache_alloc(
+			sNodeCache, flags);
+		if (node == NULL)
+			return B_NO_MEMORY;
+
+		node->parent = fNodes;
+		fNodes = node;
+		fCount++;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Returns a list of \a count nodes, linked via their parent field. They are
+	taken from the current thread's innermost preload first; the remaining
+	ones are allocated without waiting for memory.
+	\return The list of nodes, or \c NULL, if they could not be allocated.
+*/
+/*static*/ VMCachePagesTreeNode*
+VMCachePagesTreePreload::_TakeNodes(size_t count)
+{
+	Thread* thread = thread_get_current_thread();
+	VMCachePagesTreePreload* preload
+		= thread != NULL ? thread->cache_pages_preload : NULL;
+
+	VMCachePagesTreeNode* nodes = NULL;
+	for (size_t i = 0; i < count; i++) {
+		VMCachePagesTreeNode* node;
+		if (preload != NULL && preload->fNodes != NULL) {
+			node = preload->fNodes;
+			preload->fNodes = node->parent;
+			preload->fCount--;
+		} else {
+			node = (VMCachePagesTreeNode*)object_cache_alloc(sNodeCache,
+				CACHE_DONT_WAIT_FOR_MEMORY | CACHE_DONT_LOCK_KERNEL_SPACE);
+			if (node == NULL) {
+				// give back what we have got so far
+				while (nodes != NULL) {
+					node = nodes;
+					nodes = node->parent;
+					if (preload != NULL) {
+						node->parent = preload->fNodes;
+						preload->fNodes = node;
+						preload->fCount++;
+					} else {
+						object_cache_free(sNodeCache, node,
+							CACHE_DONT_WAIT_FOR_MEMORY
+								| CACHE_DONT_LOCK_KERNEL_SPACE);
+					}
+				}
+				return NULL;
+			}
+		}
+
+		node->parent = nodes;
+		nodes = node;
+	}
+
+	return nodes;
+}
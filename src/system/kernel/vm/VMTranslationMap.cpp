@@ -14,6 +14,11 @@
 #include <vm/VMCache.h>
 
 
+int32 gMappedLargePagesCount;
+int64 gLargePagePromotions;
+int64 gLargePageDemotions;
+
+
 // #pragma mark - VMTranslationMap
 
 
@@ -39,6 +44,31 @@ VMTranslationMap::DebugMarkRangePresent(addr_t start, addr_t end,
 }
 
 
+/*!	Returns the size of the large pages PromoteLargePage() can create, or
+	\c 0, if the implementation doesn't support them.
+*/
+size_t
+VMTranslationMap::LargePageSize() const
+{
+	return 0;
+}
+
+
+/*!	Replaces the mappings of the large page at \a address (aligned to
+	LargePageSize()) with a single large page mapping.
+	All small pages of the range must be mapped with the same attributes, and
+	they must be physically contiguous and aligned. Any later operation that
+	affects only part of the range splits the large page again. The page
+	mappings of the individual pages are not touched.
+	The map must be locked.
+*/
+status_t
+VMTranslationMap::PromoteLargePage(addr_t address)
+{
+	return B_NOT_SUPPORTED;
+}
+
+
 /*!	Unmaps a range of pages of an area.
 
 	The default implementation just iterates over all virtual pages of the
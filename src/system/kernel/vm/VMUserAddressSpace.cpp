@@ -125,9 +125,7 @@ VMUserAddressSpace::CreateArea(const char* name, uint32 wiring,
 void
 VMUserAddressSpace::DeleteArea(VMArea* _area, uint32 allocationFlags)
 {
-	VMUserArea* area = static_cast<VMUserArea*>(_area);
-	area->~VMUserArea();
-	free_etc(area, allocationFlags);
+	_FreeArea(static_cast<VMUserArea*>(_area));
 }
 
 
@@ -143,6 +141,39 @@ VMUserAddressSpace::LookupArea(addr_t address) const
 }
 
 
+/*!	Looks up the area containing \a address without holding the address
+	space lock. Since the tree might be changed at the same time, the lookup
+	might take a wrong turn and return an area that doesn't contain
+	\a address (anymore), or no area at all. It doesn't access freed memory,
+	though: areas are freed only after all RCU read sections that could still
+	see them have been left. The caller must be in such a read section, and
+	has to validate the result.
+*/
+VMArea*
+VMUserAddressSpace::LookupAreaUnlocked(addr_t address) const
+{
+	// An AVL tree can't be higher than that, unless we're going in circles.
+	static const int32 kMaxSteps = 64;
+
+	VMUserArea* candidate = NULL;
+	AVLTreeNode* node = fAreas.RootNode();
+	for (int32 steps = 0; node != NULL && steps < kMaxSteps; steps++) {
+		VMUserArea* area = static_cast<VMUserArea*>(node);
+		if (address < area->Base()) {
+			node = atomic_pointer_get(&node->left);
+		} else {
+			candidate = area;
+			node = atomic_pointer_get(&node->right);
+		}
+	}
+
+	if (candidate == NULL || candidate->id == RESERVED_AREA_ID)
+		return NULL;
+
+	return candidate;
+}
+
+
 //! You must hold the address space's read lock.
 VMArea*
 VMUserAddressSpace::FindClosestArea(addr_t address, bool less) const
@@ -267,8 +298,7 @@ VMUserAddressSpace::ResizeArea(VMArea* _area, size_t newSize,
 		addr_t offset = area->Base() + newSize - next->Base();
 		if (next->Size() <= offset) {
 			RemoveArea(next, allocationFlags);
-			next->~VMUserArea();
-			free_etc(next, allocationFlags);
+			_FreeArea(next);
 		} else {
 			status_t error = ShrinkAreaHead(next, next->Size() - offset,
 				allocationFlags);
@@ -311,6 +341,26 @@ VMUserAddressSpace::ShrinkAreaTail(VMArea* area, size_t size,
 }
 
 
+/*!	Areas that have been in the tree are freed only after an RCU grace period,
+	since LookupAreaUnlocked() might still be looking at them.
+*/
+/*static*/ void
+VMUserAddressSpace::_FreeArea(VMUserArea* area)
+{
+	rcu_call(&area->rcu, &_FreeAreaRCU);
+}
+
+
+/*static*/ void
+VMUserAddressSpace::_FreeAreaRCU(rcu_head* head)
+{
+	VMUserArea* area = (VMUserArea*)((uint8*)head - offsetof(VMUserArea, rcu));
+	uint32 allocationFlags = area->allocation_flags;
+	area->~VMUserArea();
+	free_etc(area, allocationFlags);
+}
+
+
 status_t
 VMUserAddressSpace::ReserveAddressRange(size_t size,
 	const virtual_address_restrictions* addressRestrictions,
@@ -368,8 +418,7 @@ VMUserAddressSpace::UnreserveAddressRange(addr_t address, size_t size,
 			// remove reserved range
 			RemoveArea(area, allocationFlags);
 			Put();
-			area->~VMUserArea();
-			free_etc(area, allocationFlags);
+			_FreeArea(area);
 		}
 	}
 
@@ -385,8 +434,7 @@ VMUserAddressSpace::UnreserveAllAddressRanges(uint32 allocationFlags)
 		if (area->id == RESERVED_AREA_ID) {
 			RemoveArea(area, allocationFlags);
 			Put();
-			area->~VMUserArea();
-			free_etc(area, allocationFlags);
+			_FreeArea(area);
 		}
 	}
 }
@@ -475,8 +523,7 @@ VMUserAddressSpace::_InsertAreaIntoReservedRegion(addr_t start, size_t size,
 			// the new area fully covers the reserved range
 			fAreas.Remove(reserved);
 			Put();
-			reserved->~VMUserArea();
-			free_etc(reserved, allocationFlags);
+			_FreeArea(reserved);
 		} else {
 			// resize the reserved range behind the area
 			reserved->SetBase(reserved->Base() + size);
@@ -509,6 +556,7 @@ VMUserAddressSpace::_InsertAreaIntoReservedRegion(addr_t start, size_t size,
 
 	area->SetBase(start);
 	area->SetSize(size);
+	_ExtendWriteRange(start, size);
 	fAreas.Insert(area);
 	IncrementChangeCount();
 
@@ -691,8 +739,7 @@ second_chance:
 
 						foundSpot = true;
 						area->SetBase(alignedBase);
-						next->~VMUserArea();
-						free_etc(next, allocationFlags);
+						_FreeArea(next);
 						break;
 					}
 
@@ -775,6 +822,7 @@ second_chance:
 		fNextInsertHint = area->Base() + size;
 
 	area->SetSize(size);
+	_ExtendWriteRange(area->Base(), size);
 	fAreas.Insert(area);
 	IncrementChangeCount();
 	return B_OK;
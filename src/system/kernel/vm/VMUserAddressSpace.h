@@ -21,6 +21,7 @@ public:
 	virtual	VMArea*				NextArea(VMArea* area) const;
 
 	virtual	VMArea*				LookupArea(addr_t address) const;
+	virtual	VMArea*				LookupAreaUnlocked(addr_t address) const;
 	virtual	VMArea*				FindClosestArea(addr_t address, bool less)
 									const;
 	virtual	VMArea*				CreateArea(const char* name, uint32 wiring,
@@ -59,6 +60,9 @@ private:
 	static	addr_t				_RandomizeAddress(addr_t start, addr_t end,
 									size_t alignment, bool initial = false);
 
+	static	void				_FreeArea(VMUserArea* area);
+	static	void				_FreeAreaRCU(rcu_head* head);
+
 			status_t			_InsertAreaIntoReservedRegion(addr_t start,
 									size_t size, VMUserArea* area,
 									uint32 allocationFlags);
@@ -13,7 +13,8 @@
 VMUserArea::VMUserArea(VMAddressSpace* addressSpace, uint32 wiring,
 	uint32 protection)
 	:
-	VMArea(addressSpace, wiring, protection)
+	VMArea(addressSpace, wiring, protection),
+	allocation_flags(0)
 {
 }
 
@@ -32,6 +33,8 @@ VMUserArea::Create(VMAddressSpace* addressSpace, const char* name,
 	if (area == NULL)
 		return NULL;
 
+	area->allocation_flags = allocationFlags;
+
 	if (area->Init(name, allocationFlags) != B_OK) {
 		area->~VMUserArea();
 		free_etc(area, allocationFlags);
@@ -51,6 +54,7 @@ VMUserArea::CreateReserved(VMAddressSpace* addressSpace, uint32 flags,
 	if (area != NULL) {
 		area->id = RESERVED_AREA_ID;
 		area->protection = flags;
+		area->allocation_flags = allocationFlags;
 	}
 	return area;
 }
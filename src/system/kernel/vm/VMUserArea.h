@@ -6,6 +6,7 @@
 #define VM_USER_AREA_H
 
 
+#include <rcu.h>
 #include <util/AVLTree.h>
 
 #include <vm/VMArea.h>
@@ -24,6 +25,12 @@ struct VMUserArea : VMArea, AVLTreeNode {
 									uint32 protection, uint32 allocationFlags);
 	static	VMUserArea*			CreateReserved(VMAddressSpace* addressSpace,
 									uint32 flags, uint32 allocationFlags);
+
+			rcu_head			rcu;
+				// for deferring the deletion, see
+				// VMUserAddressSpace::LookupAreaUnlocked()
+			uint32				allocation_flags;
+				// the area is freed with these when the deletion happens
 };
 
 
@@ -11,6 +11,7 @@
 #include <vm/vm.h>
 
 #include <ctype.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -39,6 +40,7 @@
 #include <kernel.h>
 #include <int.h>
 #include <lock.h>
+#include <rcu.h>
 #include <low_resource_manager.h>
 #include <slab/Slab.h>
 #include <smp.h>
@@ -256,6 +258,16 @@ static off_t sNeededMemory;
 static uint32 sPageFaults;
 static VMPhysicalPageMapper* sPhysicalPageMapper;
 
+// By default, large pages are only used for areas of at least that many
+// large pages, so that smaller areas don't end up using a lot more memory
+// than they touch.
+static const size_t kLargePagesMinAreaPages = 8;
+static const bigtime_t kLargePageRetryDelay = 1000000;
+
+static int64 sLargePageFaults;
+static int64 sLargePageFallbacks;
+static bigtime_t sLargePageRetryTime;
+
 
 // function declarations
 static void delete_area(VMAddressSpace* addressSpace, VMArea* area,
@@ -929,6 +941,8 @@ cut_area(VMAddressSpace* addressSpace, VMArea* area, addr_t address,
 	AutoLocker<VMCache> areaCacheLocker, secondCacheLocker;
 
 	if (onlyCacheUser) {
+		VMCachePagesTreePreload preload;
+
 		// Create a new cache for the second area.
 		VMCache* secondCache;
 		error = VMCacheFactory::CreateAnonymousCache(secondCache,
@@ -947,6 +961,12 @@ cut_area(VMAddressSpace* addressSpace, VMArea* area, addr_t address,
 		secondCache->virtual_base = secondCacheOffset;
 		error = secondCache->Resize(secondCache->virtual_base + secondSize, resizePriority);
 
+		if (error == B_OK) {
+			// Moving the pages, and moving them back in case of an error, needs
+			// at most twice as many page tree nodes as the cache has.
+			error = preload.TryPreload(2 * cache->pages.NodeCount());
+		}
+
 		if (error == B_OK) {
 			if (cache->source != NULL)
 				cache->source->AddConsumer(secondCache);
@@ -1040,6 +1060,9 @@ cut_area(VMAddressSpace* addressSpace, VMArea* area, addr_t address,
 		free_etc(areaOldProtections, allocationFlags);
 	}
 
+	secondArea->large_pages = area->large_pages;
+	secondArea->fault_around_pages = area->fault_around_pages;
+
 	if (resizePriority == -1) {
 		// Adjust commitments.
 		const off_t areaCommit = compute_area_page_commitment(area) * B_PAGE_SIZE;
@@ -1418,6 +1441,31 @@ wait_if_address_range_is_wired(VMAddressSpace* addressSpace, addr_t base,
 }
 
 
+/*!	Tells speculative page faults that the current write session of the
+	address space will only change the areas intersecting the given range,
+	respectively add new areas, if \a size is 0.
+	Faults in all other areas can then be resolved without waiting for the
+	address space lock. The address space must be write-locked.
+*/
+static void
+limit_address_space_write_range(VMAddressSpace* addressSpace, addr_t base,
+	size_t size)
+{
+	if (size > 0) {
+		addr_t end = base + (size - 1);
+		VMAddressSpace::AreaRangeIterator it
+			= addressSpace->GetAreaRangeIterator(base, size);
+		while (VMArea* area = it.Next()) {
+			base = std::min(base, area->Base());
+			end = std::max(end, area->Base() + (area->Size() - 1));
+		}
+		size = end - base + 1;
+	}
+
+	addressSpace->LimitWriteRange(base, size);
+}
+
+
 /*!	Prepares an area to be used for vm_set_kernel_area_debug_protection().
 	It must be called in a situation where the kernel address space may be
 	locked.
@@ -1749,6 +1797,7 @@ vm_create_anonymous_area(team_id team, const char *name, addr_t size,
 		reservedPages += size / B_PAGE_SIZE;
 
 	vm_page_reservation reservation;
+	VMCachePagesTreePreload preload;
 	if (reservedPages > 0) {
 		if ((flags & CREATE_AREA_DONT_WAIT) != 0) {
 			if (!vm_page_try_reserve_pages(&reservation, reservedPages,
@@ -1761,6 +1810,21 @@ vm_create_anonymous_area(team_id team, const char *name, addr_t size,
 			vm_page_reserve_pages(&reservation, reservedPages, priority);
 	}
 
+	// Likewise preload the nodes of the cache's page tree, since the pages
+	// are inserted with the cache locked.
+	if (wiring == B_FULL_LOCK || wiring == B_ALREADY_WIRED
+		|| wiring == B_CONTIGUOUS) {
+		size_t nodeCount = VMCachePagesTreePreload::NodesNeeded(
+			size / B_PAGE_SIZE);
+		if ((flags & CREATE_AREA_DONT_WAIT) != 0) {
+			if (preload.TryPreload(nodeCount) != B_OK) {
+				status = B_WOULD_BLOCK;
+				goto err0;
+			}
+		} else
+			preload.Preload(nodeCount);
+	}
+
 	if (wiring == B_CONTIGUOUS) {
 		// we try to allocate the page run here upfront as this may easily
 		// fail for obvious reasons
@@ -1787,6 +1851,13 @@ vm_create_anonymous_area(team_id team, const char *name, addr_t size,
 		&& wait_if_address_range_is_wired(addressSpace,
 			(addr_t)virtualAddressRestrictions->address, size, &locker));
 
+	if (virtualAddressRestrictions->address_specification == B_EXACT_ADDRESS
+		&& (flags & CREATE_AREA_UNMAP_ADDRESS_RANGE) != 0) {
+		limit_address_space_write_range(addressSpace,
+			(addr_t)virtualAddressRestrictions->address, size);
+	} else
+		limit_address_space_write_range(addressSpace, 0, 0);
+
 	// create an anonymous cache
 	// if it's a stack, make sure that two pages are available at least
 	status = VMCacheFactory::CreateAnonymousCache(cache, canOvercommit,
@@ -2268,6 +2339,12 @@ pre_map_area_pages(VMArea* area, VMCache* cache,
 }
 
 
+static area_id _vm_map_vnode(team_id team, const char* name, void** _address,
+	uint32 addressSpec, size_t size, uint32 protection, uint32 protectionMax,
+	uint32 mapping, uint32 mappingFlags, bool unmapAddressRange,
+	struct vnode* vnode, off_t offset, bool kernel);
+
+
 /*!	Will map the file specified by \a fd to an area in memory.
 	The file will be mirrored beginning at the specified \a offset. The
 	\a offset and \a size arguments have to be page aligned.
@@ -2344,6 +2421,23 @@ _vm_map_file(team_id team, const char* name, void** _address,
 		return status;
 	VnodePutter vnodePutter(vnode);
 
+	return _vm_map_vnode(team, name, _address, addressSpec, size, protection,
+		protectionMax, mapping, mappingFlags, unmapAddressRange, vnode, offset,
+		kernel);
+}
+
+
+/*!	Maps the file cache of \a vnode. The caller is responsible for checking
+	the permissions, and for keeping a reference to the vnode.
+*/
+static area_id
+_vm_map_vnode(team_id team, const char* name, void** _address,
+	uint32 addressSpec, size_t size, uint32 protection, uint32 protectionMax,
+	uint32 mapping, uint32 mappingFlags, bool unmapAddressRange,
+	struct vnode* vnode, off_t offset, bool kernel)
+{
+	status_t status;
+
 	// If we're going to pre-map pages, we need to reserve the pages needed by
 	// the mapping backend upfront.
 	page_num_t reservedPreMapPages = 0;
@@ -2354,6 +2448,8 @@ _vm_map_file(team_id team, const char* name, void** _address,
 		if (status != B_OK)
 			return status;
 
+		limit_address_space_write_range(locker.AddressSpace(), 0, 0);
+
 		VMTranslationMap* map = locker.AddressSpace()->TranslationMap();
 		reservedPreMapPages = map->MaxPagesNeededToMap(0, size - 1);
 
@@ -2390,6 +2486,9 @@ _vm_map_file(team_id team, const char* name, void** _address,
 		&& wait_if_address_range_is_wired(locker.AddressSpace(),
 			(addr_t)*_address, size, &locker));
 
+	limit_address_space_write_range(locker.AddressSpace(),
+		unmapAddressRange ? (addr_t)*_address : 0, unmapAddressRange ? size : 0);
+
 	// TODO: this only works for file systems that use the file cache
 	VMCache* cache;
 	status = vfs_get_vnode_cache(vnode, &cache, false);
@@ -2458,6 +2557,27 @@ vm_map_file(team_id aid, const char* name, void** address, uint32 addressSpec,
 }
 
 
+/*!	Maps the file cache of \a vnode into the kernel address space, shared
+	and read-only. The caller must keep a reference to the vnode while the
+	area exists.
+*/
+area_id
+vm_map_vnode_cache(const char* name, void** _address, uint32 addressSpec,
+	addr_t size, struct vnode* vnode, off_t offset)
+{
+	if ((offset % B_PAGE_SIZE) != 0)
+		return B_BAD_VALUE;
+
+	return _vm_map_vnode(VMAddressSpace::KernelID(), name, _address,
+		addressSpec, PAGE_ALIGN(size), B_KERNEL_READ_AREA | B_SHARED_AREA,
+		0, REGION_NO_PRIVATE_MAP, 0, false, vnode, offset, true);
+}
+
+
+/*!	Returns the area's cache locked and with a reference.
+	Returns \c NULL only for an area that has been deleted, which can only
+	happen when it has been found by VMAddressSpace::LookupAreaUnlocked().
+*/
 VMCache*
 vm_area_get_locked_cache(VMArea* area)
 {
@@ -2465,6 +2585,10 @@ vm_area_get_locked_cache(VMArea* area)
 
 	while (true) {
 		VMCache* cache = area->cache;
+		if (cache == NULL) {
+			rw_lock_read_unlock(&sAreaCacheLock);
+			return NULL;
+		}
 
 		if (!cache->SwitchFromReadLock(&sAreaCacheLock)) {
 			// cache has been deleted
@@ -2709,8 +2833,15 @@ delete_area(VMAddressSpace* addressSpace, VMArea* area,
 	addressSpace->RemoveArea(area, allocationFlags);
 	addressSpace->Put();
 
-	area->cache->RemoveArea(area);
-	area->cache->ReleaseRef();
+	// Speculative page faults might still find the area, but they must not
+	// get to its cache anymore (cf. vm_area_get_locked_cache()).
+	rw_lock_write_lock(&sAreaCacheLock);
+	VMCache* cache = area->cache;
+	area->cache = NULL;
+	rw_lock_write_unlock(&sAreaCacheLock);
+
+	cache->RemoveArea(area);
+	cache->ReleaseRef();
 
 	addressSpace->DeleteArea(area, allocationFlags);
 }
@@ -2754,6 +2885,8 @@ vm_delete_area(team_id team, area_id id, bool kernel)
 	- All of the cache's areas' address spaces must be read locked.
 	- Either the cache must not have any wired ranges or a page reservation for
 	  all wired pages must be provided, so they can be copied.
+	- In the latter case, twice as many page tree nodes as the cache's page
+	  tree has must be preloaded (cf. VMCachePagesTreePreload).
 
 	\param lowerCache The cache on top of which a new cache shall be created.
 	\param wiredPagesReservation If \c NULL there must not be any wired pages
@@ -2924,6 +3057,7 @@ vm_copy_area(team_id team, const char* name, void** _address,
 
 	page_num_t wiredPages = 0;
 	vm_page_reservation wiredPagesReservation;
+	VMCachePagesTreePreload preload;
 
 	bool restart;
 	do {
@@ -2946,19 +3080,26 @@ vm_copy_area(team_id team, const char* name, void** _address,
 		wiredPages = 0;
 
 		// If the source area isn't shared, count the number of wired pages in
-		// the cache and reserve as many pages.
+		// the cache and reserve as many pages. Moving them and inserting their
+		// copies also needs page tree nodes.
 		if (!sharedArea) {
 			wiredPages = cache->WiredPagesCount();
+			size_t treeNodes
+				= wiredPages > 0 ? 2 * cache->pages.NodeCount() : 0;
 
-			if (wiredPages > oldWiredPages) {
+			if (wiredPages > oldWiredPages || treeNodes > preload.Count()) {
 				cacheLocker.Unlock();
 				locker.Unlock();
 
-				if (oldWiredPages > 0)
-					vm_page_unreserve_pages(&wiredPagesReservation);
+				if (wiredPages > oldWiredPages) {
+					if (oldWiredPages > 0)
+						vm_page_unreserve_pages(&wiredPagesReservation);
+
+					vm_page_reserve_pages(&wiredPagesReservation, wiredPages,
+						VM_PRIORITY_USER);
+				}
 
-				vm_page_reserve_pages(&wiredPagesReservation, wiredPages,
-					VM_PRIORITY_USER);
+				preload.Preload(treeNodes);
 
 				restart = true;
 			}
@@ -3031,6 +3172,9 @@ vm_copy_area(team_id team, const char* name, void** _address,
 		return status;
 	}
 
+	target->large_pages = source->large_pages;
+	target->fault_around_pages = source->fault_around_pages;
+
 	if (targetPageProtections != NULL) {
 		target->page_protections = targetPageProtections;
 
@@ -4233,7 +4377,9 @@ struct PageFaultContext {
 	VMCache*				topCache;
 	off_t					cacheOffset;
 	vm_page_reservation		reservation;
+	VMCachePagesTreePreload	preload;
 	bool					isWrite;
+	bool					speculative;
 
 	// return values
 	vm_page*				page;
@@ -4245,7 +4391,8 @@ struct PageFaultContext {
 		:
 		addressSpaceLocker(addressSpace, true),
 		map(addressSpace->TranslationMap()),
-		isWrite(isWrite)
+		isWrite(isWrite),
+		speculative(false)
 	{
 	}
 
@@ -4271,10 +4418,84 @@ struct PageFaultContext {
 		topCache = NULL;
 		addressSpaceLocker.Unlock();
 		cacheChainLocker.Unlock(exceptCache);
+
+		if (speculative) {
+			addressSpaceLocker.AddressSpace()->EndSpeculativeFault();
+			speculative = false;
+		}
 	}
 };
 
 
+/*!	Finds the area containing \a address and locks its top cache without
+	locking the address space, unless a writer of the address space might be
+	changing the area.
+	On success, the fault is registered as speculative with the address space,
+	which makes new writers wait for it until PageFaultContext::UnlockAll(),
+	and \a context is prepared as for a regular fault. Otherwise \c NULL is
+	returned, and the fault has to lock the address space.
+*/
+static VMArea*
+fault_lookup_area_speculatively(PageFaultContext& context,
+	VMAddressSpace* addressSpace, addr_t address)
+{
+	addressSpace->BeginSpeculativeFault();
+
+	VMArea* area;
+	VMCache* cache = NULL;
+	{
+		RCUReadLocker rcuLocker;
+
+		area = addressSpace->LookupAreaUnlocked(address);
+		if (area != NULL) {
+			// While the area is being changed, base and size might not match,
+			// but they still lie within the range the writer announced.
+			addr_t base = area->Base();
+			size_t size = area->Size();
+			if (address >= base && address <= base + (size - 1)
+				&& !addressSpace->MayBeWritten(base, size)) {
+				cache = vm_area_get_locked_cache(area);
+			}
+		}
+	}
+
+	if (cache != NULL && area->wiring != B_NO_LOCK) {
+		vm_area_put_locked_cache(cache);
+		cache = NULL;
+	}
+
+	if (cache == NULL) {
+		addressSpace->EndSpeculativeFault();
+		return NULL;
+	}
+
+	context.speculative = true;
+	context.Prepare(cache, address - area->Base() + area->cache_offset);
+	return area;
+}
+
+
+/*!	Inserts the newly allocated \a page into \a cache at the fault's offset.
+	Page tree nodes are only preloaded once this fails, since the nodes are
+	usually there already. In that case, the page is freed again, everything
+	is unlocked, and \c false is returned with \c context.restart set to
+	\c true.
+*/
+static bool
+fault_insert_page(PageFaultContext& context, VMCache* cache, vm_page* page)
+{
+	if (cache->TryInsertPage(page, context.cacheOffset) == B_OK)
+		return true;
+
+	vm_page_free_etc(NULL, page, &context.reservation);
+	context.UnlockAll();
+	context.preload.Preload(VMCachePagesTreePreload::NodesNeeded(1));
+
+	context.restart = true;
+	return false;
+}
+
+
 /*!	Gets the page that should be mapped into the area.
 	Returns an error code other than \c B_OK, if the page couldn't be found or
 	paged in. The locking state of the address space and the caches is undefined
@@ -4321,7 +4542,8 @@ fault_get_page(PageFaultContext& context)
 			// insert a fresh page and mark it busy -- we're going to read it in
 			page = vm_page_allocate_page(&context.reservation,
 				PAGE_STATE_ACTIVE | VM_PAGE_ALLOC_BUSY);
-			cache->InsertPage(page, context.cacheOffset);
+			if (!fault_insert_page(context, cache, page))
+				return B_OK;
 
 			// We need to unlock all caches and the address space while reading
 			// the page in. Keep a reference to the cache around.
@@ -4382,7 +4604,8 @@ fault_get_page(PageFaultContext& context)
 			page->physical_page_number));
 
 		// insert the new page into our cache
-		cache->InsertPage(page, context.cacheOffset);
+		if (!fault_insert_page(context, cache, page))
+			return B_OK;
 		context.pageAllocated = true;
 	} else if (page->Cache() != context.topCache && context.isWrite) {
 		// We have a page that has the data we want, but in the wrong cache
@@ -4409,7 +4632,8 @@ fault_get_page(PageFaultContext& context)
 		sourcePage->Cache()->IncrementCopiedPagesCount();
 
 		// insert the new page into our cache
-		context.topCache->InsertPage(page, context.cacheOffset);
+		if (!fault_insert_page(context, context.topCache, page))
+			return B_OK;
 		context.pageAllocated = true;
 	} else
 		DEBUG_PAGE_ACCESS_START(page);
@@ -4419,6 +4643,259 @@ fault_get_page(PageFaultContext& context)
 }
 
 
+/*!	Returns whether the fault at \a address can be resolved by mapping a
+	complete large page, and if so, the large page's base address via
+	\a _base.
+	This is only done for private anonymous memory, when the large page's
+	range is completely unpopulated yet.
+	The address space must be locked as well as the area's top cache.
+*/
+static bool
+large_page_fault_possible(VMArea* area, VMCache* topCache, addr_t address,
+	addr_t& _base)
+{
+	VMAddressSpace* addressSpace = area->address_space;
+	size_t largePageSize = addressSpace->TranslationMap()->LargePageSize();
+	if (largePageSize == 0 || addressSpace == VMAddressSpace::Kernel())
+		return false;
+
+	if (area->large_pages == VMArea::LARGE_PAGES_NEVER
+		|| (area->large_pages == VMArea::LARGE_PAGES_DEFAULT
+			&& area->Size() < kLargePagesMinAreaPages * largePageSize)) {
+		return false;
+	}
+
+	if (area->cache_type != CACHE_TYPE_RAM || area->wiring != B_NO_LOCK
+		|| area->page_protections != NULL
+		|| (area->MemoryType() != 0
+			&& area->MemoryType() != B_WRITE_BACK_MEMORY)
+		|| topCache->type != CACHE_TYPE_RAM || topCache->source != NULL
+		|| topCache->CanOvercommit()) {
+		return false;
+	}
+
+	addr_t base = ROUNDDOWN(address, largePageSize);
+	if (base < area->Base()
+		|| base + (largePageSize - 1) > area->Base() + (area->Size() - 1)
+		|| area->IsWired(base, largePageSize)) {
+		return false;
+	}
+
+	if (system_time() < atomic_get64(&sLargePageRetryTime)
+		|| low_resource_state(B_KERNEL_RESOURCE_PAGES) != B_NO_LOW_RESOURCE) {
+		return false;
+	}
+
+	// none of the pages must exist yet, neither in memory nor in swap
+	off_t cacheOffset = base - area->Base() + area->cache_offset;
+	off_t cacheEnd = cacheOffset + largePageSize;
+
+	vm_page* page = topCache->pages.GetIterator(
+		(page_num_t)(cacheOffset >> PAGE_SHIFT), true, true).Next();
+	if (page != NULL
+		&& page->cache_offset < (page_num_t)(cacheEnd >> PAGE_SHIFT)) {
+		return false;
+	}
+
+	if (topCache->StoreHasPages(cacheOffset, largePageSize))
+		return false;
+
+	_base = base;
+	return true;
+}
+
+
+/*!	Resolves a page fault by inserting a physically contiguous run of new
+	pages for the complete large page at \a base into the area's top cache,
+	and mapping them as a large page.
+	The address space and the area's top cache must be locked, and
+	large_page_fault_possible() must have returned \c true.
+	Everything is unlocked while allocating the pages. If that fails, or the
+	situation has changed in the meantime, \c false is returned with
+	everything unlocked, and the fault needs to be restarted. Otherwise the
+	address space and the top cache are still locked.
+*/
+static bool
+fault_large_page(PageFaultContext& context, VMAddressSpace* addressSpace,
+	addr_t address, addr_t base)
+{
+	size_t largePageSize = context.map->LargePageSize();
+	page_num_t pageCount = largePageSize / B_PAGE_SIZE;
+
+	context.UnlockAll();
+
+	VMCachePagesTreePreload preload;
+	if (preload.TryPreload(VMCachePagesTreePreload::NodesNeeded(pageCount))
+			!= B_OK) {
+		atomic_add64(&sLargePageFallbacks, 1);
+		return false;
+	}
+
+	physical_address_restrictions restrictions = {};
+	restrictions.alignment = largePageSize;
+	vm_page* pages = vm_page_allocate_page_run(
+		PAGE_STATE_ACTIVE | VM_PAGE_ALLOC_CLEAR | VM_PAGE_ALLOC_DONT_WAIT,
+		pageCount, &restrictions, VM_PRIORITY_USER);
+	if (pages == NULL) {
+		// Physical memory is fragmented or getting scarce -- don't waste any
+		// time on trying again for a while.
+		atomic_set64(&sLargePageRetryTime,
+			system_time() + kLargePageRetryDelay);
+		atomic_add64(&sLargePageFallbacks, 1);
+		return false;
+	}
+
+	// Since we had to unlock everything, check whether the large page is
+	// still needed.
+	context.addressSpaceLocker.Lock();
+
+	VMArea* area = addressSpace->LookupArea(address);
+	if (area != NULL) {
+		context.Prepare(vm_area_get_locked_cache(area),
+			address - area->Base() + area->cache_offset);
+
+		addr_t newBase;
+		if (!large_page_fault_possible(area, context.topCache, address,
+				newBase) || newBase != base) {
+			area = NULL;
+		}
+	}
+
+	if (area == NULL) {
+		context.UnlockAll();
+
+		for (page_num_t i = 0; i < pageCount; i++)
+			vm_page_free(NULL, &pages[i]);
+		return false;
+	}
+
+	VMCache* cache = context.topCache;
+	off_t cacheOffset = base - area->Base() + area->cache_offset;
+	uint32 protection = get_area_page_protection(area, address);
+
+	// Map the pages individually first, so that they get their page mappings
+	// like any other page. If a mapping can't be allocated, the remaining
+	// pages will be mapped by later faults.
+	bool mapped = true;
+	for (page_num_t i = 0; i < pageCount; i++) {
+		vm_page* page = &pages[i];
+		cache->InsertPage(page, cacheOffset + i * B_PAGE_SIZE);
+
+		if (mapped && map_page(area, page, base + i * B_PAGE_SIZE, protection,
+				&context.reservation) != B_OK) {
+			mapped = false;
+		}
+
+		DEBUG_PAGE_ACCESS_END(page);
+	}
+
+	status_t status = B_ERROR;
+	if (mapped) {
+		context.map->Lock();
+		status = context.map->PromoteLargePage(base);
+		context.map->Unlock();
+	}
+
+	if (status == B_OK)
+		atomic_add64(&sLargePageFaults, 1);
+	else
+		atomic_add64(&sLargePageFallbacks, 1);
+
+	cache->IncrementFaultCount();
+	return true;
+}
+
+
+/*!	Returns the page at \a cacheOffset that a fault in the area of
+	\a topCache would map, if it is resident in one of the caches from
+	\a topCache down to \a bottomCache, and not busy.
+	All of these caches must be locked.
+*/
+static vm_page*
+fault_around_lookup_page(VMCache* topCache, VMCache* bottomCache,
+	off_t cacheOffset)
+{
+	for (VMCache* cache = topCache;; cache = cache->source) {
+		vm_page* page = cache->LookupPage(cacheOffset);
+		if (page != NULL)
+			return page->busy ? NULL : page;
+
+		// If the page is in the store, the fault would have to read it in
+		if (cache == bottomCache || cache->StoreHasPage(cacheOffset))
+			return NULL;
+	}
+}
+
+
+/*!	After a read fault in a file backed or shared area has been resolved by
+	mapping \c context.page at \a address, this maps the neighbouring pages
+	that are already resident and not busy, so that the following accesses
+	don't fault as well. The pages are looked up in the caches from the top
+	cache down to the faulting page's cache only, which are all locked.
+
+	The window is aligned to the area's fault_around_pages, so it doesn't need
+	more pages for the translation map than vm_soft_fault() reserved.
+	Pages that don't live in the top cache are mapped read-only, as usual.
+*/
+static void
+fault_around(PageFaultContext& context, VMArea* area, addr_t address)
+{
+	size_t pageCount = area->fault_around_pages;
+	if (pageCount <= 1 || area->wiring != B_NO_LOCK
+		|| area->address_space == VMAddressSpace::Kernel()
+		|| (area->cache_type != CACHE_TYPE_VNODE
+			&& (area->protection & B_SHARED_AREA) == 0)) {
+		return;
+	}
+
+	const addr_t windowSize = pageCount * B_PAGE_SIZE;
+	addr_t start = std::max(ROUNDDOWN(address, windowSize), area->Base());
+	addr_t end = std::min(ROUNDDOWN(address, windowSize) + (windowSize - 1),
+		area->Base() + (area->Size() - 1));
+
+	VMCache* bottomCache = context.page->Cache();
+
+	for (addr_t pageAddress = start; pageAddress < end;
+			pageAddress += B_PAGE_SIZE) {
+		if (pageAddress == address)
+			continue;
+
+		uint32 protection = get_area_page_protection(area, pageAddress);
+		if ((protection & B_READ_AREA) == 0)
+			continue;
+
+		vm_page* page = fault_around_lookup_page(context.topCache, bottomCache,
+			pageAddress - area->Base() + area->cache_offset);
+		if (page == NULL)
+			continue;
+
+		// Like for the faulting page, the translation map is only locked for
+		// the query; map_page() locks it again itself, but not while it
+		// allocates the mapping object or changes the page's state.
+		phys_addr_t physicalAddress;
+		uint32 flags;
+		context.map->Lock();
+		status_t status = context.map->Query(pageAddress, &physicalAddress,
+			&flags);
+		context.map->Unlock();
+		if (status == B_OK && (flags & PAGE_PRESENT) != 0)
+			continue;
+
+		if (page->Cache() != context.topCache)
+			protection &= ~(B_WRITE_AREA | B_KERNEL_WRITE_AREA);
+
+		DEBUG_PAGE_ACCESS_START(page);
+		status = map_page(area, page, pageAddress, protection,
+			&context.reservation);
+		DEBUG_PAGE_ACCESS_END(page);
+
+		// if we can't get a mapping structure, we just leave it to later faults
+		if (status != B_OK)
+			break;
+	}
+}
+
+
 /*!	Makes sure the address in the given address space is mapped.
 
 	\param addressSpace The address space.
@@ -4443,13 +4920,21 @@ vm_soft_fault(VMAddressSpace* addressSpace, addr_t originalAddress,
 	addr_t address = ROUNDDOWN(originalAddress, B_PAGE_SIZE);
 	status_t status = B_OK;
 
+	// file cache module to be notified about the faulted in file page
+	VMCache* accessedCache = NULL;
+	off_t accessedOffset = 0;
+
 	addressSpace->IncrementFaultCount();
 
 	// We may need up to 2 pages plus pages needed for mapping them -- reserving
 	// the pages upfront makes sure we don't have any cache locked, so that the
-	// page daemon/thief can do their job without problems.
-	size_t reservePages = 2 + context.map->MaxPagesNeededToMap(originalAddress,
-		originalAddress);
+	// page daemon/thief can do their job without problems. The mapping pages
+	// also cover any neighbouring pages fault_around() might map.
+	const addr_t faultAroundSize
+		= VMArea::FAULT_AROUND_MAX_PAGES * B_PAGE_SIZE;
+	addr_t faultAroundBase = ROUNDDOWN(originalAddress, faultAroundSize);
+	size_t reservePages = 2 + context.map->MaxPagesNeededToMap(faultAroundBase,
+		faultAroundBase + (faultAroundSize - 1));
 	context.addressSpaceLocker.Unlock();
 	vm_page_reserve_pages(&context.reservation, reservePages,
 		addressSpace == VMAddressSpace::Kernel()
@@ -4460,11 +4945,28 @@ vm_soft_fault(VMAddressSpace* addressSpace, addr_t originalAddress,
 #else
 	const bool logFaults = !isUser;
 #endif
+
+	// Try to resolve the fault without the address space lock, so that we
+	// don't have to wait for unrelated changes to the address space.
+	bool speculative = wirePage == NULL
+		&& addressSpace != VMAddressSpace::Kernel();
+
 	while (true) {
-		context.addressSpaceLocker.Lock();
+		VMArea* area = NULL;
+		if (speculative) {
+			area = fault_lookup_area_speculatively(context, addressSpace,
+				address);
+			if (area == NULL)
+				speculative = false;
+		}
+
+		if (area == NULL) {
+			context.addressSpaceLocker.Lock();
+
+			// get the area the fault was in
+			area = addressSpace->LookupArea(address);
+		}
 
-		// get the area the fault was in
-		VMArea* area = addressSpace->LookupArea(address);
 		if (area == NULL) {
 			if (logFaults) {
 				dprintf("vm_soft_fault: va 0x%lx not covered by area in address "
@@ -4525,8 +5027,10 @@ vm_soft_fault(VMAddressSpace* addressSpace, addr_t originalAddress,
 		// page fault now.
 		// At first, the top most cache from the area is investigated.
 
-		context.Prepare(vm_area_get_locked_cache(area),
-			address - area->Base() + area->cache_offset);
+		if (!context.speculative) {
+			context.Prepare(vm_area_get_locked_cache(area),
+				address - area->Base() + area->cache_offset);
+		}
 
 		// See if this cache has a fault handler -- this will do all the work
 		// for us.
@@ -4539,6 +5043,21 @@ vm_soft_fault(VMAddressSpace* addressSpace, addr_t originalAddress,
 				break;
 		}
 
+		// For suitable anonymous memory, populate and map a complete large
+		// page at once.
+		addr_t largePageBase;
+		if (wirePage == NULL
+			&& large_page_fault_possible(area, context.topCache, address,
+				largePageBase)) {
+			if (fault_large_page(context, addressSpace, address,
+					largePageBase)) {
+				status = B_OK;
+				break;
+			}
+
+			continue;
+		}
+
 		// The top most cache has no fault handler, so let's see if the cache or
 		// its sources already have the page we're searching for (we're going
 		// from top to bottom).
@@ -4670,10 +5189,27 @@ vm_soft_fault(VMAddressSpace* addressSpace, addr_t originalAddress,
 
 		context.page->Cache()->IncrementFaultCount();
 
+		if (mapPage && !isWrite && wirePage == NULL)
+			fault_around(context, area, address);
+
+		if (isUser && context.page->Cache()->type == CACHE_TYPE_VNODE
+			&& cache_tracks_node_accesses()) {
+			accessedCache = context.page->Cache();
+			accessedCache->AcquireRefLocked();
+			accessedOffset = (off_t)context.page->cache_offset << PAGE_SHIFT;
+		}
+
 		DEBUG_PAGE_ACCESS_END(context.page);
 		break;
 	}
 
+	if (accessedCache != NULL) {
+		// the module must be called without any VM locks held
+		context.UnlockAll();
+		cache_node_accessed(accessedCache, accessedOffset, B_PAGE_SIZE);
+		accessedCache->ReleaseRef();
+	}
+
 	return status;
 }
 
@@ -6305,6 +6841,8 @@ _user_unmap_memory(void* _address, size_t size)
 	} while (wait_if_address_range_is_wired(locker.AddressSpace(), address,
 			size, &locker));
 
+	limit_address_space_write_range(locker.AddressSpace(), address, size);
+
 	// unmap
 	return unmap_address_range(locker.AddressSpace(), address, size, false);
 }
@@ -6571,6 +7109,76 @@ _user_sync_memory(void* _address, size_t size, uint32 flags)
 }
 
 
+/*!	Passes the file access \a advice (a POSIX_FADV_* value) on to the files
+	mapped in the given range of the current team's address space.
+*/
+static status_t
+advise_mapped_files(addr_t address, size_t size, int advice)
+{
+	addr_t end = address + size;
+
+	while (address < end) {
+		AddressSpaceReadLocker locker;
+		status_t status = locker.SetTo(team_get_current_team_id());
+		if (status != B_OK)
+			return status;
+
+		VMArea* area = locker.AddressSpace()->GetAreaRangeIterator(address,
+			end - address).Next();
+		if (area == NULL)
+			break;
+
+		addr_t rangeStart = std::max(address, area->Base());
+		addr_t rangeEnd = std::min(end, area->Base() + area->Size());
+		off_t offset = area->cache_offset + (rangeStart - area->Base());
+
+		// The file is at the bottom of the cache chain (private mappings have
+		// an anonymous cache on top of it).
+		VMCacheChainLocker cacheChainLocker(vm_area_get_locked_cache(area));
+		cacheChainLocker.LockAllSourceCaches();
+
+		VMCache* cache = area->cache;
+		while (cache->source != NULL)
+			cache = cache->source;
+
+		if (cache->type == CACHE_TYPE_VNODE) {
+			cache->AcquireRefLocked();
+			cacheChainLocker.Unlock();
+			locker.Unlock();
+
+			cache_advise(cache, offset, rangeEnd - rangeStart, advice);
+			cache->ReleaseRef();
+		}
+
+		address = rangeEnd;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Sets how many pages around a faulting page are mapped for all areas
+	intersecting the given range. This only affects future page faults.
+*/
+static status_t
+set_fault_around_pages(addr_t address, size_t size, uint8 pages)
+{
+	AddressSpaceWriteLocker locker;
+	status_t status = locker.SetTo(team_get_current_team_id());
+	if (status != B_OK)
+		return status;
+
+	VMAddressSpace* addressSpace = locker.AddressSpace();
+	for (VMAddressSpace::AreaRangeIterator it
+			= addressSpace->GetAreaRangeIterator(address, size);
+			VMArea* area = it.Next();) {
+		area->fault_around_pages = pages;
+	}
+
+	return B_OK;
+}
+
+
 status_t
 _user_memory_advice(void* _address, size_t size, uint32 advice)
 {
@@ -6588,10 +7196,53 @@ _user_memory_advice(void* _address, size_t size, uint32 advice)
 		case MADV_NORMAL:
 		case MADV_SEQUENTIAL:
 		case MADV_RANDOM:
+		{
+			// The access pattern determines both, how many neighbouring pages
+			// a fault maps, and how far the file cache reads ahead.
+			uint8 faultAroundPages = VMArea::FAULT_AROUND_DEFAULT_PAGES;
+			int fileAdvice = POSIX_FADV_NORMAL;
+			if (advice == MADV_SEQUENTIAL) {
+				faultAroundPages = VMArea::FAULT_AROUND_MAX_PAGES;
+				fileAdvice = POSIX_FADV_SEQUENTIAL;
+			} else if (advice == MADV_RANDOM) {
+				faultAroundPages = 0;
+				fileAdvice = POSIX_FADV_RANDOM;
+			}
+
+			status_t status = set_fault_around_pages(address, size,
+				faultAroundPages);
+			if (status != B_OK)
+				return status;
+
+			return advise_mapped_files(address, size, fileAdvice);
+		}
 		case MADV_WILLNEED:
+			return advise_mapped_files(address, size, POSIX_FADV_WILLNEED);
+
 		case MADV_DONTNEED:
-			// TODO: Implement!
+			// TODO: Implement! Unlike POSIX_FADV_DONTNEED, this would have to
+			// unmap the pages of the range, too.
+			break;
+
+		case MADV_HUGEPAGE:
+		case MADV_NOHUGEPAGE:
+		{
+			AddressSpaceWriteLocker locker;
+			status_t status = locker.SetTo(team_get_current_team_id());
+			if (status != B_OK)
+				return status;
+
+			// The advice applies to all areas intersecting the range, and only
+			// affects future page faults.
+			VMAddressSpace* addressSpace = locker.AddressSpace();
+			for (VMAddressSpace::AreaRangeIterator it
+					= addressSpace->GetAreaRangeIterator(address, size);
+					VMArea* area = it.Next();) {
+				area->large_pages = advice == MADV_HUGEPAGE
+					? VMArea::LARGE_PAGES_ALWAYS : VMArea::LARGE_PAGES_NEVER;
+			}
 			break;
+		}
 
 		case MADV_FREE:
 		{
@@ -6737,6 +7388,25 @@ _user_munlock(const void* _address, size_t size)
 }
 
 
+status_t
+_user_get_large_page_stats(vm_large_page_stats* userStats)
+{
+	if (userStats == NULL || !IS_USER_ADDRESS(userStats))
+		return B_BAD_ADDRESS;
+
+	vm_large_page_stats stats;
+	stats.page_size
+		= VMAddressSpace::Kernel()->TranslationMap()->LargePageSize();
+	stats.mapped = atomic_get(&gMappedLargePagesCount);
+	stats.faults = atomic_get64(&sLargePageFaults);
+	stats.fallbacks = atomic_get64(&sLargePageFallbacks);
+	stats.promotions = atomic_get64(&gLargePagePromotions);
+	stats.demotions = atomic_get64(&gLargePageDemotions);
+
+	return user_memcpy(userStats, &stats, sizeof(stats));
+}
+
+
 // #pragma mark -- compatibility
 
 
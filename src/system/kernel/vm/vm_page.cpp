@@ -27,6 +27,7 @@
 #include <heap.h>
 #include <kernel.h>
 #include <low_resource_manager.h>
+#include <smp.h>
 #include <thread.h>
 #include <tracing.h>
 #include <util/AutoLock.h>
@@ -133,6 +134,40 @@ static mutex sPageDeficitLock = MUTEX_INITIALIZER("page deficit");
 static rw_lock sFreePageQueuesLock
 	= RW_LOCK_INITIALIZER("free/clear page queues");
 
+// Per-CPU page caches. The common page allocation and free paths only touch
+// the current CPU's cache, which exchanges pages with the free/clear queues in
+// batches. Pages in a cache keep their free/clear state, are flagged
+// cpu_cached, and remain accounted for in sUnreservedFreePages (respectively
+// by the reservation they are allocated for). Each cache furthermore holds
+// some reservation credit, i.e. pages already taken from sUnreservedFreePages,
+// that small reservations can be satisfied from.
+// A cache is only ever touched by its own CPU with interrupts disabled, so it
+// doesn't need a lock. Other CPUs empty it by sending an ICI. Exchanging pages
+// with the queues requires holding sFreePageQueuesLock (a read lock suffices).
+// Code that relies on all free and clear pages being in the queues blocks the
+// caches while it holds the write lock (cf. page_cpu_caches_block()); the
+// common paths then bypass them.
+struct page_cpu_cache {
+	VMPageQueue::PageList	freePages;
+	VMPageQueue::PageList	clearPages;
+	int32					freeCount;
+	int32					clearCount;
+	int32					reserved;
+	uint32					hits;
+	uint32					misses;
+} CACHE_LINE_ALIGN;
+
+// number of pages moved between a cache and the queues at once
+static const int32 kPageCPUCacheBatch = 32;
+// maximum number of pages a cache may hold
+static const int32 kPageCPUCacheMaxPages = 4 * kPageCPUCacheBatch;
+// maximum reservation credit a cache may hold
+static const int32 kPageCPUCacheMaxReserved = 2 * kPageCPUCacheBatch;
+
+static page_cpu_cache sPageCPUCaches[SMP_MAX_CPUS];
+static bool sPageCPUCachesEnabled = false;
+static int32 sPageCPUCachesBlocked = 0;
+
 #ifdef TRACK_PAGE_USAGE_STATS
 static page_num_t sPageUsageArrays[512];
 static page_num_t* sPageUsage = sPageUsageArrays;
@@ -987,6 +1022,7 @@ dump_page_long(int argc, char **argv)
 	kprintf("usage_count:     %d\n", page->usage_count);
 	kprintf("busy:            %d\n", page->busy);
 	kprintf("busy_writing:    %d\n", page->busy_writing);
+	kprintf("cpu_cached:      %d\n", page->cpu_cached);
 	kprintf("accessed:        %d\n", page->accessed);
 	kprintf("modified:        %d\n", page->modified);
 #if DEBUG_PAGE_QUEUE
@@ -1216,6 +1252,17 @@ dump_page_stats(int argc, char **argv)
 		&sInactivePageQueue, sInactivePageQueue.Count());
 	kprintf("cached queue: %p, count = %" B_PRIuPHYSADDR "\n",
 		&sCachedPageQueue, sCachedPageQueue.Count());
+
+	if (sPageCPUCachesEnabled) {
+		kprintf("\nCPU page caches:\n");
+		for (int32 i = 0; i < smp_get_num_cpus(); i++) {
+			page_cpu_cache& cache = sPageCPUCaches[i];
+			kprintf("  %3" B_PRId32 ": free: %4" B_PRId32 ", clear: %4" B_PRId32
+				", reserved: %4" B_PRId32 ", hits: %10" B_PRIu32 ", misses: %10"
+				B_PRIu32 "\n", i, cache.freeCount, cache.clearCount,
+				cache.reserved, cache.hits, cache.misses);
+		}
+	}
 	return 0;
 }
 
@@ -1468,10 +1515,28 @@ vm_page::SetState(uint8 newState)
 // #pragma mark -
 
 
+/*!	Returns the number of free pages that are not reserved, including the
+	CPU caches' reservation credit. The caches aren't locked, so the value
+	might be slightly off.
+*/
+static int32
+unreserved_free_pages()
+{
+	int32 count = atomic_get(&sUnreservedFreePages);
+	if (sPageCPUCachesEnabled) {
+		int32 cpuCount = smp_get_num_cpus();
+		for (int32 i = 0; i < cpuCount; i++)
+			count += sPageCPUCaches[i].reserved;
+	}
+
+	return count;
+}
+
+
 static void
 get_page_stats(page_stats& _pageStats)
 {
-	_pageStats.totalFreePages = sUnreservedFreePages;
+	_pageStats.totalFreePages = unreserved_free_pages();
 	_pageStats.cachedPages = sCachedPageQueue.Count();
 	_pageStats.unsatisfiedReservations = sUnsatisfiedPageReservations;
 	// TODO: We don't get an actual snapshot here!
@@ -1512,6 +1577,337 @@ reserve_some_pages(uint32 count, uint32 dontTouch)
 }
 
 
+/*!	Returns the current CPU's page cache.
+	Interrupts must be disabled.
+*/
+static inline page_cpu_cache&
+current_page_cpu_cache()
+{
+	return sPageCPUCaches[smp_get_current_cpu()];
+}
+
+
+/*!	Moves pages of the given cache to the free/clear queues until at most
+	\a keep pages remain. Free pages are returned before clear pages, and the
+	least recently cached pages first.
+	Must be called on the cache's CPU with interrupts disabled, and the caller
+	must hold \c sFreePageQueuesLock.
+	\return Whether any pages were returned to the free queue.
+*/
+static bool
+page_cpu_cache_flush(page_cpu_cache& cache, int32 keep)
+{
+	bool freedPages = false;
+
+	while (cache.freeCount + cache.clearCount > keep) {
+		vm_page* page;
+		if (cache.freeCount > 0) {
+			page = cache.freePages.RemoveTail();
+			cache.freeCount--;
+			page->cpu_cached = false;
+			sFreePageQueue.PrependUnlocked(page);
+			freedPages = true;
+		} else {
+			page = cache.clearPages.RemoveTail();
+			cache.clearCount--;
+			page->cpu_cached = false;
+			sClearPageQueue.PrependUnlocked(page);
+		}
+	}
+
+	return freedPages;
+}
+
+
+/*!	Moves up to \a count pages from the free/clear queues into the given
+	cache, preferring clear pages, if \a clear is \c true.
+	Must be called on the cache's CPU with interrupts disabled, and the caller
+	must hold \c sFreePageQueuesLock.
+*/
+static void
+page_cpu_cache_refill(page_cpu_cache& cache, bool clear, int32 count)
+{
+	VMPageQueue& queue = clear ? sClearPageQueue : sFreePageQueue;
+	VMPageQueue& otherQueue = clear ? sFreePageQueue : sClearPageQueue;
+
+	for (int32 i = 0; i < count; i++) {
+		vm_page* page = queue.RemoveHeadUnlocked();
+		if (page == NULL) {
+			page = otherQueue.RemoveHeadUnlocked();
+			if (page == NULL)
+				break;
+		}
+
+		page->cpu_cached = true;
+		if (page->State() == PAGE_STATE_CLEAR) {
+			cache.clearPages.Add(page);
+			cache.clearCount++;
+		} else {
+			cache.freePages.Add(page);
+			cache.freeCount++;
+		}
+	}
+}
+
+
+/*!	Takes a page out of the given cache and sets its state according to
+	\a flags, as vm_page_allocate_page() does. The page's previous state is
+	returned in \a _oldState.
+	Must be called on the cache's CPU with interrupts disabled.
+	\return The page, or \c NULL, if the cache is empty.
+*/
+static vm_page*
+page_cpu_cache_take(page_cpu_cache& cache, uint32 flags, int& _oldState)
+{
+	bool clear = (flags & VM_PAGE_ALLOC_CLEAR) != 0;
+
+	vm_page* page = NULL;
+	if (clear && cache.clearCount > 0) {
+		page = cache.clearPages.RemoveHead();
+		cache.clearCount--;
+	} else if (cache.freeCount > 0) {
+		page = cache.freePages.RemoveHead();
+		cache.freeCount--;
+	} else if (cache.clearCount > 0) {
+		page = cache.clearPages.RemoveHead();
+		cache.clearCount--;
+	} else
+		return NULL;
+
+	DEBUG_PAGE_ACCESS_START(page);
+
+	_oldState = page->State();
+	page->SetState(flags & VM_PAGE_ALLOC_STATE);
+	page->busy = (flags & VM_PAGE_ALLOC_BUSY) != 0;
+	page->usage_count = 0;
+	page->accessed = false;
+	page->modified = false;
+	page->cpu_cached = false;
+
+	return page;
+}
+
+
+/*!	Allocates a page from the current CPU's cache, refilling the cache from
+	the free/clear queues, if necessary.
+	\return The page, or \c NULL, if the caches are blocked or neither the
+		cache nor the queues have any pages left.
+*/
+static vm_page*
+page_cpu_cache_allocate(uint32 flags, int& _oldState)
+{
+	{
+		InterruptsLocker interruptsLocker;
+		if (atomic_get(&sPageCPUCachesBlocked) != 0)
+			return NULL;
+
+		page_cpu_cache& cache = current_page_cpu_cache();
+		vm_page* page = page_cpu_cache_take(cache, flags, _oldState);
+		if (page != NULL) {
+			cache.hits++;
+			return page;
+		}
+	}
+
+	// The cache is empty -- refill it. When free pages are getting scarce,
+	// only get what we need, so that the pages don't end up being scattered
+	// over the CPU caches.
+	int32 count = atomic_get(&sUnreservedFreePages) > (int32)sFreePagesTarget
+		? kPageCPUCacheBatch : 1;
+
+	ReadLocker queuesLocker(sFreePageQueuesLock);
+	InterruptsLocker interruptsLocker;
+	if (atomic_get(&sPageCPUCachesBlocked) != 0)
+		return NULL;
+
+	page_cpu_cache& cache = current_page_cpu_cache();
+	cache.misses++;
+	page_cpu_cache_refill(cache, (flags & VM_PAGE_ALLOC_CLEAR) != 0, count);
+	return page_cpu_cache_take(cache, flags, _oldState);
+}
+
+
+/*!	Puts a page that is to be freed into the current CPU's cache. If the
+	cache overflows, a batch of pages is returned to the free/clear queues.
+	The page must not be in any queue anymore.
+	\return \c false, if the caches are blocked and the page has to be put
+		into a queue by the caller.
+*/
+static bool
+page_cpu_cache_free(vm_page* page, bool clear)
+{
+	{
+		InterruptsLocker interruptsLocker;
+		if (atomic_get(&sPageCPUCachesBlocked) != 0)
+			return false;
+
+		page_cpu_cache& cache = current_page_cpu_cache();
+
+		DEBUG_PAGE_ACCESS_END(page);
+
+		page->cpu_cached = true;
+		if (clear) {
+			page->SetState(PAGE_STATE_CLEAR);
+			cache.clearPages.Add(page, false);
+			cache.clearCount++;
+		} else {
+			page->SetState(PAGE_STATE_FREE);
+			cache.freePages.Add(page, false);
+			cache.freeCount++;
+		}
+
+		if (cache.freeCount + cache.clearCount <= kPageCPUCacheMaxPages)
+			return true;
+	}
+
+	bool freedPages;
+	{
+		ReadLocker queuesLocker(sFreePageQueuesLock);
+		InterruptsLocker interruptsLocker;
+		freedPages = page_cpu_cache_flush(current_page_cpu_cache(),
+			kPageCPUCacheMaxPages - kPageCPUCacheBatch);
+	}
+
+	if (freedPages)
+		sFreePageCondition.NotifyAll();
+
+	return true;
+}
+
+
+static void
+page_cpu_cache_drain_ici(void* _freedPages, int cpu)
+{
+	if (page_cpu_cache_flush(sPageCPUCaches[cpu], 0))
+		atomic_set((int32*)_freedPages, 1);
+}
+
+
+/*!	Moves the pages of all CPU caches to the free/clear queues. Every CPU
+	empties its own cache in an ICI.
+	The caller must hold \c sFreePageQueuesLock.
+*/
+static void
+page_cpu_caches_drain()
+{
+	if (!sPageCPUCachesEnabled)
+		return;
+
+	int32 freedPages = 0;
+	call_all_cpus_sync(&page_cpu_cache_drain_ici, &freedPages);
+
+	if (freedPages != 0)
+		sFreePageCondition.NotifyAll();
+}
+
+
+/*!	Drains the CPU caches and keeps pages from being put into them again
+	until page_cpu_caches_unblock() is called. Needed by code that scans
+	the pages array and expects all free and clear pages to be in the
+	queues.
+	The caller must hold the write lock of \c sFreePageQueuesLock.
+*/
+static void
+page_cpu_caches_block()
+{
+	if (!sPageCPUCachesEnabled)
+		return;
+
+	// Once the ICI has run on a CPU, it will see the flag on its next cache
+	// operation.
+	atomic_add(&sPageCPUCachesBlocked, 1);
+	page_cpu_caches_drain();
+}
+
+
+static void
+page_cpu_caches_unblock()
+{
+	if (sPageCPUCachesEnabled)
+		atomic_add(&sPageCPUCachesBlocked, -1);
+}
+
+
+/*!	Tries to satisfy a reservation of \a count pages from the current CPU's
+	reservation credit. The credit is only replenished while there are
+	plenty of free pages, hence it can be used for any priority.
+	\return \c true, if the pages have been reserved.
+*/
+static bool
+page_cpu_cache_reserve(uint32 count)
+{
+	if (count > (uint32)kPageCPUCacheMaxReserved)
+		return false;
+
+	InterruptsLocker interruptsLocker;
+	page_cpu_cache& cache = current_page_cpu_cache();
+
+	if (cache.reserved < (int32)count) {
+		if (atomic_get(&sUnsatisfiedPageReservations) != 0)
+			return false;
+
+		cache.reserved += reserve_some_pages(
+			count - cache.reserved + kPageCPUCacheBatch,
+			kPageReserveForPriority[VM_PRIORITY_USER] + sFreePagesTarget);
+		if (cache.reserved < (int32)count)
+			return false;
+	}
+
+	cache.reserved -= count;
+	return true;
+}
+
+
+/*!	Adds \a count unreserved pages to the current CPU's reservation credit.
+	\return The number of pages that didn't fit and have to be returned to
+		\c sUnreservedFreePages by the caller.
+*/
+static uint32
+page_cpu_cache_unreserve(uint32 count)
+{
+	InterruptsLocker interruptsLocker;
+	page_cpu_cache& cache = current_page_cpu_cache();
+
+	int32 reserved = cache.reserved + (int32)count;
+	if (reserved <= kPageCPUCacheMaxReserved) {
+		cache.reserved = reserved;
+		return 0;
+	}
+
+	cache.reserved = kPageCPUCacheBatch;
+	return reserved - kPageCPUCacheBatch;
+}
+
+
+static void
+page_cpu_cache_return_reserved_ici(void* _returned, int cpu)
+{
+	page_cpu_cache& cache = sPageCPUCaches[cpu];
+	atomic_add((int32*)_returned, cache.reserved);
+	cache.reserved = 0;
+}
+
+
+/*!	Returns the reservation credit of all CPU caches to
+	\c sUnreservedFreePages. Every CPU returns its own credit in an ICI.
+	\return The number of pages returned.
+*/
+static int32
+page_cpu_caches_return_reserved()
+{
+	if (!sPageCPUCachesEnabled)
+		return 0;
+
+	int32 returned = 0;
+	call_all_cpus_sync(&page_cpu_cache_return_reserved_ici, &returned);
+
+	if (returned > 0)
+		atomic_add(&sUnreservedFreePages, returned);
+
+	return returned;
+}
+
+
 static void
 wake_up_page_reservation_waiters()
 {
@@ -1543,6 +1939,13 @@ wake_up_page_reservation_waiters()
 static inline void
 unreserve_pages(uint32 count)
 {
+	if (sPageCPUCachesEnabled
+		&& atomic_get(&sUnsatisfiedPageReservations) == 0) {
+		count = page_cpu_cache_unreserve(count);
+		if (count == 0)
+			return;
+	}
+
 	atomic_add(&sUnreservedFreePages, count);
 	if (atomic_get(&sUnsatisfiedPageReservations) != 0) {
 		MutexLocker pageDeficitLocker(sPageDeficitLock);
@@ -1601,6 +2004,9 @@ free_page(vm_page* page, bool clear)
 	page->allocation_tracking_info.Clear();
 #endif
 
+	if (sPageCPUCachesEnabled && page_cpu_cache_free(page, clear))
+		return;
+
 	ReadLocker locker(sFreePageQueuesLock);
 
 	DEBUG_PAGE_ACCESS_END(page);
@@ -1690,11 +2096,18 @@ set_page_state(vm_page *page, int pageState)
 	}
 
 	VMCache* cache = page->Cache();
-	if (cache != NULL && cache->temporary) {
+	if (cache != NULL
+		&& (pageState == PAGE_STATE_MODIFIED
+			|| page->State() == PAGE_STATE_MODIFIED)) {
+		if (cache->temporary) {
+			atomic_add(&sModifiedTemporaryPages,
+				pageState == PAGE_STATE_MODIFIED ? 1 : -1);
+		}
+
 		if (pageState == PAGE_STATE_MODIFIED)
-			atomic_add(&sModifiedTemporaryPages, 1);
-		else if (page->State() == PAGE_STATE_MODIFIED)
-			atomic_add(&sModifiedTemporaryPages, -1);
+			cache->pages.SetTag(page, VM_CACHE_PAGE_TAG_MODIFIED);
+		else
+			cache->pages.ClearTag(page, VM_CACHE_PAGE_TAG_MODIFIED);
 	}
 
 	// move the page
@@ -1777,6 +2190,7 @@ mark_page_range_in_use(page_num_t startPage, page_num_t length, bool wired)
 	}
 
 	WriteLocker locker(sFreePageQueuesLock);
+	page_cpu_caches_block();
 
 	for (page_num_t i = 0; i < length; i++) {
 		vm_page *page = &sPages[startPage + i];
@@ -1814,6 +2228,7 @@ mark_page_range_in_use(page_num_t startPage, page_num_t length, bool wired)
 		}
 	}
 
+	page_cpu_caches_unblock();
 	return B_OK;
 }
 
@@ -2509,8 +2924,9 @@ page_writer(void* /*unused*/)
 			// Write adjacent pages at the same time, if they're also modified.
 			if (cache->temporary)
 				continue;
-			while (page->cache_next != NULL && numPages < kNumPages) {
-				page = page->cache_next;
+			VMCachePagesTree::Iterator it = cache->pages.GetIterator(
+				page->cache_offset, true, false);
+			while (numPages < kNumPages && (page = it.Next()) != NULL) {
 				if (page->busy || page->State() != PAGE_STATE_MODIFIED)
 					break;
 				if (page->WiredCount() > 0)
@@ -3044,6 +3460,18 @@ page_daemon_full_scan(page_stats& pageStats, int32 despairLevel)
 	// queues.
 	full_scan_inactive_pages(pageStats, despairLevel);
 
+	// Return what the CPU caches hold back, so that it is available for
+	// reservation waiters and contiguous allocations.
+	if (page_cpu_caches_return_reserved() > 0
+		&& atomic_get(&sUnsatisfiedPageReservations) != 0) {
+		MutexLocker pageDeficitLocker(sPageDeficitLock);
+		wake_up_page_reservation_waiters();
+	}
+	{
+		ReadLocker locker(sFreePageQueuesLock);
+		page_cpu_caches_drain();
+	}
+
 	// Free cached pages. Also wake up reservation waiters.
 	get_page_stats(pageStats);
 	int32 pagesToFree = pageStats.unsatisfiedReservations + sFreePagesTarget
@@ -3105,12 +3533,20 @@ reserve_pages(uint32 missing, int priority, bool dontWait)
 {
 	const uint32 requested = missing;
 	const int32 dontTouch = kPageReserveForPriority[priority];
+	bool creditReturned = false;
 
 	while (true) {
 		missing -= reserve_some_pages(missing, dontTouch);
 		if (missing == 0)
 			return 0;
 
+		if (!creditReturned) {
+			// The CPU caches might hold back some reservation credit.
+			creditReturned = true;
+			if (page_cpu_caches_return_reserved() > 0)
+				continue;
+		}
+
 		if (sUnsatisfiedPageReservations == 0) {
 			missing -= free_cached_pages(missing, dontWait);
 			if (missing == 0)
@@ -3123,6 +3559,7 @@ reserve_pages(uint32 missing, int priority, bool dontWait)
 		// we need to wait for pages to become available
 
 		MutexLocker pageDeficitLocker(sPageDeficitLock);
+		page_cpu_caches_return_reserved();
 		if (atomic_get(&sUnreservedFreePages) > dontTouch) {
 			// the situation changed
 			pageDeficitLocker.Unlock();
@@ -3230,8 +3667,14 @@ vm_page_write_modified_page_range(struct VMCache* cache, uint32 firstPage,
 	PageWriteTransfer transfer;
 	bool transferEmpty = true;
 
-	VMCachePagesTree::Iterator it
-		= cache->pages.GetIterator(firstPage, true, true);
+	// Unless the file is mapped, only the pages in the modified state can
+	// have been changed, and the page tree can directly lead us to them.
+	VMCachePagesTree::Iterator it;
+	if (cache->type == CACHE_TYPE_VNODE && cache->areas.IsEmpty()) {
+		it = cache->pages.GetTaggedIterator(VM_CACHE_PAGE_TAG_MODIFIED,
+			firstPage);
+	} else
+		it = cache->pages.GetIterator(firstPage, true, true);
 
 	while (true) {
 		vm_page* page = it.Next();
@@ -3336,8 +3779,8 @@ vm_page_schedule_write_page_range(struct VMCache *cache, uint32 firstPage,
 	uint32 endPage)
 {
 	uint32 modified = 0;
-	for (VMCachePagesTree::Iterator it
-				= cache->pages.GetIterator(firstPage, true, true);
+	for (VMCachePagesTree::Iterator it = cache->pages.GetTaggedIterator(
+				VM_CACHE_PAGE_TAG_MODIFIED, firstPage);
 			vm_page *page = it.Next();) {
 		if (page->cache_offset >= endPage)
 			break;
@@ -3564,6 +4007,14 @@ vm_page_init_post_thread(kernel_args *args)
 		B_NORMAL_PRIORITY + 1, NULL);
 	resume_thread(thread);
 
+	// Enable the per-CPU page caches, unless they could hold back a
+	// significant share of the memory.
+	if ((page_num_t)smp_get_num_cpus()
+			* (kPageCPUCacheMaxPages + kPageCPUCacheMaxReserved) * 32
+			<= vm_page_num_pages()) {
+		sPageCPUCachesEnabled = true;
+	}
+
 	// start page daemon
 
 	sPageDaemonCondition.Init("page daemon");
@@ -3624,6 +4075,9 @@ vm_page_reserve_pages(vm_page_reservation* reservation, uint32 count,
 
 	TA(ReservePages(count));
 
+	if (sPageCPUCachesEnabled && page_cpu_cache_reserve(count))
+		return;
+
 	reserve_pages(count, priority, false);
 }
 
@@ -3637,6 +4091,12 @@ vm_page_try_reserve_pages(vm_page_reservation* reservation, uint32 count,
 		return true;
 	}
 
+	if (sPageCPUCachesEnabled && page_cpu_cache_reserve(count)) {
+		TA(ReservePages(count));
+		reservation->count = count;
+		return true;
+	}
+
 	uint32 remaining = reserve_pages(count, priority, true);
 	if (remaining == 0) {
 		TA(ReservePages(count));
@@ -3650,16 +4110,13 @@ vm_page_try_reserve_pages(vm_page_reservation* reservation, uint32 count,
 }
 
 
-vm_page *
-vm_page_allocate_page(vm_page_reservation* reservation, uint32 flags)
+/*!	Allocates a page directly from the free/clear queues, as
+	vm_page_allocate_page() does when the CPU caches are disabled or run dry.
+	The page's previous state is returned in \a _oldState.
+*/
+static vm_page*
+allocate_page_from_queues(uint32 flags, int& _oldState)
 {
-	uint32 pageState = flags & VM_PAGE_ALLOC_STATE;
-	ASSERT(pageState != PAGE_STATE_FREE);
-	ASSERT(pageState != PAGE_STATE_CLEAR);
-
-	ASSERT(reservation->count > 0);
-	reservation->count--;
-
 	VMPageQueue* queue;
 	VMPageQueue* otherQueue;
 
@@ -3681,14 +4138,17 @@ vm_page_allocate_page(vm_page_reservation* reservation, uint32 flags)
 
 		if (page == NULL) {
 			// Unlikely, but possible: the page we have reserved has moved
-			// between the queues after we checked the first queue. Grab the
-			// write locker to make sure this doesn't happen again.
+			// between the queues after we checked the first queue, or it is
+			// sitting in another CPU's cache. Grab the write locker to make
+			// sure this doesn't happen again.
 			locker.Unlock();
 			WriteLocker writeLocker(sFreePageQueuesLock);
 
+			page_cpu_caches_drain();
+
 			page = queue->RemoveHead();
 			if (page == NULL)
-				otherQueue->RemoveHead();
+				page = otherQueue->RemoveHead();
 
 			if (page == NULL) {
 				panic("Had reserved page, but there is none!");
@@ -3705,14 +4165,37 @@ vm_page_allocate_page(vm_page_reservation* reservation, uint32 flags)
 
 	DEBUG_PAGE_ACCESS_START(page);
 
-	int oldPageState = page->State();
-	page->SetState(pageState);
+	_oldState = page->State();
+	page->SetState(flags & VM_PAGE_ALLOC_STATE);
 	page->busy = (flags & VM_PAGE_ALLOC_BUSY) != 0;
 	page->usage_count = 0;
 	page->accessed = false;
 	page->modified = false;
 
-	locker.Unlock();
+	return page;
+}
+
+
+vm_page *
+vm_page_allocate_page(vm_page_reservation* reservation, uint32 flags)
+{
+	uint32 pageState = flags & VM_PAGE_ALLOC_STATE;
+	ASSERT(pageState != PAGE_STATE_FREE);
+	ASSERT(pageState != PAGE_STATE_CLEAR);
+
+	ASSERT(reservation->count > 0);
+	reservation->count--;
+
+	vm_page* page = NULL;
+	int oldPageState;
+	if (sPageCPUCachesEnabled)
+		page = page_cpu_cache_allocate(flags, oldPageState);
+
+	if (page == NULL) {
+		page = allocate_page_from_queues(flags, oldPageState);
+		if (page == NULL)
+			return NULL;
+	}
 
 	if (pageState < PAGE_STATE_FIRST_UNQUEUED)
 		sPageQueues[pageState].AppendUnlocked(page);
@@ -3796,6 +4279,12 @@ allocate_page_run(page_num_t start, page_num_t length, uint32 flags,
 		bool pageAllocated = true;
 		bool noPage = false;
 		vm_page& page = sPages[start + i];
+		if (page.cpu_cached) {
+			// The page is in a CPU cache that our caller hasn't blocked, we
+			// cannot take it out of a queue.
+			break;
+		}
+
 		switch (page.State()) {
 			case PAGE_STATE_CLEAR:
 				DEBUG_PAGE_ACCESS_START(&page);
@@ -3925,8 +4414,9 @@ allocate_page_run(page_num_t start, page_num_t length, uint32 flags,
 
 	\param flags Page allocation flags. Encodes the state the function shall
 		set the allocated pages to, whether the pages shall be marked busy
-		(VM_PAGE_ALLOC_BUSY), and whether the pages shall be cleared
-		(VM_PAGE_ALLOC_CLEAR).
+		(VM_PAGE_ALLOC_BUSY), whether the pages shall be cleared
+		(VM_PAGE_ALLOC_CLEAR), and whether the function shall fail instead of
+		waiting for enough pages to become available (VM_PAGE_ALLOC_DONT_WAIT).
 	\param length The number of contiguous pages to allocate.
 	\param restrictions Restrictions to the physical addresses of the page run
 		to allocate, including \c low_address, the first acceptable physical
@@ -3979,10 +4469,18 @@ vm_page_allocate_page_run(uint32 flags, page_num_t length,
 	}
 
 	vm_page_reservation reservation;
-	vm_page_reserve_pages(&reservation, length, priority);
+	if ((flags & VM_PAGE_ALLOC_DONT_WAIT) != 0) {
+		if (!vm_page_try_reserve_pages(&reservation, length, priority))
+			return NULL;
+	} else
+		vm_page_reserve_pages(&reservation, length, priority);
 
 	WriteLocker freeClearQueueLocker(sFreePageQueuesLock);
 
+	// Make the pages of the CPU caches available for the run, and keep
+	// freed pages from going into the caches while we look for it.
+	page_cpu_caches_block();
+
 	// First we try to get a run with free pages only. If that fails, we also
 	// consider cached pages. If there are only few free pages and many cached
 	// ones, the odds are that we won't find enough contiguous ones, so we skip
@@ -4016,12 +4514,16 @@ vm_page_allocate_page_run(uint32 flags, page_num_t length,
 				continue;
 			}
 
-			dprintf("vm_page_allocate_page_run(): Failed to allocate run of "
-				"length %" B_PRIuPHYSADDR " (%" B_PRIuPHYSADDR " %"
-				B_PRIuPHYSADDR ") in second iteration (align: %" B_PRIuPHYSADDR
-				" boundary: %" B_PRIuPHYSADDR ")!\n", length, requestedStart,
-				end, restrictions->alignment, restrictions->boundary);
+			if ((flags & VM_PAGE_ALLOC_DONT_WAIT) == 0) {
+				dprintf("vm_page_allocate_page_run(): Failed to allocate run "
+					"of length %" B_PRIuPHYSADDR " (%" B_PRIuPHYSADDR " %"
+					B_PRIuPHYSADDR ") in second iteration (align: %"
+					B_PRIuPHYSADDR " boundary: %" B_PRIuPHYSADDR ")!\n",
+					length, requestedStart, end, restrictions->alignment,
+					restrictions->boundary);
+			}
 
+			page_cpu_caches_unblock();
 			freeClearQueueLocker.Unlock();
 			vm_page_unreserve_pages(&reservation);
 			return NULL;
@@ -4030,10 +4532,12 @@ vm_page_allocate_page_run(uint32 flags, page_num_t length,
 		bool foundRun = true;
 		page_num_t i;
 		for (i = 0; i < length; i++) {
-			uint32 pageState = sPages[start + i].State();
-			if (pageState != PAGE_STATE_FREE
-				&& pageState != PAGE_STATE_CLEAR
-				&& (pageState != PAGE_STATE_CACHED || !useCached)) {
+			const vm_page& page = sPages[start + i];
+			uint32 pageState = page.State();
+			if (page.cpu_cached
+				|| (pageState != PAGE_STATE_FREE
+					&& pageState != PAGE_STATE_CLEAR
+					&& (pageState != PAGE_STATE_CACHED || !useCached))) {
 				foundRun = false;
 				break;
 			}
@@ -4042,6 +4546,7 @@ vm_page_allocate_page_run(uint32 flags, page_num_t length,
 		if (foundRun) {
 			i = allocate_page_run(start, length, flags, freeClearQueueLocker);
 			if (i == length) {
+				page_cpu_caches_unblock();
 				reservation.count = 0;
 				return &sPages[start];
 			}
@@ -4114,6 +4619,17 @@ vm_page_free_etc(VMCache* cache, vm_page* page,
 }
 
 
+/*!	Frees all cached pages that aren't in use at the moment, i.e. those that
+	are neither busy nor mapped nor modified. Returns the number of pages
+	freed.
+*/
+uint32
+vm_page_free_cached_pages(void)
+{
+	return free_cached_pages(sCachedPageQueue.Count(), false);
+}
+
+
 void
 vm_page_set_state(vm_page *page, int pageState)
 {
@@ -4183,7 +4699,7 @@ vm_page_num_pages(void)
 page_num_t
 vm_page_num_free_pages(void)
 {
-	int32 count = sUnreservedFreePages + sCachedPageQueue.Count();
+	int32 count = unreserved_free_pages() + sCachedPageQueue.Count();
 	return count > 0 ? count : 0;
 }
 
@@ -4191,7 +4707,7 @@ vm_page_num_free_pages(void)
 page_num_t
 vm_page_num_unused_pages(void)
 {
-	int32 count = sUnreservedFreePages;
+	int32 count = unreserved_free_pages();
 	return count > 0 ? count : 0;
 }
 
@@ -4230,6 +4746,13 @@ vm_page_get_stats(system_info *info)
 	// clear ones leaves us with all used pages.
 	uint32 subtractPages = info->cached_pages + sFreePageQueue.Count()
 		+ sClearPageQueue.Count();
+	if (sPageCPUCachesEnabled) {
+		int32 cpuCount = smp_get_num_cpus();
+		for (int32 i = 0; i < cpuCount; i++) {
+			subtractPages += sPageCPUCaches[i].freeCount
+				+ sPageCPUCaches[i].clearCount;
+		}
+	}
 	info->used_pages = subtractPages > info->max_pages
 		? 0 : info->max_pages - subtractPages;
 
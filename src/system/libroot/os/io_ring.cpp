@@ -0,0 +1,163 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <user_io_ring.h>
+
+#include <OS.h>
+
+#include <syscalls.h>
+
+
+status_t
+io_ring_init(io_ring* ring, uint32 entries, uint32 flags)
+{
+	io_ring_params params;
+	memset(&params, 0, sizeof(params));
+	params.sq_entries = entries;
+	params.flags = flags;
+
+	int fd = _kern_io_ring_setup(&params);
+	if (fd < 0)
+		return fd;
+
+	uint8* address = (uint8*)params.address;
+	ring->fd = fd;
+	ring->area = params.area;
+	ring->sq = (io_ring_queue*)(address + params.sq_offset);
+	ring->cq = (io_ring_queue*)(address + params.cq_offset);
+	ring->sqes = (io_ring_sqe*)(address + params.sqes_offset);
+	ring->cqes = (io_ring_cqe*)(address + params.cqes_offset);
+	ring->sq_tail = ring->sq->tail;
+
+	return B_OK;
+}
+
+
+void
+io_ring_exit(io_ring* ring)
+{
+	// the kernel deletes the area along with the ring
+	_kern_close(ring->fd);
+	ring->fd = -1;
+	ring->area = -1;
+}
+
+
+io_ring_sqe*
+io_ring_get_sqe(io_ring* ring)
+{
+	uint32 head = (uint32)atomic_get((int32*)&ring->sq->head);
+	if (ring->sq_tail - head >= ring->sq->entries)
+		return NULL;
+
+	return &ring->sqes[ring->sq_tail++ & ring->sq->mask];
+}
+
+
+static ssize_t
+submit(io_ring* ring, uint32 waitCount, uint32 flags, bigtime_t timeout)
+{
+	// publish the prepared entries
+	atomic_set((int32*)&ring->sq->tail, ring->sq_tail);
+
+	uint32 toSubmit = ring->sq_tail
+		- (uint32)atomic_get((int32*)&ring->sq->head);
+	if (waitCount > 0)
+		flags |= IO_RING_ENTER_GETEVENTS;
+	else if (toSubmit == 0)
+		return 0;
+
+	return _kern_io_ring_enter(ring->fd, toSubmit, waitCount, flags, timeout);
+}
+
+
+ssize_t
+io_ring_submit(io_ring* ring)
+{
+	return submit(ring, 0, 0, 0);
+}
+
+
+ssize_t
+io_ring_submit_and_wait(io_ring* ring, uint32 waitCount)
+{
+	return submit(ring, waitCount, 0, 0);
+}
+
+
+status_t
+io_ring_peek_cqe(io_ring* ring, io_ring_cqe** _cqe)
+{
+	uint32 head = ring->cq->head;
+	if (head == (uint32)atomic_get((int32*)&ring->cq->tail))
+		return B_WOULD_BLOCK;
+
+	*_cqe = &ring->cqes[head & ring->cq->mask];
+	return B_OK;
+}
+
+
+status_t
+io_ring_wait_cqe(io_ring* ring, io_ring_cqe** _cqe)
+{
+	return io_ring_wait_cqe_etc(ring, _cqe, 0, 0);
+}
+
+
+status_t
+io_ring_wait_cqe_etc(io_ring* ring, io_ring_cqe** _cqe, uint32 flags,
+	bigtime_t timeout)
+{
+	if (io_ring_peek_cqe(ring, _cqe) == B_OK)
+		return B_OK;
+
+	ssize_t result = submit(ring, 1, flags, timeout);
+	if (result < 0)
+		return result;
+
+	// the kernel doesn't wait, if nothing is in flight
+	return io_ring_peek_cqe(ring, _cqe) == B_OK ? B_OK : B_ENTRY_NOT_FOUND;
+}
+
+
+void
+io_ring_cqe_seen(io_ring* ring, io_ring_cqe* cqe)
+{
+	atomic_set((int32*)&ring->cq->head, ring->cq->head + 1);
+}
+
+
+status_t
+io_ring_register_buffers(io_ring* ring, const struct iovec* vecs,
+	uint32 count)
+{
+	return _kern_io_ring_register(ring->fd, IO_RING_REGISTER_BUFFERS, vecs,
+		count);
+}
+
+
+status_t
+io_ring_unregister_buffers(io_ring* ring)
+{
+	return _kern_io_ring_register(ring->fd, IO_RING_UNREGISTER_BUFFERS, NULL,
+		0);
+}
+
+
+status_t
+io_ring_register_files(io_ring* ring, const int* fds, uint32 count)
+{
+	return _kern_io_ring_register(ring->fd, IO_RING_REGISTER_FILES, fds,
+		count);
+}
+
+
+status_t
+io_ring_unregister_files(io_ring* ring)
+{
+	return _kern_io_ring_register(ring->fd, IO_RING_UNREGISTER_FILES, NULL,
+		0);
+}
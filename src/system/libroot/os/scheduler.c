@@ -11,6 +11,7 @@
 #include <scheduler.h>
 
 #include <syscalls.h>
+#include <thread_defs.h>
 
 
 static struct {
@@ -34,6 +35,10 @@ static struct {
 
 status_t __set_scheduler_mode(int32 mode);
 int32 __get_scheduler_mode(void);
+status_t __set_thread_deadline(thread_id thread, bigtime_t runtime,
+	bigtime_t deadline, bigtime_t period);
+status_t __get_thread_deadline(thread_id thread, bigtime_t* _runtime,
+	bigtime_t* _deadline, bigtime_t* _period);
 
 
 int32
@@ -78,6 +83,41 @@ __get_scheduler_mode(void)
 }
 
 
+status_t
+__set_thread_deadline(thread_id thread, bigtime_t runtime, bigtime_t deadline,
+	bigtime_t period)
+{
+	struct thread_deadline_params params;
+	params.runtime = runtime;
+	params.deadline = deadline;
+	params.period = period;
+
+	return _kern_set_thread_deadline(thread, &params);
+}
+
+
+status_t
+__get_thread_deadline(thread_id thread, bigtime_t* _runtime,
+	bigtime_t* _deadline, bigtime_t* _period)
+{
+	struct thread_deadline_params params;
+	status_t status = _kern_get_thread_deadline(thread, &params);
+	if (status != B_OK)
+		return status;
+
+	if (_runtime != NULL)
+		*_runtime = params.runtime;
+	if (_deadline != NULL)
+		*_deadline = params.deadline;
+	if (_period != NULL)
+		*_period = params.period;
+
+	return B_OK;
+}
+
+
 B_DEFINE_WEAK_ALIAS(__set_scheduler_mode, set_scheduler_mode);
 B_DEFINE_WEAK_ALIAS(__get_scheduler_mode, get_scheduler_mode);
+B_DEFINE_WEAK_ALIAS(__set_thread_deadline, set_thread_deadline);
+B_DEFINE_WEAK_ALIAS(__get_thread_deadline, get_thread_deadline);
 
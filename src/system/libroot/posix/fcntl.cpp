@@ -91,8 +91,7 @@ posix_fadvise(int fd, off_t offset, off_t len, int advice)
 	if (S_ISFIFO(stat.st_mode))
 		return ESPIPE;
 
-	// Haiku does not use this information.
-	return 0;
+	return _kern_file_advice(fd, offset, len, advice);
 }
 
 
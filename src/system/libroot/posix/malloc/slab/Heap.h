@@ -0,0 +1,239 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef _LIBROOT_MALLOC_SLAB_HEAP_H
+#define _LIBROOT_MALLOC_SLAB_HEAP_H
+
+
+#include <OS.h>
+
+#include <limits.h>
+
+
+/*!	The heap hands out memory in three ways:
+	- Small allocations (up to kMaxSmallSize bytes) are rounded up to one of
+	  kClassCount size classes, and are served from slabs ("spans") of that
+	  class. Every span is owned by the heap of the thread that uses it, so
+	  allocating and freeing objects of one's own spans doesn't need any
+	  locking. Other threads push the objects they free onto the span's
+	  remote free list, which the owner collects when it runs out of objects.
+	- Large allocations (up to kMaxLargeSize bytes) get a span of their own.
+	- Huge allocations get an area of their own.
+	Spans are runs of pages in arenas; arenas are kArenaSize aligned areas,
+	so that the span of an address can be found without a lookup structure.
+*/
+
+
+namespace BPrivate {
+
+
+static const size_t kAlignment = 16;
+
+static const uint32 kPageShift = 12;
+static const uint32 kArenaShift = 22;
+static const size_t kArenaSize = (size_t)1 << kArenaShift;
+static const uint32 kArenaPages = kArenaSize / B_PAGE_SIZE;
+
+static const size_t kMaxSmallSize = 32 * 1024;
+static const size_t kMaxLargeSize = 1024 * 1024;
+static const uint32 kClassCount = 40;
+
+
+enum {
+	SPAN_FREE = 0,
+	SPAN_SMALL,
+	SPAN_LARGE
+};
+
+
+struct ThreadHeap;
+
+struct Span {
+	Span*			next;
+	Span*			prev;
+	addr_t			base;
+	void*			free_list;
+	void*			remote_free;
+		// objects freed by other threads, accessed atomically
+	ThreadHeap*		owner;
+	uint16			page_count;
+	uint16			used;
+		// small spans: objects handed out, including those freed remotely
+		// that have not been collected yet
+	uint16			capacity;
+	uint16			carved;
+	uint16			dirty_pages;
+		// free spans: pages that have not been returned to the kernel yet
+	uint8			type;
+	uint8			size_class;
+	int32			full;
+		// set while the span is in its owner's list of full spans
+};
+
+
+struct SpanList {
+	Span*			first;
+	Span*			last;
+
+	bool IsEmpty() const
+	{
+		return first == NULL;
+	}
+
+	void Add(Span* span, bool back = true)
+	{
+		if (back) {
+			span->next = NULL;
+			span->prev = last;
+			if (last != NULL)
+				last->next = span;
+			else
+				first = span;
+			last = span;
+		} else {
+			span->prev = NULL;
+			span->next = first;
+			if (first != NULL)
+				first->prev = span;
+			else
+				last = span;
+			first = span;
+		}
+	}
+
+	void Remove(Span* span)
+	{
+		if (span->prev != NULL)
+			span->prev->next = span->next;
+		else
+			first = span->next;
+		if (span->next != NULL)
+			span->next->prev = span->prev;
+		else
+			last = span->prev;
+	}
+};
+
+
+struct Arena {
+	Arena*			next;
+	area_id			area;
+	uint16			span_start[kArenaPages];
+		// for every page the index of the first page of its span; only
+		// the first and last page of free spans are kept up to date
+	Span			spans[kArenaPages];
+		// the descriptors of the spans, indexed by their first page
+};
+
+static const uint32 kArenaHeaderPages
+	= (sizeof(Arena) + B_PAGE_SIZE - 1) / B_PAGE_SIZE;
+
+
+// #pragma mark - atomic helpers
+
+
+static inline void*
+atomic_pointer_get(void** pointer)
+{
+#if LONG_MAX == INT_MAX
+	return (void*)atomic_get((int32*)pointer);
+#else
+	return (void*)atomic_get64((int64*)pointer);
+#endif
+}
+
+
+static inline void*
+atomic_pointer_get_and_set(void** pointer, void* set)
+{
+#if LONG_MAX == INT_MAX
+	return (void*)atomic_get_and_set((int32*)pointer, (int32)set);
+#else
+	return (void*)atomic_get_and_set64((int64*)pointer, (int64)set);
+#endif
+}
+
+
+static inline void*
+atomic_pointer_test_and_set(void** pointer, void* set, void* test)
+{
+#if LONG_MAX == INT_MAX
+	return (void*)atomic_test_and_set((int32*)pointer, (int32)set,
+		(int32)test);
+#else
+	return (void*)atomic_test_and_set64((int64*)pointer, (int64)set,
+		(int64)test);
+#endif
+}
+
+
+// #pragma mark - page heap
+
+
+static const uint32 kArenaMapLeafBits = 13;
+#if B_HAIKU_64_BIT
+static const uint32 kArenaMapTopBits = 48 - kArenaShift - kArenaMapLeafBits;
+#else
+static const uint32 kArenaMapTopBits = 0;
+#endif
+
+extern uint8* gArenaMap[1 << kArenaMapTopBits];
+	// one byte per possible arena, set when there is one at that address
+
+
+static inline bool
+is_arena_address(addr_t address)
+{
+	addr_t index = address >> kArenaShift;
+	if ((index >> kArenaMapLeafBits) >= ((addr_t)1 << kArenaMapTopBits))
+		return false;
+
+	uint8* leaf = gArenaMap[index >> kArenaMapLeafBits];
+	return leaf != NULL
+		&& leaf[index & ((1 << kArenaMapLeafBits) - 1)] != 0;
+}
+
+
+static inline Span*
+span_for_address(addr_t address)
+{
+	Arena* arena = (Arena*)(address & ~(kArenaSize - 1));
+	uint32 page = (address - (addr_t)arena) >> kPageShift;
+	return &arena->spans[arena->span_start[page]];
+}
+
+
+Span*	page_heap_allocate(uint32 pageCount, uint32 alignmentPages,
+			uint8 type);
+void	page_heap_free(Span* span);
+void*	page_heap_allocate_metadata(size_t size);
+
+void	page_heap_init();
+void	page_heap_lock();
+void	page_heap_unlock();
+void	page_heap_get_stats(size_t& total, size_t& freeSize, size_t& usedSpans,
+			size_t& freeSpans);
+
+void*	huge_allocate(size_t size, size_t alignment);
+void	huge_free(void* address);
+size_t	huge_usable_size(void* address);
+bool	huge_resize(void* address, size_t size);
+size_t	huge_total_size();
+
+
+// #pragma mark - thread heaps
+
+
+void	reclaim_abandoned_spans();
+
+void*	heap_allocate(size_t size, size_t alignment);
+void	heap_free(void* address);
+size_t	heap_usable_size(void* address);
+bool	heap_resize(void* address, size_t size);
+
+
+}	// namespace BPrivate
+
+
+#endif	// _LIBROOT_MALLOC_SLAB_HEAP_H
@@ -0,0 +1,556 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "Heap.h"
+
+#include <stdint.h>
+#include <sys/mman.h>
+
+#include <libroot_private.h>
+#include <locks.h>
+#include <syscalls.h>
+
+
+namespace BPrivate {
+
+
+static const uint32 kFreeListCount = 128;
+	// free spans of kFreeListCount - 1 or more pages share the last list
+static const uint32 kMaxDirtyPages = 256;
+	// the number of free pages we keep before returning them to the kernel
+static const size_t kMetadataChunkSize = 64 * 1024;
+
+static const uint32 kHugeMagic = 'hUge';
+
+
+struct HugeHeader {
+	area_id			area;
+	uint32			magic;
+	size_t			offset;
+	size_t			size;
+};
+
+
+uint8* gArenaMap[1 << kArenaMapTopBits];
+
+static mutex sPageLock = MUTEX_INITIALIZER("heap pages");
+static Arena* sArenas;
+static uint32 sArenaCount;
+static SpanList sFreeSpans[kFreeListCount];
+static uint32 sFreePages;
+static uint32 sDirtyPages;
+
+static addr_t sMetadataBase;
+static size_t sMetadataFree;
+
+static int64 sHugeSize;
+
+
+static uint32
+heap_protection()
+{
+	uint32 protection = B_READ_AREA | B_WRITE_AREA;
+	if (__gABIVersion < B_HAIKU_ABI_GCC_2_HAIKU)
+		protection |= B_EXECUTE_AREA;
+
+	return protection;
+}
+
+
+/*!	Creates an area of the given size whose address is a multiple of
+	\a alignment.
+*/
+static area_id
+create_heap_area(const char* name, size_t size, size_t alignment,
+	void** _address)
+{
+	if (alignment <= B_PAGE_SIZE) {
+		return create_area(name, _address, B_RANDOMIZED_ANY_ADDRESS, size,
+			B_NO_LOCK, heap_protection());
+	}
+
+	// Reserve enough address space for the aligned area to fit in, so that
+	// no other area can get in the way.
+	addr_t reserved = 0;
+	status_t status = _kern_reserve_address_range(&reserved,
+		B_RANDOMIZED_ANY_ADDRESS, size + alignment);
+	if (status != B_OK)
+		return status;
+
+	*_address = (void*)((reserved + alignment - 1) & ~(addr_t)(alignment - 1));
+	area_id area = create_area(name, _address, B_EXACT_ADDRESS, size,
+		B_NO_LOCK, heap_protection());
+
+	_kern_unreserve_address_range(reserved, size + alignment);
+	return area;
+}
+
+
+static void*
+allocate_metadata_locked(size_t size)
+{
+	size = (size + kAlignment - 1) & ~(kAlignment - 1);
+
+	if (size > sMetadataFree) {
+		void* address;
+		area_id area = create_area("heap metadata", &address,
+			B_RANDOMIZED_ANY_ADDRESS, kMetadataChunkSize, B_NO_LOCK,
+			B_READ_AREA | B_WRITE_AREA);
+		if (area < 0)
+			return NULL;
+
+		sMetadataBase = (addr_t)address;
+		sMetadataFree = kMetadataChunkSize;
+	}
+
+	void* address = (void*)sMetadataBase;
+	sMetadataBase += size;
+	sMetadataFree -= size;
+	return address;
+}
+
+
+static bool
+set_arena_mapped(Arena* arena, bool mapped)
+{
+	addr_t index = (addr_t)arena >> kArenaShift;
+	uint8*& leaf = gArenaMap[index >> kArenaMapLeafBits];
+	if (leaf == NULL) {
+		if (!mapped)
+			return true;
+
+		leaf = (uint8*)allocate_metadata_locked(1 << kArenaMapLeafBits);
+		if (leaf == NULL)
+			return false;
+	}
+
+	leaf[index & ((1 << kArenaMapLeafBits) - 1)] = mapped ? 1 : 0;
+	return true;
+}
+
+
+static inline SpanList&
+free_list_for(uint32 pageCount)
+{
+	return sFreeSpans[min_c(pageCount, kFreeListCount - 1)];
+}
+
+
+static inline Arena*
+arena_for(Span* span)
+{
+	return (Arena*)(span->base & ~(kArenaSize - 1));
+}
+
+
+static Span*
+init_span(Arena* arena, uint32 index, uint32 pageCount)
+{
+	Span* span = &arena->spans[index];
+	span->base = (addr_t)arena + index * B_PAGE_SIZE;
+	span->page_count = pageCount;
+	return span;
+}
+
+
+static void
+insert_free_span(Arena* arena, uint32 index, uint32 pageCount,
+	uint32 dirtyPages)
+{
+	Span* span = init_span(arena, index, pageCount);
+	span->type = SPAN_FREE;
+	span->dirty_pages = dirtyPages;
+
+	arena->span_start[index] = index;
+	arena->span_start[index + pageCount - 1] = index;
+
+	// prefer reusing pages that are still mapped
+	free_list_for(pageCount).Add(span, dirtyPages == 0);
+}
+
+
+static Arena*
+create_arena()
+{
+	void* address;
+	area_id area = create_heap_area("heap", kArenaSize, kArenaSize, &address);
+	if (area < 0)
+		return NULL;
+
+	Arena* arena = (Arena*)address;
+	if (!set_arena_mapped(arena, true)) {
+		delete_area(area);
+		return NULL;
+	}
+
+	arena->area = area;
+	arena->next = sArenas;
+	sArenas = arena;
+	sArenaCount++;
+
+	insert_free_span(arena, kArenaHeaderPages,
+		kArenaPages - kArenaHeaderPages, 0);
+	sFreePages += kArenaPages - kArenaHeaderPages;
+
+	return arena;
+}
+
+
+static void
+delete_arena(Arena* arena)
+{
+	Arena** link = &sArenas;
+	while (*link != arena)
+		link = &(*link)->next;
+	*link = arena->next;
+	sArenaCount--;
+
+	set_arena_mapped(arena, false);
+	delete_area(arena->area);
+}
+
+
+static Span*
+find_free_span(uint32 pageCount, size_t alignment)
+{
+	Span* best = NULL;
+
+	for (uint32 i = min_c(pageCount, kFreeListCount - 1); i < kFreeListCount;
+			i++) {
+		for (Span* span = sFreeSpans[i].first; span != NULL;
+				span = span->next) {
+			addr_t start = (span->base + alignment - 1)
+				& ~(addr_t)(alignment - 1);
+			if (start + pageCount * B_PAGE_SIZE
+					> span->base + span->page_count * B_PAGE_SIZE) {
+				continue;
+			}
+
+			if (i < kFreeListCount - 1)
+				return span;
+
+			// the spans in the last list have different sizes, pick the
+			// best fit
+			if (best == NULL || span->page_count < best->page_count)
+				best = span;
+		}
+	}
+
+	return best;
+}
+
+
+/*!	Returns the pages of free spans to the kernel, largest spans first, until
+	only half of kMaxDirtyPages are left.
+*/
+static void
+release_dirty_pages()
+{
+	for (int32 i = kFreeListCount - 1;
+			i >= 0 && sDirtyPages > kMaxDirtyPages / 2; i--) {
+		for (Span* span = sFreeSpans[i].first;
+				span != NULL && sDirtyPages > kMaxDirtyPages / 2;
+				span = span->next) {
+			if (span->dirty_pages == 0)
+				continue;
+
+			_kern_memory_advice((void*)span->base,
+				(size_t)span->page_count * B_PAGE_SIZE, MADV_FREE);
+
+			sDirtyPages -= span->dirty_pages;
+			span->dirty_pages = 0;
+		}
+	}
+}
+
+
+// #pragma mark - page heap
+
+
+void
+page_heap_init()
+{
+	mutex_init_etc(&sPageLock, "heap pages", MUTEX_FLAG_ADAPTIVE);
+}
+
+
+void
+page_heap_lock()
+{
+	mutex_lock(&sPageLock);
+}
+
+
+void
+page_heap_unlock()
+{
+	mutex_unlock(&sPageLock);
+}
+
+
+/*!	Returns a span of \a pageCount pages, starting at a multiple of
+	\a alignmentPages pages.
+*/
+Span*
+page_heap_allocate(uint32 pageCount, uint32 alignmentPages, uint8 type)
+{
+	size_t alignment = (size_t)alignmentPages * B_PAGE_SIZE;
+
+	mutex_lock(&sPageLock);
+
+	Span* span = find_free_span(pageCount, alignment);
+	if (span == NULL) {
+		// Before mapping another arena, see if the spans of exited threads
+		// have become free in the mean time.
+		mutex_unlock(&sPageLock);
+		reclaim_abandoned_spans();
+		mutex_lock(&sPageLock);
+
+		span = find_free_span(pageCount, alignment);
+		if (span == NULL && create_arena() != NULL)
+			span = find_free_span(pageCount, alignment);
+		if (span == NULL) {
+			mutex_unlock(&sPageLock);
+			return NULL;
+		}
+	}
+
+	Arena* arena = arena_for(span);
+	uint32 index = (span->base - (addr_t)arena) >> kPageShift;
+	uint32 freePages = span->page_count;
+	uint32 dirtyPages = span->dirty_pages;
+	free_list_for(freePages).Remove(span);
+
+	addr_t start = (span->base + alignment - 1) & ~(addr_t)(alignment - 1);
+	uint32 leadingPages = (start - span->base) >> kPageShift;
+	uint32 trailingPages = freePages - leadingPages - pageCount;
+
+	// We don't know which pages are still mapped; assume the allocation
+	// gets them first.
+	uint32 usedDirtyPages = min_c(dirtyPages, pageCount);
+	uint32 leadingDirtyPages = min_c(dirtyPages - usedDirtyPages,
+		leadingPages);
+	sDirtyPages -= usedDirtyPages;
+
+	if (leadingPages > 0)
+		insert_free_span(arena, index, leadingPages, leadingDirtyPages);
+	if (trailingPages > 0) {
+		insert_free_span(arena, index + leadingPages + pageCount,
+			trailingPages, dirtyPages - usedDirtyPages - leadingDirtyPages);
+	}
+
+	index += leadingPages;
+	span = init_span(arena, index, pageCount);
+	for (uint32 i = 0; i < pageCount; i++)
+		arena->span_start[index + i] = index;
+
+	span->type = type;
+	span->owner = NULL;
+	span->free_list = NULL;
+	span->remote_free = NULL;
+	span->full = 0;
+	span->dirty_pages = 0;
+
+	sFreePages -= pageCount;
+
+	mutex_unlock(&sPageLock);
+	return span;
+}
+
+
+void
+page_heap_free(Span* span)
+{
+	Arena* arena = arena_for(span);
+	uint32 index = (span->base - (addr_t)arena) >> kPageShift;
+	uint32 pageCount = span->page_count;
+	uint32 dirtyPages = pageCount;
+
+	mutex_lock(&sPageLock);
+
+	sFreePages += pageCount;
+	sDirtyPages += dirtyPages;
+
+	// join with the neighbouring spans, if they are free
+	if (index > kArenaHeaderPages) {
+		uint32 previousIndex = arena->span_start[index - 1];
+		Span* previous = &arena->spans[previousIndex];
+		if (previous->type == SPAN_FREE) {
+			free_list_for(previous->page_count).Remove(previous);
+			index = previousIndex;
+			pageCount += previous->page_count;
+			dirtyPages += previous->dirty_pages;
+		}
+	}
+
+	if (index + pageCount < kArenaPages) {
+		Span* next = &arena->spans[index + pageCount];
+		if (next->type == SPAN_FREE) {
+			free_list_for(next->page_count).Remove(next);
+			pageCount += next->page_count;
+			dirtyPages += next->dirty_pages;
+		}
+	}
+
+	// The span descriptor isn't necessarily the one of the joined span
+	span->type = SPAN_FREE;
+
+	if (pageCount == kArenaPages - kArenaHeaderPages && sArenaCount > 1) {
+		// the whole arena is unused, and it's not the last one
+		sFreePages -= pageCount;
+		sDirtyPages -= dirtyPages;
+		delete_arena(arena);
+	} else {
+		insert_free_span(arena, index, pageCount, dirtyPages);
+
+		if (sDirtyPages > kMaxDirtyPages)
+			release_dirty_pages();
+	}
+
+	mutex_unlock(&sPageLock);
+}
+
+
+void*
+page_heap_allocate_metadata(size_t size)
+{
+	mutex_lock(&sPageLock);
+	void* address = allocate_metadata_locked(size);
+	mutex_unlock(&sPageLock);
+
+	return address;
+}
+
+
+void
+page_heap_get_stats(size_t& total, size_t& freeSize, size_t& usedSpans,
+	size_t& freeSpans)
+{
+	mutex_lock(&sPageLock);
+
+	total = (size_t)sArenaCount * (kArenaPages - kArenaHeaderPages)
+		* B_PAGE_SIZE;
+	freeSize = (size_t)sFreePages * B_PAGE_SIZE;
+	usedSpans = 0;
+	freeSpans = 0;
+
+	for (Arena* arena = sArenas; arena != NULL; arena = arena->next) {
+		uint32 index = kArenaHeaderPages;
+		while (index < kArenaPages) {
+			Span* span = &arena->spans[index];
+			if (span->type == SPAN_FREE)
+				freeSpans++;
+			else
+				usedSpans++;
+
+			index += span->page_count;
+		}
+	}
+
+	mutex_unlock(&sPageLock);
+}
+
+
+// #pragma mark - huge allocations
+
+
+static HugeHeader*
+huge_header(void* address)
+{
+	HugeHeader* header = (HugeHeader*)address - 1;
+	if (header->magic != kHugeMagic) {
+		debugger("heap: invalid address");
+		return NULL;
+	}
+
+	return header;
+}
+
+
+void*
+huge_allocate(size_t size, size_t alignment)
+{
+	if (alignment < kAlignment)
+		alignment = kAlignment;
+
+	size_t offset = (sizeof(HugeHeader) + alignment - 1) & ~(alignment - 1);
+	if (size > SIZE_MAX - offset - B_PAGE_SIZE)
+		return NULL;
+
+	size_t areaSize = (offset + size + B_PAGE_SIZE - 1)
+		& ~(size_t)(B_PAGE_SIZE - 1);
+
+	void* base;
+	area_id area = create_heap_area("heap huge", areaSize, alignment, &base);
+	if (area < 0)
+		return NULL;
+
+	HugeHeader* header = (HugeHeader*)((addr_t)base + offset) - 1;
+	header->area = area;
+	header->magic = kHugeMagic;
+	header->offset = offset;
+	header->size = areaSize - offset;
+
+	atomic_add64(&sHugeSize, areaSize);
+	return (void*)((addr_t)base + offset);
+}
+
+
+void
+huge_free(void* address)
+{
+	HugeHeader* header = huge_header(address);
+	if (header == NULL)
+		return;
+
+	atomic_add64(&sHugeSize, -(int64)(header->offset + header->size));
+	delete_area(header->area);
+}
+
+
+size_t
+huge_usable_size(void* address)
+{
+	HugeHeader* header = huge_header(address);
+	return header != NULL ? header->size : 0;
+}
+
+
+/*!	Resizes the area of a huge allocation in place, if possible. Allocations
+	that would no longer be huge are left alone.
+*/
+bool
+huge_resize(void* address, size_t size)
+{
+	HugeHeader* header = huge_header(address);
+	if (header == NULL || size <= kMaxLargeSize
+		|| size > SIZE_MAX - header->offset - B_PAGE_SIZE) {
+		return false;
+	}
+
+	size_t oldAreaSize = header->offset + header->size;
+	size_t areaSize = (header->offset + size + B_PAGE_SIZE - 1)
+		& ~(size_t)(B_PAGE_SIZE - 1);
+	if (areaSize == oldAreaSize)
+		return true;
+
+	if (resize_area(header->area, areaSize) != B_OK)
+		return false;
+
+	header->size = areaSize - header->offset;
+	atomic_add64(&sHugeSize, (int64)areaSize - (int64)oldAreaSize);
+	return true;
+}
+
+
+size_t
+huge_total_size()
+{
+	return (size_t)atomic_get64(&sHugeSize);
+}
+
+
+}	// namespace BPrivate
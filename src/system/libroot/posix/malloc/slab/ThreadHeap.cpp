@@ -0,0 +1,612 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "Heap.h"
+
+#include <string.h>
+
+#include <locks.h>
+#include <tls.h>
+
+
+namespace BPrivate {
+
+
+static const size_t kMinSpanSize = 16 * 1024;
+static const uint32 kMinSpanObjects = 8;
+static const size_t kMaxLargeAlignment = 256 * 1024;
+
+
+struct ThreadHeap {
+	ThreadHeap*		next;
+	ThreadHeap*		previous;
+		// in the list of heaps in use, or (next only) of unused heaps
+	SpanList		spans[kClassCount];
+		// the first span of a class is the one we allocate from
+	SpanList		full_spans[kClassCount];
+	int32			remote_frees[kClassCount];
+		// set when objects of a full span have been freed remotely
+};
+
+
+static uint32 sClassSizes[kClassCount];
+static uint16 sClassPages[kClassCount];
+static uint8 sSizeClasses[kMaxSmallSize / kAlignment + 1];
+
+static mutex sHeapLock = MUTEX_INITIALIZER("heap");
+static SpanList sAbandonedSpans[kClassCount];
+static ThreadHeap* sHeaps;
+static ThreadHeap* sUnusedHeaps;
+
+static mutex sSharedHeapLock = MUTEX_INITIALIZER("shared heap");
+static ThreadHeap sSharedHeap;
+	// used by threads that could not get a heap of their own, or that are
+	// already past __heap_thread_exit()
+
+
+static void
+init_size_classes()
+{
+	// 16 byte steps up to 128 bytes, then four classes per power of two
+	uint32 index = 0;
+	for (size_t size = kAlignment; size <= 128; size += kAlignment)
+		sClassSizes[index++] = size;
+	for (size_t base = 128; base < kMaxSmallSize; base *= 2) {
+		for (uint32 step = 1; step <= 4; step++)
+			sClassSizes[index++] = base + base / 4 * step;
+	}
+
+	for (uint32 i = 0; i < kClassCount; i++) {
+		size_t size = sClassSizes[i];
+		size_t spanSize = max_c(size * kMinSpanObjects, kMinSpanSize);
+		spanSize = (spanSize + B_PAGE_SIZE - 1) & ~(size_t)(B_PAGE_SIZE - 1);
+
+		// keep the space wasted at the end of a span below 1/8
+		while (spanSize % size > spanSize / 8)
+			spanSize += B_PAGE_SIZE;
+
+		sClassPages[i] = spanSize / B_PAGE_SIZE;
+	}
+
+	uint32 sizeClass = 0;
+	for (uint32 i = 0; i <= kMaxSmallSize / kAlignment; i++) {
+		while (sClassSizes[sizeClass] < i * kAlignment)
+			sizeClass++;
+		sSizeClasses[i] = sizeClass;
+	}
+}
+
+
+static inline ThreadHeap*
+current_heap()
+{
+	return (ThreadHeap*)tls_get(TLS_MALLOC_SLOT);
+}
+
+
+static ThreadHeap*
+create_heap()
+{
+	mutex_lock(&sHeapLock);
+	ThreadHeap* heap = sUnusedHeaps;
+	if (heap != NULL)
+		sUnusedHeaps = heap->next;
+	mutex_unlock(&sHeapLock);
+
+	if (heap == NULL) {
+		heap = (ThreadHeap*)page_heap_allocate_metadata(sizeof(ThreadHeap));
+		if (heap == NULL)
+			return &sSharedHeap;
+	}
+
+	memset(heap, 0, sizeof(ThreadHeap));
+
+	mutex_lock(&sHeapLock);
+	heap->next = sHeaps;
+	if (sHeaps != NULL)
+		sHeaps->previous = heap;
+	sHeaps = heap;
+	mutex_unlock(&sHeapLock);
+
+	tls_set(TLS_MALLOC_SLOT, heap);
+	return heap;
+}
+
+
+// #pragma mark - spans
+
+
+static Span*
+allocate_span(ThreadHeap* heap, uint32 sizeClass)
+{
+	Span* span = page_heap_allocate(sClassPages[sizeClass], 1, SPAN_SMALL);
+	if (span == NULL)
+		return NULL;
+
+	span->size_class = sizeClass;
+	span->capacity = span->page_count * B_PAGE_SIZE / sClassSizes[sizeClass];
+	span->used = 0;
+	span->carved = 0;
+	span->owner = heap;
+	return span;
+}
+
+
+/*!	Adds the next page worth of never used objects to the span's free list,
+	which must be empty. This way, the pages of a span are only touched when
+	they are needed.
+*/
+static void
+carve_objects(Span* span)
+{
+	size_t size = sClassSizes[span->size_class];
+	uint32 count = min_c((size_t)(span->capacity - span->carved),
+		max_c(B_PAGE_SIZE / size, (size_t)1));
+	addr_t base = span->base + span->carved * size;
+	span->carved += count;
+
+	void* list = NULL;
+	for (uint32 i = count; i-- > 0;) {
+		void** object = (void**)(base + i * size);
+		*object = list;
+		list = object;
+	}
+
+	span->free_list = list;
+}
+
+
+/*!	Moves the objects other threads have freed to the span's free list.
+	May only be called by the owner of the span.
+*/
+static bool
+collect_remote_frees(Span* span)
+{
+	void* list = atomic_pointer_get_and_set(&span->remote_free, NULL);
+	if (list == NULL)
+		return false;
+
+	uint32 count = 1;
+	void** last = (void**)list;
+	while (*last != NULL) {
+		last = (void**)*last;
+		count++;
+	}
+
+	*last = span->free_list;
+	span->free_list = list;
+	span->used -= count;
+	return true;
+}
+
+
+static inline void*
+pop_object(Span* span)
+{
+	void** object = (void**)span->free_list;
+	span->free_list = *object;
+	span->used++;
+	return object;
+}
+
+
+/*!	Moves the span to the list of full spans, unless objects have been freed
+	remotely in the mean time; those are collected instead. Other threads
+	check the "full" flag after freeing an object, so we must not miss one
+	that arrived just before.
+	Setting the flag and checking the remote free list are both atomic
+	read-modify-write operations, as are their counterparts in
+	free_object_remotely(): a plain store could still be buffered when the
+	list is read, and both sides could miss each other.
+*/
+static bool
+move_to_full_list(ThreadHeap* heap, Span* span)
+{
+	atomic_get_and_set(&span->full, 1);
+	if (collect_remote_frees(span)) {
+		atomic_set(&span->full, 0);
+		return false;
+	}
+
+	heap->spans[span->size_class].Remove(span);
+	heap->full_spans[span->size_class].Add(span);
+	return true;
+}
+
+
+static Span*
+adopt_abandoned_span(ThreadHeap* heap, uint32 sizeClass)
+{
+	if (sAbandonedSpans[sizeClass].IsEmpty())
+		return NULL;
+
+	mutex_lock(&sHeapLock);
+	Span* span = sAbandonedSpans[sizeClass].first;
+	if (span != NULL)
+		sAbandonedSpans[sizeClass].Remove(span);
+	mutex_unlock(&sHeapLock);
+
+	if (span != NULL) {
+		span->owner = heap;
+		collect_remote_frees(span);
+	}
+
+	return span;
+}
+
+
+/*!	Gives up the ownership of a span of an exiting thread. Spans that still
+	have objects in use are kept until another thread adopts them, or until
+	they become unused.
+*/
+static void
+abandon_span(Span* span)
+{
+	atomic_set(&span->full, 0);
+	collect_remote_frees(span);
+
+	if (span->used == 0) {
+		page_heap_free(span);
+		return;
+	}
+
+	span->owner = NULL;
+
+	mutex_lock(&sHeapLock);
+	sAbandonedSpans[span->size_class].Add(span);
+	mutex_unlock(&sHeapLock);
+}
+
+
+/*!	Abandons all spans of the heap, and puts it into the list of unused
+	heaps. The caller must not hold sHeapLock.
+*/
+static void
+abandon_heap(ThreadHeap* heap)
+{
+	for (uint32 i = 0; i < kClassCount; i++) {
+		while (!heap->spans[i].IsEmpty()) {
+			Span* span = heap->spans[i].first;
+			heap->spans[i].Remove(span);
+			abandon_span(span);
+		}
+		while (!heap->full_spans[i].IsEmpty()) {
+			Span* span = heap->full_spans[i].first;
+			heap->full_spans[i].Remove(span);
+			abandon_span(span);
+		}
+	}
+
+	mutex_lock(&sHeapLock);
+	if (heap->previous != NULL)
+		heap->previous->next = heap->next;
+	else
+		sHeaps = heap->next;
+	if (heap->next != NULL)
+		heap->next->previous = heap->previous;
+
+	heap->next = sUnusedHeaps;
+	sUnusedHeaps = heap;
+	mutex_unlock(&sHeapLock);
+}
+
+
+void
+reclaim_abandoned_spans()
+{
+	mutex_lock(&sHeapLock);
+
+	for (uint32 i = 0; i < kClassCount; i++) {
+		Span* span = sAbandonedSpans[i].first;
+		while (span != NULL) {
+			Span* next = span->next;
+
+			collect_remote_frees(span);
+			if (span->used == 0) {
+				sAbandonedSpans[i].Remove(span);
+				page_heap_free(span);
+			}
+
+			span = next;
+		}
+	}
+
+	mutex_unlock(&sHeapLock);
+}
+
+
+// #pragma mark - objects
+
+
+static void*
+allocate_object_slow(ThreadHeap* heap, uint32 sizeClass)
+{
+	SpanList& spans = heap->spans[sizeClass];
+
+	while (true) {
+		while (!spans.IsEmpty()) {
+			Span* span = spans.first;
+			if (span->free_list == NULL)
+				collect_remote_frees(span);
+			if (span->free_list == NULL && span->carved < span->capacity)
+				carve_objects(span);
+			if (span->free_list != NULL)
+				return pop_object(span);
+
+			move_to_full_list(heap, span);
+		}
+
+		// Objects of full spans might have been freed by other threads
+		if (atomic_get(&heap->remote_frees[sizeClass]) != 0) {
+			atomic_set(&heap->remote_frees[sizeClass], 0);
+
+			Span* span = heap->full_spans[sizeClass].first;
+			while (span != NULL) {
+				Span* next = span->next;
+				if (atomic_pointer_get(&span->remote_free) != NULL) {
+					heap->full_spans[sizeClass].Remove(span);
+					atomic_set(&span->full, 0);
+					spans.Add(span);
+				}
+				span = next;
+			}
+
+			if (!spans.IsEmpty())
+				continue;
+		}
+
+		Span* span = adopt_abandoned_span(heap, sizeClass);
+		if (span == NULL) {
+			span = allocate_span(heap, sizeClass);
+			if (span == NULL)
+				return NULL;
+		}
+
+		spans.Add(span, false);
+	}
+}
+
+
+static inline void*
+allocate_object(ThreadHeap* heap, uint32 sizeClass)
+{
+	Span* span = heap->spans[sizeClass].first;
+	if (span != NULL && span->free_list != NULL)
+		return pop_object(span);
+
+	return allocate_object_slow(heap, sizeClass);
+}
+
+
+static inline void
+free_object(ThreadHeap* heap, Span* span, void* object)
+{
+	*(void**)object = span->free_list;
+	span->free_list = object;
+
+	SpanList& spans = heap->spans[span->size_class];
+	if (span->full != 0) {
+		atomic_set(&span->full, 0);
+		heap->full_spans[span->size_class].Remove(span);
+		spans.Add(span);
+	}
+
+	// Keep the span we allocate from, even if it's empty now
+	if (--span->used == 0 && span != spans.first) {
+		spans.Remove(span);
+		page_heap_free(span);
+	}
+}
+
+
+static void
+free_object_remotely(Span* span, void* object)
+{
+	void* head;
+	do {
+		head = atomic_pointer_get(&span->remote_free);
+		*(void**)object = head;
+	} while (atomic_pointer_test_and_set(&span->remote_free, object, head)
+		!= head);
+
+	// This must not be a plain load, see move_to_full_list()
+	if (atomic_or(&span->full, 0) != 0) {
+		// Tell the owner to look at its full spans again. If the span has
+		// changed hands meanwhile, this is just a false alarm.
+		ThreadHeap* owner = span->owner;
+		if (owner != NULL)
+			atomic_add(&owner->remote_frees[span->size_class], 1);
+	}
+}
+
+
+// #pragma mark - heap
+
+
+void*
+heap_allocate(size_t size, size_t alignment)
+{
+	if (size <= kMaxSmallSize && alignment <= B_PAGE_SIZE) {
+		// Objects are aligned to their size class in the page aligned spans
+		uint32 sizeClass = sSizeClasses[(size + kAlignment - 1) / kAlignment];
+		while (sizeClass < kClassCount && alignment > kAlignment
+			&& sClassSizes[sizeClass] % alignment != 0) {
+			sizeClass++;
+		}
+
+		if (sizeClass < kClassCount) {
+			ThreadHeap* heap = current_heap();
+			if (heap == NULL)
+				heap = create_heap();
+
+			if (heap != &sSharedHeap)
+				return allocate_object(heap, sizeClass);
+
+			mutex_lock(&sSharedHeapLock);
+			void* object = allocate_object(heap, sizeClass);
+			mutex_unlock(&sSharedHeapLock);
+			return object;
+		}
+	}
+
+	if (size <= kMaxLargeSize && alignment <= kMaxLargeAlignment) {
+		Span* span = page_heap_allocate(
+			max_c((size + B_PAGE_SIZE - 1) >> kPageShift, (size_t)1),
+			max_c(alignment >> kPageShift, (size_t)1), SPAN_LARGE);
+		return span != NULL ? (void*)span->base : NULL;
+	}
+
+	return huge_allocate(size, alignment);
+}
+
+
+void
+heap_free(void* address)
+{
+	if (!is_arena_address((addr_t)address)) {
+		huge_free(address);
+		return;
+	}
+
+	Span* span = span_for_address((addr_t)address);
+	if (span->type != SPAN_SMALL) {
+		if (span->type != SPAN_LARGE || span->base != (addr_t)address)
+			debugger("heap: invalid address");
+		else
+			page_heap_free(span);
+		return;
+	}
+
+	// Only the owner of a span may change its owner, so if it's us, it
+	// stays that way.
+	ThreadHeap* heap = current_heap();
+	if (heap == NULL || span->owner != heap) {
+		free_object_remotely(span, address);
+		return;
+	}
+
+	if (heap != &sSharedHeap) {
+		free_object(heap, span, address);
+		return;
+	}
+
+	mutex_lock(&sSharedHeapLock);
+	free_object(heap, span, address);
+	mutex_unlock(&sSharedHeapLock);
+}
+
+
+size_t
+heap_usable_size(void* address)
+{
+	if (!is_arena_address((addr_t)address))
+		return huge_usable_size(address);
+
+	Span* span = span_for_address((addr_t)address);
+	if (span->type == SPAN_SMALL)
+		return sClassSizes[span->size_class];
+
+	return (size_t)span->page_count * B_PAGE_SIZE;
+}
+
+
+/*!	Returns whether the allocation can hold \a size bytes without moving it.
+*/
+bool
+heap_resize(void* address, size_t size)
+{
+	if (!is_arena_address((addr_t)address))
+		return huge_resize(address, size);
+
+	return size <= heap_usable_size(address);
+}
+
+
+}	// namespace BPrivate
+
+
+using namespace BPrivate;
+
+
+extern "C" status_t
+__init_heap(void)
+{
+	init_size_classes();
+
+	mutex_init_etc(&sHeapLock, "heap", MUTEX_FLAG_ADAPTIVE);
+	mutex_init_etc(&sSharedHeapLock, "shared heap", MUTEX_FLAG_ADAPTIVE);
+	page_heap_init();
+
+	return B_OK;
+}
+
+
+extern "C" void
+__heap_terminate_after()
+{
+	// nothing to do
+}
+
+
+extern "C" void
+__heap_before_fork(void)
+{
+	mutex_lock(&sSharedHeapLock);
+	mutex_lock(&sHeapLock);
+	page_heap_lock();
+}
+
+
+extern "C" void
+__heap_after_fork_child(void)
+{
+	mutex_init_etc(&sHeapLock, "heap", MUTEX_FLAG_ADAPTIVE);
+	mutex_init_etc(&sSharedHeapLock, "shared heap", MUTEX_FLAG_ADAPTIVE);
+	page_heap_init();
+
+	// Only the forking thread survives, so the heaps of all other threads
+	// are abandoned, as if their threads had exited; our allocations will
+	// adopt their spans then. Only their owners changed those heaps, so
+	// they are consistent unless their thread was just in the middle of an
+	// allocation or free.
+	ThreadHeap* current = current_heap();
+	ThreadHeap* heap = sHeaps;
+	while (heap != NULL) {
+		ThreadHeap* next = heap->next;
+		if (heap != current)
+			abandon_heap(heap);
+		heap = next;
+	}
+}
+
+
+extern "C" void
+__heap_after_fork_parent(void)
+{
+	page_heap_unlock();
+	mutex_unlock(&sHeapLock);
+	mutex_unlock(&sSharedHeapLock);
+}
+
+
+extern "C" void
+__heap_thread_init(void)
+{
+	// heaps are created with the first allocation of a thread
+}
+
+
+extern "C" void
+__heap_thread_exit(void)
+{
+	ThreadHeap* heap = current_heap();
+	tls_set(TLS_MALLOC_SLOT, &sSharedHeap);
+
+	if (heap == NULL || heap == &sSharedHeap)
+		return;
+
+	abandon_heap(heap);
+}
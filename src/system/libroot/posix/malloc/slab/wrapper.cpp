@@ -0,0 +1,246 @@
+/*
+ * Copyright 2002-2026, Haiku Inc.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "Heap.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <errno_private.h>
+#include <user_thread.h>
+
+#include "tracing_config.h"
+
+using namespace BPrivate;
+
+
+#if USER_MALLOC_TRACING
+#	define KTRACE(format...)	ktrace_printf(format)
+#else
+#	define KTRACE(format...)	do {} while (false)
+#endif
+
+
+static inline void*
+allocate(size_t size, size_t alignment)
+{
+	defer_signals();
+	void* address = heap_allocate(size, alignment);
+	undefer_signals();
+
+	return address;
+}
+
+
+//	#pragma mark - public functions
+
+
+extern "C" void *
+malloc(size_t size)
+{
+	void *addr = allocate(size, kAlignment);
+	if (addr == NULL) {
+		__set_errno(B_NO_MEMORY);
+		KTRACE("malloc(%lu) -> NULL", size);
+		return NULL;
+	}
+
+	KTRACE("malloc(%lu) -> %p", size, addr);
+
+	return addr;
+}
+
+
+extern "C" void *
+calloc(size_t nelem, size_t elsize)
+{
+	size_t size = nelem * elsize;
+	void *ptr = NULL;
+
+	if ((nelem > 0) && ((size/nelem) != elsize))
+		goto nomem;
+
+	ptr = allocate(size, kAlignment);
+	if (ptr == NULL) {
+	nomem:
+		__set_errno(B_NO_MEMORY);
+		KTRACE("calloc(%lu, %lu) -> NULL", nelem, elsize);
+		return NULL;
+	}
+
+	// Zero out the malloc'd block, unless it got a fresh area of its own.
+	if (size <= kMaxLargeSize)
+		memset(ptr, 0, size);
+	KTRACE("calloc(%lu, %lu) -> %p", nelem, elsize, ptr);
+	return ptr;
+}
+
+
+extern "C" void
+free(void *ptr)
+{
+	KTRACE("free(%p)", ptr);
+
+	if (ptr == NULL)
+		return;
+
+	defer_signals();
+	heap_free(ptr);
+	undefer_signals();
+}
+
+
+extern "C" void *
+memalign(size_t alignment, size_t size)
+{
+	// round the alignment up to the next power of two
+	size_t powerOfTwo = kAlignment;
+	while (powerOfTwo < alignment && powerOfTwo != 0)
+		powerOfTwo <<= 1;
+
+	void *addr = powerOfTwo != 0 ? allocate(size, powerOfTwo) : NULL;
+	if (addr == NULL) {
+		__set_errno(B_NO_MEMORY);
+		KTRACE("memalign(%lu, %lu) -> NULL", alignment, size);
+		return NULL;
+	}
+
+	KTRACE("memalign(%lu, %lu) -> %p", alignment, size, addr);
+	return addr;
+}
+
+
+extern "C" void *
+aligned_alloc(size_t alignment, size_t size)
+{
+	if (size % alignment != 0) {
+		__set_errno(B_BAD_VALUE);
+		return NULL;
+	}
+	return memalign(alignment, size);
+}
+
+
+extern "C" int
+posix_memalign(void **_pointer, size_t alignment, size_t size)
+{
+	if ((alignment & (sizeof(void *) - 1)) != 0
+		|| (alignment & (alignment - 1)) != 0 || _pointer == NULL)
+		return B_BAD_VALUE;
+
+	void *pointer = allocate(size, max_c(alignment, kAlignment));
+	if (pointer == NULL) {
+		KTRACE("posix_memalign(%p, %lu, %lu) -> NULL", _pointer, alignment,
+			size);
+		return B_NO_MEMORY;
+	}
+
+	*_pointer = pointer;
+	KTRACE("posix_memalign(%p, %lu, %lu) -> %p", _pointer, alignment, size,
+		pointer);
+	return 0;
+}
+
+
+extern "C" void *
+valloc(size_t size)
+{
+	return memalign(B_PAGE_SIZE, size);
+}
+
+
+extern "C" void *
+realloc(void *ptr, size_t size)
+{
+	if (ptr == NULL)
+		return malloc(size);
+
+	if (size == 0) {
+		free(ptr);
+		return NULL;
+	}
+
+	// If the existing object can hold the new size, or can be resized in
+	// place, just return it.
+
+	defer_signals();
+	bool resized = heap_resize(ptr, size);
+	size_t objSize = resized ? 0 : heap_usable_size(ptr);
+	undefer_signals();
+
+	if (resized) {
+		KTRACE("realloc(%p, %lu) -> %p", ptr, size, ptr);
+		return ptr;
+	}
+
+	// Allocate a new block of size sz.
+	void *buffer = malloc(size);
+	if (buffer == NULL) {
+		// Allocation failed, leave old block and return
+		__set_errno(B_NO_MEMORY);
+		KTRACE("realloc(%p, %lu) -> NULL", ptr, size);
+		return NULL;
+	}
+
+	// Copy the contents of the original object
+	// up to the size of the new block.
+
+	size_t minSize = (objSize < size) ? objSize : size;
+	memcpy(buffer, ptr, minSize);
+
+	// Free the old block.
+	free(ptr);
+
+	// Return a pointer to the new one.
+	KTRACE("realloc(%p, %lu) -> %p", ptr, size, buffer);
+	return buffer;
+}
+
+
+extern "C" size_t
+malloc_usable_size(void *ptr)
+{
+	if (ptr == NULL)
+		return 0;
+	return heap_usable_size(ptr);
+}
+
+
+//	#pragma mark - BeOS specific extensions
+
+
+struct mstats {
+	size_t bytes_total;
+	size_t chunks_used;
+	size_t bytes_used;
+	size_t chunks_free;
+	size_t bytes_free;
+};
+
+
+extern "C" struct mstats mstats(void);
+
+extern "C" struct mstats
+mstats(void)
+{
+	// Note, the stats structure is not thread-safe, but it doesn't
+	// matter that much either. Objects that are cached in the spans of a
+	// thread count as used.
+	static struct mstats stats;
+
+	size_t total, freeSize, usedSpans, freeSpans;
+	page_heap_get_stats(total, freeSize, usedSpans, freeSpans);
+
+	size_t hugeSize = huge_total_size();
+
+	stats.bytes_total = total + hugeSize;
+	stats.chunks_used = usedSpans;
+	stats.bytes_used = total - freeSize + hugeSize;
+	stats.chunks_free = freeSpans;
+	stats.bytes_free = freeSize;
+
+	return stats;
+}
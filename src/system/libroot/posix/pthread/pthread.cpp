@@ -30,7 +30,10 @@ static pthread_attr pthread_attr_default = {
 	B_NORMAL_PRIORITY,
 	USER_STACK_SIZE,
 	USER_STACK_GUARD_SIZE,
-	NULL
+	NULL,
+	0,
+	0,
+	0
 };
 
 
@@ -197,6 +200,22 @@ pthread_create(pthread_t* _thread, const pthread_attr_t* attr,
 		return EAGAIN;
 	}
 
+	if (attr != NULL && (*attr)->deadline_runtime != 0) {
+		// the thread hasn't been resumed yet, so it will run with its
+		// reservation from the start
+		thread_deadline_params params;
+		params.runtime = (*attr)->deadline_runtime;
+		params.deadline = (*attr)->deadline;
+		params.period = (*attr)->deadline_period;
+
+		error = _kern_set_thread_deadline(thread->id, &params);
+		if (error != B_OK) {
+			kill_thread(thread->id);
+			free(thread);
+			return error == B_BUSY ? EAGAIN : error;
+		}
+	}
+
 	__set_stack_protection();
 	*_thread = thread;
 	resume_thread(thread->id);
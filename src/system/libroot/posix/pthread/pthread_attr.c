@@ -39,6 +39,9 @@ pthread_attr_init(pthread_attr_t *_attr)
 	attr->stack_size = USER_STACK_SIZE;
 	attr->guard_size = USER_STACK_GUARD_SIZE;
 	attr->stack_address = NULL;
+	attr->deadline_runtime = 0;
+	attr->deadline = 0;
+	attr->deadline_period = 0;
 
 	*_attr = attr;
 	return B_OK;
@@ -241,12 +244,57 @@ pthread_attr_setstack(pthread_attr_t *_attr, void *stackaddr,
 }
 
 
+int
+pthread_attr_getdeadline_np(const pthread_attr_t *_attr, bigtime_t *runtime,
+	bigtime_t *deadline, bigtime_t *period)
+{
+	pthread_attr *attr;
+
+	if (_attr == NULL || (attr = *_attr) == NULL || runtime == NULL
+		|| deadline == NULL || period == NULL) {
+		return B_BAD_VALUE;
+	}
+
+	*runtime = attr->deadline_runtime;
+	*deadline = attr->deadline;
+	*period = attr->deadline_period;
+
+	return 0;
+}
+
+
+int
+pthread_attr_setdeadline_np(pthread_attr_t *_attr, bigtime_t runtime,
+	bigtime_t deadline, bigtime_t period)
+{
+	pthread_attr *attr;
+
+	if (_attr == NULL || (attr = *_attr) == NULL)
+		return B_BAD_VALUE;
+
+	// whether the reservation can be admitted is only known when the thread
+	// is created
+	if (runtime < 0 || deadline < 0 || period < 0
+		|| (runtime != 0 && (runtime > period
+			|| (deadline != 0 && (runtime > deadline || deadline > period))))) {
+		return B_BAD_VALUE;
+	}
+
+	attr->deadline_runtime = runtime;
+	attr->deadline = deadline;
+	attr->deadline_period = period;
+
+	return 0;
+}
+
+
 int
 __pthread_attr_get_np(pthread_t thread, pthread_attr_t *_attr)
 {
 	pthread_attr *attr;
 	status_t status;
 	thread_info info;
+	struct thread_deadline_params deadlineParams;
 
 	if (_attr == NULL || (attr = *_attr) == NULL)
 		return B_BAD_VALUE;
@@ -265,6 +313,12 @@ __pthread_attr_get_np(pthread_t thread, pthread_attr_t *_attr)
 	// not in thread_info
 	attr->guard_size = 0;
 
+	if (_kern_get_thread_deadline(thread->id, &deadlineParams) == B_OK) {
+		attr->deadline_runtime = deadlineParams.runtime;
+		attr->deadline = deadlineParams.deadline;
+		attr->deadline_period = deadlineParams.period;
+	}
+
 	return 0;
 }
 
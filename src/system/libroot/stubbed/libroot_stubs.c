@@ -16,11 +16,7 @@ int _ZN8BPrivate7Libroot16gPosixLCTimeInfoE;
 int _ZN8BPrivate7Libroot16gPosixLocaleConvE;
 int _ZN8BPrivate7Libroot20gGlobalLocaleBackendE;
 int _ZN8BPrivate7Libroot23gGlobalLocaleDataBridgeE;
-int _ZN8BPrivate9hoardHeap10_sizeTableE;
-int _ZN8BPrivate9hoardHeap10_thresholdE;
-int _ZN8BPrivate9hoardHeap14_numProcessorsE;
-int _ZN8BPrivate9hoardHeap15fMaxThreadHeapsE;
-int _ZN8BPrivate9hoardHeap18_numProcessorsMaskE;
+int _ZN8BPrivate9gArenaMapE;
 int __ctype32_wctrans;
 int __ctype32_wctype;
 int __ctype_b;
@@ -275,7 +271,6 @@ void _Z13PBKDF2_SHA256PKhmS0_mmPhm() {}
 void _Z13crypto_scryptPKhmS0_mmjjPhm() {}
 void _Z16HMAC_SHA256_InitP15HMAC_SHA256_CTXPKvm() {}
 void _Z17HMAC_SHA256_FinalPhP15HMAC_SHA256_CTX() {}
-void _Z17__init_after_forkv() {}
 void _Z18HMAC_SHA256_UpdateP15HMAC_SHA256_CTXPKvm() {}
 void _Z18crypto_scrypt_smixPhmmPvS0_() {}
 void _Z20__pthread_mutex_lockP14_pthread_mutexjl() {}
@@ -316,33 +311,30 @@ void _ZN17EnvironmentFilter5_InitEiPKcmPKS1_m() {}
 void _ZN8BPrivate10AutoLockerI11LocalRWLockNS1_7LockingEE6UnlockEv() {}
 void _ZN8BPrivate10AutoLockerI5mutex12MutexLockingE6UnlockEv() {}
 void _ZN8BPrivate10AutoLockerIiNS_16UserGroupLockingEE6UnlockEv() {}
-void _ZN8BPrivate10hoardYieldEv() {}
-void _ZN8BPrivate10superblock14makeSuperblockEiPNS_11processHeapE() {}
-void _ZN8BPrivate10superblock8getBlockEv() {}
-void _ZN8BPrivate10superblockC1EiiPNS_9hoardHeapE() {}
-void _ZN8BPrivate10superblockC2EiiPNS_9hoardHeapE() {}
-void _ZN8BPrivate10threadHeap6mallocEm() {}
-void _ZN8BPrivate10threadHeap8memalignEmm() {}
-void _ZN8BPrivate10threadHeapC1Ev() {}
-void _ZN8BPrivate10threadHeapC2Ev() {}
-void _ZN8BPrivate11hoardUnlockER5mutex() {}
-void _ZN8BPrivate11hoardUnsbrkEPvl() {}
-void _ZN8BPrivate11processHeap4freeEPv() {}
-void _ZN8BPrivate11processHeap5statsEv() {}
-void _ZN8BPrivate11processHeapC1Ev() {}
-void _ZN8BPrivate11processHeapC2Ev() {}
+void _ZN8BPrivate11heap_resizeEPvm() {}
+void _ZN8BPrivate11huge_resizeEPvm() {}
 void _ZN8BPrivate13KMessageField10AddElementEPKvi() {}
 void _ZN8BPrivate13KMessageField11AddElementsEPKvii() {}
 void _ZN8BPrivate13KMessageField5SetToEPNS_8KMessageEi() {}
 void _ZN8BPrivate13KMessageField5UnsetEv() {}
 void _ZN8BPrivate13KMessageFieldC1Ev() {}
 void _ZN8BPrivate13KMessageFieldC2Ev() {}
-void _ZN8BPrivate13hoardLockInitER5mutexPKc() {}
+void _ZN8BPrivate13heap_allocateEmm() {}
+void _ZN8BPrivate13huge_allocateEmm() {}
+void _ZN8BPrivate14page_heap_freeEPNS_4SpanE() {}
+void _ZN8BPrivate14page_heap_initEv() {}
+void _ZN8BPrivate14page_heap_lockEv() {}
 void _ZN8BPrivate15get_launch_dataEPKcRNS_8KMessageE() {}
+void _ZN8BPrivate15huge_total_sizeEv() {}
 void _ZN8BPrivate15user_group_lockEv() {}
+void _ZN8BPrivate16heap_usable_sizeEPv() {}
+void _ZN8BPrivate16huge_usable_sizeEPv() {}
+void _ZN8BPrivate16page_heap_unlockEv() {}
 void _ZN8BPrivate16parse_group_lineEPcRS0_S1_RjPS0_Ri() {}
 void _ZN8BPrivate17parse_passwd_lineEPcRS0_S1_RjS2_S1_S1_S1_() {}
 void _ZN8BPrivate17user_group_unlockEv() {}
+void _ZN8BPrivate18page_heap_allocateEjjh() {}
+void _ZN8BPrivate19page_heap_get_statsERmS0_S0_S0_() {}
 void _ZN8BPrivate20copy_group_to_bufferEPK5groupPS0_Pcm() {}
 void _ZN8BPrivate20copy_group_to_bufferEPKcS1_jPKS1_iP5groupPcm() {}
 void _ZN8BPrivate21copy_passwd_to_bufferEPK6passwdPS0_Pcm() {}
@@ -350,8 +342,10 @@ void _ZN8BPrivate21copy_passwd_to_bufferEPKcS1_jjS1_S1_S1_P6passwdPcm() {}
 void _ZN8BPrivate21parse_shadow_pwd_lineEPcRS0_S1_RiS2_S2_S2_S2_S2_S2_() {}
 void _ZN8BPrivate22get_extended_team_infoEijRNS_8KMessageE() {}
 void _ZN8BPrivate22get_launch_daemon_portEv() {}
+void _ZN8BPrivate23reclaim_abandoned_spansEv() {}
 void _ZN8BPrivate25copy_shadow_pwd_to_bufferEPK4spwdPS0_Pcm() {}
 void _ZN8BPrivate25copy_shadow_pwd_to_bufferEPKcS1_iiiiiiiP4spwdPcm() {}
+void _ZN8BPrivate27page_heap_allocate_metadataEm() {}
 void _ZN8BPrivate29send_request_to_launch_daemonERNS_8KMessageES1_() {}
 void _ZN8BPrivate33get_registrar_authentication_portEv() {}
 void _ZN8BPrivate33set_registrar_authentication_portEi() {}
@@ -431,19 +425,8 @@ void _ZN8BPrivate8KMessageC2Ej() {}
 void _ZN8BPrivate8KMessageC2Ev() {}
 void _ZN8BPrivate8KMessageD1Ev() {}
 void _ZN8BPrivate8KMessageD2Ev() {}
-void _ZN8BPrivate9hoardHeap12initNumProcsEv() {}
-void _ZN8BPrivate9hoardHeap14moveSuperblockEPNS_10superblockEiii() {}
-void _ZN8BPrivate9hoardHeap16insertSuperblockEiPNS_10superblockEPNS_11processHeapE() {}
-void _ZN8BPrivate9hoardHeap16removeSuperblockEPNS_10superblockEi() {}
-void _ZN8BPrivate9hoardHeap19removeMaxSuperblockEi() {}
-void _ZN8BPrivate9hoardHeap23findAvailableSuperblockEiRPNS_5blockEPNS_11processHeapE() {}
-void _ZN8BPrivate9hoardHeap5reuseEi() {}
-void _ZN8BPrivate9hoardHeap7recycleEPNS_10superblockE() {}
-void _ZN8BPrivate9hoardHeap9freeBlockERPNS_5blockERPNS_10superblockEiPNS_11processHeapE() {}
-void _ZN8BPrivate9hoardHeapC1Ev() {}
-void _ZN8BPrivate9hoardHeapC2Ev() {}
-void _ZN8BPrivate9hoardLockER5mutex() {}
-void _ZN8BPrivate9hoardSbrkEl() {}
+void _ZN8BPrivate9heap_freeEPv() {}
+void _ZN8BPrivate9huge_freeEPv() {}
 void _ZN8DateMask10IsCompleteEv() {}
 void _ZN8DateMask7HasTimeEv() {}
 void _ZN9__gnu_cxx20recursive_init_errorC1Ev() {}
@@ -768,6 +751,7 @@ void __get_scheduler_mode() {}
 void __get_secondary_architectures() {}
 void __get_system_info() {}
 void __get_system_time_offset() {}
+void __get_thread_deadline() {}
 void __getc_unlocked() {}
 void __getdelim() {}
 void __getenv_reentrant() {}
@@ -902,6 +886,7 @@ void __rw_lock_write_unlock() {}
 void __seed48_r() {}
 void __set_scheduler_mode() {}
 void __set_stack_protection() {}
+void __set_thread_deadline() {}
 void __setjmp_save_sigs() {}
 void __setstate_r() {}
 void __sigaction() {}
@@ -1080,6 +1065,7 @@ void _itowa_lower_digits() {}
 void _itowa_upper_digits() {}
 void _kern_accept() {}
 void _kern_access() {}
+void _kern_acquire_port_buffer() {}
 void _kern_acquire_sem() {}
 void _kern_acquire_sem_etc() {}
 void _kern_analyze_scheduling() {}
@@ -1123,11 +1109,13 @@ void _kern_entry_ref_to_path() {}
 void _kern_estimate_max_scheduling_latency() {}
 void _kern_event_queue_create() {}
 void _kern_event_queue_select() {}
+void _kern_event_queue_setup_ring() {}
 void _kern_event_queue_wait() {}
 void _kern_exec() {}
 void _kern_exit_team() {}
 void _kern_exit_thread() {}
 void _kern_fcntl() {}
+void _kern_file_advice() {}
 void _kern_find_area() {}
 void _kern_find_disk_device() {}
 void _kern_find_disk_system() {}
@@ -1142,6 +1130,7 @@ void _kern_fsync() {}
 void _kern_generic_syscall() {}
 void _kern_get_area_info() {}
 void _kern_get_clock() {}
+void _kern_get_compressed_swap_stats() {}
 void _kern_get_cpu() {}
 void _kern_get_cpu_info() {}
 void _kern_get_cpu_topology_info() {}
@@ -1152,6 +1141,7 @@ void _kern_get_disk_system_info() {}
 void _kern_get_extended_team_info() {}
 void _kern_get_file_disk_device_path() {}
 void _kern_get_image_info() {}
+void _kern_get_large_page_stats() {}
 void _kern_get_memory_properties() {}
 void _kern_get_next_area_info() {}
 void _kern_get_next_disk_device_id() {}
@@ -1174,6 +1164,7 @@ void _kern_get_system_info() {}
 void _kern_get_team_info() {}
 void _kern_get_team_usage_info() {}
 void _kern_get_thread_affinity() {}
+void _kern_get_thread_deadline() {}
 void _kern_get_thread_info() {}
 void _kern_get_timer() {}
 void _kern_get_timezone() {}
@@ -1190,6 +1181,9 @@ void _kern_image_relocated() {}
 void _kern_initialize_partition() {}
 void _kern_install_default_debugger() {}
 void _kern_install_team_debugger() {}
+void _kern_io_ring_enter() {}
+void _kern_io_ring_register() {}
+void _kern_io_ring_setup() {}
 void _kern_ioctl() {}
 void _kern_is_computer_on() {}
 void _kern_kernel_debugger() {}
@@ -1234,6 +1228,7 @@ void _kern_read_fs_info() {}
 void _kern_read_index_stat() {}
 void _kern_read_kernel_image_symbols() {}
 void _kern_read_link() {}
+void _kern_read_port_buffer_etc() {}
 void _kern_read_port_etc() {}
 void _kern_read_stat() {}
 void _kern_readv() {}
@@ -1251,6 +1246,7 @@ void _kern_register_file_device() {}
 void _kern_register_image() {}
 void _kern_register_messaging_service() {}
 void _kern_register_syslog_daemon() {}
+void _kern_release_port_buffer() {}
 void _kern_release_sem() {}
 void _kern_release_sem_etc() {}
 void _kern_remove_attr() {}
@@ -1292,6 +1288,7 @@ void _kern_set_sem_owner() {}
 void _kern_set_signal_mask() {}
 void _kern_set_signal_stack() {}
 void _kern_set_thread_affinity() {}
+void _kern_set_thread_deadline() {}
 void _kern_set_thread_priority() {}
 void _kern_set_timer() {}
 void _kern_set_timezone() {}
@@ -1314,6 +1311,7 @@ void _kern_sockatmark() {}
 void _kern_socket() {}
 void _kern_socketpair() {}
 void _kern_spawn_thread() {}
+void _kern_splice() {}
 void _kern_start_watching() {}
 void _kern_start_watching_disks() {}
 void _kern_start_watching_system() {}
@@ -1354,6 +1352,7 @@ void _kern_wait_for_thread_etc() {}
 void _kern_write() {}
 void _kern_write_attr() {}
 void _kern_write_fs_info() {}
+void _kern_write_port_buffer_etc() {}
 void _kern_write_port_etc() {}
 void _kern_write_stat() {}
 void _kern_writev() {}
@@ -1841,6 +1840,7 @@ void get_secondary_architectures() {}
 void get_sem_count() {}
 void get_stack_frame() {}
 void get_system_info() {}
+void get_thread_deadline() {}
 void getc() {}
 void getc_unlocked() {}
 void getchar() {}
@@ -2205,6 +2205,7 @@ void psignal() {}
 void pthread_atfork() {}
 void pthread_attr_destroy() {}
 void pthread_attr_get_np() {}
+void pthread_attr_getdeadline_np() {}
 void pthread_attr_getdetachstate() {}
 void pthread_attr_getguardsize() {}
 void pthread_attr_getschedparam() {}
@@ -2212,6 +2213,7 @@ void pthread_attr_getscope() {}
 void pthread_attr_getstack() {}
 void pthread_attr_getstacksize() {}
 void pthread_attr_init() {}
+void pthread_attr_setdeadline_np() {}
 void pthread_attr_setdetachstate() {}
 void pthread_attr_setguardsize() {}
 void pthread_attr_setschedparam() {}
@@ -2422,6 +2424,7 @@ void set_real_time_clock() {}
 void set_scheduler_mode() {}
 void set_sem_owner() {}
 void set_signal_stack() {}
+void set_thread_deadline() {}
 void set_thread_priority() {}
 void setbuf() {}
 void setbuffer() {}
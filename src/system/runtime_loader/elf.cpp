@@ -25,6 +25,7 @@
 
 #include "add_ons.h"
 #include "elf_load_image.h"
+#include "elf_relocation_cache.h"
 #include "elf_symbol_lookup.h"
 #include "elf_tls.h"
 #include "elf_versioning.h"
@@ -194,6 +195,15 @@ load_immediate_dependencies(image_t *image, bool preload)
 	if (runpath == NULL)
 		rpath = find_dt_rpath(image);
 
+	if (image->num_needed - preloadedCount > 1) {
+		for (i = 0; d[i].d_tag != DT_NULL; i++) {
+			if (d[i].d_tag == DT_NEEDED) {
+				prefetch_image(STRING(image, d[i].d_un.d_val), rpath, runpath,
+					image->path);
+			}
+		}
+	}
+
 	for (i = 0, j = preloadedCount; d[i].d_tag != DT_NULL; i++) {
 		switch (d[i].d_tag) {
 			case DT_NEEDED:
@@ -279,9 +289,12 @@ load_dependencies(image_t* image, bool preload = false)
 
 
 static status_t
-relocate_image(image_t *rootImage, image_t *image)
+relocate_image(image_t *rootImage, image_t *image,
+	RelocationCache* relocationCache, uint32 index)
 {
 	SymbolLookupCache cache(image);
+	if (relocationCache != NULL)
+		relocationCache->Prime(index, &cache);
 
 	status_t status = arch_relocate_image(rootImage, image, &cache);
 	if (status < B_OK) {
@@ -289,14 +302,32 @@ relocate_image(image_t *rootImage, image_t *image)
 		return status;
 	}
 
+	if (relocationCache != NULL)
+		relocationCache->Record(index, &cache);
+
 	_kern_image_relocated(image->id);
 	image_event(image, IMAGE_EVENT_RELOCATED);
 	return B_OK;
 }
 
 
+/*!	Returns whether the symbols of the program can be resolved using the
+	relocation cache. It's not used for set-user-ID programs, as the cache
+	is stored with the user's rights, nor when add-ons may patch symbols.
+*/
+static bool
+use_relocation_cache()
+{
+	if (sPreloadedAddonCount > 0 || getenv("DISABLE_RELOCATION_CACHE") != NULL)
+		return false;
+
+	return _kern_getuid(true) == _kern_getuid(false)
+		&& _kern_getgid(true) == _kern_getgid(false);
+}
+
+
 static status_t
-relocate_dependencies(image_t *image)
+relocate_dependencies(image_t *image, bool useRelocationCache = false)
 {
 	// get the images that still have to be relocated
 	image_t **list;
@@ -304,15 +335,27 @@ relocate_dependencies(image_t *image)
 	if (count < B_OK)
 		return count;
 
+	// The cache can only be used when all loaded images are relocated at
+	// once, i.e. when the program is started.
+	RelocationCache relocationCache;
+	if (useRelocationCache && ((uint32)count != count_loaded_images()
+			|| !relocationCache.Init(image, list, count))) {
+		useRelocationCache = false;
+	}
+
 	// relocate
 	for (ssize_t i = 0; i < count; i++) {
-		status_t status = relocate_image(image, list[i]);
+		status_t status = relocate_image(image, list[i],
+			useRelocationCache ? &relocationCache : NULL, i);
 		if (status < B_OK) {
 			free(list);
 			return status;
 		}
 	}
 
+	if (useRelocationCache)
+		relocationCache.Store();
+
 	free(list);
 	return B_OK;
 }
@@ -565,7 +608,7 @@ load_program(char const *path, void **_entry)
 	// This results in the desired symbol resolution for dlopen()ed libraries.
 	set_image_flags_recursively(gProgramImage, RTLD_GLOBAL);
 
-	status = relocate_dependencies(gProgramImage);
+	status = relocate_dependencies(gProgramImage, use_relocation_cache());
 	if (status < B_OK)
 		goto err;
 
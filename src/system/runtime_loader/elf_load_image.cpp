@@ -10,6 +10,7 @@
 
 #include "elf_load_image.h"
 
+#include <fcntl.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -488,6 +489,31 @@ parse_elf64_header(Elf64_Ehdr* eheader, int32* _pheaderSize,
 #endif	// _COMPAT_MODE
 
 
+/*!	Asks the file cache to read the library \a name in the background, if
+	it hasn't been loaded yet. The arguments are the same as for load_image().
+	This allows the file cache to read all dependencies of an image
+	concurrently, while they are mapped one after the other.
+*/
+void
+prefetch_image(char const* name, const char* rpath, const char* runpath,
+	const char* requestingObjectPath)
+{
+	if (find_loaded_image_by_name(name, APP_OR_LIBRARY_TYPE) != NULL)
+		return;
+
+	char path[PATH_MAX];
+	strlcpy(path, name, sizeof(path));
+
+	int fd = open_executable(path, B_LIBRARY_IMAGE, rpath, runpath,
+		get_program_path(), requestingObjectPath, sSearchPathSubDir);
+	if (fd < 0)
+		return;
+
+	_kern_file_advice(fd, 0, 0, POSIX_FADV_WILLNEED);
+	_kern_close(fd);
+}
+
+
 status_t
 load_image(char const* name, image_type type, const char* rpath, const char* runpath,
 	const char* requestingObjectPath, image_t** _image)
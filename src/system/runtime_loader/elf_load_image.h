@@ -19,6 +19,8 @@ status_t	parse_elf64_header(Elf64_Ehdr* eheader, int32* _pheaderSize,
 	int32* _sheaderSize);
 	#endif
 #endif
+void		prefetch_image(char const* name, const char* rpath,
+				const char* runpath, const char* requestingObjectPath);
 status_t	load_image(char const* name, image_type type, const char* rpath,
 	const char* runpath, const char* requestingObjectPath, image_t** _image);
 
@@ -0,0 +1,433 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include "elf_relocation_cache.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <find_directory_private.h>
+#include <syscalls.h>
+
+#include "elf_symbol_lookup.h"
+
+
+static const uint32 kCacheMagic = 'RlCc';
+static const uint32 kCacheVersion = 1;
+static const char* const kCacheDirectory = "runtime_loader";
+
+
+struct relocation_cache_header {
+	uint32	magic;
+	uint32	version;
+	uint32	pointer_size;
+	uint32	image_count;
+	uint32	entry_count;
+	uint32	reserved;
+};
+
+struct relocation_cache_image {
+	int64	node;
+	int64	size;
+	int64	modified;
+	int32	modified_nsec;
+	int32	device;
+	uint32	entry_count;
+	uint32	reserved;
+};
+
+struct relocation_cache_entry {
+	uint32	symbol;
+	int32	image;
+		// index of the image defining the symbol, -1 if there is none
+	uint64	value;
+		// relative to the defining image, unless it's a TLS symbol
+};
+
+
+static bool
+is_tls_symbol(image_t* image, uint32 index)
+{
+	return image->syms[index].Type() == STT_TLS;
+}
+
+
+static void
+set_image_record(relocation_cache_image& record, const struct stat& stat,
+	uint32 entryCount)
+{
+	memset(&record, 0, sizeof(record));
+	record.node = stat.st_ino;
+	record.size = stat.st_size;
+	record.modified = stat.st_mtim.tv_sec;
+	record.modified_nsec = stat.st_mtim.tv_nsec;
+	record.device = stat.st_dev;
+	record.entry_count = entryCount;
+}
+
+
+//	#pragma mark -
+
+
+RelocationCache::RelocationCache()
+	:
+	fRootImage(NULL),
+	fImages(NULL),
+	fCount(0),
+	fStats(NULL),
+	fBuffer(NULL),
+	fEntries(NULL),
+	fEntryOffsets(NULL),
+	fRecorded(NULL),
+	fRecordedCounts(NULL),
+	fComplete(false)
+{
+}
+
+
+RelocationCache::~RelocationCache()
+{
+	if (fRecorded != NULL) {
+		for (uint32 i = 0; i < fCount; i++)
+			free(fRecorded[i]);
+	}
+
+	free(fRecorded);
+	free(fRecordedCounts);
+	free(fEntryOffsets);
+	free(fBuffer);
+	free(fStats);
+}
+
+
+/*!	Prepares the cache for relocating \a images, which must be all images
+	that are loaded, in the order they are going to be relocated in, with
+	\a rootImage being the program.
+	Returns \c false if the cache cannot be used for these images at all.
+	Otherwise it either has been loaded (IsValid()), or the resolved symbols
+	will be recorded during relocation, so that they can be stored afterwards.
+*/
+bool
+RelocationCache::Init(image_t* rootImage, image_t** images, uint32 count)
+{
+	if (count == 0)
+		return false;
+
+	// Symbol patchers may resolve symbols differently each time
+	for (uint32 i = 0; i < count; i++) {
+		if (images[i]->defined_symbol_patchers != NULL
+			|| images[i]->undefined_symbol_patchers != NULL) {
+			return false;
+		}
+	}
+
+	fStats = (struct stat*)malloc(count * sizeof(struct stat));
+	fRecorded = (relocation_cache_entry**)calloc(count,
+		sizeof(relocation_cache_entry*));
+	fRecordedCounts = (uint32*)calloc(count, sizeof(uint32));
+	if (fStats == NULL || fRecorded == NULL || fRecordedCounts == NULL)
+		return false;
+
+	for (uint32 i = 0; i < count; i++) {
+		if (_kern_read_stat(AT_FDCWD, images[i]->path, true, &fStats[i],
+				sizeof(struct stat)) != B_OK) {
+			return false;
+		}
+	}
+
+	fRootImage = rootImage;
+	fImages = images;
+	fCount = count;
+	fComplete = true;
+
+	if (_Load() != B_OK) {
+		free(fBuffer);
+		fBuffer = NULL;
+		fEntries = NULL;
+	}
+
+	return true;
+}
+
+
+/*!	Fills \a cache with the symbols of image \a index as they had been
+	resolved the last time, if the cache is valid.
+*/
+void
+RelocationCache::Prime(uint32 index, SymbolLookupCache* cache)
+{
+	if (!IsValid())
+		return;
+
+	image_t* image = fImages[index];
+	uint32 symbolCount = cache->TableSize();
+	relocation_cache_entry* entries = fEntries + fEntryOffsets[index];
+	uint32 entryCount = fEntryOffsets[index + 1] - fEntryOffsets[index];
+
+	for (uint32 i = 0; i < entryCount; i++) {
+		const relocation_cache_entry& entry = entries[i];
+		if (entry.symbol >= symbolCount || entry.image >= (int32)fCount)
+			continue;
+
+		image_t* symbolImage = entry.image >= 0 ? fImages[entry.image] : NULL;
+		addr_t value = (addr_t)entry.value;
+		if (symbolImage != NULL && !is_tls_symbol(image, entry.symbol))
+			value += symbolImage->regions[0].delta;
+
+		cache->SetSymbolValueAt(entry.symbol, value, symbolImage);
+	}
+}
+
+
+/*!	Remembers the symbols resolved while relocating image \a index, unless
+	the cache is valid already.
+*/
+void
+RelocationCache::Record(uint32 index, const SymbolLookupCache* cache)
+{
+	if (IsValid() || !fComplete)
+		return;
+
+	image_t* image = fImages[index];
+	uint32 symbolCount = cache->TableSize();
+
+	uint32 entryCount = 0;
+	for (uint32 i = 0; i < symbolCount; i++) {
+		if (cache->IsSymbolValueCached(i))
+			entryCount++;
+	}
+
+	relocation_cache_entry* entries = (relocation_cache_entry*)malloc(
+		(entryCount > 0 ? entryCount : 1) * sizeof(relocation_cache_entry));
+	if (entries == NULL) {
+		fComplete = false;
+		return;
+	}
+
+	fRecorded[index] = entries;
+	fRecordedCounts[index] = entryCount;
+
+	for (uint32 i = 0; i < symbolCount; i++) {
+		if (!cache->IsSymbolValueCached(i))
+			continue;
+
+		image_t* symbolImage;
+		addr_t value = cache->SymbolValueAt(i, &symbolImage);
+
+		int32 symbolIndex = -1;
+		if (symbolImage != NULL) {
+			symbolIndex = _IndexOf(symbolImage);
+			if (symbolIndex < 0) {
+				// we can only refer to the images we know about
+				fComplete = false;
+				return;
+			}
+			if (!is_tls_symbol(image, i))
+				value -= symbolImage->regions[0].delta;
+		}
+
+		entries->symbol = i;
+		entries->image = symbolIndex;
+		entries->value = value;
+		entries++;
+	}
+}
+
+
+/*!	Writes the recorded symbols to the cache file, if all images have been
+	relocated successfully. Failing to do so is not an error; the cache is
+	just not used next time either.
+*/
+void
+RelocationCache::Store()
+{
+	if (IsValid() || !fComplete)
+		return;
+
+	relocation_cache_header header;
+	memset(&header, 0, sizeof(header));
+	header.magic = kCacheMagic;
+	header.version = kCacheVersion;
+	header.pointer_size = sizeof(addr_t);
+	header.image_count = fCount;
+
+	for (uint32 i = 0; i < fCount; i++) {
+		if (fRecorded[i] == NULL)
+			return;
+		header.entry_count += fRecordedCounts[i];
+	}
+
+	char path[B_PATH_NAME_LENGTH];
+	if (_GetPath(path, sizeof(path), true) != B_OK)
+		return;
+
+	// write to a temporary file first, so that a concurrent launch of the
+	// same program never sees a partial cache
+	char tempPath[B_PATH_NAME_LENGTH];
+	snprintf(tempPath, sizeof(tempPath), "%s.%" B_PRId32, path,
+		_kern_get_current_team());
+
+	int fd = _kern_open(AT_FDCWD, tempPath, O_WRONLY | O_CREAT | O_TRUNC,
+		0644);
+	if (fd < 0)
+		return;
+
+	off_t offset = 0;
+	bool success = _kern_write(fd, offset, &header, sizeof(header))
+		== (ssize_t)sizeof(header);
+	offset += sizeof(header);
+
+	for (uint32 i = 0; success && i < fCount; i++) {
+		relocation_cache_image record;
+		set_image_record(record, fStats[i], fRecordedCounts[i]);
+		success = _kern_write(fd, offset, &record, sizeof(record))
+			== (ssize_t)sizeof(record);
+		offset += sizeof(record);
+	}
+
+	for (uint32 i = 0; success && i < fCount; i++) {
+		size_t size = fRecordedCounts[i] * sizeof(relocation_cache_entry);
+		if (size == 0)
+			continue;
+
+		success = _kern_write(fd, offset, fRecorded[i], size)
+			== (ssize_t)size;
+		offset += size;
+	}
+
+	_kern_close(fd);
+
+	if (!success || _kern_rename(AT_FDCWD, tempPath, AT_FDCWD, path) != B_OK)
+		_kern_unlink(AT_FDCWD, tempPath);
+	else
+		KTRACE("rld: stored relocation cache %s", path);
+}
+
+
+/*!	The cache file is named after a hash of the program's path; the
+	contents identify the exact images it is valid for.
+*/
+status_t
+RelocationCache::_GetPath(char* path, size_t size, bool create)
+{
+	status_t status = __find_directory(B_USER_CACHE_DIRECTORY, -1, create,
+		path, size);
+	if (status != B_OK)
+		return status;
+
+	size_t length = strlen(path);
+	if (snprintf(path + length, size - length, "/%s", kCacheDirectory)
+			>= (int)(size - length)) {
+		return B_NAME_TOO_LONG;
+	}
+
+	if (create)
+		_kern_create_dir(AT_FDCWD, path, 0755);
+
+	length = strlen(path);
+	if (snprintf(path + length, size - length, "/%08" B_PRIx32,
+			elf_gnuhash(fRootImage->path)) >= (int)(size - length)) {
+		return B_NAME_TOO_LONG;
+	}
+
+	return B_OK;
+}
+
+
+status_t
+RelocationCache::_Load()
+{
+	char path[B_PATH_NAME_LENGTH];
+	status_t status = _GetPath(path, sizeof(path), false);
+	if (status != B_OK)
+		return status;
+
+	int fd = _kern_open(AT_FDCWD, path, O_RDONLY, 0);
+	if (fd < 0)
+		return fd;
+
+	struct stat stat;
+	status = _kern_read_stat(fd, NULL, false, &stat, sizeof(struct stat));
+	if (status == B_OK && (stat.st_size < (off_t)sizeof(relocation_cache_header)
+			|| stat.st_size > 64 * 1024 * 1024)) {
+		status = B_BAD_DATA;
+	}
+
+	if (status == B_OK) {
+		fBuffer = (uint8*)malloc(stat.st_size);
+		if (fBuffer == NULL)
+			status = B_NO_MEMORY;
+	}
+
+	if (status == B_OK && _kern_read(fd, 0, fBuffer, stat.st_size)
+			!= stat.st_size) {
+		status = B_IO_ERROR;
+	}
+
+	_kern_close(fd);
+
+	if (status != B_OK)
+		return status;
+
+	// validate the header and the images
+
+	relocation_cache_header* header = (relocation_cache_header*)fBuffer;
+	if (header->magic != kCacheMagic || header->version != kCacheVersion
+		|| header->pointer_size != sizeof(addr_t)
+		|| header->image_count != fCount) {
+		return B_MISMATCHED_VALUES;
+	}
+	if (header->entry_count > stat.st_size / sizeof(relocation_cache_entry))
+		return B_BAD_DATA;
+
+	size_t expectedSize = sizeof(relocation_cache_header)
+		+ fCount * sizeof(relocation_cache_image)
+		+ (size_t)header->entry_count * sizeof(relocation_cache_entry);
+	if ((off_t)expectedSize != stat.st_size)
+		return B_BAD_DATA;
+
+	fEntryOffsets = (uint32*)malloc((fCount + 1) * sizeof(uint32));
+	if (fEntryOffsets == NULL)
+		return B_NO_MEMORY;
+
+	relocation_cache_image* records = (relocation_cache_image*)(header + 1);
+	uint32 entryOffset = 0;
+
+	for (uint32 i = 0; i < fCount; i++) {
+		relocation_cache_image expected;
+		set_image_record(expected, fStats[i], records[i].entry_count);
+		if (memcmp(&expected, &records[i], sizeof(expected)) != 0) {
+			KTRACE("rld: relocation cache %s is stale: %s changed", path,
+				fImages[i]->path);
+			return B_MISMATCHED_VALUES;
+		}
+
+		fEntryOffsets[i] = entryOffset;
+		entryOffset += records[i].entry_count;
+		if (entryOffset > header->entry_count)
+			return B_BAD_DATA;
+	}
+	fEntryOffsets[fCount] = entryOffset;
+
+	fEntries = (relocation_cache_entry*)(records + fCount);
+
+	KTRACE("rld: using relocation cache %s", path);
+	return B_OK;
+}
+
+
+int32
+RelocationCache::_IndexOf(image_t* image) const
+{
+	for (uint32 i = 0; i < fCount; i++) {
+		if (fImages[i] == image)
+			return i;
+	}
+
+	return -1;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef ELF_RELOCATION_CACHE_H
+#define ELF_RELOCATION_CACHE_H
+
+#include <sys/stat.h>
+
+#include "runtime_loader_private.h"
+
+
+struct relocation_cache_entry;
+
+
+/*!	Remembers how the symbols of a program and its libraries were resolved,
+	so that the next launch of the same program with the very same set of
+	images doesn't have to look them up again.
+
+	The cache is stored in the user's cache directory, one file per program.
+	It is only valid as long as none of the images changed; every resolved
+	value is kept relative to the image that defines the symbol, so that it
+	doesn't depend on where the images are mapped.
+*/
+class RelocationCache {
+public:
+								RelocationCache();
+								~RelocationCache();
+
+			bool				Init(image_t* rootImage, image_t** images,
+									uint32 count);
+			bool				IsValid() const	{ return fEntries != NULL; }
+
+			void				Prime(uint32 index, SymbolLookupCache* cache);
+			void				Record(uint32 index,
+									const SymbolLookupCache* cache);
+			void				Store();
+
+private:
+			status_t			_GetPath(char* path, size_t size,
+									bool create);
+			status_t			_Load();
+			int32				_IndexOf(image_t* image) const;
+
+private:
+			image_t*			fRootImage;
+			image_t**			fImages;
+			uint32				fCount;
+			struct stat*		fStats;
+			uint8*				fBuffer;
+			relocation_cache_entry* fEntries;
+			uint32*				fEntryOffsets;
+			relocation_cache_entry** fRecorded;
+			uint32*				fRecordedCounts;
+			bool				fComplete;
+};
+
+
+#endif	// ELF_RELOCATION_CACHE_H
@@ -14,6 +14,8 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include "add_ons.h"
 #include "errors.h"
 #include "images.h"
@@ -71,6 +73,32 @@ elf_gnuhash(const char* _name)
 }
 
 
+/*!	Returns the number of entries in the dynamic symbol table of \a image.
+	Only the SysV hash table stores it directly; with just a GNU hash table,
+	the end of the longest chain has to be looked up.
+*/
+uint32
+elf_symbol_count(const image_t* image)
+{
+	if (image->symhash != NULL)
+		return image->symhash[1];
+	if (image->gnuhash.buckets == NULL)
+		return 0;
+
+	uint32 last = 0;
+	for (uint32 i = 0; i < image->gnuhash.bucket_count; i++)
+		last = std::max(last, image->gnuhash.buckets[i]);
+	if (last == 0)
+		return 0;
+
+	const uint32* chain0 = image->gnuhash.chain0;
+	while ((chain0[last] & 1) == 0)
+		last++;
+
+	return last + 1;
+}
+
+
 struct match_result {
 	elf_sym* symbol;
 	elf_sym* versioned_symbol;
@@ -268,6 +296,183 @@ find_symbol(image_t* image, const SymbolLookupInfo& lookupInfo)
 }
 
 
+// #pragma mark - global symbol cache
+
+
+/*!	The global symbol cache remembers for a symbol the first image in load
+	order that defines it and is part of the global scope, i.e. is neither an
+	add-on nor loaded with RTLD_LOCAL. Since images are always appended to the
+	load order, such an entry stays valid when other images are loaded; it
+	only has to be flushed when an image is unloaded, or an image that has
+	been loaded before becomes part of the global scope.
+	Symbols that could not be found are not cached.
+*/
+struct global_symbol {
+	uint32					generation;
+	uint32					hash;
+	const char*				name;
+	const elf_version_info*	version;
+	int32					type;
+	uint32					flags;
+	image_t*				image;
+	elf_sym*				symbol;
+};
+
+static const uint32 kMinGlobalSymbolCacheSize = 1024;
+
+static global_symbol* sGlobalSymbols = NULL;
+static uint32 sGlobalSymbolsSize = 0;
+static uint32 sGlobalSymbolsCount = 0;
+static uint32 sGlobalSymbolsGeneration = 1;
+
+
+static inline bool
+is_in_global_scope(const image_t* image)
+{
+	return image->type != B_ADD_ON_IMAGE && (image->flags & RTLD_GLOBAL) != 0;
+}
+
+
+static uint32
+global_symbol_hash(const SymbolLookupInfo& lookupInfo)
+{
+	if (lookupInfo.gnuhash == 0)
+		const_cast<uint32&>(lookupInfo.gnuhash) = elf_gnuhash(lookupInfo.name);
+
+	uint32 hash = lookupInfo.gnuhash;
+	if (lookupInfo.version != NULL)
+		hash ^= lookupInfo.version->hash * 31;
+	return hash;
+}
+
+
+static bool
+global_symbol_matches(const global_symbol& entry, uint32 hash,
+	const SymbolLookupInfo& lookupInfo)
+{
+	if (entry.hash != hash || entry.type != lookupInfo.type
+		|| entry.flags != lookupInfo.flags
+		|| strcmp(entry.name, lookupInfo.name) != 0) {
+		return false;
+	}
+
+	const elf_version_info* version = lookupInfo.version;
+	if (entry.version == version)
+		return true;
+	if (entry.version == NULL || version == NULL
+		|| entry.version->hash != version->hash
+		|| strcmp(entry.version->name, version->name) != 0) {
+		return false;
+	}
+
+	// the file name only matters for images without version information,
+	// see match_symbol()
+	if (entry.version->file_name == NULL || version->file_name == NULL)
+		return entry.version->file_name == version->file_name;
+	return strcmp(entry.version->file_name, version->file_name) == 0;
+}
+
+
+static elf_sym*
+lookup_global_symbol(const SymbolLookupInfo& lookupInfo, image_t** _image)
+{
+	if (sGlobalSymbolsCount == 0)
+		return NULL;
+
+	uint32 hash = global_symbol_hash(lookupInfo);
+	uint32 mask = sGlobalSymbolsSize - 1;
+
+	for (uint32 index = hash & mask; true; index = (index + 1) & mask) {
+		global_symbol& entry = sGlobalSymbols[index];
+		if (entry.generation != sGlobalSymbolsGeneration)
+			return NULL;
+
+		if (global_symbol_matches(entry, hash, lookupInfo)) {
+			*_image = entry.image;
+			return entry.symbol;
+		}
+	}
+}
+
+
+static void
+resize_global_symbols()
+{
+	uint32 newSize = std::max(sGlobalSymbolsSize * 2,
+		kMinGlobalSymbolCacheSize);
+	global_symbol* symbols = (global_symbol*)calloc(newSize,
+		sizeof(global_symbol));
+	if (symbols == NULL)
+		return;
+
+	uint32 mask = newSize - 1;
+	for (uint32 i = 0; i < sGlobalSymbolsSize; i++) {
+		global_symbol& entry = sGlobalSymbols[i];
+		if (entry.generation != sGlobalSymbolsGeneration)
+			continue;
+
+		uint32 index = entry.hash & mask;
+		while (symbols[index].generation == sGlobalSymbolsGeneration)
+			index = (index + 1) & mask;
+		symbols[index] = entry;
+	}
+
+	free(sGlobalSymbols);
+	sGlobalSymbols = symbols;
+	sGlobalSymbolsSize = newSize;
+}
+
+
+static void
+add_global_symbol(const SymbolLookupInfo& lookupInfo, image_t* image,
+	elf_sym* symbol)
+{
+	if (2 * (sGlobalSymbolsCount + 1) > sGlobalSymbolsSize) {
+		resize_global_symbols();
+		if (2 * (sGlobalSymbolsCount + 1) > sGlobalSymbolsSize)
+			return;
+	}
+
+	uint32 hash = global_symbol_hash(lookupInfo);
+	uint32 mask = sGlobalSymbolsSize - 1;
+	uint32 index = hash & mask;
+	while (sGlobalSymbols[index].generation == sGlobalSymbolsGeneration)
+		index = (index + 1) & mask;
+
+	global_symbol& entry = sGlobalSymbols[index];
+	entry.generation = sGlobalSymbolsGeneration;
+	entry.hash = hash;
+	entry.name = lookupInfo.name;
+	entry.version = lookupInfo.version;
+	entry.type = lookupInfo.type;
+	entry.flags = lookupInfo.flags;
+	entry.image = image;
+	entry.symbol = symbol;
+	sGlobalSymbolsCount++;
+}
+
+
+/*!	Invalidates all entries of the global symbol cache. The entries refer to
+	the names and version infos of the images that looked them up, as well
+	as to the images defining them.
+*/
+void
+flush_global_symbol_cache()
+{
+	if (sGlobalSymbolsCount == 0)
+		return;
+
+	sGlobalSymbolsCount = 0;
+	if (++sGlobalSymbolsGeneration == 0) {
+		memset(sGlobalSymbols, 0, sGlobalSymbolsSize * sizeof(global_symbol));
+		sGlobalSymbolsGeneration = 1;
+	}
+}
+
+
+// #pragma mark -
+
+
 void
 patch_defined_symbol(image_t* image, const char* name, void** symbol,
 	int32* type)
@@ -443,14 +648,34 @@ find_undefined_symbol_global(image_t* rootImage, image_t* image,
 		}
 	}
 
+	// The global symbol cache can be used, unless the root image is part of
+	// the global scope, but is skipped here.
+	bool useCache = !symbolic || !is_in_global_scope(rootImage);
+	image_t* cachedImage = NULL;
+	elf_sym* cachedSymbol = useCache
+		? lookup_global_symbol(lookupInfo, &cachedImage) : NULL;
+
 	image_t* otherImage = get_loaded_images().head;
 	while (otherImage != NULL) {
-		if (otherImage == rootImage
+		if (otherImage == cachedImage) {
+			*_foundInImage = cachedImage;
+			return cachedSymbol;
+		}
+
+		// With a cached symbol, only the images outside of the global scope
+		// have to be checked.
+		if ((otherImage == rootImage
 				? !symbolic
 				: (otherImage->type != B_ADD_ON_IMAGE
 					&& (otherImage->flags
-						& (RTLD_GLOBAL | RFLAG_USE_FOR_RESOLVING)) != 0)) {
+						& (RTLD_GLOBAL | RFLAG_USE_FOR_RESOLVING)) != 0))
+			&& (cachedImage == NULL || !is_in_global_scope(otherImage))) {
 			if (elf_sym* symbol = find_symbol(otherImage, lookupInfo)) {
+				if (useCache && cachedImage == NULL
+					&& is_in_global_scope(otherImage)) {
+					add_global_symbol(lookupInfo, otherImage, symbol);
+				}
+
 				*_foundInImage = otherImage;
 				return symbol;
 			}
@@ -514,13 +739,35 @@ find_undefined_symbol_add_on(image_t* rootImage, image_t* image,
 		}
 	}
 
+	// A symbol from the global symbol cache can only be used, if it isn't
+	// weak, as a non-weak one defined later would be preferred otherwise.
+	bool useCache = !is_in_global_scope(rootImage);
+	image_t* cachedImage = NULL;
+	elf_sym* cachedSymbol = useCache
+		? lookup_global_symbol(lookupInfo, &cachedImage) : NULL;
+	bool globalSymbolFound = cachedSymbol != NULL;
+	if (cachedSymbol != NULL && cachedSymbol->Bind() == STB_WEAK)
+		cachedImage = NULL;
+
 	image_t* otherImage = get_loaded_images().head;
 	while (otherImage != NULL) {
+		if (otherImage == cachedImage) {
+			*_foundInImage = cachedImage;
+			return cachedSymbol;
+		}
+
 		if (otherImage != rootImage
 			&& otherImage->type != B_ADD_ON_IMAGE
 			&& (otherImage->flags
-				& (RTLD_GLOBAL | RFLAG_USE_FOR_RESOLVING)) != 0) {
+				& (RTLD_GLOBAL | RFLAG_USE_FOR_RESOLVING)) != 0
+			&& (cachedImage == NULL || !is_in_global_scope(otherImage))) {
 			if (elf_sym* symbol = find_symbol(otherImage, lookupInfo)) {
+				if (useCache && !globalSymbolFound
+					&& is_in_global_scope(otherImage)) {
+					add_global_symbol(lookupInfo, otherImage, symbol);
+					globalSymbolFound = true;
+				}
+
 				if (symbol->Bind() != STB_WEAK) {
 					*_foundInImage = otherImage;
 					return symbol;
@@ -18,6 +18,7 @@
 
 uint32 elf_hash(const char* name);
 uint32 elf_gnuhash(const char* name);
+uint32 elf_symbol_count(const image_t* image);
 
 
 struct SymbolLookupInfo {
@@ -47,7 +48,7 @@ struct SymbolLookupInfo {
 struct SymbolLookupCache {
 	SymbolLookupCache(image_t* image)
 		:
-		fTableSize(image->symhash != NULL ? image->symhash[1] : 0),
+		fTableSize(elf_symbol_count(image)),
 		fValues(NULL),
 		fDSOs(NULL),
 		fValuesResolved(NULL)
@@ -80,6 +81,11 @@ struct SymbolLookupCache {
 		free(fDSOs);
 	}
 
+	size_t TableSize() const
+	{
+		return fTableSize;
+	}
+
 	bool IsSymbolValueCached(size_t index) const
 	{
 		return index < fTableSize
@@ -121,6 +127,8 @@ void		patch_undefined_symbol(image_t* rootImage, image_t* image,
 				const char* name, image_t** foundInImage, void** symbol,
 				int32* type);
 
+void		flush_global_symbol_cache();
+
 elf_sym*	find_symbol(image_t* image, const SymbolLookupInfo& lookupInfo);
 status_t	find_symbol(image_t* image, const SymbolLookupInfo& lookupInfo,
 				void** _location);
@@ -10,6 +10,7 @@
 
 #include "images.h"
 
+#include <dlfcn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,6 +22,7 @@
 #include <vm_defs.h>
 
 #include "add_ons.h"
+#include "elf_symbol_lookup.h"
 #include "elf_tls.h"
 #include "runtime_loader_private.h"
 
@@ -146,10 +148,22 @@ update_image_flags_recursively(image_t* image, uint32 flagsToSet,
 	}
 
 	// update flags
+	bool globalScopeChanged = false;
 	for (uint32 i = 0; i < count; i++) {
+		// Images that haven't been relocated yet have just been loaded, and
+		// are therefore behind all symbols in the global symbol cache.
+		if ((flagsToSet & RTLD_GLOBAL) != 0
+			&& (queue[i]->flags & (RTLD_GLOBAL | RFLAG_RELOCATED))
+				== RFLAG_RELOCATED) {
+			globalScopeChanged = true;
+		}
+
 		queue[i]->flags = (queue[i]->flags | flagsToSet)
 			& ~(flagsToClear | RFLAG_VISITED);
 	}
+
+	if (globalScopeChanged)
+		flush_global_symbol_cache();
 }
 
 
@@ -235,6 +249,8 @@ delete_image_struct(image_t* image)
 		+ (image->num_regions - 1) * sizeof(elf_region_t);
 	memset(image->needed, 0xa5, sizeof(image->needed[0]) * image->num_needed);
 #endif
+	flush_global_symbol_cache();
+
 	free(image->needed);
 	free(image->versions);
 
@@ -280,6 +296,7 @@ put_image(image_t* image)
 		dequeue_image(&sLoadedImages, image);
 		enqueue_image(&sDisposableImages, image);
 		sLoadedImageCount--;
+		flush_global_symbol_cache();
 
 		// If the image wasn't fully loaded, its NEEDED may be incomplete.
 		if (image->needed == NULL)
@@ -597,6 +614,7 @@ dequeue_loaded_image(image_t* image)
 {
 	dequeue_image(&sLoadedImages, image);
 	sLoadedImageCount--;
+	flush_global_symbol_cache();
 }
 
 
@@ -63,6 +63,9 @@ static void _rw_lock_write_unlock_threads_locked(rw_lock* lock);
 static status_t _mutex_lock_threads_locked(mutex* lock);
 static void _mutex_unlock_threads_locked(mutex* lock);
 
+// lock statistics are never collected in the emulation
+int32 gLockStatsEnabled = 0;
+
 
 /*!	Helper class playing the role of the kernel's thread spinlock. We don't use
 	as spinlock as that could be expensive in userland (due to spinlock holder
@@ -296,6 +299,8 @@ rw_lock_init(rw_lock* lock, const char* name)
 	lock->active_readers = 0;
 	lock->pending_readers = 0;
 	lock->flags = 0;
+	lock->owner_cpu = -1;
+	lock->owner_stack = NULL;
 }
 
 
@@ -310,6 +315,8 @@ rw_lock_init_etc(rw_lock* lock, const char* name, uint32 flags)
 	lock->active_readers = 0;
 	lock->pending_readers = 0;
 	lock->flags = flags & RW_LOCK_FLAG_CLONE_NAME;
+	lock->owner_cpu = -1;
+	lock->owner_stack = NULL;
 }
 
 
@@ -607,6 +614,8 @@ mutex_init(mutex* lock, const char *name)
 	lock->count = 0;
 #endif
 	lock->flags = 0;
+	lock->owner_cpu = -1;
+	lock->owner_stack = NULL;
 }
 
 
@@ -621,6 +630,8 @@ mutex_init_etc(mutex* lock, const char *name, uint32 flags)
 	lock->count = 0;
 #endif
 	lock->flags = flags & MUTEX_FLAG_CLONE_NAME;
+	lock->owner_cpu = -1;
+	lock->owner_stack = NULL;
 }
 
 
@@ -801,6 +812,12 @@ _mutex_unlock(mutex* lock)
 }
 
 
+void
+_lock_stats_released(const void* lock)
+{
+}
+
+
 #undef mutex_trylock
 status_t
 mutex_trylock(mutex* lock)
@@ -829,6 +846,26 @@ mutex_lock(mutex* lock)
 }
 
 
+#if !KDEBUG
+
+
+status_t
+_mutex_lock_stats(mutex* lock)
+{
+	return mutex_lock(lock);
+}
+
+
+status_t
+_mutex_trylock_stats(mutex* lock)
+{
+	return mutex_trylock(lock);
+}
+
+
+#endif	// !KDEBUG
+
+
 #undef mutex_unlock
 void
 mutex_unlock(mutex* lock)
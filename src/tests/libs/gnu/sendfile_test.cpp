@@ -0,0 +1,221 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+static const size_t kFileSize = 3 * 1024 * 1024 + 123;
+
+
+static char
+pattern(off_t offset)
+{
+	return (char)(offset * 7 + offset / 4096);
+}
+
+
+static bool
+check_data(const char* test, const char* data, off_t offset, size_t length)
+{
+	for (size_t i = 0; i < length; i++) {
+		if (data[i] != pattern(offset + i)) {
+			fprintf(stderr, "%s: data mismatch at offset %lld\n", test,
+				(long long)(offset + i));
+			return false;
+		}
+	}
+	return true;
+}
+
+
+static bool
+read_all(int fd, char* buffer, size_t length)
+{
+	while (length > 0) {
+		ssize_t bytesRead = read(fd, buffer, length);
+		if (bytesRead <= 0)
+			return false;
+		buffer += bytesRead;
+		length -= bytesRead;
+	}
+	return true;
+}
+
+
+/*!	Creates a connected pair of TCP sockets over the loopback interface;
+	unlike local sockets, they take the file cache pages without copying.
+*/
+static bool
+tcp_socket_pair(int sockets[2])
+{
+	int listener = socket(AF_INET, SOCK_STREAM, 0);
+	if (listener < 0)
+		return false;
+
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_len = sizeof(address);
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t addressLength = sizeof(address);
+
+	bool success = bind(listener, (sockaddr*)&address, sizeof(address)) == 0
+		&& listen(listener, 1) == 0
+		&& getsockname(listener, (sockaddr*)&address, &addressLength) == 0;
+	if (success) {
+		sockets[1] = socket(AF_INET, SOCK_STREAM, 0);
+		success = sockets[1] >= 0
+			&& connect(sockets[1], (sockaddr*)&address, sizeof(address)) == 0;
+	}
+	if (success) {
+		sockets[0] = accept(listener, NULL, NULL);
+		success = sockets[0] >= 0;
+	}
+
+	close(listener);
+	return success;
+}
+
+
+static bool
+test_file_to_socket(int file)
+{
+	int sockets[2];
+	if (!tcp_socket_pair(sockets)) {
+		perror("tcp_socket_pair");
+		return false;
+	}
+
+	// send an unaligned range from a child, so that we can read concurrently
+	const off_t start = 1000;
+	const size_t length = kFileSize - start - 77;
+
+	pid_t child = fork();
+	if (child == 0) {
+		close(sockets[0]);
+		off_t offset = start;
+		size_t left = length;
+		while (left > 0) {
+			ssize_t bytesSent = sendfile(sockets[1], file, &offset, left);
+			if (bytesSent <= 0)
+				exit(1);
+			left -= bytesSent;
+		}
+		exit(offset == start + (off_t)length ? 0 : 1);
+	}
+	close(sockets[1]);
+
+	char* buffer = (char*)malloc(length);
+	bool success = buffer != NULL && read_all(sockets[0], buffer, length)
+		&& check_data("file to socket", buffer, start, length);
+	free(buffer);
+	close(sockets[0]);
+
+	int status;
+	waitpid(child, &status, 0);
+	return success && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+
+static bool
+test_file_to_pipe_to_file(int file)
+{
+	int pipes[2];
+	if (pipe(pipes) != 0) {
+		perror("pipe");
+		return false;
+	}
+
+	char path[] = "/tmp/sendfile_test_XXXXXX";
+	int target = mkstemp(path);
+	if (target < 0) {
+		perror("mkstemp");
+		return false;
+	}
+	unlink(path);
+
+	// move the file through the pipe in chunks that fit into it
+	off_t inOffset = 0;
+	size_t copied = 0;
+	while (copied < kFileSize) {
+		ssize_t bytesIn = splice(file, &inOffset, pipes[1], NULL,
+			kFileSize - copied, 0);
+		if (bytesIn <= 0) {
+			perror("splice file to pipe");
+			return false;
+		}
+
+		ssize_t left = bytesIn;
+		while (left > 0) {
+			ssize_t bytesOut = splice(pipes[0], NULL, target, NULL, left, 0);
+			if (bytesOut <= 0) {
+				perror("splice pipe to file");
+				return false;
+			}
+			left -= bytesOut;
+		}
+		copied += bytesIn;
+	}
+
+	// an empty pipe must not block with SPLICE_F_NONBLOCK
+	if (splice(pipes[0], NULL, target, NULL, 1, SPLICE_F_NONBLOCK) != -1) {
+		fprintf(stderr, "non-blocking splice from empty pipe succeeded\n");
+		return false;
+	}
+
+	char* buffer = (char*)malloc(kFileSize);
+	bool success = buffer != NULL && pread(target, buffer, kFileSize, 0)
+			== (ssize_t)kFileSize
+		&& check_data("file to pipe to file", buffer, 0, kFileSize);
+	free(buffer);
+
+	close(target);
+	close(pipes[0]);
+	close(pipes[1]);
+	return success;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	char path[] = "/tmp/sendfile_test_XXXXXX";
+	int file = mkstemp(path);
+	if (file < 0) {
+		perror("mkstemp");
+		return 1;
+	}
+	unlink(path);
+
+	char* data = (char*)malloc(kFileSize);
+	if (data == NULL)
+		return 1;
+	for (size_t i = 0; i < kFileSize; i++)
+		data[i] = pattern(i);
+	if (write(file, data, kFileSize) != (ssize_t)kFileSize) {
+		perror("write");
+		return 1;
+	}
+	free(data);
+
+	bool success = test_file_to_socket(file);
+	printf("file to socket: %s\n", success ? "ok" : "FAILED");
+
+	bool pipeSuccess = test_file_to_pipe_to_file(file);
+	printf("file to pipe to file: %s\n", pipeSuccess ? "ok" : "FAILED");
+
+	close(file);
+	return success && pipeSuccess ? 0 : 1;
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Replays pictures into a bitmap with the app_server's tiled rendering
+	turned off and on, and compares the time it took, and the results.
+
+	Any number of flattened BPicture files can be given on the command line;
+	without them, a few built-in pictures are used.
+*/
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <Application.h>
+#include <Bitmap.h>
+#include <File.h>
+#include <GradientLinear.h>
+#include <Picture.h>
+#include <String.h>
+#include <View.h>
+
+
+// from InterfaceDefs.cpp
+extern void set_tiled_rendering(bool tiled);
+extern status_t get_tiled_rendering(bool* tiled);
+
+
+static const BRect kBounds(0, 0, 1919, 1079);
+static const int32 kDefaultIterations = 20;
+
+
+static BPicture*
+record_gradient(BView* view)
+{
+	BGradientLinear gradient(kBounds.LeftTop(), kBounds.RightBottom());
+	gradient.AddColor(make_color(255, 0, 0), 0);
+	gradient.AddColor(make_color(0, 255, 0), 128);
+	gradient.AddColor(make_color(0, 0, 255), 255);
+
+	view->BeginPicture(new BPicture);
+	view->FillRect(kBounds, gradient);
+	return view->EndPicture();
+}
+
+
+static BPicture*
+record_text(BView* view)
+{
+	view->BeginPicture(new BPicture);
+	view->SetHighColor(0, 0, 0);
+	view->SetFontSize(48);
+
+	font_height fontHeight;
+	view->GetFontHeight(&fontHeight);
+	float lineHeight = ceilf(fontHeight.ascent + fontHeight.descent
+		+ fontHeight.leading);
+
+	const char* text = "The quick brown fox jumps over the lazy dog. "
+		"The quick brown fox jumps over the lazy dog.";
+	for (float y = lineHeight; y <= kBounds.bottom; y += lineHeight)
+		view->DrawString(text, BPoint(5, y));
+
+	return view->EndPicture();
+}
+
+
+static BPicture*
+record_bitmap(BView* view)
+{
+	BBitmap source(BRect(0, 0, 255, 255), B_RGBA32);
+	uint8* bits = (uint8*)source.Bits();
+	for (int32 y = 0; y < 256; y++) {
+		uint8* pixel = bits + y * source.BytesPerRow();
+		for (int32 x = 0; x < 256; x++) {
+			pixel[0] = x;
+			pixel[1] = y;
+			pixel[2] = (x ^ y) & 0xff;
+			pixel[3] = 255 - ((x + y) >> 1);
+			pixel += 4;
+		}
+	}
+
+	view->BeginPicture(new BPicture);
+	view->SetDrawingMode(B_OP_ALPHA);
+	view->DrawBitmap(&source, source.Bounds(), kBounds,
+		B_FILTER_BITMAP_BILINEAR);
+	return view->EndPicture();
+}
+
+
+static BPicture*
+record_ellipses(BView* view)
+{
+	view->BeginPicture(new BPicture);
+	view->SetDrawingMode(B_OP_ALPHA);
+
+	BPoint center(kBounds.Width() / 2, kBounds.Height() / 2);
+	for (int32 i = 0; i < 16; i++) {
+		float radius = kBounds.Height() / 2 - i * 30;
+		view->SetHighColor(i * 16, 255 - i * 16, 128, 160);
+		view->FillEllipse(center, radius * 1.7, radius);
+	}
+
+	return view->EndPicture();
+}
+
+
+struct picture_info {
+	BString		name;
+	BPicture*	picture;
+};
+
+
+static bigtime_t
+render(BBitmap* bitmap, BView* view, BPicture* picture, int32 iterations,
+	bool tiled)
+{
+	set_tiled_rendering(tiled);
+
+	bigtime_t start = system_time();
+
+	for (int32 i = 0; i < iterations; i++) {
+		bitmap->Lock();
+		view->SetDrawingMode(B_OP_COPY);
+		view->SetHighColor(255, 255, 255);
+		view->FillRect(kBounds);
+		view->DrawPicture(picture, B_ORIGIN);
+		view->Sync();
+		bitmap->Unlock();
+	}
+
+	return system_time() - start;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int32 iterations = kDefaultIterations;
+	int32 firstFile = 1;
+	if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+		iterations = atol(argv[2]);
+		firstFile = 3;
+	}
+	if (iterations < 1) {
+		fprintf(stderr, "Usage: %s [-n <iterations>] [picture files ...]\n",
+			argv[0]);
+		return 1;
+	}
+
+	BApplication app("application/x-vnd.Haiku-TiledRenderingBenchmark");
+
+	BBitmap bitmap(kBounds, B_BITMAP_ACCEPTS_VIEWS, B_RGBA32);
+	if (bitmap.InitCheck() != B_OK) {
+		fprintf(stderr, "Could not create the bitmap.\n");
+		return 1;
+	}
+	BView* view = new BView(kBounds, "canvas", B_FOLLOW_NONE, 0);
+	bitmap.AddChild(view);
+
+	picture_info pictures[32];
+	int32 pictureCount = 0;
+
+	for (int32 i = firstFile; i < argc && pictureCount < 32; i++) {
+		BFile file(argv[i], B_READ_ONLY);
+		BPicture* picture = new BPicture;
+		if (file.InitCheck() != B_OK || picture->Unflatten(&file) != B_OK) {
+			fprintf(stderr, "Could not read picture \"%s\".\n", argv[i]);
+			delete picture;
+			continue;
+		}
+		pictures[pictureCount].name = argv[i];
+		pictures[pictureCount++].picture = picture;
+	}
+
+	if (firstFile == argc) {
+		bitmap.Lock();
+		pictures[0].name = "gradient";
+		pictures[0].picture = record_gradient(view);
+		pictures[1].name = "text";
+		pictures[1].picture = record_text(view);
+		pictures[2].name = "scaled bitmap";
+		pictures[2].picture = record_bitmap(view);
+		pictures[3].name = "ellipses";
+		pictures[3].picture = record_ellipses(view);
+		pictureCount = 4;
+		bitmap.Unlock();
+	}
+
+	bool wasTiled = false;
+	get_tiled_rendering(&wasTiled);
+
+	size_t size = bitmap.BitsLength();
+	uint8* serialBits = (uint8*)malloc(size);
+	if (serialBits == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+
+	int32 failures = 0;
+	printf("%-24s %12s %12s %8s\n", "picture", "serial (ms)", "tiled (ms)",
+		"result");
+
+	for (int32 i = 0; i < pictureCount; i++) {
+		BPicture* picture = pictures[i].picture;
+
+		bigtime_t serial = render(&bitmap, view, picture, iterations, false);
+		memcpy(serialBits, bitmap.Bits(), size);
+
+		bigtime_t tiled = render(&bitmap, view, picture, iterations, true);
+		bool identical = memcmp(serialBits, bitmap.Bits(), size) == 0;
+		if (!identical)
+			failures++;
+
+		printf("%-24s %12.2f %12.2f %8s\n", pictures[i].name.String(),
+			serial / 1000.0 / iterations, tiled / 1000.0 / iterations,
+			identical ? "same" : "DIFFERS");
+
+		delete picture;
+	}
+
+	set_tiled_rendering(wasTiled);
+	free(serialBits);
+
+	return failures == 0 ? 0 : 1;
+}
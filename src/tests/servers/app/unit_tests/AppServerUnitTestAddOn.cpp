@@ -6,6 +6,7 @@
 #include <TestSuite.h>
 #include <TestSuiteAddon.h>
 
+#include "DrawingModeSIMDTest.h"
 #include "SimpleTransformTest.h"
 
 
@@ -15,6 +16,9 @@ getTestSuite()
 	BTestSuite* suite = new BTestSuite("AppServerUnitTests");
 
 	SimpleTransformTest::AddTests(*suite);
+#ifdef APPSERVER_SIMD_BLENDING
+	DrawingModeSIMDTest::AddTests(*suite);
+#endif
 
 	return suite;
 }
@@ -0,0 +1,397 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+#include "DrawingModeSIMDTest.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <cppunit/TestCaller.h>
+#include <cppunit/TestSuite.h>
+
+// the scalar versions
+#include "DrawingModeAlphaCO.h"
+#include "DrawingModeAlphaPOSolid.h"
+#include "DrawingModeCopySolid.h"
+#include "DrawingModeOver.h"
+#include "DrawingModeOverSolid.h"
+
+#include "DrawingModeSIMD.h"
+#include "PatternHandler.h"
+
+
+#ifdef APPSERVER_SIMD_BLENDING
+
+
+const SIMDBlendFunctions* gSIMDBlendFunctions = NULL;
+
+void bilinear_scale_xloop_sse2(const uint8* src, void* dst, void* xWeights,
+	uint32 xmin, uint32 xmax, uint32 wTop, uint32 srcBPR);
+void scale_nearest_row_sse2(uint32* dst, const uint8* src,
+	const uint16* xIndices, int32 count);
+
+
+static const int32 kWidth = 96;
+static const int32 kIterations = 5000;
+
+
+/*!	Values are biased towards 0 and 255, since those take special paths.
+*/
+static uint8
+random_value()
+{
+	switch (rand() % 8) {
+		case 0:
+			return 0;
+		case 1:
+			return 255;
+		default:
+			return rand() & 0xff;
+	}
+}
+
+
+static color_type
+random_color()
+{
+	return color_type(random_value(), random_value(), random_value(),
+		random_value());
+}
+
+
+/*!	Returns the SIMDBlendFunctions the CPU can run.
+*/
+static int32
+get_blend_functions(const SIMDBlendFunctions* functions[2])
+{
+	int32 count = 0;
+	if (__builtin_cpu_supports("sse2"))
+		functions[count++] = &kSSE2BlendFunctions;
+	if (__builtin_cpu_supports("avx2"))
+		functions[count++] = &kAVX2BlendFunctions;
+	return count;
+}
+
+
+/*!	A row of random pixels for the scalar, and a copy of it for the SIMD
+	version, plus random parameters for one blending call.
+*/
+struct TestRow {
+	uint8					scalarBits[kWidth * 4];
+	uint8					simdBits[kWidth * 4];
+	agg::rendering_buffer	scalar;
+	agg::rendering_buffer	simd;
+
+	color_type				colors[kWidth];
+	uint8					covers[kWidth];
+	color_type				color;
+	uint8					cover;
+	int						x;
+	unsigned				length;
+
+	TestRow()
+		:
+		scalar(scalarBits, kWidth, 1, kWidth * 4),
+		simd(simdBits, kWidth, 1, kWidth * 4)
+	{
+		for (int32 i = 0; i < kWidth * 4; i++)
+			scalarBits[i] = simdBits[i] = random_value();
+		for (int32 i = 0; i < kWidth; i++) {
+			colors[i] = random_color();
+			covers[i] = random_value();
+		}
+		color = random_color();
+		cover = random_value();
+		length = 1 + rand() % (kWidth / 2);
+		x = rand() % (kWidth - length + 1);
+	}
+
+	bool Equal() const
+	{
+		return memcmp(scalarBits, simdBits, sizeof(scalarBits)) == 0;
+	}
+};
+
+
+// #pragma mark -
+
+
+void
+DrawingModeSIMDTest::HLine()
+{
+	PatternHandler pattern;
+	const SIMDBlendFunctions* functions[2];
+	int32 count = get_blend_functions(functions);
+
+	for (int32 i = 0; i < count; i++) {
+		gSIMDBlendFunctions = functions[i];
+		for (int32 iteration = 0; iteration < kIterations; iteration++) {
+			TestRow row;
+			if (iteration % 2 == 0) {
+				blend_hline_copy_solid(row.x, 0, row.length, row.color,
+					row.cover, &row.scalar, &pattern);
+				blend_hline_copy_solid_simd(row.x, 0, row.length, row.color,
+					row.cover, &row.simd, &pattern);
+			} else {
+				blend_hline_over_solid(row.x, 0, row.length, row.color,
+					row.cover, &row.scalar, &pattern);
+				blend_hline_over_solid_simd(row.x, 0, row.length, row.color,
+					row.cover, &row.simd, &pattern);
+			}
+			CPPUNIT_ASSERT(row.Equal());
+		}
+	}
+}
+
+
+void
+DrawingModeSIMDTest::SolidHSpan()
+{
+	PatternHandler pattern;
+	const SIMDBlendFunctions* functions[2];
+	int32 count = get_blend_functions(functions);
+
+	for (int32 i = 0; i < count; i++) {
+		gSIMDBlendFunctions = functions[i];
+		for (int32 iteration = 0; iteration < kIterations; iteration++) {
+			TestRow row;
+			if (iteration % 2 == 0) {
+				blend_solid_hspan_copy_solid(row.x, 0, row.length, row.color,
+					row.covers, &row.scalar, &pattern);
+				blend_solid_hspan_copy_solid_simd(row.x, 0, row.length,
+					row.color, row.covers, &row.simd, &pattern);
+			} else {
+				blend_solid_hspan_over_solid(row.x, 0, row.length, row.color,
+					row.covers, &row.scalar, &pattern);
+				blend_solid_hspan_over_solid_simd(row.x, 0, row.length,
+					row.color, row.covers, &row.simd, &pattern);
+			}
+			CPPUNIT_ASSERT(row.Equal());
+		}
+	}
+}
+
+
+void
+DrawingModeSIMDTest::ColorHSpan()
+{
+	PatternHandler pattern;
+	const SIMDBlendFunctions* functions[2];
+	int32 count = get_blend_functions(functions);
+
+	for (int32 i = 0; i < count; i++) {
+		gSIMDBlendFunctions = functions[i];
+		for (int32 iteration = 0; iteration < kIterations; iteration++) {
+			TestRow row;
+			// with and without covers
+			const uint8* covers = (iteration / 2) % 2 == 0 ? row.covers : NULL;
+			if (iteration % 2 == 0) {
+				blend_color_hspan_copy_solid(row.x, 0, row.length, row.colors,
+					covers, row.cover, &row.scalar, &pattern);
+				blend_color_hspan_copy_solid_simd(row.x, 0, row.length,
+					row.colors, covers, row.cover, &row.simd, &pattern);
+			} else {
+				blend_color_hspan_over(row.x, 0, row.length, row.colors,
+					covers, row.cover, &row.scalar, &pattern);
+				blend_color_hspan_over_simd(row.x, 0, row.length, row.colors,
+					covers, row.cover, &row.simd, &pattern);
+			}
+			CPPUNIT_ASSERT(row.Equal());
+		}
+	}
+}
+
+
+void
+DrawingModeSIMDTest::AlphaPixelOverlay()
+{
+	PatternHandler pattern;
+	const SIMDBlendFunctions* functions[2];
+	int32 count = get_blend_functions(functions);
+
+	for (int32 i = 0; i < count; i++) {
+		gSIMDBlendFunctions = functions[i];
+		for (int32 iteration = 0; iteration < kIterations; iteration++) {
+			TestRow row;
+			switch (iteration % 3) {
+				case 0:
+					blend_solid_hspan_alpha_po_solid(row.x, 0, row.length,
+						row.color, row.covers, &row.scalar, &pattern);
+					blend_solid_hspan_alpha_po_solid_simd(row.x, 0,
+						row.length, row.color, row.covers, &row.simd,
+						&pattern);
+					break;
+				case 1:
+					blend_color_hspan_alpha_po(row.x, 0, row.length,
+						row.colors, row.covers, row.cover, &row.scalar,
+						&pattern);
+					blend_color_hspan_alpha_po_simd(row.x, 0, row.length,
+						row.colors, row.covers, row.cover, &row.simd,
+						&pattern);
+					break;
+				case 2:
+					blend_color_hspan_alpha_po(row.x, 0, row.length,
+						row.colors, NULL, row.cover, &row.scalar, &pattern);
+					blend_color_hspan_alpha_po_simd(row.x, 0, row.length,
+						row.colors, NULL, row.cover, &row.simd, &pattern);
+					break;
+			}
+			CPPUNIT_ASSERT(row.Equal());
+		}
+	}
+}
+
+
+void
+DrawingModeSIMDTest::BitmapRowAlpha()
+{
+	const SIMDBlendFunctions* functions[2];
+	int32 count = get_blend_functions(functions);
+
+	for (int32 i = 0; i < count; i++) {
+		for (int32 iteration = 0; iteration < kIterations; iteration++) {
+			TestRow row;
+			uint8 source[kWidth * 4];
+			for (int32 j = 0; j < kWidth * 4; j++)
+				source[j] = random_value();
+
+			// Bgr32Alpha::BlendRow() in DrawBitmapNoScale.h
+			uint8* d = row.scalarBits + row.x * 4;
+			const uint8* s = source;
+			for (unsigned j = 0; j < row.length; j++) {
+				if (s[3] == 255) {
+					*(uint32*)d = *(uint32*)s;
+				} else {
+					d[0] = ((s[0] - d[0]) * s[3] + (d[0] << 8)) >> 8;
+					d[1] = ((s[1] - d[1]) * s[3] + (d[1] << 8)) >> 8;
+					d[2] = ((s[2] - d[2]) * s[3] + (d[2] << 8)) >> 8;
+				}
+				d += 4;
+				s += 4;
+			}
+
+			functions[i]->blend_bitmap_row_alpha(row.simdBits + row.x * 4,
+				source, row.length);
+			CPPUNIT_ASSERT(row.Equal());
+		}
+	}
+}
+
+
+void
+DrawingModeSIMDTest::BilinearScale()
+{
+	if (!__builtin_cpu_supports("sse2"))
+		return;
+
+	struct FilterInfo {
+		uint16 index;
+		uint16 weight;
+	};
+
+	const uint32 sourceBytesPerRow = kWidth * 4;
+	uint8 source[2 * kWidth * 4];
+	FilterInfo weights[kWidth];
+
+	for (int32 iteration = 0; iteration < kIterations; iteration++) {
+		TestRow row;
+		for (uint32 i = 0; i < sizeof(source); i++)
+			source[i] = rand() & 0xff;
+		for (int32 i = 0; i < kWidth; i++) {
+			weights[i].index = (rand() % (kWidth - 1)) * 4;
+			weights[i].weight = random_value();
+		}
+		const uint16 wTop = random_value();
+		const uint16 wBottom = 255 - wTop;
+
+		// BilinearDefault<ColorTypeRgb, DrawModeCopy> in DrawBitmapBilinear.h
+		uint8* d = row.scalarBits;
+		for (unsigned x = 0; x < row.length; x++) {
+			const uint8* s = source + weights[x].index;
+			const uint16 wLeft = weights[x].weight;
+			const uint16 wRight = 255 - wLeft;
+			uint32 t[3];
+			t[0] = (s[0] * wLeft + s[4] * wRight) * wTop;
+			t[1] = (s[1] * wLeft + s[5] * wRight) * wTop;
+			t[2] = (s[2] * wLeft + s[6] * wRight) * wTop;
+			s += sourceBytesPerRow;
+			t[0] += (s[0] * wLeft + s[4] * wRight) * wBottom;
+			t[1] += (s[1] * wLeft + s[5] * wRight) * wBottom;
+			t[2] += (s[2] * wLeft + s[6] * wRight) * wBottom;
+			d[0] = t[0] >> 16;
+			d[1] = t[1] >> 16;
+			d[2] = t[2] >> 16;
+			d += 4;
+		}
+
+		bilinear_scale_xloop_sse2(source, row.simdBits, weights, 0,
+			row.length - 1, wTop, sourceBytesPerRow);
+		CPPUNIT_ASSERT(row.Equal());
+	}
+}
+
+
+void
+DrawingModeSIMDTest::NearestNeighborScale()
+{
+	if (!__builtin_cpu_supports("sse2"))
+		return;
+
+	uint8 source[kWidth * 4];
+	uint16 indices[kWidth];
+
+	for (int32 iteration = 0; iteration < kIterations; iteration++) {
+		TestRow row;
+		for (uint32 i = 0; i < sizeof(source); i++)
+			source[i] = rand() & 0xff;
+		for (int32 i = 0; i < kWidth; i++)
+			indices[i] = (rand() % kWidth) * 4;
+
+		uint32* d = (uint32*)row.scalarBits;
+		for (unsigned x = 0; x < row.length; x++)
+			d[x] = *(uint32*)(source + indices[x]);
+
+		scale_nearest_row_sse2((uint32*)row.simdBits, source, indices,
+			row.length);
+		CPPUNIT_ASSERT(row.Equal());
+	}
+}
+
+
+#endif	// APPSERVER_SIMD_BLENDING
+
+
+/* static */ void
+DrawingModeSIMDTest::AddTests(BTestSuite& parent)
+{
+#ifdef APPSERVER_SIMD_BLENDING
+	CppUnit::TestSuite* const suite = new CppUnit::TestSuite(
+		"DrawingModeSIMDTest");
+
+	suite->addTest(new CppUnit::TestCaller<DrawingModeSIMDTest>(
+		"DrawingModeSIMDTest::HLine",
+		&DrawingModeSIMDTest::HLine));
+	suite->addTest(new CppUnit::TestCaller<DrawingModeSIMDTest>(
+		"DrawingModeSIMDTest::SolidHSpan",
+		&DrawingModeSIMDTest::SolidHSpan));
+	suite->addTest(new CppUnit::TestCaller<DrawingModeSIMDTest>(
+		"DrawingModeSIMDTest::ColorHSpan",
+		&DrawingModeSIMDTest::ColorHSpan));
+	suite->addTest(new CppUnit::TestCaller<DrawingModeSIMDTest>(
+		"DrawingModeSIMDTest::AlphaPixelOverlay",
+		&DrawingModeSIMDTest::AlphaPixelOverlay));
+	suite->addTest(new CppUnit::TestCaller<DrawingModeSIMDTest>(
+		"DrawingModeSIMDTest::BitmapRowAlpha",
+		&DrawingModeSIMDTest::BitmapRowAlpha));
+	suite->addTest(new CppUnit::TestCaller<DrawingModeSIMDTest>(
+		"DrawingModeSIMDTest::BilinearScale",
+		&DrawingModeSIMDTest::BilinearScale));
+	suite->addTest(new CppUnit::TestCaller<DrawingModeSIMDTest>(
+		"DrawingModeSIMDTest::NearestNeighborScale",
+		&DrawingModeSIMDTest::NearestNeighborScale));
+
+	parent.addTest("DrawingModeSIMDTest", suite);
+#endif
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+#ifndef DRAWING_MODE_SIMD_TEST_H
+#define DRAWING_MODE_SIMD_TEST_H
+
+#include <TestCase.h>
+#include <TestSuite.h>
+
+#include "SIMDBlending.h"
+
+
+/*!	Compares the SIMD versions of the drawing modes and bitmap scaling loops
+	against the scalar versions, they have to produce the very same pixels.
+*/
+class DrawingModeSIMDTest : public BTestCase {
+public:
+	static	void			AddTests(BTestSuite& parent);
+
+			void			HLine();
+			void			SolidHSpan();
+			void			ColorHSpan();
+			void			AlphaPixelOverlay();
+			void			BitmapRowAlpha();
+			void			BilinearScale();
+			void			NearestNeighborScale();
+};
+
+
+#endif // DRAWING_MODE_SIMD_TEST_H
@@ -0,0 +1,41 @@
+#!/bin/sh
+
+# Measures the cold start time of an application with and without the
+# launch_speedup file cache module.
+# Usage: launch_bench.sh <application> [<arguments>...]
+# The application should quit by itself, and cache_control must be in the
+# PATH. The boot session's timings are taken from the syslog.
+
+if [ $# -lt 1 ]; then
+	echo "Usage: $0 <application> [<arguments>...]"
+	exit 1
+fi
+
+module=file_cache/launch_speedup/v1
+runs=4
+
+launch()
+{
+	cache_control clear > /dev/null
+	sync
+	time "$@" > /dev/null
+}
+
+echo "without $module:"
+cache_control unset
+for f in $(seq $runs); do
+	launch "$@"
+done
+
+# the first runs only record the profile
+echo
+echo "with $module:"
+cache_control set $module
+for f in $(seq $runs); do
+	launch "$@"
+	sleep 1
+done
+cache_control unset
+
+echo
+grep "launch_speedup:" /var/log/syslog | tail -n 20
@@ -0,0 +1,282 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how metadata operations scale with the number of threads.
+
+	Every thread works in a directory of its own below the given base
+	directory: it creates a number of files, reads the directory, stats the
+	files, and removes them again. The throughput of each phase is printed
+	for an increasing number of threads; on file systems like BFS, most of
+	these operations end up in the block cache.
+*/
+
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+
+static const int32 kMaxThreads = 256;
+
+enum {
+	PHASE_CREATE,
+	PHASE_READ_DIR,
+	PHASE_STAT,
+	PHASE_UNLINK,
+	PHASE_COUNT
+};
+
+static const char* const kPhaseNames[PHASE_COUNT] = {
+	"create", "readdir", "stat", "unlink"
+};
+
+static const char* sBaseDirectory = "/boot/home";
+static int32 sFileCount = 1000;
+static int32 sRounds = 4;
+
+static sem_id sStartSem[PHASE_COUNT];
+static sem_id sDoneSem;
+static int32 sErrors;
+
+
+static void
+get_path(char* path, size_t size, int32 thread, int32 file)
+{
+	if (file < 0) {
+		snprintf(path, size, "%s/block_cache_scaling_%" B_PRId32,
+			sBaseDirectory, thread);
+	} else {
+		snprintf(path, size, "%s/block_cache_scaling_%" B_PRId32 "/%" B_PRId32,
+			sBaseDirectory, thread, file);
+	}
+}
+
+
+static bool
+run_phase(int32 phase, int32 thread)
+{
+	char path[B_PATH_NAME_LENGTH];
+
+	switch (phase) {
+		case PHASE_CREATE:
+			for (int32 i = 0; i < sFileCount; i++) {
+				get_path(path, sizeof(path), thread, i);
+				int fd = open(path, O_CREAT | O_EXCL | O_WRONLY, 0644);
+				if (fd < 0)
+					return false;
+				close(fd);
+			}
+			return true;
+
+		case PHASE_READ_DIR:
+			get_path(path, sizeof(path), thread, -1);
+			for (int32 round = 0; round < sRounds; round++) {
+				DIR* dir = opendir(path);
+				if (dir == NULL)
+					return false;
+				while (readdir(dir) != NULL)
+					;
+				closedir(dir);
+			}
+			return true;
+
+		case PHASE_STAT:
+			for (int32 round = 0; round < sRounds; round++) {
+				for (int32 i = 0; i < sFileCount; i++) {
+					get_path(path, sizeof(path), thread, i);
+					struct stat st;
+					if (lstat(path, &st) != 0)
+						return false;
+				}
+			}
+			return true;
+
+		case PHASE_UNLINK:
+			for (int32 i = 0; i < sFileCount; i++) {
+				get_path(path, sizeof(path), thread, i);
+				if (unlink(path) != 0)
+					return false;
+			}
+			return true;
+	}
+
+	return false;
+}
+
+
+static status_t
+benchmark_thread(void* data)
+{
+	int32 thread = (int32)(addr_t)data;
+
+	for (int32 phase = 0; phase < PHASE_COUNT; phase++) {
+		acquire_sem(sStartSem[phase]);
+
+		if (!run_phase(phase, thread))
+			atomic_add(&sErrors, 1);
+
+		release_sem(sDoneSem);
+	}
+
+	return B_OK;
+}
+
+
+/*!	Runs all phases with \a threadCount threads, and fills in the number of
+	operations per second of each phase.
+*/
+static bool
+run_threads(int32 threadCount, double* rates)
+{
+	char path[B_PATH_NAME_LENGTH];
+	for (int32 i = 0; i < threadCount; i++) {
+		get_path(path, sizeof(path), i, -1);
+		if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+			fprintf(stderr, "Error: could not create \"%s\": %s\n", path,
+				strerror(errno));
+			return false;
+		}
+	}
+
+	for (int32 phase = 0; phase < PHASE_COUNT; phase++)
+		sStartSem[phase] = create_sem(0, "start");
+	sDoneSem = create_sem(0, "done");
+	sErrors = 0;
+
+	thread_id threads[kMaxThreads];
+	for (int32 i = 0; i < threadCount; i++) {
+		threads[i] = spawn_thread(&benchmark_thread, "metadata",
+			B_NORMAL_PRIORITY, (void*)(addr_t)i);
+		if (threads[i] < 0) {
+			fprintf(stderr, "Error: failed to spawn thread: %s\n",
+				strerror(threads[i]));
+			exit(1);
+		}
+		resume_thread(threads[i]);
+	}
+
+	// give the threads time to block on the semaphore
+	snooze(10000);
+
+	for (int32 phase = 0; phase < PHASE_COUNT; phase++) {
+		bigtime_t startTime = system_time();
+		release_sem_etc(sStartSem[phase], threadCount, 0);
+		acquire_sem_etc(sDoneSem, threadCount, 0, 0);
+		bigtime_t time = system_time() - startTime;
+
+		int32 operations = threadCount * sFileCount;
+		if (phase == PHASE_READ_DIR || phase == PHASE_STAT)
+			operations *= sRounds;
+
+		rates[phase] = time > 0 ? (double)operations * 1000000 / time : 0;
+	}
+
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+
+		get_path(path, sizeof(path), i, -1);
+		rmdir(path);
+	}
+
+	for (int32 phase = 0; phase < PHASE_COUNT; phase++)
+		delete_sem(sStartSem[phase]);
+	delete_sem(sDoneSem);
+
+	if (sErrors != 0) {
+		fprintf(stderr, "Error: %" B_PRId32 " threads failed\n", sErrors);
+		return false;
+	}
+
+	return true;
+}
+
+
+static void
+usage(const char* programName)
+{
+	printf("Usage: %s [options] [<base directory>]\n"
+		"  -t <count>    maximum number of threads (default: twice the CPU "
+			"count)\n"
+		"  -f <count>    files per thread (default: %" B_PRId32 ")\n"
+		"  -r <count>    readdir/stat rounds (default: %" B_PRId32 ")\n"
+		"The base directory defaults to %s.\n",
+		programName, sFileCount, sRounds, sBaseDirectory);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	system_info info;
+	get_system_info(&info);
+
+	int32 maxThreads = 2 * info.cpu_count;
+
+	int option;
+	while ((option = getopt(argc, argv, "t:f:r:h")) != -1) {
+		switch (option) {
+			case 't':
+				maxThreads = atol(optarg);
+				break;
+			case 'f':
+				sFileCount = atol(optarg);
+				break;
+			case 'r':
+				sRounds = atol(optarg);
+				break;
+			default:
+				usage(argv[0]);
+				return option == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind < argc)
+		sBaseDirectory = argv[optind];
+
+	if (maxThreads <= 0 || maxThreads > kMaxThreads || sFileCount <= 0
+		|| sRounds <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	printf("%" B_PRId32 " CPUs, %" B_PRId32 " files per thread in %s\n\n",
+		info.cpu_count, sFileCount, sBaseDirectory);
+	printf("threads");
+	for (int32 phase = 0; phase < PHASE_COUNT; phase++)
+		printf(" %10s/s", kPhaseNames[phase]);
+	printf("   speedup\n");
+
+	double singleRate = 0;
+	for (int32 threadCount = 1; threadCount <= maxThreads;
+			threadCount = threadCount < 4 ? threadCount + 1 : threadCount * 2) {
+		double rates[PHASE_COUNT];
+		if (!run_threads(threadCount, rates))
+			return 1;
+
+		// the speedup is based on all phases together
+		double total = 0;
+		for (int32 phase = 0; phase < PHASE_COUNT; phase++)
+			total += rates[phase];
+		if (threadCount == 1)
+			singleRate = total;
+
+		printf("%7" B_PRId32, threadCount);
+		for (int32 phase = 0; phase < PHASE_COUNT; phase++)
+			printf(" %12.0f", rates[phase]);
+		printf(" %9.2f\n", singleRate > 0 ? total / singleRate : 0);
+	}
+
+	return 0;
+}
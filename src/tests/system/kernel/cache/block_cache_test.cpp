@@ -189,7 +189,7 @@ test_blocks(off_t number, int32 count, int32 line)
 	for (int32 i = 0; i < count; i++, number++) {
 		MutexLocker locker(&gCache->lock);
 
-		cached_block* block = (cached_block*)hash_lookup(gCache->hash, &number);
+		cached_block* block = gCache->Lookup(number);
 		if (block == NULL) {
 			if (gBlocks[number].present)
 				error(line, "Block %lld not found!", number);
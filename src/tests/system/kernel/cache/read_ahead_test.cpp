@@ -0,0 +1,171 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures the read throughput of a file with different access patterns.
+
+	The file is read sequentially, with several interleaved sequential streams,
+	and in random order, each with and without a posix_fadvise() hint. To
+	actually hit the disk, the test file should be considerably larger than
+	the file cache, or the cache has to be flushed between the runs (for
+	example by remounting the volume).
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+
+static const int32 kMaxStreams = 16;
+
+static size_t sBlockSize = 64 * 1024;
+static int32 sStreamCount = 4;
+
+
+static bool
+read_block(int fd, off_t offset, uint8* buffer)
+{
+	ssize_t bytesRead = pread(fd, buffer, sBlockSize, offset);
+	if (bytesRead < 0) {
+		fprintf(stderr, "Error: read failed: %s\n", strerror(errno));
+		return false;
+	}
+
+	return true;
+}
+
+
+/*!	Reads the whole file with \a streamCount interleaved sequential streams,
+	each of which covers an equally sized part of the file.
+*/
+static bool
+read_streams(int fd, off_t fileSize, int32 streamCount, uint8* buffer)
+{
+	off_t partSize = fileSize / streamCount;
+	partSize -= partSize % sBlockSize;
+
+	for (off_t offset = 0; offset < partSize; offset += sBlockSize) {
+		for (int32 i = 0; i < streamCount; i++) {
+			if (!read_block(fd, i * partSize + offset, buffer))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
+static bool
+read_random(int fd, off_t fileSize, uint8* buffer)
+{
+	off_t blockCount = fileSize / sBlockSize;
+	for (off_t i = 0; i < blockCount; i++) {
+		off_t block = ((off_t)rand() * RAND_MAX + rand()) % blockCount;
+		if (!read_block(fd, block * sBlockSize, buffer))
+			return false;
+	}
+
+	return true;
+}
+
+
+static void
+run(const char* path, const char* name, int advice, int32 streamCount)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Error: could not open \"%s\": %s\n", path,
+			strerror(errno));
+		exit(1);
+	}
+
+	struct stat st;
+	fstat(fd, &st);
+
+	uint8* buffer = (uint8*)malloc(sBlockSize);
+	if (buffer == NULL) {
+		fprintf(stderr, "Error: out of memory\n");
+		exit(1);
+	}
+
+	int error = posix_fadvise(fd, 0, 0, advice);
+	if (error != 0) {
+		fprintf(stderr, "Error: posix_fadvise() failed: %s\n",
+			strerror(error));
+	}
+
+	bigtime_t startTime = system_time();
+	bool success = streamCount > 0
+		? read_streams(fd, st.st_size, streamCount, buffer)
+		: read_random(fd, st.st_size, buffer);
+	bigtime_t time = system_time() - startTime;
+
+	free(buffer);
+	close(fd);
+
+	if (!success)
+		exit(1);
+
+	printf("%-28s %10.1f MB/s\n", name,
+		time > 0 ? (double)st.st_size / time : 0.0);
+}
+
+
+static void
+usage(const char* programName)
+{
+	printf("Usage: %s [options] <file>\n"
+		"  -b <size>     size of a single read (default: %" B_PRIuSIZE ")\n"
+		"  -s <count>    number of interleaved streams (default: %" B_PRId32
+			")\n",
+		programName, sBlockSize, sStreamCount);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int option;
+	while ((option = getopt(argc, argv, "b:s:h")) != -1) {
+		switch (option) {
+			case 'b':
+				sBlockSize = strtoul(optarg, NULL, 0);
+				break;
+			case 's':
+				sStreamCount = atol(optarg);
+				break;
+			default:
+				usage(argv[0]);
+				return option == 'h' ? 0 : 1;
+		}
+	}
+
+	if (optind + 1 != argc || sBlockSize == 0 || sStreamCount <= 0
+		|| sStreamCount > kMaxStreams) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	const char* path = argv[optind];
+
+	char name[64];
+	snprintf(name, sizeof(name), "%" B_PRId32 " streams", sStreamCount);
+
+	run(path, "sequential", POSIX_FADV_NORMAL, 1);
+	run(path, "sequential (advised)", POSIX_FADV_SEQUENTIAL, 1);
+	run(path, name, POSIX_FADV_NORMAL, sStreamCount);
+	run(path, "random", POSIX_FADV_NORMAL, 0);
+	run(path, "random (advised)", POSIX_FADV_RANDOM, 0);
+
+	return 0;
+}
@@ -0,0 +1,269 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	A C10K style event queue benchmark: registers the receiving ends of many
+	local socket pairs with one event queue, and lets a number of threads
+	wait on it while the main thread writes to randomly chosen sockets.
+
+	Each run reports how many bytes per second made it through, and how many
+	waits returned nothing to do, for:
+	- all threads waiting on the queue the same way,
+	- all threads waiting exclusively (B_EVENT_QUEUE_WAIT_EXCLUSIVE),
+	- a single thread returning the events in the shared ring.
+
+	Usage: event_queue_c10k_test [connections] [threads] [writes]
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include <event_queue_defs.h>
+#include <syscalls.h>
+
+
+static const int kDefaultConnections = 10000;
+static const int kDefaultThreads = 4;
+static const int kDefaultWrites = 200000;
+static const int kBatchSize = 64;
+static const uint32 kRingEntries = 1024;
+
+
+struct connection {
+	int		read_fd;
+	int		write_fd;
+};
+
+
+struct benchmark {
+	int					queue;
+	connection*			connections;
+	int					connection_count;
+	uint32				wait_flags;
+	event_queue_ring*	ring;
+	int32				bytes_read;
+	int32				empty_wakeups;
+	int32				target;
+	int32				done;
+};
+
+
+static void
+drain(benchmark& bench, int index)
+{
+	char buffer[256];
+	while (true) {
+		ssize_t bytesRead = read(bench.connections[index].read_fd, buffer,
+			sizeof(buffer));
+		if (bytesRead <= 0)
+			break;
+		atomic_add(&bench.bytes_read, bytesRead);
+	}
+}
+
+
+static status_t
+waiter_thread(void* data)
+{
+	benchmark& bench = *(benchmark*)data;
+	event_wait_info infos[kBatchSize];
+
+	while (atomic_get(&bench.done) == 0) {
+		ssize_t count = _kern_event_queue_wait(bench.queue, infos, kBatchSize,
+			bench.wait_flags | B_RELATIVE_TIMEOUT, 100000);
+		if (count == B_TIMED_OUT || count == B_INTERRUPTED)
+			continue;
+		if (count < 0) {
+			fprintf(stderr, "wait failed: %s\n", strerror(count));
+			break;
+		}
+		if (count == 0)
+			atomic_add(&bench.empty_wakeups, 1);
+
+		for (ssize_t i = 0; i < count; i++)
+			drain(bench, (int)(addr_t)infos[i].user_data);
+
+		if (atomic_get(&bench.bytes_read) >= bench.target)
+			atomic_set(&bench.done, 1);
+	}
+
+	return B_OK;
+}
+
+
+static status_t
+ring_waiter_thread(void* data)
+{
+	benchmark& bench = *(benchmark*)data;
+	event_queue_ring* ring = bench.ring;
+	event_wait_info* entries = (event_wait_info*)(ring + 1);
+
+	while (atomic_get(&bench.done) == 0) {
+		ssize_t count = _kern_event_queue_wait(bench.queue, NULL, 0,
+			B_EVENT_QUEUE_WAIT_RING | B_RELATIVE_TIMEOUT, 100000);
+		if (count == B_TIMED_OUT || count == B_INTERRUPTED)
+			continue;
+		if (count < 0) {
+			fprintf(stderr, "ring wait failed: %s\n", strerror(count));
+			break;
+		}
+		if (count == 0)
+			atomic_add(&bench.empty_wakeups, 1);
+
+		uint32 head = ring->head;
+		uint32 tail = atomic_get((int32*)&ring->tail);
+		for (; head != tail; head++)
+			drain(bench, (int)(addr_t)entries[head & ring->mask].user_data);
+		atomic_set((int32*)&ring->head, head);
+
+		if (atomic_get(&bench.bytes_read) >= bench.target)
+			atomic_set(&bench.done, 1);
+	}
+
+	return B_OK;
+}
+
+
+static bool
+run(const char* name, connection* connections, int connectionCount,
+	int threadCount, int writes, uint32 waitFlags, bool useRing)
+{
+	benchmark bench = {};
+	bench.connections = connections;
+	bench.connection_count = connectionCount;
+	bench.wait_flags = waitFlags;
+	bench.target = writes;
+
+	bench.queue = _kern_event_queue_create(O_CLOEXEC);
+	if (bench.queue < 0) {
+		fprintf(stderr, "%s: could not create queue: %s\n", name,
+			strerror(bench.queue));
+		return false;
+	}
+
+	if (useRing) {
+		void* address;
+		area_id area = _kern_event_queue_setup_ring(bench.queue, kRingEntries,
+			&address);
+		if (area < 0) {
+			fprintf(stderr, "%s: could not set up ring: %s\n", name,
+				strerror(area));
+			close(bench.queue);
+			return false;
+		}
+		bench.ring = (event_queue_ring*)address;
+		threadCount = 1;
+	}
+
+	// register all connections, edge-triggered
+	event_wait_info* infos = new event_wait_info[connectionCount];
+	for (int i = 0; i < connectionCount; i++) {
+		infos[i].object = connections[i].read_fd;
+		infos[i].type = B_OBJECT_TYPE_FD;
+		infos[i].events = B_EVENT_READ;
+		infos[i].user_data = (void*)(addr_t)i;
+	}
+
+	bigtime_t start = system_time();
+	status_t status = _kern_event_queue_select(bench.queue, infos,
+		connectionCount);
+	bigtime_t registerTime = system_time() - start;
+	delete[] infos;
+
+	if (status != B_OK) {
+		fprintf(stderr, "%s: could not register connections: %s\n", name,
+			strerror(status));
+		close(bench.queue);
+		return false;
+	}
+
+	thread_id* threads = new thread_id[threadCount];
+	for (int i = 0; i < threadCount; i++) {
+		threads[i] = spawn_thread(useRing ? ring_waiter_thread : waiter_thread,
+			"waiter", B_NORMAL_PRIORITY, &bench);
+		resume_thread(threads[i]);
+	}
+
+	start = system_time();
+	for (int i = 0; i < writes; i++) {
+		int index = rand() % connectionCount;
+		char byte = 0;
+		write(connections[index].write_fd, &byte, 1);
+	}
+
+	for (int i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+	}
+	bigtime_t time = system_time() - start;
+	delete[] threads;
+
+	printf("%-10s %d threads: registered %d in %" B_PRIdBIGTIME " us, "
+		"%" B_PRId32 " bytes in %" B_PRIdBIGTIME " us (%.0f/s), "
+		"%" B_PRId32 " empty wake-ups\n", name, threadCount, connectionCount,
+		registerTime, bench.bytes_read, time,
+		bench.bytes_read * 1000000.0 / time, bench.empty_wakeups);
+
+	close(bench.queue);
+	return bench.bytes_read == writes;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int connectionCount = argc > 1 ? atoi(argv[1]) : kDefaultConnections;
+	int threadCount = argc > 2 ? atoi(argv[2]) : kDefaultThreads;
+	int writes = argc > 3 ? atoi(argv[3]) : kDefaultWrites;
+	if (connectionCount <= 0 || threadCount <= 0 || writes <= 0) {
+		fprintf(stderr, "usage: %s [connections] [threads] [writes]\n",
+			argv[0]);
+		return 1;
+	}
+
+	struct rlimit limit;
+	limit.rlim_cur = limit.rlim_max = 2 * connectionCount + 64;
+	if (setrlimit(RLIMIT_NOFILE, &limit) != 0) {
+		fprintf(stderr, "could not raise the FD limit: %s\n",
+			strerror(errno));
+		return 1;
+	}
+
+	connection* connections = new connection[connectionCount];
+	for (int i = 0; i < connectionCount; i++) {
+		int sockets[2];
+		if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+			fprintf(stderr, "socketpair %d failed: %s\n", i, strerror(errno));
+			return 1;
+		}
+		fcntl(sockets[0], F_SETFL, O_NONBLOCK);
+		connections[i].read_fd = sockets[0];
+		connections[i].write_fd = sockets[1];
+	}
+
+	bool success = run("shared", connections, connectionCount, threadCount,
+		writes, 0, false);
+	success &= run("exclusive", connections, connectionCount, threadCount,
+		writes, B_EVENT_QUEUE_WAIT_EXCLUSIVE, false);
+	success &= run("ring", connections, connectionCount, 1, writes, 0, true);
+
+	for (int i = 0; i < connectionCount; i++) {
+		close(connections[i].read_fd);
+		close(connections[i].write_fd);
+	}
+	delete[] connections;
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,328 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Checks the basic I/O ring operations, and compares the time it takes to
+	read a file in small blocks with pread() to reading it through a ring,
+	with several reads in flight at once.
+
+	Pass a device (like /dev/disk/...) to also measure reads into registered
+	buffers, which are executed as asynchronous device requests.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include <user_io_ring.h>
+
+
+static const size_t kDefaultFileSize = 64 * 1024 * 1024;
+static const size_t kBlockSize = 4096;
+static const uint32 kQueueDepth = 32;
+
+static bool sSuccess = true;
+
+
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, \
+				#condition); \
+			sSuccess = false; \
+		} \
+	} while (false)
+
+
+static int32
+wait_result(io_ring* ring, uint64 userData)
+{
+	io_ring_cqe* cqe;
+	status_t status = io_ring_wait_cqe(ring, &cqe);
+	if (status != B_OK)
+		return status;
+
+	CHECK(cqe->user_data == userData);
+	int32 result = cqe->result;
+	io_ring_cqe_seen(ring, cqe);
+	return result;
+}
+
+
+static void
+test_basics()
+{
+	io_ring ring;
+	status_t status = io_ring_init(&ring, 8, 0);
+	if (status != B_OK) {
+		fprintf(stderr, "Error: could not create ring: %s\n",
+			strerror(status));
+		sSuccess = false;
+		return;
+	}
+
+	// nop
+	io_ring_sqe* sqe = io_ring_get_sqe(&ring);
+	io_ring_prep_nop(sqe);
+	sqe->user_data = 1;
+	CHECK(io_ring_submit(&ring) == 1);
+	CHECK(wait_result(&ring, 1) == B_OK);
+
+	// invalid file
+	sqe = io_ring_get_sqe(&ring);
+	io_ring_prep_read(sqe, -1, NULL, 0, 0);
+	sqe->user_data = 2;
+	CHECK(io_ring_submit(&ring) == 1);
+	CHECK(wait_result(&ring, 2) == B_FILE_ERROR);
+
+	// nothing in flight
+	io_ring_cqe* cqe;
+	CHECK(io_ring_wait_cqe(&ring, &cqe) == B_ENTRY_NOT_FOUND);
+
+	// a receive only completes once there is something to receive
+	int sockets[2];
+	CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+
+	char buffer[16];
+	sqe = io_ring_get_sqe(&ring);
+	io_ring_prep_recv(sqe, sockets[0], buffer, sizeof(buffer), 0);
+	sqe->user_data = 3;
+	CHECK(io_ring_submit(&ring) == 1);
+	CHECK(io_ring_wait_cqe_etc(&ring, &cqe, B_RELATIVE_TIMEOUT, 100000)
+		== B_TIMED_OUT);
+
+	CHECK(write(sockets[1], "hello", 5) == 5);
+	CHECK(wait_result(&ring, 3) == 5);
+	CHECK(memcmp(buffer, "hello", 5) == 0);
+
+	// closing the ring cancels waiting operations
+	sqe = io_ring_get_sqe(&ring);
+	io_ring_prep_poll(sqe, sockets[0], B_EVENT_READ);
+	CHECK(io_ring_submit(&ring) == 1);
+
+	io_ring_exit(&ring);
+	close(sockets[0]);
+	close(sockets[1]);
+}
+
+
+/*!	Two rings wait to read from the same (blocking) pipe, but there is only
+	one byte for them. The ring that loses must not block in the read, but
+	wait for more data, and continue to run other operations meanwhile.
+*/
+static void
+test_racing_readers()
+{
+	io_ring rings[2];
+	if (io_ring_init(&rings[0], 8, 0) != B_OK
+		|| io_ring_init(&rings[1], 8, 0) != B_OK) {
+		fprintf(stderr, "Error: could not create rings\n");
+		sSuccess = false;
+		return;
+	}
+
+	int fds[2];
+	CHECK(pipe(fds) == 0);
+
+	char buffers[2];
+	for (int i = 0; i < 2; i++) {
+		io_ring_sqe* sqe = io_ring_get_sqe(&rings[i]);
+		io_ring_prep_read(sqe, fds[0], &buffers[i], 1, -1);
+		sqe->user_data = 1;
+		CHECK(io_ring_submit(&rings[i]) == 1);
+	}
+
+	CHECK(write(fds[1], "a", 1) == 1);
+	CHECK(wait_result(&rings[0], 1) == 1);
+	CHECK(buffers[0] == 'a');
+
+	// the second read found the pipe empty again
+	io_ring_cqe* cqe;
+	CHECK(io_ring_wait_cqe_etc(&rings[1], &cqe, B_RELATIVE_TIMEOUT, 100000)
+		== B_TIMED_OUT);
+
+	io_ring_sqe* sqe = io_ring_get_sqe(&rings[1]);
+	io_ring_prep_nop(sqe);
+	sqe->user_data = 2;
+	CHECK(io_ring_submit(&rings[1]) == 1);
+	CHECK(wait_result(&rings[1], 2) == B_OK);
+
+	CHECK(write(fds[1], "b", 1) == 1);
+	CHECK(wait_result(&rings[1], 1) == 1);
+	CHECK(buffers[1] == 'b');
+
+	io_ring_exit(&rings[0]);
+	io_ring_exit(&rings[1]);
+	close(fds[0]);
+	close(fds[1]);
+}
+
+
+static bigtime_t
+read_synchronously(int fd, off_t size, uint8* buffer)
+{
+	bigtime_t startTime = system_time();
+
+	for (off_t offset = 0; offset < size; offset += kBlockSize) {
+		if (pread(fd, buffer + offset % (kQueueDepth * kBlockSize), kBlockSize,
+				offset) != (ssize_t)kBlockSize) {
+			fprintf(stderr, "Error: read failed: %s\n", strerror(errno));
+			sSuccess = false;
+			break;
+		}
+	}
+
+	return system_time() - startTime;
+}
+
+
+static bigtime_t
+read_with_ring(io_ring* ring, int fd, off_t size, uint8* buffer, bool fixed)
+{
+	bigtime_t startTime = system_time();
+
+	off_t offset = 0;
+	uint32 inFlight = 0;
+	while (offset < size || inFlight > 0) {
+		while (offset < size && inFlight < kQueueDepth) {
+			io_ring_sqe* sqe = io_ring_get_sqe(ring);
+			if (sqe == NULL)
+				break;
+
+			uint8* blockBuffer
+				= buffer + offset % (kQueueDepth * kBlockSize);
+			if (fixed) {
+				io_ring_prep_read_fixed(sqe, fd, blockBuffer, kBlockSize,
+					offset, 0);
+			} else
+				io_ring_prep_read(sqe, fd, blockBuffer, kBlockSize, offset);
+
+			offset += kBlockSize;
+			inFlight++;
+		}
+
+		ssize_t submitted = io_ring_submit_and_wait(ring, 1);
+		if (submitted < 0) {
+			fprintf(stderr, "Error: submitting failed: %s\n",
+				strerror(submitted));
+			sSuccess = false;
+			break;
+		}
+
+		io_ring_cqe* cqe;
+		while (io_ring_peek_cqe(ring, &cqe) == B_OK) {
+			if (cqe->result != (int32)kBlockSize) {
+				fprintf(stderr, "Error: read failed: %s\n",
+					strerror(cqe->result));
+				sSuccess = false;
+			}
+			io_ring_cqe_seen(ring, cqe);
+			inFlight--;
+		}
+	}
+
+	return system_time() - startTime;
+}
+
+
+static void
+print_result(const char* name, off_t size, bigtime_t time)
+{
+	printf("%-22s %10" B_PRIdBIGTIME " us %10.1f MB/s\n", name, time,
+		time > 0 ? size * 1000000.0 / time / (1024 * 1024) : 0);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	if (argc > 2) {
+		printf("Usage: %s [<file or device>]\n", argv[0]);
+		return 1;
+	}
+
+	test_basics();
+	test_racing_readers();
+
+	char path[B_PATH_NAME_LENGTH];
+	bool temporary = argc < 2;
+	if (temporary) {
+		strlcpy(path, "/tmp/io_ring_test.XXXXXX", sizeof(path));
+		int fd = mkstemp(path);
+		if (fd < 0 || ftruncate(fd, kDefaultFileSize) != 0) {
+			fprintf(stderr, "Error: could not create test file: %s\n",
+				strerror(errno));
+			return 1;
+		}
+		close(fd);
+	} else
+		strlcpy(path, argv[1], sizeof(path));
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Error: could not open \"%s\": %s\n", path,
+			strerror(errno));
+		return 1;
+	}
+
+	struct stat st;
+	fstat(fd, &st);
+	off_t size = st.st_size;
+	if (S_ISBLK(st.st_mode) || S_ISCHR(st.st_mode) || size == 0)
+		size = kDefaultFileSize;
+	size -= size % kBlockSize;
+
+	uint8* buffer;
+	area_id area = create_area("io ring test buffer", (void**)&buffer,
+		B_ANY_ADDRESS, kQueueDepth * kBlockSize, B_NO_LOCK,
+		B_READ_AREA | B_WRITE_AREA);
+	if (area < 0) {
+		fprintf(stderr, "Error: could not create buffer: %s\n",
+			strerror(area));
+		return 1;
+	}
+
+	io_ring ring;
+	status_t status = io_ring_init(&ring, kQueueDepth, 0);
+	if (status != B_OK) {
+		fprintf(stderr, "Error: could not create ring: %s\n",
+			strerror(status));
+		return 1;
+	}
+
+	// read once, so that we don't measure the first access to a file
+	read_synchronously(fd, size, buffer);
+
+	print_result("pread()", size, read_synchronously(fd, size, buffer));
+	print_result("ring", size, read_with_ring(&ring, fd, size, buffer, false));
+
+	iovec vec = { buffer, kQueueDepth * kBlockSize };
+	status = io_ring_register_buffers(&ring, &vec, 1);
+	if (status == B_OK) {
+		print_result("ring, fixed buffers", size,
+			read_with_ring(&ring, fd, size, buffer, true));
+		io_ring_unregister_buffers(&ring);
+	} else {
+		fprintf(stderr, "Error: could not register buffer: %s\n",
+			strerror(status));
+		sSuccess = false;
+	}
+
+	io_ring_exit(&ring);
+	delete_area(area);
+	close(fd);
+	if (temporary)
+		unlink(path);
+
+	return sSuccess ? 0 : 1;
+}
@@ -1,14 +1,35 @@
 /*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
  * Copyright 2008, Ingo Weinhold, ingo_weinhold@gmx.de.
  * Distributed under the terms of the MIT License.
  */
 
+#include <getopt.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 
 #include <OS.h>
 
 
+static const int32 kMaxThreads = 1024;
+
+static const char* const kPaths[] = {
+	"/",
+	"/boot",
+	"/boot/develop",
+	"/boot/develop/headers",
+	"/boot/develop/headers/posix",
+	"/boot/develop/headers/posix/sys",
+	"/boot/develop/headers/posix/sys/stat.h",
+	NULL
+};
+
+static int32 sIterations = 100000;
+static sem_id sStartSem;
+
+
 static void
 time_lstat(const char* path)
 {
@@ -27,22 +48,133 @@ time_lstat(const char* path)
 }
 
 
+static status_t
+lstat_thread(void* data)
+{
+	const char* path = (const char*)data;
+
+	acquire_sem(sStartSem);
+
+	for (int32 i = 0; i < sIterations; i++) {
+		struct stat st;
+		if (lstat(path, &st) != 0)
+			return B_ERROR;
+	}
+
+	return B_OK;
+}
+
+
+/*!	Lets \a threadCount threads lstat() \a path concurrently and returns the
+	total number of calls per second.
+*/
+static double
+run_threads(const char* path, int32 threadCount)
+{
+	thread_id threads[kMaxThreads];
+
+	sStartSem = create_sem(0, "start");
+
+	for (int32 i = 0; i < threadCount; i++) {
+		threads[i] = spawn_thread(&lstat_thread, "lstat", B_NORMAL_PRIORITY,
+			(void*)path);
+		if (threads[i] < 0) {
+			fprintf(stderr, "Error: failed to spawn thread: %s\n",
+				strerror(threads[i]));
+			exit(1);
+		}
+		resume_thread(threads[i]);
+	}
+
+	// give the threads time to block on the semaphore
+	snooze(10000);
+
+	bigtime_t startTime = system_time();
+	release_sem_etc(sStartSem, threadCount, 0);
+
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+		if (result != B_OK) {
+			fprintf(stderr, "Error: lstat(\"%s\") failed\n", path);
+			exit(1);
+		}
+	}
+
+	bigtime_t time = system_time() - startTime;
+
+	delete_sem(sStartSem);
+
+	return time > 0 ? (double)threadCount * sIterations * 1000000 / time : 0;
+}
+
+
+static void
+benchmark_threads(const char* path, int32 maxThreads)
+{
+	printf("\n%s\n", path);
+	printf("threads      calls/s   speedup\n");
+
+	double singleRate = 0;
+	for (int32 threadCount = 1; threadCount <= maxThreads;
+			threadCount = threadCount < 4 ? threadCount + 1 : threadCount * 2) {
+		double rate = run_threads(path, threadCount);
+		if (threadCount == 1)
+			singleRate = rate;
+
+		printf("%7" B_PRId32 " %12.0f %9.2f\n", threadCount, rate,
+			singleRate > 0 ? rate / singleRate : 0);
+	}
+}
+
+
+static void
+usage(const char* programName)
+{
+	printf("Usage: %s [options]\n"
+		"  -t <count>    maximum number of threads (default: twice the CPU "
+			"count)\n"
+		"  -i <count>    lstat() calls per thread (default: %" B_PRId32 ")\n",
+		programName, sIterations);
+}
+
+
 int
-main()
+main(int argc, char** argv)
 {
-	const char* const paths[] = {
-		"/",
-		"/boot",
-		"/boot/develop",
-		"/boot/develop/headers",
-		"/boot/develop/headers/posix",
-		"/boot/develop/headers/posix/sys",
-		"/boot/develop/headers/posix/sys/stat.h",
-		NULL
-	};
-
-	for (int32 i = 0; paths[i] != NULL; i++)
-		time_lstat(paths[i]);
+	system_info info;
+	get_system_info(&info);
+
+	int32 maxThreads = 2 * info.cpu_count;
+
+	int option;
+	while ((option = getopt(argc, argv, "t:i:h")) != -1) {
+		switch (option) {
+			case 't':
+				maxThreads = atol(optarg);
+				break;
+			case 'i':
+				sIterations = atol(optarg);
+				break;
+			default:
+				usage(argv[0]);
+				return option == 'h' ? 0 : 1;
+		}
+	}
+
+	if (maxThreads <= 0 || maxThreads > kMaxThreads || sIterations <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	for (int32 i = 0; kPaths[i] != NULL; i++)
+		time_lstat(kPaths[i]);
+
+	// concurrent lookups of the same (hot) directories
+	printf("\n%" B_PRId32 " CPUs, %" B_PRId32 " calls per thread\n",
+		info.cpu_count, sIterations);
+	benchmark_threads(kPaths[3], maxThreads);
+	benchmark_threads(kPaths[6], maxThreads);
 
 	return 0;
 }
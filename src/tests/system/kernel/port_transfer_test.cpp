@@ -0,0 +1,236 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Compares the latency and throughput of passing 1 KiB to 1 MiB messages
+	to another team:
+	- copying them through the port (up to the maximum port message size),
+	- creating an area per message, and transferring it, like BMessage does
+	  for large messages,
+	- passing them in port buffers.
+	The sender fills every message, the receiver checks its first and last
+	byte, and acknowledges it.
+
+	Usage: port_transfer_test [messages]
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+#include <syscalls.h>
+
+
+static const size_t kSizes[] = {
+	1024, 4096, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024
+};
+static const size_t kMaxCopySize = 256 * 1024;
+static const int kDefaultMessages = 2000;
+
+enum transfer_mode {
+	MODE_COPY = 0,
+	MODE_AREA,
+	MODE_BUFFER
+};
+
+static const char* const kModeNames[] = { "copy", "area", "buffer" };
+
+
+static bool
+check_message(const void* data, size_t size, int32 code)
+{
+	const uint8* bytes = (const uint8*)data;
+	return bytes[0] == (uint8)code && bytes[size - 1] == (uint8)code;
+}
+
+
+static int
+receive_messages(transfer_mode mode, size_t size, int count, port_id port,
+	port_id replyPort)
+{
+	uint8* buffer = mode == MODE_COPY ? (uint8*)malloc(size) : NULL;
+
+	for (int i = 0; i < count; i++) {
+		int32 code;
+		bool valid = false;
+
+		switch (mode) {
+			case MODE_COPY:
+			{
+				ssize_t bytesRead = read_port(port, &code, buffer, size);
+				valid = bytesRead == (ssize_t)size
+					&& check_message(buffer, size, code);
+				break;
+			}
+
+			case MODE_AREA:
+			{
+				area_id area;
+				area_info info;
+				if (read_port(port, &code, &area, sizeof(area))
+						== sizeof(area)
+					&& get_area_info(area, &info) == B_OK) {
+					valid = check_message(info.address, size, code);
+					delete_area(area);
+				}
+				break;
+			}
+
+			case MODE_BUFFER:
+			{
+				area_id area;
+				void* address;
+				ssize_t bytesRead = _kern_read_port_buffer_etc(port, &code,
+					&area, &address, 0, 0);
+				if (bytesRead == (ssize_t)size) {
+					valid = check_message(address, size, code);
+					_kern_release_port_buffer(area);
+				}
+				break;
+			}
+		}
+
+		if (!valid) {
+			fprintf(stderr, "%s: message %d of %" B_PRIuSIZE " bytes is "
+				"invalid\n", kModeNames[mode], i, size);
+			return 1;
+		}
+
+		write_port(replyPort, 0, NULL, 0);
+	}
+
+	free(buffer);
+	return 0;
+}
+
+
+static status_t
+send_message(transfer_mode mode, size_t size, int32 code, port_id port,
+	team_id target, uint8* buffer)
+{
+	switch (mode) {
+		case MODE_COPY:
+			memset(buffer, code, size);
+			return write_port(port, code, buffer, size);
+
+		case MODE_AREA:
+		{
+			void* address;
+			area_id area = create_area("message", &address, B_ANY_ADDRESS,
+				(size + B_PAGE_SIZE - 1) & ~(B_PAGE_SIZE - 1), B_NO_LOCK,
+				B_READ_AREA | B_WRITE_AREA);
+			if (area < 0)
+				return area;
+
+			memset(address, code, size);
+
+			area_id transferred = _kern_transfer_area(area, &address,
+				B_ANY_ADDRESS, target);
+			if (transferred < 0) {
+				delete_area(area);
+				return transferred;
+			}
+			area = transferred;
+
+			return write_port(port, code, &area, sizeof(area));
+		}
+
+		case MODE_BUFFER:
+		{
+			void* address;
+			area_id area = _kern_acquire_port_buffer(size, &address);
+			if (area < 0)
+				return area;
+
+			memset(address, code, size);
+
+			status_t status = _kern_write_port_buffer_etc(port, code, area,
+				size, 0, 0);
+			if (status != B_OK)
+				_kern_release_port_buffer(area);
+			return status;
+		}
+	}
+
+	return B_BAD_VALUE;
+}
+
+
+static bool
+run(transfer_mode mode, size_t size, int count)
+{
+	port_id port = create_port(16, "transfer");
+	port_id replyPort = create_port(16, "transfer reply");
+	if (port < 0 || replyPort < 0) {
+		fprintf(stderr, "could not create ports\n");
+		return false;
+	}
+
+	pid_t child = fork();
+	if (child < 0) {
+		fprintf(stderr, "fork failed\n");
+		return false;
+	}
+	if (child == 0)
+		_exit(receive_messages(mode, size, count, port, replyPort));
+
+	uint8* buffer = mode == MODE_COPY ? (uint8*)malloc(size) : NULL;
+	status_t status = B_OK;
+
+	bigtime_t start = system_time();
+	for (int i = 0; i < count && status == B_OK; i++) {
+		status = send_message(mode, size, i, port, child, buffer);
+		if (status == B_OK) {
+			int32 code;
+			status = read_port(replyPort, &code, NULL, 0);
+		}
+	}
+	bigtime_t time = system_time() - start;
+
+	free(buffer);
+	delete_port(port);
+	delete_port(replyPort);
+
+	int childStatus;
+	waitpid(child, &childStatus, 0);
+
+	if (status < B_OK) {
+		fprintf(stderr, "%s: sending %" B_PRIuSIZE " bytes failed: %s\n",
+			kModeNames[mode], size, strerror(status));
+		return false;
+	}
+
+	printf("%-7s %8" B_PRIuSIZE " bytes: %7.2f us/message, %9.2f MB/s\n",
+		kModeNames[mode], size, (double)time / count,
+		(double)size * count / time);
+
+	return WIFEXITED(childStatus) && WEXITSTATUS(childStatus) == 0;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : kDefaultMessages;
+	if (count <= 0) {
+		fprintf(stderr, "usage: %s [messages]\n", argv[0]);
+		return 1;
+	}
+
+	bool success = true;
+	for (size_t i = 0; i < sizeof(kSizes) / sizeof(kSizes[0]); i++) {
+		if (kSizes[i] <= kMaxCopySize)
+			success &= run(MODE_COPY, kSizes[i], count);
+		success &= run(MODE_AREA, kSizes[i], count);
+		success &= run(MODE_BUFFER, kSizes[i], count);
+	}
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,336 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Synthetic periodic task benchmark for deadline reservations.
+
+	A number of periodic tasks each burn a fixed amount of CPU time per
+	period, while background threads keep all CPUs busy. For every task the
+	response times and the number of missed deadlines are reported. Without
+	reservations (-n), the tasks run with a real-time priority instead, for
+	comparison.
+	Finally, the admission control is checked: reservations are added until
+	the system refuses them, which has to happen before the CPUs are
+	overcommitted.
+*/
+
+
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <OS.h>
+#include <scheduler.h>
+
+
+struct periodic_task {
+	pthread_t	thread;
+	int32		index;
+
+	int64		periods;
+	int64		misses;
+	bigtime_t	total_response;
+	bigtime_t	max_response;
+};
+
+
+static bigtime_t sRuntime = 2000;
+static bigtime_t sDeadline = 0;
+static bigtime_t sPeriod = 10000;
+static bigtime_t sWork = 1500;
+static bigtime_t sDuration = 5000000;
+static bool sUseReservations = true;
+
+static bigtime_t sStartTime;
+static int32 sQuit;
+
+
+static bigtime_t
+thread_cpu_time()
+{
+	timespec time;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+	return (bigtime_t)time.tv_sec * 1000000 + time.tv_nsec / 1000;
+}
+
+
+/*!	Burns \a time us of the calling thread's CPU time. Time the thread
+	spends preempted doesn't count.
+*/
+static void
+burn_cpu_time(bigtime_t time)
+{
+	bigtime_t end = thread_cpu_time() + time;
+	volatile uint32 value = 0;
+	while (thread_cpu_time() < end) {
+		for (int32 i = 0; i < 1000; i++)
+			value = value * 1103515245 + 12345;
+	}
+}
+
+
+static void*
+periodic_task_entry(void* _task)
+{
+	periodic_task* task = (periodic_task*)_task;
+	bigtime_t deadline = sDeadline != 0 ? sDeadline : sPeriod;
+
+	for (int64 period = 0; atomic_get(&sQuit) == 0; period++) {
+		bigtime_t release = sStartTime + period * sPeriod;
+		snooze_until(release, B_SYSTEM_TIMEBASE);
+
+		burn_cpu_time(sWork);
+
+		bigtime_t response = system_time() - release;
+		task->periods++;
+		task->total_response += response;
+		if (response > task->max_response)
+			task->max_response = response;
+		if (response > deadline)
+			task->misses++;
+	}
+
+	return NULL;
+}
+
+
+static void*
+load_entry(void*)
+{
+	volatile uint32 value = 0;
+	while (atomic_get(&sQuit) == 0)
+		value = value * 1103515245 + 12345;
+
+	return NULL;
+}
+
+
+static status_t
+start_thread(pthread_t* thread, void* (*entry)(void*), void* data,
+	bool reserve, int32 priority)
+{
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+
+	sched_param parameters;
+	parameters.sched_priority = priority;
+	pthread_attr_setschedparam(&attributes, &parameters);
+
+	if (reserve) {
+		pthread_attr_setdeadline_np(&attributes, sRuntime, sDeadline,
+			sPeriod);
+	}
+
+	status_t status = pthread_create(thread, &attributes, entry, data);
+	pthread_attr_destroy(&attributes);
+	return status;
+}
+
+
+static status_t
+admission_entry(void*)
+{
+	return B_OK;
+}
+
+
+/*!	Reserves a fixed runtime out of every period for as many new threads as
+	the system admits, and checks that the admitted bandwidth doesn't exceed
+	the CPU count. The threads are never resumed.
+*/
+static bool
+test_admission(int32 cpuCount, int32 reservedTasks)
+{
+	const bigtime_t kPeriod = 10000;
+	const bigtime_t kRuntime = 2500;
+
+	thread_id threads[256];
+	int32 admitted = 0;
+	status_t status = B_OK;
+
+	while (admitted < 256) {
+		threads[admitted] = spawn_thread(&admission_entry, "admission",
+			B_NORMAL_PRIORITY, NULL);
+		if (threads[admitted] < 0)
+			break;
+
+		status = set_thread_deadline(threads[admitted], kRuntime, 0, kPeriod);
+		if (status != B_OK) {
+			kill_thread(threads[admitted]);
+			break;
+		}
+
+		admitted++;
+	}
+
+	for (int32 i = 0; i < admitted; i++)
+		kill_thread(threads[i]);
+
+	double bandwidth = (double)admitted * kRuntime / kPeriod
+		+ (sUseReservations
+			? (double)reservedTasks * sRuntime
+				/ (sDeadline != 0 ? sDeadline : sPeriod) : 0);
+
+	printf("\nadmission: %" B_PRId32 " more reservations of %" B_PRId64 "/%"
+		B_PRId64 " us admitted, %.2f of %" B_PRId32 " CPUs reserved, then: "
+		"%s\n", admitted, kRuntime, kPeriod, bandwidth, cpuCount,
+		strerror(status));
+
+	if (status != B_BUSY) {
+		fprintf(stderr, "Error: expected the reservation to be refused with "
+			"B_BUSY.\n");
+		return false;
+	}
+	if (bandwidth > cpuCount) {
+		fprintf(stderr, "Error: the CPUs are overcommitted.\n");
+		return false;
+	}
+
+	return true;
+}
+
+
+static void
+usage(const char* programName)
+{
+	printf("Usage: %s [options]\n"
+		"  -t <count>    number of periodic tasks (default: CPU count)\n"
+		"  -l <count>    number of background load threads (default: twice "
+			"the\n"
+		"                CPU count)\n"
+		"  -r <us>       reserved runtime per period (default: %" B_PRId64 ")\n"
+		"  -D <us>       relative deadline (default: the period)\n"
+		"  -p <us>       period (default: %" B_PRId64 ")\n"
+		"  -w <us>       CPU time used per period (default: %" B_PRId64 ")\n"
+		"  -d <seconds>  duration (default: %" B_PRId64 ")\n"
+		"  -n            use a real-time priority instead of reservations\n",
+		programName, sRuntime, sPeriod, sWork, sDuration / 1000000);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	system_info info;
+	get_system_info(&info);
+	int32 cpuCount = info.cpu_count;
+
+	int32 taskCount = cpuCount;
+	int32 loadCount = 2 * cpuCount;
+
+	int option;
+	while ((option = getopt(argc, argv, "t:l:r:D:p:w:d:nh")) != -1) {
+		switch (option) {
+			case 't':
+				taskCount = atol(optarg);
+				break;
+			case 'l':
+				loadCount = atol(optarg);
+				break;
+			case 'r':
+				sRuntime = atoll(optarg);
+				break;
+			case 'D':
+				sDeadline = atoll(optarg);
+				break;
+			case 'p':
+				sPeriod = atoll(optarg);
+				break;
+			case 'w':
+				sWork = atoll(optarg);
+				break;
+			case 'd':
+				sDuration = atoll(optarg) * 1000000;
+				break;
+			case 'n':
+				sUseReservations = false;
+				break;
+			default:
+				usage(argv[0]);
+				return option == 'h' ? 0 : 1;
+		}
+	}
+
+	if (taskCount <= 0 || taskCount > 1024 || loadCount < 0
+		|| loadCount > 1024 || sPeriod <= 0 || sWork <= 0
+		|| sDuration <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	periodic_task* tasks = (periodic_task*)calloc(taskCount,
+		sizeof(periodic_task));
+	pthread_t* loadThreads = (pthread_t*)calloc(loadCount + 1,
+		sizeof(pthread_t));
+	if (tasks == NULL || loadThreads == NULL) {
+		fprintf(stderr, "Error: out of memory\n");
+		return 1;
+	}
+
+	printf("%" B_PRId32 " tasks using %" B_PRId64 " us every %" B_PRId64
+		" us, %s, %" B_PRId32 " load threads\n", taskCount, sWork, sPeriod,
+		sUseReservations ? "with reservations" : "real-time priority",
+		loadCount);
+
+	for (int32 i = 0; i < loadCount; i++) {
+		if (start_thread(&loadThreads[i], &load_entry, NULL, false,
+				B_NORMAL_PRIORITY) != 0) {
+			fprintf(stderr, "Error: could not start load thread\n");
+			return 1;
+		}
+	}
+
+	sStartTime = system_time() + 100000;
+
+	int32 startedTasks = 0;
+	for (; startedTasks < taskCount; startedTasks++) {
+		tasks[startedTasks].index = startedTasks;
+		int error = start_thread(&tasks[startedTasks].thread,
+			&periodic_task_entry, &tasks[startedTasks], sUseReservations,
+			B_REAL_TIME_DISPLAY_PRIORITY);
+		if (error != 0) {
+			fprintf(stderr, "Error: could not start task %" B_PRId32 ": %s\n",
+				startedTasks, strerror(error));
+			break;
+		}
+	}
+
+	snooze_until(sStartTime + sDuration, B_SYSTEM_TIMEBASE);
+	atomic_set(&sQuit, 1);
+
+	for (int32 i = 0; i < startedTasks; i++)
+		pthread_join(tasks[i].thread, NULL);
+	for (int32 i = 0; i < loadCount; i++)
+		pthread_join(loadThreads[i], NULL);
+
+	printf("\ntask    periods   missed   avg resp   max resp\n");
+	int64 totalMisses = 0;
+	for (int32 i = 0; i < startedTasks; i++) {
+		periodic_task& task = tasks[i];
+		printf("%4" B_PRId32 " %10" B_PRId64 " %8" B_PRId64 " %10" B_PRId64
+			" %10" B_PRId64 "\n", task.index, task.periods, task.misses,
+			task.periods > 0 ? task.total_response / task.periods : 0,
+			task.max_response);
+		totalMisses += task.misses;
+	}
+
+	bool success = startedTasks == taskCount;
+	if (sUseReservations && sWork <= sRuntime && totalMisses > 0) {
+		fprintf(stderr, "Error: %" B_PRId64 " deadlines missed despite the "
+			"reservations.\n", totalMisses);
+		success = false;
+	}
+
+	if (!test_admission(cpuCount, startedTasks))
+		success = false;
+
+	free(tasks);
+	free(loadThreads);
+	return success ? 0 : 1;
+}
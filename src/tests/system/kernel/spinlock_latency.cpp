@@ -0,0 +1,323 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Compares the acquisition latency of a plain test-and-set spinlock with
+	the queued spinlock algorithm under contention.
+
+	Note that this benchmark does not exercise the kernel's acquire_spinlock()
+	at all: both lock variants are userland copies of the algorithm, and
+	queued_acquire() has to be kept in sync with smp.cpp by hand. It can only
+	show how the algorithms behave. The contending threads are pinned to their
+	own CPU, but they still run with interrupts enabled and may be preempted,
+	and none of the kernel's debugging and statistics code is involved. The
+	numbers must not be taken as the latency of the kernel's spinlocks.
+*/
+
+
+#include <algorithm>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ByteOrder.h>
+#include <OS.h>
+
+#include <syscalls.h>
+
+
+#define SPINLOCK_LOCKED				0x1
+#define SPINLOCK_TAIL_SHIFT			8
+#define SPINLOCK_TAIL_MASK			0x7fffff00
+
+static const int32 kIterations = 20000;
+static const int32 kCriticalSectionLength = 32;
+
+
+struct wait_node {
+	wait_node* volatile	next;
+	int32				granted;
+} __attribute__((aligned(64)));
+
+
+struct test_lock {
+	int32				lock;
+	char				padding[60];
+	int32				counter;
+} __attribute__((aligned(64)));
+
+
+struct test_thread {
+	int32				cpu;
+	bool				queued;
+	nanotime_t*			latencies;
+};
+
+
+static test_lock sLock;
+static wait_node sWaitNodes[SMP_MAX_CPUS];
+static int32 sStartBarrier;
+static int32 sThreadCount;
+
+
+static void
+tas_acquire(test_lock* lock)
+{
+	while (true) {
+		while (atomic_get(&lock->lock) != 0)
+			;
+		if (atomic_get_and_set(&lock->lock, SPINLOCK_LOCKED) == 0)
+			return;
+	}
+}
+
+
+static void
+tas_release(test_lock* lock)
+{
+	atomic_set(&lock->lock, 0);
+}
+
+
+static void
+queued_acquire(test_lock* lock, int32 index)
+{
+	if (atomic_test_and_set(&lock->lock, SPINLOCK_LOCKED, 0) == 0)
+		return;
+
+	wait_node* node = &sWaitNodes[index];
+	node->next = NULL;
+	node->granted = 0;
+
+	const uint32 tail = (uint32)(index + 1) << SPINLOCK_TAIL_SHIFT;
+
+	uint32 oldValue;
+	while (true) {
+		oldValue = (uint32)atomic_get(&lock->lock);
+		if (oldValue == 0) {
+			if (atomic_test_and_set(&lock->lock, SPINLOCK_LOCKED, 0) == 0)
+				return;
+			continue;
+		}
+
+		uint32 newValue = (oldValue & ~SPINLOCK_TAIL_MASK) | tail;
+		if ((uint32)atomic_test_and_set(&lock->lock, newValue, oldValue)
+				== oldValue) {
+			break;
+		}
+	}
+
+	uint32 previousTail = oldValue & SPINLOCK_TAIL_MASK;
+	if (previousTail != 0) {
+		wait_node* previous
+			= &sWaitNodes[(previousTail >> SPINLOCK_TAIL_SHIFT) - 1];
+		previous->next = node;
+
+		while (atomic_get(&node->granted) == 0)
+			;
+	}
+
+	while ((atomic_get(&lock->lock) & SPINLOCK_LOCKED) != 0)
+		;
+
+	while (true) {
+		uint32 value = (uint32)atomic_get(&lock->lock);
+		if ((value & SPINLOCK_TAIL_MASK) != tail) {
+			atomic_or(&lock->lock, SPINLOCK_LOCKED);
+			break;
+		}
+
+		if ((uint32)atomic_test_and_set(&lock->lock, SPINLOCK_LOCKED, value)
+				== value) {
+			return;
+		}
+	}
+
+	wait_node* next;
+	while ((next = node->next) == NULL)
+		;
+
+	atomic_set(&next->granted, 1);
+}
+
+
+static void
+queued_release(test_lock* lock)
+{
+	// the tail never touches the lowest byte, so a release store suffices
+	uint8* lockedByte = (uint8*)&lock->lock;
+#if !B_HOST_IS_LENDIAN
+	lockedByte += sizeof(lock->lock) - 1;
+#endif
+	__atomic_store_n(lockedByte, 0, __ATOMIC_RELEASE);
+}
+
+
+static status_t
+pin_to_cpu(int32 cpu)
+{
+	uint32 mask[(SMP_MAX_CPUS + 31) / 32];
+	memset(mask, 0, sizeof(mask));
+	mask[cpu / 32] = 1u << (cpu % 32);
+
+	return _kern_set_thread_affinity(find_thread(NULL), mask, sizeof(mask));
+}
+
+
+static status_t
+contention_thread(void* data)
+{
+	test_thread* thread = (test_thread*)data;
+
+	status_t error = pin_to_cpu(thread->cpu);
+	if (error != B_OK)
+		return error;
+
+	atomic_add(&sStartBarrier, 1);
+	while (atomic_get(&sStartBarrier) < sThreadCount)
+		;
+
+	for (int32 i = 0; i < kIterations; i++) {
+		nanotime_t start = system_time_nsecs();
+		if (thread->queued)
+			queued_acquire(&sLock, thread->cpu);
+		else
+			tas_acquire(&sLock);
+		thread->latencies[i] = system_time_nsecs() - start;
+
+		for (int32 k = 0; k < kCriticalSectionLength; k++)
+			sLock.counter++;
+
+		if (thread->queued)
+			queued_release(&sLock);
+		else
+			tas_release(&sLock);
+
+		// give the others a chance to queue up again
+		for (int32 k = 0; k < kCriticalSectionLength; k++)
+			__asm__ __volatile__("" ::: "memory");
+	}
+
+	return B_OK;
+}
+
+
+static nanotime_t
+percentile(nanotime_t* sorted, int32 count, double fraction)
+{
+	int32 index = (int32)(fraction * (count - 1));
+	return sorted[index];
+}
+
+
+static bool
+run_test(int32 threadCount, bool queued)
+{
+	test_thread threads[SMP_MAX_CPUS];
+	thread_id threadIDs[SMP_MAX_CPUS];
+
+	int32 sampleCount = threadCount * kIterations;
+	nanotime_t* latencies = (nanotime_t*)malloc(
+		sizeof(nanotime_t) * sampleCount);
+	if (latencies == NULL) {
+		fprintf(stderr, "Error: Out of memory\n");
+		return false;
+	}
+
+	sLock.lock = 0;
+	sLock.counter = 0;
+	sStartBarrier = 0;
+	sThreadCount = threadCount;
+
+	for (int32 i = 0; i < threadCount; i++) {
+		threads[i].cpu = i;
+		threads[i].queued = queued;
+		threads[i].latencies = latencies + i * kIterations;
+
+		threadIDs[i] = spawn_thread(&contention_thread, "contention",
+			B_URGENT_DISPLAY_PRIORITY, &threads[i]);
+		if (threadIDs[i] < 0) {
+			fprintf(stderr, "Error: Failed to spawn thread: %s\n",
+				strerror(threadIDs[i]));
+			exit(1);
+		}
+	}
+
+	bigtime_t startTime = system_time();
+	for (int32 i = 0; i < threadCount; i++)
+		resume_thread(threadIDs[i]);
+
+	bool success = true;
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threadIDs[i], &result);
+		if (result != B_OK) {
+			fprintf(stderr, "Error: Failed to pin thread to CPU %" B_PRId32
+				": %s\n", i, strerror(result));
+			success = false;
+		}
+	}
+	bigtime_t totalTime = system_time() - startTime;
+
+	if (success) {
+		std::sort(latencies, latencies + sampleCount);
+
+		printf("%-7s %5" B_PRId32 "  %8" B_PRId64 " %8" B_PRId64 " %8" B_PRId64
+			" %8" B_PRId64 " %10" B_PRId64 " %10.0f\n",
+			queued ? "queued" : "tas", threadCount,
+			percentile(latencies, sampleCount, 0.5),
+			percentile(latencies, sampleCount, 0.9),
+			percentile(latencies, sampleCount, 0.99),
+			percentile(latencies, sampleCount, 0.999),
+			latencies[sampleCount - 1],
+			(double)sampleCount * 1000000 / totalTime);
+	}
+
+	free(latencies);
+	return success;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	system_info info;
+	get_system_info(&info);
+	int32 cpuCount = std::min((int32)info.cpu_count, (int32)SMP_MAX_CPUS);
+
+	if (cpuCount < 2) {
+		fprintf(stderr, "Error: This test needs at least two CPUs.\n");
+		return 1;
+	}
+
+	printf("userland model of the spinlock algorithms, not the kernel's "
+		"spinlocks\n");
+	printf("acquisition latency in ns, %" B_PRId32 " iterations per CPU\n\n",
+		kIterations);
+	printf("lock     cpus       p50      p90      p99    p99.9        max"
+		"   acq/sec\n");
+	printf("----------------------------------------------------------------"
+		"--------\n");
+
+	static const int32 kThreadCounts[] = { 2, 4, 8, 16 };
+	for (size_t i = 0; i <= sizeof(kThreadCounts) / sizeof(int32); i++) {
+		int32 threadCount = i < sizeof(kThreadCounts) / sizeof(int32)
+			? kThreadCounts[i] : cpuCount;
+		if (threadCount > cpuCount)
+			continue;
+		if (i == sizeof(kThreadCounts) / sizeof(int32)
+			&& std::find(kThreadCounts, kThreadCounts + i, cpuCount)
+				!= kThreadCounts + i) {
+			// already covered
+			continue;
+		}
+
+		if (!run_test(threadCount, false) || !run_test(threadCount, true))
+			return 1;
+	}
+
+	return 0;
+}
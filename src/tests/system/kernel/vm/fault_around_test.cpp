@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures how long it takes to touch every page of a mapped file that is
+	already in the file cache, with the different madvise() access patterns.
+
+	MADV_RANDOM turns off fault-around, so every page faults on its own, while
+	MADV_NORMAL and MADV_SEQUENTIAL map the neighbouring resident pages with a
+	single fault. The file is read once beforehand to make it resident.
+*/
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <OS.h>
+
+
+static const size_t kDefaultFileSize = 64 * 1024 * 1024;
+
+
+static void
+make_resident(int fd, off_t size)
+{
+	char buffer[64 * 1024];
+	for (off_t offset = 0; offset < size; offset += sizeof(buffer)) {
+		if (pread(fd, buffer, sizeof(buffer), offset) < 0) {
+			fprintf(stderr, "Error: read failed: %s\n", strerror(errno));
+			exit(1);
+		}
+	}
+}
+
+
+static void
+run(int fd, off_t size, const char* name, int advice)
+{
+	uint8* address = (uint8*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (address == MAP_FAILED) {
+		fprintf(stderr, "Error: mmap failed: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	if (madvise(address, size, advice) != 0)
+		fprintf(stderr, "Error: madvise failed: %s\n", strerror(errno));
+
+	bigtime_t startTime = system_time();
+
+	uint32 sum = 0;
+	for (off_t offset = 0; offset < size; offset += B_PAGE_SIZE)
+		sum += address[offset];
+
+	bigtime_t time = system_time() - startTime;
+	munmap(address, size);
+
+	printf("%-20s %10" B_PRIdBIGTIME " us %8.1f ns/page (%" B_PRIu32 ")\n",
+		name, time, time * 1000.0 / (size / B_PAGE_SIZE), sum);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	if (argc > 2) {
+		printf("Usage: %s [<file>]\n", argv[0]);
+		return 1;
+	}
+
+	char path[B_PATH_NAME_LENGTH];
+	bool temporary = argc < 2;
+	if (temporary) {
+		strlcpy(path, "/tmp/fault_around_test.XXXXXX", sizeof(path));
+		int fd = mkstemp(path);
+		if (fd < 0 || ftruncate(fd, kDefaultFileSize) != 0) {
+			fprintf(stderr, "Error: could not create test file: %s\n",
+				strerror(errno));
+			return 1;
+		}
+		close(fd);
+	} else
+		strlcpy(path, argv[1], sizeof(path));
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Error: could not open \"%s\": %s\n", path,
+			strerror(errno));
+		return 1;
+	}
+
+	struct stat st;
+	fstat(fd, &st);
+	off_t size = st.st_size - st.st_size % B_PAGE_SIZE;
+
+	make_resident(fd, size);
+
+	run(fd, size, "MADV_RANDOM", MADV_RANDOM);
+	run(fd, size, "MADV_NORMAL", MADV_NORMAL);
+	run(fd, size, "MADV_SEQUENTIAL", MADV_SEQUENTIAL);
+
+	close(fd);
+	if (temporary)
+		unlink(path);
+
+	return 0;
+}
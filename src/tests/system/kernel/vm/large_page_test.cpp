@@ -0,0 +1,248 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Benchmarks and checks the use of large pages for anonymous memory.
+
+	An area is populated and then accessed randomly, once with large pages
+	disabled via madvise(MADV_NOHUGEPAGE), and once with them requested via
+	madvise(MADV_HUGEPAGE). The number of large page faults is printed along
+	with the timings.
+	Afterwards single pages of large pages are write-protected and unmapped,
+	which has to split the large pages, and the memory contents are verified.
+*/
+
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <OS.h>
+
+#include <syscalls.h>
+#include <vm_defs.h>
+
+
+static const size_t kDefaultLargePageSize = 2 * 1024 * 1024;
+
+static size_t sSize = 64 * 1024 * 1024;
+static int64 sAccesses = 16 * 1024 * 1024;
+
+static volatile uint32 sSink;
+
+
+static void
+get_large_page_stats(vm_large_page_stats& stats)
+{
+	if (_kern_get_large_page_stats(&stats) != B_OK)
+		memset(&stats, 0, sizeof(stats));
+}
+
+
+static uint8*
+create_test_area(area_id& _area, int advice)
+{
+	uint8* address;
+	_area = create_area("large page test", (void**)&address, B_ANY_ADDRESS,
+		sSize, B_NO_LOCK, B_READ_AREA | B_WRITE_AREA);
+	if (_area < 0) {
+		fprintf(stderr, "Error: failed to create area: %s\n", strerror(_area));
+		exit(1);
+	}
+
+	if (madvise(address, sSize, advice) != 0) {
+		fprintf(stderr, "Error: madvise() failed: %s\n", strerror(errno));
+		exit(1);
+	}
+
+	return address;
+}
+
+
+static inline uint32
+test_value(size_t index)
+{
+	return (uint32)index * 2654435761U;
+}
+
+
+static void
+run_benchmark(const char* name, int advice)
+{
+	vm_large_page_stats before;
+	get_large_page_stats(before);
+
+	area_id area;
+	uint8* address = create_test_area(area, advice);
+
+	bigtime_t startTime = system_time();
+	for (size_t offset = 0; offset < sSize; offset += B_PAGE_SIZE)
+		address[offset] = (uint8)(offset / B_PAGE_SIZE);
+	bigtime_t populateTime = system_time() - startTime;
+
+	uint64 random = 1;
+	uint32 sum = 0;
+	startTime = system_time();
+	for (int64 i = 0; i < sAccesses; i++) {
+		random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+		sum += address[(random >> 16) % sSize];
+	}
+	bigtime_t accessTime = system_time() - startTime;
+
+	sSink = sum;
+
+	vm_large_page_stats after;
+	get_large_page_stats(after);
+
+	delete_area(area);
+
+	printf("%-16s %12.1f %12.1f %12" B_PRId64 " %12" B_PRId64 "\n", name,
+		populateTime / 1000.0, accessTime / 1000.0, after.faults - before.faults,
+		after.fallbacks - before.fallbacks);
+}
+
+
+static bool
+verify(const uint32* data, size_t count, size_t skipStart, size_t skipEnd)
+{
+	for (size_t i = 0; i < count; i++) {
+		if (i >= skipStart && i < skipEnd)
+			continue;
+
+		if (data[i] != test_value(i)) {
+			fprintf(stderr, "Error: wrong value at offset %#" B_PRIxSIZE
+				": %#" B_PRIx32 ", expected %#" B_PRIx32 "\n",
+				i * sizeof(uint32), data[i], test_value(i));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+static bool
+test_splitting()
+{
+	vm_large_page_stats before;
+	get_large_page_stats(before);
+
+	area_id area;
+	uint8* address = create_test_area(area, MADV_HUGEPAGE);
+
+	uint32* data = (uint32*)address;
+	size_t count = sSize / sizeof(uint32);
+	for (size_t i = 0; i < count; i++)
+		data[i] = test_value(i);
+
+	vm_large_page_stats populated;
+	get_large_page_stats(populated);
+
+	size_t largePageSize = before.page_size != 0
+		? before.page_size : kDefaultLargePageSize;
+	addr_t base = ((addr_t)address + largePageSize - 1) & ~(largePageSize - 1);
+	if (base + 2 * largePageSize > (addr_t)address + sSize) {
+		fprintf(stderr, "Error: the area is too small\n");
+		return false;
+	}
+
+	// write-protect a single page in the middle of a large page
+	uint8* protectedPage = (uint8*)base + 4 * B_PAGE_SIZE;
+	if (mprotect(protectedPage, B_PAGE_SIZE, PROT_READ) != 0) {
+		fprintf(stderr, "Error: mprotect() failed: %s\n", strerror(errno));
+		return false;
+	}
+
+	// the pages around it must still be writable
+	volatile uint32* neighbor = (uint32*)(protectedPage - B_PAGE_SIZE);
+	*neighbor = *neighbor;
+	neighbor = (uint32*)(protectedPage + B_PAGE_SIZE);
+	*neighbor = *neighbor;
+
+	// unmap a single page of the next large page
+	uint8* unmappedPage = (uint8*)base + largePageSize + 8 * B_PAGE_SIZE;
+	if (munmap(unmappedPage, B_PAGE_SIZE) != 0) {
+		fprintf(stderr, "Error: munmap() failed: %s\n", strerror(errno));
+		return false;
+	}
+
+	size_t skipStart = (unmappedPage - address) / sizeof(uint32);
+	bool success = verify(data, count, skipStart,
+		skipStart + B_PAGE_SIZE / sizeof(uint32));
+
+	vm_large_page_stats after;
+	get_large_page_stats(after);
+
+	int64 faults = populated.faults - before.faults;
+	int64 demotions = after.demotions - populated.demotions;
+	printf("\nsplitting: %" B_PRId64 " large page faults, %" B_PRId64
+		" demotions, contents %s\n", faults, demotions,
+		success ? "ok" : "corrupted");
+
+	if (before.page_size == 0)
+		printf("Large pages are not supported.\n");
+	else if (faults == 0) {
+		printf("No large pages could be allocated (physical memory might be "
+			"fragmented).\n");
+	} else if (demotions == 0) {
+		// Whether the two large pages in question actually were large pages
+		// can't be told for sure, but with an otherwise idle system that's
+		// to be expected.
+		fprintf(stderr, "Warning: no large page has been split.\n");
+	}
+
+	munmap(address, sSize);
+	return success;
+}
+
+
+static void
+usage(const char* programName)
+{
+	printf("Usage: %s [options]\n"
+		"  -s <MB>       size of the test area (default: %" B_PRIuSIZE ")\n"
+		"  -a <count>    number of random accesses (default: %" B_PRId64 ")\n",
+		programName, sSize / (1024 * 1024), sAccesses);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int option;
+	while ((option = getopt(argc, argv, "s:a:h")) != -1) {
+		switch (option) {
+			case 's':
+				sSize = (size_t)atol(optarg) * 1024 * 1024;
+				break;
+			case 'a':
+				sAccesses = atoll(optarg);
+				break;
+			default:
+				usage(argv[0]);
+				return option == 'h' ? 0 : 1;
+		}
+	}
+
+	if (sSize < 4 * kDefaultLargePageSize || sAccesses <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	vm_large_page_stats stats;
+	get_large_page_stats(stats);
+	printf("large page size: %" B_PRIuSIZE ", area size: %" B_PRIuSIZE
+		" MB\n\n", stats.page_size, sSize / (1024 * 1024));
+
+	printf("advice              fill (ms)  access (ms)  large faults"
+		"    fallbacks\n");
+	run_benchmark("MADV_NOHUGEPAGE", MADV_NOHUGEPAGE);
+	run_benchmark("MADV_HUGEPAGE", MADV_HUGEPAGE);
+
+	return test_splitting() ? 0 : 1;
+}
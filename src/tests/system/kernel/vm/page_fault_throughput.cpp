@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures the anonymous page fault throughput for an increasing number of
+	threads.
+
+	Each thread creates its own area, touches every page of it (each touch
+	faults in a fresh, cleared page), and deletes the area again, freeing the
+	pages. This mostly exercises the page allocation and free paths, which
+	is where parallel faulting threads used to contend.
+*/
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+
+static const int32 kMaxThreads = 1024;
+
+static int32 sPagesPerRound = 1024;
+static int32 sRounds = 32;
+
+static sem_id sStartSem;
+
+
+static status_t
+fault_thread(void* _faults)
+{
+	int64* faults = (int64*)_faults;
+
+	acquire_sem(sStartSem);
+
+	for (int32 round = 0; round < sRounds; round++) {
+		uint8* address;
+		area_id area = create_area("page fault throughput", (void**)&address,
+			B_ANY_ADDRESS, (size_t)sPagesPerRound * B_PAGE_SIZE, B_NO_LOCK,
+			B_READ_AREA | B_WRITE_AREA);
+		if (area < 0)
+			return area;
+
+		for (int32 i = 0; i < sPagesPerRound; i++)
+			address[(size_t)i * B_PAGE_SIZE] = (uint8)i;
+
+		delete_area(area);
+		*faults += sPagesPerRound;
+	}
+
+	return B_OK;
+}
+
+
+static bool
+run_test(int32 threadCount, bigtime_t& _time, int64& _faults)
+{
+	thread_id threads[kMaxThreads];
+	int64 faults[kMaxThreads];
+
+	sStartSem = create_sem(0, "start");
+
+	for (int32 i = 0; i < threadCount; i++) {
+		faults[i] = 0;
+		threads[i] = spawn_thread(&fault_thread, "faulter", B_NORMAL_PRIORITY,
+			&faults[i]);
+		if (threads[i] < 0) {
+			fprintf(stderr, "Error: failed to spawn thread: %s\n",
+				strerror(threads[i]));
+			exit(1);
+		}
+		resume_thread(threads[i]);
+	}
+
+	// give the threads time to block on the semaphore
+	snooze(10000);
+
+	bigtime_t startTime = system_time();
+	release_sem_etc(sStartSem, threadCount, 0);
+
+	bool success = true;
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+		if (result != B_OK) {
+			fprintf(stderr, "Error: thread failed: %s\n", strerror(result));
+			success = false;
+		}
+	}
+
+	_time = system_time() - startTime;
+
+	delete_sem(sStartSem);
+
+	_faults = 0;
+	for (int32 i = 0; i < threadCount; i++)
+		_faults += faults[i];
+
+	return success;
+}
+
+
+static void
+usage(const char* programName)
+{
+	printf("Usage: %s [options]\n"
+		"  -t <count>    maximum number of threads (default: twice the CPU "
+			"count)\n"
+		"  -p <pages>    pages faulted in per round (default: %" B_PRId32 ")\n"
+		"  -r <rounds>   rounds per thread (default: %" B_PRId32 ")\n",
+		programName, sPagesPerRound, sRounds);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	system_info info;
+	get_system_info(&info);
+
+	int32 maxThreads = 2 * info.cpu_count;
+
+	int option;
+	while ((option = getopt(argc, argv, "t:p:r:h")) != -1) {
+		switch (option) {
+			case 't':
+				maxThreads = atol(optarg);
+				break;
+			case 'p':
+				sPagesPerRound = atol(optarg);
+				break;
+			case 'r':
+				sRounds = atol(optarg);
+				break;
+			default:
+				usage(argv[0]);
+				return option == 'h' ? 0 : 1;
+		}
+	}
+
+	if (maxThreads <= 0 || maxThreads > kMaxThreads || sPagesPerRound <= 0
+		|| sRounds <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	printf("%" B_PRId32 " CPUs, %" B_PRId32 " pages x %" B_PRId32
+		" rounds per thread\n\n", info.cpu_count, sPagesPerRound, sRounds);
+	printf("threads       faults    time (ms)     faults/s   speedup\n");
+
+	double singleRate = 0;
+	bool success = true;
+
+	for (int32 threadCount = 1; threadCount <= maxThreads;
+			threadCount = threadCount < 4 ? threadCount + 1 : threadCount * 2) {
+		bigtime_t time;
+		int64 faults;
+		if (!run_test(threadCount, time, faults))
+			success = false;
+
+		double rate = time > 0 ? faults * 1000000.0 / time : 0;
+		if (threadCount == 1)
+			singleRate = rate;
+
+		printf("%7" B_PRId32 " %12" B_PRId64 " %12.1f %12.0f %9.2f\n",
+			threadCount, faults, time / 1000.0, rate,
+			singleRate > 0 ? rate / singleRate : 0);
+	}
+
+	return success ? 0 : 1;
+}
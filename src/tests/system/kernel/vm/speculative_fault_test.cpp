@@ -0,0 +1,229 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures the anonymous page fault throughput of several threads, while
+	another thread keeps mapping and unmapping memory in the same team.
+
+	Each faulting thread touches every page of its own area, which has been
+	created before the measurement starts. The churning thread write-locks
+	the address space with every mmap() and munmap(); since those only change
+	their own range, the page faults in the other areas shouldn't have to wait
+	for them.
+*/
+
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <OS.h>
+
+
+static const int32 kMaxThreads = 1024;
+static const size_t kChurnSize = 16 * B_PAGE_SIZE;
+
+static int32 sPagesPerThread = 16384;
+
+static sem_id sStartSem;
+static int32 sChurnQuit;
+
+
+struct fault_thread_args {
+	uint8*	address;
+	int64	faults;
+};
+
+
+static status_t
+fault_thread(void* _args)
+{
+	fault_thread_args* args = (fault_thread_args*)_args;
+
+	acquire_sem(sStartSem);
+
+	for (int32 i = 0; i < sPagesPerThread; i++)
+		args->address[(size_t)i * B_PAGE_SIZE] = (uint8)i;
+
+	args->faults = sPagesPerThread;
+	return B_OK;
+}
+
+
+static status_t
+churn_thread(void* _rounds)
+{
+	int64* rounds = (int64*)_rounds;
+
+	while (atomic_get(&sChurnQuit) == 0) {
+		void* address = mmap(NULL, kChurnSize, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (address == MAP_FAILED)
+			return B_NO_MEMORY;
+
+		munmap(address, kChurnSize);
+		(*rounds)++;
+	}
+
+	return B_OK;
+}
+
+
+static bool
+run_test(int32 threadCount, bool churn, bigtime_t& _time, int64& _faults,
+	int64& _churnRounds)
+{
+	thread_id threads[kMaxThreads];
+	area_id areas[kMaxThreads];
+	fault_thread_args args[kMaxThreads];
+
+	sStartSem = create_sem(0, "start");
+
+	for (int32 i = 0; i < threadCount; i++) {
+		areas[i] = create_area("speculative fault test",
+			(void**)&args[i].address, B_ANY_ADDRESS,
+			(size_t)sPagesPerThread * B_PAGE_SIZE, B_NO_LOCK,
+			B_READ_AREA | B_WRITE_AREA);
+		if (areas[i] < 0) {
+			fprintf(stderr, "Error: failed to create area: %s\n",
+				strerror(areas[i]));
+			exit(1);
+		}
+
+		args[i].faults = 0;
+		threads[i] = spawn_thread(&fault_thread, "faulter", B_NORMAL_PRIORITY,
+			&args[i]);
+		if (threads[i] < 0) {
+			fprintf(stderr, "Error: failed to spawn thread: %s\n",
+				strerror(threads[i]));
+			exit(1);
+		}
+		resume_thread(threads[i]);
+	}
+
+	_churnRounds = 0;
+	sChurnQuit = 0;
+	thread_id churnThread = -1;
+	if (churn) {
+		churnThread = spawn_thread(&churn_thread, "churner",
+			B_NORMAL_PRIORITY, &_churnRounds);
+		if (churnThread < 0) {
+			fprintf(stderr, "Error: failed to spawn thread: %s\n",
+				strerror(churnThread));
+			exit(1);
+		}
+		resume_thread(churnThread);
+	}
+
+	// give the threads time to block on the semaphore
+	snooze(10000);
+
+	bigtime_t startTime = system_time();
+	release_sem_etc(sStartSem, threadCount, 0);
+
+	bool success = true;
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+		if (result != B_OK) {
+			fprintf(stderr, "Error: thread failed: %s\n", strerror(result));
+			success = false;
+		}
+	}
+
+	_time = system_time() - startTime;
+
+	if (churn) {
+		atomic_set(&sChurnQuit, 1);
+
+		status_t result;
+		wait_for_thread(churnThread, &result);
+		if (result != B_OK) {
+			fprintf(stderr, "Error: churn thread failed: %s\n",
+				strerror(result));
+			success = false;
+		}
+	}
+
+	delete_sem(sStartSem);
+
+	_faults = 0;
+	for (int32 i = 0; i < threadCount; i++) {
+		_faults += args[i].faults;
+		delete_area(areas[i]);
+	}
+
+	return success;
+}
+
+
+static void
+usage(const char* programName)
+{
+	printf("Usage: %s [options]\n"
+		"  -t <count>    maximum number of faulting threads (default: the CPU "
+			"count)\n"
+		"  -p <pages>    pages faulted in per thread (default: %" B_PRId32
+			")\n",
+		programName, sPagesPerThread);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	system_info info;
+	get_system_info(&info);
+
+	int32 maxThreads = info.cpu_count;
+
+	int option;
+	while ((option = getopt(argc, argv, "t:p:h")) != -1) {
+		switch (option) {
+			case 't':
+				maxThreads = atol(optarg);
+				break;
+			case 'p':
+				sPagesPerThread = atol(optarg);
+				break;
+			default:
+				usage(argv[0]);
+				return option == 'h' ? 0 : 1;
+		}
+	}
+
+	if (maxThreads <= 0 || maxThreads > kMaxThreads || sPagesPerThread <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	printf("%" B_PRId32 " CPUs, %" B_PRId32 " pages per thread\n\n",
+		info.cpu_count, sPagesPerThread);
+	printf("threads     faults/s  with churn  churn rounds/s   ratio\n");
+
+	bool success = true;
+
+	for (int32 threadCount = 1; threadCount <= maxThreads;
+			threadCount = threadCount < 4 ? threadCount + 1 : threadCount * 2) {
+		bigtime_t time;
+		int64 faults;
+		int64 churnRounds;
+		if (!run_test(threadCount, false, time, faults, churnRounds))
+			success = false;
+		double rate = time > 0 ? faults * 1000000.0 / time : 0;
+
+		if (!run_test(threadCount, true, time, faults, churnRounds))
+			success = false;
+		double churnRate = time > 0 ? faults * 1000000.0 / time : 0;
+
+		printf("%7" B_PRId32 " %12.0f %11.0f %15.0f %7.2f\n", threadCount,
+			rate, churnRate, time > 0 ? churnRounds * 1000000.0 / time : 0,
+			rate > 0 ? churnRate / rate : 0);
+	}
+
+	return success ? 0 : 1;
+}
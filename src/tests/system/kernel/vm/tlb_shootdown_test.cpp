@@ -0,0 +1,211 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Checks and benchmarks TLB shootdowns.
+
+	The main thread repeatedly replaces a page with a fresh one containing the
+	iteration number, and publishes the number afterwards. Reader threads of
+	the same team read the published number and then the page. Seeing an
+	older number in the page means a stale TLB entry has survived the
+	replacement. Half of the readers spin, the others sleep in between, so
+	that the CPUs they run on keep switching between the team and the idle
+	thread.
+	Finally, the time for mapping and unmapping a range of pages is measured
+	with only sleeping readers, which shouldn't have to be interrupted.
+*/
+
+
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <OS.h>
+
+
+static const int32 kMaxThreads = 64;
+
+static int32 sIterations = 100000;
+static int32 sUnmapPages = 256;
+
+static uint32* volatile sPage;
+static volatile int32 sPublished;
+static int32 sQuit;
+static int32 sStaleReads;
+
+
+static status_t
+reader_thread(void* data)
+{
+	bool sleeping = data != NULL;
+
+	while (atomic_get(&sQuit) == 0) {
+		int32 published = atomic_get((int32*)&sPublished);
+		int32 value = (int32)*sPage;
+
+		// a fresh page is cleared until the number has been written
+		if (value != 0 && value < published) {
+			fprintf(stderr, "Error: read %" B_PRId32 " after %" B_PRId32
+				" has been published\n", value, published);
+			atomic_add(&sStaleReads, 1);
+		}
+
+		if (sleeping)
+			snooze(100);
+	}
+
+	return B_OK;
+}
+
+
+static bool
+test_coherency(int32 threadCount)
+{
+	uint32* page = (uint32*)mmap(NULL, B_PAGE_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (page == MAP_FAILED) {
+		fprintf(stderr, "Error: mmap() failed: %s\n", strerror(errno));
+		return false;
+	}
+	*page = 0;
+	sPage = page;
+
+	thread_id threads[kMaxThreads];
+	for (int32 i = 0; i < threadCount; i++) {
+		threads[i] = spawn_thread(&reader_thread, "reader", B_NORMAL_PRIORITY,
+			(void*)(addr_t)(i % 2));
+		resume_thread(threads[i]);
+	}
+
+	bigtime_t startTime = system_time();
+	for (int32 i = 1; i <= sIterations; i++) {
+		// replace the page by a fresh one
+		void* address = mmap(page, B_PAGE_SIZE, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+		if (address != page) {
+			fprintf(stderr, "Error: mmap() failed: %s\n", strerror(errno));
+			break;
+		}
+
+		*page = i;
+		atomic_set((int32*)&sPublished, i);
+	}
+	bigtime_t time = system_time() - startTime;
+
+	atomic_set(&sQuit, 1);
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+	}
+
+	munmap(page, B_PAGE_SIZE);
+
+	printf("coherency: %" B_PRId32 " page replacements with %" B_PRId32
+		" readers: %.2f us each, %" B_PRId32 " stale reads\n", sIterations,
+		threadCount, (double)time / sIterations, sStaleReads);
+
+	return sStaleReads == 0;
+}
+
+
+static void
+benchmark_unmap(int32 threadCount)
+{
+	sQuit = 0;
+
+	uint32 dummy = 0;
+	sPage = &dummy;
+	sPublished = 0;
+
+	thread_id threads[kMaxThreads];
+	for (int32 i = 0; i < threadCount; i++) {
+		threads[i] = spawn_thread(&reader_thread, "sleeper", B_NORMAL_PRIORITY,
+			(void*)1);
+		resume_thread(threads[i]);
+	}
+
+	size_t size = (size_t)sUnmapPages * B_PAGE_SIZE;
+	int32 rounds = sIterations / 100 + 1;
+
+	bigtime_t startTime = system_time();
+	for (int32 i = 0; i < rounds; i++) {
+		uint8* address = (uint8*)mmap(NULL, size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (address == MAP_FAILED)
+			break;
+
+		for (size_t offset = 0; offset < size; offset += B_PAGE_SIZE)
+			address[offset] = 1;
+
+		munmap(address, size);
+	}
+	bigtime_t time = system_time() - startTime;
+
+	atomic_set(&sQuit, 1);
+	for (int32 i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+	}
+
+	printf("unmap: %" B_PRId32 " pages with %" B_PRId32 " sleeping threads: "
+		"%.1f us per round\n", sUnmapPages, threadCount,
+		(double)time / rounds);
+}
+
+
+static void
+usage(const char* programName)
+{
+	printf("Usage: %s [options]\n"
+		"  -t <count>    number of reader threads (default: twice the CPU "
+			"count)\n"
+		"  -i <count>    number of iterations (default: %" B_PRId32 ")\n"
+		"  -p <pages>    pages unmapped per round (default: %" B_PRId32 ")\n",
+		programName, sIterations, sUnmapPages);
+}
+
+
+int
+main(int argc, char** argv)
+{
+	system_info info;
+	get_system_info(&info);
+
+	int32 threadCount = min_c(2 * (int32)info.cpu_count, kMaxThreads);
+
+	int option;
+	while ((option = getopt(argc, argv, "t:i:p:h")) != -1) {
+		switch (option) {
+			case 't':
+				threadCount = atol(optarg);
+				break;
+			case 'i':
+				sIterations = atol(optarg);
+				break;
+			case 'p':
+				sUnmapPages = atol(optarg);
+				break;
+			default:
+				usage(argv[0]);
+				return option == 'h' ? 0 : 1;
+		}
+	}
+
+	if (threadCount < 0 || threadCount > kMaxThreads || sIterations <= 0
+		|| sUnmapPages <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	printf("%" B_PRId32 " CPUs\n", info.cpu_count);
+
+	bool success = test_coherency(threadCount);
+	benchmark_unmap(threadCount);
+
+	return success ? 0 : 1;
+}
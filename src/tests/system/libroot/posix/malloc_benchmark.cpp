@@ -0,0 +1,280 @@
+/*
+ * Copyright 2026, Haiku, Inc. All rights reserved.
+ * Distributed under the terms of the MIT License.
+ */
+
+
+/*!	Measures the throughput and the memory footprint of malloc() and free()
+	for a number of threads and allocation size distributions.
+
+	Every thread replaces randomly chosen allocations in a table of slots with
+	new ones of a random size. The slots are either private to a thread, or
+	shared by all threads, in which case most objects are freed by another
+	thread than the one that allocated them.
+
+	While the threads run, the resident memory of the team is sampled, and
+	reported over time, together with what is left after everything has been
+	freed again.
+
+	Usage: malloc_benchmark [max threads] [operations per thread]
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <OS.h>
+
+
+static const int kDefaultMaxThreads = 8;
+static const int kDefaultOperations = 1000000;
+static const int kSlotsPerThread = 4096;
+static const int kLargeSlotsPerThread = 64;
+static const int kMaxSamples = 10;
+static const bigtime_t kSampleInterval = 20000;
+
+
+enum size_distribution {
+	SIZES_SMALL = 0,
+	SIZES_MIXED,
+	SIZES_LARGE
+};
+
+static const char* const kDistributionNames[] = { "small", "mixed", "large" };
+
+
+struct benchmark {
+	size_distribution	distribution;
+	void**				slots;
+	int					slot_count;
+	bool				shared;
+	int					operations;
+};
+
+
+struct worker {
+	benchmark*			bench;
+	void**				slots;
+	int					slot_count;
+	uint32				seed;
+};
+
+
+static inline uint32
+next_random(uint32& seed)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+
+static size_t
+random_size(size_distribution distribution, uint32& seed)
+{
+	uint32 random = next_random(seed);
+
+	switch (distribution) {
+		case SIZES_SMALL:
+			// 8 to 256 bytes
+			return 8 + random % 249;
+
+		case SIZES_MIXED:
+		{
+			// mostly small, sometimes up to 64 KiB: every doubling is half
+			// as likely as the one before
+			int shift = 0;
+			while (shift < 11 && (random & (1 << shift)) != 0)
+				shift++;
+			return (16 << shift) + (random >> 12) % (16 << shift);
+		}
+
+		case SIZES_LARGE:
+			// 32 KiB to 1 MiB
+			return 32 * 1024 + random % (1024 * 1024 - 32 * 1024);
+	}
+
+	return 0;
+}
+
+
+static size_t
+resident_size()
+{
+	size_t size = 0;
+
+	area_info info;
+	ssize_t cookie = 0;
+	while (get_next_area_info(B_CURRENT_TEAM, &cookie, &info) == B_OK)
+		size += info.ram_size;
+
+	return size;
+}
+
+
+static status_t
+worker_thread(void* data)
+{
+	worker& work = *(worker*)data;
+	benchmark& bench = *work.bench;
+
+	for (int i = 0; i < bench.operations; i++) {
+		int index = next_random(work.seed) % work.slot_count;
+		size_t size = random_size(bench.distribution, work.seed);
+
+		uint8* allocation = (uint8*)malloc(size);
+		if (allocation == NULL)
+			return B_NO_MEMORY;
+		allocation[0] = allocation[size - 1] = (uint8)size;
+
+		void* previous;
+		if (bench.shared) {
+#if B_HAIKU_64_BIT
+			previous = (void*)atomic_get_and_set64(
+				(int64*)&work.slots[index], (int64)allocation);
+#else
+			previous = (void*)atomic_get_and_set((int32*)&work.slots[index],
+				(int32)allocation);
+#endif
+		} else {
+			previous = work.slots[index];
+			work.slots[index] = allocation;
+		}
+
+		free(previous);
+	}
+
+	return B_OK;
+}
+
+
+static bool
+run(size_distribution distribution, int threadCount, bool shared,
+	int operations)
+{
+	int slotsPerThread = distribution == SIZES_LARGE
+		? kLargeSlotsPerThread : kSlotsPerThread;
+
+	benchmark bench;
+	bench.distribution = distribution;
+	bench.slot_count = threadCount * slotsPerThread;
+	bench.slots = (void**)calloc(bench.slot_count, sizeof(void*));
+	bench.shared = shared;
+	bench.operations = operations;
+	if (distribution == SIZES_LARGE)
+		bench.operations /= 100;
+
+	size_t startSize = resident_size();
+
+	worker* workers = new worker[threadCount];
+	thread_id* threads = new thread_id[threadCount];
+
+	bigtime_t start = system_time();
+	for (int i = 0; i < threadCount; i++) {
+		workers[i].bench = &bench;
+		workers[i].slots = shared
+			? bench.slots : bench.slots + i * slotsPerThread;
+		workers[i].slot_count = shared ? bench.slot_count : slotsPerThread;
+		workers[i].seed = i + 1;
+
+		threads[i] = spawn_thread(worker_thread, "malloc worker",
+			B_NORMAL_PRIORITY, &workers[i]);
+		resume_thread(threads[i]);
+	}
+
+	// sample the resident size until all threads are done
+	size_t samples[kMaxSamples];
+	int sampleCount = 0;
+	int sampleStep = 1;
+	size_t peakSize = 0;
+	for (int i = 0; true; i++) {
+		status_t result;
+		if (wait_for_thread_etc(threads[threadCount - 1], B_RELATIVE_TIMEOUT,
+				kSampleInterval, &result) != B_TIMED_OUT) {
+			break;
+		}
+
+		size_t size = resident_size();
+		if (size > peakSize)
+			peakSize = size;
+
+		if (i % sampleStep != 0)
+			continue;
+
+		if (sampleCount == kMaxSamples) {
+			// keep every other sample, and take half as many from now on
+			for (int j = 0; j < kMaxSamples / 2; j++)
+				samples[j] = samples[j * 2];
+			sampleCount = kMaxSamples / 2;
+			sampleStep *= 2;
+		}
+		samples[sampleCount++] = size;
+	}
+
+	bool success = true;
+	for (int i = 0; i < threadCount; i++) {
+		status_t result;
+		wait_for_thread(threads[i], &result);
+		if (result != B_OK)
+			success = false;
+	}
+	bigtime_t time = system_time() - start;
+
+	size_t endSize = resident_size();
+	if (endSize > peakSize)
+		peakSize = endSize;
+
+	for (int i = 0; i < bench.slot_count; i++)
+		free(bench.slots[i]);
+	free(bench.slots);
+	size_t freedSize = resident_size();
+
+	delete[] threads;
+	delete[] workers;
+
+	printf("%-5s %-7s %2d threads: %10.0f ops/s, RSS %6" B_PRIuSIZE " KiB "
+		"at start, %6" B_PRIuSIZE " KiB peak, %6" B_PRIuSIZE " KiB at end, "
+		"%6" B_PRIuSIZE " KiB after freeing\n",
+		kDistributionNames[distribution], shared ? "shared" : "private",
+		threadCount,
+		(double)bench.operations * threadCount * 1000000 / time,
+		startSize / 1024, peakSize / 1024, endSize / 1024, freedSize / 1024);
+
+	printf("      RSS over time (KiB, every %" B_PRIdBIGTIME " ms):",
+		kSampleInterval * sampleStep / 1000);
+	for (int i = 0; i < sampleCount; i++)
+		printf(" %" B_PRIuSIZE, samples[i] / 1024);
+	putchar('\n');
+
+	if (!success)
+		fprintf(stderr, "allocation failed\n");
+	return success;
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int maxThreads = argc > 1 ? atoi(argv[1]) : kDefaultMaxThreads;
+	int operations = argc > 2 ? atoi(argv[2]) : kDefaultOperations;
+	if (maxThreads <= 0 || operations <= 0) {
+		fprintf(stderr, "usage: %s [max threads] [operations per thread]\n",
+			argv[0]);
+		return 1;
+	}
+
+	bool success = true;
+	for (int distribution = SIZES_SMALL; distribution <= SIZES_LARGE;
+			distribution++) {
+		for (int threads = 1; threads <= maxThreads; threads *= 2) {
+			success &= run((size_distribution)distribution, threads, false,
+				operations);
+			if (threads > 1) {
+				success &= run((size_distribution)distribution, threads, true,
+					operations);
+			}
+		}
+	}
+
+	return success ? 0 : 1;
+}
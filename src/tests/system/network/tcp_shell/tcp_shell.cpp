@@ -698,6 +698,7 @@ net_socket_module_info gNetSocketModule = {
 	NULL, // listen,
 	NULL, // receive,
 	NULL, // send,
+	NULL, // send_external,
 	NULL, // setsockopt,
 	NULL, // shutdown,
 	NULL, // socketpair
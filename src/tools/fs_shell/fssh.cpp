@@ -1024,6 +1024,138 @@ command_touch(int argc, const char* const* argv)
 }
 
 
+static void
+print_benchmark_phase(const char* phase, int operations, fssh_bigtime_t time)
+{
+	printf("%-8s %9d %12.0f\n", phase, operations,
+		time > 0 ? (double)operations * 1000000 / time : 0.0);
+}
+
+
+/*!	Measures the metadata operations per second of the file system: creates
+	a number of files in a new directory, stats them and reads the directory
+	a few times, and finally removes everything again.
+	Since the FS shell is single-threaded, only a single client can be
+	measured here; src/tests/system/kernel/cache/block_cache_scaling_test
+	does the same with any number of threads on a running system.
+*/
+static fssh_status_t
+command_metabench(int argc, const char* const* argv)
+{
+	int fileCount = 10000;
+	int rounds = 4;
+
+	// parse parameters
+	int argi = 1;
+	for (; argi < argc; argi++) {
+		const char* arg = argv[argi];
+		if (arg[0] != '-')
+			break;
+
+		if (strcmp(arg, "-n") == 0 && argi + 1 < argc)
+			fileCount = atoi(argv[++argi]);
+		else if (strcmp(arg, "-r") == 0 && argi + 1 < argc)
+			rounds = atoi(argv[++argi]);
+		else {
+			fprintf(stderr, "Error: Invalid option \"%s\"\n", arg);
+			return FSSH_B_BAD_VALUE;
+		}
+	}
+
+	if (argi + 1 < argc || fileCount <= 0 || rounds <= 0) {
+		printf("Usage: %s [ -n <files> ] [ -r <rounds> ] [ <dir> ]\n",
+			argv[0]);
+		return FSSH_B_BAD_VALUE;
+	}
+
+	const char* dir = argi < argc ? argv[argi] : "/myfs/metabench";
+
+	fssh_status_t error = _kern_create_dir(-1, dir, 0755);
+	if (error != FSSH_B_OK) {
+		fprintf(stderr, "Error: Failed to create dir \"%s\": %s\n", dir,
+			fssh_strerror(error));
+		return error;
+	}
+
+	printf("phase          ops        ops/s\n");
+
+	char path[FSSH_B_PATH_NAME_LENGTH];
+
+	// create
+	fssh_bigtime_t startTime = fssh_system_time();
+	int created = 0;
+	for (; created < fileCount; created++) {
+		snprintf(path, sizeof(path), "%s/file%d", dir, created);
+		int fd = _kern_open(-1, path, FSSH_O_CREAT | FSSH_O_EXCL, 0644);
+		if (fd < 0) {
+			fprintf(stderr, "Error: Failed to create \"%s\": %s\n", path,
+				fssh_strerror(fd));
+			error = fd;
+			break;
+		}
+		_kern_close(fd);
+	}
+	print_benchmark_phase("create", created, fssh_system_time() - startTime);
+
+	// stat
+	startTime = fssh_system_time();
+	for (int round = 0; round < rounds && error == FSSH_B_OK; round++) {
+		for (int i = 0; i < created; i++) {
+			snprintf(path, sizeof(path), "%s/file%d", dir, i);
+			struct fssh_stat st;
+			error = _kern_read_stat(-1, path, false, &st, sizeof(st));
+			if (error != FSSH_B_OK) {
+				fprintf(stderr, "Error: Failed to stat \"%s\": %s\n", path,
+					fssh_strerror(error));
+				break;
+			}
+		}
+	}
+	if (error == FSSH_B_OK) {
+		print_benchmark_phase("stat", rounds * created,
+			fssh_system_time() - startTime);
+	}
+
+	// readdir
+	startTime = fssh_system_time();
+	int entriesRead = 0;
+	for (int round = 0; round < rounds && error == FSSH_B_OK; round++) {
+		int fd = _kern_open_dir(-1, dir);
+		if (fd < 0) {
+			error = fd;
+			break;
+		}
+
+		char buffer[sizeof(fssh_dirent) + FSSH_B_FILE_NAME_LENGTH];
+		fssh_dirent* entry = (fssh_dirent*)buffer;
+		while (_kern_read_dir(fd, entry, sizeof(buffer), 1) == 1)
+			entriesRead++;
+
+		_kern_close(fd);
+	}
+	if (error == FSSH_B_OK) {
+		print_benchmark_phase("readdir", entriesRead,
+			fssh_system_time() - startTime);
+	}
+
+	// unlink
+	startTime = fssh_system_time();
+	for (int i = 0; i < created; i++) {
+		snprintf(path, sizeof(path), "%s/file%d", dir, i);
+		fssh_status_t status = _kern_unlink(-1, path);
+		if (status != FSSH_B_OK && error == FSSH_B_OK) {
+			fprintf(stderr, "Error: Failed to remove \"%s\": %s\n", path,
+				fssh_strerror(status));
+			error = status;
+		}
+	}
+	print_benchmark_phase("unlink", created, fssh_system_time() - startTime);
+
+	_kern_remove_dir(-1, dir);
+	return error;
+}
+
+
 static fssh_status_t
 command_mkdir(int argc, const char* const* argv)
 {
@@ -1354,6 +1486,7 @@ register_commands()
 		command_ioctl,		"ioctl",		"ioctl() on root, for FS debugging only",
 		command_ln,			"ln",			"create a hard or symbolic link",
 		command_ls,			"ls",			"list files or directories",
+		command_metabench,	"metabench",	"benchmark metadata operations",
 		command_mkdir,		"mkdir",		"create directories",
 		command_mkindex,	"mkindex",		"create an index",
 		command_mv,			"mv",			"move/rename files and directories",